@@ -613,6 +613,23 @@ UA_Client_modifyAsyncCallback(UA_Client *client, UA_UInt32 requestId,
 UA_StatusCode UA_EXPORT
 UA_Client_run_iterate(UA_Client *client, UA_UInt32 timeout);
 
+/* Drive many clients from a single thread. The sockets of all clients are
+ * polled together for at most the given timeout (less if a timed callback of
+ * one of the clients is due earlier). Only the clients whose socket became
+ * ready are processed. Clients that are (re)connecting are advanced without
+ * blocking. The other housekeeping of ``UA_Client_run_iterate`` is done for
+ * every client.
+ *
+ * @param clients Array of clients. NULL entries are skipped.
+ * @param clientsSize Number of entries in the array
+ * @param timeout Maximum time to wait in ms
+ * @return The first ``connectStatus`` that is not good or
+ *         UA_STATUSCODE_GOOD. Use ``UA_Client_getState`` to find out which
+ *         client has failed. */
+UA_StatusCode UA_EXPORT
+UA_Client_run_iterateMany(UA_Client **clients, size_t clientsSize,
+                          UA_UInt32 timeout);
+
 /* Force the manual renewal of the SecureChannel. This is useful to renew the
  * SecureChannel during a downtime when no time-critical operations are
  * performed. This method is asynchronous. The renewal is triggered (the OPN
@@ -128,8 +128,9 @@ struct UA_HistoryDatabase {
                UA_HistoryReadResponse *response,
                UA_HistoryEvent * const * const historyData);
 
-    /* No default implementation is provided by UA_HistoryDatabase_default
-     * for the following function */
+    /* UA_HistoryDatabase_default computes the aggregates Interpolative,
+     * Average, TimeAverage, Total, Minimum, Maximum, Range, Count, Start, End
+     * and Delta from the raw values of the backend. */
     void
     (*readProcessed)(UA_Server *server,
                void *hdbContext,
@@ -144,8 +145,8 @@ struct UA_HistoryDatabase {
                UA_HistoryReadResponse *response,
                UA_HistoryData * const * const historyData);
 
-    /* No default implementation is provided by UA_HistoryDatabase_default
-     * for the following function */
+    /* UA_HistoryDatabase_default interpolates between the raw values of the
+     * backend if there is no value at the requested time. */
     void
     (*readAtTime)(UA_Server *server,
                void *hdbContext,
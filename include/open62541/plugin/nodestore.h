@@ -257,19 +257,39 @@ UA_ReferenceTypeSet_contains(const UA_ReferenceTypeSet *set, UA_Byte index) {
  * not known or not important. The ``nodeClass`` attribute is used to ensure the
  * correctness of casting from ``UA_Node`` to a specific node type. */
 
-/* Ordered tree structure for fast member check */
 typedef struct {
-    struct aa_entry idTreeEntry; /* Binary-Tree for fast lookup */
-    struct aa_entry nameTreeEntry;
     UA_UInt32 targetIdHash;      /* Hash of the target's NodeId */
     UA_UInt32 targetNameHash;    /* Hash of the target's BrowseName */
     UA_ExpandedNodeId targetId;
 } UA_ReferenceTarget;
 
-/* List of reference targets with the same reference type and direction */
+/* Ordered tree structure for fast member check */
+typedef struct {
+    struct aa_entry idTreeEntry; /* Binary-Tree for fast lookup */
+    struct aa_entry nameTreeEntry;
+    UA_ReferenceTarget target;
+} UA_ReferenceTargetTreeElem;
+
+/* Up to this number of targets, the targets of a UA_NodeReferenceKind are
+ * stored in a sorted array. Further targets are added to binary trees. */
+#define UA_REFERENCETARGETS_ARRAY_MAX 32
+
+/* List of reference targets with the same reference type and direction. The
+ * targets are ordered by their targetIdHash (and then the targetId). Most
+ * nodes have only a few targets per reference type. They are kept in an array
+ * without any additional per-target overhead. Above the threshold (or when
+ * more targets shall be added to an array that was created in one go with a
+ * larger size), the targets are moved into two binary trees. */
 typedef struct {
-    struct aa_entry *idTreeRoot;   /* Fast lookup based on the target id */
-    struct aa_entry *nameTreeRoot; /* Fast lookup based on the target browseName*/
+    union {
+        UA_ReferenceTarget *array;
+        struct {
+            struct aa_entry *idTreeRoot;   /* Fast lookup based on the target id */
+            struct aa_entry *nameTreeRoot; /* Fast lookup based on the target browseName*/
+        } tree;
+    } targets;
+    size_t targetsSize;
+    UA_Boolean hasRefTree; /* RefTree or RefArray? */
     UA_Byte referenceTypeIndex;
     UA_Boolean isInverse;
 } UA_NodeReferenceKind;
@@ -554,6 +574,10 @@ typedef struct {
                            * background. Only dynamic variables conserve source
                            * and server timestamp for the value attribute.
                            * Static variables have timestamps of "now". */
+#if UA_MULTITHREADING >= 100
+    UA_Boolean async; /* Read and Write of a DataSource value are dispatched
+                       * to the async operation workers */
+#endif
 } UA_VariableNode;
 
 /**
@@ -901,6 +925,13 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst);
 UA_EXPORT UA_Node *
 UA_Node_copy_alloc(const UA_Node *src);
 
+/* Copy the node with all attributes, references and the value into a single
+ * contiguous memory block starting at dst. Returns the size of the block.
+ * With dst == NULL, only the required size is computed. The flat copy must not
+ * be edited or cleared. It is released with the memory block. */
+UA_EXPORT size_t
+UA_Node_copyFlat(const UA_Node *src, UA_Node *dst);
+
 /* Add a single reference to the node */
 UA_StatusCode UA_EXPORT
 UA_Node_addReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
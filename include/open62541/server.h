@@ -185,6 +185,13 @@ struct UA_ServerConfig {
     /* Nodestore */
     UA_Nodestore nodestore;
 
+    /* Encode the values of ReadResponses directly from the nodes. The
+     * DataValues in the response are not copied. The nodes remain pinned in
+     * the Nodestore until the response has been sent. The option has no
+     * effect with UA_MULTITHREADING >= 100. Then the values are always
+     * copied. */
+    UA_Boolean readValuesNoCopy;
+
     /* Certificate Verification */
     UA_CertificateVerification certificateVerification;
 
@@ -195,6 +202,8 @@ struct UA_ServerConfig {
     /* Limits for Sessions */
     UA_UInt16 maxSessions;
     UA_Double maxSessionTimeout; /* in ms */
+    UA_UInt32 maxRegisteredNodesPerSession; /* Handles from RegisterNodes.
+                                             * 0 -> unlimited */
 
     /* Operation limits */
     UA_UInt32 maxNodesPerRead;
@@ -209,6 +218,23 @@ struct UA_ServerConfig {
     /* Limits for Requests */
     UA_UInt32 maxReferencesPerNode;
 
+    /* The results of TranslateBrowsePathsToNodeIds are cached together with
+     * the results for the prefixes of the BrowsePaths. Paths with a common
+     * prefix are then resolved from the cached result of the prefix. The cache
+     * is invalidated when References are added or removed. Changing the
+     * references of a node directly with UA_Server_editNode is not tracked.
+     * The maximum number of cached BrowsePaths. 0 disables the cache. */
+    UA_UInt32 maxBrowsePathCacheSize;
+
+    /* Method calls cache the argument definitions of the method and whether
+     * the method is a component of the object. So repeated calls don't browse
+     * the address space. The cache is invalidated when References are added or
+     * removed, Nodes are deleted or a value of DataType Argument is written.
+     * Changing the argument values directly with UA_Server_editNode is not
+     * tracked. The maximum number of cached (Object, Method) pairs. 0 disables
+     * the cache. */
+    UA_UInt32 maxMethodCallCacheSize;
+
     /* Discovery */
 #ifdef UA_ENABLE_DISCOVERY
     /* Timeout in seconds when to automatically remove a registered server from
@@ -241,6 +267,9 @@ struct UA_ServerConfig {
     UA_UInt32 maxNotificationsPerPublish;
     UA_Boolean enableRetransmissionQueue;
     UA_UInt32 maxRetransmissionQueueSize; /* 0 -> unlimited size */
+    size_t maxRetransmissionQueueBytes; /* Encoded size of the retained
+                                         * NotificationMessages per Session.
+                                         * 0 -> unlimited size */
 # ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     UA_UInt32 maxEventsPerNode; /* 0 -> unlimited size */
 # endif
@@ -326,6 +355,34 @@ UA_ServerConfig_setCustomHostname(UA_ServerConfig *config,
 UA_Server UA_EXPORT *
 UA_Server_newWithConfig(UA_ServerConfig *config);
 
+/* Creating namespace zero (and the nodesets of companion specifications) node
+ * by node takes a large part of the server startup time. Every node goes
+ * through the checks of the AddNodes service. A snapshot contains the
+ * namespace array and all nodes of a fully constructed information model in
+ * the binary encoding. Loading it inserts the nodes into the nodestore without
+ * repeating the checks. So a snapshot can be created once (e.g. as a step of
+ * the build) and shipped together with the server.
+ *
+ * Node contexts, DataSources, value callbacks, value backends, method
+ * callbacks and lifecycle callbacks are not part of the snapshot. The
+ * callbacks of namespace zero are attached again during the initialization.
+ * Callbacks for the nodes of other namespaces have to be attached by the user
+ * after loading the snapshot. The snapshot has to be created by a server with
+ * the same build options and custom datatypes. */
+
+/* Encode the namespaces and nodes of the server into a snapshot. The snapshot
+ * buffer is allocated and has to be cleaned up by the caller. */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_encodeNodestoreSnapshot(UA_Server *server, UA_ByteString *snapshot);
+
+/* Creates a new server as with UA_Server_newWithConfig. But the nodes are
+ * loaded from the snapshot instead of creating namespace zero. The content of
+ * the snapshot is copied during loading. So the buffer (which can for example
+ * be a memory-mapped file) can be released afterwards. */
+UA_Server UA_EXPORT *
+UA_Server_newWithNodestoreSnapshot(UA_ServerConfig *config,
+                                   const UA_ByteString *snapshot);
+
 void UA_EXPORT UA_Server_delete(UA_Server *server);
 
 UA_ServerConfig UA_EXPORT *
@@ -1348,6 +1405,35 @@ UA_Server_addMethodNode_finish(UA_Server *server, const UA_NodeId nodeId,
 
 #endif
 
+/**
+ * Many instances of the same ObjectType can be added in bulk. The
+ * instantiation plan of the ObjectType (the children to be copied from the
+ * type and its supertypes, their BrowseNames, ModellingRules and References) is
+ * computed once and then applied to every instance. This avoids browsing the
+ * type hierarchy for every instance. The result is the same as for adding the
+ * instances one by one with UA_Server_addObjectNode. The createOptionalChild
+ * callback is called for every instance. But if the optional child of a type
+ * is not created, the matching children of the supertypes are skipped as
+ * well.
+ *
+ * The status code of every item is written to the results array. The NodeIds
+ * of the new instances are written to the optional outNewNodeIds array. The
+ * returned status code is bad only if the plan cannot be computed. */
+
+typedef struct {
+    UA_NodeId requestedNewNodeId;
+    UA_NodeId parentNodeId;
+    UA_NodeId referenceTypeId;
+    UA_QualifiedName browseName;
+    UA_ObjectAttributes attr;
+    void *nodeContext;
+} UA_AddObjectNodesItem;
+
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_addObjectNodes(UA_Server *server, const UA_NodeId typeDefinition,
+                         size_t itemsSize, const UA_AddObjectNodesItem *items,
+                         UA_StatusCode *results, UA_NodeId *outNewNodeIds);
+
 /* Deletes a node and optionally all references leading to the node. */
 UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_deleteNode(UA_Server *server, const UA_NodeId nodeId,
@@ -1586,6 +1672,15 @@ UA_Server_getNamespaceByName(UA_Server *server, const UA_String namespaceUri,
 * ready. See the examples in ``/examples/tutorial_server_method_async.c`` for
 * the usage.
 *
+* The same applies to the Read and Write of the value attribute of variables
+* with a DataSource that are marked as async. The access rights of the session
+* are checked before the operation is put into the queue. The worker typically
+* performs the operation with ``UA_Server_read`` (with both timestamps, the
+* server removes the timestamps that were not requested) or ``UA_Server_write``
+* and returns the result. The DataSource callbacks are then executed in the
+* worker thread. Note that they see the session of the local admin user and
+* not the session of the original request.
+*
 * Note that the operation can time out (see the asyncOperationTimeout setting in
 * the server config) also when it has been retrieved by the worker. */
 
@@ -1596,23 +1691,29 @@ UA_StatusCode UA_EXPORT
 UA_Server_setMethodNodeAsync(UA_Server *server, const UA_NodeId id,
                              UA_Boolean isAsync);
 
+/* Set the async flag in a variable node. Only Read and Write of the value
+ * attribute of variables with a DataSource are dispatched to the workers. */
+UA_StatusCode UA_EXPORT
+UA_Server_setVariableNodeAsync(UA_Server *server, const UA_NodeId id,
+                               UA_Boolean isAsync);
+
 typedef enum {
     UA_ASYNCOPERATIONTYPE_INVALID, /* 0, the default */
-    UA_ASYNCOPERATIONTYPE_CALL
-    /* UA_ASYNCOPERATIONTYPE_READ, */
-    /* UA_ASYNCOPERATIONTYPE_WRITE, */
+    UA_ASYNCOPERATIONTYPE_CALL,
+    UA_ASYNCOPERATIONTYPE_READ,
+    UA_ASYNCOPERATIONTYPE_WRITE
 } UA_AsyncOperationType;
 
 typedef union {
     UA_CallMethodRequest callMethodRequest;
-    /* UA_ReadValueId readValueId; */
-    /* UA_WriteValue writeValue; */
+    UA_ReadValueId readValueId;
+    UA_WriteValue writeValue;
 } UA_AsyncOperationRequest;
 
 typedef union {
     UA_CallMethodResult callMethodResult;
-    /* UA_DataValue readResult; */
-    /* UA_StatusCode writeResult; */
+    UA_DataValue readResult;
+    UA_StatusCode writeResult;
 } UA_AsyncOperationResponse;
 
 /* Get the next async operation without blocking
@@ -9,7 +9,7 @@
 #include <open62541/util.h>
 #include "securitypolicy_mbedtls_common.h"
 
-#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+#if defined(UA_ENABLE_PUBSUB_ENCRYPTION) && defined(UA_ENABLE_ENCRYPTION_MBEDTLS)
 
 #include <mbedtls/aes.h>
 #include <mbedtls/ctr_drbg.h>
@@ -52,12 +52,26 @@ typedef struct {
     UA_Byte encryptingKey[UA_AES128CTR_KEY_LENGTH];
     UA_Byte keyNonce[UA_AES128CTR_KEYNONCE_LENGTH];
     UA_Byte messageNonce[UA_AES128CTR_MESSAGENONCE_LENGTH];
+    /* Expanded encryption key and HMAC keyed with the signing key. Updated
+     * only when the keys change. */
+    mbedtls_aes_context aesContext;
+    mbedtls_md_context_t hmacContext;
 } PUBSUB_AES128CTR_ChannelContext;
 
 /*******************/
 /* SymmetricModule */
 /*******************/
 
+/* The HMAC context is keyed in updateKeys_sp_pubsub_aes128ctr. Resetting it
+ * restores the inner padding without processing the key again. */
+static void
+hmac_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
+                         const UA_ByteString *message, unsigned char *out) {
+    mbedtls_md_hmac_reset(&cc->hmacContext);
+    mbedtls_md_hmac_update(&cc->hmacContext, message->data, message->length);
+    mbedtls_md_hmac_finish(&cc->hmacContext, out);
+}
+
 /* Signature and verify all using HMAC-SHA2-256, nothing to change */
 static UA_StatusCode
 verify_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
@@ -70,13 +84,8 @@ verify_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
-    PUBSUB_AES128CTR_PolicyContext *pc =
-        (PUBSUB_AES128CTR_PolicyContext *)cc->policyContext;
-
     unsigned char mac[UA_SHA256_LENGTH];
-    UA_ByteString signingKey =
-        {UA_AES128CTR_SIGNING_KEY_LENGTH, cc->signingKey};
-    mbedtls_hmac(&pc->sha256MdContext, &signingKey, message, mac);
+    hmac_sp_pubsub_aes128ctr(cc, message, mac);
 
     /* Compare with Signature */
     if(!UA_constantTimeEqual(signature->data, mac, UA_SHA256_LENGTH))
@@ -90,10 +99,7 @@ sign_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    UA_ByteString signingKey =
-        {UA_AES128CTR_SIGNING_KEY_LENGTH, cc->signingKey};
-    mbedtls_hmac(&cc->policyContext->sha256MdContext, &signingKey, message,
-                 signature->data);
+    hmac_sp_pubsub_aes128ctr(cc, message, signature->data);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -123,22 +129,13 @@ getPlainTextBlockSize_sp_pubsub_aes128ctr(const void *channelContext) {
 }
 
 static UA_StatusCode
-encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
+encrypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
                             UA_ByteString *data) {
     if(cc == NULL || data == NULL)
         return UA_STATUSCODE_BADINTERNALERROR;
 
     /* CTR mode does not need padding */
 
-    /* Decode the header to Extract the message nonce */
-
-    /* Keylength in bits */
-    unsigned int keylength = (unsigned int)(UA_AES128CTR_KEY_LENGTH * 8);
-    mbedtls_aes_context aesContext;
-    int mbedErr = mbedtls_aes_setkey_enc(&aesContext, cc->encryptingKey, keylength);
-    if(mbedErr)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
     /* Prepare the counterBlock required for encryption/decryption */
     UA_Byte counterBlockCopy[UA_AES128CTR_ENCRYPTION_BLOCK_SIZE];
     memcpy(counterBlockCopy, cc->keyNonce, UA_AES128CTR_KEYNONCE_LENGTH);
@@ -149,8 +146,9 @@ encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
 
     size_t counterblockoffset = 0;
     UA_Byte aesBuffer[UA_AES128CTR_ENCRYPTION_BLOCK_SIZE];
-    mbedErr = mbedtls_aes_crypt_ctr(&aesContext, data->length, &counterblockoffset,
-                                    counterBlockCopy, aesBuffer, data->data, data->data);
+    int mbedErr = mbedtls_aes_crypt_ctr(&cc->aesContext, data->length, &counterblockoffset,
+                                        counterBlockCopy, aesBuffer,
+                                        data->data, data->data);
     if(mbedErr)
         return UA_STATUSCODE_BADINTERNALERROR;
     return UA_STATUSCODE_GOOD;
@@ -159,7 +157,7 @@ encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
 /* a decryption function is exactly the same as an encryption one, since they all do XOR
  * operations*/
 static UA_StatusCode
-decrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
+decrypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
                             UA_ByteString *data) {
     return encrypt_sp_pubsub_aes128ctr(cc, data);
 }
@@ -189,8 +187,25 @@ generateNonce_sp_pubsub_aes128ctr(void *policyContext, UA_ByteString *out) {
 /* ChannelModule */
 /*****************/
 
+/* Expand the AES key and key the HMAC. This is done once for every key and
+ * not for every message. */
+static UA_StatusCode
+updateKeys_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc) {
+    int mbedErr = mbedtls_aes_setkey_enc(&cc->aesContext, cc->encryptingKey,
+                                         UA_AES128CTR_KEY_LENGTH * 8);
+    if(mbedErr)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    mbedErr = mbedtls_md_hmac_starts(&cc->hmacContext, cc->signingKey,
+                                     UA_AES128CTR_SIGNING_KEY_LENGTH);
+    if(mbedErr)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
 static void
 channelContext_deleteContext_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc) {
+    mbedtls_aes_free(&cc->aesContext);
+    mbedtls_md_free(&cc->hmacContext);
     UA_free(cc);
 }
 
@@ -219,6 +234,18 @@ channelContext_newContext_sp_pubsub_aes128ctr(void *policyContext,
         memcpy(cc->encryptingKey, encryptingKey->data, encryptingKey->length);
     if(keyNonce)
         memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
+
+    mbedtls_aes_init(&cc->aesContext);
+    mbedtls_md_init(&cc->hmacContext);
+    UA_StatusCode res = UA_STATUSCODE_BADINTERNALERROR;
+    const mbedtls_md_info_t *mdInfo = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if(mbedtls_md_setup(&cc->hmacContext, mdInfo, 1) == 0)
+        res = updateKeys_sp_pubsub_aes128ctr(cc);
+    if(res != UA_STATUSCODE_GOOD) {
+        channelContext_deleteContext_sp_pubsub_aes128ctr(cc);
+        return res;
+    }
+
     *wgContext = cc;
     return UA_STATUSCODE_GOOD;
 }
@@ -237,7 +264,7 @@ channelContext_setKeys_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     memcpy(cc->signingKey, signingKey->data, signingKey->length);
     memcpy(cc->encryptingKey, encryptingKey->data, encryptingKey->length);
     memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
-    return UA_STATUSCODE_GOOD;
+    return updateKeys_sp_pubsub_aes128ctr(cc);
 }
 
 static UA_StatusCode
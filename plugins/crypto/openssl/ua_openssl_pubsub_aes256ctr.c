@@ -0,0 +1,368 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/util.h>
+
+#if defined(UA_ENABLE_PUBSUB_ENCRYPTION) && defined(UA_ENABLE_ENCRYPTION_OPENSSL)
+
+#include "securitypolicy_openssl_common.h"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include <limits.h>
+
+#define UA_SHA256_LENGTH 32
+#define UA_SHA256_BLOCK_SIZE 64
+#define UA_AES256CTR_SIGNING_KEY_LENGTH 32
+#define UA_AES256CTR_KEY_LENGTH 32
+#define UA_AES256CTR_KEYNONCE_LENGTH 4
+#define UA_AES256CTR_MESSAGENONCE_LENGTH 8
+#define UA_AES256CTR_ENCRYPTION_BLOCK_SIZE 16
+#define UA_AES256CTR_PLAIN_TEXT_BLOCK_SIZE 16
+
+typedef struct {
+    const UA_PubSubSecurityPolicy *securityPolicy;
+} PUBSUB_AES256CTR_PolicyContext;
+
+/* The cipher context holds the expanded key. Only the counter block is set for
+ * every message. The HMAC is kept as the SHA-256 states after hashing the inner
+ * and the outer padded key. They are copied for every message instead of
+ * hashing the key again. */
+typedef struct {
+    PUBSUB_AES256CTR_PolicyContext *policyContext;
+    UA_Byte keyNonce[UA_AES256CTR_KEYNONCE_LENGTH];
+    UA_Byte messageNonce[UA_AES256CTR_MESSAGENONCE_LENGTH];
+    EVP_CIPHER_CTX *cipherContext;
+    EVP_MD_CTX *innerHmacContext;
+    EVP_MD_CTX *outerHmacContext;
+    EVP_MD_CTX *mdContext;
+} PUBSUB_AES256CTR_ChannelContext;
+
+/*******************/
+/* SymmetricModule */
+/*******************/
+
+static UA_StatusCode
+hmac_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                         const UA_ByteString *message, UA_Byte *out) {
+    UA_Byte innerHash[UA_SHA256_LENGTH];
+    if(EVP_MD_CTX_copy_ex(cc->mdContext, cc->innerHmacContext) != 1 ||
+       EVP_DigestUpdate(cc->mdContext, message->data, message->length) != 1 ||
+       EVP_DigestFinal_ex(cc->mdContext, innerHash, NULL) != 1 ||
+       EVP_MD_CTX_copy_ex(cc->mdContext, cc->outerHmacContext) != 1 ||
+       EVP_DigestUpdate(cc->mdContext, innerHash, UA_SHA256_LENGTH) != 1 ||
+       EVP_DigestFinal_ex(cc->mdContext, out, NULL) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Signature and verify all using HMAC-SHA2-256 */
+static UA_StatusCode
+verify_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                           const UA_ByteString *message,
+                           const UA_ByteString *signature) {
+    if(cc == NULL || message == NULL || signature == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    if(signature->length != UA_SHA256_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    /* Compute MAC */
+    UA_Byte mac[UA_SHA256_LENGTH];
+    UA_StatusCode res = hmac_sp_pubsub_aes256ctr(cc, message, mac);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Compare with Signature */
+    if(!UA_constantTimeEqual(signature->data, mac, UA_SHA256_LENGTH))
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+sign_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                         const UA_ByteString *message, UA_ByteString *signature) {
+    if(signature->length != UA_SHA256_LENGTH)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return hmac_sp_pubsub_aes256ctr(cc, message, signature->data);
+}
+
+static size_t
+getSignatureSize_sp_pubsub_aes256ctr(const void *channelContext) {
+    return UA_SHA256_LENGTH;
+}
+
+static size_t
+getSigningKeyLength_sp_pubsub_aes256ctr(const void *const channelContext) {
+    return UA_AES256CTR_SIGNING_KEY_LENGTH;
+}
+
+static size_t
+getEncryptionKeyLength_sp_pubsub_aes256ctr(const void *channelContext) {
+    return UA_AES256CTR_KEY_LENGTH;
+}
+
+static size_t
+getEncryptionBlockSize_sp_pubsub_aes256ctr(const void *channelContext) {
+    return UA_AES256CTR_ENCRYPTION_BLOCK_SIZE;
+}
+
+static size_t
+getPlainTextBlockSize_sp_pubsub_aes256ctr(const void *channelContext) {
+    return UA_AES256CTR_PLAIN_TEXT_BLOCK_SIZE;
+}
+
+static UA_StatusCode
+encrypt_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                            UA_ByteString *data) {
+    if(cc == NULL || data == NULL || data->length > INT_MAX)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* counter block = keynonce (4 Byte) + messagenonce (8 Byte) + counter (4
+     * Byte). See Part 14, 7.2.2.2.3.2 for details. */
+    UA_Byte counterBlock[UA_AES256CTR_ENCRYPTION_BLOCK_SIZE];
+    memcpy(counterBlock, cc->keyNonce, UA_AES256CTR_KEYNONCE_LENGTH);
+    memcpy(counterBlock + UA_AES256CTR_KEYNONCE_LENGTH,
+           cc->messageNonce, UA_AES256CTR_MESSAGENONCE_LENGTH);
+    memset(counterBlock + UA_AES256CTR_KEYNONCE_LENGTH +
+           UA_AES256CTR_MESSAGENONCE_LENGTH, 0, 4);
+
+    /* Only set the IV. The key schedule is kept in the context. CTR mode does
+     * not need padding and can be done in-place. */
+    int outLength = 0;
+    if(EVP_EncryptInit_ex(cc->cipherContext, NULL, NULL, NULL, counterBlock) != 1 ||
+       EVP_EncryptUpdate(cc->cipherContext, data->data, &outLength,
+                         data->data, (int)data->length) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* a decryption function is exactly the same as an encryption one, since they
+ * all do XOR operations */
+static UA_StatusCode
+decrypt_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                            UA_ByteString *data) {
+    return encrypt_sp_pubsub_aes256ctr(cc, data);
+}
+
+static UA_StatusCode
+generateKey_sp_pubsub_aes256ctr(void *policyContext, const UA_ByteString *secret,
+                                const UA_ByteString *seed, UA_ByteString *out) {
+    if(policyContext == NULL || secret == NULL || seed == NULL || out == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_Openssl_Random_Key_PSHA256_Derive(secret, seed, out);
+}
+
+/* This nonce does not need to be a cryptographically random number, it can be
+ * pseudo-random */
+static UA_StatusCode
+generateNonce_sp_pubsub_aes256ctr(void *policyContext, UA_ByteString *out) {
+    if(policyContext == NULL || out == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(RAND_bytes(out->data, (int)out->length) != 1)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/*****************/
+/* ChannelModule */
+/*****************/
+
+/* Key the cipher and the HMAC. This is done once for every key and not for
+ * every message. */
+static UA_StatusCode
+updateKeys_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                               const UA_Byte *signingKey,
+                               const UA_Byte *encryptingKey) {
+    if(EVP_EncryptInit_ex(cc->cipherContext, EVP_aes_256_ctr(), NULL,
+                          encryptingKey, NULL) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_Byte innerPad[UA_SHA256_BLOCK_SIZE];
+    UA_Byte outerPad[UA_SHA256_BLOCK_SIZE];
+    memset(innerPad, 0x36, UA_SHA256_BLOCK_SIZE);
+    memset(outerPad, 0x5c, UA_SHA256_BLOCK_SIZE);
+    for(size_t i = 0; i < UA_AES256CTR_SIGNING_KEY_LENGTH; i++) {
+        innerPad[i] ^= signingKey[i];
+        outerPad[i] ^= signingKey[i];
+    }
+    int ok =
+        EVP_DigestInit_ex(cc->innerHmacContext, EVP_sha256(), NULL) == 1 &&
+        EVP_DigestUpdate(cc->innerHmacContext, innerPad, UA_SHA256_BLOCK_SIZE) == 1 &&
+        EVP_DigestInit_ex(cc->outerHmacContext, EVP_sha256(), NULL) == 1 &&
+        EVP_DigestUpdate(cc->outerHmacContext, outerPad, UA_SHA256_BLOCK_SIZE) == 1;
+    OPENSSL_cleanse(innerPad, UA_SHA256_BLOCK_SIZE);
+    OPENSSL_cleanse(outerPad, UA_SHA256_BLOCK_SIZE);
+    return ok ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+static void
+channelContext_deleteContext_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc) {
+    EVP_CIPHER_CTX_free(cc->cipherContext);
+    EVP_MD_CTX_destroy(cc->innerHmacContext);
+    EVP_MD_CTX_destroy(cc->outerHmacContext);
+    EVP_MD_CTX_destroy(cc->mdContext);
+    UA_free(cc);
+}
+
+static UA_StatusCode
+channelContext_newContext_sp_pubsub_aes256ctr(void *policyContext,
+                                              const UA_ByteString *signingKey,
+                                              const UA_ByteString *encryptingKey,
+                                              const UA_ByteString *keyNonce,
+                                              void **wgContext) {
+    if((signingKey && signingKey->length != UA_AES256CTR_SIGNING_KEY_LENGTH) ||
+       (encryptingKey && encryptingKey->length != UA_AES256CTR_KEY_LENGTH) ||
+       (keyNonce && keyNonce->length != UA_AES256CTR_KEYNONCE_LENGTH))
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+
+    /* Allocate the channel context */
+    PUBSUB_AES256CTR_ChannelContext *cc = (PUBSUB_AES256CTR_ChannelContext *)
+        UA_calloc(1, sizeof(PUBSUB_AES256CTR_ChannelContext));
+    if(cc == NULL)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    cc->policyContext = (PUBSUB_AES256CTR_PolicyContext *)policyContext;
+    cc->cipherContext = EVP_CIPHER_CTX_new();
+    cc->innerHmacContext = EVP_MD_CTX_create();
+    cc->outerHmacContext = EVP_MD_CTX_create();
+    cc->mdContext = EVP_MD_CTX_create();
+    if(!cc->cipherContext || !cc->innerHmacContext ||
+       !cc->outerHmacContext || !cc->mdContext) {
+        channelContext_deleteContext_sp_pubsub_aes256ctr(cc);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    /* Initialize the channel context. Missing keys are zero until they are set
+     * with setSecurityKeys. */
+    UA_Byte sk[UA_AES256CTR_SIGNING_KEY_LENGTH] = {0};
+    UA_Byte ek[UA_AES256CTR_KEY_LENGTH] = {0};
+    if(signingKey)
+        memcpy(sk, signingKey->data, signingKey->length);
+    if(encryptingKey)
+        memcpy(ek, encryptingKey->data, encryptingKey->length);
+    if(keyNonce)
+        memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
+    UA_StatusCode res = updateKeys_sp_pubsub_aes256ctr(cc, sk, ek);
+    if(res != UA_STATUSCODE_GOOD) {
+        channelContext_deleteContext_sp_pubsub_aes256ctr(cc);
+        return res;
+    }
+
+    *wgContext = cc;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+channelContext_setKeys_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                                           const UA_ByteString *signingKey,
+                                           const UA_ByteString *encryptingKey,
+                                           const UA_ByteString *keyNonce) {
+    if(!cc)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(!signingKey || signingKey->length != UA_AES256CTR_SIGNING_KEY_LENGTH ||
+       !encryptingKey || encryptingKey->length != UA_AES256CTR_KEY_LENGTH ||
+       !keyNonce || keyNonce->length != UA_AES256CTR_KEYNONCE_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
+    return updateKeys_sp_pubsub_aes256ctr(cc, signingKey->data, encryptingKey->data);
+}
+
+static UA_StatusCode
+channelContext_setMessageNonce_sp_pubsub_aes256ctr(PUBSUB_AES256CTR_ChannelContext *cc,
+                                                   const UA_ByteString *nonce) {
+    if(nonce->length != UA_AES256CTR_MESSAGENONCE_LENGTH)
+        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    memcpy(cc->messageNonce, nonce->data, nonce->length);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_sp_pubsub_aes256ctr(UA_PubSubSecurityPolicy *securityPolicy) {
+    if(securityPolicy == NULL || securityPolicy->policyContext == NULL)
+        return;
+    UA_free(securityPolicy->policyContext);
+    securityPolicy->policyContext = NULL;
+}
+
+UA_StatusCode
+UA_PubSubSecurityPolicy_Aes256Ctr(UA_PubSubSecurityPolicy *policy,
+                                  const UA_Logger *logger) {
+    UA_Openssl_Init();
+    memset(policy, 0, sizeof(UA_PubSubSecurityPolicy));
+    policy->logger = logger;
+
+    policy->policyUri =
+        UA_STRING("http://opcfoundation.org/UA/SecurityPolicy#PubSub-Aes256-CTR");
+
+    UA_SecurityPolicySymmetricModule *symmetricModule = &policy->symmetricModule;
+
+    /* SymmetricModule */
+    symmetricModule->generateKey = generateKey_sp_pubsub_aes256ctr;
+    symmetricModule->generateNonce = generateNonce_sp_pubsub_aes256ctr;
+
+    UA_SecurityPolicySignatureAlgorithm *signatureAlgorithm =
+        &symmetricModule->cryptoModule.signatureAlgorithm;
+    signatureAlgorithm->uri = UA_STRING("http://www.w3.org/2001/04/xmlenc#sha256");
+    signatureAlgorithm->verify =
+        (UA_StatusCode(*)(void *, const UA_ByteString *,
+                          const UA_ByteString *))verify_sp_pubsub_aes256ctr;
+    signatureAlgorithm->sign =
+        (UA_StatusCode(*)(void *, const UA_ByteString *, UA_ByteString *))sign_sp_pubsub_aes256ctr;
+    signatureAlgorithm->getLocalSignatureSize = getSignatureSize_sp_pubsub_aes256ctr;
+    signatureAlgorithm->getRemoteSignatureSize = getSignatureSize_sp_pubsub_aes256ctr;
+    signatureAlgorithm->getLocalKeyLength =
+        (size_t(*)(const void *))getSigningKeyLength_sp_pubsub_aes256ctr;
+    signatureAlgorithm->getRemoteKeyLength =
+        (size_t(*)(const void *))getSigningKeyLength_sp_pubsub_aes256ctr;
+
+    UA_SecurityPolicyEncryptionAlgorithm *encryptionAlgorithm =
+        &symmetricModule->cryptoModule.encryptionAlgorithm;
+    encryptionAlgorithm->uri =
+        UA_STRING("https://tools.ietf.org/html/rfc3686"); /* Temp solution */
+    encryptionAlgorithm->encrypt =
+        (UA_StatusCode(*)(void *, UA_ByteString *))encrypt_sp_pubsub_aes256ctr;
+    encryptionAlgorithm->decrypt =
+        (UA_StatusCode(*)(void *, UA_ByteString *))decrypt_sp_pubsub_aes256ctr;
+    encryptionAlgorithm->getLocalKeyLength =
+        getEncryptionKeyLength_sp_pubsub_aes256ctr;
+    encryptionAlgorithm->getRemoteKeyLength =
+        getEncryptionKeyLength_sp_pubsub_aes256ctr;
+    encryptionAlgorithm->getRemoteBlockSize =
+        (size_t(*)(const void *))getEncryptionBlockSize_sp_pubsub_aes256ctr;
+    encryptionAlgorithm->getRemotePlainTextBlockSize =
+        (size_t(*)(const void *))getPlainTextBlockSize_sp_pubsub_aes256ctr;
+    symmetricModule->secureChannelNonceLength = UA_AES256CTR_SIGNING_KEY_LENGTH +
+        UA_AES256CTR_KEY_LENGTH + UA_AES256CTR_KEYNONCE_LENGTH;
+
+    /* ChannelModule */
+    policy->newContext = channelContext_newContext_sp_pubsub_aes256ctr;
+    policy->deleteContext = (void (*)(void *))
+        channelContext_deleteContext_sp_pubsub_aes256ctr;
+
+    policy->setSecurityKeys = (UA_StatusCode(*)(void *, const UA_ByteString *,
+                                                const UA_ByteString *,
+                                                const UA_ByteString *))
+            channelContext_setKeys_sp_pubsub_aes256ctr;
+    policy->setMessageNonce = (UA_StatusCode(*)(void *, const UA_ByteString *))
+        channelContext_setMessageNonce_sp_pubsub_aes256ctr;
+    policy->clear = deleteMembers_sp_pubsub_aes256ctr;
+
+    /* Initialize the policyContext */
+    PUBSUB_AES256CTR_PolicyContext *pc = (PUBSUB_AES256CTR_PolicyContext *)
+        UA_calloc(1, sizeof(PUBSUB_AES256CTR_PolicyContext));
+    if(!pc) {
+        UA_LOG_ERROR(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                     "Could not create securityContext");
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    pc->securityPolicy = policy;
+    policy->policyContext = pc;
+    return UA_STATUSCODE_GOOD;
+}
+
+#endif
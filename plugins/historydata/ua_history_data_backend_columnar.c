@@ -0,0 +1,820 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+
+#include "ua_history_data_backend_nodemap.h"
+
+#include <string.h>
+
+/* Every sample is spread over the columns of the node store at the same
+ * position. The ordering key is the source timestamp (or the server timestamp,
+ * or the time of insertion if the DataValue has no timestamp). The source
+ * timestamp is therefore not stored separately. */
+
+#define UA_COLUMNAR_HASVALUE      0x01
+#define UA_COLUMNAR_HASSTATUS     0x02
+#define UA_COLUMNAR_HASSOURCETIME 0x04
+#define UA_COLUMNAR_HASSERVERTIME 0x08
+#define UA_COLUMNAR_HASSOURCEPICO 0x10
+#define UA_COLUMNAR_HASSERVERPICO 0x20
+
+typedef struct {
+    UA_StatusCode status;
+    UA_UInt16 sourcePicoseconds;
+    UA_UInt16 serverPicoseconds;
+    UA_Byte flags;
+} UA_ColumnarSampleInfo;
+
+typedef struct {
+    UA_NodeId nodeId;
+
+    /* Ring-buffer. The logical index i is stored at position
+     * (head + i) % capacity of every column. */
+    size_t head;
+    size_t count;
+    size_t capacity;
+
+    /* Columns */
+    UA_DateTime *keys;
+    UA_DateTime *serverTimestamps;
+    UA_ColumnarSampleInfo *info;
+
+    /* The value column contains unboxed scalars of valueType. If the samples
+     * are not all scalars of the same numeric type, the column switches to
+     * UA_Variant. NULL as long as no sample with a value was added. */
+    const UA_DataType *valueType;
+    void *values;
+
+    /* Returned by getDataValue. Points into the columns. */
+    UA_DataValue current;
+} UA_ColumnarNodeStore;
+
+typedef struct {
+    UA_HistoryNodeMap nodes;
+    size_t maxValuesPerNode;
+    UA_ColumnarNodeStore empty; /* Used for NodeIds without a store */
+} UA_ColumnarStoreContext;
+
+#define UA_COLUMNAR_VARIANT (&UA_TYPES[UA_TYPES_VARIANT])
+
+/* Returns the store of the NodeId. If the NodeId is unknown, a new store is
+ * created or, if create is false, an empty store is returned. Returns NULL only
+ * if out of memory. */
+static UA_ColumnarNodeStore *
+getNodeStore(UA_ColumnarStoreContext *ctx, const UA_NodeId *nodeId,
+             UA_Boolean create) {
+    UA_ColumnarNodeStore *store = (UA_ColumnarNodeStore*)
+        UA_HistoryNodeMap_find(&ctx->nodes, nodeId);
+    if(store)
+        return store;
+    if(!create)
+        return &ctx->empty;
+
+    store = (UA_ColumnarNodeStore*)UA_calloc(1, sizeof(UA_ColumnarNodeStore));
+    if(!store)
+        return NULL;
+    if(UA_NodeId_copy(nodeId, &store->nodeId) != UA_STATUSCODE_GOOD ||
+       UA_HistoryNodeMap_insert(&ctx->nodes, &store->nodeId, store) != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&store->nodeId);
+        UA_free(store);
+        return NULL;
+    }
+    return store;
+}
+
+/**********************/
+/* Column Utilities   */
+/**********************/
+
+static size_t
+pos(const UA_ColumnarNodeStore *s, size_t i) {
+    size_t p = s->head + i;
+    if(p >= s->capacity)
+        p -= s->capacity;
+    return p;
+}
+
+static UA_DateTime
+key(const UA_ColumnarNodeStore *s, size_t i) {
+    return s->keys[pos(s, i)];
+}
+
+static void *
+valueAt(const UA_ColumnarNodeStore *s, size_t p) {
+    return (void*)((uintptr_t)s->values + (p * s->valueType->memSize));
+}
+
+/* Numeric builtin types without dynamic members are stored unboxed */
+static const UA_DataType *
+unboxedType(const UA_DataValue *value) {
+    if(!UA_Variant_isScalar(&value->value))
+        return NULL;
+    const UA_DataType *type = value->value.type;
+    if(!type)
+        return NULL;
+    if(type->typeKind <= UA_DATATYPEKIND_DOUBLE ||
+       type->typeKind == UA_DATATYPEKIND_DATETIME ||
+       type->typeKind == UA_DATATYPEKIND_STATUSCODE)
+        return type;
+    return NULL;
+}
+
+/* First index with a key >= timestamp */
+static size_t
+lowerBound(const UA_ColumnarNodeStore *s, UA_DateTime timestamp) {
+    size_t low = 0;
+    size_t high = s->count;
+    while(low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if(key(s, mid) < timestamp)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/* First index with a key > timestamp */
+static size_t
+upperBound(const UA_ColumnarNodeStore *s, UA_DateTime timestamp) {
+    size_t low = 0;
+    size_t high = s->count;
+    while(low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if(key(s, mid) <= timestamp)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static void
+clearSample(UA_ColumnarNodeStore *s, size_t p) {
+    if(s->valueType == UA_COLUMNAR_VARIANT)
+        UA_Variant_clear((UA_Variant*)valueAt(s, p));
+}
+
+static void
+moveSample(UA_ColumnarNodeStore *s, size_t dst, size_t src) {
+    s->keys[dst] = s->keys[src];
+    s->serverTimestamps[dst] = s->serverTimestamps[src];
+    s->info[dst] = s->info[src];
+    if(s->valueType)
+        memcpy(valueAt(s, dst), valueAt(s, src), s->valueType->memSize);
+}
+
+/* Copy the ring-buffer column into dst starting at position zero */
+static void
+linearize(void *dst, const void *src, size_t elemSize,
+          const UA_ColumnarNodeStore *s) {
+    if(s->count == 0)
+        return;
+    size_t first = s->capacity - s->head;
+    if(first > s->count)
+        first = s->count;
+    memcpy(dst, (const void*)((uintptr_t)src + (s->head * elemSize)), first * elemSize);
+    memcpy((void*)((uintptr_t)dst + (first * elemSize)), src, (s->count - first) * elemSize);
+}
+
+static UA_StatusCode
+grow(UA_ColumnarNodeStore *s, size_t maxValues) {
+    size_t ncap = (s->capacity == 0) ? INITIAL_COLUMNAR_STORE_SIZE : s->capacity * 2;
+    if(maxValues > 0 && ncap > maxValues)
+        ncap = maxValues;
+
+    UA_DateTime *keys = (UA_DateTime*)UA_malloc(ncap * sizeof(UA_DateTime));
+    UA_DateTime *serverTimestamps = (UA_DateTime*)UA_malloc(ncap * sizeof(UA_DateTime));
+    UA_ColumnarSampleInfo *info = (UA_ColumnarSampleInfo*)
+        UA_malloc(ncap * sizeof(UA_ColumnarSampleInfo));
+    void *values = NULL;
+    if(s->valueType)
+        values = UA_calloc(ncap, s->valueType->memSize);
+    if(!keys || !serverTimestamps || !info || (s->valueType && !values)) {
+        UA_free(keys);
+        UA_free(serverTimestamps);
+        UA_free(info);
+        UA_free(values);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    linearize(keys, s->keys, sizeof(UA_DateTime), s);
+    linearize(serverTimestamps, s->serverTimestamps, sizeof(UA_DateTime), s);
+    linearize(info, s->info, sizeof(UA_ColumnarSampleInfo), s);
+    if(s->valueType)
+        linearize(values, s->values, s->valueType->memSize, s);
+
+    UA_free(s->keys);
+    UA_free(s->serverTimestamps);
+    UA_free(s->info);
+    UA_free(s->values);
+    s->keys = keys;
+    s->serverTimestamps = serverTimestamps;
+    s->info = info;
+    s->values = values;
+    s->capacity = ncap;
+    s->head = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Replace the unboxed value column with a column of variants */
+static UA_StatusCode
+boxValues(UA_ColumnarNodeStore *s) {
+    UA_Variant *variants = (UA_Variant*)UA_calloc(s->capacity, sizeof(UA_Variant));
+    if(!variants && s->capacity > 0)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < s->count; i++) {
+        size_t p = pos(s, i);
+        if(!(s->info[p].flags & UA_COLUMNAR_HASVALUE))
+            continue;
+        retval = UA_Variant_setScalarCopy(&variants[p], valueAt(s, p), s->valueType);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_Array_delete(variants, s->capacity, UA_COLUMNAR_VARIANT);
+            return retval;
+        }
+    }
+    UA_free(s->values);
+    s->values = variants;
+    s->valueType = UA_COLUMNAR_VARIANT;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Adjust the value column for the new sample. For boxed values, the variant is
+ * copied into *boxed. The samples in the store are unchanged if this fails. */
+static UA_StatusCode
+prepareValue(UA_ColumnarNodeStore *s, const UA_DataValue *value, UA_Variant *boxed) {
+    UA_Variant_init(boxed);
+    if(!value->hasValue)
+        return UA_STATUSCODE_GOOD;
+
+    const UA_DataType *type = unboxedType(value);
+    if(!s->valueType) {
+        /* The first value decides the column type */
+        const UA_DataType *columnType = type ? type : UA_COLUMNAR_VARIANT;
+        if(s->capacity > 0) {
+            s->values = UA_calloc(s->capacity, columnType->memSize);
+            if(!s->values)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        s->valueType = columnType;
+    } else if(s->valueType != UA_COLUMNAR_VARIANT && s->valueType != type) {
+        UA_StatusCode retval = boxValues(s);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+
+    if(s->valueType == UA_COLUMNAR_VARIANT)
+        return UA_Variant_copy(&value->value, boxed);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Write the sample at position p. Takes ownership of the boxed variant. */
+static void
+writeSample(UA_ColumnarNodeStore *s, size_t p, UA_DateTime timestamp,
+            const UA_DataValue *value, UA_Variant *boxed) {
+    s->keys[p] = timestamp;
+    s->serverTimestamps[p] = value->serverTimestamp;
+    UA_ColumnarSampleInfo *info = &s->info[p];
+    info->status = value->status;
+    info->sourcePicoseconds = value->sourcePicoseconds;
+    info->serverPicoseconds = value->serverPicoseconds;
+    info->flags = 0;
+    if(value->hasValue)
+        info->flags |= UA_COLUMNAR_HASVALUE;
+    if(value->hasStatus)
+        info->flags |= UA_COLUMNAR_HASSTATUS;
+    if(value->hasSourceTimestamp)
+        info->flags |= UA_COLUMNAR_HASSOURCETIME;
+    if(value->hasServerTimestamp)
+        info->flags |= UA_COLUMNAR_HASSERVERTIME;
+    if(value->hasSourcePicoseconds)
+        info->flags |= UA_COLUMNAR_HASSOURCEPICO;
+    if(value->hasServerPicoseconds)
+        info->flags |= UA_COLUMNAR_HASSERVERPICO;
+
+    if(!s->valueType)
+        return;
+    void *dst = valueAt(s, p);
+    if(!value->hasValue)
+        memset(dst, 0, s->valueType->memSize);
+    else if(s->valueType == UA_COLUMNAR_VARIANT)
+        *(UA_Variant*)dst = *boxed;
+    else
+        memcpy(dst, value->value.data, s->valueType->memSize);
+}
+
+/* Fill a DataValue that points into the columns. Must not be cleared. */
+static void
+readSample(const UA_ColumnarNodeStore *s, size_t p, UA_DataValue *dv) {
+    UA_DataValue_init(dv);
+    const UA_ColumnarSampleInfo *info = &s->info[p];
+    dv->hasStatus = (info->flags & UA_COLUMNAR_HASSTATUS) != 0;
+    dv->status = info->status;
+    dv->hasSourceTimestamp = (info->flags & UA_COLUMNAR_HASSOURCETIME) != 0;
+    if(dv->hasSourceTimestamp)
+        dv->sourceTimestamp = s->keys[p];
+    dv->hasServerTimestamp = (info->flags & UA_COLUMNAR_HASSERVERTIME) != 0;
+    dv->serverTimestamp = s->serverTimestamps[p];
+    dv->hasSourcePicoseconds = (info->flags & UA_COLUMNAR_HASSOURCEPICO) != 0;
+    dv->sourcePicoseconds = info->sourcePicoseconds;
+    dv->hasServerPicoseconds = (info->flags & UA_COLUMNAR_HASSERVERPICO) != 0;
+    dv->serverPicoseconds = info->serverPicoseconds;
+    if(!(info->flags & UA_COLUMNAR_HASVALUE))
+        return;
+    dv->hasValue = true;
+    if(s->valueType == UA_COLUMNAR_VARIANT)
+        dv->value = *(const UA_Variant*)valueAt(s, p);
+    else
+        UA_Variant_setScalar(&dv->value, valueAt(s, p), s->valueType);
+    dv->value.storageType = UA_VARIANT_DATA_NODELETE;
+}
+
+/* Insert the sample at the logical index. The samples before or after are
+ * shifted, whichever are fewer. */
+static UA_StatusCode
+insertSample(UA_ColumnarStoreContext *ctx, UA_ColumnarNodeStore *s, size_t index,
+             UA_DateTime timestamp, const UA_DataValue *value) {
+    UA_Variant boxed;
+    UA_StatusCode retval = prepareValue(s, value, &boxed);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    if(s->count == s->capacity) {
+        if(ctx->maxValuesPerNode == 0 || s->capacity < ctx->maxValuesPerNode) {
+            retval = grow(s, ctx->maxValuesPerNode);
+            if(retval != UA_STATUSCODE_GOOD) {
+                UA_Variant_clear(&boxed);
+                return retval;
+            }
+        } else {
+            /* The ring-buffer is full. Drop the oldest sample. If the new
+             * sample would be the oldest, it is dropped right away. */
+            if(index == 0) {
+                UA_Variant_clear(&boxed);
+                return UA_STATUSCODE_GOOD;
+            }
+            clearSample(s, s->head);
+            s->head = pos(s, 1);
+            s->count--;
+            index--;
+        }
+    }
+
+    if(index < s->count / 2) {
+        s->head = (s->head == 0) ? s->capacity - 1 : s->head - 1;
+        for(size_t i = 0; i < index; i++)
+            moveSample(s, pos(s, i), pos(s, i + 1));
+    } else {
+        for(size_t i = s->count; i > index; i--)
+            moveSample(s, pos(s, i), pos(s, i - 1));
+    }
+    writeSample(s, pos(s, index), timestamp, value, &boxed);
+    s->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Remove the samples in the logical range [index1, index2) */
+static void
+removeSamples(UA_ColumnarNodeStore *s, size_t index1, size_t index2) {
+    size_t n = index2 - index1;
+    for(size_t i = index1; i < index2; i++)
+        clearSample(s, pos(s, i));
+    if(index1 == 0) {
+        s->head = pos(s, index2);
+    } else {
+        for(size_t i = index2; i < s->count; i++)
+            moveSample(s, pos(s, i - n), pos(s, i));
+    }
+    s->count -= n;
+    if(s->count > 0)
+        return;
+
+    /* Start over. The next value decides the column type again. */
+    s->head = 0;
+    UA_free(s->values);
+    s->values = NULL;
+    s->valueType = NULL;
+}
+
+static void
+UA_ColumnarNodeStore_clear(UA_ColumnarNodeStore *s) {
+    for(size_t i = 0; i < s->count; i++)
+        clearSample(s, pos(s, i));
+    UA_free(s->keys);
+    UA_free(s->serverTimestamps);
+    UA_free(s->info);
+    UA_free(s->values);
+    UA_NodeId_clear(&s->nodeId);
+    memset(s, 0, sizeof(UA_ColumnarNodeStore));
+}
+
+static void
+UA_ColumnarStoreContext_clear(UA_ColumnarStoreContext *ctx) {
+    for(size_t i = 0; i < ctx->nodes.size; i++) {
+        UA_ColumnarNodeStore *s = (UA_ColumnarNodeStore*)ctx->nodes.slots[i].entry;
+        if(!s)
+            continue;
+        UA_ColumnarNodeStore_clear(s);
+        UA_free(s);
+    }
+    UA_HistoryNodeMap_clear(&ctx->nodes);
+    memset(ctx, 0, sizeof(UA_ColumnarStoreContext));
+}
+
+/***********/
+/* Backend */
+/***********/
+
+static size_t
+resultSize_backend_columnar(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex) {
+    const UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false);
+    if(s->count == 0 || startIndex == s->count || endIndex == s->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_columnar(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  const UA_DateTime timestamp,
+                                  const MatchStrategy strategy) {
+    const UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false);
+    size_t index;
+    switch(strategy) {
+    case MATCH_EQUAL:
+        index = lowerBound(s, timestamp);
+        if(index < s->count && key(s, index) == timestamp)
+            return index;
+        return s->count;
+    case MATCH_AFTER:
+        return upperBound(s, timestamp);
+    case MATCH_EQUAL_OR_AFTER:
+        return lowerBound(s, timestamp);
+    case MATCH_EQUAL_OR_BEFORE:
+        index = upperBound(s, timestamp);
+        break;
+    case MATCH_BEFORE:
+        index = lowerBound(s, timestamp);
+        break;
+    default:
+        return s->count;
+    }
+    return (index > 0) ? index - 1 : s->count;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_columnar(UA_Server *server,
+                                      void *context,
+                                      const UA_NodeId *sessionId,
+                                      void *sessionContext,
+                                      const UA_NodeId *nodeId,
+                                      UA_Boolean historizing,
+                                      const UA_DataValue *value) {
+    UA_ColumnarStoreContext *ctx = (UA_ColumnarStoreContext*)context;
+    UA_ColumnarNodeStore *s = getNodeStore(ctx, nodeId, true);
+    if(!s)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_DateTime timestamp;
+    if(value->hasSourceTimestamp)
+        timestamp = value->sourceTimestamp;
+    else if(value->hasServerTimestamp)
+        timestamp = value->serverTimestamp;
+    else
+        timestamp = UA_DateTime_now();
+
+    /* Fast path for appending. Otherwise insert before equal timestamps. */
+    size_t index = s->count;
+    if(s->count > 0 && timestamp < key(s, s->count - 1))
+        index = lowerBound(s, timestamp);
+    return insertSample(ctx, s, index, timestamp, value);
+}
+
+static size_t
+getEnd_backend_columnar(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false)->count;
+}
+
+static size_t
+lastIndex_backend_columnar(UA_Server *server,
+                           void *context,
+                           const UA_NodeId *sessionId,
+                           void *sessionContext,
+                           const UA_NodeId *nodeId) {
+    const UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false);
+    if(s->count == 0)
+        return 0;
+    return s->count - 1;
+}
+
+static size_t
+firstIndex_backend_columnar(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static UA_Boolean
+boundSupported_backend_columnar(UA_Server *server,
+                                void *context,
+                                const UA_NodeId *sessionId,
+                                void *sessionContext,
+                                const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_columnar(UA_Server *server,
+                                             void *context,
+                                             const UA_NodeId *sessionId,
+                                             void *sessionContext,
+                                             const UA_NodeId *nodeId,
+                                             const UA_TimestampsToReturn timestampsToReturn) {
+    const UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false);
+    if(s->count == 0)
+        return true;
+    UA_Byte flags = s->info[s->head].flags;
+    UA_Boolean hasSource = (flags & UA_COLUMNAR_HASSOURCETIME) != 0;
+    UA_Boolean hasServer = (flags & UA_COLUMNAR_HASSERVERTIME) != 0;
+    switch(timestampsToReturn) {
+    case UA_TIMESTAMPSTORETURN_SOURCE:
+        return hasSource;
+    case UA_TIMESTAMPSTORETURN_SERVER:
+        return hasServer;
+    case UA_TIMESTAMPSTORETURN_BOTH:
+        return hasSource && hasServer;
+    default:
+        return false;
+    }
+}
+
+static const UA_DataValue *
+getDataValue_backend_columnar(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              size_t index) {
+    UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false);
+    if(index >= s->count)
+        return NULL;
+    readSample(s, pos(s, index), &s->current);
+    return &s->current;
+}
+
+static UA_StatusCode
+copySample(const UA_ColumnarNodeStore *s, size_t index,
+           const UA_NumericRange range, UA_DataValue *dst) {
+    UA_DataValue sample;
+    readSample(s, pos(s, index), &sample);
+    if(range.dimensionsSize == 0)
+        return UA_DataValue_copy(&sample, dst);
+    *dst = sample;
+    UA_Variant_init(&dst->value);
+    if(!sample.hasValue)
+        return UA_STATUSCODE_GOOD;
+    UA_StatusCode res = UA_Variant_copyRange(&sample.value, &dst->value, range);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_DataValue_init(dst);
+    return res;
+}
+
+static UA_StatusCode
+copyDataValues_backend_columnar(UA_Server *server,
+                                void *context,
+                                const UA_NodeId *sessionId,
+                                void *sessionContext,
+                                const UA_NodeId *nodeId,
+                                size_t startIndex,
+                                size_t endIndex,
+                                UA_Boolean reverse,
+                                size_t maxValues,
+                                UA_NumericRange range,
+                                UA_Boolean releaseContinuationPoints,
+                                const UA_ByteString *continuationPoint,
+                                UA_ByteString *outContinuationPoint,
+                                size_t *providedValues,
+                                UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+    }
+
+    const UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)context, nodeId, false);
+    size_t total;
+    size_t index;
+    if(reverse) {
+        if(startIndex >= s->count || endIndex > startIndex)
+            total = 0;
+        else
+            total = startIndex - endIndex + 1;
+        index = startIndex - skip;
+    } else {
+        if(endIndex >= s->count || startIndex > endIndex)
+            total = 0;
+        else
+            total = endIndex - startIndex + 1;
+        index = startIndex + skip;
+    }
+
+    /* The sample positions are contiguous. No need to search. */
+    size_t counter = 0;
+    for(; skip + counter < total && counter < maxValues; counter++) {
+        UA_StatusCode res = copySample(s, index, range, &values[counter]);
+        if(res != UA_STATUSCODE_GOOD) {
+            /* Don't return partial results */
+            for(size_t i = 0; i < counter; i++)
+                UA_DataValue_clear(&values[i]);
+            return res;
+        }
+        index = reverse ? index - 1 : index + 1;
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if(skip + counter < total) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        size_t next = skip + counter;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+insertDataValue_backend_columnar(UA_Server *server,
+                                 void *hdbContext,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId,
+                                 const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = value->hasSourceTimestamp ?
+        value->sourceTimestamp : value->serverTimestamp;
+    UA_ColumnarStoreContext *ctx = (UA_ColumnarStoreContext*)hdbContext;
+    UA_ColumnarNodeStore *s = getNodeStore(ctx, nodeId, true);
+    if(!s)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    size_t index = lowerBound(s, timestamp);
+    if(index < s->count && key(s, index) == timestamp)
+        return UA_STATUSCODE_BADENTRYEXISTS;
+    return insertSample(ctx, s, index, timestamp, value);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_columnar(UA_Server *server,
+                                  void *hdbContext,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    const UA_DateTime timestamp = value->hasSourceTimestamp ?
+        value->sourceTimestamp : value->serverTimestamp;
+    UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)hdbContext, nodeId, false);
+
+    size_t index = lowerBound(s, timestamp);
+    if(index == s->count || key(s, index) != timestamp)
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+
+    UA_Variant boxed;
+    UA_StatusCode retval = prepareValue(s, value, &boxed);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    size_t p = pos(s, index);
+    clearSample(s, p);
+    writeSample(s, p, timestamp, value, &boxed);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+updateDataValue_backend_columnar(UA_Server *server,
+                                 void *hdbContext,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId,
+                                 const UA_DataValue *value) {
+    // we first try to replace, because it is cheap
+    UA_StatusCode ret = replaceDataValue_backend_columnar(server, hdbContext, sessionId,
+                                                          sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+
+    ret = insertDataValue_backend_columnar(server, hdbContext, sessionId,
+                                           sessionContext, nodeId, value);
+    if(ret == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return ret;
+}
+
+static UA_StatusCode
+removeDataValue_backend_columnar(UA_Server *server,
+                                 void *hdbContext,
+                                 const UA_NodeId *sessionId,
+                                 void *sessionContext,
+                                 const UA_NodeId *nodeId,
+                                 UA_DateTime startTimestamp,
+                                 UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    UA_ColumnarNodeStore *s =
+        getNodeStore((UA_ColumnarStoreContext*)hdbContext, nodeId, false);
+
+    /* The first index which will be deleted */
+    size_t index1 = lowerBound(s, startTimestamp);
+    /* The first index which is not deleted */
+    size_t index2;
+    if(startTimestamp == endTimestamp) {
+        if(index1 == s->count || key(s, index1) != startTimestamp)
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        index2 = lowerBound(s, endTimestamp);
+        if(index1 >= index2)
+            return UA_STATUSCODE_BADNODATA;
+    }
+    removeSamples(s, index1, index2);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_backend_columnar(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_ColumnarStoreContext_clear((UA_ColumnarStoreContext*)backend->context);
+    UA_free(backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_Columnar(size_t initialNodeIdStoreSize,
+                               size_t maxValuesPerNode) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    UA_ColumnarStoreContext *ctx = (UA_ColumnarStoreContext*)
+        UA_calloc(1, sizeof(UA_ColumnarStoreContext));
+    if(!ctx)
+        return result;
+    if(UA_HistoryNodeMap_init(&ctx->nodes, initialNodeIdStoreSize) != UA_STATUSCODE_GOOD) {
+        UA_free(ctx);
+        return result;
+    }
+    ctx->maxValuesPerNode = maxValuesPerNode;
+    result.serverSetHistoryData = &serverSetHistoryData_backend_columnar;
+    result.resultSize = &resultSize_backend_columnar;
+    result.getEnd = &getEnd_backend_columnar;
+    result.lastIndex = &lastIndex_backend_columnar;
+    result.firstIndex = &firstIndex_backend_columnar;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_columnar;
+    result.copyDataValues = &copyDataValues_backend_columnar;
+    result.getDataValue = &getDataValue_backend_columnar;
+    result.boundSupported = &boundSupported_backend_columnar;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_columnar;
+    result.insertDataValue = &insertDataValue_backend_columnar;
+    result.updateDataValue = &updateDataValue_backend_columnar;
+    result.replaceDataValue = &replaceDataValue_backend_columnar;
+    result.removeDataValue = &removeDataValue_backend_columnar;
+    result.deleteMembers = &deleteMembers_backend_columnar;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_Columnar_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_columnar(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
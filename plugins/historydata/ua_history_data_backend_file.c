@@ -0,0 +1,1029 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+
+#include "ua_history_data_backend_nodemap.h"
+#include "ua_types_encoding_binary.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Layout on disk:
+ *
+ * <directory>/nodes        Append-only list of (number, binary NodeId)
+ * <directory>/<number>/    One directory per node
+ *     <seq>.seg            Segment files with increasing sequence numbers
+ *
+ * A segment file starts with a header, followed by the records. A record is
+ * the record header and the binary-encoded DataValue, padded to 8 bytes. The
+ * records in a segment and across the segments of a node are ordered by their
+ * timestamp. A record becomes visible when the count in the segment header is
+ * increased after it was written. The record pages are flushed to disk before
+ * the count is increased. Every record carries a CRC over its header and
+ * payload. On loading, the records are verified and the segment is cut off at
+ * the first record that was not written completely. */
+
+#define UA_HISTORYFILE_MAGIC 0x53484155 /* "UAHS" */
+#define UA_HISTORYFILE_VERSION 2
+#define UA_HISTORYFILE_HEADERSIZE 64
+#define UA_HISTORYFILE_INDEXSTRIDE 16 /* Records per sparse index entry */
+#define UA_HISTORYFILE_PATHSIZE 1024
+
+#define UA_HISTORYFILE_HASSOURCETIME 0x01
+#define UA_HISTORYFILE_HASSERVERTIME 0x02
+
+typedef struct {
+    UA_UInt32 magic;
+    UA_UInt32 version;
+    UA_UInt64 count;   /* Number of committed records */
+    UA_UInt64 end;     /* Offset after the last committed record */
+    UA_DateTime first; /* Timestamp of the first record */
+    UA_DateTime last;  /* Timestamp of the last record */
+} UA_FileSegmentHeader;
+
+typedef struct {
+    UA_DateTime timestamp;
+    UA_UInt32 length; /* Of the encoded DataValue */
+    UA_UInt32 flags;
+    UA_UInt32 crc;    /* Over the fields above and the encoded DataValue */
+    UA_UInt32 reserved;
+} UA_FileRecordHeader;
+
+typedef struct {
+    UA_DateTime timestamp;
+    size_t offset;
+} UA_FileIndexEntry;
+
+typedef struct {
+    UA_UInt64 seq;
+    UA_Byte *data; /* The mapped file */
+    size_t size;
+    size_t firstIndex; /* Index of the first record in the node history */
+
+    /* Sparse index. Entry k points to the record k * INDEXSTRIDE. */
+    UA_FileIndexEntry *index;
+    size_t indexSize;
+    size_t indexCapacity;
+} UA_FileSegment;
+
+typedef struct {
+    UA_NodeId nodeId;
+    UA_UInt32 number;
+    UA_Boolean loaded;
+    UA_FileSegment *segments;
+    size_t segmentsSize;
+    size_t count;
+
+    /* Returned by getDataValue. Decoded from the record. */
+    UA_DataValue current;
+} UA_FileNodeStore;
+
+typedef struct {
+    char *directory;
+    size_t segmentSize;
+    size_t maxSegmentsPerNode;
+    UA_Boolean syncEachSample;
+    int nodesFd;
+    UA_UInt32 nextNumber;
+
+    UA_HistoryNodeMap nodes;
+    UA_FileNodeStore empty; /* Used for NodeIds without history */
+} UA_FileStoreContext;
+
+static UA_FileSegmentHeader *
+segmentHeader(const UA_FileSegment *seg) {
+    return (UA_FileSegmentHeader*)seg->data;
+}
+
+static const UA_FileRecordHeader *
+recordAtOffset(const UA_FileSegment *seg, size_t offset) {
+    return (const UA_FileRecordHeader*)(seg->data + offset);
+}
+
+static size_t
+recordSize(size_t length) {
+    size_t size = sizeof(UA_FileRecordHeader) + length;
+    return (size + 7) & ~(size_t)7;
+}
+
+/* CRC-32 (IEEE 802.3) with a table of 16 entries, processing four bits at a
+ * time */
+static const UA_UInt32 crcTable[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static UA_UInt32
+crc32Update(UA_UInt32 crc, const UA_Byte *data, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+        crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+    }
+    return crc;
+}
+
+static UA_UInt32
+recordCrc(const UA_FileRecordHeader *rec) {
+    UA_UInt32 crc = 0xFFFFFFFF;
+    crc = crc32Update(crc, (const UA_Byte*)rec, offsetof(UA_FileRecordHeader, crc));
+    crc = crc32Update(crc, (const UA_Byte*)&rec[1], rec->length);
+    return ~crc;
+}
+
+/**************/
+/* Node Store */
+/**************/
+
+static UA_StatusCode
+addNodeStore(UA_FileStoreContext *ctx, const UA_NodeId *nodeId,
+             UA_UInt32 number, UA_FileNodeStore **outStore) {
+    UA_FileNodeStore *store = (UA_FileNodeStore*)UA_calloc(1, sizeof(UA_FileNodeStore));
+    if(!store)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode retval = UA_NodeId_copy(nodeId, &store->nodeId);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = UA_HistoryNodeMap_insert(&ctx->nodes, &store->nodeId, store);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&store->nodeId);
+        UA_free(store);
+        return retval;
+    }
+    store->number = number;
+    if(number >= ctx->nextNumber)
+        ctx->nextNumber = number + 1;
+    *outStore = store;
+    return UA_STATUSCODE_GOOD;
+}
+
+/*****************/
+/* File Handling */
+/*****************/
+
+static UA_StatusCode
+nodePath(const UA_FileStoreContext *ctx, UA_UInt32 number, char *path) {
+    int len = UA_snprintf(path, UA_HISTORYFILE_PATHSIZE, "%s/%u",
+                          ctx->directory, (unsigned)number);
+    if(len < 0 || len >= UA_HISTORYFILE_PATHSIZE)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+segmentPath(const UA_FileStoreContext *ctx, UA_UInt32 number,
+            UA_UInt64 seq, char *path) {
+    int len = UA_snprintf(path, UA_HISTORYFILE_PATHSIZE, "%s/%u/%llu.seg",
+                          ctx->directory, (unsigned)number, (unsigned long long)seq);
+    if(len < 0 || len >= UA_HISTORYFILE_PATHSIZE)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+makeDirectory(const char *path) {
+    if(mkdir(path, 0755) == 0 || errno == EEXIST)
+        return UA_STATUSCODE_GOOD;
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
+
+/* Map an existing segment file, or create a new one if newSize > 0 */
+static UA_StatusCode
+mapSegment(const char *path, size_t newSize, UA_FileSegment *seg) {
+    int flags = O_RDWR;
+    if(newSize > 0)
+        flags |= O_CREAT | O_TRUNC;
+    int fd = open(path, flags, 0644);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    size_t size = newSize;
+    if(newSize > 0) {
+        /* The file is sparse until the records are written */
+        if(ftruncate(fd, (off_t)newSize) != 0) {
+            close(fd);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    } else {
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size < UA_HISTORYFILE_HEADERSIZE) {
+            close(fd);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+        size = (size_t)st.st_size;
+    }
+
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); /* The mapping remains valid */
+    if(data == MAP_FAILED)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    memset(seg, 0, sizeof(UA_FileSegment));
+    seg->data = (UA_Byte*)data;
+    seg->size = size;
+    UA_FileSegmentHeader *header = segmentHeader(seg);
+    if(newSize > 0) {
+        header->magic = UA_HISTORYFILE_MAGIC;
+        header->version = UA_HISTORYFILE_VERSION;
+        header->end = UA_HISTORYFILE_HEADERSIZE;
+    } else if(header->magic != UA_HISTORYFILE_MAGIC ||
+              header->version != UA_HISTORYFILE_VERSION ||
+              header->end < UA_HISTORYFILE_HEADERSIZE || header->end > size) {
+        munmap(data, size);
+        memset(seg, 0, sizeof(UA_FileSegment));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+unmapSegment(UA_FileSegment *seg) {
+    if(seg->data)
+        munmap(seg->data, seg->size);
+    UA_free(seg->index);
+    memset(seg, 0, sizeof(UA_FileSegment));
+}
+
+static UA_StatusCode
+addIndexEntry(UA_FileSegment *seg, UA_DateTime timestamp, size_t offset) {
+    if(seg->indexSize == seg->indexCapacity) {
+        size_t ncap = (seg->indexCapacity == 0) ? 16 : seg->indexCapacity * 2;
+        UA_FileIndexEntry *index = (UA_FileIndexEntry*)
+            UA_realloc(seg->index, ncap * sizeof(UA_FileIndexEntry));
+        if(!index)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        seg->index = index;
+        seg->indexCapacity = ncap;
+    }
+    seg->index[seg->indexSize].timestamp = timestamp;
+    seg->index[seg->indexSize].offset = offset;
+    seg->indexSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Rebuild the sparse index of a loaded segment. Records that were not written
+ * completely (e.g. power loss) fail the CRC check and are cut off together with
+ * all following records. */
+static UA_StatusCode
+indexSegment(UA_FileSegment *seg) {
+    UA_FileSegmentHeader *header = segmentHeader(seg);
+    size_t offset = UA_HISTORYFILE_HEADERSIZE;
+    UA_UInt64 i = 0;
+    for(; i < header->count; i++) {
+        if(offset + sizeof(UA_FileRecordHeader) > header->end)
+            break;
+        const UA_FileRecordHeader *rec = recordAtOffset(seg, offset);
+        size_t size = recordSize(rec->length);
+        if(offset + size > header->end || rec->crc != recordCrc(rec))
+            break;
+        if(i % UA_HISTORYFILE_INDEXSTRIDE == 0) {
+            UA_StatusCode retval = addIndexEntry(seg, rec->timestamp, offset);
+            if(retval != UA_STATUSCODE_GOOD)
+                return retval;
+        }
+        header->last = rec->timestamp;
+        offset += size;
+    }
+    header->count = i;
+    header->end = offset;
+    return UA_STATUSCODE_GOOD;
+}
+
+static int
+compareSeq(const void *a, const void *b) {
+    UA_UInt64 sa = *(const UA_UInt64*)a;
+    UA_UInt64 sb = *(const UA_UInt64*)b;
+    return (sa > sb) - (sa < sb);
+}
+
+/* Map the segment files of the node. Empty segments are removed. */
+static UA_StatusCode
+loadNodeStore(UA_FileStoreContext *ctx, UA_FileNodeStore *store) {
+    char path[UA_HISTORYFILE_PATHSIZE];
+    UA_StatusCode retval = nodePath(ctx, store->number, path);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    DIR *dir = opendir(path);
+    if(!dir) {
+        retval = makeDirectory(path);
+        store->loaded = (retval == UA_STATUSCODE_GOOD);
+        return retval;
+    }
+
+    /* Collect the sequence numbers */
+    UA_UInt64 *seqs = NULL;
+    size_t seqsSize = 0;
+    struct dirent *entry;
+    while((entry = readdir(dir))) {
+        char *end = NULL;
+        unsigned long long seq = strtoull(entry->d_name, &end, 10);
+        if(end == entry->d_name || strcmp(end, ".seg") != 0)
+            continue;
+        UA_UInt64 *newSeqs = (UA_UInt64*)UA_realloc(seqs, (seqsSize + 1) * sizeof(UA_UInt64));
+        if(!newSeqs) {
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        seqs = newSeqs;
+        seqs[seqsSize++] = (UA_UInt64)seq;
+    }
+    closedir(dir);
+    if(retval != UA_STATUSCODE_GOOD || seqsSize == 0) {
+        UA_free(seqs);
+        store->loaded = (retval == UA_STATUSCODE_GOOD);
+        return retval;
+    }
+
+    store->segments = (UA_FileSegment*)UA_calloc(seqsSize, sizeof(UA_FileSegment));
+    if(!store->segments) {
+        UA_free(seqs);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    qsort(seqs, seqsSize, sizeof(UA_UInt64), compareSeq);
+    for(size_t i = 0; i < seqsSize; i++) {
+        retval = segmentPath(ctx, store->number, seqs[i], path);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+        UA_FileSegment *seg = &store->segments[store->segmentsSize];
+        if(mapSegment(path, 0, seg) != UA_STATUSCODE_GOOD)
+            continue; /* Ignore damaged segments */
+        seg->seq = seqs[i];
+        retval = indexSegment(seg);
+        if(retval != UA_STATUSCODE_GOOD) {
+            unmapSegment(seg);
+            break;
+        }
+        if(segmentHeader(seg)->count == 0) {
+            unmapSegment(seg);
+            unlink(path);
+            continue;
+        }
+        seg->firstIndex = store->count;
+        store->count += segmentHeader(seg)->count;
+        store->segmentsSize++;
+    }
+    UA_free(seqs);
+
+    /* Unmap again so that the next access retries from a clean state */
+    if(retval != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < store->segmentsSize; i++)
+            unmapSegment(&store->segments[i]);
+        UA_free(store->segments);
+        store->segments = NULL;
+        store->segmentsSize = 0;
+        store->count = 0;
+        return retval;
+    }
+    store->loaded = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Read the list of known nodes. The segments are mapped when a node is
+ * accessed for the first time. */
+static UA_StatusCode
+loadNodes(UA_FileStoreContext *ctx) {
+    struct stat st;
+    if(fstat(ctx->nodesFd, &st) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(st.st_size == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_ByteString buf;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, (size_t)st.st_size);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    size_t pos = 0;
+    while(pos < buf.length) {
+        ssize_t r = pread(ctx->nodesFd, buf.data + pos, buf.length - pos, (off_t)pos);
+        if(r <= 0)
+            break;
+        pos += (size_t)r;
+    }
+    buf.length = pos;
+
+    /* Entries are (UInt32 number, UInt32 length, binary NodeId). A cut off
+     * entry at the end is ignored. */
+    size_t offset = 0;
+    while(retval == UA_STATUSCODE_GOOD && offset + 8 <= buf.length) {
+        UA_UInt32 number, length;
+        memcpy(&number, buf.data + offset, 4);
+        memcpy(&length, buf.data + offset + 4, 4);
+        offset += 8;
+        if(offset + length > buf.length)
+            break;
+        UA_ByteString entry = {length, buf.data + offset};
+        size_t entryOffset = 0;
+        UA_NodeId nodeId;
+        retval = UA_decodeBinary(&entry, &entryOffset, &nodeId,
+                                 &UA_TYPES[UA_TYPES_NODEID], NULL);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+        UA_FileNodeStore *store;
+        if(!UA_HistoryNodeMap_find(&ctx->nodes, &nodeId))
+            retval = addNodeStore(ctx, &nodeId, number, &store);
+        UA_NodeId_clear(&nodeId);
+        offset += length;
+    }
+    UA_ByteString_clear(&buf);
+    return retval;
+}
+
+static UA_StatusCode
+persistNode(UA_FileStoreContext *ctx, const UA_FileNodeStore *store) {
+    size_t length = UA_calcSizeBinary(&store->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_ByteString buf;
+    UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, length + 8);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_UInt32 number = store->number;
+    UA_UInt32 len32 = (UA_UInt32)length;
+    memcpy(buf.data, &number, 4);
+    memcpy(buf.data + 4, &len32, 4);
+    UA_Byte *bufPos = buf.data + 8;
+    const UA_Byte *bufEnd = buf.data + buf.length;
+    retval = UA_encodeBinary(&store->nodeId, &UA_TYPES[UA_TYPES_NODEID],
+                             &bufPos, &bufEnd, NULL, NULL);
+    if(retval == UA_STATUSCODE_GOOD &&
+       write(ctx->nodesFd, buf.data, buf.length) != (ssize_t)buf.length)
+        retval = UA_STATUSCODE_BADINTERNALERROR;
+    UA_ByteString_clear(&buf);
+    return retval;
+}
+
+/* Returns the store of the NodeId. Unknown NodeIds get an empty store or, if
+ * create is true, a new store. Returns NULL only if an error occurred. */
+static UA_FileNodeStore *
+getFileNodeStore(UA_FileStoreContext *ctx, const UA_NodeId *nodeId, UA_Boolean create) {
+    UA_FileNodeStore *store = (UA_FileNodeStore*)
+        UA_HistoryNodeMap_find(&ctx->nodes, nodeId);
+    if(!store) {
+        if(!create)
+            return &ctx->empty;
+        if(addNodeStore(ctx, nodeId, ctx->nextNumber, &store) != UA_STATUSCODE_GOOD)
+            return NULL;
+        if(persistNode(ctx, store) != UA_STATUSCODE_GOOD)
+            return NULL;
+    }
+    if(!store->loaded && loadNodeStore(ctx, store) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return store;
+}
+
+static UA_FileNodeStore *
+getReadStore(void *context, const UA_NodeId *nodeId) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    UA_FileNodeStore *store = getFileNodeStore(ctx, nodeId, false);
+    return (store) ? store : &ctx->empty;
+}
+
+/**********/
+/* Lookup */
+/**********/
+
+/* The segment that contains the record with the index */
+static const UA_FileSegment *
+findSegment(const UA_FileNodeStore *s, size_t index) {
+    size_t low = 0;
+    size_t high = s->segmentsSize;
+    while(high - low > 1) {
+        size_t mid = low + ((high - low) / 2);
+        if(s->segments[mid].firstIndex <= index)
+            low = mid;
+        else
+            high = mid;
+    }
+    return &s->segments[low];
+}
+
+/* Offset of the record i within the segment. Starts from the sparse index. */
+static size_t
+recordOffset(const UA_FileSegment *seg, size_t i) {
+    size_t offset = seg->index[i / UA_HISTORYFILE_INDEXSTRIDE].offset;
+    for(size_t j = 0; j < i % UA_HISTORYFILE_INDEXSTRIDE; j++)
+        offset += recordSize(recordAtOffset(seg, offset)->length);
+    return offset;
+}
+
+static UA_Boolean
+isBefore(UA_DateTime t, UA_DateTime timestamp, UA_Boolean upper) {
+    return upper ? (t <= timestamp) : (t < timestamp);
+}
+
+/* Index of the first record with timestamp >= the given timestamp. Or > if
+ * upper is true. */
+static size_t
+findRecordBound(const UA_FileNodeStore *s, UA_DateTime timestamp, UA_Boolean upper) {
+    /* First segment where the last record is not before the timestamp */
+    size_t low = 0;
+    size_t high = s->segmentsSize;
+    while(low < high) {
+        size_t mid = low + ((high - low) / 2);
+        const UA_FileSegmentHeader *header = segmentHeader(&s->segments[mid]);
+        if(header->count == 0 || isBefore(header->last, timestamp, upper))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    if(low == s->segmentsSize)
+        return s->count;
+    const UA_FileSegment *seg = &s->segments[low];
+
+    /* First entry in the sparse index that is not before the timestamp */
+    size_t ilow = 0;
+    size_t ihigh = seg->indexSize;
+    while(ilow < ihigh) {
+        size_t mid = ilow + ((ihigh - ilow) / 2);
+        if(isBefore(seg->index[mid].timestamp, timestamp, upper))
+            ilow = mid + 1;
+        else
+            ihigh = mid;
+    }
+
+    /* Scan from the previous index entry */
+    size_t entry = (ilow > 0) ? ilow - 1 : 0;
+    size_t i = entry * UA_HISTORYFILE_INDEXSTRIDE;
+    size_t offset = seg->index[entry].offset;
+    const UA_FileRecordHeader *rec = recordAtOffset(seg, offset);
+    while(isBefore(rec->timestamp, timestamp, upper)) {
+        offset += recordSize(rec->length);
+        rec = recordAtOffset(seg, offset);
+        i++;
+    }
+    return seg->firstIndex + i;
+}
+
+static UA_StatusCode
+decodeRecord(UA_Server *server, const UA_FileRecordHeader *rec, UA_DataValue *dst) {
+    UA_ByteString buf = {rec->length, (UA_Byte*)(uintptr_t)&rec[1]};
+    const UA_DataTypeArray *customTypes =
+        (server) ? UA_Server_getConfig(server)->customDataTypes : NULL;
+    size_t offset = 0;
+    return UA_decodeBinary(&buf, &offset, dst, &UA_TYPES[UA_TYPES_DATAVALUE], customTypes);
+}
+
+/**********/
+/* Append */
+/**********/
+
+static void
+removeOldestSegment(UA_FileStoreContext *ctx, UA_FileNodeStore *s) {
+    UA_FileSegment *seg = &s->segments[0];
+    size_t count = (size_t)segmentHeader(seg)->count;
+    char path[UA_HISTORYFILE_PATHSIZE];
+    if(segmentPath(ctx, s->number, seg->seq, path) == UA_STATUSCODE_GOOD)
+        unlink(path);
+    unmapSegment(seg);
+    s->segmentsSize--;
+    memmove(&s->segments[0], &s->segments[1], s->segmentsSize * sizeof(UA_FileSegment));
+    for(size_t i = 0; i < s->segmentsSize; i++)
+        s->segments[i].firstIndex -= count;
+    s->count -= count;
+}
+
+static UA_StatusCode
+addSegment(UA_FileStoreContext *ctx, UA_FileNodeStore *s, size_t recSize) {
+    UA_FileSegment *segments = (UA_FileSegment*)
+        UA_realloc(s->segments, (s->segmentsSize + 1) * sizeof(UA_FileSegment));
+    if(!segments)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    s->segments = segments;
+
+    UA_UInt64 seq = (s->segmentsSize > 0) ? s->segments[s->segmentsSize - 1].seq + 1 : 0;
+    size_t size = ctx->segmentSize;
+    if(size < UA_HISTORYFILE_HEADERSIZE + recSize)
+        size = UA_HISTORYFILE_HEADERSIZE + recSize;
+    char path[UA_HISTORYFILE_PATHSIZE];
+    UA_StatusCode retval = segmentPath(ctx, s->number, seq, path);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_FileSegment *seg = &s->segments[s->segmentsSize];
+    retval = mapSegment(path, size, seg);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    seg->seq = seq;
+    seg->firstIndex = s->count;
+    s->segmentsSize++;
+
+    /* Retention */
+    if(ctx->maxSegmentsPerNode > 0 && s->segmentsSize > ctx->maxSegmentsPerNode)
+        removeOldestSegment(ctx, s);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+appendRecord(UA_FileStoreContext *ctx, UA_FileNodeStore *s,
+             UA_DateTime timestamp, const UA_DataValue *value) {
+    UA_FileSegment *seg = (s->segmentsSize > 0) ? &s->segments[s->segmentsSize - 1] : NULL;
+    if(s->count > 0 && timestamp < segmentHeader(seg)->last)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+
+    size_t length = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(length == 0 || length > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    size_t recSize = recordSize(length);
+    if(!seg || segmentHeader(seg)->end + recSize > seg->size) {
+        UA_StatusCode retval = addSegment(ctx, s, recSize);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+        seg = &s->segments[s->segmentsSize - 1];
+    }
+
+    /* Write the record */
+    UA_FileSegmentHeader *header = segmentHeader(seg);
+    size_t offset = (size_t)header->end;
+    UA_FileRecordHeader *rec = (UA_FileRecordHeader*)(seg->data + offset);
+    UA_Byte *bufPos = (UA_Byte*)&rec[1];
+    const UA_Byte *bufEnd = bufPos + length;
+    UA_StatusCode retval = UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE],
+                                           &bufPos, &bufEnd, NULL, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    rec->timestamp = timestamp;
+    rec->length = (UA_UInt32)length;
+    rec->flags = 0;
+    if(value->hasSourceTimestamp)
+        rec->flags |= UA_HISTORYFILE_HASSOURCETIME;
+    if(value->hasServerTimestamp)
+        rec->flags |= UA_HISTORYFILE_HASSERVERTIME;
+    rec->reserved = 0;
+    rec->crc = recordCrc(rec);
+
+    /* The record has to be on disk before the header points past it. msync
+     * requires a page-aligned start address. */
+    if(ctx->syncEachSample) {
+        size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        size_t syncStart = offset - (offset % pageSize);
+        if(msync(seg->data + syncStart, offset + recSize - syncStart, MS_SYNC) != 0)
+            return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    if(header->count % UA_HISTORYFILE_INDEXSTRIDE == 0) {
+        retval = addIndexEntry(seg, timestamp, offset);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+
+    /* Commit */
+    if(header->count == 0)
+        header->first = timestamp;
+    header->last = timestamp;
+    header->end = offset + recSize;
+    header->count++;
+    s->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+UA_FileNodeStore_clear(UA_FileNodeStore *s) {
+    for(size_t i = 0; i < s->segmentsSize; i++)
+        unmapSegment(&s->segments[i]);
+    UA_free(s->segments);
+    UA_DataValue_clear(&s->current);
+    UA_NodeId_clear(&s->nodeId);
+    memset(s, 0, sizeof(UA_FileNodeStore));
+}
+
+static void
+UA_FileStoreContext_clear(UA_FileStoreContext *ctx) {
+    for(size_t i = 0; i < ctx->nodes.size; i++) {
+        UA_FileNodeStore *s = (UA_FileNodeStore*)ctx->nodes.slots[i].entry;
+        if(!s)
+            continue;
+        UA_FileNodeStore_clear(s);
+        UA_free(s);
+    }
+    UA_HistoryNodeMap_clear(&ctx->nodes);
+    UA_FileNodeStore_clear(&ctx->empty);
+    if(ctx->nodesFd >= 0)
+        close(ctx->nodesFd);
+    UA_free(ctx->directory);
+    memset(ctx, 0, sizeof(UA_FileStoreContext));
+}
+
+/***********/
+/* Backend */
+/***********/
+
+static size_t
+resultSize_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId,
+                        size_t startIndex,
+                        size_t endIndex) {
+    const UA_FileNodeStore *s = getReadStore(context, nodeId);
+    if(s->count == 0 || startIndex == s->count || endIndex == s->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static size_t
+getDateTimeMatch_backend_file(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_NodeId *nodeId,
+                              const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    const UA_FileNodeStore *s = getReadStore(context, nodeId);
+    size_t index;
+    switch(strategy) {
+    case MATCH_EQUAL:
+        index = findRecordBound(s, timestamp, false);
+        if(index < findRecordBound(s, timestamp, true))
+            return index;
+        return s->count;
+    case MATCH_AFTER:
+        return findRecordBound(s, timestamp, true);
+    case MATCH_EQUAL_OR_AFTER:
+        return findRecordBound(s, timestamp, false);
+    case MATCH_EQUAL_OR_BEFORE:
+        index = findRecordBound(s, timestamp, true);
+        break;
+    case MATCH_BEFORE:
+        index = findRecordBound(s, timestamp, false);
+        break;
+    default:
+        return s->count;
+    }
+    return (index > 0) ? index - 1 : s->count;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_file(UA_Server *server,
+                                  void *context,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_NodeId *nodeId,
+                                  UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)context;
+    UA_FileNodeStore *s = getFileNodeStore(ctx, nodeId, true);
+    if(!s)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_DateTime timestamp;
+    if(value->hasSourceTimestamp)
+        timestamp = value->sourceTimestamp;
+    else if(value->hasServerTimestamp)
+        timestamp = value->serverTimestamp;
+    else
+        timestamp = UA_DateTime_now();
+    return appendRecord(ctx, s, timestamp, value);
+}
+
+static size_t
+getEnd_backend_file(UA_Server *server,
+                    void *context,
+                    const UA_NodeId *sessionId,
+                    void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    return getReadStore(context, nodeId)->count;
+}
+
+static size_t
+lastIndex_backend_file(UA_Server *server,
+                       void *context,
+                       const UA_NodeId *sessionId,
+                       void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    const UA_FileNodeStore *s = getReadStore(context, nodeId);
+    if(s->count == 0)
+        return 0;
+    return s->count - 1;
+}
+
+static size_t
+firstIndex_backend_file(UA_Server *server,
+                        void *context,
+                        const UA_NodeId *sessionId,
+                        void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static UA_Boolean
+boundSupported_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_file(UA_Server *server,
+                                         void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn timestampsToReturn) {
+    const UA_FileNodeStore *s = getReadStore(context, nodeId);
+    if(s->count == 0)
+        return true;
+    UA_UInt32 flags = recordAtOffset(&s->segments[0], UA_HISTORYFILE_HEADERSIZE)->flags;
+    UA_Boolean hasSource = (flags & UA_HISTORYFILE_HASSOURCETIME) != 0;
+    UA_Boolean hasServer = (flags & UA_HISTORYFILE_HASSERVERTIME) != 0;
+    switch(timestampsToReturn) {
+    case UA_TIMESTAMPSTORETURN_SOURCE:
+        return hasSource;
+    case UA_TIMESTAMPSTORETURN_SERVER:
+        return hasServer;
+    case UA_TIMESTAMPSTORETURN_BOTH:
+        return hasSource && hasServer;
+    default:
+        return false;
+    }
+}
+
+static const UA_DataValue *
+getDataValue_backend_file(UA_Server *server,
+                          void *context,
+                          const UA_NodeId *sessionId,
+                          void *sessionContext,
+                          const UA_NodeId *nodeId,
+                          size_t index) {
+    UA_FileNodeStore *s = getReadStore(context, nodeId);
+    if(index >= s->count)
+        return NULL;
+    const UA_FileSegment *seg = findSegment(s, index);
+    const UA_FileRecordHeader *rec =
+        recordAtOffset(seg, recordOffset(seg, index - seg->firstIndex));
+    UA_DataValue_clear(&s->current);
+    if(decodeRecord(server, rec, &s->current) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return &s->current;
+}
+
+static UA_StatusCode
+copyDataValues_backend_file(UA_Server *server,
+                            void *context,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            size_t startIndex,
+                            size_t endIndex,
+                            UA_Boolean reverse,
+                            size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues,
+                            UA_DataValue *values) {
+    size_t skip = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+    }
+
+    const UA_FileNodeStore *s = getReadStore(context, nodeId);
+    size_t total;
+    size_t index;
+    if(reverse) {
+        if(startIndex >= s->count || endIndex > startIndex)
+            total = 0;
+        else
+            total = startIndex - endIndex + 1;
+        index = startIndex - skip;
+    } else {
+        if(endIndex >= s->count || startIndex > endIndex)
+            total = 0;
+        else
+            total = endIndex - startIndex + 1;
+        index = startIndex + skip;
+    }
+
+    /* Decode directly from the mapped segments. Going forward, the records
+     * are walked in sequence. Going backwards, every record is looked up via
+     * the sparse index. */
+    const UA_FileSegment *seg = NULL;
+    size_t offset = 0;
+    size_t counter = 0;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(; skip + counter < total && counter < maxValues; counter++) {
+        if(!seg || reverse || offset >= segmentHeader(seg)->end) {
+            seg = findSegment(s, index);
+            offset = recordOffset(seg, index - seg->firstIndex);
+        }
+        const UA_FileRecordHeader *rec = recordAtOffset(seg, offset);
+        offset += recordSize(rec->length);
+        index = reverse ? index - 1 : index + 1;
+
+        UA_DataValue *dst = &values[counter];
+        retval = decodeRecord(server, rec, dst);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+        if(range.dimensionsSize > 0) {
+            UA_Variant v = dst->value;
+            UA_Variant_init(&dst->value);
+            if(dst->hasValue)
+                UA_Variant_copyRange(&v, &dst->value, range);
+            UA_Variant_clear(&v);
+        }
+    }
+    if(retval != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < counter; i++)
+            UA_DataValue_clear(&values[i]);
+        return retval;
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+
+    if(skip + counter < total) {
+        outContinuationPoint->data = (UA_Byte*)UA_malloc(sizeof(size_t));
+        if(!outContinuationPoint->data)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        outContinuationPoint->length = sizeof(size_t);
+        size_t next = skip + counter;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteMembers_backend_file(UA_HistoryDataBackend *backend) {
+    if(backend == NULL || backend->context == NULL)
+        return;
+    UA_FileStoreContext_clear((UA_FileStoreContext*)backend->context);
+    UA_free(backend->context);
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           size_t maxSegmentsPerNode, UA_Boolean syncEachSample) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    if(!directory || makeDirectory(directory) != UA_STATUSCODE_GOOD)
+        return result;
+
+    UA_FileStoreContext *ctx = (UA_FileStoreContext*)
+        UA_calloc(1, sizeof(UA_FileStoreContext));
+    if(!ctx)
+        return result;
+    ctx->nodesFd = -1;
+    ctx->segmentSize = (segmentSize > 0) ? segmentSize : UA_HISTORYFILE_SEGMENTSIZE;
+    ctx->maxSegmentsPerNode = maxSegmentsPerNode;
+    ctx->syncEachSample = syncEachSample;
+    size_t dirLen = strlen(directory);
+    ctx->directory = (char*)UA_malloc(dirLen + 1);
+    if(!ctx->directory)
+        goto error;
+    memcpy(ctx->directory, directory, dirLen + 1);
+
+    char path[UA_HISTORYFILE_PATHSIZE];
+    int len = UA_snprintf(path, UA_HISTORYFILE_PATHSIZE, "%s/nodes", directory);
+    if(len < 0 || len >= UA_HISTORYFILE_PATHSIZE)
+        goto error;
+    ctx->nodesFd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if(ctx->nodesFd < 0)
+        goto error;
+    if(UA_HistoryNodeMap_init(&ctx->nodes, 0) != UA_STATUSCODE_GOOD ||
+       loadNodes(ctx) != UA_STATUSCODE_GOOD)
+        goto error;
+
+    result.serverSetHistoryData = &serverSetHistoryData_backend_file;
+    result.resultSize = &resultSize_backend_file;
+    result.getEnd = &getEnd_backend_file;
+    result.lastIndex = &lastIndex_backend_file;
+    result.firstIndex = &firstIndex_backend_file;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_file;
+    result.copyDataValues = &copyDataValues_backend_file;
+    result.getDataValue = &getDataValue_backend_file;
+    result.boundSupported = &boundSupported_backend_file;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_file;
+    result.insertDataValue = NULL;
+    result.updateDataValue = NULL;
+    result.replaceDataValue = NULL;
+    result.removeDataValue = NULL;
+    result.deleteMembers = &deleteMembers_backend_file;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+
+ error:
+    UA_FileStoreContext_clear(ctx);
+    UA_free(ctx);
+    return result;
+}
+
+void
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_file(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
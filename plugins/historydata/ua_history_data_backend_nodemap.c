@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_history_data_backend_nodemap.h"
+
+#include <string.h>
+
+static UA_UInt32 const nodeMapPrimes[] = {
+    7,         13,         31,         61,         127,         251,
+    509,       1021,       2039,       4093,       8191,        16381,
+    32749,     65521,      131071,     262139,     524287,      1048573,
+    2097143,   4194301,    8388593,    16777213,   33554393,    67108859,
+    134217689, 268435399,  536870909,  1073741789, 2147483647,  4294967291
+};
+
+static UA_UInt32
+higherPrime(UA_UInt32 n) {
+    UA_UInt16 low  = 0;
+    UA_UInt16 high = (UA_UInt16)(sizeof(nodeMapPrimes) / sizeof(UA_UInt32));
+    while(low != high) {
+        UA_UInt16 mid = (UA_UInt16)(low + ((high - low) / 2));
+        if(n > nodeMapPrimes[mid])
+            low = (UA_UInt16)(mid + 1);
+        else
+            high = mid;
+    }
+    return nodeMapPrimes[low];
+}
+
+/* Returns the slot with the NodeId or the empty slot where it can be added */
+static UA_HistoryNodeMapSlot *
+findNodeMapSlot(const UA_HistoryNodeMap *map, const UA_NodeId *nodeId, UA_UInt32 h) {
+    UA_UInt32 size = map->size;
+    if(size == 0)
+        return NULL;
+    UA_UInt64 idx = h % size; /* Use 64bit container to avoid overflow  */
+    UA_UInt32 startIdx = (UA_UInt32)idx;
+    UA_UInt32 hash2 = 1 + (h % (size - 2));
+    do {
+        UA_HistoryNodeMapSlot *slot = &map->slots[(UA_UInt32)idx];
+        if(!slot->entry)
+            return slot;
+        if(slot->nodeIdHash == h && UA_NodeId_equal(slot->nodeId, nodeId))
+            return slot;
+        idx += hash2;
+        if(idx >= size)
+            idx -= size;
+    } while((UA_UInt32)idx != startIdx);
+    return NULL;
+}
+
+/* The occupancy of the table after the call will be about 25% */
+static UA_StatusCode
+expandNodeMap(UA_HistoryNodeMap *map) {
+    UA_UInt32 osize = map->size;
+    UA_UInt32 count = map->count;
+    if(osize > 0 && (count + 1) * 2 < osize)
+        return UA_STATUSCODE_GOOD;
+
+    UA_HistoryNodeMapSlot *oslots = map->slots;
+    UA_UInt32 nsize = higherPrime((count + 1) * 4);
+    UA_HistoryNodeMapSlot *nslots = (UA_HistoryNodeMapSlot*)
+        UA_calloc(nsize, sizeof(UA_HistoryNodeMapSlot));
+    if(!nslots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    map->slots = nslots;
+    map->size = nsize;
+    for(size_t i = 0, j = 0; i < osize && j < count; ++i) {
+        if(!oslots[i].entry)
+            continue;
+        UA_HistoryNodeMapSlot *s =
+            findNodeMapSlot(map, oslots[i].nodeId, oslots[i].nodeIdHash);
+        UA_assert(s);
+        *s = oslots[i];
+        ++j;
+    }
+    UA_free(oslots);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_HistoryNodeMap_init(UA_HistoryNodeMap *map, size_t initialSize) {
+    memset(map, 0, sizeof(UA_HistoryNodeMap));
+    if(initialSize > UA_UINT32_MAX / 2)
+        initialSize = UA_UINT32_MAX / 2;
+    UA_UInt32 size = higherPrime((UA_UInt32)initialSize * 2);
+    map->slots = (UA_HistoryNodeMapSlot*)UA_calloc(size, sizeof(UA_HistoryNodeMapSlot));
+    if(!map->slots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    map->size = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+void *
+UA_HistoryNodeMap_find(const UA_HistoryNodeMap *map, const UA_NodeId *nodeId) {
+    UA_HistoryNodeMapSlot *slot = findNodeMapSlot(map, nodeId, UA_NodeId_hash(nodeId));
+    return (slot) ? slot->entry : NULL;
+}
+
+UA_StatusCode
+UA_HistoryNodeMap_insert(UA_HistoryNodeMap *map, const UA_NodeId *nodeId,
+                         void *entry) {
+    UA_StatusCode retval = expandNodeMap(map);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_UInt32 h = UA_NodeId_hash(nodeId);
+    UA_HistoryNodeMapSlot *slot = findNodeMapSlot(map, nodeId, h);
+    UA_assert(slot && !slot->entry);
+    slot->entry = entry;
+    slot->nodeId = nodeId;
+    slot->nodeIdHash = h;
+    map->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_HistoryNodeMap_clear(UA_HistoryNodeMap *map) {
+    UA_free(map->slots);
+    memset(map, 0, sizeof(UA_HistoryNodeMap));
+}
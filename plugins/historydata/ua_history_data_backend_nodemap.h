@@ -0,0 +1,52 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORY_DATA_BACKEND_NODEMAP_H_
+#define UA_HISTORY_DATA_BACKEND_NODEMAP_H_
+
+#include <open62541/types.h>
+
+_UA_BEGIN_DECLS
+
+/* Hash map from the NodeId to the per-node store of a history backend. Same
+ * scheme as the default nodestore: open addressing with double hashing and a
+ * size that is always a prime close to a power of 2. Entries are never removed
+ * until the map is cleared. So there are no tombstones.
+ *
+ * The NodeId pointer is not copied. It has to remain valid as long as the
+ * entry is in the map. Usually it points to the NodeId inside the store. */
+
+typedef struct {
+    void *entry; /* NULL if the slot is empty */
+    const UA_NodeId *nodeId;
+    UA_UInt32 nodeIdHash;
+} UA_HistoryNodeMapSlot;
+
+typedef struct {
+    UA_HistoryNodeMapSlot *slots;
+    UA_UInt32 size;
+    UA_UInt32 count;
+} UA_HistoryNodeMap;
+
+UA_StatusCode
+UA_HistoryNodeMap_init(UA_HistoryNodeMap *map, size_t initialSize);
+
+/* Returns NULL if the NodeId is not in the map */
+void *
+UA_HistoryNodeMap_find(const UA_HistoryNodeMap *map, const UA_NodeId *nodeId);
+
+/* The NodeId must not be in the map yet */
+UA_StatusCode
+UA_HistoryNodeMap_insert(UA_HistoryNodeMap *map, const UA_NodeId *nodeId,
+                         void *entry);
+
+/* Frees the slots only. The entries are cleaned up by the caller before, by
+ * iterating over the slots. */
+void
+UA_HistoryNodeMap_clear(UA_HistoryNodeMap *map);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORY_DATA_BACKEND_NODEMAP_H_ */
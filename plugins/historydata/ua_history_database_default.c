@@ -454,6 +454,39 @@ deleteRawModified_service_default(UA_Server *server,
                                                           details->endTime);
 }
 
+static const UA_HistorizingNodeIdSettings *
+getReadSetting_service_default(UA_Server *server,
+                               UA_HistoryDatabaseContext_default *ctx,
+                               const UA_NodeId *nodeId,
+                               UA_StatusCode *statusCode)
+{
+    UA_Byte accessLevel = 0;
+    UA_Server_readAccessLevel(server,
+                              *nodeId,
+                              &accessLevel);
+    if (!(accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD)) {
+        *statusCode = UA_STATUSCODE_BADUSERACCESSDENIED;
+        return NULL;
+    }
+
+    UA_Boolean historizing = false;
+    UA_Server_readHistorizing(server,
+                              *nodeId,
+                              &historizing);
+    if (!historizing) {
+        *statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+        return NULL;
+    }
+
+    const UA_HistorizingNodeIdSettings *setting = ctx->gathering.getHistorizingSetting(
+                server,
+                ctx->gathering.context,
+                nodeId);
+    if (!setting)
+        *statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+    return setting;
+}
+
 static void
 readRaw_service_default(UA_Server *server,
                         void *context,
@@ -470,33 +503,11 @@ readRaw_service_default(UA_Server *server,
 {
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
     for (size_t i = 0; i < nodesToReadSize; ++i) {
-        UA_Byte accessLevel = 0;
-        UA_Server_readAccessLevel(server,
-                                  nodesToRead[i].nodeId,
-                                  &accessLevel);
-        if (!(accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD)) {
-            response->results[i].statusCode = UA_STATUSCODE_BADUSERACCESSDENIED;
-            continue;
-        }
-
-        UA_Boolean historizing = false;
-        UA_Server_readHistorizing(server,
-                                  nodesToRead[i].nodeId,
-                                  &historizing);
-        if (!historizing) {
-            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
-            continue;
-        }
-
-        const UA_HistorizingNodeIdSettings *setting = ctx->gathering.getHistorizingSetting(
-                    server,
-                    ctx->gathering.context,
-                    &nodesToRead[i].nodeId);
-
-        if (!setting) {
-            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+        const UA_HistorizingNodeIdSettings *setting =
+            getReadSetting_service_default(server, ctx, &nodesToRead[i].nodeId,
+                                           &response->results[i].statusCode);
+        if (!setting)
             continue;
-        }
 
         if (historyReadDetails->returnBounds && !setting->historizingBackend.boundSupported(
                     server,
@@ -578,6 +589,997 @@ readRaw_service_default(UA_Server *server,
     return;
 }
 
+/**************/
+/* Aggregates */
+/**************/
+
+/* HistorianBits of the StatusCode (Part 4, 7.34.1) */
+#define UA_HISTORIANBITS_CALCULATED (UA_STATUSCODE_INFOTYPE_DATAVALUE | 0x01)
+#define UA_HISTORIANBITS_INTERPOLATED (UA_STATUSCODE_INFOTYPE_DATAVALUE | 0x02)
+#define UA_HISTORIANBITS_PARTIAL (UA_STATUSCODE_INFOTYPE_DATAVALUE | 0x04)
+
+/* Number of DataValues copied from the backend at once */
+#define UA_HISTORYSAMPLES_CHUNKSIZE 64
+
+/* Maximum number of processed values in one response. The client chooses the
+ * number of intervals with the ProcessingInterval. The remaining intervals are
+ * returned with a continuation point. */
+#define UA_HISTORYPROCESSED_MAXVALUES 10000
+
+typedef enum {
+    UA_HISTORYAGGREGATE_UNSUPPORTED,
+    UA_HISTORYAGGREGATE_INTERPOLATIVE,
+    UA_HISTORYAGGREGATE_AVERAGE,
+    UA_HISTORYAGGREGATE_TIMEAVERAGE,
+    UA_HISTORYAGGREGATE_TOTAL,
+    UA_HISTORYAGGREGATE_MINIMUM,
+    UA_HISTORYAGGREGATE_MAXIMUM,
+    UA_HISTORYAGGREGATE_RANGE,
+    UA_HISTORYAGGREGATE_COUNT,
+    UA_HISTORYAGGREGATE_START,
+    UA_HISTORYAGGREGATE_END,
+    UA_HISTORYAGGREGATE_DELTA
+} UA_HistoryAggregate;
+
+static UA_HistoryAggregate
+getAggregate_service_default(const UA_NodeId *aggregateType)
+{
+    if (aggregateType->namespaceIndex != 0 ||
+        aggregateType->identifierType != UA_NODEIDTYPE_NUMERIC)
+        return UA_HISTORYAGGREGATE_UNSUPPORTED;
+    switch (aggregateType->identifier.numeric) {
+    case UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE:
+        return UA_HISTORYAGGREGATE_INTERPOLATIVE;
+    case UA_NS0ID_AGGREGATEFUNCTION_AVERAGE:
+        return UA_HISTORYAGGREGATE_AVERAGE;
+    case UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE:
+        return UA_HISTORYAGGREGATE_TIMEAVERAGE;
+    case UA_NS0ID_AGGREGATEFUNCTION_TOTAL:
+        return UA_HISTORYAGGREGATE_TOTAL;
+    case UA_NS0ID_AGGREGATEFUNCTION_MINIMUM:
+        return UA_HISTORYAGGREGATE_MINIMUM;
+    case UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM:
+        return UA_HISTORYAGGREGATE_MAXIMUM;
+    case UA_NS0ID_AGGREGATEFUNCTION_RANGE:
+        return UA_HISTORYAGGREGATE_RANGE;
+    case UA_NS0ID_AGGREGATEFUNCTION_COUNT:
+        return UA_HISTORYAGGREGATE_COUNT;
+    case UA_NS0ID_AGGREGATEFUNCTION_START:
+        return UA_HISTORYAGGREGATE_START;
+    case UA_NS0ID_AGGREGATEFUNCTION_END:
+        return UA_HISTORYAGGREGATE_END;
+    case UA_NS0ID_AGGREGATEFUNCTION_DELTA:
+        return UA_HISTORYAGGREGATE_DELTA;
+    default:
+        return UA_HISTORYAGGREGATE_UNSUPPORTED;
+    }
+}
+
+static UA_Boolean
+isNumericType(const UA_DataType *type)
+{
+    return type && type->typeKind <= UA_DATATYPEKIND_DOUBLE;
+}
+
+static UA_Boolean
+variantToDouble(const UA_Variant *v, UA_Double *out)
+{
+    if (!UA_Variant_isScalar(v) || !isNumericType(v->type))
+        return false;
+    switch (v->type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: *out = *(UA_Boolean*)v->data ? 1.0 : 0.0; break;
+    case UA_DATATYPEKIND_SBYTE: *out = *(UA_SByte*)v->data; break;
+    case UA_DATATYPEKIND_BYTE: *out = *(UA_Byte*)v->data; break;
+    case UA_DATATYPEKIND_INT16: *out = *(UA_Int16*)v->data; break;
+    case UA_DATATYPEKIND_UINT16: *out = *(UA_UInt16*)v->data; break;
+    case UA_DATATYPEKIND_INT32: *out = *(UA_Int32*)v->data; break;
+    case UA_DATATYPEKIND_UINT32: *out = *(UA_UInt32*)v->data; break;
+    case UA_DATATYPEKIND_INT64: *out = (UA_Double)*(UA_Int64*)v->data; break;
+    case UA_DATATYPEKIND_UINT64: *out = (UA_Double)*(UA_UInt64*)v->data; break;
+    case UA_DATATYPEKIND_FLOAT: *out = *(UA_Float*)v->data; break;
+    default: *out = *(UA_Double*)v->data; break;
+    }
+    return true;
+}
+
+/* Round to the nearest integer and saturate at the limits of the type */
+#define HISTORY_SATURATE(T, MIN, MAX)                                   \
+    ((d <= (UA_Double)(MIN)) ? (T)(MIN) :                               \
+     ((d >= (UA_Double)(MAX)) ? (T)(MAX) :                              \
+      (T)((d >= 0.0) ? d + 0.5 : d - 0.5)))
+
+/* Set the value with the numeric builtin type. Integers are rounded and
+ * saturate at the limits of the type. */
+static UA_StatusCode
+setNumericValue(UA_Variant *v, UA_Double d, const UA_DataType *type)
+{
+    if (!isNumericType(type))
+        type = &UA_TYPES[UA_TYPES_DOUBLE];
+    type = &UA_TYPES[type->typeKind];
+    if (d != d && type->typeKind < UA_DATATYPEKIND_FLOAT)
+        d = 0.0; /* NaN has no integer representation */
+    union {
+        UA_Boolean b; UA_SByte sb; UA_Byte by; UA_Int16 i16; UA_UInt16 u16;
+        UA_Int32 i32; UA_UInt32 u32; UA_Int64 i64; UA_UInt64 u64;
+        UA_Float f; UA_Double d;
+    } val;
+    switch (type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: val.b = (d != 0.0); break;
+    case UA_DATATYPEKIND_SBYTE: val.sb = HISTORY_SATURATE(UA_SByte, UA_SBYTE_MIN, UA_SBYTE_MAX); break;
+    case UA_DATATYPEKIND_BYTE: val.by = HISTORY_SATURATE(UA_Byte, 0, UA_BYTE_MAX); break;
+    case UA_DATATYPEKIND_INT16: val.i16 = HISTORY_SATURATE(UA_Int16, UA_INT16_MIN, UA_INT16_MAX); break;
+    case UA_DATATYPEKIND_UINT16: val.u16 = HISTORY_SATURATE(UA_UInt16, 0, UA_UINT16_MAX); break;
+    case UA_DATATYPEKIND_INT32: val.i32 = HISTORY_SATURATE(UA_Int32, UA_INT32_MIN, UA_INT32_MAX); break;
+    case UA_DATATYPEKIND_UINT32: val.u32 = HISTORY_SATURATE(UA_UInt32, 0, UA_UINT32_MAX); break;
+    case UA_DATATYPEKIND_INT64: val.i64 = HISTORY_SATURATE(UA_Int64, UA_INT64_MIN, UA_INT64_MAX); break;
+    case UA_DATATYPEKIND_UINT64: val.u64 = HISTORY_SATURATE(UA_UInt64, 0, UA_UINT64_MAX); break;
+    case UA_DATATYPEKIND_FLOAT: val.f = (UA_Float)d; break;
+    default: val.d = d; break;
+    }
+    return UA_Variant_setScalarCopy(v, &val, type);
+}
+
+#undef HISTORY_SATURATE
+
+static UA_DateTime
+sampleTime(const UA_DataValue *value)
+{
+    if (value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    return value->serverTimestamp;
+}
+
+static UA_Boolean
+isGoodSample(const UA_DataValue *value, UA_Boolean treatUncertainAsBad)
+{
+    UA_StatusCode code = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+    if (code & UA_STATUSCODE_BAD)
+        return false;
+    if (treatUncertainAsBad && (code & UA_STATUSCODE_UNCERTAIN))
+        return false;
+    return true;
+}
+
+/* Only the good samples with a numeric value are used for the calculation.
+ * The other samples are counted to compute the quality of an interval. */
+static UA_Boolean
+sampleToDouble(const UA_DataValue *value, UA_Boolean treatUncertainAsBad, UA_Double *d)
+{
+    return value->hasValue && isGoodSample(value, treatUncertainAsBad) &&
+        variantToDouble(&value->value, d);
+}
+
+/* The node whose raw samples are aggregated */
+typedef struct {
+    const UA_HistoryDataBackend *backend;
+    UA_Server *server;
+    const UA_NodeId *sessionId;
+    void *sessionContext;
+    const UA_NodeId *nodeId;
+    UA_Boolean treatUncertainAsBad;
+} UA_HistorySource;
+
+/* The raw samples of an interval are folded into the partial results chunk by
+ * chunk. So the memory does not grow with the number of samples. */
+typedef struct {
+    size_t good;
+    size_t bad;
+    UA_Double sum;
+    UA_Double integral; /* From the first to the last good sample */
+    UA_Double min;
+    UA_Double max;
+    UA_Double first;
+    UA_Double last;
+    UA_DateTime minTime;
+    UA_DateTime maxTime;
+    UA_DateTime firstTime;
+    UA_DateTime lastTime;
+    const UA_DataType *type; /* Of the first good sample */
+} UA_HistoryInterval;
+
+/* The kernels work on contiguous columns. There are no branches in the inner
+ * loops and independent accumulators, so that the compiler can vectorize. */
+
+static UA_Double
+sumKernel(const UA_Double *v, size_t n)
+{
+    UA_Double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += v[i];
+        s1 += v[i+1];
+        s2 += v[i+2];
+        s3 += v[i+3];
+    }
+    for (; i < n; ++i)
+        s0 += v[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/* Index of the first minimum (or maximum) value. n must be > 0. */
+static size_t
+extremumKernel(const UA_Double *v, size_t n, UA_Boolean maximum)
+{
+    UA_Double m0 = v[0], m1 = v[0], m2 = v[0], m3 = v[0];
+    size_t i = 0;
+    if (maximum) {
+        for (; i + 4 <= n; i += 4) {
+            m0 = (v[i] > m0) ? v[i] : m0;
+            m1 = (v[i+1] > m1) ? v[i+1] : m1;
+            m2 = (v[i+2] > m2) ? v[i+2] : m2;
+            m3 = (v[i+3] > m3) ? v[i+3] : m3;
+        }
+        for (; i < n; ++i)
+            m0 = (v[i] > m0) ? v[i] : m0;
+        m0 = (m1 > m0) ? m1 : m0;
+        m2 = (m3 > m2) ? m3 : m2;
+        m0 = (m2 > m0) ? m2 : m0;
+    } else {
+        for (; i + 4 <= n; i += 4) {
+            m0 = (v[i] < m0) ? v[i] : m0;
+            m1 = (v[i+1] < m1) ? v[i+1] : m1;
+            m2 = (v[i+2] < m2) ? v[i+2] : m2;
+            m3 = (v[i+3] < m3) ? v[i+3] : m3;
+        }
+        for (; i < n; ++i)
+            m0 = (v[i] < m0) ? v[i] : m0;
+        m0 = (m1 < m0) ? m1 : m0;
+        m2 = (m3 < m2) ? m3 : m2;
+        m0 = (m2 < m0) ? m2 : m0;
+    }
+    for (i = 0; i < n; ++i) {
+        if (v[i] == m0)
+            break;
+    }
+    return i;
+}
+
+/* Integral with linear interpolation between the samples. In value * 100ns. */
+static UA_Double
+integralKernel(const UA_DateTime *t, const UA_Double *v, size_t n)
+{
+    UA_Double s0 = 0.0, s1 = 0.0;
+    size_t i = 1;
+    for (; i + 2 <= n; i += 2) {
+        s0 += (UA_Double)(t[i] - t[i-1]) * (v[i] + v[i-1]);
+        s1 += (UA_Double)(t[i+1] - t[i]) * (v[i+1] + v[i]);
+    }
+    for (; i < n; ++i)
+        s0 += (UA_Double)(t[i] - t[i-1]) * (v[i] + v[i-1]);
+    return (s0 + s1) * 0.5;
+}
+
+/* Fold the good samples of a chunk (in contiguous columns) into the interval */
+static void
+addChunk(UA_HistoryInterval *iv, const UA_DateTime *times, const UA_Double *values, size_t n)
+{
+    if (n == 0)
+        return;
+    if (iv->good == 0) {
+        iv->first = iv->min = iv->max = values[0];
+        iv->firstTime = iv->minTime = iv->maxTime = times[0];
+    } else {
+        /* Close the gap to the previous chunk */
+        iv->integral += (UA_Double)(times[0] - iv->lastTime) * (values[0] + iv->last) * 0.5;
+    }
+    iv->sum += sumKernel(values, n);
+    iv->integral += integralKernel(times, values, n);
+    size_t i = extremumKernel(values, n, false);
+    if (values[i] < iv->min) {
+        iv->min = values[i];
+        iv->minTime = times[i];
+    }
+    i = extremumKernel(values, n, true);
+    if (values[i] > iv->max) {
+        iv->max = values[i];
+        iv->maxTime = times[i];
+    }
+    iv->last = values[n-1];
+    iv->lastTime = times[n-1];
+    iv->good += n;
+}
+
+/* Read the raw samples in [from, to) from the backend. At most
+ * UA_HISTORYSAMPLES_CHUNKSIZE DataValues are copied at once. The continuation
+ * point of the backend is handed back until the range is complete. Works with
+ * every backend that returns its values sorted. */
+static UA_StatusCode
+loadInterval(const UA_HistorySource *src, UA_DateTime from, UA_DateTime to,
+             UA_HistoryInterval *iv)
+{
+    const UA_HistoryDataBackend *backend = src->backend;
+    memset(iv, 0, sizeof(UA_HistoryInterval));
+    size_t storeEnd = backend->getEnd(src->server, backend->context, src->sessionId,
+                                      src->sessionContext, src->nodeId);
+    size_t first = backend->getDateTimeMatch(src->server, backend->context, src->sessionId,
+                                             src->sessionContext, src->nodeId, from,
+                                             MATCH_EQUAL_OR_AFTER);
+    size_t last = backend->getDateTimeMatch(src->server, backend->context, src->sessionId,
+                                            src->sessionContext, src->nodeId, to, MATCH_BEFORE);
+    if (first == storeEnd || last == storeEnd)
+        return UA_STATUSCODE_GOOD;
+    const UA_DataValue *firstValue =
+        backend->getDataValue(src->server, backend->context, src->sessionId,
+                              src->sessionContext, src->nodeId, first);
+    if (!firstValue || sampleTime(firstValue) >= to)
+        return UA_STATUSCODE_GOOD; /* No sample in the interval */
+
+    UA_NumericRange range;
+    range.dimensionsSize = 0;
+    range.dimensions = NULL;
+    UA_ByteString continuationPoint;
+    UA_ByteString_init(&continuationPoint);
+    UA_DataValue chunk[UA_HISTORYSAMPLES_CHUNKSIZE];
+    UA_DateTime times[UA_HISTORYSAMPLES_CHUNKSIZE];
+    UA_Double values[UA_HISTORYSAMPLES_CHUNKSIZE];
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    while (true) {
+        size_t provided = 0;
+        UA_ByteString outContinuationPoint;
+        UA_ByteString_init(&outContinuationPoint);
+        for (size_t i = 0; i < UA_HISTORYSAMPLES_CHUNKSIZE; ++i)
+            UA_DataValue_init(&chunk[i]);
+        retval = backend->copyDataValues(src->server, backend->context, src->sessionId,
+                                         src->sessionContext, src->nodeId, first, last,
+                                         false, UA_HISTORYSAMPLES_CHUNKSIZE, range, false,
+                                         &continuationPoint, &outContinuationPoint,
+                                         &provided, chunk);
+        UA_ByteString_clear(&continuationPoint);
+        if (retval != UA_STATUSCODE_GOOD)
+            break;
+        size_t n = 0;
+        for (size_t i = 0; i < provided; ++i) {
+            if (sampleToDouble(&chunk[i], src->treatUncertainAsBad, &values[n])) {
+                if (!iv->type)
+                    iv->type = chunk[i].value.type;
+                times[n] = sampleTime(&chunk[i]);
+                n++;
+            } else {
+                iv->bad++;
+            }
+            UA_DataValue_clear(&chunk[i]);
+        }
+        addChunk(iv, times, values, n);
+        continuationPoint = outContinuationPoint;
+        if (provided == 0 || continuationPoint.length == 0)
+            break;
+    }
+    UA_ByteString_clear(&continuationPoint);
+    return retval;
+}
+
+/* The closest good numeric sample before (or at or after) the timestamp,
+ * depending on the strategy. Samples that are skipped on the way are added to
+ * skipped. Returns false if there is no such sample. */
+static UA_Boolean
+findGoodSample(const UA_HistorySource *src, UA_DateTime timestamp, MatchStrategy strategy,
+               UA_DateTime *time, UA_Double *value, const UA_DataType **type,
+               size_t *skipped)
+{
+    const UA_HistoryDataBackend *backend = src->backend;
+    size_t storeEnd = backend->getEnd(src->server, backend->context, src->sessionId,
+                                      src->sessionContext, src->nodeId);
+    while (true) {
+        size_t index = backend->getDateTimeMatch(src->server, backend->context, src->sessionId,
+                                                 src->sessionContext, src->nodeId,
+                                                 timestamp, strategy);
+        if (index == storeEnd)
+            return false;
+        const UA_DataValue *dv =
+            backend->getDataValue(src->server, backend->context, src->sessionId,
+                                  src->sessionContext, src->nodeId, index);
+        if (!dv)
+            return false;
+        if (sampleToDouble(dv, src->treatUncertainAsBad, value)) {
+            *time = sampleTime(dv);
+            if (type)
+                *type = dv->value.type;
+            return true;
+        }
+        (*skipped)++;
+        timestamp = sampleTime(dv);
+        if (strategy == MATCH_EQUAL_OR_AFTER)
+            strategy = MATCH_AFTER;
+    }
+}
+
+static UA_Double
+interpolate(UA_DateTime t0, UA_Double v0, UA_DateTime t1, UA_Double v1, UA_DateTime t)
+{
+    if (t1 == t0)
+        return v0;
+    return v0 + (v1 - v0) * ((UA_Double)(t - t0) / (UA_Double)(t1 - t0));
+}
+
+/* The value at the timestamp. Without a sample at that time, the value is
+ * interpolated between the bounding samples. After the last sample, the value
+ * is extrapolated (stepped or sloped). Before the first sample, there is no
+ * value. */
+static UA_StatusCode
+sampleValueAt(const UA_HistorySource *src, UA_DateTime t, UA_Boolean sloped,
+              UA_Double *value, const UA_DataType **type)
+{
+    size_t skipped = 0;
+    UA_DateTime t0, t1;
+    UA_Double v0, v1;
+    UA_Boolean hasAfter = findGoodSample(src, t, MATCH_EQUAL_OR_AFTER, &t1, &v1, type, &skipped);
+    if (hasAfter && t1 == t) {
+        *value = v1;
+        return UA_STATUSCODE_GOOD;
+    }
+    if (!findGoodSample(src, t, MATCH_BEFORE, &t0, &v0, type, &skipped))
+        return UA_STATUSCODE_BADNODATA;
+    if (!hasAfter) {
+        UA_DateTime tPrev;
+        UA_Double vPrev;
+        size_t ignored = 0;
+        if (sloped && findGoodSample(src, t0, MATCH_BEFORE, &tPrev, &vPrev, NULL, &ignored))
+            *value = interpolate(tPrev, vPrev, t0, v0, t);
+        else
+            *value = v0;
+        return UA_STATUSCODE_UNCERTAINDATASUBNORMAL | UA_HISTORIANBITS_INTERPOLATED;
+    }
+    *value = interpolate(t0, v0, t1, v1, t);
+    if (skipped > 0)
+        return UA_STATUSCODE_UNCERTAINDATASUBNORMAL | UA_HISTORIANBITS_INTERPOLATED;
+    return UA_STATUSCODE_GOOD | UA_HISTORIANBITS_INTERPOLATED;
+}
+
+/* Quality of an interval from the share of good samples (Part 13, 5.4.3) */
+static UA_StatusCode
+intervalStatus(const UA_AggregateConfiguration *config, size_t good, size_t bad)
+{
+    if (good == 0)
+        return UA_STATUSCODE_BADNODATA;
+    size_t percentGood = (good * 100) / (good + bad);
+    if (percentGood >= config->percentDataGood)
+        return UA_STATUSCODE_GOOD;
+    if (100 - percentGood >= config->percentDataBad)
+        return UA_STATUSCODE_BAD;
+    return UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+}
+
+/* Integral over [from, to) with the interpolated bounding values */
+static UA_StatusCode
+timeIntegral(const UA_HistorySource *src, const UA_HistoryInterval *iv,
+             UA_DateTime from, UA_DateTime to, UA_Boolean sloped,
+             UA_Double *integral, UA_DateTime *covered)
+{
+    UA_Double vFrom, vTo;
+    UA_StatusCode result = UA_STATUSCODE_GOOD;
+    UA_StatusCode statusTo = sampleValueAt(src, to, sloped, &vTo, NULL);
+    if (statusTo & UA_STATUSCODE_BAD)
+        return UA_STATUSCODE_BADNODATA;
+    if (statusTo & UA_STATUSCODE_UNCERTAIN)
+        result = UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+    UA_StatusCode statusFrom = sampleValueAt(src, from, sloped, &vFrom, NULL);
+    if (statusFrom & UA_STATUSCODE_BAD) {
+        /* The interval starts before the first sample */
+        if (iv->good == 0)
+            return UA_STATUSCODE_BADNODATA;
+        from = iv->firstTime;
+        vFrom = iv->first;
+        result = UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+    } else if (statusFrom & UA_STATUSCODE_UNCERTAIN) {
+        result = UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+    }
+
+    if (iv->good == 0) {
+        *integral = (UA_Double)(to - from) * (vFrom + vTo) * 0.5;
+    } else {
+        *integral = (UA_Double)(iv->firstTime - from) * (vFrom + iv->first) * 0.5;
+        *integral += iv->integral;
+        *integral += (UA_Double)(to - iv->lastTime) * (iv->last + vTo) * 0.5;
+    }
+    *covered = to - from;
+    return result;
+}
+
+static void
+setTimestamps(UA_DataValue *dv, UA_DateTime timestamp,
+              UA_TimestampsToReturn timestampsToReturn)
+{
+    if (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE ||
+        timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        dv->hasSourceTimestamp = true;
+        dv->sourceTimestamp = timestamp;
+    }
+    if (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+        timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        dv->hasServerTimestamp = true;
+        dv->serverTimestamp = timestamp;
+    }
+}
+
+/* Compute the aggregate over the interval [from, to). The result carries the
+ * timestamp of the interval. */
+static void
+computeAggregate(UA_HistoryAggregate aggregate,
+                 const UA_HistorySource *src,
+                 const UA_HistoryInterval *iv,
+                 const UA_AggregateConfiguration *config,
+                 UA_DateTime from,
+                 UA_DateTime to,
+                 UA_DateTime timestamp,
+                 UA_Boolean partial,
+                 UA_TimestampsToReturn timestampsToReturn,
+                 UA_DataValue *dv)
+{
+    size_t good = iv->good;
+    size_t bad = iv->bad;
+    UA_StatusCode result = intervalStatus(config, good, bad);
+    UA_StatusCode bits = UA_HISTORIANBITS_CALCULATED;
+    const UA_DataType *rawType = NULL;
+    UA_Double d = 0.0;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+
+    switch (aggregate) {
+    case UA_HISTORYAGGREGATE_COUNT: {
+        if (good + bad == 0)
+            result = UA_STATUSCODE_GOOD;
+        if (!(result & UA_STATUSCODE_BAD)) {
+            UA_UInt32 count = (UA_UInt32)good;
+            retval = UA_Variant_setScalarCopy(&dv->value, &count, &UA_TYPES[UA_TYPES_UINT32]);
+        }
+        break;
+    }
+    case UA_HISTORYAGGREGATE_AVERAGE:
+        if (good > 0)
+            d = iv->sum / (UA_Double)good;
+        break;
+    case UA_HISTORYAGGREGATE_MINIMUM:
+    case UA_HISTORYAGGREGATE_MAXIMUM:
+        if (good > 0) {
+            UA_Boolean maximum = (aggregate == UA_HISTORYAGGREGATE_MAXIMUM);
+            d = maximum ? iv->max : iv->min;
+            timestamp = maximum ? iv->maxTime : iv->minTime;
+            rawType = iv->type;
+            bits = 0;
+        }
+        break;
+    case UA_HISTORYAGGREGATE_RANGE:
+        if (good > 0)
+            d = iv->max - iv->min;
+        break;
+    case UA_HISTORYAGGREGATE_START:
+    case UA_HISTORYAGGREGATE_END:
+        if (good > 0) {
+            UA_Boolean start = (aggregate == UA_HISTORYAGGREGATE_START);
+            d = start ? iv->first : iv->last;
+            timestamp = start ? iv->firstTime : iv->lastTime;
+            rawType = iv->type;
+            bits = 0;
+        }
+        break;
+    case UA_HISTORYAGGREGATE_DELTA:
+        if (good > 0)
+            d = iv->last - iv->first;
+        break;
+    case UA_HISTORYAGGREGATE_INTERPOLATIVE:
+        result = sampleValueAt(src, timestamp, config->useSlopedExtrapolation, &d, &rawType);
+        bits = 0;
+        break;
+    case UA_HISTORYAGGREGATE_TIMEAVERAGE:
+    case UA_HISTORYAGGREGATE_TOTAL: {
+        /* Without raw samples in the interval, only the bounds are used */
+        if (good + bad == 0)
+            result = UA_STATUSCODE_GOOD;
+        if (result & UA_STATUSCODE_BAD)
+            break;
+        UA_Double integral = 0.0;
+        UA_DateTime covered = 0;
+        UA_StatusCode integralStatus =
+            timeIntegral(src, iv, from, to, config->useSlopedExtrapolation,
+                         &integral, &covered);
+        if (integralStatus & UA_STATUSCODE_BAD) {
+            result = integralStatus;
+            break;
+        }
+        if (result == UA_STATUSCODE_GOOD)
+            result = integralStatus;
+        if (aggregate == UA_HISTORYAGGREGATE_TOTAL)
+            d = integral / (UA_Double)UA_DATETIME_SEC;
+        else
+            d = (covered > 0) ? integral / (UA_Double)covered : 0.0;
+        break;
+    }
+    default:
+        result = UA_STATUSCODE_BADAGGREGATENOTSUPPORTED;
+        break;
+    }
+
+    if (!(result & UA_STATUSCODE_BAD) && aggregate != UA_HISTORYAGGREGATE_COUNT)
+        retval = setNumericValue(&dv->value, d,
+                                 rawType ? rawType : &UA_TYPES[UA_TYPES_DOUBLE]);
+    if (retval != UA_STATUSCODE_GOOD)
+        result = retval;
+    if (!(result & UA_STATUSCODE_BAD)) {
+        dv->hasValue = true;
+        result |= bits;
+        if (partial)
+            result |= UA_HISTORIANBITS_PARTIAL;
+    }
+    dv->hasStatus = (result != UA_STATUSCODE_GOOD);
+    dv->status = result;
+    setTimestamps(dv, timestamp, timestampsToReturn);
+}
+
+static UA_StatusCode
+readProcessedNode_service_default(UA_Server *server,
+                                  const UA_NodeId *sessionId,
+                                  void *sessionContext,
+                                  const UA_HistorizingNodeIdSettings *setting,
+                                  const UA_NodeId *nodeId,
+                                  const UA_ReadProcessedDetails *details,
+                                  UA_HistoryAggregate aggregate,
+                                  const UA_AggregateConfiguration *config,
+                                  UA_TimestampsToReturn timestampsToReturn,
+                                  const UA_ByteString *continuationPoint,
+                                  UA_ByteString *outContinuationPoint,
+                                  UA_HistoryData *historyData)
+{
+    if (details->startTime == details->endTime || details->processingInterval < 0.0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    /* Split into intervals. Without a processing interval, the whole range
+     * is one interval. In reverse order, the intervals start at startTime
+     * and go backwards. */
+    UA_Boolean reverse = details->endTime < details->startTime;
+    UA_DateTime lo = reverse ? details->endTime : details->startTime;
+    UA_DateTime hi = reverse ? details->startTime : details->endTime;
+    UA_UInt64 uspan = (UA_UInt64)hi - (UA_UInt64)lo;
+    if (uspan > UA_INT64_MAX)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_DateTime span = (UA_DateTime)uspan;
+    UA_Double intervalMsec = details->processingInterval * UA_DATETIME_MSEC;
+    UA_DateTime interval = span;
+    UA_UInt64 intervals = 1;
+    if (intervalMsec >= 1.0 && intervalMsec < (UA_Double)span) {
+        interval = (UA_DateTime)intervalMsec;
+        intervals = ((UA_UInt64)span + (UA_UInt64)interval - 1) / (UA_UInt64)interval;
+    }
+
+    size_t skip = 0;
+    if (continuationPoint->length > 0) {
+        if (continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&skip, continuationPoint->data, sizeof(size_t));
+        if (skip >= intervals)
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+    }
+    size_t count = UA_HISTORYPROCESSED_MAXVALUES;
+    if (intervals - skip < count)
+        count = (size_t)(intervals - skip);
+    if (setting->maxHistoryDataResponseSize > 0 && count > setting->maxHistoryDataResponseSize)
+        count = setting->maxHistoryDataResponseSize;
+
+    historyData->dataValues = (UA_DataValue*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if (!historyData->dataValues)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    historyData->dataValuesSize = count;
+
+    /* The raw samples are streamed interval by interval */
+    UA_HistorySource src;
+    src.backend = &setting->historizingBackend;
+    src.server = server;
+    src.sessionId = sessionId;
+    src.sessionContext = sessionContext;
+    src.nodeId = nodeId;
+    src.treatUncertainAsBad = config->treatUncertainAsBad;
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for (size_t i = 0; i < count; ++i) {
+        UA_DateTime from, to, timestamp;
+        size_t k = skip + i;
+        if (reverse) {
+            to = hi - ((UA_DateTime)k * interval);
+            from = (to - lo > interval) ? to - interval : lo;
+            timestamp = to;
+        } else {
+            from = lo + ((UA_DateTime)k * interval);
+            to = (hi - from > interval) ? from + interval : hi;
+            timestamp = from;
+        }
+        UA_HistoryInterval iv;
+        retval = loadInterval(&src, from, to, &iv);
+        if (retval != UA_STATUSCODE_GOOD) {
+            UA_Array_delete(historyData->dataValues, historyData->dataValuesSize,
+                            &UA_TYPES[UA_TYPES_DATAVALUE]);
+            historyData->dataValues = NULL;
+            historyData->dataValuesSize = 0;
+            return retval;
+        }
+        computeAggregate(aggregate, &src, &iv, config, from, to, timestamp,
+                         (to - from) < interval, timestampsToReturn,
+                         &historyData->dataValues[i]);
+    }
+
+    /* More intervals remain */
+    if (skip + count < intervals) {
+        retval = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(size_t));
+        if (retval != UA_STATUSCODE_GOOD)
+            return retval;
+        size_t next = skip + count;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Return no results, only the service result */
+static void
+rejectRequest(UA_HistoryReadResponse *response, UA_StatusCode serviceResult)
+{
+    UA_Array_delete(response->results, response->resultsSize,
+                    &UA_TYPES[UA_TYPES_HISTORYREADRESULT]);
+    response->results = NULL;
+    response->resultsSize = 0;
+    response->responseHeader.serviceResult = serviceResult;
+}
+
+static void
+readProcessed_service_default(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_RequestHeader *requestHeader,
+                              const UA_ReadProcessedDetails *historyReadDetails,
+                              UA_TimestampsToReturn timestampsToReturn,
+                              UA_Boolean releaseContinuationPoints,
+                              size_t nodesToReadSize,
+                              const UA_HistoryReadValueId *nodesToRead,
+                              UA_HistoryReadResponse *response,
+                              UA_HistoryData * const * const historyData)
+{
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    if (historyReadDetails->aggregateTypeSize != nodesToReadSize) {
+        rejectRequest(response, UA_STATUSCODE_BADAGGREGATELISTMISMATCH);
+        return;
+    }
+
+    /* Server defaults for the aggregate configuration (Part 13, 4.2.1.2) */
+    UA_AggregateConfiguration config = historyReadDetails->aggregateConfiguration;
+    if (config.useServerCapabilitiesDefaults) {
+        config.treatUncertainAsBad = true;
+        config.percentDataBad = 100;
+        config.percentDataGood = 100;
+        config.useSlopedExtrapolation = false;
+    } else if (config.percentDataBad > 100 || config.percentDataGood > 100 ||
+               config.percentDataGood + config.percentDataBad < 100) {
+        rejectRequest(response, UA_STATUSCODE_BADAGGREGATECONFIGURATIONREJECTED);
+        return;
+    }
+
+    for (size_t i = 0; i < nodesToReadSize; ++i) {
+        UA_HistoryAggregate aggregate =
+            getAggregate_service_default(&historyReadDetails->aggregateType[i]);
+        if (aggregate == UA_HISTORYAGGREGATE_UNSUPPORTED) {
+            response->results[i].statusCode = UA_STATUSCODE_BADAGGREGATENOTSUPPORTED;
+            continue;
+        }
+
+        const UA_HistorizingNodeIdSettings *setting =
+            getReadSetting_service_default(server, ctx, &nodesToRead[i].nodeId,
+                                           &response->results[i].statusCode);
+        if (!setting)
+            continue;
+
+        /* Continuation points keep no state. Nothing to release. */
+        if (releaseContinuationPoints)
+            continue;
+
+        response->results[i].statusCode =
+            readProcessedNode_service_default(server, sessionId, sessionContext, setting,
+                                              &nodesToRead[i].nodeId, historyReadDetails,
+                                              aggregate, &config, timestampsToReturn,
+                                              &nodesToRead[i].continuationPoint,
+                                              &response->results[i].continuationPoint,
+                                              historyData[i]);
+    }
+    response->responseHeader.serviceResult = UA_STATUSCODE_GOOD;
+}
+
+/* Find the closest good sample before (or after) the timestamp. With simple
+ * bounds, the closest sample is used regardless of its status. */
+static UA_StatusCode
+findBound(const UA_HistoryDataBackend *backend,
+          UA_Server *server,
+          const UA_NodeId *sessionId,
+          void *sessionContext,
+          const UA_NodeId *nodeId,
+          UA_DateTime timestamp,
+          MatchStrategy strategy,
+          UA_Boolean useSimpleBounds,
+          UA_DataValue *bound)
+{
+    size_t storeEnd = backend->getEnd(server, backend->context, sessionId, sessionContext, nodeId);
+    while (true) {
+        size_t index = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                                 sessionContext, nodeId, timestamp, strategy);
+        if (index == storeEnd)
+            return UA_STATUSCODE_BADNODATA;
+        const UA_DataValue *value =
+            backend->getDataValue(server, backend->context, sessionId, sessionContext, nodeId, index);
+        if (!value)
+            return UA_STATUSCODE_BADNODATA;
+        if (useSimpleBounds || isGoodSample(value, true))
+            return UA_DataValue_copy(value, bound);
+        timestamp = sampleTime(value);
+    }
+}
+
+/* Remove the timestamps of a raw value that were not requested */
+static void
+filterTimestamps(UA_DataValue *dv, UA_TimestampsToReturn timestampsToReturn)
+{
+    if (timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+        timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER) {
+        dv->hasSourceTimestamp = false;
+        dv->hasSourcePicoseconds = false;
+        dv->sourceTimestamp = 0;
+        dv->sourcePicoseconds = 0;
+    }
+    if (timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE ||
+        timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER) {
+        dv->hasServerTimestamp = false;
+        dv->hasServerPicoseconds = false;
+        dv->serverTimestamp = 0;
+        dv->serverPicoseconds = 0;
+    }
+}
+
+static UA_StatusCode
+valueAtTime_service_default(const UA_HistoryDataBackend *backend,
+                            UA_Server *server,
+                            const UA_NodeId *sessionId,
+                            void *sessionContext,
+                            const UA_NodeId *nodeId,
+                            UA_DateTime timestamp,
+                            UA_Boolean useSimpleBounds,
+                            UA_TimestampsToReturn timestampsToReturn,
+                            UA_DataValue *dv)
+{
+    /* Raw value at that time */
+    size_t storeEnd = backend->getEnd(server, backend->context, sessionId, sessionContext, nodeId);
+    size_t index = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                             sessionContext, nodeId, timestamp, MATCH_EQUAL);
+    if (index != storeEnd) {
+        const UA_DataValue *value =
+            backend->getDataValue(server, backend->context, sessionId, sessionContext, nodeId, index);
+        if (value) {
+            UA_StatusCode retval = UA_DataValue_copy(value, dv);
+            filterTimestamps(dv, timestampsToReturn);
+            return retval;
+        }
+    }
+
+    UA_DataValue before, after;
+    UA_DataValue_init(&before);
+    UA_DataValue_init(&after);
+    UA_StatusCode retval = findBound(backend, server, sessionId, sessionContext, nodeId,
+                                     timestamp, MATCH_BEFORE, useSimpleBounds, &before);
+    if (retval != UA_STATUSCODE_GOOD) {
+        dv->hasStatus = true;
+        dv->status = (retval == UA_STATUSCODE_BADNODATA) ? retval : UA_STATUSCODE_BADOUTOFMEMORY;
+        setTimestamps(dv, timestamp, timestampsToReturn);
+        return (retval == UA_STATUSCODE_BADNODATA) ? UA_STATUSCODE_GOOD : retval;
+    }
+    UA_StatusCode afterStatus = findBound(backend, server, sessionId, sessionContext, nodeId,
+                                          timestamp, MATCH_AFTER, useSimpleBounds, &after);
+
+    /* Interpolate between numeric bounds. Otherwise the value before is
+     * extrapolated stepped. */
+    UA_Double v0, v1;
+    UA_StatusCode result = UA_STATUSCODE_GOOD;
+    if (afterStatus == UA_STATUSCODE_GOOD &&
+        variantToDouble(&before.value, &v0) && variantToDouble(&after.value, &v1)) {
+        retval = setNumericValue(&dv->value,
+                                 interpolate(sampleTime(&before), v0,
+                                             sampleTime(&after), v1, timestamp),
+                                 before.value.type);
+        if (!isGoodSample(&before, true) || !isGoodSample(&after, true))
+            result = UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+    } else {
+        retval = UA_Variant_copy(&before.value, &dv->value);
+        if (afterStatus != UA_STATUSCODE_GOOD || !isGoodSample(&before, true))
+            result = UA_STATUSCODE_UNCERTAINDATASUBNORMAL;
+    }
+    UA_DataValue_clear(&before);
+    UA_DataValue_clear(&after);
+    if (retval != UA_STATUSCODE_GOOD)
+        return retval;
+    dv->hasValue = true;
+    dv->hasStatus = true;
+    dv->status = result | UA_HISTORIANBITS_INTERPOLATED;
+    setTimestamps(dv, timestamp, timestampsToReturn);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+readAtTime_service_default(UA_Server *server,
+                           void *context,
+                           const UA_NodeId *sessionId,
+                           void *sessionContext,
+                           const UA_RequestHeader *requestHeader,
+                           const UA_ReadAtTimeDetails *historyReadDetails,
+                           UA_TimestampsToReturn timestampsToReturn,
+                           UA_Boolean releaseContinuationPoints,
+                           size_t nodesToReadSize,
+                           const UA_HistoryReadValueId *nodesToRead,
+                           UA_HistoryReadResponse *response,
+                           UA_HistoryData * const * const historyData)
+{
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    for (size_t i = 0; i < nodesToReadSize; ++i) {
+        const UA_HistorizingNodeIdSettings *setting =
+            getReadSetting_service_default(server, ctx, &nodesToRead[i].nodeId,
+                                           &response->results[i].statusCode);
+        if (!setting)
+            continue;
+
+        const UA_HistoryDataBackend *backend = &setting->historizingBackend;
+        if (!backend->timestampsToReturnSupported(server, backend->context, sessionId,
+                                                  sessionContext, &nodesToRead[i].nodeId,
+                                                  timestampsToReturn)) {
+            response->results[i].statusCode = UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+            continue;
+        }
+
+        if (releaseContinuationPoints)
+            continue;
+
+        /* The continuation point is the index of the next requested time */
+        size_t skip = 0;
+        const UA_ByteString *continuationPoint = &nodesToRead[i].continuationPoint;
+        if (continuationPoint->length > 0) {
+            if (continuationPoint->length != sizeof(size_t)) {
+                response->results[i].statusCode = UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+                continue;
+            }
+            memcpy(&skip, continuationPoint->data, sizeof(size_t));
+            if (skip >= historyReadDetails->reqTimesSize) {
+                response->results[i].statusCode = UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+                continue;
+            }
+        }
+        size_t count = historyReadDetails->reqTimesSize - skip;
+        if (setting->maxHistoryDataResponseSize > 0 && count > setting->maxHistoryDataResponseSize)
+            count = setting->maxHistoryDataResponseSize;
+        if (count == 0)
+            continue;
+
+        UA_HistoryData *data = historyData[i];
+        data->dataValues = (UA_DataValue*)UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if (!data->dataValues) {
+            response->results[i].statusCode = UA_STATUSCODE_BADOUTOFMEMORY;
+            continue;
+        }
+        data->dataValuesSize = count;
+
+        UA_StatusCode retval = UA_STATUSCODE_GOOD;
+        for (size_t j = 0; j < count && retval == UA_STATUSCODE_GOOD; ++j)
+            retval = valueAtTime_service_default(backend, server, sessionId, sessionContext,
+                                                 &nodesToRead[i].nodeId,
+                                                 historyReadDetails->reqTimes[skip + j],
+                                                 historyReadDetails->useSimpleBounds,
+                                                 timestampsToReturn, &data->dataValues[j]);
+        if (retval == UA_STATUSCODE_GOOD && skip + count < historyReadDetails->reqTimesSize) {
+            UA_ByteString *outContinuationPoint = &response->results[i].continuationPoint;
+            retval = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(size_t));
+            if (retval == UA_STATUSCODE_GOOD) {
+                size_t next = skip + count;
+                memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+            }
+        }
+        if (retval != UA_STATUSCODE_GOOD) {
+            UA_Array_delete(data->dataValues, data->dataValuesSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+            data->dataValues = NULL;
+            data->dataValuesSize = 0;
+            response->results[i].statusCode = retval;
+        }
+    }
+    response->responseHeader.serviceResult = UA_STATUSCODE_GOOD;
+}
+
 static void
 setValue_service_default(UA_Server *server,
                          void *context,
@@ -619,6 +1621,8 @@ UA_HistoryDatabase_default(UA_HistoryDataGathering gathering)
     context->gathering = gathering;
     hdb.context = context;
     hdb.readRaw = &readRaw_service_default;
+    hdb.readProcessed = &readProcessed_service_default;
+    hdb.readAtTime = &readAtTime_service_default;
     hdb.setValue = &setValue_service_default;
     hdb.updateData = &updateData_service_default;
     hdb.deleteRawModified = &deleteRawModified_service_default;
@@ -26,6 +26,41 @@ UA_AccessControl_default(UA_ServerConfig *config, UA_Boolean allowAnonymous,
                          size_t usernamePasswordLoginSize,
                          const UA_UsernamePasswordLogin *usernamePasswordLogin);
 
+/* The logins are kept in a hash table by username. If a crypto backend
+ * (OpenSSL or mbedTLS) is enabled, only a salted PBKDF2-HMAC-SHA256 hash of
+ * the password is stored. The password can also be given in hashed form as
+ * returned by UA_AccessControl_default_hashPassword. A username is locked out
+ * for some time after repeated failed logins, independent of the Session.
+ *
+ * Logins are added to the access control plugin that was set up with
+ * UA_AccessControl_default. Adding the first login also adds the username
+ * token policy to the endpoints that already exist in the config. Usernames
+ * must be unique. Don't add logins while the server is running. */
+UA_EXPORT UA_StatusCode
+UA_AccessControl_default_addLogin(UA_ServerConfig *config, const UA_String *username,
+                                  const UA_String *password);
+
+/* Load logins from a file with one "username:password" per line. Empty lines
+ * and lines starting with '#' are ignored. */
+UA_EXPORT UA_StatusCode
+UA_AccessControl_default_loadLogins(UA_ServerConfig *config, const char *path);
+
+/* Set the PBKDF2 iterations for the passwords that are hashed by the plugin.
+ * The default is 10000. Every login with a username token costs one hashing,
+ * also for unknown usernames. Passwords in hashed form keep the iterations
+ * they were hashed with. Call before adding logins. */
+UA_EXPORT UA_StatusCode
+UA_AccessControl_default_setHashIterations(UA_ServerConfig *config,
+                                           UA_UInt32 iterations);
+
+/* Returns the hashed form "$pbkdf2-sha256$<iterations>$<salt>$<hash>" of a
+ * password with a random salt. The salt and hash are base64-encoded. Zero
+ * iterations select the default. Returns BadNotSupported without a crypto
+ * backend. */
+UA_EXPORT UA_StatusCode
+UA_AccessControl_default_hashPassword(const UA_String *password, UA_UInt32 iterations,
+                                      UA_String *hashed);
+
 _UA_END_DECLS
 
 #endif /* UA_ACCESSCONTROL_DEFAULT_H_ */
@@ -0,0 +1,37 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_COLUMNAR_H_
+#define UA_HISTORYDATABACKEND_COLUMNAR_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#define INITIAL_COLUMNAR_STORE_SIZE 64
+
+/* In-memory backend with columnar storage. The store of a node is found via a
+ * hash-map over the NodeId. Every node keeps its samples in a ring-buffer of
+ * contiguous columns (timestamps, status, values). Scalar values of a numeric
+ * builtin type are stored unboxed in a typed column. Other values fall back to
+ * a column of variants.
+ *
+ * Samples with monotonically increasing timestamps are appended in O(1).
+ * Out-of-order samples are inserted at their sorted position.
+ *
+ * @param initialNodeIdStoreSize Expected number of historized nodes
+ * @param maxValuesPerNode Capacity of the ring-buffer of every node. If full,
+ *        the oldest sample is dropped for every new sample. Zero for an
+ *        unlimited history. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_Columnar(size_t initialNodeIdStoreSize,
+                               size_t maxValuesPerNode);
+
+void UA_EXPORT
+UA_HistoryDataBackend_Columnar_clear(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_COLUMNAR_H_ */
@@ -0,0 +1,52 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_FILE_H_
+#define UA_HISTORYDATABACKEND_FILE_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+#define UA_HISTORYFILE_SEGMENTSIZE (1024 * 1024)
+
+/* Persistent backend on top of memory-mapped files (POSIX only). Every node has
+ * a directory with append-only segment files. The samples are stored in the
+ * binary encoding, ordered by their source (or server) timestamp. A sparse
+ * timestamp index is kept in memory for the binary search. Read requests
+ * decode the samples directly from the mapped pages.
+ *
+ * Samples older than the latest sample of the node are rejected with
+ * BadInvalidTimestamp. Insert, replace, update and remove via HistoryUpdate
+ * are not supported.
+ *
+ * The samples are written to the mapped pages and flushed to disk by the
+ * operating system. A sample that was not written completely before a crash
+ * is detected by its CRC and dropped together with the samples after it.
+ *
+ * The history that exists in the directory is picked up again after a restart.
+ * The returned backend has no context if the directory cannot be opened.
+ * The segment files use the host byte order for their headers and cannot be
+ * moved between architectures of different endianness.
+ *
+ * @param directory The base directory. It is created if it does not exist.
+ * @param segmentSize The size of a segment file in bytes. Zero for the default
+ *        UA_HISTORYFILE_SEGMENTSIZE. When a segment is full, the next one is
+ *        created.
+ * @param maxSegmentsPerNode Retention limit. If the node has more segments,
+ *        the oldest segment file is removed. Zero for an unlimited history.
+ * @param syncEachSample Flush every sample to disk with msync before it
+ *        becomes visible. No sample is lost on a power failure, but the write
+ *        rate is bounded by the synchronous write rate of the disk. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           size_t maxSegmentsPerNode, UA_Boolean syncEachSample);
+
+void UA_EXPORT
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_FILE_H_ */
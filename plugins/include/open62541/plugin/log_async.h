@@ -0,0 +1,68 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#ifndef UA_LOG_ASYNC_H_
+#define UA_LOG_ASYNC_H_
+
+#include <open62541/plugin/log.h>
+#include <open62541/types.h>
+
+_UA_BEGIN_DECLS
+
+/* Asynchronous logging is available only for Linux/Unices.
+ *
+ * The calling thread formats the message into a buffer on its own stack and
+ * pushes it into a bounded lock-free queue. A background thread takes the
+ * messages from the queue and writes them out. So logging does not block on
+ * the output. Messages are dropped (and counted) when the queue is full. The
+ * background thread reports the number of dropped messages in the log. */
+
+#if defined(__linux__) || defined(__unix__)
+
+/* Number of UA_LogCategory values */
+#define UA_LOG_ASYNC_CATEGORIES 7
+
+/* Messages are truncated to this length (including the terminating zero) */
+#define UA_LOG_ASYNC_MESSAGESIZE 512
+
+typedef enum {
+    UA_LOGASYNCTARGET_STDOUT = 0,
+    UA_LOGASYNCTARGET_FILE,
+    UA_LOGASYNCTARGET_SYSLOG /* The programm must call openlog(3) */
+} UA_LogAsyncTarget;
+
+typedef struct {
+    /* Minimum log level for every UA_LogCategory */
+    UA_LogLevel minLevel[UA_LOG_ASYNC_CATEGORIES];
+
+    /* Number of messages that can be queued. Rounded up to a power of two. */
+    size_t queueSize;
+
+    UA_LogAsyncTarget target;
+    const char *path; /* For UA_LOGASYNCTARGET_FILE. The file is appended to. */
+
+    /* Interval in ms after which the background thread looks for new
+     * messages */
+    UA_UInt32 drainInterval;
+} UA_LogAsyncConfig;
+
+/* Log everything from minLevel on to stdout, with a queue of 1024 messages
+ * and a drain interval of 10ms */
+UA_EXPORT void
+UA_LogAsyncConfig_init(UA_LogAsyncConfig *config, UA_LogLevel minLevel);
+
+/* Starts the background thread. The queue is drained and the thread is stopped
+ * in the clear method of the logger. */
+UA_EXPORT UA_StatusCode
+UA_Log_Async_init(UA_Logger *logger, const UA_LogAsyncConfig *config);
+
+/* Number of messages dropped so far because the queue was full */
+UA_EXPORT size_t
+UA_Log_Async_getDropped(const UA_Logger *logger);
+
+#endif
+
+_UA_END_DECLS
+
+#endif /* UA_LOG_ASYNC_H_ */
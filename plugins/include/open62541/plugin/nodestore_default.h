@@ -18,6 +18,21 @@ _UA_BEGIN_DECLS
 UA_EXPORT UA_StatusCode
 UA_Nodestore_HashMap(UA_Nodestore *ns);
 
+/* Move all nodes of the HashMap Nodestore into a read-only layer. The nodes
+ * are flat-copied into a single contiguous memory block with a compact lookup
+ * table. This reduces the heap fragmentation and the memory footprint of large
+ * information models that are loaded once during startup (e.g. namespace zero
+ * and the nodesets from the nodeset compiler). Sealed nodes are not
+ * refcounted.
+ *
+ * Afterwards, added nodes are stored in the hash-map on top of the sealed
+ * layer. Editing a sealed node stores the modified copy in the hash-map where
+ * it shadows the original. Hence, sealing requires
+ * UA_ENABLE_IMMUTABLE_NODES. Call this after the server has been created and
+ * before it is started. Sealing is possible only once. */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_HashMap_seal(UA_Nodestore *ns);
+
 /* The ZipTree Nodestore holds all nodes in RAM in a tree structure. The lookup
  * time is about O(log n). Adding/removing nodes does not require resizing of
  * the underlying array with the linear overhead.
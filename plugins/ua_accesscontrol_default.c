@@ -8,19 +8,86 @@
 
 #include <open62541/plugin/accesscontrol_default.h>
 
+#include <stdio.h>
+
+#if UA_MULTITHREADING >= 100
+#include <pthread.h>
+#endif
+
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL)
+#include <openssl/evp.h>
+#define UA_ACCESSCONTROL_PASSWORDHASH
+#elif defined(UA_ENABLE_ENCRYPTION_MBEDTLS)
+#include <mbedtls/md.h>
+#include <mbedtls/pkcs5.h>
+#define UA_ACCESSCONTROL_PASSWORDHASH
+#endif
+
 /* Example access control management. Anonymous and username / password login.
  * The access rights are maximally permissive.
  *
  * FOR PRODUCTION USE, THIS EXAMPLE PLUGIN SHOULD BE REPLACED WITH LESS
  * PERMISSIVE ACCESS CONTROL.
  *
+ * The logins are kept in a hash table by username. With a crypto backend
+ * (OpenSSL or mbedTLS), only a salted PBKDF2-HMAC-SHA256 hash of the password
+ * is stored. Otherwise the password is stored as is. In both cases, the
+ * password is compared in constant time. After MAXFAILEDLOGINS failed
+ * attempts, a username is locked out for a time that doubles with every further
+ * failure. The failures are counted per username and not per Session, so that
+ * opening a new Session does not reset the count. A locked-out username is
+ * rejected without hashing.
+ *
  * For TransferSubscriptions, we check whether the transfer happens between
  * Sessions for the same user. */
 
+#define PBKDF2_PREFIX "$pbkdf2-sha256$"
+#define PBKDF2_ITERATIONS 10000
+#define PBKDF2_SALTLENGTH 16
+#define PBKDF2_HASHLENGTH 32
+
+#define LOGIN_MININDEXSIZE 16
+#define MAXFAILEDLOGINS 3
+#define LOCKOUT_TIME UA_DATETIME_SEC /* Doubles for every further failure */
+#define LOCKOUT_MAXSHIFT 6
+#define FAILEDLOGINS_MAXSIZE 1024 /* Also unknown usernames are tracked */
+
+typedef struct Login {
+    struct Login *next;
+    UA_UInt32 hash; /* Of the username */
+    UA_String username;
+    UA_UInt32 iterations; /* 0 if the password is not hashed */
+    UA_ByteString salt;
+    UA_ByteString password; /* Or the password hash */
+} Login;
+
+typedef struct FailedLogin {
+    struct FailedLogin *next;
+    UA_UInt32 hash; /* Of the username */
+    UA_String username;
+    UA_UInt32 failures;
+    UA_DateTime lastFailure; /* Monotonic */
+    UA_DateTime lockedUntil; /* Monotonic */
+} FailedLogin;
+
 typedef struct {
     UA_Boolean allowAnonymous;
-    size_t usernamePasswordLoginSize;
-    UA_UsernamePasswordLogin *usernamePasswordLogin;
+    UA_String userTokenPolicyUri;
+    UA_UInt32 hashIterations; /* For newly hashed passwords */
+
+    /* Hash table of the logins */
+    size_t loginsSize;
+    Login **logins;
+    size_t loginsIndexSize;
+
+    /* Hash table of the usernames with failed logins */
+    size_t failedLoginsSize;
+    FailedLogin **failedLogins;
+    size_t failedLoginsIndexSize;
+
+#if UA_MULTITHREADING >= 100
+    pthread_mutex_t failedLoginsMutex;
+#endif
 } AccessControlContext;
 
 #define ANONYMOUS_POLICY "open62541-anonymous-policy"
@@ -28,6 +95,428 @@ typedef struct {
 const UA_String anonymous_policy = UA_STRING_STATIC(ANONYMOUS_POLICY);
 const UA_String username_policy = UA_STRING_STATIC(USERNAME_POLICY);
 
+/*************/
+/* Passwords */
+/*************/
+
+static UA_Boolean
+equalConstantTime(const UA_Byte *a, const UA_Byte *b, size_t length) {
+    volatile UA_Byte diff = 0;
+    for(size_t i = 0; i < length; i++)
+        diff |= (UA_Byte)(a[i] ^ b[i]);
+    return (diff == 0);
+}
+
+#ifdef UA_ACCESSCONTROL_PASSWORDHASH
+static UA_StatusCode
+pbkdf2(const UA_String *password, const UA_ByteString *salt,
+       UA_UInt32 iterations, UA_Byte *out) {
+#if defined(UA_ENABLE_ENCRYPTION_OPENSSL)
+    if(PKCS5_PBKDF2_HMAC((const char*)password->data, (int)password->length,
+                         salt->data, (int)salt->length, (int)iterations,
+                         EVP_sha256(), PBKDF2_HASHLENGTH, out) != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+#else
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    int err = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if(err == 0)
+        err = mbedtls_pkcs5_pbkdf2_hmac(&ctx, password->data, password->length,
+                                        salt->data, salt->length, iterations,
+                                        PBKDF2_HASHLENGTH, out);
+    mbedtls_md_free(&ctx);
+    return (err == 0) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+#endif
+}
+
+/* Parse "$pbkdf2-sha256$<iterations>$<base64 salt>$<base64 hash>" */
+static UA_StatusCode
+parseHashedPassword(const UA_String *hashed, Login *login) {
+    const UA_String prefix = UA_STRING_STATIC(PBKDF2_PREFIX);
+    if(hashed->length <= prefix.length ||
+       memcmp(hashed->data, prefix.data, prefix.length) != 0)
+        return UA_STATUSCODE_BADDECODINGERROR;
+
+    size_t pos = prefix.length;
+    UA_UInt32 iterations = 0;
+    for(; pos < hashed->length && hashed->data[pos] != '$'; pos++) {
+        if(hashed->data[pos] < '0' || hashed->data[pos] > '9' || iterations > 100000000)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        iterations = (iterations * 10) + (UA_UInt32)(hashed->data[pos] - '0');
+    }
+    if(iterations == 0 || pos >= hashed->length)
+        return UA_STATUSCODE_BADDECODINGERROR;
+
+    size_t saltStart = ++pos;
+    for(; pos < hashed->length && hashed->data[pos] != '$'; pos++) {}
+    if(pos >= hashed->length)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    UA_String salt64 = {pos - saltStart, &hashed->data[saltStart]};
+    UA_String hash64 = {hashed->length - pos - 1, &hashed->data[pos + 1]};
+
+    UA_StatusCode res = UA_ByteString_fromBase64(&login->salt, &salt64);
+    res |= UA_ByteString_fromBase64(&login->password, &hash64);
+    if(res != UA_STATUSCODE_GOOD || login->salt.length == 0 ||
+       login->password.length != PBKDF2_HASHLENGTH) {
+        UA_ByteString_clear(&login->salt);
+        UA_ByteString_clear(&login->password);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    login->iterations = iterations;
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
+UA_StatusCode
+UA_AccessControl_default_hashPassword(const UA_String *password, UA_UInt32 iterations,
+                                      UA_String *hashed) {
+#ifdef UA_ACCESSCONTROL_PASSWORDHASH
+    if(iterations == 0)
+        iterations = PBKDF2_ITERATIONS;
+    UA_Byte saltData[PBKDF2_SALTLENGTH];
+    for(size_t i = 0; i < PBKDF2_SALTLENGTH; i += 4) {
+        UA_UInt32 r = UA_UInt32_random();
+        memcpy(&saltData[i], &r, 4);
+    }
+    UA_ByteString salt = {PBKDF2_SALTLENGTH, saltData};
+    UA_Byte hashData[PBKDF2_HASHLENGTH];
+    UA_ByteString hash = {PBKDF2_HASHLENGTH, hashData};
+    UA_StatusCode res = pbkdf2(password, &salt, iterations, hashData);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    UA_String salt64 = UA_STRING_NULL, hash64 = UA_STRING_NULL;
+    res = UA_ByteString_toBase64(&salt, &salt64);
+    res |= UA_ByteString_toBase64(&hash, &hash64);
+    if(res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    char buf[128];
+    int len = snprintf(buf, sizeof(buf), PBKDF2_PREFIX "%u$%.*s$%.*s",
+                       (unsigned)iterations, (int)salt64.length,
+                       (char*)salt64.data, (int)hash64.length, (char*)hash64.data);
+    if(len < 0 || (size_t)len >= sizeof(buf)) {
+        res = UA_STATUSCODE_BADINTERNALERROR;
+        goto cleanup;
+    }
+    *hashed = UA_STRING_ALLOC(buf);
+    if(!hashed->data)
+        res = UA_STATUSCODE_BADOUTOFMEMORY;
+
+ cleanup:
+    UA_String_clear(&salt64);
+    UA_String_clear(&hash64);
+    return res;
+#else
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+}
+
+static UA_Boolean
+verifyPassword(const Login *login, const UA_String *password) {
+#ifdef UA_ACCESSCONTROL_PASSWORDHASH
+    if(login->iterations > 0) {
+        UA_Byte hash[PBKDF2_HASHLENGTH];
+        if(pbkdf2(password, &login->salt, login->iterations, hash) != UA_STATUSCODE_GOOD)
+            return false;
+        return equalConstantTime(hash, login->password.data, PBKDF2_HASHLENGTH);
+    }
+#endif
+    if(password->length != login->password.length)
+        return false;
+    return equalConstantTime(password->data, login->password.data, password->length);
+}
+
+/* Spend the same time for an unknown username as for a known one */
+static void
+verifyDummyPassword(const AccessControlContext *context, const UA_String *password) {
+#ifdef UA_ACCESSCONTROL_PASSWORDHASH
+    UA_Byte saltData[PBKDF2_SALTLENGTH] = {0};
+    UA_ByteString salt = {PBKDF2_SALTLENGTH, saltData};
+    UA_Byte hash[PBKDF2_HASHLENGTH];
+    pbkdf2(password, &salt, context->hashIterations, hash);
+#endif
+}
+
+/**********/
+/* Logins */
+/**********/
+
+static void
+Login_delete(Login *login) {
+    UA_String_clear(&login->username);
+    UA_ByteString_clear(&login->salt);
+    UA_ByteString_clear(&login->password);
+    UA_free(login);
+}
+
+/* Rebuild the index with the new number of buckets. The old index is kept if
+ * the allocation fails. */
+static void
+resizeLoginsIndex(AccessControlContext *context, size_t indexSize) {
+    Login **index = (Login**)UA_calloc(indexSize, sizeof(Login*));
+    if(!index)
+        return;
+    for(size_t i = 0; i < context->loginsIndexSize; i++) {
+        Login *login = context->logins[i];
+        while(login) {
+            Login *next = login->next;
+            size_t bucket = login->hash & (indexSize - 1);
+            login->next = index[bucket];
+            index[bucket] = login;
+            login = next;
+        }
+    }
+    UA_free(context->logins);
+    context->logins = index;
+    context->loginsIndexSize = indexSize;
+}
+
+static Login *
+findLogin(const AccessControlContext *context, const UA_String *username) {
+    if(!context->logins)
+        return NULL;
+    UA_UInt32 hash = UA_ByteString_hash(0, username->data, username->length);
+    Login *login = context->logins[hash & (context->loginsIndexSize - 1)];
+    for(; login; login = login->next) {
+        if(login->hash == hash && UA_String_equal(&login->username, username))
+            return login;
+    }
+    return NULL;
+}
+
+/* Takes ownership of the login */
+static UA_StatusCode
+insertLogin(AccessControlContext *context, Login *login) {
+    if(findLogin(context, &login->username)) {
+        Login_delete(login);
+        return UA_STATUSCODE_BADALREADYEXISTS;
+    }
+
+    /* Grow the index to keep at most one login per bucket on average */
+    if(context->loginsSize + 1 > context->loginsIndexSize) {
+        size_t indexSize = context->loginsIndexSize * 2;
+        if(indexSize < LOGIN_MININDEXSIZE)
+            indexSize = LOGIN_MININDEXSIZE;
+        resizeLoginsIndex(context, indexSize);
+        if(!context->logins) {
+            Login_delete(login);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+
+    login->hash = UA_ByteString_hash(0, login->username.data, login->username.length);
+    size_t bucket = login->hash & (context->loginsIndexSize - 1);
+    login->next = context->logins[bucket];
+    context->logins[bucket] = login;
+    context->loginsSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The password is either plain text or hashed with the PBKDF2_PREFIX */
+static UA_StatusCode
+addLogin(AccessControlContext *context, const UA_String *username,
+         const UA_String *password) {
+    if(username->length == 0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    Login *login = (Login*)UA_calloc(1, sizeof(Login));
+    if(!login)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = UA_String_copy(username, &login->username);
+    if(res != UA_STATUSCODE_GOOD) {
+        Login_delete(login);
+        return res;
+    }
+
+    const UA_String prefix = UA_STRING_STATIC(PBKDF2_PREFIX);
+    UA_Boolean isHashed = (password->length > prefix.length &&
+                           memcmp(password->data, prefix.data, prefix.length) == 0);
+#ifdef UA_ACCESSCONTROL_PASSWORDHASH
+    if(isHashed) {
+        res = parseHashedPassword(password, login);
+    } else {
+        /* Hash the plain text password */
+        UA_String hashed = UA_STRING_NULL;
+        res = UA_AccessControl_default_hashPassword(password, context->hashIterations,
+                                                    &hashed);
+        if(res == UA_STATUSCODE_GOOD)
+            res = parseHashedPassword(&hashed, login);
+        UA_String_clear(&hashed);
+    }
+#else
+    if(isHashed)
+        res = UA_STATUSCODE_BADNOTSUPPORTED; /* No crypto backend */
+    else
+        res = UA_ByteString_copy(password, &login->password);
+#endif
+    if(res != UA_STATUSCODE_GOOD) {
+        Login_delete(login);
+        return res;
+    }
+    return insertLogin(context, login);
+}
+
+/*****************/
+/* Failed Logins */
+/*****************/
+
+static void
+FailedLogin_delete(FailedLogin *fl) {
+    UA_String_clear(&fl->username);
+    UA_free(fl);
+}
+
+static void
+resizeFailedLoginsIndex(AccessControlContext *context, size_t indexSize) {
+    FailedLogin **index = (FailedLogin**)UA_calloc(indexSize, sizeof(FailedLogin*));
+    if(!index)
+        return;
+    for(size_t i = 0; i < context->failedLoginsIndexSize; i++) {
+        FailedLogin *fl = context->failedLogins[i];
+        while(fl) {
+            FailedLogin *next = fl->next;
+            size_t bucket = fl->hash & (indexSize - 1);
+            fl->next = index[bucket];
+            index[bucket] = fl;
+            fl = next;
+        }
+    }
+    UA_free(context->failedLogins);
+    context->failedLogins = index;
+    context->failedLoginsIndexSize = indexSize;
+}
+
+/* Returns the pointer to the entry in its bucket */
+static FailedLogin **
+findFailedLogin(const AccessControlContext *context, const UA_String *username,
+                UA_UInt32 hash) {
+    if(!context->failedLogins)
+        return NULL;
+    FailedLogin **pos = &context->failedLogins
+        [hash & (context->failedLoginsIndexSize - 1)];
+    for(; *pos; pos = &(*pos)->next) {
+        if((*pos)->hash == hash && UA_String_equal(&(*pos)->username, username))
+            return pos;
+    }
+    return NULL;
+}
+
+/* Shrink the index when it has become sparse */
+static void
+shrinkFailedLoginsIndex(AccessControlContext *context) {
+    if(context->failedLoginsIndexSize > LOGIN_MININDEXSIZE &&
+       context->failedLoginsSize < context->failedLoginsIndexSize / 4)
+        resizeFailedLoginsIndex(context, context->failedLoginsIndexSize / 2);
+}
+
+static void
+removeFailedLogin(AccessControlContext *context, const UA_String *username) {
+    UA_UInt32 hash = UA_ByteString_hash(0, username->data, username->length);
+    FailedLogin **pos = findFailedLogin(context, username, hash);
+    if(!pos)
+        return;
+    FailedLogin *fl = *pos;
+    *pos = fl->next;
+    FailedLogin_delete(fl);
+    context->failedLoginsSize--;
+    shrinkFailedLoginsIndex(context);
+}
+
+/* Drop the entries whose last failure is older than the longest lockout */
+static void
+purgeFailedLogins(AccessControlContext *context, UA_DateTime now) {
+    UA_DateTime expired = now - (LOCKOUT_TIME << LOCKOUT_MAXSHIFT);
+    for(size_t i = 0; i < context->failedLoginsIndexSize; i++) {
+        FailedLogin **pos = &context->failedLogins[i];
+        while(*pos) {
+            FailedLogin *fl = *pos;
+            if(fl->lastFailure > expired || fl->lockedUntil > now) {
+                pos = &fl->next;
+                continue;
+            }
+            *pos = fl->next;
+            FailedLogin_delete(fl);
+            context->failedLoginsSize--;
+        }
+    }
+    shrinkFailedLoginsIndex(context);
+}
+
+static UA_Boolean
+isLockedOut(AccessControlContext *context, const UA_String *username) {
+    UA_UInt32 hash = UA_ByteString_hash(0, username->data, username->length);
+    FailedLogin **pos = findFailedLogin(context, username, hash);
+    return (pos && (*pos)->lockedUntil > UA_DateTime_nowMonotonic());
+}
+
+static void
+recordFailedLogin(AccessControlContext *context, const UA_String *username) {
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    UA_UInt32 hash = UA_ByteString_hash(0, username->data, username->length);
+    FailedLogin *fl;
+    FailedLogin **pos = findFailedLogin(context, username, hash);
+    if(pos) {
+        fl = *pos;
+    } else {
+        /* Bound the memory when many different usernames are tried. If the
+         * table is still full, the failure is not recorded. */
+        if(context->failedLoginsSize >= FAILEDLOGINS_MAXSIZE) {
+            purgeFailedLogins(context, now);
+            if(context->failedLoginsSize >= FAILEDLOGINS_MAXSIZE)
+                return;
+        }
+        if(context->failedLoginsSize + 1 > context->failedLoginsIndexSize) {
+            size_t indexSize = context->failedLoginsIndexSize * 2;
+            if(indexSize < LOGIN_MININDEXSIZE)
+                indexSize = LOGIN_MININDEXSIZE;
+            resizeFailedLoginsIndex(context, indexSize);
+            if(!context->failedLogins)
+                return;
+        }
+        fl = (FailedLogin*)UA_calloc(1, sizeof(FailedLogin));
+        if(!fl)
+            return;
+        if(UA_String_copy(username, &fl->username) != UA_STATUSCODE_GOOD) {
+            UA_free(fl);
+            return;
+        }
+        fl->hash = hash;
+        size_t bucket = hash & (context->failedLoginsIndexSize - 1);
+        fl->next = context->failedLogins[bucket];
+        context->failedLogins[bucket] = fl;
+        context->failedLoginsSize++;
+    }
+
+    /* Start counting anew if the last failure is long ago */
+    if(fl->lastFailure < now - (LOCKOUT_TIME << LOCKOUT_MAXSHIFT) &&
+       fl->lockedUntil <= now)
+        fl->failures = 0;
+    fl->lastFailure = now;
+    fl->failures++;
+    if(fl->failures < MAXFAILEDLOGINS)
+        return;
+    UA_UInt32 shift = fl->failures - MAXFAILEDLOGINS;
+    if(shift > LOCKOUT_MAXSHIFT)
+        shift = LOCKOUT_MAXSHIFT;
+    fl->lockedUntil = now + (LOCKOUT_TIME << shift);
+}
+
+static void
+lockFailedLogins(AccessControlContext *context) {
+#if UA_MULTITHREADING >= 100
+    pthread_mutex_lock(&context->failedLoginsMutex);
+#endif
+}
+
+static void
+unlockFailedLogins(AccessControlContext *context) {
+#if UA_MULTITHREADING >= 100
+    pthread_mutex_unlock(&context->failedLoginsMutex);
+#endif
+}
+
 /************************/
 /* Access Control Logic */
 /************************/
@@ -90,15 +579,28 @@ activateSession_default(UA_Server *server, UA_AccessControl *ac,
         if(userToken->userName.length == 0 && userToken->password.length == 0)
             return UA_STATUSCODE_BADIDENTITYTOKENINVALID;
 
+        /* Reject without checking the password if the username has failed
+         * too often */
+        lockFailedLogins(context);
+        UA_Boolean locked = isLockedOut(context, &userToken->userName);
+        unlockFailedLogins(context);
+        if(locked)
+            return UA_STATUSCODE_BADUSERACCESSDENIED;
+
         /* Try to match username/pw */
         UA_Boolean match = false;
-        for(size_t i = 0; i < context->usernamePasswordLoginSize; i++) {
-            if(UA_String_equal(&userToken->userName, &context->usernamePasswordLogin[i].username) &&
-               UA_String_equal(&userToken->password, &context->usernamePasswordLogin[i].password)) {
-                match = true;
-                break;
-            }
-        }
+        const Login *login = findLogin(context, &userToken->userName);
+        if(login)
+            match = verifyPassword(login, &userToken->password);
+        else
+            verifyDummyPassword(context, &userToken->password);
+
+        lockFailedLogins(context);
+        if(match)
+            removeFailedLogin(context, &userToken->userName);
+        else
+            recordFailedLogin(context, &userToken->userName);
+        unlockFailedLogins(context);
         if(!match)
             return UA_STATUSCODE_BADUSERACCESSDENIED;
 
@@ -234,17 +736,136 @@ static void clear_default(UA_AccessControl *ac) {
     AccessControlContext *context = (AccessControlContext*)ac->context;
 
     if (context) {
-        for(size_t i = 0; i < context->usernamePasswordLoginSize; i++) {
-            UA_String_clear(&context->usernamePasswordLogin[i].username);
-            UA_String_clear(&context->usernamePasswordLogin[i].password);
+        for(size_t i = 0; i < context->loginsIndexSize; i++) {
+            Login *login = context->logins[i];
+            while(login) {
+                Login *next = login->next;
+                Login_delete(login);
+                login = next;
+            }
+        }
+        UA_free(context->logins);
+        for(size_t i = 0; i < context->failedLoginsIndexSize; i++) {
+            FailedLogin *fl = context->failedLogins[i];
+            while(fl) {
+                FailedLogin *next = fl->next;
+                FailedLogin_delete(fl);
+                fl = next;
+            }
         }
-        if(context->usernamePasswordLoginSize > 0)
-            UA_free(context->usernamePasswordLogin);
+        UA_free(context->failedLogins);
+        UA_String_clear(&context->userTokenPolicyUri);
+#if UA_MULTITHREADING >= 100
+        pthread_mutex_destroy(&context->failedLoginsMutex);
+#endif
         UA_free(ac->context);
         ac->context = NULL;
     }
 }
 
+/* Append a copy of the policy unless there is already one for the token type */
+static UA_StatusCode
+appendUserTokenPolicy(UA_UserTokenPolicy **policies, size_t *policiesSize,
+                      const UA_UserTokenPolicy *policy) {
+    for(size_t i = 0; i < *policiesSize; i++) {
+        if((*policies)[i].tokenType == policy->tokenType)
+            return UA_STATUSCODE_GOOD;
+    }
+    /* An empty array can be the UA_EMPTY_ARRAY_SENTINEL */
+    UA_UserTokenPolicy *newPolicies = (UA_UserTokenPolicy*)
+        UA_realloc((*policiesSize > 0) ? *policies : NULL,
+                   (*policiesSize + 1) * sizeof(UA_UserTokenPolicy));
+    if(!newPolicies)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    *policies = newPolicies;
+    UA_StatusCode res = UA_UserTokenPolicy_copy(policy, &newPolicies[*policiesSize]);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    (*policiesSize)++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Advertise the username policy once there are logins. The endpoints copy the
+ * policies of the access control plugin when they are created. So endpoints
+ * that already exist get the policy as well. */
+static UA_StatusCode
+addUsernamePolicy(UA_ServerConfig *config) {
+    UA_AccessControl *ac = &config->accessControl;
+    AccessControlContext *context = (AccessControlContext*)ac->context;
+    UA_UserTokenPolicy policy;
+    UA_UserTokenPolicy_init(&policy);
+    policy.tokenType = UA_USERTOKENTYPE_USERNAME;
+    policy.policyId = username_policy;
+    policy.securityPolicyUri = context->userTokenPolicyUri;
+
+    UA_StatusCode res = appendUserTokenPolicy(&ac->userTokenPolicies,
+                                              &ac->userTokenPoliciesSize, &policy);
+    for(size_t i = 0; i < config->endpointsSize && res == UA_STATUSCODE_GOOD; i++) {
+        UA_EndpointDescription *ep = &config->endpoints[i];
+        res = appendUserTokenPolicy(&ep->userIdentityTokens,
+                                    &ep->userIdentityTokensSize, &policy);
+    }
+    return res;
+}
+
+UA_StatusCode
+UA_AccessControl_default_addLogin(UA_ServerConfig *config, const UA_String *username,
+                                  const UA_String *password) {
+    UA_AccessControl *ac = &config->accessControl;
+    if(ac->clear != clear_default || !ac->context)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_StatusCode res = addLogin((AccessControlContext*)ac->context, username, password);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return addUsernamePolicy(config);
+}
+
+UA_StatusCode
+UA_AccessControl_default_loadLogins(UA_ServerConfig *config, const char *path) {
+    UA_AccessControl *ac = &config->accessControl;
+    if(ac->clear != clear_default || !ac->context)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    FILE *file = fopen(path, "r");
+    if(!file)
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    char line[1024];
+    while(res == UA_STATUSCODE_GOOD && fgets(line, sizeof(line), file)) {
+        size_t length = strlen(line);
+        if(length > 0 && line[length - 1] != '\n' && !feof(file)) {
+            res = UA_STATUSCODE_BADDECODINGERROR; /* Line too long */
+            break;
+        }
+        while(length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+            length--;
+        if(length == 0 || line[0] == '#')
+            continue;
+
+        /* Split at the first colon */
+        char *colon = (char*)memchr(line, ':', length);
+        if(!colon) {
+            res = UA_STATUSCODE_BADDECODINGERROR;
+            break;
+        }
+        UA_String username = {(size_t)(colon - line), (UA_Byte*)line};
+        UA_String password = {length - username.length - 1, (UA_Byte*)colon + 1};
+        res = UA_AccessControl_default_addLogin(config, &username, &password);
+    }
+    fclose(file);
+    return res;
+}
+
+UA_StatusCode
+UA_AccessControl_default_setHashIterations(UA_ServerConfig *config,
+                                           UA_UInt32 iterations) {
+    UA_AccessControl *ac = &config->accessControl;
+    if(ac->clear != clear_default || !ac->context || iterations == 0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    ((AccessControlContext*)ac->context)->hashIterations = iterations;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_AccessControl_default(UA_ServerConfig *config, UA_Boolean allowAnonymous,
                          const UA_ByteString *userTokenPolicyUri,
@@ -285,8 +906,16 @@ UA_AccessControl_default(UA_ServerConfig *config, UA_Boolean allowAnonymous,
     if(!context)
         return UA_STATUSCODE_BADOUTOFMEMORY;
     memset(context, 0, sizeof(AccessControlContext));
+    context->hashIterations = PBKDF2_ITERATIONS;
+#if UA_MULTITHREADING >= 100
+    pthread_mutex_init(&context->failedLoginsMutex, NULL);
+#endif
     ac->context = context;
 
+    UA_StatusCode res = UA_String_copy(userTokenPolicyUri, &context->userTokenPolicyUri);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
     /* Allow anonymous? */
     context->allowAnonymous = allowAnonymous;
     if(allowAnonymous) {
@@ -295,16 +924,11 @@ UA_AccessControl_default(UA_ServerConfig *config, UA_Boolean allowAnonymous,
     }
 
     /* Copy username/password to the access control plugin */
-    if(usernamePasswordLoginSize > 0) {
-        context->usernamePasswordLogin = (UA_UsernamePasswordLogin*)
-            UA_malloc(usernamePasswordLoginSize * sizeof(UA_UsernamePasswordLogin));
-        if(!context->usernamePasswordLogin)
-            return UA_STATUSCODE_BADOUTOFMEMORY;
-        context->usernamePasswordLoginSize = usernamePasswordLoginSize;
-        for(size_t i = 0; i < usernamePasswordLoginSize; i++) {
-            UA_String_copy(&usernamePasswordLogin[i].username, &context->usernamePasswordLogin[i].username);
-            UA_String_copy(&usernamePasswordLogin[i].password, &context->usernamePasswordLogin[i].password);
-        }
+    for(size_t i = 0; i < usernamePasswordLoginSize; i++) {
+        res = addLogin(context, &usernamePasswordLogin[i].username,
+                       &usernamePasswordLogin[i].password);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
     }
 
     /* Set the allowed policies */
@@ -193,6 +193,9 @@ setDefaultConfig(UA_ServerConfig *conf) {
     /* conf->nodeLifecycle.generateChildNodeId = NULL; */
     conf->modellingRulesOnInstances = UA_TRUE;
 
+    /* Send the values of ReadResponses without a copy */
+    conf->readValuesNoCopy = true;
+
     /* Limits for SecureChannels */
     conf->maxSecureChannels = 40;
     conf->maxSecurityTokenLifetime = 10 * 60 * 1000; /* 10 minutes */
@@ -200,6 +203,13 @@ setDefaultConfig(UA_ServerConfig *conf) {
     /* Limits for Sessions */
     conf->maxSessions = 100;
     conf->maxSessionTimeout = 60.0 * 60.0 * 1000.0; /* 1h */
+    conf->maxRegisteredNodesPerSession = 1000;
+
+    /* Cache for TranslateBrowsePathsToNodeIds */
+    conf->maxBrowsePathCacheSize = 16384;
+
+    /* Cache for the Call service */
+    conf->maxMethodCallCacheSize = 1024;
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* Limits for Subscriptions */
@@ -209,6 +219,7 @@ setDefaultConfig(UA_ServerConfig *conf) {
     conf->maxNotificationsPerPublish = 1000;
     conf->enableRetransmissionQueue = true;
     conf->maxRetransmissionQueueSize = 0; /* unlimited */
+    conf->maxRetransmissionQueueBytes = 0; /* unlimited */
 # ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     conf->maxEventsPerNode = 0; /* unlimited */
 # endif
@@ -0,0 +1,342 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information.
+ */
+
+#include <open62541/plugin/log_async.h>
+#include <open62541/types.h>
+
+#if defined(__linux__) || defined(__unix__)
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#ifdef UA_ENABLE_LOG_COLORS
+# define ANSI_COLOR_RED     "\x1b[31m"
+# define ANSI_COLOR_GREEN   "\x1b[32m"
+# define ANSI_COLOR_YELLOW  "\x1b[33m"
+# define ANSI_COLOR_MAGENTA "\x1b[35m"
+# define ANSI_COLOR_RESET   "\x1b[0m"
+#else
+# define ANSI_COLOR_RED     ""
+# define ANSI_COLOR_GREEN   ""
+# define ANSI_COLOR_YELLOW  ""
+# define ANSI_COLOR_MAGENTA ""
+# define ANSI_COLOR_RESET   ""
+#endif
+
+/* Colors are used only for stdout */
+static const char *asyncLevelColors[6] = {"", "", ANSI_COLOR_GREEN,
+                                          ANSI_COLOR_YELLOW, ANSI_COLOR_RED,
+                                          ANSI_COLOR_MAGENTA};
+static const char *asyncLevelNames[6] = {"trace", "debug", "info",
+                                         "warn", "error", "fatal"};
+static const char *asyncCategoryNames[UA_LOG_ASYNC_CATEGORIES] =
+    {"network", "channel", "session", "server", "client", "userland",
+     "securitypolicy"};
+
+/* Bounded multi-producer queue after Dmitry Vyukov. Every record carries a
+ * sequence number. A record at position pos is free for the producer if its
+ * sequence is pos and is ready for the consumer if its sequence is pos+1. The
+ * consumer hands the record back for the next round with pos+queueSize. */
+typedef struct {
+    size_t sequence;
+    UA_DateTime timestamp;
+    UA_LogLevel level;
+    UA_LogCategory category;
+    size_t length;
+    char msg[UA_LOG_ASYNC_MESSAGESIZE];
+} LogRecord;
+
+typedef struct {
+    UA_LogLevel minLevel[UA_LOG_ASYNC_CATEGORIES];
+    UA_LogAsyncTarget target;
+    FILE *file;
+    UA_UInt32 drainInterval;
+
+    LogRecord *records;
+    size_t mask; /* queueSize - 1 */
+
+    /* Keep the counter of the producers on a cache line of its own */
+    char pad0[64];
+    size_t enqueuePos;
+    size_t dropped;
+    char pad1[64];
+
+    /* Only accessed by the background thread */
+    size_t dequeuePos;
+    size_t droppedReported;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    UA_Boolean running;
+} LogAsyncContext;
+
+/*******************/
+/* Calling Threads */
+/*******************/
+
+static void
+enqueueRecord(LogAsyncContext *ctx, UA_LogLevel level, UA_LogCategory category,
+              UA_DateTime timestamp, const char *msg, size_t length) {
+    LogRecord *rec;
+    size_t pos = __atomic_load_n(&ctx->enqueuePos, __ATOMIC_RELAXED);
+    for(;;) {
+        rec = &ctx->records[pos & ctx->mask];
+        size_t seq = __atomic_load_n(&rec->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if(diff == 0) {
+            /* Claim the record. Updates pos if another producer was faster. */
+            if(__atomic_compare_exchange_n(&ctx->enqueuePos, &pos, pos + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if(diff < 0) {
+            /* The queue is full */
+            __atomic_fetch_add(&ctx->dropped, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&ctx->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    rec->timestamp = timestamp;
+    rec->level = level;
+    rec->category = category;
+    rec->length = length;
+    memcpy(rec->msg, msg, length);
+
+    /* Hand the record to the consumer */
+    __atomic_store_n(&rec->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef __clang__
+__attribute__((__format__(__printf__, 4 , 0)))
+#endif
+static void
+UA_Log_Async_log(void *context, UA_LogLevel level, UA_LogCategory category,
+                 const char *msg, va_list args) {
+    LogAsyncContext *ctx = (LogAsyncContext*)context;
+    if(ctx->minLevel[category] > level)
+        return;
+
+    /* Format on the stack of the calling thread */
+    char buf[UA_LOG_ASYNC_MESSAGESIZE];
+    int len = vsnprintf(buf, UA_LOG_ASYNC_MESSAGESIZE, msg, args);
+    if(len < 0)
+        return;
+    size_t length = (size_t)len;
+    if(length >= UA_LOG_ASYNC_MESSAGESIZE)
+        length = UA_LOG_ASYNC_MESSAGESIZE - 1; /* Truncated */
+
+    enqueueRecord(ctx, level, category, UA_DateTime_now(), buf, length);
+}
+
+/*********************/
+/* Background Thread */
+/*********************/
+
+static void
+writeRecord(LogAsyncContext *ctx, const LogRecord *rec, UA_Int64 tOffset) {
+    if(ctx->target == UA_LOGASYNCTARGET_SYSLOG) {
+        int priority;
+        switch(rec->level) {
+        case UA_LOGLEVEL_DEBUG:
+            priority = LOG_DEBUG;
+            break;
+        case UA_LOGLEVEL_INFO:
+            priority = LOG_INFO;
+            break;
+        case UA_LOGLEVEL_WARNING:
+            priority = LOG_WARNING;
+            break;
+        case UA_LOGLEVEL_ERROR:
+            priority = LOG_ERR;
+            break;
+        case UA_LOGLEVEL_FATAL:
+            priority = LOG_CRIT;
+            break;
+        case UA_LOGLEVEL_TRACE:
+        default:
+            return; /* Not available for syslog */
+        }
+        syslog(priority, "[%s/%s] %.*s", asyncLevelNames[rec->level],
+               asyncCategoryNames[rec->category], (int)rec->length, rec->msg);
+        return;
+    }
+
+    UA_Boolean colors = (ctx->target == UA_LOGASYNCTARGET_STDOUT);
+    UA_DateTimeStruct dts = UA_DateTime_toStruct(rec->timestamp + tOffset);
+    fprintf(ctx->file, "[%04u-%02u-%02u %02u:%02u:%02u.%03u (UTC%+05d)] %s%s/%s%s\t%.*s\n",
+            dts.year, dts.month, dts.day, dts.hour, dts.min, dts.sec, dts.milliSec,
+            (int)(tOffset / UA_DATETIME_SEC / 36),
+            colors ? asyncLevelColors[rec->level] : "", asyncLevelNames[rec->level],
+            asyncCategoryNames[rec->category], colors ? ANSI_COLOR_RESET : "",
+            (int)rec->length, rec->msg);
+}
+
+static void
+drainRecords(LogAsyncContext *ctx) {
+    UA_Int64 tOffset = UA_DateTime_localTimeUtcOffset();
+    size_t written = 0;
+    for(;;) {
+        LogRecord *rec = &ctx->records[ctx->dequeuePos & ctx->mask];
+        size_t seq = __atomic_load_n(&rec->sequence, __ATOMIC_ACQUIRE);
+        if(seq != ctx->dequeuePos + 1)
+            break; /* Empty or the producer has not finished the record */
+        writeRecord(ctx, rec, tOffset);
+        __atomic_store_n(&rec->sequence, ctx->dequeuePos + ctx->mask + 1,
+                         __ATOMIC_RELEASE);
+        ctx->dequeuePos++;
+        written++;
+    }
+
+    /* Report dropped messages */
+    size_t dropped = __atomic_load_n(&ctx->dropped, __ATOMIC_RELAXED);
+    if(dropped != ctx->droppedReported) {
+        LogRecord rec;
+        rec.timestamp = UA_DateTime_now();
+        rec.level = UA_LOGLEVEL_WARNING;
+        rec.category = UA_LOGCATEGORY_USERLAND;
+        int len = snprintf(rec.msg, UA_LOG_ASYNC_MESSAGESIZE,
+                           "%lu log messages dropped because the queue was full",
+                           (unsigned long)(dropped - ctx->droppedReported));
+        rec.length = (len > 0) ? (size_t)len : 0;
+        writeRecord(ctx, &rec, tOffset);
+        ctx->droppedReported = dropped;
+        written++;
+    }
+
+    if(written > 0 && ctx->target != UA_LOGASYNCTARGET_SYSLOG)
+        fflush(ctx->file);
+}
+
+static void *
+drainThread(void *context) {
+    LogAsyncContext *ctx = (LogAsyncContext*)context;
+    pthread_mutex_lock(&ctx->mutex);
+    while(ctx->running) {
+        pthread_mutex_unlock(&ctx->mutex);
+        drainRecords(ctx);
+        pthread_mutex_lock(&ctx->mutex);
+        if(!ctx->running)
+            break;
+
+        struct timespec abstime;
+        clock_gettime(CLOCK_REALTIME, &abstime);
+        abstime.tv_sec += (time_t)(ctx->drainInterval / 1000);
+        abstime.tv_nsec += (long)(ctx->drainInterval % 1000) * 1000000L;
+        if(abstime.tv_nsec >= 1000000000L) {
+            abstime.tv_sec++;
+            abstime.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&ctx->cond, &ctx->mutex, &abstime);
+    }
+    pthread_mutex_unlock(&ctx->mutex);
+
+    /* Write out what remains in the queue */
+    drainRecords(ctx);
+    return NULL;
+}
+
+/*************/
+/* Lifecycle */
+/*************/
+
+static void
+UA_Log_Async_clear(void *context) {
+    LogAsyncContext *ctx = (LogAsyncContext*)context;
+    if(!ctx)
+        return;
+
+    pthread_mutex_lock(&ctx->mutex);
+    ctx->running = false;
+    pthread_cond_signal(&ctx->cond);
+    pthread_mutex_unlock(&ctx->mutex);
+    pthread_join(ctx->thread, NULL);
+
+    pthread_cond_destroy(&ctx->cond);
+    pthread_mutex_destroy(&ctx->mutex);
+    if(ctx->target == UA_LOGASYNCTARGET_FILE)
+        fclose(ctx->file);
+    UA_free(ctx->records);
+    UA_free(ctx);
+}
+
+void
+UA_LogAsyncConfig_init(UA_LogAsyncConfig *config, UA_LogLevel minLevel) {
+    memset(config, 0, sizeof(UA_LogAsyncConfig));
+    for(size_t i = 0; i < UA_LOG_ASYNC_CATEGORIES; i++)
+        config->minLevel[i] = minLevel;
+    config->queueSize = 1024;
+    config->target = UA_LOGASYNCTARGET_STDOUT;
+    config->drainInterval = 10;
+}
+
+UA_StatusCode
+UA_Log_Async_init(UA_Logger *logger, const UA_LogAsyncConfig *config) {
+    if(!logger || !config || config->queueSize == 0 || config->drainInterval == 0)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    if(config->target == UA_LOGASYNCTARGET_FILE && !config->path)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    LogAsyncContext *ctx = (LogAsyncContext*)UA_calloc(1, sizeof(LogAsyncContext));
+    if(!ctx)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memcpy(ctx->minLevel, config->minLevel, sizeof(ctx->minLevel));
+    ctx->target = config->target;
+    ctx->drainInterval = config->drainInterval;
+
+    /* Round the queue size up to a power of two */
+    size_t queueSize = 1;
+    while(queueSize < config->queueSize)
+        queueSize <<= 1;
+    ctx->records = (LogRecord*)UA_malloc(queueSize * sizeof(LogRecord));
+    if(!ctx->records) {
+        UA_free(ctx);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    for(size_t i = 0; i < queueSize; i++)
+        ctx->records[i].sequence = i;
+    ctx->mask = queueSize - 1;
+
+    if(ctx->target == UA_LOGASYNCTARGET_FILE) {
+        ctx->file = fopen(config->path, "a");
+        if(!ctx->file) {
+            UA_free(ctx->records);
+            UA_free(ctx);
+            return UA_STATUSCODE_BADINTERNALERROR;
+        }
+    } else if(ctx->target == UA_LOGASYNCTARGET_STDOUT) {
+        ctx->file = stdout;
+    }
+
+    pthread_mutex_init(&ctx->mutex, NULL);
+    pthread_cond_init(&ctx->cond, NULL);
+    ctx->running = true;
+    if(pthread_create(&ctx->thread, NULL, drainThread, ctx) != 0) {
+        pthread_cond_destroy(&ctx->cond);
+        pthread_mutex_destroy(&ctx->mutex);
+        if(ctx->target == UA_LOGASYNCTARGET_FILE)
+            fclose(ctx->file);
+        UA_free(ctx->records);
+        UA_free(ctx);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    logger->log = UA_Log_Async_log;
+    logger->context = ctx;
+    logger->clear = UA_Log_Async_clear;
+    return UA_STATUSCODE_GOOD;
+}
+
+size_t
+UA_Log_Async_getDropped(const UA_Logger *logger) {
+    const LogAsyncContext *ctx = (const LogAsyncContext*)logger->context;
+    return __atomic_load_n(&ctx->dropped, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -23,25 +23,48 @@
 
 typedef struct UA_NodeMapEntry {
     struct UA_NodeMapEntry *orig; /* the version this is a copy from (or NULL) */
-    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_UInt32 refCount; /* How many consumers have a reference to the node? */
     UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
     UA_Node node;
 } UA_NodeMapEntry;
 
 #define UA_NODEMAP_MINSIZE 64
 #define UA_NODEMAP_TOMBSTONE ((UA_NodeMapEntry*)0x01)
+#define UA_NODEMAP_SEALED ((UA_NodeMapEntry*)0x02) /* orig of sealed node copies */
 
 typedef struct {
     UA_NodeMapEntry *entry;
     UA_UInt32 nodeIdHash;
 } UA_NodeMapSlot;
 
+/* The sealed layer holds flat copies of the nodes in a single memory block.
+ * The lookup table uses open addressing with linear probing and is filled to
+ * at most 50%. Sealed nodes are not refcounted. They are valid until the
+ * nodestore is deleted. */
+typedef struct {
+    UA_UInt32 nodeIdHash;
+    UA_UInt32 node; /* Index in the nodes array + 1. Zero for an empty slot. */
+} UA_SealedSlot;
+
+typedef struct {
+    UA_Byte *block;
+    size_t blockSize;
+    UA_Node **nodes;
+    UA_Boolean *removed; /* Sealed nodes can be masked but not changed */
+    UA_UInt32 nodesSize;
+    UA_SealedSlot *slots;
+    UA_UInt32 slotsSize; /* Power of two */
+} UA_SealedNodes;
+
 typedef struct {
     UA_NodeMapSlot *slots;
     UA_UInt32 size;
     UA_UInt32 count;
     UA_UInt32 sizePrimeIndex;
 
+    /* Read-only layer below the hash-map (or NULL) */
+    UA_SealedNodes *sealed;
+
     /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
     UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
     UA_Byte referenceTypeCounter;
@@ -225,6 +248,45 @@ findOccupiedSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
     return NULL;
 }
 
+/****************/
+/* Sealed Nodes */
+/****************/
+
+/* Returns the index of the sealed node or -1 */
+static UA_Int64
+findSealed(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
+    const UA_SealedNodes *sealed = ns->sealed;
+    if(!sealed)
+        return -1;
+    UA_UInt32 h = UA_NodeId_hash(nodeid);
+    UA_UInt32 mask = sealed->slotsSize - 1;
+    for(UA_UInt32 idx = h & mask; sealed->slots[idx].node != 0; idx = (idx + 1) & mask) {
+        const UA_SealedSlot *slot = &sealed->slots[idx];
+        if(slot->nodeIdHash != h)
+            continue;
+        UA_UInt32 i = slot->node - 1;
+        if(UA_NodeId_equal(&sealed->nodes[i]->head.nodeId, nodeid))
+            return sealed->removed[i] ? -1 : (UA_Int64)i;
+    }
+    return -1;
+}
+
+static UA_Boolean
+isSealed(const UA_NodeMap *ns, const UA_Node *node) {
+    const UA_SealedNodes *sealed = ns->sealed;
+    return (sealed && (uintptr_t)node >= (uintptr_t)sealed->block &&
+            (uintptr_t)node < (uintptr_t)sealed->block + sealed->blockSize);
+}
+
+static void
+deleteSealed(UA_SealedNodes *sealed) {
+    UA_free(sealed->block);
+    UA_free(sealed->nodes);
+    UA_free(sealed->removed);
+    UA_free(sealed->slots);
+    UA_free(sealed);
+}
+
 /***********************/
 /* Interface functions */
 /***********************/
@@ -248,8 +310,11 @@ static const UA_Node *
 UA_NodeMap_getNode(void *context, const UA_NodeId *nodeid) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
-    if(!slot)
-        return NULL;
+    if(!slot) {
+        /* Nodes in the hash-map shadow the sealed nodes */
+        UA_Int64 i = findSealed(ns, nodeid);
+        return (i >= 0) ? ns->sealed->nodes[i] : NULL;
+    }
     ++slot->entry->refCount;
     return &slot->entry->node;
 }
@@ -258,6 +323,8 @@ static void
 UA_NodeMap_releaseNode(void *context, const UA_Node *node) {
     if (!node)
         return;
+    if(isSealed((UA_NodeMap*)context, node))
+        return;
     UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
     UA_assert(&entry->node == node);
     UA_assert(entry->refCount > 0);
@@ -270,15 +337,25 @@ UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
                        UA_Node **outNode) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
-    if(!slot)
-        return UA_STATUSCODE_BADNODEIDUNKNOWN;
-    UA_NodeMapEntry *entry = slot->entry;
-    UA_NodeMapEntry *newItem = createEntry(entry->node.head.nodeClass);
+    const UA_Node *node;
+    UA_NodeMapEntry *orig;
+    if(slot) {
+        node = &slot->entry->node;
+        orig = slot->entry;
+    } else {
+        /* The copy of a sealed node shadows the original after replacing */
+        UA_Int64 i = findSealed(ns, nodeid);
+        if(i < 0)
+            return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        node = ns->sealed->nodes[i];
+        orig = UA_NODEMAP_SEALED;
+    }
+    UA_NodeMapEntry *newItem = createEntry(node->head.nodeClass);
     if(!newItem)
         return UA_STATUSCODE_BADOUTOFMEMORY;
-    UA_StatusCode retval = UA_Node_copy(&entry->node, &newItem->node);
+    UA_StatusCode retval = UA_Node_copy(node, &newItem->node);
     if(retval == UA_STATUSCODE_GOOD) {
-        newItem->orig = entry; /* Store the pointer to the original */
+        newItem->orig = orig; /* Store the pointer to the original */
         *outNode = &newItem->node;
     } else {
         deleteNodeMapEntry(newItem);
@@ -289,9 +366,15 @@ UA_NodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
 static UA_StatusCode
 UA_NodeMap_removeNode(void *context, const UA_NodeId *nodeid) {
     UA_NodeMap *ns = (UA_NodeMap*)context;
+
+    /* Mask the sealed node. Also if it is shadowed by the hash-map. */
+    UA_Int64 i = findSealed(ns, nodeid);
+    if(i >= 0)
+        ns->sealed->removed[i] = true;
+
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
     if(!slot)
-        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        return (i >= 0) ? UA_STATUSCODE_GOOD : UA_STATUSCODE_BADNODEIDUNKNOWN;
 
     UA_NodeMapEntry *entry = slot->entry;
     slot->entry = UA_NODEMAP_TOMBSTONE;
@@ -341,6 +424,8 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
         do {
             node->head.nodeId.identifier.numeric = (UA_UInt32)identifier;
             slot = findFreeSlot(ns, &node->head.nodeId);
+            if(slot && findSealed(ns, &node->head.nodeId) >= 0)
+                slot = NULL;
             if(slot)
                 break;
             identifier += increase;
@@ -349,6 +434,8 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
         } while((UA_UInt32)identifier != startId);
     } else {
         slot = findFreeSlot(ns, &node->head.nodeId);
+        if(slot && findSealed(ns, &node->head.nodeId) >= 0)
+            slot = NULL;
     }
 
     if(!slot) {
@@ -404,8 +491,25 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     /* Find the node */
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, &node->head.nodeId);
     if(!slot) {
-        deleteNodeMapEntry(newEntry);
-        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        /* Shadow the sealed node with the edited copy. The ReferenceTypeIndex
+         * is not reassigned. */
+        if(newEntry->orig != UA_NODEMAP_SEALED ||
+           findSealed(ns, &node->head.nodeId) < 0) {
+            deleteNodeMapEntry(newEntry);
+            return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        }
+        if(ns->size * 3 <= ns->count * 4 && expand(ns) != UA_STATUSCODE_GOOD) {
+            deleteNodeMapEntry(newEntry);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        slot = findFreeSlot(ns, &node->head.nodeId);
+        UA_assert(slot);
+        newEntry->orig = NULL;
+        slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
+        UA_atomic_sync(); /* Set the hash first */
+        slot->entry = newEntry;
+        ++ns->count;
+        return UA_STATUSCODE_GOOD;
     }
 
     /* The node was already updated since the copy was made? */
@@ -445,6 +549,16 @@ UA_NodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
             cleanupNodeMapEntry(slot->entry);
         }
     }
+
+    /* Sealed nodes that are not masked or shadowed */
+    UA_SealedNodes *sealed = ns->sealed;
+    if(!sealed)
+        return;
+    for(UA_UInt32 i = 0; i < sealed->nodesSize; ++i) {
+        const UA_Node *node = sealed->nodes[i];
+        if(!sealed->removed[i] && !findOccupiedSlot(ns, &node->head.nodeId))
+            visitor(visitorContext, node);
+    }
 }
 
 static void
@@ -466,6 +580,9 @@ UA_NodeMap_delete(void *context) {
     }
     UA_free(ns->slots);
 
+    if(ns->sealed)
+        deleteSealed(ns->sealed);
+
     /* Clean up the ReferenceTypes index array */
     for(size_t i = 0; i < ns->referenceTypeCounter; i++)
         UA_NodeId_clear(&ns->referenceTypeIds[i]);
@@ -490,6 +607,7 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
     }
 
     nodemap->referenceTypeCounter = 0;
+    nodemap->sealed = NULL;
 
     /* Populate the nodestore */
     ns->context = nodemap;
@@ -506,3 +624,79 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
     ns->iterate = UA_NodeMap_iterate;
     return UA_STATUSCODE_GOOD;
 }
+
+UA_StatusCode
+UA_Nodestore_HashMap_seal(UA_Nodestore *ns) {
+#ifndef UA_ENABLE_IMMUTABLE_NODES
+    /* Sealed nodes cannot be edited in-situ */
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+#else
+    if(ns->getNode != UA_NodeMap_getNode)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_NodeMap *map = (UA_NodeMap*)ns->context;
+    if(map->sealed)
+        return UA_STATUSCODE_BADINVALIDSTATE;
+
+    /* Compute the size of the memory block. No node can be in use as the
+     * entries are removed afterwards. */
+    size_t blockSize = 0;
+    for(UA_UInt32 i = 0; i < map->size; ++i) {
+        UA_NodeMapEntry *entry = map->slots[i].entry;
+        if(entry <= UA_NODEMAP_TOMBSTONE)
+            continue;
+        if(entry->refCount > 0)
+            return UA_STATUSCODE_BADINVALIDSTATE;
+        blockSize += UA_Node_copyFlat(&entry->node, NULL);
+    }
+
+    /* Allocate the sealed layer */
+    UA_SealedNodes *sealed = (UA_SealedNodes*)UA_calloc(1, sizeof(UA_SealedNodes));
+    if(!sealed)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    sealed->slotsSize = UA_NODEMAP_MINSIZE;
+    while(sealed->slotsSize < map->count * 2)
+        sealed->slotsSize *= 2;
+    sealed->block = (UA_Byte*)UA_malloc(blockSize);
+    sealed->nodes = (UA_Node**)UA_calloc(map->count + 1, sizeof(UA_Node*));
+    sealed->removed = (UA_Boolean*)UA_calloc(map->count + 1, sizeof(UA_Boolean));
+    sealed->slots = (UA_SealedSlot*)UA_calloc(sealed->slotsSize, sizeof(UA_SealedSlot));
+    UA_NodeMapSlot *emptySlots = (UA_NodeMapSlot*)
+        UA_calloc(primes[higher_prime_index(UA_NODEMAP_MINSIZE)], sizeof(UA_NodeMapSlot));
+    if((blockSize > 0 && !sealed->block) || !sealed->nodes ||
+       !sealed->removed || !sealed->slots || !emptySlots) {
+        deleteSealed(sealed);
+        UA_free(emptySlots);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    sealed->blockSize = blockSize;
+
+    /* Move the nodes into the sealed layer */
+    UA_Byte *pos = sealed->block;
+    UA_UInt32 mask = sealed->slotsSize - 1;
+    for(UA_UInt32 i = 0; i < map->size; ++i) {
+        UA_NodeMapEntry *entry = map->slots[i].entry;
+        if(entry <= UA_NODEMAP_TOMBSTONE)
+            continue;
+        UA_Node *node = (UA_Node*)pos;
+        pos += UA_Node_copyFlat(&entry->node, node);
+        UA_UInt32 idx = map->slots[i].nodeIdHash & mask;
+        while(sealed->slots[idx].node != 0)
+            idx = (idx + 1) & mask;
+        sealed->nodes[sealed->nodesSize] = node;
+        sealed->nodesSize++;
+        sealed->slots[idx].nodeIdHash = map->slots[i].nodeIdHash;
+        sealed->slots[idx].node = sealed->nodesSize;
+        deleteNodeMapEntry(entry);
+    }
+    UA_assert(pos == sealed->block + blockSize);
+
+    /* Reset the hash-map. The ReferenceTypeIndex assignment continues. */
+    UA_free(map->slots);
+    map->slots = emptySlots;
+    map->sizePrimeIndex = higher_prime_index(UA_NODEMAP_MINSIZE);
+    map->size = primes[map->sizePrimeIndex];
+    map->count = 0;
+    map->sealed = sealed;
+    return UA_STATUSCODE_GOOD;
+#endif
+}
@@ -679,25 +679,28 @@ clientExecuteRepeatedCallback(void *executionApplication, UA_ApplicationCallback
     cb(callbackApplication, data);
 }
 
-UA_StatusCode
-UA_Client_run_iterate(UA_Client *client, UA_UInt32 timeout) {
-    /* Process timed (repeated) jobs */
+/* Process the timed (repeated) callbacks. Returns the latest date until which
+ * the client may listen on the network before the next callback is due. */
+static UA_DateTime
+processTimedCallbacks(UA_Client *client, UA_UInt32 timeout) {
     UA_DateTime now = UA_DateTime_nowMonotonic();
     UA_DateTime maxDate =
         UA_Timer_process(&client->timer, now, (UA_TimerExecutionCallback)
                          clientExecuteRepeatedCallback, client);
     if(maxDate > now + ((UA_DateTime)timeout * UA_DATETIME_MSEC))
         maxDate = now + ((UA_DateTime)timeout * UA_DATETIME_MSEC);
+    return maxDate;
+}
 
-    /* Make sure we have an open channel */
-    UA_StatusCode retval = UA_STATUSCODE_GOOD;
-    if((client->noSession && client->channel.state != UA_SECURECHANNELSTATE_OPEN) ||
-       client->sessionState < UA_SESSIONSTATE_ACTIVATED) {
-        retval = connectIterate(client, timeout);
-        notifyClientState(client);
-        return retval;
-    }
+static UA_Boolean
+isConnecting(const UA_Client *client) {
+    return ((client->noSession && client->channel.state != UA_SECURECHANNELSTATE_OPEN) ||
+            client->sessionState < UA_SESSIONSTATE_ACTIVATED);
+}
 
+/* Housekeeping of a connected client before listening on the network */
+static UA_StatusCode
+iterateBeforeReceive(UA_Client *client) {
     /* Renew Secure Channel */
     UA_Client_renewSecureChannel(client);
     if(client->connectStatus != UA_STATUSCODE_GOOD)
@@ -710,6 +713,40 @@ UA_Client_run_iterate(UA_Client *client, UA_UInt32 timeout) {
 
     /* Send read requests from time to time to test the connectivity */
     UA_Client_backgroundConnectivity(client);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Housekeeping of a connected client after listening on the network */
+static void
+iterateAfterReceive(UA_Client *client) {
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    /* The inactivity check must be done after receiveServiceResponse*/
+    UA_Client_Subscriptions_backgroundPublishInactivityCheck(client);
+#endif
+
+    /* Did async services time out? Process callbacks with an error code */
+    asyncServiceTimeoutCheck(client);
+
+    /* Log and notify user if the client state has changed */
+    notifyClientState(client);
+}
+
+UA_StatusCode
+UA_Client_run_iterate(UA_Client *client, UA_UInt32 timeout) {
+    /* Process timed (repeated) jobs */
+    UA_DateTime maxDate = processTimedCallbacks(client, timeout);
+
+    /* Make sure we have an open channel */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(isConnecting(client)) {
+        retval = connectIterate(client, timeout);
+        notifyClientState(client);
+        return retval;
+    }
+
+    retval = iterateBeforeReceive(client);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
 
     /* Listen on the network for the given timeout */
     retval = receiveResponse(client, NULL, NULL, maxDate, NULL);
@@ -721,18 +758,139 @@ UA_Client_run_iterate(UA_Client *client, UA_UInt32 timeout) {
                                UA_StatusCode_name(retval));
     }
 
-#ifdef UA_ENABLE_SUBSCRIPTIONS
-    /* The inactivity check must be done after receiveServiceResponse*/
-    UA_Client_Subscriptions_backgroundPublishInactivityCheck(client);
+    iterateAfterReceive(client);
+    return client->connectStatus;
+}
+
+/* Sockets that cannot be added to the fd_set are polled without waiting. On
+ * Windows, FD_SETSIZE limits the number of sockets in the fd_set and not the
+ * value of the socket handle. So the sockets are also counted in
+ * UA_Client_run_iterateMany. */
+static UA_Boolean
+canSelect(const UA_Connection *connection) {
+    if(connection->sockfd == UA_INVALID_SOCKET)
+        return false;
+#ifndef _WIN32
+    if((size_t)connection->sockfd >= FD_SETSIZE)
+        return false;
 #endif
+    return true;
+}
 
-    /* Did async services time out? Process callbacks with an error code */
-    asyncServiceTimeoutCheck(client);
+UA_StatusCode
+UA_Client_run_iterateMany(UA_Client **clients, size_t clientsSize,
+                          UA_UInt32 timeout) {
+    fd_set readset, writeset;
+    FD_ZERO(&readset);
+    FD_ZERO(&writeset);
+    UA_SOCKET highestfd = 0;
+    UA_Boolean listening = false;
+    UA_Boolean pollAll = false;
+    size_t selectSize = 0;
+    size_t pollFrom = clientsSize; /* Clients from here on are not in the fd_set */
+
+    /* Process the timed callbacks and the housekeeping. Collect the sockets to
+     * listen on and the earliest date a timed callback is due. */
+    UA_DateTime maxDate = UA_DateTime_nowMonotonic() +
+        ((UA_DateTime)timeout * UA_DATETIME_MSEC);
+    for(size_t i = 0; i < clientsSize; i++) {
+        UA_Client *client = clients[i];
+        if(!client)
+            continue;
+        UA_DateTime clientMaxDate = processTimedCallbacks(client, timeout);
+        if(clientMaxDate < maxDate)
+            maxDate = clientMaxDate;
+
+        if(isConnecting(client)) {
+            /* Advance the connection without blocking */
+            connectIterate(client, 0);
+            notifyClientState(client);
+        } else if(iterateBeforeReceive(client) != UA_STATUSCODE_GOOD) {
+            continue;
+        }
 
-    /* Log and notify user if the client state has changed */
-    notifyClientState(client);
+        UA_Connection *connection = &client->connection;
+        if(connection->state == UA_CONNECTIONSTATE_CLOSED ||
+           client->connectStatus != UA_STATUSCODE_GOOD)
+            continue;
+        if(!canSelect(connection)) {
+            pollAll = true;
+            continue;
+        }
+        if(selectSize >= FD_SETSIZE) {
+            /* The fd_set is full. FD_SET would silently drop the socket. */
+            pollAll = true;
+            if(pollFrom == clientsSize)
+                pollFrom = i;
+            continue;
+        }
+        selectSize++;
+        if(connection->state == UA_CONNECTIONSTATE_OPENING)
+            UA_fd_set(connection->sockfd, &writeset);
+        else
+            UA_fd_set(connection->sockfd, &readset);
+        if(connection->sockfd > highestfd)
+            highestfd = connection->sockfd;
+        listening = true;
+    }
 
-    return client->connectStatus;
+    /* Wait until one of the sockets becomes ready or the first timed callback
+     * is due. Only the clients with a ready socket are processed below. */
+    UA_DateTime now = UA_DateTime_nowMonotonic();
+    UA_DateTime wait = (maxDate > now && !pollAll) ? maxDate - now : 0;
+    struct timeval tmptv = {(long int)(wait / UA_DATETIME_SEC),
+                            (int)((wait % UA_DATETIME_SEC) / UA_DATETIME_USEC)};
+    int resultsize = 0;
+    if(listening) {
+        resultsize = UA_select((UA_Int32)(highestfd + 1), &readset, &writeset,
+                               NULL, &tmptv);
+        if(resultsize < 0) {
+            /* Interrupted or failed. Act as if it timed out. The clients notice
+             * broken connections on the next receive. */
+            FD_ZERO(&readset);
+            FD_ZERO(&writeset);
+            resultsize = 0;
+        }
+    } else if(wait > 0) {
+        UA_sleep_ms((unsigned int)(wait / UA_DATETIME_MSEC));
+    }
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < clientsSize; i++) {
+        UA_Client *client = clients[i];
+        if(!client)
+            continue;
+
+        UA_Connection *connection = &client->connection;
+        UA_Boolean ready = false;
+        if(connection->state != UA_CONNECTIONSTATE_CLOSED) {
+            if(!canSelect(connection) || i >= pollFrom)
+                ready = true;
+            else if(resultsize > 0)
+                ready = (UA_fd_isset(connection->sockfd, &readset) ||
+                         UA_fd_isset(connection->sockfd, &writeset));
+        }
+
+        if(isConnecting(client)) {
+            if(ready)
+                connectIterate(client, 0);
+            notifyClientState(client);
+        } else {
+            if(ready) {
+                UA_StatusCode res =
+                    receiveResponse(client, NULL, NULL, UA_DateTime_nowMonotonic(), NULL);
+                if(res != UA_STATUSCODE_GOOD && res != UA_STATUSCODE_GOODNONCRITICALTIMEOUT)
+                    UA_LOG_WARNING_CHANNEL(&client->config.logger, &client->channel,
+                                           "Could not receive with StatusCode %s",
+                                           UA_StatusCode_name(res));
+            }
+            iterateAfterReceive(client);
+        }
+
+        if(retval == UA_STATUSCODE_GOOD)
+            retval = client->connectStatus;
+    }
+    return retval;
 }
 
 const UA_DataType *
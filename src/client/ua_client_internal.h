@@ -37,6 +37,8 @@ typedef struct UA_Client_NotificationsAckNumber {
 
 typedef struct UA_Client_MonitoredItem {
     LIST_ENTRY(UA_Client_MonitoredItem) listEntry;
+    struct UA_Client_MonitoredItem *indexNext; /* Next in the bucket of the
+                                                * Subscription's index */
     UA_UInt32 monitoredItemId;
     UA_UInt32 clientHandle;
     void *context;
@@ -50,6 +52,8 @@ typedef struct UA_Client_MonitoredItem {
 
 typedef struct UA_Client_Subscription {
     LIST_ENTRY(UA_Client_Subscription) listEntry;
+    struct UA_Client_Subscription *indexNext; /* Next in the bucket of the
+                                               * client's index */
     UA_UInt32 subscriptionId;
     void *context;
     UA_Double publishingInterval;
@@ -59,8 +63,19 @@ typedef struct UA_Client_Subscription {
     UA_UInt32 sequenceNumber;
     UA_DateTime lastActivity;
     LIST_HEAD(, UA_Client_MonitoredItem) monitoredItems;
+    size_t monitoredItemsSize;
+
+    /* Hash index of the MonitoredItems by their clientHandle. The client
+     * allocates the handles sequentially. So the lower bits are used as the
+     * hash. The number of buckets is a power of two. Without an index (failed
+     * allocation), the list is searched. */
+    UA_Client_MonitoredItem **monitoredItemsIndex;
+    size_t monitoredItemsIndexSize;
 } UA_Client_Subscription;
 
+/* Smallest number of buckets in the Subscription and MonitoredItem indexes */
+#define UA_CLIENT_SUBSCRIPTION_MININDEXSIZE 16
+
 void
 UA_Client_Subscriptions_clean(UA_Client *client);
 
@@ -68,6 +83,12 @@ UA_Client_Subscriptions_clean(UA_Client *client);
 UA_StatusCode
 UA_Client_preparePublishRequest(UA_Client *client, UA_PublishRequest *request);
 
+/* Exposed for testing */
+void
+UA_Client_Subscriptions_processPublishResponse(UA_Client *client,
+                                               UA_PublishRequest *request,
+                                               UA_PublishResponse *response);
+
 void
 UA_Client_Subscriptions_backgroundPublish(UA_Client *client);
 
@@ -149,6 +170,11 @@ struct UA_Client {
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     LIST_HEAD(, UA_Client_NotificationsAckNumber) pendingNotificationsAcks;
     LIST_HEAD(, UA_Client_Subscription) subscriptions;
+    size_t subscriptionsSize;
+    /* Hash index of the Subscriptions by their identifier. Servers typically
+     * allocate the identifiers sequentially. */
+    UA_Client_Subscription **subscriptionsIndex;
+    size_t subscriptionsIndexSize;
     UA_UInt32 monitoredItemHandles;
     UA_UInt16 currentlyOutStandingPublishRequests;
 #endif
@@ -26,6 +26,69 @@ static void
 MonitoredItem_delete(UA_Client *client, UA_Client_Subscription *sub,
                      UA_Client_MonitoredItem *mon);
 
+/* Rebuild the Subscription index with the new number of buckets. The old index
+ * is kept if the allocation fails. */
+static void
+resizeSubscriptionsIndex(UA_Client *client, size_t indexSize) {
+    UA_Client_Subscription **index = (UA_Client_Subscription**)
+        UA_calloc(indexSize, sizeof(UA_Client_Subscription*));
+    if(!index)
+        return;
+    UA_Client_Subscription *sub;
+    LIST_FOREACH(sub, &client->subscriptions, listEntry) {
+        size_t bucket = sub->subscriptionId & (indexSize - 1);
+        sub->indexNext = index[bucket];
+        index[bucket] = sub;
+    }
+    UA_free(client->subscriptionsIndex);
+    client->subscriptionsIndex = index;
+    client->subscriptionsIndexSize = indexSize;
+}
+
+static void
+addSubscription(UA_Client *client, UA_Client_Subscription *sub) {
+    client->subscriptionsSize++;
+    LIST_INSERT_HEAD(&client->subscriptions, sub, listEntry);
+    sub->indexNext = NULL;
+
+    /* Grow the index to keep at most one Subscription per bucket on average */
+    if(client->subscriptionsSize > client->subscriptionsIndexSize) {
+        size_t indexSize = client->subscriptionsIndexSize * 2;
+        if(indexSize < UA_CLIENT_SUBSCRIPTION_MININDEXSIZE)
+            indexSize = UA_CLIENT_SUBSCRIPTION_MININDEXSIZE;
+        resizeSubscriptionsIndex(client, indexSize); /* Inserts sub */
+        if(client->subscriptionsIndexSize == indexSize)
+            return;
+    }
+
+    if(!client->subscriptionsIndex)
+        return;
+    size_t bucket = sub->subscriptionId & (client->subscriptionsIndexSize - 1);
+    sub->indexNext = client->subscriptionsIndex[bucket];
+    client->subscriptionsIndex[bucket] = sub;
+}
+
+static void
+removeSubscription(UA_Client *client, UA_Client_Subscription *sub) {
+    client->subscriptionsSize--;
+    LIST_REMOVE(sub, listEntry);
+
+    if(!client->subscriptionsIndex)
+        return;
+    UA_Client_Subscription **pos = &client->subscriptionsIndex
+        [sub->subscriptionId & (client->subscriptionsIndexSize - 1)];
+    while(*pos && *pos != sub)
+        pos = &(*pos)->indexNext;
+    if(*pos)
+        *pos = sub->indexNext;
+    sub->indexNext = NULL;
+
+    /* Shrink the index when it has become sparse */
+    if(client->subscriptionsIndexSize > UA_CLIENT_SUBSCRIPTION_MININDEXSIZE &&
+       client->subscriptionsSize < client->subscriptionsIndexSize / 4)
+        resizeSubscriptionsIndex(client, client->subscriptionsIndexSize / 2);
+}
+
 static void
 __Subscriptions_create(UA_Client *client, UA_Client_Subscription *newSub,
                        UA_CreateSubscriptionResponse *response) {
@@ -35,7 +98,10 @@ __Subscriptions_create(UA_Client *client, UA_Client_Subscription *newSub,
     newSub->publishingInterval = response->revisedPublishingInterval;
     newSub->maxKeepAliveCount = response->revisedMaxKeepAliveCount;
     LIST_INIT(&newSub->monitoredItems);
-    LIST_INSERT_HEAD(&client->subscriptions, newSub, listEntry);
+    newSub->monitoredItemsSize = 0;
+    newSub->monitoredItemsIndex = NULL;
+    newSub->monitoredItemsIndexSize = 0;
+    addSubscription(client, newSub);
 }
 
 static void
@@ -123,11 +189,18 @@ UA_Client_Subscriptions_create_async(UA_Client *client,
 
 static UA_Client_Subscription *
 findSubscription(const UA_Client *client, UA_UInt32 subscriptionId) {
-    UA_Client_Subscription *sub = NULL;
-    LIST_FOREACH(sub, &client->subscriptions, listEntry) {
-        if(sub->subscriptionId == subscriptionId)
-            break;
+    UA_Client_Subscription *sub;
+    if(!client->subscriptionsIndex) {
+        LIST_FOREACH(sub, &client->subscriptions, listEntry) {
+            if(sub->subscriptionId == subscriptionId)
+                break;
+        }
+        return sub;
     }
+    sub = client->subscriptionsIndex
+        [subscriptionId & (client->subscriptionsIndexSize - 1)];
+    while(sub && sub->subscriptionId != subscriptionId)
+        sub = sub->indexNext;
     return sub;
 }
 
@@ -213,13 +286,14 @@ UA_Client_Subscription_deleteInternal(UA_Client *client,
     UA_Client_MonitoredItem *mon, *mon_tmp;
     LIST_FOREACH_SAFE(mon, &sub->monitoredItems, listEntry, mon_tmp)
         MonitoredItem_delete(client, sub, mon);
+    UA_free(sub->monitoredItemsIndex);
 
     /* Call the delete callback */
     if(sub->deleteCallback)
         sub->deleteCallback(client, sub->subscriptionId, sub->context);
 
     /* Remove */
-    LIST_REMOVE(sub, listEntry);
+    removeSubscription(client, sub);
     UA_free(sub);
 }
 
@@ -349,10 +423,89 @@ UA_Client_Subscriptions_deleteSingle(UA_Client *client, UA_UInt32 subscriptionId
 /* MonitoredItems */
 /******************/
 
+/* Rebuild the MonitoredItem index with the new number of buckets. The old
+ * index is kept if the allocation fails. */
+static void
+resizeClientMonitoredItemsIndex(UA_Client_Subscription *sub, size_t indexSize) {
+    UA_Client_MonitoredItem **index = (UA_Client_MonitoredItem**)
+        UA_calloc(indexSize, sizeof(UA_Client_MonitoredItem*));
+    if(!index)
+        return;
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+        size_t bucket = mon->clientHandle & (indexSize - 1);
+        mon->indexNext = index[bucket];
+        index[bucket] = mon;
+    }
+    UA_free(sub->monitoredItemsIndex);
+    sub->monitoredItemsIndex = index;
+    sub->monitoredItemsIndexSize = indexSize;
+}
+
+static void
+addMonitoredItem(UA_Client_Subscription *sub, UA_Client_MonitoredItem *mon) {
+    sub->monitoredItemsSize++;
+    LIST_INSERT_HEAD(&sub->monitoredItems, mon, listEntry);
+    mon->indexNext = NULL;
+
+    /* Grow the index to keep at most one MonitoredItem per bucket on average */
+    if(sub->monitoredItemsSize > sub->monitoredItemsIndexSize) {
+        size_t indexSize = sub->monitoredItemsIndexSize * 2;
+        if(indexSize < UA_CLIENT_SUBSCRIPTION_MININDEXSIZE)
+            indexSize = UA_CLIENT_SUBSCRIPTION_MININDEXSIZE;
+        resizeClientMonitoredItemsIndex(sub, indexSize); /* Inserts mon */
+        if(sub->monitoredItemsIndexSize == indexSize)
+            return;
+    }
+
+    if(!sub->monitoredItemsIndex)
+        return;
+    size_t bucket = mon->clientHandle & (sub->monitoredItemsIndexSize - 1);
+    mon->indexNext = sub->monitoredItemsIndex[bucket];
+    sub->monitoredItemsIndex[bucket] = mon;
+}
+
+static void
+removeMonitoredItem(UA_Client_Subscription *sub, UA_Client_MonitoredItem *mon) {
+    sub->monitoredItemsSize--;
+    LIST_REMOVE(mon, listEntry);
+
+    if(!sub->monitoredItemsIndex)
+        return;
+    UA_Client_MonitoredItem **pos = &sub->monitoredItemsIndex
+        [mon->clientHandle & (sub->monitoredItemsIndexSize - 1)];
+    while(*pos && *pos != mon)
+        pos = &(*pos)->indexNext;
+    if(*pos)
+        *pos = mon->indexNext;
+    mon->indexNext = NULL;
+
+    /* Shrink the index when it has become sparse */
+    if(sub->monitoredItemsIndexSize > UA_CLIENT_SUBSCRIPTION_MININDEXSIZE &&
+       sub->monitoredItemsSize < sub->monitoredItemsIndexSize / 4)
+        resizeClientMonitoredItemsIndex(sub, sub->monitoredItemsIndexSize / 2);
+}
+
+static UA_Client_MonitoredItem *
+findMonitoredItem(const UA_Client_Subscription *sub, UA_UInt32 clientHandle) {
+    UA_Client_MonitoredItem *mon;
+    if(!sub->monitoredItemsIndex) {
+        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+            if(mon->clientHandle == clientHandle)
+                break;
+        }
+        return mon;
+    }
+    mon = sub->monitoredItemsIndex[clientHandle & (sub->monitoredItemsIndexSize - 1)];
+    while(mon && mon->clientHandle != clientHandle)
+        mon = mon->indexNext;
+    return mon;
+}
+
 static void
 MonitoredItem_delete(UA_Client *client, UA_Client_Subscription *sub,
                      UA_Client_MonitoredItem *mon) {
-    LIST_REMOVE(mon, listEntry);
+    removeMonitoredItem(sub, mon);
     if(mon->deleteCallback)
         mon->deleteCallback(client, sub->subscriptionId, sub->context,
                             mon->monitoredItemId, mon->context);
@@ -423,7 +576,7 @@ __MonitoredItems_create(UA_Client *client,MonitoredItems_CreateData *data,
         newMon->isEventMonitoredItem =
             (request->itemsToCreate[i].itemToMonitor.attributeId ==
              UA_ATTRIBUTEID_EVENTNOTIFIER);
-        LIST_INSERT_HEAD(&sub->monitoredItems, newMon, listEntry);
+        addMonitoredItem(sub, newMon);
 
         UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
                     "Subscription %" PRIu32 " | Added a MonitoredItem with handle %" PRIu32,
@@ -911,11 +1064,7 @@ processDataChangeNotification(UA_Client *client, UA_Client_Subscription *sub,
         UA_MonitoredItemNotification *min = &dataChangeNotification->monitoredItems[j];
 
         /* Find the MonitoredItem */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->clientHandle == min->clientHandle)
-                break;
-        }
+        UA_Client_MonitoredItem *mon = findMonitoredItem(sub, min->clientHandle);
 
         if(!mon) {
             UA_LOG_WARNING(&client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -944,11 +1093,8 @@ processEventNotification(UA_Client *client, UA_Client_Subscription *sub,
         UA_EventFieldList *eventFieldList = &eventNotificationList->events[j];
 
         /* Find the MonitoredItem */
-        UA_Client_MonitoredItem *mon;
-        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-            if(mon->clientHandle == eventFieldList->clientHandle)
-                break;
-        }
+        UA_Client_MonitoredItem *mon =
+            findMonitoredItem(sub, eventFieldList->clientHandle);
 
         if(!mon) {
             UA_LOG_DEBUG(&client->config.logger, UA_LOGCATEGORY_CLIENT,
@@ -1011,7 +1157,7 @@ processNotificationMessage(UA_Client *client, UA_Client_Subscription *sub,
                    "Unknown notification message type");
 }
 
-static void
+void
 UA_Client_Subscriptions_processPublishResponse(UA_Client *client, UA_PublishRequest *request,
                                                UA_PublishResponse *response) {
     UA_NotificationMessage *msg = &response->notificationMessage;
@@ -1154,6 +1300,9 @@ UA_Client_Subscriptions_clean(UA_Client *client) {
     UA_Client_Subscription *sub, *tmps;
     LIST_FOREACH_SAFE(sub, &client->subscriptions, listEntry, tmps)
         UA_Client_Subscription_deleteInternal(client, sub); /* force local removal */
+    UA_free(client->subscriptionsIndex);
+    client->subscriptionsIndex = NULL;
+    client->subscriptionsIndexSize = 0;
 
     client->monitoredItemHandles = 0;
 }
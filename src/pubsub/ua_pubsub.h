@@ -317,6 +317,15 @@ verifyAndDecryptNetworkMessage(const UA_Logger *logger,
                                UA_ByteString *buffer, size_t *currentPosition,
                                UA_NetworkMessage *currentNetworkMessage,
                                UA_ReaderGroup *readerGroup);
+
+/* Verify and decrypt a message in the RT fast path. The positions of the
+ * SecurityHeader, the payload and the signature are taken from the frozen
+ * DataSetReader. Returns the position after the signature in messageEnd. */
+UA_StatusCode
+verifyAndDecryptBufferedNetworkMessage(const UA_Logger *logger,
+                                       UA_ByteString *buffer, size_t currentPosition,
+                                       UA_NetworkMessageOffsetBuffer *bufferedMessage,
+                                       UA_ReaderGroup *readerGroup, size_t *messageEnd);
 #endif
 
 UA_StatusCode
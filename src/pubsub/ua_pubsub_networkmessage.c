@@ -142,6 +142,40 @@ UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
     return rv;
 }
 
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+UA_StatusCode
+UA_NetworkMessage_updateBufferedSecurityHeader(UA_NetworkMessageOffsetBuffer *buffer,
+                                               const UA_ByteString *src,
+                                               size_t bufferPosition) {
+    UA_NetworkMessage *nm = buffer->nm;
+    size_t offset = bufferPosition + buffer->securityHeaderOffset;
+
+    // SecurityFlags
+    UA_Byte decoded = 0;
+    UA_StatusCode rv = UA_Byte_decodeBinary(src, &offset, &decoded);
+    UA_CHECK_STATUS(rv, return rv);
+    nm->securityHeader.networkMessageSigned = ((decoded & SECURITY_HEADER_NM_SIGNED) != 0);
+    nm->securityHeader.networkMessageEncrypted = ((decoded & SECURITY_HEADER_NM_ENCRYPTED) != 0);
+    if(((decoded & SECURITY_HEADER_SEC_FOOTER_ENABLED) != 0) !=
+       nm->securityHeader.securityFooterEnabled)
+        return UA_STATUSCODE_BADDECODINGERROR;
+
+    // SecurityTokenId
+    rv = UA_UInt32_decodeBinary(src, &offset, &nm->securityHeader.securityTokenId);
+    UA_CHECK_STATUS(rv, return rv);
+
+    // NonceLength. Decode the MessageNonce into the preallocated buffer.
+    UA_Byte nonceLength;
+    rv = UA_Byte_decodeBinary(src, &offset, &nonceLength);
+    UA_CHECK_STATUS(rv, return rv);
+    if(nonceLength != nm->securityHeader.messageNonce.length ||
+       offset + nonceLength > src->length)
+        return UA_STATUSCODE_BADDECODINGERROR;
+    memcpy(nm->securityHeader.messageNonce.data, &src->data[offset], nonceLength);
+    return UA_STATUSCODE_GOOD;
+}
+#endif
+
 static
 UA_StatusCode
 UA_NetworkMessageHeader_encodeBinary(const UA_NetworkMessage *src, UA_Byte **bufPos,
@@ -1027,12 +1061,20 @@ UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p, UA_NetworkMessageOffsetBu
     }
 
     if(p->securityEnabled) {
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+        if(offsetBuffer)
+            offsetBuffer->securityHeaderOffset = size;
+#endif
         size += UA_Byte_calcSizeBinary(&byte);
         size += UA_UInt32_calcSizeBinary(&p->securityHeader.securityTokenId);
         size += 1; /* UA_Byte_calcSizeBinary(&p->securityHeader.nonceLength); */
         size += p->securityHeader.messageNonce.length;
         if(p->securityHeader.securityFooterEnabled)
             size += UA_UInt16_calcSizeBinary(&p->securityHeader.securityFooterSize);
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+        if(offsetBuffer)
+            offsetBuffer->payloadOffset = size;
+#endif
     }
 
     if(p->networkMessageType == UA_NETWORKMESSAGE_DATASET) {
@@ -1054,6 +1096,10 @@ UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p, UA_NetworkMessageOffsetBu
     if(p->securityEnabled) {
         if(p->securityHeader.securityFooterEnabled)
             size += p->securityHeader.securityFooterSize;
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+        if(offsetBuffer)
+            offsetBuffer->signatureOffset = size;
+#endif
     }
 
     retval = size;
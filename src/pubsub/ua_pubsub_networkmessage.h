@@ -218,6 +218,15 @@ typedef struct {
     size_t offsetsSize;
     UA_Boolean RTsubscriberEnabled; /* Addtional offsets computation like publisherId, WGId if this bool enabled */
     UA_NetworkMessage *nm; /* The precomputed NetworkMessage for subscriber */
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    /* Positions for signing and encrypting the buffered message in-place. Only
+     * set if the NetworkMessage has a SecurityHeader. The SecurityTokenId
+     * follows the SecurityFlags at securityHeaderOffset + 1, the NonceLength
+     * at + 5 and the MessageNonce at + 6. */
+    size_t securityHeaderOffset;
+    size_t payloadOffset;   /* Start of the encrypted part */
+    size_t signatureOffset; /* End of the signed part */
+#endif
 } UA_NetworkMessageOffsetBuffer;
 
 /**
@@ -260,6 +269,15 @@ UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
                                           const UA_ByteString *src, size_t *bufferPosition);
 
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+/* Decode the SecurityHeader of a received message at the fixed offset. The
+ * MessageNonce must have the length it had when the offsets were computed. */
+UA_StatusCode
+UA_NetworkMessage_updateBufferedSecurityHeader(UA_NetworkMessageOffsetBuffer *buffer,
+                                               const UA_ByteString *src,
+                                               size_t bufferPosition);
+#endif
+
 
 /**
  * NetworkMessage Encoding
@@ -332,6 +350,19 @@ UA_NetworkMessage_encodeJson(const UA_NetworkMessage *src,
                              size_t namespaceSize, UA_String *serverUris,
                              size_t serverUriSize, UA_Boolean useReversible);
 
+/* Single-pass encoding into a growable buffer. See UA_encodeJsonBuffer. If
+ * borrowed is set, buf initially points to memory that is not owned by the
+ * encoder (e.g. on the stack). When it runs full, the content is moved to a new
+ * heap buffer. The caller frees buf->data only if it no longer points to the
+ * initial memory. */
+UA_StatusCode
+UA_NetworkMessage_encodeJsonBuffer(const UA_NetworkMessage *src,
+                                   UA_ByteString *buf, UA_Boolean borrowed,
+                                   size_t *encodedLength,
+                                   UA_String *namespaces, size_t namespaceSize,
+                                   UA_String *serverUris, size_t serverUriSize,
+                                   UA_Boolean useReversible);
+
 size_t
 UA_NetworkMessage_calcSizeJson(const UA_NetworkMessage *src,
                                UA_String *namespaces, size_t namespaceSize,
@@ -241,6 +241,42 @@ UA_NetworkMessage_encodeJson(const UA_NetworkMessage *src,
     return ret;
 }
 
+status
+UA_NetworkMessage_encodeJsonBuffer(const UA_NetworkMessage *src,
+                                   UA_ByteString *buf, UA_Boolean borrowed,
+                                   size_t *encodedLength,
+                                   UA_String *namespaces, size_t namespaceSize,
+                                   UA_String *serverUris, size_t serverUriSize,
+                                   UA_Boolean useReversible) {
+    /* An empty ByteString may point to the sentinel */
+    if(buf->length == 0) {
+        buf->data = NULL;
+        borrowed = false;
+    }
+
+    /* Set up the context */
+    CtxJson ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.pos = buf->data;
+    ctx.end = (buf->data) ? &buf->data[buf->length] : NULL;
+    ctx.growBuffer = buf;
+    ctx.growBufferBorrowed = borrowed;
+    ctx.namespaces = namespaces;
+    ctx.namespacesSize = namespaceSize;
+    ctx.serverUris = serverUris;
+    ctx.serverUrisSize = serverUriSize;
+    ctx.useReversible = useReversible;
+
+    /* The buffer only runs full if the reallocation failed */
+    status ret = UA_NetworkMessage_encodeJson_internal(src, &ctx);
+    if(ret == UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    *encodedLength = (size_t)(ctx.pos - buf->data);
+    return UA_STATUSCODE_GOOD;
+}
+
 size_t
 UA_NetworkMessage_calcSizeJson(const UA_NetworkMessage *src,
                                UA_String *namespaces, size_t namespaceSize,
@@ -524,13 +560,24 @@ status UA_NetworkMessage_decodeJson(UA_NetworkMessage *dst, const UA_ByteString
     memset(&ctx, 0, sizeof(CtxJson));
     ParseCtx parseCtx;
     memset(&parseCtx, 0, sizeof(ParseCtx));
-    parseCtx.tokenArray = (jsmntok_t*)UA_malloc(sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
-    memset(parseCtx.tokenArray, 0, sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
+
+    /* Tokenize into a token array on the stack first. Larger messages are
+     * tokenized again with the maximum number of tokens on the heap. */
+    jsmntok_t stackTokens[UA_JSON_STACKTOKENCOUNT];
+    parseCtx.tokenArray = stackTokens;
+    parseCtx.tokenArraySize = UA_JSON_STACKTOKENCOUNT;
     status ret = tokenize(&parseCtx, &ctx, src);
-    if(ret != UA_STATUSCODE_GOOD){
-        return ret;
+    if(ret == UA_STATUSCODE_BADOUTOFMEMORY) {
+        parseCtx.tokenArray = (jsmntok_t*)
+            UA_malloc(sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
+        if(!parseCtx.tokenArray)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        parseCtx.tokenArraySize = UA_JSON_MAXTOKENCOUNT;
+        ret = tokenize(&parseCtx, &ctx, src);
     }
-    ret = NetworkMessage_decodeJsonInternal(dst, &ctx, &parseCtx);
-    UA_free(parseCtx.tokenArray);
+    if(ret == UA_STATUSCODE_GOOD)
+        ret = NetworkMessage_decodeJsonInternal(dst, &ctx, &parseCtx);
+    if(parseCtx.tokenArray != stackTokens)
+        UA_free(parseCtx.tokenArray);
     return ret;
 }
@@ -209,7 +209,8 @@ UA_DataSetReader_generateDataSetMessage(UA_Server *server, UA_DataSetMessage *da
 }
 
 static UA_StatusCode
-UA_DataSetReader_generateNetworkMessage(UA_PubSubConnection *pubSubConnection, UA_DataSetReader *dataSetReader, UA_DataSetMessage *dsm,
+UA_DataSetReader_generateNetworkMessage(UA_PubSubConnection *pubSubConnection, UA_ReaderGroup *readerGroup,
+                                        UA_DataSetReader *dataSetReader, UA_DataSetMessage *dsm,
                                         UA_UInt16 *writerId, UA_Byte dsmCount, UA_NetworkMessage *networkMessage) {
     if(dataSetReader->config.messageSettings.content.decoded.type != &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE])
         return UA_STATUSCODE_BADNOTSUPPORTED;
@@ -292,6 +293,20 @@ UA_DataSetReader_generateNetworkMessage(UA_PubSubConnection *pubSubConnection, U
     networkMessage->groupHeader.networkMessageNumber = 1;
     networkMessage->payload.dataSetPayload.sizes = dsmLengths;
     networkMessage->payload.dataSetPayload.dataSetMessages = dsm;
+
+    /* Set the SecurityHeader. The SecurityTokenId and the MessageNonce are
+     * taken from the received message. Only the NonceLength is fixed. */
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    if(readerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        networkMessage->securityEnabled = true;
+        networkMessage->securityHeader.networkMessageSigned = true;
+        if(readerGroup->config.securityMode >= UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
+            networkMessage->securityHeader.networkMessageEncrypted = true;
+        UA_StatusCode rv =
+            UA_ByteString_allocBuffer(&networkMessage->securityHeader.messageNonce, 8);
+        UA_CHECK_STATUS(rv, return rv);
+    }
+#endif
     return UA_STATUSCODE_GOOD;
 }
 
@@ -690,7 +705,7 @@ UA_Server_freezeReaderGroupConfiguration(UA_Server *server, const UA_NodeId read
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
 
-        res = UA_DataSetReader_generateNetworkMessage(pubSubConnection, dataSetReader, dsm,
+        res = UA_DataSetReader_generateNetworkMessage(pubSubConnection, rg, dataSetReader, dsm,
                                                       dsWriterIds, 1, networkMessage);
         if(res != UA_STATUSCODE_GOOD) {
             UA_free(networkMessage->payload.dataSetPayload.sizes);
@@ -1889,6 +1904,27 @@ decodeAndProcessNetworkMessageRT(UA_Server *server, UA_ReaderGroup *readerGroup,
 */
     size_t paddingBytes = 0;
     UA_DataSetReader *dataSetReader = LIST_FIRST(&readerGroup->readers);
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    /* Verify and decrypt in-place before the fixed offsets are decoded */
+    size_t messageEnd = 0;
+    if(dataSetReader->bufferedMessage.nm->securityEnabled) {
+        UA_StatusCode rv =
+            verifyAndDecryptBufferedNetworkMessage(&server->config.logger, buffer,
+                                                   *currentPosition,
+                                                   &dataSetReader->bufferedMessage,
+                                                   readerGroup, &messageEnd);
+        if(rv != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                           "Subscribe failed. verify and decrypt network message failed.");
+#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
+            useNormalAlloc();
+#endif /* UA_ENABLE_PUBSUB_BUFMALLOC */
+            return rv;
+        }
+    }
+#endif
+
     /* Decode only the necessary offset and update the networkMessage */
     if(UA_NetworkMessage_updateBufferedNwMessage(&dataSetReader->bufferedMessage, buffer,
                                                  currentPosition) != UA_STATUSCODE_GOOD) {
@@ -1929,6 +1965,12 @@ decodeAndProcessNetworkMessageRT(UA_Server *server, UA_ReaderGroup *readerGroup,
     useNormalAlloc();
 #endif /* UA_ENABLE_PUBSUB_BUFMALLOC */
 
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    /* Continue after the signature */
+    if(dataSetReader->bufferedMessage.nm->securityEnabled)
+        *currentPosition = messageEnd;
+#endif
+
     /* Minimum ethernet packet size is 64 bytes where the header size is 14
      * bytes and FCS size is 4 bytes so remaining minimum payload size of
      * ethernet packet is 46 bytes */
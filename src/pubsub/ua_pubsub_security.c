@@ -162,3 +162,43 @@ verifyAndDecryptNetworkMessage(const UA_Logger *logger,
 
     return rv;
 }
+
+UA_StatusCode
+verifyAndDecryptBufferedNetworkMessage(const UA_Logger *logger,
+                                       UA_ByteString *buffer, size_t currentPosition,
+                                       UA_NetworkMessageOffsetBuffer *bufferedMessage,
+                                       UA_ReaderGroup *readerGroup, size_t *messageEnd) {
+    void *channelContext = readerGroup->securityPolicyContext;
+    UA_PubSubSecurityPolicy *securityPolicy = readerGroup->config.securityPolicy;
+    UA_CHECK_MEM_ERROR(channelContext, return UA_STATUSCODE_BADINVALIDARGUMENT,
+                       logger, UA_LOGCATEGORY_SERVER,
+                       "PubSub receive. securityPolicyContext must be initialized "
+                       "when security mode is enabled to sign and/or encrypt");
+    UA_CHECK_MEM_ERROR(securityPolicy, return UA_STATUSCODE_BADINVALIDARGUMENT,
+                       logger, UA_LOGCATEGORY_SERVER,
+                       "PubSub receive. securityPolicy must be set when security mode"
+                       "is enabled to sign and/or encrypt");
+
+    /* The signature follows the fixed-size message */
+    size_t sigSize = securityPolicy->symmetricModule.cryptoModule.
+        signatureAlgorithm.getLocalSignatureSize(channelContext);
+    size_t msgSize = bufferedMessage->signatureOffset + sigSize;
+    UA_CHECK_WARN(currentPosition <= buffer->length &&
+                  msgSize <= buffer->length - currentPosition,
+                  return UA_STATUSCODE_BADDECODINGERROR, logger, UA_LOGCATEGORY_SERVER,
+                  "PubSub receive. Message shorter than expected");
+
+    UA_ByteString message = {msgSize, &buffer->data[currentPosition]};
+    UA_StatusCode rv =
+        UA_NetworkMessage_updateBufferedSecurityHeader(bufferedMessage, &message, 0);
+    UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SERVER,
+                         "PubSub receive. Decoding the SecurityHeader failed");
+
+    size_t payloadPosition = bufferedMessage->payloadOffset;
+    rv = verifyAndDecryptNetworkMessage(logger, &message, &payloadPosition,
+                                        bufferedMessage->nm, readerGroup);
+    UA_CHECK_STATUS(rv, return rv);
+
+    *messageEnd = currentPosition + msgSize;
+    return UA_STATUSCODE_GOOD;
+}
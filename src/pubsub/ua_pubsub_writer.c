@@ -352,6 +352,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
         res = UA_ByteString_allocBuffer(&buf, msgSize);
         if(res != UA_STATUSCODE_GOOD)
         {
+            UA_ByteString_clear(&networkMessage.securityHeader.messageNonce);
             UA_free(networkMessage.payload.dataSetPayload.sizes);
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
@@ -360,6 +361,7 @@ UA_Server_freezeWriterGroupConfiguration(UA_Server *server, const UA_NodeId writ
         UA_Byte *bufPos = wg->bufferedMessage.buffer.data;
         UA_NetworkMessage_encodeBinary(&networkMessage, &bufPos, bufEnd, NULL);
 
+        UA_ByteString_clear(&networkMessage.securityHeader.messageNonce);
         UA_free(networkMessage.payload.dataSetPayload.sizes);
         /* Clean up DSM */
         for(size_t i = 0; i < dsmCount; i++){
@@ -1931,35 +1933,21 @@ sendNetworkMessageJson(UA_PubSubConnection *connection, UA_DataSetMessage *dsm,
     nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = writerIds;
     nm.payload.dataSetPayload.dataSetMessages = dsm;
 
-    /* Allocate the buffer. Allocate on the stack if the buffer is small. */
-    UA_ByteString buf;
-    size_t msgSize = UA_NetworkMessage_calcSizeJson(&nm, NULL, 0, NULL, 0, true);
-    size_t stackSize = 1;
-    if(msgSize <= UA_MAX_STACKBUF)
-        stackSize = msgSize;
-    UA_STACKARRAY(UA_Byte, stackBuf, stackSize);
-    buf.data = stackBuf;
-    buf.length = msgSize;
-    if(msgSize > UA_MAX_STACKBUF) {
-        retval = UA_ByteString_allocBuffer(&buf, msgSize);
-        if(retval != UA_STATUSCODE_GOOD)
-            return retval;
-    }
-
-    /* Encode the message */
-    UA_Byte *bufPos = buf.data;
-    memset(bufPos, 0, msgSize);
-    const UA_Byte *bufEnd = &buf.data[buf.length];
-    retval = UA_NetworkMessage_encodeJson(&nm, &bufPos, &bufEnd, NULL, 0, NULL, 0, true);
-    if(retval != UA_STATUSCODE_GOOD) {
-        if(msgSize > UA_MAX_STACKBUF)
-            UA_ByteString_clear(&buf);
-        return retval;
-    }
+    /* Encode the message in a single pass into a buffer on the stack. Only
+     * messages that don't fit are moved to a growing buffer on the heap. */
+    UA_Byte stackBuf[UA_MAX_STACKBUF];
+    UA_ByteString buf = {UA_MAX_STACKBUF, stackBuf};
+    size_t msgSize = 0;
+    retval = UA_NetworkMessage_encodeJsonBuffer(&nm, &buf, true, &msgSize,
+                                                NULL, 0, NULL, 0, true);
 
     /* Send the prepared messages */
-    retval = connection->channel->send(connection->channel, transportSettings, &buf);
-    if(msgSize > UA_MAX_STACKBUF)
+    if(retval == UA_STATUSCODE_GOOD) {
+        UA_ByteString msg = {msgSize, buf.data};
+        retval = connection->channel->send(connection->channel,
+                                           transportSettings, &msg);
+    }
+    if(buf.data != stackBuf)
         UA_ByteString_clear(&buf);
 #endif
     return retval;
@@ -2035,6 +2023,7 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
         UA_Byte *pos = &networkMessage->securityHeader.messageNonce.data[4];
         const UA_Byte *end = &networkMessage->securityHeader.messageNonce.data[8];
         UA_UInt32_encodeBinary(&wg->nonceSequenceNumber, &pos, end);
+        wg->nonceSequenceNumber++;
     }
 #endif
 
@@ -2070,28 +2059,17 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_StatusCode
-sendBufferedNetworkMessage(UA_Server *server, UA_PubSubConnection *connection,
-                           UA_NetworkMessageOffsetBuffer *buffer,
-                           UA_ExtensionObject *transportSettings) {
-    if(UA_NetworkMessage_updateBufferedMessage(buffer) != UA_STATUSCODE_GOOD)
-        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "PubSub sending. Unknown field type.");
-    return connection->channel->send(connection->channel,
-                                     transportSettings, &buffer->buffer);
-}
-
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
 static UA_StatusCode
-encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
-                 UA_Byte *signStart, UA_Byte *encryptStart,
-                 UA_Byte *msgEnd) {
+encryptAndSign(UA_WriterGroup *wg, const UA_ByteString *messageNonce,
+               UA_Byte *signStart, UA_Byte *encryptStart,
+               UA_Byte *msgEnd) {
     UA_StatusCode rv;
     void *channelContext = wg->securityPolicyContext;
 
-    if(nm->securityHeader.networkMessageEncrypted) {
+    if(wg->config.securityMode >= UA_MESSAGESECURITYMODE_SIGNANDENCRYPT) {
         /* Set the temporary MessageNonce in the SecurityPolicy */
-        rv = wg->config.securityPolicy->setMessageNonce(channelContext, &nm->securityHeader.messageNonce);
+        rv = wg->config.securityPolicy->setMessageNonce(channelContext, messageNonce);
         UA_CHECK_STATUS(rv, return rv);
 
         /* The encryption is done in-place, no need to encode again */
@@ -2102,7 +2080,7 @@ encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
         UA_CHECK_STATUS(rv, return rv);
     }
 
-    if(nm->securityHeader.networkMessageSigned) {
+    if(wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
         UA_ByteString toBeSigned = {(uintptr_t)msgEnd - (uintptr_t)signStart,
                                     signStart};
 
@@ -2116,8 +2094,83 @@ encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
     }
     return UA_STATUSCODE_GOOD;
 }
+
+/* The buffered message is only a template. Copy it into the send buffer, set
+ * the current SecurityTokenId and a fresh MessageNonce. Then encrypt and sign
+ * in-place. The send buffer has additional space for the signature. */
+static UA_StatusCode
+encryptAndSignBufferedMessage(UA_WriterGroup *wg, UA_ByteString *buf) {
+    if(!wg->securityPolicyContext)
+        return UA_STATUSCODE_BADINVALIDSTATE;
+
+    UA_NetworkMessageOffsetBuffer *bm = &wg->bufferedMessage;
+    memcpy(buf->data, bm->buffer.data, bm->buffer.length);
+
+    /* SecurityTokenId */
+    UA_Byte *bufStart = buf->data;
+    const UA_Byte *bufEnd = &buf->data[buf->length];
+    UA_Byte *bufPos = &bufStart[bm->securityHeaderOffset + 1];
+    UA_StatusCode rv = UA_UInt32_encodeBinary(&wg->securityTokenId, &bufPos, bufEnd);
+    UA_CHECK_STATUS(rv, return rv);
+
+    /* MessageNonce with 4 random bytes and the NonceSequenceNumber. The
+     * NonceLength was fixed when the message was frozen. */
+    UA_ByteString messageNonce = {8, &bufStart[bm->securityHeaderOffset + 6]};
+    UA_ByteString randomPart = {4, messageNonce.data};
+    rv = wg->config.securityPolicy->symmetricModule.
+        generateNonce(wg->config.securityPolicy->policyContext, &randomPart);
+    UA_CHECK_STATUS(rv, return rv);
+    bufPos = &messageNonce.data[4];
+    rv = UA_UInt32_encodeBinary(&wg->nonceSequenceNumber, &bufPos, bufEnd);
+    UA_CHECK_STATUS(rv, return rv);
+    wg->nonceSequenceNumber++;
+
+    return encryptAndSign(wg, &messageNonce, bufStart, &bufStart[bm->payloadOffset],
+                          &bufStart[bm->signatureOffset]);
+}
 #endif
 
+static UA_StatusCode
+sendBufferedNetworkMessage(UA_Server *server, UA_PubSubConnection *connection,
+                           UA_WriterGroup *wg) {
+    UA_NetworkMessageOffsetBuffer *buffer = &wg->bufferedMessage;
+    if(UA_NetworkMessage_updateBufferedMessage(buffer) != UA_STATUSCODE_GOOD)
+        UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "PubSub sending. Unknown field type.");
+
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    if(wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_PubSubSecurityPolicy *sp = wg->config.securityPolicy;
+        size_t msgSize = buffer->buffer.length + sp->symmetricModule.cryptoModule.
+            signatureAlgorithm.getLocalSignatureSize(sp->policyContext);
+
+        /* Allocate the memory */
+        UA_ByteString buf;
+        UA_Byte stackBuf[UA_MAX_STACKBUF];
+        if(msgSize <= UA_MAX_STACKBUF) {
+            buf.data = stackBuf;
+            buf.length = msgSize;
+        } else {
+            UA_StatusCode rv = UA_ByteString_allocBuffer(&buf, msgSize);
+            UA_CHECK_STATUS(rv, return rv);
+        }
+
+        UA_StatusCode rv = encryptAndSignBufferedMessage(wg, &buf);
+        UA_CHECK_STATUS_WARN(rv, (void)0, &server->config.logger, UA_LOGCATEGORY_SERVER,
+                             "PubSub sending. Encrypting and signing failed.");
+        if(rv == UA_STATUSCODE_GOOD)
+            rv = connection->channel->send(connection->channel,
+                                           &wg->config.transportSettings, &buf);
+        if(msgSize > UA_MAX_STACKBUF)
+            UA_ByteString_clear(&buf);
+        return rv;
+    }
+#endif
+
+    return connection->channel->send(connection->channel,
+                                     &wg->config.transportSettings, &buffer->buffer);
+}
+
 static UA_StatusCode
 writeNetworkMessage(UA_WriterGroup *wg, size_t msgSize,
                     UA_NetworkMessage *nm, UA_ByteString *buf) { /* Encode the message */
@@ -2146,7 +2199,8 @@ writeNetworkMessage(UA_WriterGroup *wg, size_t msgSize,
     /* Encrypt and Sign the message */
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
 
-    rv = encryptAndSign(wg, nm, networkMessageStart, payloadStart, footerEnd);
+    rv = encryptAndSign(wg, &nm->securityHeader.messageNonce,
+                        networkMessageStart, payloadStart, footerEnd);
     UA_CHECK_STATUS(rv, return rv);
 
 #endif
@@ -2244,8 +2298,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
     if(writerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
         UA_StatusCode res =
-            sendBufferedNetworkMessage(server, connection, &writerGroup->bufferedMessage,
-                                       &writerGroup->config.transportSettings);
+            sendBufferedNetworkMessage(server, connection, writerGroup);
         if(res == UA_STATUSCODE_GOOD) {
             writerGroup->sequenceNumber++;
         } else {
@@ -16,14 +16,17 @@
 #include "aa_tree.h"
 
 static enum aa_cmp
-cmpRefTargetId(const void *a, const void *b) {
-    const UA_ReferenceTarget *aa = (const UA_ReferenceTarget*)a;
-    const UA_ReferenceTarget *bb = (const UA_ReferenceTarget*)b;
-    if(aa->targetIdHash < bb->targetIdHash)
+cmpRefTarget(const UA_ReferenceTarget *a, const UA_ReferenceTarget *b) {
+    if(a->targetIdHash < b->targetIdHash)
         return AA_CMP_LESS;
-    if(aa->targetIdHash > bb->targetIdHash)
+    if(a->targetIdHash > b->targetIdHash)
         return AA_CMP_MORE;
-    return (enum aa_cmp)UA_ExpandedNodeId_order(&aa->targetId, &bb->targetId);
+    return (enum aa_cmp)UA_ExpandedNodeId_order(&a->targetId, &b->targetId);
+}
+
+static enum aa_cmp
+cmpRefTargetId(const void *a, const void *b) {
+    return cmpRefTarget((const UA_ReferenceTarget*)a, (const UA_ReferenceTarget*)b);
 }
 
 static enum aa_cmp
@@ -39,26 +42,65 @@ cmpRefTargetName(const void *a, const void *b) {
 
 /* Reusable binary search tree "heads". Just switch out the root pointer. */
 static const struct aa_head refIdTree =
-    { NULL, cmpRefTargetId, offsetof(UA_ReferenceTarget, idTreeEntry), 0 };
-const struct aa_head refNameTree =
-    { NULL, cmpRefTargetName, offsetof(UA_ReferenceTarget, nameTreeEntry),
-      offsetof(UA_ReferenceTarget, targetNameHash) };
+    { NULL, cmpRefTargetId, offsetof(UA_ReferenceTargetTreeElem, idTreeEntry),
+      offsetof(UA_ReferenceTargetTreeElem, target) };
+static const struct aa_head refNameTree =
+    { NULL, cmpRefTargetName, offsetof(UA_ReferenceTargetTreeElem, nameTreeEntry),
+      offsetof(UA_ReferenceTargetTreeElem, target.targetNameHash) };
+
+#define TREEELEM(t) ((UA_ReferenceTargetTreeElem*)                      \
+                     ((uintptr_t)(t) - offsetof(UA_ReferenceTargetTreeElem, target)))
+
+/* Allocations in the flat copy are aligned to UA_FLAT_ALIGN */
+#define UA_FLAT_ALIGN 8
+#define UA_FLAT_ALIGNED(size) (((size) + (UA_FLAT_ALIGN - 1)) & ~(size_t)(UA_FLAT_ALIGN - 1))
+
+/* In flat copies, arrays with more than UA_REFERENCETARGETS_ARRAY_MAX targets
+ * are directly followed by an index for the lookup by BrowseName. The entries
+ * are (targetNameHash << 32 | position in the array), sorted ascending. */
+static const UA_UInt64 *
+flatNameIndex(const UA_NodeReferenceKind *kind) {
+    return (const UA_UInt64*)((uintptr_t)kind->targets.array +
+        UA_FLAT_ALIGNED(sizeof(UA_ReferenceTarget) * kind->targetsSize));
+}
+
+/* Binary search in the sorted array. Returns the index of the first target
+ * that is not smaller than the search target. */
+static size_t
+findArrayPosition(const UA_NodeReferenceKind *kind, const UA_ReferenceTarget *target) {
+    size_t lower = 0, upper = kind->targetsSize;
+    while(lower < upper) {
+        size_t middle = lower + ((upper - lower) / 2);
+        if(cmpRefTarget(&kind->targets.array[middle], target) == AA_CMP_LESS)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return lower;
+}
 
 UA_ReferenceTarget *
 UA_NodeReferenceKind_firstTarget(const UA_NodeReferenceKind *kind) {
-    struct aa_head _refIdTree =
-        { kind->idTreeRoot, cmpRefTargetId,
-          offsetof(UA_ReferenceTarget, idTreeEntry), 0 };
-    return (UA_ReferenceTarget*)aa_min(&_refIdTree);
+    if(!kind->hasRefTree)
+        return (kind->targetsSize > 0) ? kind->targets.array : NULL;
+    struct aa_head _refIdTree = refIdTree;
+    _refIdTree.root = kind->targets.tree.idTreeRoot;
+    UA_ReferenceTargetTreeElem *elem = (UA_ReferenceTargetTreeElem*)aa_min(&_refIdTree);
+    return (elem) ? &elem->target : NULL;
 }
 
 UA_ReferenceTarget *
 UA_NodeReferenceKind_nextTarget(const UA_NodeReferenceKind *kind,
                                 const UA_ReferenceTarget *current) {
-    struct aa_head _refIdTree =
-        { kind->idTreeRoot, cmpRefTargetId,
-          offsetof(UA_ReferenceTarget, idTreeEntry), 0 };
-    return (UA_ReferenceTarget*)aa_next(&_refIdTree, current);
+    if(!kind->hasRefTree) {
+        size_t next = (size_t)(current - kind->targets.array) + 1;
+        return (next < kind->targetsSize) ? &kind->targets.array[next] : NULL;
+    }
+    struct aa_head _refIdTree = refIdTree;
+    _refIdTree.root = kind->targets.tree.idTreeRoot;
+    UA_ReferenceTargetTreeElem *elem = (UA_ReferenceTargetTreeElem*)
+        aa_next(&_refIdTree, TREEELEM(current));
+    return (elem) ? &elem->target : NULL;
 }
 
 UA_ReferenceTarget *
@@ -67,10 +109,77 @@ UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *kind,
     UA_ReferenceTarget tmpTarget;
     tmpTarget.targetId = *targetId;
     tmpTarget.targetIdHash = UA_ExpandedNodeId_hash(targetId);
-    struct aa_head _refIdTree =
-        { kind->idTreeRoot, cmpRefTargetId,
-          offsetof(UA_ReferenceTarget, idTreeEntry), 0 };
-    return (UA_ReferenceTarget*)aa_find(&_refIdTree, &tmpTarget);
+    if(!kind->hasRefTree) {
+        size_t pos = findArrayPosition(kind, &tmpTarget);
+        if(pos < kind->targetsSize &&
+           cmpRefTarget(&kind->targets.array[pos], &tmpTarget) == AA_CMP_EQ)
+            return &kind->targets.array[pos];
+        return NULL;
+    }
+    struct aa_head _refIdTree = refIdTree;
+    _refIdTree.root = kind->targets.tree.idTreeRoot;
+    UA_ReferenceTargetTreeElem *elem = (UA_ReferenceTargetTreeElem*)
+        aa_find(&_refIdTree, &tmpTarget);
+    return (elem) ? &elem->target : NULL;
+}
+
+UA_ReferenceTarget *
+UA_NodeReferenceKind_nextTargetByName(const UA_NodeReferenceKind *kind,
+                                      UA_UInt32 targetNameHash,
+                                      const UA_ReferenceTarget *current) {
+    /* Binary search in the name index of large flat arrays. Arrays above
+     * UA_REFERENCETARGETS_ARRAY_MAX only exist in flat copies. The next entry
+     * after the current target is the first one not below (hash, pos + 1). */
+    if(!kind->hasRefTree && kind->targetsSize > UA_REFERENCETARGETS_ARRAY_MAX) {
+        const UA_UInt64 *index = flatNameIndex(kind);
+        UA_UInt64 key = (UA_UInt64)targetNameHash << 32;
+        if(current)
+            key |= (UA_UInt64)(current - kind->targets.array) + 1;
+        size_t lower = 0, upper = kind->targetsSize;
+        while(lower < upper) {
+            size_t middle = lower + ((upper - lower) / 2);
+            if(index[middle] < key)
+                lower = middle + 1;
+            else
+                upper = middle;
+        }
+        if(lower == kind->targetsSize || (UA_UInt32)(index[lower] >> 32) != targetNameHash)
+            return NULL;
+        return &kind->targets.array[(UA_UInt32)index[lower]];
+    }
+
+    /* Linear scan in the small arrays */
+    if(!kind->hasRefTree) {
+        size_t i = (current) ? (size_t)(current - kind->targets.array) + 1 : 0;
+        for(; i < kind->targetsSize; i++) {
+            if(kind->targets.array[i].targetNameHash == targetNameHash)
+                return &kind->targets.array[i];
+        }
+        return NULL;
+    }
+
+    /* The targets with the same name hash are adjacent in the name tree */
+    struct aa_head _refNameTree = refNameTree;
+    _refNameTree.root = kind->targets.tree.nameTreeRoot;
+    UA_ReferenceTargetTreeElem *elem;
+    if(current) {
+        elem = (UA_ReferenceTargetTreeElem*)aa_next(&_refNameTree, TREEELEM(current));
+        if(!elem || elem->target.targetNameHash != targetNameHash)
+            return NULL;
+        return &elem->target;
+    }
+
+    /* Find any matching target and go back to the first one */
+    elem = (UA_ReferenceTargetTreeElem*)aa_find(&_refNameTree, &targetNameHash);
+    if(!elem)
+        return NULL;
+    UA_ReferenceTargetTreeElem *prev = (UA_ReferenceTargetTreeElem*)
+        aa_prev(&_refNameTree, elem);
+    while(prev && prev->target.targetNameHash == targetNameHash) {
+        elem = prev;
+        prev = (UA_ReferenceTargetTreeElem*)aa_prev(&_refNameTree, elem);
+    }
+    return &elem->target;
 }
 
 const UA_Node *
@@ -160,6 +269,9 @@ UA_VariableNode_copy(const UA_VariableNode *src, UA_VariableNode *dst) {
     dst->minimumSamplingInterval = src->minimumSamplingInterval;
     dst->historizing = src->historizing;
     dst->isDynamic = src->isDynamic;
+#if UA_MULTITHREADING >= 100
+    dst->async = src->async;
+#endif
     return UA_CommonVariableNode_copy(src, dst);
 }
 
@@ -211,8 +323,7 @@ UA_ViewNode_copy(const UA_ViewNode *src, UA_ViewNode *dst) {
 }
 
 static UA_StatusCode
-addReferenceTarget(UA_NodeReferenceKind *refs, const UA_ExpandedNodeId *target,
-                   UA_UInt32 targetNameHash);
+copyReferenceTargets(const UA_NodeReferenceKind *src, UA_NodeReferenceKind *dst);
 
 UA_StatusCode
 UA_Node_copy(const UA_Node *src, UA_Node *dst) {
@@ -250,17 +361,9 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
             UA_NodeReferenceKind *drefs = &dsthead->references[i];
             drefs->referenceTypeIndex = srefs->referenceTypeIndex;
             drefs->isInverse = srefs->isInverse;
-            drefs->idTreeRoot = NULL;
-            drefs->nameTreeRoot = NULL;
 
             /* Copy all the targets */
-            for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(srefs);
-                t; t = UA_NodeReferenceKind_nextTarget(srefs, t)) {
-                retval = addReferenceTarget(drefs, &t->targetId, t->targetNameHash);
-                if(retval != UA_STATUSCODE_GOOD)
-                    break;
-            }
-
+            retval = copyReferenceTargets(srefs, drefs);
             if(retval != UA_STATUSCODE_GOOD)
                 break;
         }
@@ -307,37 +410,35 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
     return retval;
 }
 
-UA_Node *
-UA_Node_copy_alloc(const UA_Node *src) {
-    size_t nodesize = 0;
-    switch(src->head.nodeClass) {
+static size_t
+nodeSize(UA_NodeClass nodeClass) {
+    switch(nodeClass) {
         case UA_NODECLASS_OBJECT:
-            nodesize = sizeof(UA_ObjectNode);
-            break;
+            return sizeof(UA_ObjectNode);
         case UA_NODECLASS_VARIABLE:
-            nodesize = sizeof(UA_VariableNode);
-            break;
+            return sizeof(UA_VariableNode);
         case UA_NODECLASS_METHOD:
-            nodesize = sizeof(UA_MethodNode);
-            break;
+            return sizeof(UA_MethodNode);
         case UA_NODECLASS_OBJECTTYPE:
-            nodesize = sizeof(UA_ObjectTypeNode);
-            break;
+            return sizeof(UA_ObjectTypeNode);
         case UA_NODECLASS_VARIABLETYPE:
-            nodesize = sizeof(UA_VariableTypeNode);
-            break;
+            return sizeof(UA_VariableTypeNode);
         case UA_NODECLASS_REFERENCETYPE:
-            nodesize = sizeof(UA_ReferenceTypeNode);
-            break;
+            return sizeof(UA_ReferenceTypeNode);
         case UA_NODECLASS_DATATYPE:
-            nodesize = sizeof(UA_DataTypeNode);
-            break;
+            return sizeof(UA_DataTypeNode);
         case UA_NODECLASS_VIEW:
-            nodesize = sizeof(UA_ViewNode);
-            break;
+            return sizeof(UA_ViewNode);
         default:
-            return NULL;
+            return 0;
     }
+}
+
+UA_Node *
+UA_Node_copy_alloc(const UA_Node *src) {
+    size_t nodesize = nodeSize(src->head.nodeClass);
+    if(nodesize == 0)
+        return NULL;
 
     UA_Node *dst = (UA_Node*)UA_calloc(1, nodesize);
     if(!dst)
@@ -352,6 +453,342 @@ UA_Node_copy_alloc(const UA_Node *src) {
     }
     return dst;
 }
+
+/*************/
+/* Flat Copy */
+/*************/
+
+/* The flat copy places the node and all of its content into one contiguous
+ * buffer. Without a buffer (pos == NULL), only the required size is counted.
+ * Then nothing is written to the destination. */
+
+typedef struct {
+    UA_Byte *pos;
+    size_t size;
+} FlatBuffer;
+
+static void *
+flatAlloc(FlatBuffer *fb, size_t size) {
+    size = UA_FLAT_ALIGNED(size);
+    fb->size += size;
+    if(!fb->pos)
+        return NULL;
+    void *p = fb->pos;
+    fb->pos += size;
+    return p;
+}
+
+static void
+flatCopy(FlatBuffer *fb, const void *src, void *dst, const UA_DataType *type);
+
+static void *
+flatCopyArray(FlatBuffer *fb, const void *src, size_t size,
+              const UA_DataType *type) {
+    if(size == 0)
+        return (void*)(uintptr_t)src; /* NULL or the empty array sentinel */
+    void *dst = flatAlloc(fb, size * type->memSize);
+    uintptr_t ptrs = (uintptr_t)src;
+    uintptr_t ptrd = (uintptr_t)dst;
+    for(size_t i = 0; i < size; i++) {
+        flatCopy(fb, (const void*)ptrs, dst ? (void*)ptrd : NULL, type);
+        ptrs += type->memSize;
+        ptrd += type->memSize;
+    }
+    return dst;
+}
+
+static void
+flatCopyString(FlatBuffer *fb, const UA_String *src, UA_String *dst) {
+    if(src->length == 0) {
+        if(dst && src->data != NULL)
+            dst->data = (UA_Byte*)UA_EMPTY_ARRAY_SENTINEL;
+        return;
+    }
+    UA_Byte *data = (UA_Byte*)flatAlloc(fb, src->length);
+    if(!dst)
+        return;
+    memcpy(data, src->data, src->length);
+    dst->data = data;
+}
+
+static void
+flatCopyNodeId(FlatBuffer *fb, const UA_NodeId *src, UA_NodeId *dst) {
+    if(src->identifierType == UA_NODEIDTYPE_STRING ||
+       src->identifierType == UA_NODEIDTYPE_BYTESTRING)
+        flatCopyString(fb, &src->identifier.string,
+                       dst ? &dst->identifier.string : NULL);
+}
+
+static void
+flatCopyVariant(FlatBuffer *fb, const UA_Variant *src, UA_Variant *dst) {
+    if(!src->type)
+        return;
+    size_t length = src->arrayLength;
+    if(UA_Variant_isScalar(src))
+        length = 1;
+    void *data = flatCopyArray(fb, src->data, length, src->type);
+    void *dims = flatCopyArray(fb, src->arrayDimensions, src->arrayDimensionsSize,
+                               &UA_TYPES[UA_TYPES_UINT32]);
+    if(!dst)
+        return;
+    dst->data = data;
+    dst->arrayDimensions = (UA_UInt32*)dims;
+    dst->storageType = UA_VARIANT_DATA_NODELETE;
+}
+
+static void
+flatCopyMembers(FlatBuffer *fb, const void *src, void *dst,
+                const UA_DataType *type) {
+    uintptr_t ptrs = (uintptr_t)src;
+    uintptr_t ptrd = (uintptr_t)dst;
+    const UA_DataType *typelists[2] = { UA_TYPES, &type[-type->typeIndex] };
+    size_t membersSize = type->membersSize;
+    const UA_DataTypeMember *members = type->members;
+
+    /* Only the selected member of a union is copied */
+    if(type->typeKind == UA_DATATYPEKIND_UNION) {
+        UA_UInt32 selection = *(const UA_UInt32*)src;
+        if(selection == 0)
+            return;
+        members = &type->members[selection - 1];
+        membersSize = 1;
+    }
+
+    for(size_t i = 0; i < membersSize; ++i) {
+        const UA_DataTypeMember *m = &members[i];
+        const UA_DataType *mt = &typelists[!m->namespaceZero][m->memberTypeIndex];
+        if(type->typeKind == UA_DATATYPEKIND_UNION) {
+            ptrs = (uintptr_t)src;
+            ptrd = (uintptr_t)dst;
+        }
+        ptrs += m->padding;
+        ptrd += m->padding;
+        if(!m->isOptional && !m->isArray) {
+            flatCopy(fb, (const void*)ptrs, dst ? (void*)ptrd : NULL, mt);
+            ptrs += mt->memSize;
+            ptrd += mt->memSize;
+            continue;
+        }
+        if(m->isArray) {
+            const size_t size = *(const size_t*)ptrs;
+            ptrs += sizeof(size_t);
+            ptrd += sizeof(size_t);
+            void *array = flatCopyArray(fb, *(void* const*)ptrs, size, mt);
+            if(dst)
+                *(void**)ptrd = array;
+        } else {
+            /* Optional scalar member */
+            void *member = flatCopyArray(fb, *(void* const*)ptrs,
+                                         *(void* const*)ptrs ? 1 : 0, mt);
+            if(dst)
+                *(void**)ptrd = member;
+        }
+        ptrs += sizeof(void*);
+        ptrd += sizeof(void*);
+    }
+}
+
+static void
+flatCopy(FlatBuffer *fb, const void *src, void *dst, const UA_DataType *type) {
+    if(dst)
+        memcpy(dst, src, type->memSize);
+    if(type->pointerFree)
+        return;
+
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_STRING:
+    case UA_DATATYPEKIND_BYTESTRING:
+    case UA_DATATYPEKIND_XMLELEMENT:
+        flatCopyString(fb, (const UA_String*)src, (UA_String*)dst);
+        break;
+    case UA_DATATYPEKIND_NODEID:
+        flatCopyNodeId(fb, (const UA_NodeId*)src, (UA_NodeId*)dst);
+        break;
+    case UA_DATATYPEKIND_EXPANDEDNODEID: {
+        const UA_ExpandedNodeId *s = (const UA_ExpandedNodeId*)src;
+        UA_ExpandedNodeId *d = (UA_ExpandedNodeId*)dst;
+        flatCopyNodeId(fb, &s->nodeId, d ? &d->nodeId : NULL);
+        flatCopyString(fb, &s->namespaceUri, d ? &d->namespaceUri : NULL);
+        break;
+    }
+    case UA_DATATYPEKIND_QUALIFIEDNAME: {
+        const UA_QualifiedName *s = (const UA_QualifiedName*)src;
+        UA_QualifiedName *d = (UA_QualifiedName*)dst;
+        flatCopyString(fb, &s->name, d ? &d->name : NULL);
+        break;
+    }
+    case UA_DATATYPEKIND_LOCALIZEDTEXT: {
+        const UA_LocalizedText *s = (const UA_LocalizedText*)src;
+        UA_LocalizedText *d = (UA_LocalizedText*)dst;
+        flatCopyString(fb, &s->locale, d ? &d->locale : NULL);
+        flatCopyString(fb, &s->text, d ? &d->text : NULL);
+        break;
+    }
+    case UA_DATATYPEKIND_EXTENSIONOBJECT: {
+        const UA_ExtensionObject *s = (const UA_ExtensionObject*)src;
+        UA_ExtensionObject *d = (UA_ExtensionObject*)dst;
+        if(s->encoding >= UA_EXTENSIONOBJECT_DECODED) {
+            if(!s->content.decoded.data || !s->content.decoded.type)
+                break;
+            void *data = flatCopyArray(fb, s->content.decoded.data, 1,
+                                       s->content.decoded.type);
+            if(d) {
+                d->content.decoded.data = data;
+                d->encoding = UA_EXTENSIONOBJECT_DECODED_NODELETE;
+            }
+        } else {
+            flatCopyNodeId(fb, &s->content.encoded.typeId,
+                           d ? &d->content.encoded.typeId : NULL);
+            flatCopyString(fb, &s->content.encoded.body,
+                           d ? &d->content.encoded.body : NULL);
+        }
+        break;
+    }
+    case UA_DATATYPEKIND_DATAVALUE: {
+        const UA_DataValue *s = (const UA_DataValue*)src;
+        UA_DataValue *d = (UA_DataValue*)dst;
+        flatCopyVariant(fb, &s->value, d ? &d->value : NULL);
+        break;
+    }
+    case UA_DATATYPEKIND_VARIANT:
+        flatCopyVariant(fb, (const UA_Variant*)src, (UA_Variant*)dst);
+        break;
+    case UA_DATATYPEKIND_DIAGNOSTICINFO: {
+        const UA_DiagnosticInfo *s = (const UA_DiagnosticInfo*)src;
+        UA_DiagnosticInfo *d = (UA_DiagnosticInfo*)dst;
+        flatCopyString(fb, &s->additionalInfo, d ? &d->additionalInfo : NULL);
+        if(s->hasInnerDiagnosticInfo && s->innerDiagnosticInfo) {
+            void *inner = flatCopyArray(fb, s->innerDiagnosticInfo, 1, type);
+            if(d)
+                d->innerDiagnosticInfo = (UA_DiagnosticInfo*)inner;
+        }
+        break;
+    }
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT:
+    case UA_DATATYPEKIND_UNION:
+        flatCopyMembers(fb, src, dst, type);
+        break;
+    default:
+        break;
+    }
+}
+
+static int
+cmpFlatNameIndex(const void *a, const void *b) {
+    UA_UInt64 ea = *(const UA_UInt64*)a, eb = *(const UA_UInt64*)b;
+    return (ea < eb) ? -1 : (ea > eb);
+}
+
+static void
+flatCopyReferences(FlatBuffer *fb, const UA_NodeHead *src, UA_NodeHead *dst) {
+    if(src->referencesSize == 0)
+        return;
+    UA_NodeReferenceKind *refs = (UA_NodeReferenceKind*)
+        flatAlloc(fb, sizeof(UA_NodeReferenceKind) * src->referencesSize);
+    if(dst)
+        dst->references = refs;
+
+    /* Flat copies are not edited. The targets are always stored in the
+     * (compact) array representation. */
+    for(size_t i = 0; i < src->referencesSize; i++) {
+        const UA_NodeReferenceKind *srefs = &src->references[i];
+        UA_ReferenceTarget *targets = (UA_ReferenceTarget*)
+            flatAlloc(fb, sizeof(UA_ReferenceTarget) * srefs->targetsSize);
+        UA_NodeReferenceKind *drefs = (dst) ? &refs[i] : NULL;
+        if(drefs) {
+            drefs->referenceTypeIndex = srefs->referenceTypeIndex;
+            drefs->isInverse = srefs->isInverse;
+            drefs->hasRefTree = false;
+            drefs->targets.array = targets;
+            drefs->targetsSize = srefs->targetsSize;
+        }
+
+        /* The targets are iterated in sorted order */
+        size_t j = 0;
+        for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(srefs);
+            t; t = UA_NodeReferenceKind_nextTarget(srefs, t), j++) {
+            UA_ReferenceTarget *dt = (drefs) ? &targets[j] : NULL;
+            flatCopy(fb, &t->targetId, dt ? &dt->targetId : NULL,
+                     &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+            if(!dt)
+                continue;
+            dt->targetIdHash = t->targetIdHash;
+            dt->targetNameHash = t->targetNameHash;
+        }
+
+        /* Add the name index for large arrays. It directly follows the
+         * targets, see flatNameIndex. */
+        if(srefs->targetsSize <= UA_REFERENCETARGETS_ARRAY_MAX)
+            continue;
+        UA_UInt64 *index = (UA_UInt64*)
+            flatAlloc(fb, sizeof(UA_UInt64) * srefs->targetsSize);
+        if(!drefs)
+            continue;
+        UA_assert((const UA_UInt64*)index == flatNameIndex(drefs));
+        for(j = 0; j < srefs->targetsSize; j++)
+            index[j] = ((UA_UInt64)targets[j].targetNameHash << 32) | (UA_UInt32)j;
+        qsort(index, srefs->targetsSize, sizeof(UA_UInt64), cmpFlatNameIndex);
+    }
+}
+
+size_t
+UA_Node_copyFlat(const UA_Node *src, UA_Node *dst) {
+    size_t nodesize = nodeSize(src->head.nodeClass);
+    if(nodesize == 0)
+        return 0;
+
+    FlatBuffer fb;
+    fb.pos = (UA_Byte*)dst;
+    fb.size = 0;
+    flatAlloc(&fb, nodesize);
+    if(dst)
+        memcpy(dst, src, nodesize);
+
+    /* Head */
+    const UA_NodeHead *shead = &src->head;
+    UA_NodeHead *dhead = (dst) ? &dst->head : NULL;
+    flatCopyNodeId(&fb, &shead->nodeId, dhead ? &dhead->nodeId : NULL);
+    flatCopy(&fb, &shead->browseName, dhead ? &dhead->browseName : NULL,
+             &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    flatCopy(&fb, &shead->displayName, dhead ? &dhead->displayName : NULL,
+             &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    flatCopy(&fb, &shead->description, dhead ? &dhead->description : NULL,
+             &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    flatCopyReferences(&fb, shead, dhead);
+
+    /* Content of the nodeclass */
+    switch(shead->nodeClass) {
+    case UA_NODECLASS_VARIABLE:
+    case UA_NODECLASS_VARIABLETYPE: {
+        const UA_VariableNode *s = &src->variableNode;
+        UA_VariableNode *d = (dst) ? &dst->variableNode : NULL;
+        flatCopyNodeId(&fb, &s->dataType, d ? &d->dataType : NULL);
+        void *dims = flatCopyArray(&fb, s->arrayDimensions, s->arrayDimensionsSize,
+                                   &UA_TYPES[UA_TYPES_UINT32]);
+        if(d)
+            d->arrayDimensions = (UA_UInt32*)dims;
+        if(s->valueSource == UA_VALUESOURCE_DATA)
+            flatCopy(&fb, &s->value.data.value, d ? &d->value.data.value : NULL,
+                     &UA_TYPES[UA_TYPES_DATAVALUE]);
+        if(s->valueBackend.backendType == UA_VALUEBACKENDTYPE_INTERNAL)
+            flatCopy(&fb, &s->valueBackend.backend.internal.value,
+                     d ? &d->valueBackend.backend.internal.value : NULL,
+                     &UA_TYPES[UA_TYPES_DATAVALUE]);
+        break;
+    }
+    case UA_NODECLASS_REFERENCETYPE:
+        flatCopy(&fb, &src->referenceTypeNode.inverseName,
+                 dst ? &dst->referenceTypeNode.inverseName : NULL,
+                 &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        break;
+    default:
+        break;
+    }
+
+    return fb.size;
+}
+
 /******************************/
 /* Copy Attributes into Nodes */
 /******************************/
@@ -522,37 +959,137 @@ UA_Node_setAttributes(UA_Node *node, const void *attributes, const UA_DataType *
 /* Manage References */
 /*********************/
 
+static void
+insertTreeElem(UA_NodeReferenceKind *refs, UA_ReferenceTargetTreeElem *elem) {
+    /* Insert to the id lookup binary search tree. Only the root is kept in refs
+     * to save space. */
+    struct aa_head _refIdTree = refIdTree;
+    _refIdTree.root = refs->targets.tree.idTreeRoot;
+    aa_insert(&_refIdTree, elem);
+    refs->targets.tree.idTreeRoot = _refIdTree.root;
+
+    /* Insert to the name lookup binary search tree */
+    struct aa_head _refNameTree = refNameTree;
+    _refNameTree.root = refs->targets.tree.nameTreeRoot;
+    aa_insert(&_refNameTree, elem);
+    refs->targets.tree.nameTreeRoot = _refNameTree.root;
+}
+
+/* Move the targets from the array into the trees. The content of the targets
+ * is moved over without a deep copy. The array is left untouched if the
+ * allocation fails. */
+static UA_StatusCode
+moveTargetsToTree(UA_NodeReferenceKind *refs) {
+    size_t size = refs->targetsSize;
+    UA_ReferenceTargetTreeElem **elems = (UA_ReferenceTargetTreeElem**)
+        UA_malloc(sizeof(UA_ReferenceTargetTreeElem*) * size);
+    if(!elems)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < size; i++) {
+        elems[i] = (UA_ReferenceTargetTreeElem*)
+            UA_malloc(sizeof(UA_ReferenceTargetTreeElem));
+        if(!elems[i]) {
+            for(size_t j = 0; j < i; j++)
+                UA_free(elems[j]);
+            UA_free(elems);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+
+    UA_ReferenceTarget *array = refs->targets.array;
+    refs->targets.tree.idTreeRoot = NULL;
+    refs->targets.tree.nameTreeRoot = NULL;
+    refs->hasRefTree = true;
+    for(size_t i = 0; i < size; i++) {
+        elems[i]->target = array[i];
+        insertTreeElem(refs, elems[i]);
+    }
+    UA_free(array);
+    UA_free(elems);
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 addReferenceTarget(UA_NodeReferenceKind *refs, const UA_ExpandedNodeId *target,
                    UA_UInt32 targetNameHash) {
-    UA_ReferenceTarget *entry = (UA_ReferenceTarget*)
-        UA_malloc(sizeof(UA_ReferenceTarget));
-    if(!entry)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    /* Inserting into a large array is expensive. Switch to the trees. */
+    if(!refs->hasRefTree && refs->targetsSize >= UA_REFERENCETARGETS_ARRAY_MAX) {
+        UA_StatusCode retval = moveTargetsToTree(refs);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
 
-    UA_StatusCode retval = UA_ExpandedNodeId_copy(target, &entry->targetId);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_free(entry);
+    UA_ReferenceTarget newTarget;
+    UA_StatusCode retval = UA_ExpandedNodeId_copy(target, &newTarget.targetId);
+    if(retval != UA_STATUSCODE_GOOD)
         return retval;
+    newTarget.targetIdHash = UA_ExpandedNodeId_hash(target);
+    newTarget.targetNameHash = targetNameHash;
+
+    if(refs->hasRefTree) {
+        UA_ReferenceTargetTreeElem *elem = (UA_ReferenceTargetTreeElem*)
+            UA_malloc(sizeof(UA_ReferenceTargetTreeElem));
+        if(!elem) {
+            UA_ExpandedNodeId_clear(&newTarget.targetId);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        elem->target = newTarget;
+        insertTreeElem(refs, elem);
+    } else {
+        /* Insert at the sorted position in the array */
+        UA_ReferenceTarget *array = (UA_ReferenceTarget*)
+            UA_realloc(refs->targets.array,
+                       sizeof(UA_ReferenceTarget) * (refs->targetsSize + 1));
+        if(!array) {
+            UA_ExpandedNodeId_clear(&newTarget.targetId);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        refs->targets.array = array;
+        size_t pos = findArrayPosition(refs, &newTarget);
+        memmove(&array[pos + 1], &array[pos],
+                sizeof(UA_ReferenceTarget) * (refs->targetsSize - pos));
+        array[pos] = newTarget;
     }
 
-    entry->targetIdHash = UA_ExpandedNodeId_hash(target);
-    entry->targetNameHash = targetNameHash;
-
-    /* Insert to the id lookup binary search tree. Only the root is kept in refs
-     * to save space. */
-    struct aa_head _refIdTree = refIdTree;
-    _refIdTree.root = refs->idTreeRoot;
-    aa_insert(&_refIdTree, entry);
-    refs->idTreeRoot = _refIdTree.root;
+    refs->targetsSize++;
+    return UA_STATUSCODE_GOOD;
+}
 
-    /* Insert to the name lookup binary search tree */
-    struct aa_head _refNameTree = refNameTree;
-    _refNameTree.root = refs->nameTreeRoot;
-    aa_insert(&_refNameTree, entry);
-    refs->nameTreeRoot = _refNameTree.root;
+/* Copy the targets of a ReferenceKind. The array representation is used unless
+ * there are too many targets. */
+static UA_StatusCode
+copyReferenceTargets(const UA_NodeReferenceKind *src, UA_NodeReferenceKind *dst) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(src->targetsSize > UA_REFERENCETARGETS_ARRAY_MAX) {
+        dst->hasRefTree = true;
+        dst->targets.tree.idTreeRoot = NULL;
+        dst->targets.tree.nameTreeRoot = NULL;
+        for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(src);
+            t; t = UA_NodeReferenceKind_nextTarget(src, t)) {
+            retval = addReferenceTarget(dst, &t->targetId, t->targetNameHash);
+            if(retval != UA_STATUSCODE_GOOD)
+                break;
+        }
+        return retval;
+    }
 
-    return UA_STATUSCODE_GOOD;
+    /* The targets are iterated in sorted order */
+    dst->hasRefTree = false;
+    dst->targets.array = (UA_ReferenceTarget*)
+        UA_malloc(sizeof(UA_ReferenceTarget) * src->targetsSize);
+    if(!dst->targets.array)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(src);
+        t; t = UA_NodeReferenceKind_nextTarget(src, t)) {
+        UA_ReferenceTarget *dt = &dst->targets.array[dst->targetsSize];
+        retval = UA_ExpandedNodeId_copy(&t->targetId, &dt->targetId);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+        dt->targetIdHash = t->targetIdHash;
+        dt->targetNameHash = t->targetNameHash;
+        dst->targetsSize++;
+    }
+    return retval;
 }
 
 static UA_StatusCode
@@ -567,8 +1104,9 @@ addReferenceKind(UA_NodeHead *head, UA_Byte refTypeIndex, UA_Boolean isForward,
     UA_NodeReferenceKind *newRef = &refs[head->referencesSize];
     newRef->referenceTypeIndex = refTypeIndex;
     newRef->isInverse = !isForward;
-    newRef->idTreeRoot = NULL;
-    newRef->nameTreeRoot = NULL;
+    newRef->hasRefTree = false;
+    newRef->targets.array = NULL;
+    newRef->targetsSize = 0;
     UA_StatusCode retval =
         addReferenceTarget(newRef, targetNodeId, targetBrowseNameHash);
     if(retval != UA_STATUSCODE_GOOD) {
@@ -615,12 +1153,71 @@ UA_Node_addReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
 
 }
 
+static void
+removeReferenceTarget(UA_NodeReferenceKind *refs, UA_ReferenceTarget *target) {
+    refs->targetsSize--;
+    if(refs->hasRefTree) {
+        UA_ReferenceTargetTreeElem *elem = TREEELEM(target);
+        struct aa_head _refIdTree = refIdTree;
+        _refIdTree.root = refs->targets.tree.idTreeRoot;
+        aa_remove(&_refIdTree, elem);
+        refs->targets.tree.idTreeRoot = _refIdTree.root;
+        struct aa_head _refNameTree = refNameTree;
+        _refNameTree.root = refs->targets.tree.nameTreeRoot;
+        aa_remove(&_refNameTree, elem);
+        refs->targets.tree.nameTreeRoot = _refNameTree.root;
+        UA_ExpandedNodeId_clear(&elem->target.targetId);
+        UA_free(elem);
+        return;
+    }
+
+    UA_ExpandedNodeId_clear(&target->targetId);
+    size_t pos = (size_t)(target - refs->targets.array);
+    memmove(&refs->targets.array[pos], &refs->targets.array[pos + 1],
+            sizeof(UA_ReferenceTarget) * (refs->targetsSize - pos));
+    if(refs->targetsSize == 0) {
+        UA_free(refs->targets.array);
+        refs->targets.array = NULL;
+        return;
+    }
+
+    /* Ignore errors in case the array could not be shrinked down */
+    UA_ReferenceTarget *array = (UA_ReferenceTarget*)
+        UA_realloc(refs->targets.array, sizeof(UA_ReferenceTarget) * refs->targetsSize);
+    if(array)
+        refs->targets.array = array;
+}
+
+static void
+clearReferenceTargets(UA_NodeReferenceKind *refs) {
+    if(!refs->hasRefTree) {
+        for(size_t i = 0; i < refs->targetsSize; i++)
+            UA_ExpandedNodeId_clear(&refs->targets.array[i].targetId);
+        UA_free(refs->targets.array);
+        refs->targets.array = NULL;
+        refs->targetsSize = 0;
+        return;
+    }
+
+    /* Remove all target entries. Don't remove entries from browseName tree.
+     * The entire ReferenceKind will be removed anyway. */
+    struct aa_head _refIdTree = refIdTree;
+    _refIdTree.root = refs->targets.tree.idTreeRoot;
+    while(_refIdTree.root) {
+        UA_ReferenceTargetTreeElem *elem = (UA_ReferenceTargetTreeElem*)
+            ((uintptr_t)_refIdTree.root - offsetof(UA_ReferenceTargetTreeElem, idTreeEntry));
+        aa_remove(&_refIdTree, elem);
+        UA_ExpandedNodeId_clear(&elem->target.targetId);
+        UA_free(elem);
+    }
+    refs->targets.tree.idTreeRoot = NULL;
+    refs->targets.tree.nameTreeRoot = NULL;
+    refs->targetsSize = 0;
+}
+
 UA_StatusCode
 UA_Node_deleteReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
                         const UA_ExpandedNodeId *targetNodeId) {
-    struct aa_head _refIdTree = refIdTree;
-    struct aa_head _refNameTree = refNameTree;
-
     UA_NodeHead *head = &node->head;
     for(size_t i = head->referencesSize; i > 0; --i) {
         UA_NodeReferenceKind *refs = &head->references[i-1];
@@ -629,24 +1226,14 @@ UA_Node_deleteReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForwar
         if(refTypeIndex != refs->referenceTypeIndex)
             continue;
 
-        _refIdTree.root = refs->idTreeRoot;
-        _refNameTree.root = refs->nameTreeRoot;
-
         UA_ReferenceTarget *target =
             UA_NodeReferenceKind_findTarget(refs, targetNodeId);
         if(!target)
             continue;
 
         /* Ok, delete the reference */
-        aa_remove(&_refIdTree, target);
-        aa_remove(&_refNameTree, target);
-        UA_ExpandedNodeId_clear(&target->targetId);
-        UA_free(target);
-
-        refs->idTreeRoot = _refIdTree.root;
-        refs->nameTreeRoot = _refNameTree.root;
-
-        if(refs->idTreeRoot)
+        removeReferenceTarget(refs, target);
+        if(refs->targetsSize > 0)
             return UA_STATUSCODE_GOOD; /* At least one target remains for the refkind */
 
         head->referencesSize--;
@@ -674,22 +1261,14 @@ UA_Node_deleteReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForwar
 void
 UA_Node_deleteReferencesSubset(UA_Node *node, const UA_ReferenceTypeSet *keepSet) {
     UA_NodeHead *head = &node->head;
-    struct aa_head _refIdTree = refIdTree;
     for(size_t i = head->referencesSize; i > 0; --i) {
         /* Keep the references of this type? */
         UA_NodeReferenceKind *refs = &head->references[i-1];
         if(UA_ReferenceTypeSet_contains(keepSet, refs->referenceTypeIndex))
             continue;
 
-        /* Remove all target entries. Don't remove entries from browseName tree.
-         * The entire ReferenceKind will be removed anyway. */
-        _refIdTree.root = refs->idTreeRoot;
-        UA_ReferenceTarget *target;
-        while((target = (UA_ReferenceTarget*)_refIdTree.root)) {
-            aa_remove(&_refIdTree, target);
-            UA_ExpandedNodeId_clear(&target->targetId);
-            UA_free(target);
-        }
+        /* Remove all target entries */
+        clearReferenceTargets(refs);
         head->referencesSize--;
 
         /* Move last references-kind entry to this position */
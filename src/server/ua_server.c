@@ -190,6 +190,7 @@ void UA_Server_delete(UA_Server *server) {
     UA_ConditionList_delete(server);
 #endif
 
+    UA_Notification_clearFreeList(server);
 #endif
 
 #ifdef UA_ENABLE_PUBSUB
@@ -207,6 +208,12 @@ void UA_Server_delete(UA_Server *server) {
     /* Clean up the Admin Session */
     UA_Session_clear(&server->adminSession, server);
 
+    clearSubtypeIndex(server);
+    clearBrowsePathCache(server);
+#ifdef UA_ENABLE_METHODCALLS
+    clearMethodCallCache(server);
+#endif
+
     UA_UNLOCK(&server->serviceMutex); /* The timer has its own mutex */
 
     /* Execute all remaining delayed events and clean up the timer */
@@ -250,7 +257,7 @@ UA_Boolean UA_Server_NodestoreIsConfigured(UA_Server *server) {
 }
 
 static UA_Server *
-UA_Server_init(UA_Server *server) {
+UA_Server_init(UA_Server *server, const UA_ByteString *snapshot) {
 
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_CHECK_FATAL(UA_Server_NodestoreIsConfigured(server), goto cleanup,
@@ -309,7 +316,7 @@ UA_Server_init(UA_Server *server) {
                                   10000.0, NULL);
 
     /* Initialize namespace 0*/
-    res = UA_Server_initNS0(server);
+    res = UA_Server_initNS0(server, snapshot);
     UA_CHECK_STATUS(res, goto cleanup);
 
 #ifdef UA_ENABLE_PUBSUB
@@ -331,8 +338,8 @@ UA_Server_init(UA_Server *server) {
     return NULL;
 }
 
-UA_Server *
-UA_Server_newWithConfig(UA_ServerConfig *config) {
+static UA_Server *
+newServer(UA_ServerConfig *config, const UA_ByteString *snapshot) {
     UA_CHECK_MEM(config, return NULL);
 
     UA_Server *server = (UA_Server *)UA_calloc(1, sizeof(UA_Server));
@@ -346,7 +353,19 @@ UA_Server_newWithConfig(UA_ServerConfig *config) {
 
     /* Reset the old config */
     memset(config, 0, sizeof(UA_ServerConfig));
-    return UA_Server_init(server);
+    return UA_Server_init(server, snapshot);
+}
+
+UA_Server *
+UA_Server_newWithConfig(UA_ServerConfig *config) {
+    return newServer(config, NULL);
+}
+
+UA_Server *
+UA_Server_newWithNodestoreSnapshot(UA_ServerConfig *config,
+                                   const UA_ByteString *snapshot) {
+    UA_CHECK_MEM(snapshot, UA_ServerConfig_clean(config); return NULL);
+    return newServer(config, snapshot);
 }
 
 /* Returns if the server should be shut down immediately */
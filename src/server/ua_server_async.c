@@ -10,10 +10,56 @@
 
 #if UA_MULTITHREADING >= 100
 
+/* The types of the operation request and response */
+static const UA_DataType *
+asyncOperationRequestType(UA_AsyncOperationType type) {
+    switch(type) {
+    case UA_ASYNCOPERATIONTYPE_READ: return &UA_TYPES[UA_TYPES_READVALUEID];
+    case UA_ASYNCOPERATIONTYPE_WRITE: return &UA_TYPES[UA_TYPES_WRITEVALUE];
+    default: return &UA_TYPES[UA_TYPES_CALLMETHODREQUEST];
+    }
+}
+
+static const UA_DataType *
+asyncOperationResponseType(UA_AsyncOperationType type) {
+    switch(type) {
+    case UA_ASYNCOPERATIONTYPE_READ: return &UA_TYPES[UA_TYPES_DATAVALUE];
+    case UA_ASYNCOPERATIONTYPE_WRITE: return &UA_TYPES[UA_TYPES_STATUSCODE];
+    default: return &UA_TYPES[UA_TYPES_CALLMETHODRESULT];
+    }
+}
+
+static const UA_DataType *
+asyncResponseType(UA_AsyncOperationType type) {
+    switch(type) {
+    case UA_ASYNCOPERATIONTYPE_READ: return &UA_TYPES[UA_TYPES_READRESPONSE];
+    case UA_ASYNCOPERATIONTYPE_WRITE: return &UA_TYPES[UA_TYPES_WRITERESPONSE];
+    default: return &UA_TYPES[UA_TYPES_CALLRESPONSE];
+    }
+}
+
 static void
-UA_AsyncOperation_delete(UA_AsyncOperation *ar) {
-    UA_CallMethodRequest_clear(&ar->request);
-    UA_CallMethodResult_clear(&ar->response);
+setAsyncOperationStatus(UA_AsyncOperation *ao, UA_StatusCode res) {
+    switch(ao->parent->operationType) {
+    case UA_ASYNCOPERATIONTYPE_READ:
+        UA_DataValue_clear(&ao->response.readResult);
+        ao->response.readResult.hasStatus = true;
+        ao->response.readResult.status = res;
+        break;
+    case UA_ASYNCOPERATIONTYPE_WRITE:
+        ao->response.writeResult = res;
+        break;
+    default:
+        ao->response.callMethodResult.statusCode = res;
+        break;
+    }
+}
+
+/* The parent may already be removed. So the type is passed explicitly. */
+static void
+UA_AsyncOperation_delete(UA_AsyncOperation *ar, UA_AsyncOperationType type) {
+    UA_clear(&ar->request, asyncOperationRequestType(type));
+    UA_clear(&ar->response, asyncOperationResponseType(type));
     UA_free(ar);
 }
 
@@ -43,12 +89,14 @@ UA_AsyncManager_sendAsyncResponse(UA_AsyncManager *am, UA_Server *server,
         goto clean_up;
     }
 
-    /* Okay, here we go, send the UA_CallResponse */
+    /* Okay, here we go, send the response. All response types start with the
+     * ResponseHeader. */
     responseHeader = (UA_ResponseHeader*)
         &ar->response.callResponse.responseHeader;
     responseHeader->requestHandle = ar->requestHandle;
     res = sendResponse(server, session, channel, ar->requestId,
-                       (UA_Response*)&ar->response, &UA_TYPES[UA_TYPES_CALLRESPONSE]);
+                       (UA_Response*)&ar->response,
+                       asyncResponseType(ar->operationType));
     UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
                  "UA_Server_SendResponse: Response for Req# %" PRIu32 " sent", ar->requestId);
 
@@ -73,9 +121,23 @@ integrateOperationResult(UA_AsyncManager *am, UA_Server *server,
                  "Return result in the server thread with %" PRIu32 " remaining",
                  ar->opCountdown);
 
-    /* Move the UA_CallMethodResult to UA_CallResponse */
-    ar->response.callResponse.results[ao->index] = ao->response;
-    UA_CallMethodResult_init(&ao->response);
+    /* Move the operation result into the response */
+    switch(ar->operationType) {
+    case UA_ASYNCOPERATIONTYPE_READ: {
+        UA_DataValue *dv = &ar->response.readResponse.results[ao->index];
+        *dv = ao->response.readResult;
+        UA_DataValue_init(&ao->response.readResult);
+        setReadTimestamps(dv, ar->timestampsToReturn, UA_ATTRIBUTEID_VALUE);
+        break;
+    }
+    case UA_ASYNCOPERATIONTYPE_WRITE:
+        ar->response.writeResponse.results[ao->index] = ao->response.writeResult;
+        break;
+    default:
+        ar->response.callResponse.results[ao->index] = ao->response.callMethodResult;
+        UA_CallMethodResult_init(&ao->response.callMethodResult);
+        break;
+    }
 
     /* Are we done with all operations? */
     if(ar->opCountdown == 0)
@@ -96,9 +158,10 @@ processAsyncResults(UA_Server *server, void *data) {
         if(!ao)
             break;
         UA_LOG_DEBUG(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "UA_Server_CallMethodResponse: Got Response: OKAY");
+                     "Integrate the result of an async operation");
+        UA_AsyncOperationType type = ao->parent->operationType;
         integrateOperationResult(am, server, ao);
-        UA_AsyncOperation_delete(ao);
+        UA_AsyncOperation_delete(ao, type);
         am->opsCount--;
     }
 }
@@ -123,7 +186,7 @@ checkTimeouts(UA_Server *server, void *_) {
             break;
 
         /* Mark as timed out and put it into the result queue */
-        op->response.statusCode = UA_STATUSCODE_BADTIMEOUT;
+        setAsyncOperationStatus(op, UA_STATUSCODE_BADTIMEOUT);
         TAILQ_REMOVE(&am->dispatchedQueue, op, pointers);
         TAILQ_INSERT_TAIL(&am->resultQueue, op, pointers);
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -137,7 +200,7 @@ checkTimeouts(UA_Server *server, void *_) {
             break;
 
         /* Mark as timed out and put it into the result queue */
-        op->response.statusCode = UA_STATUSCODE_BADTIMEOUT;
+        setAsyncOperationStatus(op, UA_STATUSCODE_BADTIMEOUT);
         TAILQ_REMOVE(&am->newQueue, op, pointers);
         TAILQ_INSERT_TAIL(&am->resultQueue, op, pointers);
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -174,16 +237,16 @@ UA_AsyncManager_clear(UA_AsyncManager *am, UA_Server *server) {
     /* Clean up queues */
     UA_LOCK(&am->queueLock);
     while((ar = TAILQ_FIRST(&am->newQueue))) {
-        TAILQ_REMOVE(&am->resultQueue, ar, pointers);
-        UA_AsyncOperation_delete(ar);
+        TAILQ_REMOVE(&am->newQueue, ar, pointers);
+        UA_AsyncOperation_delete(ar, ar->parent->operationType);
     }
     while((ar = TAILQ_FIRST(&am->dispatchedQueue))) {
-        TAILQ_REMOVE(&am->resultQueue, ar, pointers);
-        UA_AsyncOperation_delete(ar);
+        TAILQ_REMOVE(&am->dispatchedQueue, ar, pointers);
+        UA_AsyncOperation_delete(ar, ar->parent->operationType);
     }
     while((ar = TAILQ_FIRST(&am->resultQueue))) {
         TAILQ_REMOVE(&am->resultQueue, ar, pointers);
-        UA_AsyncOperation_delete(ar);
+        UA_AsyncOperation_delete(ar, ar->parent->operationType);
     }
     UA_UNLOCK(&am->queueLock);
 
@@ -214,6 +277,7 @@ UA_AsyncManager_createAsyncResponse(UA_AsyncManager *am, UA_Server *server,
     }
 
     am->asyncResponsesCount += 1;
+    newentry->operationType = operationType;
     newentry->requestId = requestId;
     newentry->requestHandle = requestHandle;
     newentry->timeout = UA_DateTime_now();
@@ -231,16 +295,16 @@ void
 UA_AsyncManager_removeAsyncResponse(UA_AsyncManager *am, UA_AsyncResponse *ar) {
     TAILQ_REMOVE(&am->asyncResponses, ar, pointers);
     am->asyncResponsesCount -= 1;
-    UA_CallResponse_clear(&ar->response.callResponse);
+    UA_clear(&ar->response, asyncResponseType(ar->operationType));
     UA_NodeId_clear(&ar->sessionId);
     UA_free(ar);
 }
 
-/* Enqueue next MethodRequest */
+/* Enqueue the next operation */
 UA_StatusCode
 UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
                               UA_AsyncResponse *ar, size_t opIndex,
-                              const UA_CallMethodRequest *opRequest) {
+                              const void *opRequest) {
     if(server->config.maxAsyncOperationQueueSize != 0 &&
        am->opsCount >= server->config.maxAsyncOperationQueueSize) {
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
@@ -256,15 +320,15 @@ UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
 
-    UA_StatusCode result = UA_CallMethodRequest_copy(opRequest, &ao->request);
+    UA_StatusCode result =
+        UA_copy(opRequest, &ao->request, asyncOperationRequestType(ar->operationType));
     if(result != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                     "UA_Server_SetAsyncMethodResult: UA_CallMethodRequest_copy failed.");                
+                     "UA_Server_SetAsyncMethodResult: Copying the request failed.");
         UA_free(ao);
         return result;
     }
 
-    UA_CallMethodResult_init(&ao->response);
     ao->index = opIndex;
     ao->parent = ar;
 
@@ -294,7 +358,7 @@ UA_Server_getAsyncOperationNonBlocking(UA_Server *server, UA_AsyncOperationType
     if(ao) {
         TAILQ_REMOVE(&am->newQueue, ao, pointers);
         TAILQ_INSERT_TAIL(&am->dispatchedQueue, ao, pointers);
-        *type = UA_ASYNCOPERATIONTYPE_CALL;
+        *type = ao->parent->operationType;
         *request = (UA_AsyncOperationRequest*)&ao->request;
         *context = (void*)ao;
         if(timeout)
@@ -353,11 +417,12 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
 
     /* Copy the result into the internal AsyncOperation */
     UA_StatusCode result =
-        UA_CallMethodResult_copy(&response->callMethodResult, &ao->response);
+        UA_copy(response, &ao->response,
+                asyncOperationResponseType(ao->parent->operationType));
     if(result != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
-                       "UA_Server_SetAsyncMethodResult: UA_CallMethodResult_copy failed.");
-        ao->response.statusCode = UA_STATUSCODE_BADOUTOFMEMORY;
+                       "UA_Server_SetAsyncMethodResult: Copying the result failed.");
+        setAsyncOperationStatus(ao, UA_STATUSCODE_BADOUTOFMEMORY);
     }
 
     /* Move to the result queue */
@@ -390,10 +455,27 @@ UA_Server_setMethodNodeAsync(UA_Server *server, const UA_NodeId id,
                               (UA_EditNodeCallback)setMethodNodeAsync, &isAsync);
 }
 
+static UA_StatusCode
+setVariableNodeAsync(UA_Server *server, UA_Session *session,
+                     UA_Node *node, UA_Boolean *isAsync) {
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE)
+        return UA_STATUSCODE_BADNODECLASSINVALID;
+    node->variableNode.async = *isAsync;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_setVariableNodeAsync(UA_Server *server, const UA_NodeId id,
+                               UA_Boolean isAsync) {
+    return UA_Server_editNode(server, &server->adminSession, &id,
+                              (UA_EditNodeCallback)setVariableNodeAsync, &isAsync);
+}
+
 UA_StatusCode
 UA_Server_processServiceOperationsAsync(UA_Server *server, UA_Session *session,
                                         UA_UInt32 requestId, UA_UInt32 requestHandle,
                                         UA_AsyncServiceOperation operationCallback,
+                                        const void *context,
                                         const size_t *requestOperations,
                                         const UA_DataType *requestOperationsType,
                                         size_t *responseOperations,
@@ -414,7 +496,7 @@ UA_Server_processServiceOperationsAsync(UA_Server *server, UA_Session *session,
     uintptr_t respOp = (uintptr_t)*respPos;
     uintptr_t reqOp = *(uintptr_t*)((uintptr_t)requestOperations + sizeof(size_t));
     for(size_t i = 0; i < ops; i++) {
-        operationCallback(server, session, requestId, requestHandle,
+        operationCallback(server, session, context, requestId, requestHandle,
                           i, (void*)reqOp, (void*)respOp, ar);
         reqOp += requestOperationsType->memSize;
         respOp += responseOperationsType->memSize;
@@ -29,8 +29,8 @@ typedef struct UA_AsyncResponse UA_AsyncResponse;
 /* A single operation (of a larger request) */
 typedef struct UA_AsyncOperation {
     TAILQ_ENTRY(UA_AsyncOperation) pointers;
-    UA_CallMethodRequest request;
-    UA_CallMethodResult	response;
+    UA_AsyncOperationRequest request;   /* Type according to the parent */
+    UA_AsyncOperationResponse response;
     size_t index;             /* Index of the operation in the array of ops in
                                * request/response */
     UA_AsyncResponse *parent; /* Always non-NULL. The parent is only removed
@@ -44,6 +44,7 @@ struct UA_AsyncResponse {
     UA_UInt32 requestHandle;
     UA_DateTime	timeout;
     UA_AsyncOperationType operationType;
+    UA_TimestampsToReturn timestampsToReturn; /* For Read operations */
     union {
         UA_CallResponse callResponse;
         UA_ReadResponse readResponse;
@@ -88,12 +89,15 @@ UA_AsyncManager_createAsyncResponse(UA_AsyncManager *am, UA_Server *server,
 void
 UA_AsyncManager_removeAsyncResponse(UA_AsyncManager *am, UA_AsyncResponse *ar);
 
+/* The opRequest is a CallMethodRequest, ReadValueId or WriteValue according
+ * to the operationType of the AsyncResponse. It is copied internally. */
 UA_StatusCode
 UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
                               UA_AsyncResponse *ar, size_t opIndex,
-                              const UA_CallMethodRequest *opRequest);
+                              const void *opRequest);
 
 typedef void (*UA_AsyncServiceOperation)(UA_Server *server, UA_Session *session,
+                                         const void *context,
                                          UA_UInt32 requestId, UA_UInt32 requestHandle,
                                          size_t opIndex, const void *requestOperation,
                                          void *responseOperation, UA_AsyncResponse **ar);
@@ -104,6 +108,7 @@ UA_StatusCode
 UA_Server_processServiceOperationsAsync(UA_Server *server, UA_Session *session,
                                         UA_UInt32 requestId, UA_UInt32 requestHandle,
                                         UA_AsyncServiceOperation operationCallback,
+                                        const void *context,
                                         const size_t *requestOperations,
                                         const UA_DataType *requestOperationsType,
                                         size_t *responseOperations,
@@ -404,10 +404,11 @@ processOPN(UA_Server *server, UA_SecureChannel *channel,
     return retval;
 }
 
-/* The responseHeader must have the requestHandle already set */
-UA_StatusCode
-sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
-             UA_UInt32 requestId, UA_Response *response, const UA_DataType *responseType) {
+/* Start the message context and encode the type identifier of the response */
+static UA_StatusCode
+beginResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
+              UA_UInt32 requestId, UA_Response *response,
+              const UA_DataType *responseType, UA_MessageContext *mc) {
     if(!channel)
         return UA_STATUSCODE_BADINTERNALERROR;
 
@@ -437,18 +438,26 @@ sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
     }
 
     /* Start the message context */
-    UA_MessageContext mc;
-    UA_StatusCode retval = UA_MessageContext_begin(&mc, channel, requestId, UA_MESSAGETYPE_MSG);
+    UA_StatusCode retval = UA_MessageContext_begin(mc, channel, requestId, UA_MESSAGETYPE_MSG);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
 
     /* Assert's required for clang-analyzer */
-    UA_assert(mc.buf_pos == &mc.messageBuffer.data[UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH]);
-    UA_assert(mc.buf_end <= &mc.messageBuffer.data[mc.messageBuffer.length]);
+    UA_assert(mc->buf_pos == &mc->messageBuffer.data[UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH]);
+    UA_assert(mc->buf_end <= &mc->messageBuffer.data[mc->messageBuffer.length]);
 
     /* Encode the response type */
-    retval = UA_MessageContext_encode(&mc, &responseType->binaryEncodingId,
-                                      &UA_TYPES[UA_TYPES_NODEID]);
+    return UA_MessageContext_encode(mc, &responseType->binaryEncodingId,
+                                    &UA_TYPES[UA_TYPES_NODEID]);
+}
+
+/* The responseHeader must have the requestHandle already set */
+UA_StatusCode
+sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
+             UA_UInt32 requestId, UA_Response *response, const UA_DataType *responseType) {
+    UA_MessageContext mc;
+    UA_StatusCode retval = beginResponse(server, session, channel, requestId,
+                                         response, responseType, &mc);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
 
@@ -461,6 +470,70 @@ sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
     return UA_MessageContext_finish(&mc);
 }
 
+static UA_StatusCode
+encodeArrayMessageContext(UA_MessageContext *mc, const void *array, size_t length,
+                          const UA_DataType *type) {
+    /* Encode the array length. Same as in the binary encoding of arrays. */
+    UA_Int32 signedLength = -1;
+    if(length > 0)
+        signedLength = (UA_Int32)length;
+    else if(array == UA_EMPTY_ARRAY_SENTINEL)
+        signedLength = 0;
+    UA_StatusCode retval =
+        UA_MessageContext_encode(mc, &signedLength, &UA_TYPES[UA_TYPES_INT32]);
+
+    /* Encode the elements */
+    uintptr_t ptr = (uintptr_t)array;
+    for(size_t i = 0; i < length && retval == UA_STATUSCODE_GOOD; i++) {
+        retval = UA_MessageContext_encode(mc, (const void*)ptr, type);
+        ptr += type->memSize;
+    }
+    return retval;
+}
+
+UA_StatusCode
+sendResponseEncodedMember(UA_Server *server, UA_Session *session,
+                          UA_SecureChannel *channel, UA_UInt32 requestId,
+                          UA_Response *response, const UA_DataType *responseType,
+                          size_t encodedMember, const UA_ByteString *encoded) {
+    UA_MessageContext mc;
+    UA_StatusCode retval = beginResponse(server, session, channel, requestId,
+                                         response, responseType, &mc);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Encode the members one by one. The context is cleaned up internally if
+     * the encoding fails. */
+    uintptr_t ptr = (uintptr_t)response;
+    for(size_t i = 0; i < responseType->membersSize; i++) {
+        const UA_DataTypeMember *m = &responseType->members[i];
+        UA_assert(m->namespaceZero); /* All response types are from ns0 */
+        const UA_DataType *mt = &UA_TYPES[m->memberTypeIndex];
+        ptr += m->padding;
+        if(!m->isArray) {
+            if(i == encodedMember)
+                retval = UA_MessageContext_encodeRaw(&mc, encoded);
+            else
+                retval = UA_MessageContext_encode(&mc, (const void*)ptr, mt);
+            ptr += mt->memSize;
+        } else {
+            size_t length = *(size_t*)ptr;
+            ptr += sizeof(size_t);
+            const void *array = *(void * const *)ptr;
+            ptr += sizeof(void*);
+            if(i == encodedMember)
+                retval = UA_MessageContext_encodeRaw(&mc, encoded);
+            else
+                retval = encodeArrayMessageContext(&mc, array, length, mt);
+        }
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+
+    /* Finish / send out */
+    return UA_MessageContext_finish(&mc);
+}
+
 /* A Session is "bound" to a SecureChannel if it was created by the
  * SecureChannel or if it was activated on it. A Session can only be bound to
  * one SecureChannel. A Session can only be closed from the SecureChannel to
@@ -495,7 +568,7 @@ static const UA_String securityPolicyNone =
 
 static UA_StatusCode
 processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
-                  UA_Service service, const UA_Request *request,
+                  UA_Service service, UA_Request *request,
                   const UA_DataType *requestType, UA_Response *response,
                   const UA_DataType *responseType, UA_Boolean sessionRequired) {
     const UA_RequestHeader *requestHeader = &request->requestHeader;
@@ -593,6 +666,20 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
     /* Update the session lifetime */
     UA_Session_updateLifetime(session);
 
+    /* Replace the handles of registered nodes with the original NodeIds. Read
+     * and Write look up the handles themselves to use the pinned nodes. */
+    if(requestType != &UA_TYPES[UA_TYPES_READREQUEST] &&
+       requestType != &UA_TYPES[UA_TYPES_WRITEREQUEST] &&
+       requestType != &UA_TYPES[UA_TYPES_REGISTERNODESREQUEST] &&
+       requestType != &UA_TYPES[UA_TYPES_UNREGISTERNODESREQUEST]) {
+        UA_LOCK(&server->serviceMutex);
+        retval = UA_Session_resolveRegisteredNodes(session, request, requestType);
+        UA_UNLOCK(&server->serviceMutex);
+        if(retval != UA_STATUSCODE_GOOD)
+            return sendServiceFault(channel, requestId, requestHeader->requestHandle,
+                                    responseType, retval);
+    }
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* The publish request is not answered immediately */
     if(requestType == &UA_TYPES[UA_TYPES_PUBLISHREQUEST]) {
@@ -601,6 +688,37 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
         UA_UNLOCK(&server->serviceMutex);
         return UA_STATUSCODE_GOOD;
     }
+
+    /* The Republish response contains the encoded NotificationMessage from the
+     * retransmission queue */
+    if(requestType == &UA_TYPES[UA_TYPES_REPUBLISHREQUEST]) {
+        UA_LOCK(&server->serviceMutex);
+        retval = Service_RepublishEncoded(server, session,
+                                          &request->republishRequest, requestId);
+        UA_UNLOCK(&server->serviceMutex);
+        return retval;
+    }
+#endif
+
+    /* The values in the ReadResponse point into the nodes. The nodes are
+     * released once the response was sent. With multithreading, another thread
+     * could edit the nodes in-situ while the response is encoded. And the
+     * ReadRequest goes through the async operations below. */
+#if UA_MULTITHREADING < 100
+    if(requestType == &UA_TYPES[UA_TYPES_READREQUEST] &&
+       server->config.readValuesNoCopy) {
+        const UA_Node **pinnedNodes;
+        size_t pinnedNodesSize;
+        UA_LOCK(&server->serviceMutex);
+        Service_ReadNoCopy(server, session, &request->readRequest,
+                           &response->readResponse, &pinnedNodes, &pinnedNodesSize);
+        UA_UNLOCK(&server->serviceMutex);
+        retval = sendResponse(server, session, channel, requestId, response, responseType);
+        UA_LOCK(&server->serviceMutex);
+        releasePinnedNodes(server, pinnedNodes, pinnedNodesSize);
+        UA_UNLOCK(&server->serviceMutex);
+        return retval;
+    }
 #endif
 
 #if UA_MULTITHREADING >= 100
@@ -619,6 +737,23 @@ processMSGDecoded(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 reques
         /* We are done here */
         return sendResponse(server, session, channel, requestId, response, responseType);
     }
+
+    /* Values of async DataSource variables are read and written by the workers */
+    if(requestType == &UA_TYPES[UA_TYPES_READREQUEST] ||
+       requestType == &UA_TYPES[UA_TYPES_WRITEREQUEST]) {
+        UA_Boolean finished = true;
+        UA_LOCK(&server->serviceMutex);
+        if(requestType == &UA_TYPES[UA_TYPES_READREQUEST])
+            Service_ReadAsync(server, session, requestId, &request->readRequest,
+                              &response->readResponse, &finished);
+        else
+            Service_WriteAsync(server, session, requestId, &request->writeRequest,
+                               &response->writeResponse, &finished);
+        UA_UNLOCK(&server->serviceMutex);
+        if(!finished)
+            return UA_STATUSCODE_GOOD;
+        return sendResponse(server, session, channel, requestId, response, responseType);
+    }
 #endif
 
     /* Dispatch the synchronous service call and send the response */
@@ -77,6 +77,17 @@ typedef struct session_list_entry {
     UA_Session session;
 } session_list_entry;
 
+/* Entry of the memoized HasSubtype closure. See isNodeInTree. */
+typedef struct UA_SubtypeEntry UA_SubtypeEntry;
+
+/* Cached result of TranslateBrowsePathsToNodeIds */
+typedef struct UA_BrowsePathCacheEntry UA_BrowsePathCacheEntry;
+
+#ifdef UA_ENABLE_METHODCALLS
+/* Cached argument definitions and object membership of a method */
+typedef struct UA_MethodCallCacheEntry UA_MethodCallCacheEntry;
+#endif
+
 typedef enum {
     UA_SERVERLIFECYCLE_FRESH,
     UA_SERVERLIFECYLE_RUNNING
@@ -106,6 +117,7 @@ struct UA_Server {
     UA_Session adminSession; /* Local access to the services (for startup and
                               * maintenance) uses this Session with all possible
                               * access rights (Session Id: 1) */
+    size_t registeredNodesSize; /* Registered nodes of all Sessions */
 
     /* Namespaces */
     size_t namespacesSize;
@@ -118,6 +130,31 @@ struct UA_Server {
      * the parent and member instantiation */
     UA_Boolean bootstrapNS0;
 
+    /* Transitive closure of the HasSubtype hierarchy for the type nodes. The
+     * entries are computed on demand and are kept in a hash-map (the number
+     * of buckets is a power of two). */
+    UA_SubtypeEntry **subtypeIndex;
+    size_t subtypeIndexSize;
+    size_t subtypeIndexCount;
+
+    /* Cache for TranslateBrowsePathsToNodeIds. Entries with an outdated
+     * generation are ignored. The generation is increased for every change of
+     * the references. */
+    UA_BrowsePathCacheEntry **browsePathCache;
+    size_t browsePathCacheSize;
+    size_t browsePathCacheCount;
+    UA_UInt32 browsePathCacheGeneration;
+
+#ifdef UA_ENABLE_METHODCALLS
+    /* Cache of the information a method call resolves from the address space,
+     * keyed by (ObjectId, MethodId). The generation is increased for every
+     * change of the references and for writes of Argument values. */
+    UA_MethodCallCacheEntry **methodCallCache;
+    size_t methodCallCacheSize;
+    size_t methodCallCacheCount;
+    UA_UInt32 methodCallCacheGeneration;
+#endif
+
     /* Discovery */
 #ifdef UA_ENABLE_DISCOVERY
     UA_DiscoveryManager discoveryManager;
@@ -136,8 +173,27 @@ struct UA_Server {
     LIST_HEAD(, UA_MonitoredItem) localMonitoredItems;
     UA_UInt32 lastLocalMonitoredItemId;
 
+    /* Freelist of deleted Notifications. Linked via their listEntry. */
+    UA_Notification *notificationFreeList;
+    size_t notificationFreeListSize;
+
 # ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(, UA_ConditionSource) headConditionSource;
+
+    /* Hash indexes of the condition list. The ConditionSources are indexed by
+     * their NodeId. The branches are indexed by their NodeId (ConditionId for
+     * the main branch) and by their lastEventId. The branch index holds both
+     * bucket arrays in one allocation, the EventId buckets come second. */
+    UA_ConditionSource **conditionSourcesIndex;
+    size_t conditionSourcesIndexSize;
+    size_t conditionSourcesSize;
+    UA_ConditionBranch **conditionBranchesIndex;
+    size_t conditionBranchesIndexSize;
+    size_t conditionBranchesSize;
+
+    /* The cached field NodeIds of a branch are dropped when its generation
+     * differs from the server's */
+    UA_UInt32 conditionFieldCacheGeneration;
 # endif
 
 #endif
@@ -160,8 +216,6 @@ struct UA_Server {
 /* References Handling */
 /***********************/
 
-extern const struct aa_head refNameTree;
-
 UA_ReferenceTarget *
 UA_NodeReferenceKind_firstTarget(const UA_NodeReferenceKind *kind);
 
@@ -173,6 +227,14 @@ UA_ReferenceTarget *
 UA_NodeReferenceKind_findTarget(const UA_NodeReferenceKind *kind,
                                 const UA_ExpandedNodeId *targetId);
 
+/* Iterate over the targets with the given BrowseName hash. Start with current
+ * == NULL. The exact BrowseName has to be checked by the caller as there can be
+ * hash collisions. */
+UA_ReferenceTarget *
+UA_NodeReferenceKind_nextTargetByName(const UA_NodeReferenceKind *kind,
+                                      UA_UInt32 targetNameHash,
+                                      const UA_ReferenceTarget *current);
+
 /**************************/
 /* SecureChannel Handling */
 /**************************/
@@ -275,6 +337,31 @@ UA_Boolean
 isNodeInTree_singleRef(UA_Server *server, const UA_NodeId *leafNode,
                        const UA_NodeId *nodeToFind, const UA_Byte relevantRefTypeIndex);
 
+/* Drop the HasSubtype closure if the node is indexed. Called when a HasSubtype
+ * reference of the subtype node is added or removed. */
+void
+invalidateSubtypeIndex(UA_Server *server, const UA_NodeId *subtype);
+
+void
+clearSubtypeIndex(UA_Server *server);
+
+/* Called when references are added or removed */
+void
+invalidateBrowsePathCache(UA_Server *server);
+
+void
+clearBrowsePathCache(UA_Server *server);
+
+#ifdef UA_ENABLE_METHODCALLS
+/* Called when references are added or removed, nodes are deleted or a value
+ * with Arguments is written */
+void
+invalidateMethodCallCache(UA_Server *server);
+
+void
+clearMethodCallCache(UA_Server *server);
+#endif
+
 /* Returns an array with the hierarchy of nodes. The start nodes can be returned
  * as well. The returned array starts at the leaf and continues "upwards" or
  * "downwards". Duplicate entries are removed. */
@@ -309,6 +396,10 @@ UA_getConditionId(UA_Server *server, const UA_NodeId *conditionNodeId,
 void
 UA_ConditionList_delete(UA_Server *server);
 
+/* Called when nodes are deleted or references are removed */
+void
+invalidateConditionFieldCache(UA_Server *server);
+
 UA_Boolean
 isConditionOrBranch(UA_Server *server,
                     const UA_NodeId *condition,
@@ -326,6 +417,14 @@ UA_StatusCode
 sendResponse(UA_Server *server, UA_Session *session, UA_SecureChannel *channel,
              UA_UInt32 requestId, UA_Response *response, const UA_DataType *responseType);
 
+/* Send a response where the member at index encodedMember is already binary
+ * encoded. The content of that member in the response structure is ignored. */
+UA_StatusCode
+sendResponseEncodedMember(UA_Server *server, UA_Session *session,
+                          UA_SecureChannel *channel, UA_UInt32 requestId,
+                          UA_Response *response, const UA_DataType *responseType,
+                          size_t encodedMember, const UA_ByteString *encoded);
+
 /* Many services come as an array of operations. This function generalizes the
  * processing of the operations. */
 typedef void (*UA_ServiceOperation)(UA_Server *server, UA_Session *session,
@@ -499,6 +598,12 @@ UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
                    const UA_VariableNode *vn, UA_DataValue *v);
 
+/* Add or remove the server and source timestamps of a read result according
+ * to the TimestampsToReturn of the request */
+void
+setReadTimestamps(UA_DataValue *v, UA_TimestampsToReturn timestampsToReturn,
+                  UA_UInt32 attributeId);
+
 /* Test whether the value matches a variable definition given by
  * - datatype
  * - valueranke
@@ -578,7 +683,14 @@ AddNode_finish(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId);
 /* Create Namespace 0 */
 /**********************/
 
-UA_StatusCode UA_Server_initNS0(UA_Server *server);
+/* If a snapshot is given, the nodes are loaded from it instead of being
+ * created from the generated ns0 definition */
+UA_StatusCode UA_Server_initNS0(UA_Server *server, const UA_ByteString *snapshot);
+
+/* Inserts the namespaces and nodes of a snapshot created with
+ * UA_Server_encodeNodestoreSnapshot */
+UA_StatusCode
+loadNodestoreSnapshot(UA_Server *server, const UA_ByteString *snapshot);
 
 UA_StatusCode writeNs0VariableArray(UA_Server *server, UA_UInt32 id, void *v,
                       size_t length, const UA_DataType *type);
@@ -614,8 +726,12 @@ UA_NODESTORE_GETFROMREF(UA_Server *server, const UA_ReferenceTarget *target);
 #define UA_NODESTORE_REPLACE(server, node)                              \
     server->config.nodestore.replaceNode(server->config.nodestore.context, node)
 
+/* Handles of registered nodes for the NodeId are marked as removed */
 #define UA_NODESTORE_REMOVE(server, nodeId)                             \
-    server->config.nodestore.removeNode(server->config.nodestore.context, nodeId)
+    UA_Server_removeNodeFromNodestore(server, nodeId)
+
+UA_StatusCode
+UA_Server_removeNodeFromNodestore(UA_Server *server, const UA_NodeId *nodeId);
 
 #define UA_NODESTORE_GETREFERENCETYPEID(server, index)                  \
     server->config.nodestore.getReferenceTypeId(server->config.nodestore.context, \
@@ -782,23 +782,31 @@ addModellingRules(UA_Server *server) {
 
 #endif
 
-/* Initialize the nodeset 0 by using the generated code of the nodeset compiler.
- * This also initialized the data sources for various variables, such as for
- * example server time. */
+/* Initialize the nodeset 0 by using the generated code of the nodeset compiler
+ * or from a nodestore snapshot. This also initialized the data sources for
+ * various variables, such as for example server time. */
 UA_StatusCode
-UA_Server_initNS0(UA_Server *server) {
-    /* Initialize base nodes which are always required an cannot be created
-     * through the NS compiler */
+UA_Server_initNS0(UA_Server *server, const UA_ByteString *snapshot) {
     server->bootstrapNS0 = true;
-    UA_StatusCode retVal = UA_Server_createNS0_base(server);
+    UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+    if(snapshot) {
+        /* Insert the nodes of the snapshot without the AddNodes checks */
+        UA_LOCK(&server->serviceMutex);
+        retVal = loadNodestoreSnapshot(server, snapshot);
+        UA_UNLOCK(&server->serviceMutex);
+    } else {
+        /* Initialize base nodes which are always required an cannot be
+         * created through the NS compiler */
+        retVal = UA_Server_createNS0_base(server);
 
 #ifdef UA_GENERATED_NAMESPACE_ZERO
-    /* Load nodes and references generated from the XML ns0 definition */
-    retVal |= namespace0_generated(server);
+        /* Load nodes and references generated from the XML ns0 definition */
+        retVal |= namespace0_generated(server);
 #else
-    /* Create a minimal server object */
-    retVal |= UA_Server_minimalServerObject(server);
+        /* Create a minimal server object */
+        retVal |= UA_Server_minimalServerObject(server);
 #endif
+    }
 
     server->bootstrapNS0 = false;
 
@@ -1103,6 +1111,17 @@ UA_Server_initNS0(UA_Server *server) {
 
 #endif /* UA_GENERATED_NAMESPACE_ZERO */
 
+    /* Optional nodes were possibly removed before the snapshot was taken.
+     * Then the nodes cannot be written or have a DataSource attached. The
+     * results are OR'ed. So any other error changes the aggregated code and is
+     * not tolerated. */
+    if(snapshot && retVal == UA_STATUSCODE_BADNODEIDUNKNOWN) {
+        UA_LOG_WARNING(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                       "Not all nodes of Namespace 0 are contained in the "
+                       "nodestore snapshot");
+        return UA_STATUSCODE_GOOD;
+    }
+
     if(retVal != UA_STATUSCODE_GOOD) {
         UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
                      "Initialization of Namespace 0 (after bootstrapping) "
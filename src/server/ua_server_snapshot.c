@@ -0,0 +1,535 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_server_internal.h"
+#include "ua_types_encoding_binary.h"
+
+/**
+ * Nodestore Snapshot
+ * ------------------
+ * The snapshot is a flat image of the information model in the binary
+ * encoding. It starts with a header (magic, version, the namespace array from
+ * index 2). Then follow the ReferenceType nodes in the order of their
+ * ReferenceTypeIndex and all remaining nodes in the order of the nodestore.
+ * The list of nodes is terminated by an unspecified NodeClass.
+ *
+ * For every node, the head (NodeId, BrowseName, DisplayName, Description,
+ * WriteMask, constructed flag), the references (grouped by the reference kind)
+ * and the attributes of the NodeClass are encoded. Callbacks, node contexts,
+ * DataSources and value backends are not part of the snapshot. */
+
+#define UA_SNAPSHOT_MAGIC 0x50414E53 /* "SNAP" */
+#define UA_SNAPSHOT_VERSION 1
+
+/************/
+/* Encoding */
+/************/
+
+typedef struct {
+    UA_ByteString buf;
+    size_t pos;
+    UA_StatusCode res;
+} SnapshotEncoder;
+
+/* Errors are sticky. All following calls become a no-op. */
+static void
+encodeField(SnapshotEncoder *enc, const void *p, const UA_DataType *type) {
+    if(enc->res != UA_STATUSCODE_GOOD)
+        return;
+
+    /* Grow the buffer */
+    size_t size = UA_calcSizeBinary(p, type);
+    if(enc->pos + size > enc->buf.length) {
+        size_t newLength = enc->buf.length * 2;
+        if(newLength < enc->pos + size)
+            newLength = enc->pos + size;
+        UA_Byte *newData = (UA_Byte*)UA_realloc(enc->buf.data, newLength);
+        if(!newData) {
+            enc->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        enc->buf.data = newData;
+        enc->buf.length = newLength;
+    }
+
+    UA_Byte *bufPos = &enc->buf.data[enc->pos];
+    const UA_Byte *bufEnd = &enc->buf.data[enc->buf.length];
+    enc->res = UA_encodeBinary(p, type, &bufPos, &bufEnd, NULL, NULL);
+    enc->pos = (uintptr_t)bufPos - (uintptr_t)enc->buf.data;
+}
+
+static void
+encodeUInt32(SnapshotEncoder *enc, UA_UInt32 v) {
+    encodeField(enc, &v, &UA_TYPES[UA_TYPES_UINT32]);
+}
+
+static void
+encodeBoolean(SnapshotEncoder *enc, UA_Boolean v) {
+    encodeField(enc, &v, &UA_TYPES[UA_TYPES_BOOLEAN]);
+}
+
+static void
+encodeByte(SnapshotEncoder *enc, UA_Byte v) {
+    encodeField(enc, &v, &UA_TYPES[UA_TYPES_BYTE]);
+}
+
+static void
+encodeReferences(SnapshotEncoder *enc, const UA_NodeHead *head) {
+    encodeUInt32(enc, (UA_UInt32)head->referencesSize);
+    for(size_t i = 0; i < head->referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &head->references[i];
+        encodeByte(enc, rk->referenceTypeIndex);
+        encodeBoolean(enc, rk->isInverse);
+
+        encodeUInt32(enc, (UA_UInt32)rk->targetsSize);
+
+        for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(rk);
+            t; t = UA_NodeReferenceKind_nextTarget(rk, t)) {
+            encodeField(enc, &t->targetId, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+            encodeUInt32(enc, t->targetNameHash);
+        }
+    }
+}
+
+/* The attributes shared by VariableNodes and VariableTypeNodes. Only values
+ * stored inline in the node are encoded. */
+static void
+encodeVariableAttributes(SnapshotEncoder *enc, const UA_NodeId *dataType,
+                         UA_Int32 valueRank, size_t arrayDimensionsSize,
+                         const UA_UInt32 *arrayDimensions,
+                         const UA_ValueBackend *valueBackend,
+                         UA_ValueSource valueSource, const UA_DataValue *value) {
+    encodeField(enc, dataType, &UA_TYPES[UA_TYPES_NODEID]);
+    encodeField(enc, &valueRank, &UA_TYPES[UA_TYPES_INT32]);
+    encodeUInt32(enc, (UA_UInt32)arrayDimensionsSize);
+    for(size_t i = 0; i < arrayDimensionsSize; i++)
+        encodeUInt32(enc, arrayDimensions[i]);
+
+    UA_Boolean hasValue = (valueBackend->backendType == UA_VALUEBACKENDTYPE_NONE &&
+                           valueSource == UA_VALUESOURCE_DATA);
+    encodeBoolean(enc, hasValue);
+    if(hasValue)
+        encodeField(enc, value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+static void
+encodeNode(SnapshotEncoder *enc, const UA_Node *node) {
+    const UA_NodeHead *head = &node->head;
+    encodeField(enc, &head->nodeClass, &UA_TYPES[UA_TYPES_NODECLASS]);
+    encodeField(enc, &head->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    encodeField(enc, &head->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    encodeField(enc, &head->displayName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    encodeField(enc, &head->description, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    encodeUInt32(enc, head->writeMask);
+    encodeBoolean(enc, head->constructed);
+    encodeReferences(enc, head);
+
+    switch(head->nodeClass) {
+    case UA_NODECLASS_VARIABLE: {
+        const UA_VariableNode *vn = &node->variableNode;
+        encodeVariableAttributes(enc, &vn->dataType, vn->valueRank,
+                                 vn->arrayDimensionsSize, vn->arrayDimensions,
+                                 &vn->valueBackend, vn->valueSource,
+                                 &vn->value.data.value);
+        encodeByte(enc, vn->accessLevel);
+        encodeField(enc, &vn->minimumSamplingInterval, &UA_TYPES[UA_TYPES_DOUBLE]);
+        encodeBoolean(enc, vn->historizing);
+        encodeBoolean(enc, vn->isDynamic);
+        break;
+    }
+    case UA_NODECLASS_VARIABLETYPE: {
+        const UA_VariableTypeNode *vtn = &node->variableTypeNode;
+        encodeVariableAttributes(enc, &vtn->dataType, vtn->valueRank,
+                                 vtn->arrayDimensionsSize, vtn->arrayDimensions,
+                                 &vtn->valueBackend, vtn->valueSource,
+                                 &vtn->value.data.value);
+        encodeBoolean(enc, vtn->isAbstract);
+        break;
+    }
+    case UA_NODECLASS_METHOD:
+        encodeBoolean(enc, node->methodNode.executable);
+        break;
+    case UA_NODECLASS_OBJECT:
+        encodeByte(enc, node->objectNode.eventNotifier);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        encodeBoolean(enc, node->objectTypeNode.isAbstract);
+        break;
+    case UA_NODECLASS_REFERENCETYPE: {
+        const UA_ReferenceTypeNode *rtn = &node->referenceTypeNode;
+        encodeBoolean(enc, rtn->isAbstract);
+        encodeBoolean(enc, rtn->symmetric);
+        encodeField(enc, &rtn->inverseName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        encodeByte(enc, rtn->referenceTypeIndex);
+        for(size_t i = 0; i < UA_REFERENCETYPESET_MAX / 32; i++)
+            encodeUInt32(enc, rtn->subTypes.bits[i]);
+        break;
+    }
+    case UA_NODECLASS_DATATYPE:
+        encodeBoolean(enc, node->dataTypeNode.isAbstract);
+        break;
+    case UA_NODECLASS_VIEW:
+        encodeByte(enc, node->viewNode.eventNotifier);
+        encodeBoolean(enc, node->viewNode.containsNoLoops);
+        break;
+    default:
+        enc->res = UA_STATUSCODE_BADINTERNALERROR;
+        break;
+    }
+}
+
+typedef struct {
+    SnapshotEncoder *enc;
+    UA_NodeId refTypes[UA_REFERENCETYPESET_MAX];
+    size_t refTypesSize;
+} SnapshotVisitorContext;
+
+static void
+collectReferenceTypes(void *visitorCtx, const UA_Node *node) {
+    SnapshotVisitorContext *ctx = (SnapshotVisitorContext*)visitorCtx;
+    if(node->head.nodeClass != UA_NODECLASS_REFERENCETYPE)
+        return;
+    UA_Byte index = node->referenceTypeNode.referenceTypeIndex;
+    ctx->refTypes[index] = node->head.nodeId; /* Shallow copy */
+    if(index >= ctx->refTypesSize)
+        ctx->refTypesSize = (size_t)index + 1;
+}
+
+static void
+encodeNonReferenceTypes(void *visitorCtx, const UA_Node *node) {
+    SnapshotVisitorContext *ctx = (SnapshotVisitorContext*)visitorCtx;
+    if(node->head.nodeClass != UA_NODECLASS_REFERENCETYPE)
+        encodeNode(ctx->enc, node);
+}
+
+static UA_StatusCode
+encodeNodestoreSnapshot(UA_Server *server, UA_ByteString *snapshot) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    SnapshotEncoder enc;
+    memset(&enc, 0, sizeof(SnapshotEncoder));
+    SnapshotVisitorContext ctx;
+    memset(&ctx, 0, sizeof(SnapshotVisitorContext));
+    ctx.enc = &enc;
+
+    /* Header */
+    encodeUInt32(&enc, UA_SNAPSHOT_MAGIC);
+    encodeUInt32(&enc, UA_SNAPSHOT_VERSION);
+    encodeUInt32(&enc, (UA_UInt32)(server->namespacesSize - 2));
+    for(size_t i = 2; i < server->namespacesSize; i++)
+        encodeField(&enc, &server->namespaces[i], &UA_TYPES[UA_TYPES_STRING]);
+
+    /* ReferenceTypes first. The ReferenceTypeIndex is assigned by the
+     * nodestore in the order of insertion. */
+    server->config.nodestore.iterate(server->config.nodestore.context,
+                                     collectReferenceTypes, &ctx);
+    for(size_t i = 0; i < ctx.refTypesSize; i++) {
+        const UA_Node *node = UA_NODESTORE_GET(server, &ctx.refTypes[i]);
+        if(!node) {
+            enc.res = UA_STATUSCODE_BADINTERNALERROR;
+            break;
+        }
+        encodeNode(&enc, node);
+        UA_NODESTORE_RELEASE(server, node);
+    }
+
+    /* All other nodes */
+    if(enc.res == UA_STATUSCODE_GOOD)
+        server->config.nodestore.iterate(server->config.nodestore.context,
+                                         encodeNonReferenceTypes, &ctx);
+
+    /* Terminate the list of nodes */
+    UA_NodeClass end = UA_NODECLASS_UNSPECIFIED;
+    encodeField(&enc, &end, &UA_TYPES[UA_TYPES_NODECLASS]);
+
+    if(enc.res != UA_STATUSCODE_GOOD) {
+        UA_ByteString_clear(&enc.buf);
+        return enc.res;
+    }
+
+    /* Shrink to the used size */
+    snapshot->data = (UA_Byte*)UA_realloc(enc.buf.data, enc.pos);
+    if(!snapshot->data) {
+        UA_ByteString_clear(&enc.buf);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    snapshot->length = enc.pos;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_encodeNodestoreSnapshot(UA_Server *server, UA_ByteString *snapshot) {
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode res = encodeNodestoreSnapshot(server, snapshot);
+    UA_UNLOCK(&server->serviceMutex);
+    return res;
+}
+
+/************/
+/* Decoding */
+/************/
+
+typedef struct {
+    const UA_ByteString *src;
+    size_t offset;
+    const UA_DataTypeArray *customTypes;
+    UA_StatusCode res;
+} SnapshotDecoder;
+
+/* Errors are sticky. All following calls become a no-op. */
+static void
+decodeField(SnapshotDecoder *dec, void *dst, const UA_DataType *type) {
+    if(dec->res != UA_STATUSCODE_GOOD)
+        return;
+    dec->res = UA_decodeBinary(dec->src, &dec->offset, dst, type, dec->customTypes);
+}
+
+static UA_UInt32
+decodeUInt32(SnapshotDecoder *dec) {
+    UA_UInt32 v = 0;
+    decodeField(dec, &v, &UA_TYPES[UA_TYPES_UINT32]);
+    return v;
+}
+
+static UA_Boolean
+decodeBoolean(SnapshotDecoder *dec) {
+    UA_Boolean v = false;
+    decodeField(dec, &v, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    return v;
+}
+
+static UA_Byte
+decodeByte(SnapshotDecoder *dec) {
+    UA_Byte v = 0;
+    decodeField(dec, &v, &UA_TYPES[UA_TYPES_BYTE]);
+    return v;
+}
+
+static void
+decodeReferences(SnapshotDecoder *dec, UA_Node *node) {
+    UA_UInt32 kindsSize = decodeUInt32(dec);
+    for(UA_UInt32 i = 0; i < kindsSize && dec->res == UA_STATUSCODE_GOOD; i++) {
+        UA_Byte refTypeIndex = decodeByte(dec);
+        UA_Boolean isInverse = decodeBoolean(dec);
+        UA_UInt32 targetsSize = decodeUInt32(dec);
+        for(UA_UInt32 j = 0; j < targetsSize && dec->res == UA_STATUSCODE_GOOD; j++) {
+            UA_ExpandedNodeId targetId;
+            UA_ExpandedNodeId_init(&targetId);
+            decodeField(dec, &targetId, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+            UA_UInt32 targetNameHash = decodeUInt32(dec);
+            if(dec->res == UA_STATUSCODE_GOOD)
+                dec->res = UA_Node_addReference(node, refTypeIndex, !isInverse,
+                                                &targetId, targetNameHash);
+            UA_ExpandedNodeId_clear(&targetId);
+        }
+    }
+}
+
+static void
+decodeVariableAttributes(SnapshotDecoder *dec, UA_NodeId *dataType,
+                         UA_Int32 *valueRank, size_t *arrayDimensionsSize,
+                         UA_UInt32 **arrayDimensions, UA_DataValue *value) {
+    decodeField(dec, dataType, &UA_TYPES[UA_TYPES_NODEID]);
+    decodeField(dec, valueRank, &UA_TYPES[UA_TYPES_INT32]);
+    UA_UInt32 dimsSize = decodeUInt32(dec);
+    if(dec->res == UA_STATUSCODE_GOOD && dimsSize > 0) {
+        *arrayDimensions = (UA_UInt32*)
+            UA_Array_new(dimsSize, &UA_TYPES[UA_TYPES_UINT32]);
+        if(!*arrayDimensions) {
+            dec->res = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        *arrayDimensionsSize = dimsSize;
+        for(UA_UInt32 i = 0; i < dimsSize; i++)
+            (*arrayDimensions)[i] = decodeUInt32(dec);
+    }
+    if(decodeBoolean(dec))
+        decodeField(dec, value, &UA_TYPES[UA_TYPES_DATAVALUE]);
+}
+
+/* Returns the new node or NULL if the end of the node list is reached or an
+ * error occurred (then dec->res is set) */
+static UA_Node *
+decodeNode(UA_Server *server, SnapshotDecoder *dec) {
+    UA_NodeClass nodeClass = UA_NODECLASS_UNSPECIFIED;
+    decodeField(dec, &nodeClass, &UA_TYPES[UA_TYPES_NODECLASS]);
+    if(dec->res != UA_STATUSCODE_GOOD || nodeClass == UA_NODECLASS_UNSPECIFIED)
+        return NULL;
+
+    UA_Node *node = UA_NODESTORE_NEW(server, nodeClass);
+    if(!node) {
+        dec->res = UA_STATUSCODE_BADDECODINGERROR;
+        return NULL;
+    }
+
+    UA_NodeHead *head = &node->head;
+    decodeField(dec, &head->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    decodeField(dec, &head->browseName, &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+    decodeField(dec, &head->displayName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    decodeField(dec, &head->description, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    head->writeMask = decodeUInt32(dec);
+    head->constructed = decodeBoolean(dec);
+    decodeReferences(dec, node);
+
+    switch(nodeClass) {
+    case UA_NODECLASS_VARIABLE: {
+        UA_VariableNode *vn = &node->variableNode;
+        decodeVariableAttributes(dec, &vn->dataType, &vn->valueRank,
+                                 &vn->arrayDimensionsSize, &vn->arrayDimensions,
+                                 &vn->value.data.value);
+        vn->accessLevel = decodeByte(dec);
+        decodeField(dec, &vn->minimumSamplingInterval, &UA_TYPES[UA_TYPES_DOUBLE]);
+        vn->historizing = decodeBoolean(dec);
+        vn->isDynamic = decodeBoolean(dec);
+        break;
+    }
+    case UA_NODECLASS_VARIABLETYPE: {
+        UA_VariableTypeNode *vtn = &node->variableTypeNode;
+        decodeVariableAttributes(dec, &vtn->dataType, &vtn->valueRank,
+                                 &vtn->arrayDimensionsSize, &vtn->arrayDimensions,
+                                 &vtn->value.data.value);
+        vtn->isAbstract = decodeBoolean(dec);
+        break;
+    }
+    case UA_NODECLASS_METHOD:
+        node->methodNode.executable = decodeBoolean(dec);
+        break;
+    case UA_NODECLASS_OBJECT:
+        node->objectNode.eventNotifier = decodeByte(dec);
+        break;
+    case UA_NODECLASS_OBJECTTYPE:
+        node->objectTypeNode.isAbstract = decodeBoolean(dec);
+        break;
+    case UA_NODECLASS_REFERENCETYPE: {
+        UA_ReferenceTypeNode *rtn = &node->referenceTypeNode;
+        rtn->isAbstract = decodeBoolean(dec);
+        rtn->symmetric = decodeBoolean(dec);
+        decodeField(dec, &rtn->inverseName, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        rtn->referenceTypeIndex = decodeByte(dec);
+        for(size_t i = 0; i < UA_REFERENCETYPESET_MAX / 32; i++)
+            rtn->subTypes.bits[i] = decodeUInt32(dec);
+        break;
+    }
+    case UA_NODECLASS_DATATYPE:
+        node->dataTypeNode.isAbstract = decodeBoolean(dec);
+        break;
+    case UA_NODECLASS_VIEW:
+        node->viewNode.eventNotifier = decodeByte(dec);
+        node->viewNode.containsNoLoops = decodeBoolean(dec);
+        break;
+    default:
+        dec->res = UA_STATUSCODE_BADDECODINGERROR;
+        break;
+    }
+
+    if(dec->res != UA_STATUSCODE_GOOD) {
+        UA_NODESTORE_DELETE(server, node);
+        return NULL;
+    }
+    return node;
+}
+
+static UA_StatusCode
+restoreSubTypes(UA_Server *server, UA_Session *session,
+                UA_ReferenceTypeNode *node, const UA_ReferenceTypeSet *subTypes) {
+    node->subTypes = *subTypes;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The nodes are inserted as they are. The consistency checks of the AddNodes
+ * service and the node lifecycle were already done when the snapshot was
+ * taken. */
+UA_StatusCode
+loadNodestoreSnapshot(UA_Server *server, const UA_ByteString *snapshot) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    SnapshotDecoder dec;
+    dec.src = snapshot;
+    dec.offset = 0;
+    dec.customTypes = server->config.customDataTypes;
+    dec.res = UA_STATUSCODE_GOOD;
+
+    /* Header */
+    UA_UInt32 magic = decodeUInt32(&dec);
+    UA_UInt32 version = decodeUInt32(&dec);
+    if(dec.res != UA_STATUSCODE_GOOD || magic != UA_SNAPSHOT_MAGIC ||
+       version != UA_SNAPSHOT_VERSION) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "The buffer is not a nodestore snapshot of a known version");
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+
+    /* Namespaces */
+    UA_UInt32 namespacesSize = decodeUInt32(&dec);
+    for(UA_UInt32 i = 0; i < namespacesSize && dec.res == UA_STATUSCODE_GOOD; i++) {
+        UA_String ns = UA_STRING_NULL;
+        decodeField(&dec, &ns, &UA_TYPES[UA_TYPES_STRING]);
+        if(dec.res == UA_STATUSCODE_GOOD && addNamespace(server, ns) != i + 2)
+            dec.res = UA_STATUSCODE_BADINTERNALERROR;
+        UA_String_clear(&ns);
+    }
+
+    /* Nodes */
+    size_t nodesSize = 0;
+    while(dec.res == UA_STATUSCODE_GOOD) {
+        UA_Node *node = decodeNode(server, &dec);
+        if(!node)
+            break;
+
+        UA_Boolean isRefType = (node->head.nodeClass == UA_NODECLASS_REFERENCETYPE);
+        UA_Byte refTypeIndex = 0;
+        UA_ReferenceTypeSet subTypes;
+        UA_ReferenceTypeSet_init(&subTypes);
+        UA_NodeId refTypeId = UA_NODEID_NULL;
+        if(isRefType) {
+            refTypeIndex = node->referenceTypeNode.referenceTypeIndex;
+            subTypes = node->referenceTypeNode.subTypes;
+            dec.res = UA_NodeId_copy(&node->head.nodeId, &refTypeId);
+            if(dec.res != UA_STATUSCODE_GOOD) {
+                UA_NODESTORE_DELETE(server, node);
+                break;
+            }
+        }
+
+        /* The nodestore takes ownership, also in case of an error */
+        dec.res = UA_NODESTORE_INSERT(server, node, NULL);
+        if(dec.res != UA_STATUSCODE_GOOD) {
+            UA_NodeId_clear(&refTypeId);
+            break;
+        }
+        nodesSize++;
+
+        /* The nodestore assigns the ReferenceTypeIndex and resets the
+         * subtypes. The indices used in the references of the snapshot must
+         * match. */
+        if(isRefType) {
+            const UA_Node *inserted = UA_NODESTORE_GET(server, &refTypeId);
+            if(!inserted ||
+               inserted->referenceTypeNode.referenceTypeIndex != refTypeIndex)
+                dec.res = UA_STATUSCODE_BADINTERNALERROR;
+            if(inserted)
+                UA_NODESTORE_RELEASE(server, inserted);
+            if(dec.res == UA_STATUSCODE_GOOD)
+                dec.res = UA_Server_editNode(server, &server->adminSession,
+                                             &refTypeId,
+                                             (UA_EditNodeCallback)restoreSubTypes,
+                                             &subTypes);
+            UA_NodeId_clear(&refTypeId);
+        }
+    }
+
+    if(dec.res != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                     "Loading the nodestore snapshot failed after %lu nodes "
+                     "with %s", (unsigned long)nodesSize,
+                     UA_StatusCode_name(dec.res));
+        return dec.res;
+    }
+
+    UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                "Loaded %lu nodes from the nodestore snapshot",
+                (unsigned long)nodesSize);
+    return UA_STATUSCODE_GOOD;
+}
@@ -57,7 +57,7 @@ getNodeType(UA_Server *server, const UA_NodeHead *head) {
         if(head->references[i].referenceTypeIndex != parentRefIndex)
             continue;
 
-        UA_assert(head->references[i].idTreeRoot);
+        UA_assert(head->references[i].targetsSize > 0);
         const UA_ReferenceTarget *rt =
             UA_NodeReferenceKind_firstTarget(&head->references[i]);
         UA_assert(rt);
@@ -228,6 +228,25 @@ UA_Server_editNode(UA_Server *server, UA_Session *session,
 #endif
 }
 
+UA_StatusCode
+UA_Server_removeNodeFromNodestore(UA_Server *server, const UA_NodeId *nodeId) {
+    /* The registered nodes keep the removed node pinned until they are
+     * unregistered. But the handles no longer point to it. */
+    if(server->registeredNodesSize > 0) {
+        session_list_entry *current;
+        LIST_FOREACH(current, &server->sessions, pointers) {
+            UA_Session *session = &current->session;
+            for(size_t i = 0; i < session->registeredNodesSize; i++) {
+                UA_RegisteredNode *rn = &session->registeredNodes[i];
+                if(rn->used && UA_NodeId_equal(&rn->nodeId, nodeId))
+                    rn->removed = true;
+            }
+        }
+    }
+    return server->config.nodestore.removeNode(server->config.nodestore.context,
+                                               nodeId);
+}
+
 UA_StatusCode
 UA_Server_processServiceOperations(UA_Server *server, UA_Session *session,
                                    UA_ServiceOperation operationCallback,
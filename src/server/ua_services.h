@@ -308,6 +308,29 @@ void Service_Read(UA_Server *server, UA_Session *session,
                   const UA_ReadRequest *request,
                   UA_ReadResponse *response);
 
+/* Maximum number of nodes pinned by a single ReadRequest with borrowed values */
+#define UA_READ_MAXPINNEDNODES 1024
+
+/* Same as Service_Read. But the values are not copied into the response. They
+ * point into the nodes with UA_VARIANT_DATA_NODELETE. The nodes remain pinned
+ * in the Nodestore and are returned in the pinnedNodes array. They have to be
+ * released with releasePinnedNodes after the response was encoded. */
+void Service_ReadNoCopy(UA_Server *server, UA_Session *session,
+                        const UA_ReadRequest *request, UA_ReadResponse *response,
+                        const UA_Node ***pinnedNodes, size_t *pinnedNodesSize);
+
+void releasePinnedNodes(UA_Server *server, const UA_Node **pinnedNodes,
+                        size_t pinnedNodesSize);
+
+# if UA_MULTITHREADING >= 100
+/* Read and write the values of async DataSource variables by the async
+ * operation workers. If operations remain, then finished is set to false. The
+ * response is then sent once all operations have returned. */
+void Service_ReadAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                       const UA_ReadRequest *request, UA_ReadResponse *response,
+                       UA_Boolean *finished);
+#endif
+
 /**
  * Write Service
  * ^^^^^^^^^^^^^
@@ -319,6 +342,12 @@ void Service_Write(UA_Server *server, UA_Session *session,
                    const UA_WriteRequest *request,
                    UA_WriteResponse *response);
 
+# if UA_MULTITHREADING >= 100
+void Service_WriteAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                        const UA_WriteRequest *request, UA_WriteResponse *response,
+                        UA_Boolean *finished);
+#endif
+
 /**
  * HistoryRead Service
  * ^^^^^^^^^^^^^^^^^^^
@@ -481,6 +510,12 @@ void Service_Republish(UA_Server *server, UA_Session *session,
                        const UA_RepublishRequest *request,
                        UA_RepublishResponse *response);
 
+/* Sends the RepublishResponse directly. The NotificationMessage is copied from
+ * its binary encoding in the retransmission queue without decoding. */
+UA_StatusCode
+Service_RepublishEncoded(UA_Server *server, UA_Session *session,
+                         const UA_RepublishRequest *request, UA_UInt32 requestId);
+
 /**
  * DeleteSubscriptions Service
  * ^^^^^^^^^^^^^^^^^^^^^^^^^^^
@@ -118,10 +118,21 @@ readIsAbstractAttribute(const UA_Node *node, UA_Variant *v) {
     return UA_Variant_setScalarCopy(v, isAbstract, &UA_TYPES[UA_TYPES_BOOLEAN]);
 }
 
+/* If borrowed is non-NULL, the value can point into the node instead of being
+ * copied. Then borrowed is set to true. */
 static UA_StatusCode
 readValueAttributeFromNode(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_DataValue *v,
-                           UA_NumericRange *rangeptr) {
+                           UA_NumericRange *rangeptr, UA_Boolean *borrowed) {
+    /* Point into the node. The DataValue has no other dynamically allocated
+     * members apart from the variant. */
+    if(borrowed && !rangeptr && !vn->value.data.callback.onRead) {
+        *v = vn->value.data.value;
+        v->value.storageType = UA_VARIANT_DATA_NODELETE;
+        *borrowed = true;
+        return UA_STATUSCODE_GOOD;
+    }
+
     /* Update the value by the user callback */
     if(vn->value.data.callback.onRead) {
         UA_UNLOCK(&server->serviceMutex);
@@ -178,7 +189,8 @@ readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
 static UA_StatusCode
 readValueAttributeComplete(UA_Server *server, UA_Session *session,
                            const UA_VariableNode *vn, UA_TimestampsToReturn timestamps,
-                           const UA_String *indexRange, UA_DataValue *v) {
+                           const UA_String *indexRange, UA_DataValue *v,
+                           UA_Boolean *borrowed) {
     /* Compute the index range */
     UA_NumericRange range;
     UA_NumericRange *rangeptr = NULL;
@@ -192,7 +204,8 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
 
     switch(vn->valueBackend.backendType) {
         case UA_VALUEBACKENDTYPE_INTERNAL:
-            retval = readValueAttributeFromNode(server, session, vn, v, rangeptr);
+            retval = readValueAttributeFromNode(server, session, vn, v,
+                                                rangeptr, borrowed);
             //TODO change old structure to value backend
             break;
         case UA_VALUEBACKENDTYPE_DATA_SOURCE_CALLBACK:
@@ -224,7 +237,8 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
         case UA_VALUEBACKENDTYPE_NONE:
             /* Read the value */
             if(vn->valueSource == UA_VALUESOURCE_DATA)
-                retval = readValueAttributeFromNode(server, session, vn, v, rangeptr);
+                retval = readValueAttributeFromNode(server, session, vn, v,
+                                                    rangeptr, borrowed);
             else
                 retval = readValueAttributeFromDataSource(server, session, vn, v,
                                                           timestamps, rangeptr);
@@ -254,7 +268,7 @@ UA_StatusCode
 readValueAttribute(UA_Server *server, UA_Session *session,
                    const UA_VariableNode *vn, UA_DataValue *v) {
     return readValueAttributeComplete(server, session, vn,
-                                      UA_TIMESTAMPSTORETURN_NEITHER, NULL, v);
+                                      UA_TIMESTAMPSTORETURN_NEITHER, NULL, v, NULL);
 }
 
 static const UA_String binEncoding = {sizeof("Default Binary")-1, (UA_Byte*)"Default Binary"};
@@ -336,11 +350,12 @@ getStructureDefinition(const UA_DataType *type, UA_StructureDefinition *def) {
 
 /* Returns a datavalue that may point into the node via the
  * UA_VARIANT_DATA_NODELETE tag. Don't access the returned DataValue once the
- * node has been released! */
-void
-ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
+ * node has been released! The value attribute is only borrowed from the node
+ * if the borrowed argument is non-NULL. */
+static void
+readWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
              UA_TimestampsToReturn timestampsToReturn,
-             const UA_ReadValueId *id, UA_DataValue *v) {
+             const UA_ReadValueId *id, UA_DataValue *v, UA_Boolean *borrowed) {
     UA_LOG_NODEID_DEBUG(&node->head.nodeId,
                         UA_LOG_DEBUG_SESSION(&server->config.logger, session,
                                              "Read attribute %"PRIi32 " of Node %.*s",
@@ -445,7 +460,8 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
             }
         }
         retval = readValueAttributeComplete(server, session, &node->variableNode,
-                                            timestampsToReturn, &id->indexRange, v);
+                                            timestampsToReturn, &id->indexRange,
+                                            v, borrowed);
         break;
     }
     case UA_ATTRIBUTEID_DATATYPE:
@@ -536,6 +552,12 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
         v->hasValue = true;
     }
 
+    setReadTimestamps(v, timestampsToReturn, id->attributeId);
+}
+
+void
+setReadTimestamps(UA_DataValue *v, UA_TimestampsToReturn timestampsToReturn,
+                  UA_UInt32 attributeId) {
     /* Create server timestamp */
     if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
        timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
@@ -549,7 +571,7 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
     }
 
     /* Handle source time stamp */
-    if(id->attributeId == UA_ATTRIBUTEID_VALUE) {
+    if(attributeId == UA_ATTRIBUTEID_VALUE) {
         if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
            timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER) {
             v->hasSourceTimestamp = false;
@@ -561,16 +583,44 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
     }
 }
 
+void
+ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
+             UA_TimestampsToReturn timestampsToReturn,
+             const UA_ReadValueId *id, UA_DataValue *v) {
+    readWithNode(node, server, session, timestampsToReturn, id, v, NULL);
+}
+
+/* Get the node for a NodeId from a request. Handles of registered nodes point
+ * directly to the node without a lookup in the Nodestore. Then registered is
+ * set and the node must not be released. */
+static const UA_Node *
+getRequestNode(UA_Server *server, UA_Session *session, const UA_NodeId *nodeId,
+               UA_Boolean *registered) {
+    *registered = false;
+    UA_RegisteredNode *rn = NULL;
+    if(session)
+        rn = UA_Session_getRegisteredNode(session, nodeId);
+    if(!rn)
+        return UA_NODESTORE_GET(server, nodeId);
+    if(rn->node && !rn->removed) {
+        *registered = true;
+        return rn->node;
+    }
+    return UA_NODESTORE_GET(server, &rn->nodeId);
+}
+
 static void
 Operation_Read(UA_Server *server, UA_Session *session, UA_ReadRequest *request,
                UA_ReadValueId *rvi, UA_DataValue *result) {
     /* Get the node */
-    const UA_Node *node = UA_NODESTORE_GET(server, &rvi->nodeId);
+    UA_Boolean registered;
+    const UA_Node *node = getRequestNode(server, session, &rvi->nodeId, &registered);
 
     /* Perform the read operation */
     if(node) {
         ReadWithNode(node, server, session, request->timestampsToReturn, rvi, result);
-        UA_NODESTORE_RELEASE(server, node);
+        if(!registered)
+            UA_NODESTORE_RELEASE(server, node);
     } else {
         result->hasStatus = true;
         result->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
@@ -613,6 +663,238 @@ Service_Read(UA_Server *server, UA_Session *session,
                                            &UA_TYPES[UA_TYPES_DATAVALUE]);
 }
 
+typedef struct {
+    const UA_Node *node;
+    UA_DataValue *value; /* Result that points into the node */
+} BorrowedValue;
+
+typedef struct {
+    const UA_ReadRequest *request;
+    const UA_Node **pinnedNodes; /* Released after the response was sent */
+    size_t pinnedNodesSize;
+    BorrowedValue *borrowed;
+    size_t borrowedSize;
+} ReadNoCopyContext;
+
+static void
+Operation_ReadNoCopy(UA_Server *server, UA_Session *session, ReadNoCopyContext *ctx,
+                     UA_ReadValueId *rvi, UA_DataValue *result) {
+    UA_Boolean registered;
+    const UA_Node *node = getRequestNode(server, session, &rvi->nodeId, &registered);
+    if(!node) {
+        result->hasStatus = true;
+        result->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        return;
+    }
+
+    /* Keep the node pinned if the value points into it. The number of
+     * borrowed values (and pinned nodes) per request is bounded. */
+    UA_Boolean borrowed = false;
+    UA_Boolean *borrowedPtr = NULL;
+    if(ctx->borrowedSize < UA_READ_MAXPINNEDNODES)
+        borrowedPtr = &borrowed;
+    readWithNode(node, server, session, ctx->request->timestampsToReturn,
+                 rvi, result, borrowedPtr);
+    if(borrowed) {
+        ctx->borrowed[ctx->borrowedSize].node = node;
+        ctx->borrowed[ctx->borrowedSize].value = result;
+        ctx->borrowedSize++;
+    }
+
+    /* Registered nodes remain pinned by the Session */
+    if(registered)
+        return;
+    if(borrowed)
+        ctx->pinnedNodes[ctx->pinnedNodesSize++] = node;
+    else
+        UA_NODESTORE_RELEASE(server, node);
+}
+
+void
+Service_ReadNoCopy(UA_Server *server, UA_Session *session,
+                   const UA_ReadRequest *request, UA_ReadResponse *response,
+                   const UA_Node ***pinnedNodes, size_t *pinnedNodesSize) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    *pinnedNodes = NULL;
+    *pinnedNodesSize = 0;
+
+    /* Fall back to the regular Read service if the request is rejected or the
+     * pinned nodes cannot be tracked */
+    size_t pinnedMax = request->nodesToReadSize;
+    if(pinnedMax > UA_READ_MAXPINNEDNODES)
+        pinnedMax = UA_READ_MAXPINNEDNODES;
+    if(request->timestampsToReturn > UA_TIMESTAMPSTORETURN_NEITHER ||
+       request->maxAge < 0 || pinnedMax == 0 ||
+       (server->config.maxNodesPerRead != 0 &&
+        request->nodesToReadSize > server->config.maxNodesPerRead)) {
+        Service_Read(server, session, request, response);
+        return;
+    }
+    ReadNoCopyContext ctx;
+    ctx.request = request;
+    ctx.pinnedNodesSize = 0;
+    ctx.borrowedSize = 0;
+    ctx.pinnedNodes = (const UA_Node**)
+        UA_malloc(pinnedMax * (sizeof(UA_Node*) + sizeof(BorrowedValue)));
+    if(!ctx.pinnedNodes) {
+        Service_Read(server, session, request, response);
+        return;
+    }
+    ctx.borrowed = (BorrowedValue*)(uintptr_t)&ctx.pinnedNodes[pinnedMax];
+
+    UA_LOG_DEBUG_SESSION(&server->config.logger, session,
+                         "Processing ReadRequest without copying the values");
+    response->responseHeader.serviceResult =
+        UA_Server_processServiceOperations(server, session,
+                                           (UA_ServiceOperation)Operation_ReadNoCopy,
+                                           &ctx, &request->nodesToReadSize,
+                                           &UA_TYPES[UA_TYPES_READVALUEID],
+                                           &response->resultsSize,
+                                           &UA_TYPES[UA_TYPES_DATAVALUE]);
+
+#ifndef UA_ENABLE_IMMUTABLE_NODES
+    /* User callbacks (onRead, DataSources) of later operations can have
+     * edited a node in-situ after its value was borrowed. Point to the current
+     * values. No more user code runs until the response is sent. */
+    for(size_t i = 0; i < ctx.borrowedSize; i++) {
+        const UA_VariableNode *vn = &ctx.borrowed[i].node->variableNode;
+        ctx.borrowed[i].value->value = vn->value.data.value.value;
+        ctx.borrowed[i].value->value.storageType = UA_VARIANT_DATA_NODELETE;
+    }
+#endif
+
+    *pinnedNodes = ctx.pinnedNodes;
+    *pinnedNodesSize = ctx.pinnedNodesSize;
+}
+
+void
+releasePinnedNodes(UA_Server *server, const UA_Node **pinnedNodes,
+                   size_t pinnedNodesSize) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    for(size_t i = 0; i < pinnedNodesSize; i++)
+        UA_NODESTORE_RELEASE(server, pinnedNodes[i]);
+    UA_free(pinnedNodes);
+}
+
+#if UA_MULTITHREADING >= 100
+
+/* Is the value attribute read and written by the async operation workers? */
+static UA_Boolean
+isAsyncDataSource(const UA_Node *node) {
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE || !node->variableNode.async)
+        return false;
+    const UA_VariableNode *vn = &node->variableNode;
+    return (vn->valueBackend.backendType == UA_VALUEBACKENDTYPE_DATA_SOURCE_CALLBACK ||
+            (vn->valueBackend.backendType == UA_VALUEBACKENDTYPE_NONE &&
+             vn->valueSource == UA_VALUESOURCE_DATASOURCE));
+}
+
+static void
+Operation_ReadAsync(UA_Server *server, UA_Session *session,
+                    const UA_ReadRequest *request, UA_UInt32 requestId,
+                    UA_UInt32 requestHandle, size_t opIndex,
+                    const UA_ReadValueId *rvi, UA_DataValue *result,
+                    UA_AsyncResponse **ar) {
+    UA_Boolean registered;
+    const UA_Node *node = getRequestNode(server, session, &rvi->nodeId, &registered);
+    if(!node) {
+        result->hasStatus = true;
+        result->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        return;
+    }
+
+    /* Synchronous execution */
+    if(rvi->attributeId != UA_ATTRIBUTEID_VALUE || !isAsyncDataSource(node) ||
+       (rvi->dataEncoding.name.length > 0 &&
+        !UA_String_equal(&binEncoding, &rvi->dataEncoding.name))) {
+        ReadWithNode(node, server, session, request->timestampsToReturn, rvi, result);
+        goto cleanup;
+    }
+
+    /* <-- Async read of the value --> */
+
+    /* Check the access rights before the operation is handed to the worker */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(!(getAccessLevel(server, session, &node->variableNode) & UA_ACCESSLEVELMASK_READ)) {
+        res = UA_STATUSCODE_BADNOTREADABLE;
+        goto status;
+    }
+    if(!(getUserAccessLevel(server, session, &node->variableNode) &
+         UA_ACCESSLEVELMASK_READ)) {
+        res = UA_STATUSCODE_BADUSERACCESSDENIED;
+        goto status;
+    }
+
+    /* No AsyncResponse allocated so far */
+    if(!*ar) {
+        res = UA_AsyncManager_createAsyncResponse(&server->asyncManager, server,
+                                                  &session->sessionId, requestId,
+                                                  requestHandle,
+                                                  UA_ASYNCOPERATIONTYPE_READ, ar);
+        if(res != UA_STATUSCODE_GOOD)
+            goto status;
+        (*ar)->timestampsToReturn = request->timestampsToReturn;
+    }
+
+    /* Create the async operation to be taken by the workers. The worker uses
+     * the admin session. So handles of registered nodes are resolved here. */
+    UA_ReadValueId resolved = *rvi;
+    resolved.nodeId = node->head.nodeId;
+    res = UA_AsyncManager_createAsyncOp(&server->asyncManager, server,
+                                        *ar, opIndex, &resolved);
+
+ status:
+    if(res != UA_STATUSCODE_GOOD) {
+        result->hasStatus = true;
+        result->status = res;
+    }
+
+ cleanup:
+    if(!registered)
+        UA_NODESTORE_RELEASE(server, node);
+}
+
+void
+Service_ReadAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                  const UA_ReadRequest *request, UA_ReadResponse *response,
+                  UA_Boolean *finished) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    /* The regular Read service rejects the invalid requests */
+    if(request->timestampsToReturn > UA_TIMESTAMPSTORETURN_NEITHER ||
+       request->maxAge < 0 ||
+       (server->config.maxNodesPerRead != 0 &&
+        request->nodesToReadSize > server->config.maxNodesPerRead)) {
+        Service_Read(server, session, request, response);
+        return;
+    }
+
+    UA_LOG_DEBUG_SESSION(&server->config.logger, session, "Processing ReadRequestAsync");
+    UA_AsyncResponse *ar = NULL;
+    response->responseHeader.serviceResult =
+        UA_Server_processServiceOperationsAsync(server, session, requestId,
+                  request->requestHeader.requestHandle,
+                  (UA_AsyncServiceOperation)Operation_ReadAsync, request,
+                  &request->nodesToReadSize, &UA_TYPES[UA_TYPES_READVALUEID],
+                  &response->resultsSize, &UA_TYPES[UA_TYPES_DATAVALUE], &ar);
+
+    if(ar) {
+        if(ar->opCountdown > 0) {
+            /* Move all results to the AsyncResponse. The async operation
+             * results will be overwritten when the workers return results. */
+            ar->response.readResponse = *response;
+            UA_ReadResponse_init(response);
+            *finished = false;
+        } else {
+            /* If there is a new AsyncResponse, ensure it has at least one
+             * pending operation */
+            UA_AsyncManager_removeAsyncResponse(&server->asyncManager, ar);
+        }
+    }
+}
+
+#endif /* UA_MULTITHREADING >= 100 */
+
 UA_DataValue
 UA_Server_readWithSession(UA_Server *server, UA_Session *session,
                           const UA_ReadValueId *item,
@@ -1312,6 +1594,12 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
         case UA_VALUEBACKENDTYPE_NONE:
             /* Ok, do it */
             if(node->valueSource == UA_VALUESOURCE_DATA) {
+#ifdef UA_ENABLE_METHODCALLS
+                /* The argument definitions of methods are cached */
+                if(node->value.data.value.value.type == &UA_TYPES[UA_TYPES_ARGUMENT] ||
+                   adjustedValue.value.type == &UA_TYPES[UA_TYPES_ARGUMENT])
+                    invalidateMethodCallCache(server);
+#endif
                 if(!rangeptr)
                     retval = writeValueAttributeWithoutRange(node, &adjustedValue);
                 else
@@ -1620,7 +1908,21 @@ static void
 Operation_Write(UA_Server *server, UA_Session *session, void *context,
                 const UA_WriteValue *wv, UA_StatusCode *result) {
     UA_assert(session != NULL);
-    *result = UA_Server_editNode(server, session, &wv->nodeId,
+
+    /* Edit a registered node directly. The node is pinned only if it is
+     * edited in-situ (no immutable nodes). */
+    const UA_NodeId *nodeId = &wv->nodeId;
+    UA_RegisteredNode *rn = UA_Session_getRegisteredNode(session, nodeId);
+    if(rn) {
+        if(rn->node && !rn->removed) {
+            *result = copyAttributeIntoNode(server, session,
+                                            (UA_Node*)(uintptr_t)rn->node, wv);
+            return;
+        }
+        nodeId = &rn->nodeId;
+    }
+
+    *result = UA_Server_editNode(server, session, nodeId,
                                  (UA_EditNodeCallback)copyAttributeIntoNode,
                                  (void*)(uintptr_t)wv);
 }
@@ -1651,6 +1953,99 @@ Service_Write(UA_Server *server, UA_Session *session,
                                            &UA_TYPES[UA_TYPES_STATUSCODE]);
 }
 
+#if UA_MULTITHREADING >= 100
+
+static void
+Operation_WriteAsync(UA_Server *server, UA_Session *session, void *context,
+                     UA_UInt32 requestId, UA_UInt32 requestHandle, size_t opIndex,
+                     const UA_WriteValue *wv, UA_StatusCode *result,
+                     UA_AsyncResponse **ar) {
+    UA_Boolean registered = false;
+    const UA_Node *node = NULL;
+    if(wv->attributeId == UA_ATTRIBUTEID_VALUE)
+        node = getRequestNode(server, session, &wv->nodeId, &registered);
+
+    /* Synchronous execution */
+    if(!node || !isAsyncDataSource(node)) {
+        if(node && !registered)
+            UA_NODESTORE_RELEASE(server, node);
+        Operation_Write(server, session, NULL, wv, result);
+        return;
+    }
+
+    /* <-- Async write of the value --> */
+
+    /* Check the access rights before the operation is handed to the worker.
+     * The value is type-checked by the worker when it calls UA_Server_write. */
+    if(!(getAccessLevel(server, session, &node->variableNode) & UA_ACCESSLEVELMASK_WRITE)) {
+        *result = UA_STATUSCODE_BADNOTWRITABLE;
+        goto cleanup;
+    }
+    if(!(getUserAccessLevel(server, session, &node->variableNode) &
+         UA_ACCESSLEVELMASK_WRITE)) {
+        *result = UA_STATUSCODE_BADUSERACCESSDENIED;
+        goto cleanup;
+    }
+
+    /* No AsyncResponse allocated so far */
+    if(!*ar) {
+        *result = UA_AsyncManager_createAsyncResponse(&server->asyncManager, server,
+                                                      &session->sessionId, requestId,
+                                                      requestHandle,
+                                                      UA_ASYNCOPERATIONTYPE_WRITE, ar);
+        if(*result != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+
+    /* Create the async operation to be taken by the workers */
+    UA_WriteValue resolved = *wv;
+    resolved.nodeId = node->head.nodeId;
+    *result = UA_AsyncManager_createAsyncOp(&server->asyncManager, server,
+                                            *ar, opIndex, &resolved);
+
+ cleanup:
+    if(!registered)
+        UA_NODESTORE_RELEASE(server, node);
+}
+
+void
+Service_WriteAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                   const UA_WriteRequest *request, UA_WriteResponse *response,
+                   UA_Boolean *finished) {
+    UA_LOG_DEBUG_SESSION(&server->config.logger, session, "Processing WriteRequestAsync");
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    if(server->config.maxNodesPerWrite != 0 &&
+       request->nodesToWriteSize > server->config.maxNodesPerWrite) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
+        return;
+    }
+
+    UA_AsyncResponse *ar = NULL;
+    response->responseHeader.serviceResult =
+        UA_Server_processServiceOperationsAsync(server, session, requestId,
+                  request->requestHeader.requestHandle,
+                  (UA_AsyncServiceOperation)Operation_WriteAsync, NULL,
+                  &request->nodesToWriteSize, &UA_TYPES[UA_TYPES_WRITEVALUE],
+                  &response->resultsSize, &UA_TYPES[UA_TYPES_STATUSCODE], &ar);
+
+    if(ar) {
+        if(ar->opCountdown > 0) {
+            /* Move all results to the AsyncResponse. The async operation
+             * results will be overwritten when the workers return results. */
+            ar->response.writeResponse = *response;
+            UA_WriteResponse_init(response);
+            *finished = false;
+        } else {
+            /* If there is a new AsyncResponse, ensure it has at least one
+             * pending operation */
+            UA_AsyncManager_removeAsyncResponse(&server->asyncManager, ar);
+        }
+    }
+}
+
+#endif /* UA_MULTITHREADING >= 100 */
+
 UA_StatusCode
 UA_Server_write(UA_Server *server, const UA_WriteValue *value) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
@@ -43,34 +43,387 @@ getArgumentsVariableNode(UA_Server *server, const UA_NodeHead *head,
     return NULL;
 }
 
-/* inputArgumentResults has the length request->inputArgumentsSize */
+static const UA_NodeId hasComponentNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASCOMPONENT}};
+static const UA_NodeId organizedByNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_ORGANIZES}};
+static const UA_String namespaceDiModel = UA_STRING_STATIC("http://opcfoundation.org/UA/DI/");
+static const UA_NodeId hasTypeDefinitionNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASTYPEDEFINITION}};
+// ns=0 will be replace dynamically. DI-Spec. 1.01: <UAObjectType NodeId="ns=1;i=1005" BrowseName="1:FunctionalGroupType">
+static UA_NodeId functionGroupNodeId = {0, UA_NODEIDTYPE_NUMERIC, {1005}};
+
+/* Verify method/object relations. Object must have a hasComponent or a subtype
+ * of hasComponent reference to the method node. Therefore, check every
+ * reference between the parent object and the method node if there is a
+ * hasComponent (or subtype) reference */
+static UA_StatusCode
+checkMethodMembership(UA_Server *server, const UA_NodeId *methodId,
+                      const UA_ObjectNode *object) {
+    UA_ReferenceTypeSet hasComponentRefs;
+    UA_StatusCode res =
+        referenceTypeIndices(server, &hasComponentNodeId, &hasComponentRefs, true);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    for(size_t i = 0; i < object->head.referencesSize; ++i) {
+        const UA_NodeReferenceKind *rk = &object->head.references[i];
+        if(rk->isInverse)
+            continue;
+        if(!UA_ReferenceTypeSet_contains(&hasComponentRefs, rk->referenceTypeIndex))
+            continue;
+        for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(rk);
+            t; t = UA_NodeReferenceKind_nextTarget(rk, t)) {
+            if(UA_ExpandedNodeId_isLocal(&t->targetId) &&
+               UA_NodeId_equal(&t->targetId.nodeId, methodId))
+                return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* The following ParentObject evaluation is a workaround only to fulfill
+     * the OPC UA Spec. Part 100 - Devices requirements regarding functional
+     * groups. Compare OPC UA Spec. Part 100 - Devices, Release 1.02
+     *    - 5.4 FunctionalGroupType
+     *    - B.1 Functional Group Usages
+     * A functional group is a sub-type of the FolderType and is used to
+     * organize the Parameters and Methods from the complete set (named
+     * ParameterSet and MethodSet) in (Functional) groups for instance
+     * Configuration or Identification. The same Property, Parameter or
+     * Method can be referenced from more than one FunctionalGroup. */
+
+    /* Check whether the DI namespace is available */
+    size_t foundNamespace = 0;
+    res = getNamespaceByName(server, namespaceDiModel, &foundNamespace);
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADMETHODINVALID;
+    functionGroupNodeId.namespaceIndex = (UA_UInt16)foundNamespace;
+
+    UA_ReferenceTypeSet hasTypeDefinitionRefs;
+    res = referenceTypeIndices(server, &hasTypeDefinitionNodeId,
+                               &hasTypeDefinitionRefs, true);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Search for a HasTypeDefinition (or sub-) reference in the parent object */
+    for(size_t i = 0; i < object->head.referencesSize; ++i) {
+        const UA_NodeReferenceKind *rk = &object->head.references[i];
+        if(rk->isInverse)
+            continue;
+        if(!UA_ReferenceTypeSet_contains(&hasTypeDefinitionRefs, rk->referenceTypeIndex))
+            continue;
+
+        /* Verify that the HasTypeDefinition is equal to FunctionGroupType
+         * (or sub-type) from the DI model */
+        for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(rk);
+            t; t = UA_NodeReferenceKind_nextTarget(rk, t)) {
+            if(!UA_ExpandedNodeId_isLocal(&t->targetId))
+                continue;
+
+            if(!isNodeInTree_singleRef(server, &t->targetId.nodeId,
+                                       &functionGroupNodeId,
+                                       UA_REFERENCETYPEINDEX_HASSUBTYPE))
+                continue;
+
+            /* Search for the called method with reference Organize (or
+             * sub-type) from the parent object */
+            for(size_t k = 0; k < object->head.referencesSize; ++k) {
+                const UA_NodeReferenceKind *rkInner = &object->head.references[k];
+                if(rkInner->isInverse)
+                    continue;
+                const UA_NodeId * refId =
+                    UA_NODESTORE_GETREFERENCETYPEID(server, rkInner->referenceTypeIndex);
+                if(!isNodeInTree_singleRef(server, refId, &organizedByNodeId,
+                                           UA_REFERENCETYPEINDEX_HASSUBTYPE))
+                    continue;
+
+                for(UA_ReferenceTarget *t2 = UA_NodeReferenceKind_firstTarget(rkInner);
+                    t2; t2 = UA_NodeReferenceKind_nextTarget(rkInner, t2)) {
+                    if(!UA_ExpandedNodeId_isLocal(&t2->targetId))
+                        continue;
+                    if(UA_NodeId_equal(&t2->targetId.nodeId, methodId))
+                        return UA_STATUSCODE_GOOD;
+                }
+            }
+        }
+    }
+    return UA_STATUSCODE_BADMETHODINVALID;
+}
+
+/********************/
+/* Call Descriptors */
+/********************/
+
+/* What a method call needs from the address space besides the method and the
+ * object node */
+typedef struct {
+    UA_StatusCode membership; /* Is the method a component of the object? */
+    UA_StatusCode inputArgumentsStatus; /* Is the InputArguments value valid? */
+    size_t inputArgumentsSize;
+    UA_Argument *inputArguments;
+    size_t outputArgumentsSize;
+} UA_MethodCallDescriptor;
+
+static void
+UA_MethodCallDescriptor_clear(UA_MethodCallDescriptor *desc) {
+    UA_Array_delete(desc->inputArguments, desc->inputArgumentsSize,
+                    &UA_TYPES[UA_TYPES_ARGUMENT]);
+    memset(desc, 0, sizeof(UA_MethodCallDescriptor));
+}
+
+/* Values from a DataSource or a value backend can change without notice */
+static UA_Boolean
+isStaticValue(const UA_VariableNode *node) {
+    return (node->valueSource == UA_VALUESOURCE_DATA &&
+            node->valueBackend.backendType == UA_VALUEBACKENDTYPE_NONE);
+}
+
+static UA_StatusCode
+resolveMethodArguments(UA_Server *server, const UA_MethodNode *method,
+                       UA_MethodCallDescriptor *desc, UA_Boolean *cacheable) {
+    /* Get the input arguments node. Without the node, no arguments are
+     * accepted. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    const UA_VariableNode *inputArguments =
+        getArgumentsVariableNode(server, &method->head, UA_STRING("InputArguments"));
+    if(inputArguments) {
+        *cacheable = *cacheable && isStaticValue(inputArguments);
+
+        /* Verify that we have a Variant containing UA_Argument (scalar or
+         * array). A scalar argument value is interpreted as an array of length
+         * 1. */
+        const UA_Variant *v = &inputArguments->value.data.value.value;
+        if(inputArguments->valueSource != UA_VALUESOURCE_DATA ||
+           !inputArguments->value.data.value.hasValue ||
+           v->type != &UA_TYPES[UA_TYPES_ARGUMENT]) {
+            desc->inputArgumentsStatus = UA_STATUSCODE_BADINTERNALERROR;
+        } else {
+            size_t argsSize = (UA_Variant_isScalar(v)) ? 1 : v->arrayLength;
+            res = UA_Array_copy(v->data, argsSize, (void**)&desc->inputArguments,
+                                &UA_TYPES[UA_TYPES_ARGUMENT]);
+            if(res == UA_STATUSCODE_GOOD)
+                desc->inputArgumentsSize = argsSize;
+        }
+        UA_NODESTORE_RELEASE(server, (const UA_Node*)inputArguments);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    /* Get the output arguments node */
+    const UA_VariableNode *outputArguments =
+        getArgumentsVariableNode(server, &method->head, UA_STRING("OutputArguments"));
+    if(outputArguments) {
+        *cacheable = *cacheable && isStaticValue(outputArguments);
+        if(outputArguments->valueSource == UA_VALUESOURCE_DATA)
+            desc->outputArgumentsSize = outputArguments->value.data.value.value.arrayLength;
+        UA_NODESTORE_RELEASE(server, (const UA_Node*)outputArguments);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/*********************/
+/* Method Call Cache */
+/*********************/
+
+#define UA_METHODCALLCACHE_MINSIZE 64
+
+struct UA_MethodCallCacheEntry {
+    UA_MethodCallCacheEntry *next;
+    UA_UInt32 hash;
+    UA_UInt32 generation;
+    UA_NodeId objectId;
+    UA_NodeId methodId;
+    UA_MethodCallDescriptor descriptor;
+};
+
+static void
+deleteMethodCallCacheEntry(UA_MethodCallCacheEntry *entry) {
+    UA_NodeId_clear(&entry->objectId);
+    UA_NodeId_clear(&entry->methodId);
+    UA_MethodCallDescriptor_clear(&entry->descriptor);
+    UA_free(entry);
+}
+
+void
+clearMethodCallCache(UA_Server *server) {
+    for(size_t i = 0; i < server->methodCallCacheSize; i++) {
+        UA_MethodCallCacheEntry *entry = server->methodCallCache[i];
+        while(entry) {
+            UA_MethodCallCacheEntry *next = entry->next;
+            deleteMethodCallCacheEntry(entry);
+            entry = next;
+        }
+    }
+    UA_free(server->methodCallCache);
+    server->methodCallCache = NULL;
+    server->methodCallCacheSize = 0;
+    server->methodCallCacheCount = 0;
+}
+
+void
+invalidateMethodCallCache(UA_Server *server) {
+    /* Outdated entries could match again after the overflow */
+    server->methodCallCacheGeneration++;
+    if(server->methodCallCacheGeneration == 0)
+        clearMethodCallCache(server);
+}
+
+static UA_UInt32
+hashMethodCall(const UA_NodeId *objectId, const UA_NodeId *methodId) {
+    UA_UInt32 h[2];
+    h[0] = UA_NodeId_hash(objectId);
+    h[1] = UA_NodeId_hash(methodId);
+    return UA_ByteString_hash(0, (const UA_Byte*)h, sizeof(h));
+}
+
+/* Returns only entries of the current generation. Outdated entries are
+ * removed. */
+static UA_MethodCallCacheEntry *
+findMethodCallCacheEntry(UA_Server *server, const UA_NodeId *objectId,
+                         const UA_NodeId *methodId, UA_UInt32 hash) {
+    if(server->methodCallCacheSize == 0)
+        return NULL;
+    UA_MethodCallCacheEntry **prev =
+        &server->methodCallCache[hash & (server->methodCallCacheSize - 1)];
+    for(UA_MethodCallCacheEntry *entry = *prev; entry; entry = *prev) {
+        if(entry->hash == hash &&
+           UA_NodeId_equal(&entry->methodId, methodId) &&
+           UA_NodeId_equal(&entry->objectId, objectId)) {
+            if(entry->generation == server->methodCallCacheGeneration)
+                return entry;
+            *prev = entry->next;
+            server->methodCallCacheCount--;
+            deleteMethodCallCacheEntry(entry);
+            return NULL;
+        }
+        prev = &entry->next;
+    }
+    return NULL;
+}
+
+/* Keeps the old buckets if the allocation fails */
+static void
+resizeMethodCallCache(UA_Server *server, size_t size) {
+    UA_MethodCallCacheEntry **cache = (UA_MethodCallCacheEntry**)
+        UA_calloc(size, sizeof(UA_MethodCallCacheEntry*));
+    if(!cache)
+        return;
+    for(size_t i = 0; i < server->methodCallCacheSize; i++) {
+        UA_MethodCallCacheEntry *entry = server->methodCallCache[i];
+        while(entry) {
+            UA_MethodCallCacheEntry *next = entry->next;
+            UA_MethodCallCacheEntry **bucket = &cache[entry->hash & (size - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    UA_free(server->methodCallCache);
+    server->methodCallCache = cache;
+    server->methodCallCacheSize = size;
+}
+
+/* Moves the descriptor into the cache. Returns NULL if the descriptor could
+ * not be added. Then the descriptor is not moved. */
+static UA_MethodCallCacheEntry *
+addMethodCallCacheEntry(UA_Server *server, const UA_NodeId *objectId,
+                        const UA_NodeId *methodId, UA_UInt32 hash,
+                        UA_MethodCallDescriptor *desc) {
+    /* Start over when the cache is full. Outdated entries are dropped as well. */
+    if(server->methodCallCacheCount >= server->config.maxMethodCallCacheSize)
+        clearMethodCallCache(server);
+
+    if(server->methodCallCacheCount >= server->methodCallCacheSize)
+        resizeMethodCallCache(server, (server->methodCallCacheSize > 0) ?
+                              server->methodCallCacheSize * 2 :
+                              UA_METHODCALLCACHE_MINSIZE);
+    if(server->methodCallCacheSize == 0)
+        return NULL;
+
+    UA_MethodCallCacheEntry *entry = (UA_MethodCallCacheEntry*)
+        UA_calloc(1, sizeof(UA_MethodCallCacheEntry));
+    if(!entry)
+        return NULL;
+    UA_StatusCode res = UA_NodeId_copy(objectId, &entry->objectId);
+    res |= UA_NodeId_copy(methodId, &entry->methodId);
+    if(res != UA_STATUSCODE_GOOD) {
+        deleteMethodCallCacheEntry(entry);
+        return NULL;
+    }
+    entry->hash = hash;
+    entry->generation = server->methodCallCacheGeneration;
+    entry->descriptor = *desc;
+    memset(desc, 0, sizeof(UA_MethodCallDescriptor));
+    UA_MethodCallCacheEntry **bucket =
+        &server->methodCallCache[hash & (server->methodCallCacheSize - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    server->methodCallCacheCount++;
+    return entry;
+}
+
+/* Returns the descriptor from the cache or resolves it into localDesc (which is
+ * then moved into the cache if possible). The descriptor must not be used after
+ * the service mutex was released. localDesc has to be cleared afterwards. */
+static UA_StatusCode
+getMethodCallDescriptor(UA_Server *server, const UA_CallMethodRequest *request,
+                        const UA_MethodNode *method, const UA_ObjectNode *object,
+                        UA_MethodCallDescriptor *localDesc,
+                        const UA_MethodCallDescriptor **desc) {
+    memset(localDesc, 0, sizeof(UA_MethodCallDescriptor));
+    UA_Boolean useCache = (server->config.maxMethodCallCacheSize > 0);
+    UA_UInt32 hash = 0;
+    if(useCache) {
+        hash = hashMethodCall(&request->objectId, &request->methodId);
+        UA_MethodCallCacheEntry *entry =
+            findMethodCallCacheEntry(server, &request->objectId,
+                                     &request->methodId, hash);
+        if(entry) {
+            *desc = &entry->descriptor;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* Resolve from the address space */
+    UA_Boolean cacheable = true;
+    localDesc->membership = checkMethodMembership(server, &request->methodId, object);
+    if(localDesc->membership == UA_STATUSCODE_GOOD) {
+        UA_StatusCode res = resolveMethodArguments(server, method, localDesc, &cacheable);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_MethodCallDescriptor_clear(localDesc);
+            return res;
+        }
+    }
+    *desc = localDesc;
+
+    if(useCache && cacheable) {
+        UA_MethodCallCacheEntry *entry =
+            addMethodCallCacheEntry(server, &request->objectId,
+                                    &request->methodId, hash, localDesc);
+        if(entry)
+            *desc = &entry->descriptor;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/****************/
+/* Method Calls */
+/****************/
+
+/* inputArgumentResults has the length argsSize */
 static UA_StatusCode
 typeCheckArguments(UA_Server *server, UA_Session *session,
-                   const UA_VariableNode *argRequirements, size_t argsSize,
+                   const UA_MethodCallDescriptor *desc, size_t argsSize,
                    UA_Variant *args, UA_StatusCode *inputArgumentResults) {
-    /* Verify that we have a Variant containing UA_Argument (scalar or array) in
-     * the "InputArguments" node */
-    if(argRequirements->valueSource != UA_VALUESOURCE_DATA)
-        return UA_STATUSCODE_BADINTERNALERROR;
-    if(!argRequirements->value.data.value.hasValue)
-        return UA_STATUSCODE_BADINTERNALERROR;
-    if(argRequirements->value.data.value.value.type != &UA_TYPES[UA_TYPES_ARGUMENT])
-        return UA_STATUSCODE_BADINTERNALERROR;
-
-    /* Verify the number of arguments. A scalar argument value is interpreted as
-     * an array of length 1. */
-    size_t argReqsSize = argRequirements->value.data.value.value.arrayLength;
-    if(UA_Variant_isScalar(&argRequirements->value.data.value.value))
-        argReqsSize = 1;
-    if(argReqsSize > argsSize)
+    if(desc->inputArgumentsStatus != UA_STATUSCODE_GOOD)
+        return desc->inputArgumentsStatus;
+
+    /* Verify the number of arguments */
+    if(desc->inputArgumentsSize > argsSize)
         return UA_STATUSCODE_BADARGUMENTSMISSING;
-    if(argReqsSize < argsSize)
+    if(desc->inputArgumentsSize < argsSize)
         return UA_STATUSCODE_BADTOOMANYARGUMENTS;
 
     /* Type-check every argument against the definition */
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
-    UA_Argument *argReqs = (UA_Argument*)argRequirements->value.data.value.value.data;
-    for(size_t i = 0; i < argReqsSize; ++i) {
+    const UA_Argument *argReqs = desc->inputArguments;
+    for(size_t i = 0; i < desc->inputArgumentsSize; ++i) {
         if(!compatibleValue(server, session, &argReqs[i].dataType, argReqs[i].valueRank,
                             argReqs[i].arrayDimensionsSize, argReqs[i].arrayDimensions,
                             &args[i], NULL)) {
@@ -81,37 +434,6 @@ typeCheckArguments(UA_Server *server, UA_Session *session,
     return retval;
 }
 
-/* inputArgumentResults has the length request->inputArgumentsSize */
-static UA_StatusCode
-validMethodArguments(UA_Server *server, UA_Session *session, const UA_MethodNode *method,
-                     const UA_CallMethodRequest *request,
-                     UA_StatusCode *inputArgumentResults) {
-    /* Get the input arguments node */
-    const UA_VariableNode *inputArguments =
-        getArgumentsVariableNode(server, &method->head, UA_STRING("InputArguments"));
-    if(!inputArguments) {
-        if(request->inputArgumentsSize > 0)
-            return UA_STATUSCODE_BADTOOMANYARGUMENTS;
-        return UA_STATUSCODE_GOOD;
-    }
-
-    /* Verify the request */
-    UA_StatusCode retval =
-        typeCheckArguments(server, session, inputArguments, request->inputArgumentsSize,
-                           request->inputArguments, inputArgumentResults);
-
-    /* Release the input arguments node */
-    UA_NODESTORE_RELEASE(server, (const UA_Node*)inputArguments);
-    return retval;
-}
-
-static const UA_NodeId hasComponentNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASCOMPONENT}};
-static const UA_NodeId organizedByNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_ORGANIZES}};
-static const UA_String namespaceDiModel = UA_STRING_STATIC("http://opcfoundation.org/UA/DI/");
-static const UA_NodeId hasTypeDefinitionNodeId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASTYPEDEFINITION}};
-// ns=0 will be replace dynamically. DI-Spec. 1.01: <UAObjectType NodeId="ns=1;i=1005" BrowseName="1:FunctionalGroupType">
-static UA_NodeId functionGroupNodeId = {0, UA_NODEIDTYPE_NUMERIC, {1005}};
-
 static void
 callWithMethodAndObject(UA_Server *server, UA_Session *session,
                         const UA_CallMethodRequest *request, UA_CallMethodResult *result,
@@ -135,110 +457,39 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
         return;
     }
 
-    /* Verify method/object relations. Object must have a hasComponent or a
-     * subtype of hasComponent reference to the method node. Therefore, check
-     * every reference between the parent object and the method node if there is
-     * a hasComponent (or subtype) reference */
-    UA_ReferenceTypeSet hasComponentRefs;
+    /* Get the object membership and the argument definitions */
+    UA_MethodCallDescriptor localDesc;
+    const UA_MethodCallDescriptor *desc = NULL;
     result->statusCode =
-        referenceTypeIndices(server, &hasComponentNodeId, &hasComponentRefs, true);
+        getMethodCallDescriptor(server, request, method, object, &localDesc, &desc);
     if(result->statusCode != UA_STATUSCODE_GOOD)
         return;
 
-    UA_Boolean found = false;
-    for(size_t i = 0; i < object->head.referencesSize && !found; ++i) {
-        const UA_NodeReferenceKind *rk = &object->head.references[i];
-        if(rk->isInverse)
-            continue;
-        if(!UA_ReferenceTypeSet_contains(&hasComponentRefs, rk->referenceTypeIndex))
-            continue;
-        for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(rk);
-            t; t = UA_NodeReferenceKind_nextTarget(rk, t)) {
-            if(UA_ExpandedNodeId_isLocal(&t->targetId) &&
-               UA_NodeId_equal(&t->targetId.nodeId, &request->methodId)) {
-                found = true;
-                break;
-            }
-        }
+    /* Verify method/object relations */
+    if(desc->membership != UA_STATUSCODE_GOOD) {
+        result->statusCode = desc->membership;
+        UA_MethodCallDescriptor_clear(&localDesc);
+        return;
     }
 
-    if(!found) {
-        /* The following ParentObject evaluation is a workaround only to fulfill
-         * the OPC UA Spec. Part 100 - Devices requirements regarding functional
-         * groups. Compare OPC UA Spec. Part 100 - Devices, Release 1.02
-         *    - 5.4 FunctionalGroupType
-         *    - B.1 Functional Group Usages
-         * A functional group is a sub-type of the FolderType and is used to
-         * organize the Parameters and Methods from the complete set (named
-         * ParameterSet and MethodSet) in (Functional) groups for instance
-         * Configuration or Identification. The same Property, Parameter or
-         * Method can be referenced from more than one FunctionalGroup. */
-
-        /* Check whether the DI namespace is available */
-        size_t foundNamespace = 0;
-        UA_StatusCode res = getNamespaceByName(server, namespaceDiModel, &foundNamespace);
-        if(res != UA_STATUSCODE_GOOD) {
-            result->statusCode = UA_STATUSCODE_BADMETHODINVALID;
-            return;
-        }
-        functionGroupNodeId.namespaceIndex = (UA_UInt16)foundNamespace;
-
-        UA_ReferenceTypeSet hasTypeDefinitionRefs;
-        result->statusCode =
-            referenceTypeIndices(server, &hasTypeDefinitionNodeId,
-                                 &hasTypeDefinitionRefs, true);
-        if(result->statusCode != UA_STATUSCODE_GOOD)
-            return;
-
-        /* Search for a HasTypeDefinition (or sub-) reference in the parent object */
-        for(size_t i = 0; i < object->head.referencesSize && !found; ++i) {
-            const UA_NodeReferenceKind *rk = &object->head.references[i];
-            if(rk->isInverse)
-                continue;
-            if(!UA_ReferenceTypeSet_contains(&hasTypeDefinitionRefs, rk->referenceTypeIndex))
-                continue;
-            
-            /* Verify that the HasTypeDefinition is equal to FunctionGroupType
-             * (or sub-type) from the DI model */
-            for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(rk);
-                t && !found; t = UA_NodeReferenceKind_nextTarget(rk, t)) {
-                if(!UA_ExpandedNodeId_isLocal(&t->targetId))
-                    continue;
-                
-                if(!isNodeInTree_singleRef(server, &t->targetId.nodeId,
-                                           &functionGroupNodeId,
-                                           UA_REFERENCETYPEINDEX_HASSUBTYPE))
-                    continue;
-
-                /* Search for the called method with reference Organize (or
-                 * sub-type) from the parent object */
-                for(size_t k = 0; k < object->head.referencesSize && !found; ++k) {
-                    const UA_NodeReferenceKind *rkInner = &object->head.references[k];
-                    if(rkInner->isInverse)
-                        continue;
-                    const UA_NodeId * refId = 
-                        UA_NODESTORE_GETREFERENCETYPEID(server, rkInner->referenceTypeIndex);
-                    if(!isNodeInTree_singleRef(server, refId, &organizedByNodeId,
-                                               UA_REFERENCETYPEINDEX_HASSUBTYPE))
-                        continue;
-                    
-                    for(UA_ReferenceTarget *t2 = UA_NodeReferenceKind_firstTarget(rkInner);
-                        t2; t2 = UA_NodeReferenceKind_nextTarget(rkInner, t2)) {
-                        if(!UA_ExpandedNodeId_isLocal(&t2->targetId))
-                            continue;
-                        if(UA_NodeId_equal(&t2->targetId.nodeId, &request->methodId)) {
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-        if(!found) {
-            result->statusCode = UA_STATUSCODE_BADMETHODINVALID;
-            return;
-        }
+    /* Allocate the inputArgumentResults array */
+    result->inputArgumentResults = (UA_StatusCode*)
+        UA_Array_new(request->inputArgumentsSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
+    if(!result->inputArgumentResults) {
+        result->statusCode = UA_STATUSCODE_BADOUTOFMEMORY;
+        UA_MethodCallDescriptor_clear(&localDesc);
+        return;
     }
+    result->inputArgumentResultsSize = request->inputArgumentsSize;
+
+    /* Verify Input Arguments. Done before the access rights are checked. The
+     * cache may change while the mutex is released. */
+    UA_StatusCode argsResult =
+        typeCheckArguments(server, session, desc, request->inputArgumentsSize,
+                           request->inputArguments, result->inputArgumentResults);
+    size_t outputArgsSize = desc->outputArgumentsSize;
+    UA_MethodCallDescriptor_clear(&localDesc);
+    desc = NULL;
 
     /* Verify access rights */
     UA_Boolean executable = method->executable;
@@ -251,23 +502,9 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
         UA_LOCK(&server->serviceMutex);
     }
 
-    if(!executable) {
-        result->statusCode = UA_STATUSCODE_BADNOTEXECUTABLE;
-        return;
-    }
-
-    /* Allocate the inputArgumentResults array */
-    result->inputArgumentResults = (UA_StatusCode*)
-        UA_Array_new(request->inputArgumentsSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
-    if(!result->inputArgumentResults) {
-        result->statusCode = UA_STATUSCODE_BADOUTOFMEMORY;
-        return;
-    }
-    result->inputArgumentResultsSize = request->inputArgumentsSize;
-
-    /* Verify Input Arguments */
-    result->statusCode = validMethodArguments(server, session, method, request,
-                                              result->inputArgumentResults);
+    if(!executable)
+        argsResult = UA_STATUSCODE_BADNOTEXECUTABLE;
+    result->statusCode = argsResult;
 
     /* Return inputArgumentResults only for BADINVALIDARGUMENT */
     if(result->statusCode != UA_STATUSCODE_BADINVALIDARGUMENT) {
@@ -281,14 +518,7 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
     if(result->statusCode != UA_STATUSCODE_GOOD)
         return;
 
-    /* Get the output arguments node */
-    const UA_VariableNode *outputArguments =
-        getArgumentsVariableNode(server, &method->head, UA_STRING("OutputArguments"));
-
     /* Allocate the output arguments array */
-    size_t outputArgsSize = 0;
-    if(outputArguments)
-        outputArgsSize = outputArguments->value.data.value.value.arrayLength;
     result->outputArguments = (UA_Variant*)
         UA_Array_new(outputArgsSize, &UA_TYPES[UA_TYPES_VARIANT]);
     if(!result->outputArguments) {
@@ -297,9 +527,6 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
     }
     result->outputArgumentsSize = outputArgsSize;
 
-    /* Release the output arguments node */
-    UA_NODESTORE_RELEASE(server, (const UA_Node*)outputArguments);
-
     /* Call the method */
     UA_UNLOCK(&server->serviceMutex);
     result->statusCode = method->method(server, &session->sessionId, session->sessionHandle,
@@ -314,8 +541,8 @@ callWithMethodAndObject(UA_Server *server, UA_Session *session,
 #if UA_MULTITHREADING >= 100
 
 static void
-Operation_CallMethodAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
-                          UA_UInt32 requestHandle, size_t opIndex,
+Operation_CallMethodAsync(UA_Server *server, UA_Session *session, void *context,
+                          UA_UInt32 requestId, UA_UInt32 requestHandle, size_t opIndex,
                           UA_CallMethodRequest *opRequest, UA_CallMethodResult *opResult,
                           UA_AsyncResponse **ar) {
     /* Get the method node */
@@ -378,7 +605,7 @@ Service_CallAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
     response->responseHeader.serviceResult =
         UA_Server_processServiceOperationsAsync(server, session, requestId,
                   request->requestHeader.requestHandle,
-                  (UA_AsyncServiceOperation)Operation_CallMethodAsync,
+                  (UA_AsyncServiceOperation)Operation_CallMethodAsync, NULL,
                   &request->methodsToCallSize, &UA_TYPES[UA_TYPES_CALLMETHODREQUEST],
                   &response->resultsSize, &UA_TYPES[UA_TYPES_CALLMETHODRESULT], &ar);
 
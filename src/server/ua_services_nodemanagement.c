@@ -1238,6 +1238,10 @@ recursiveTypeCheckAddChildren(UA_Server *server, UA_Session *session,
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+callConstructors(UA_Server *server, UA_Session *session,
+                 const UA_NodeHead *head, const UA_Node *type);
+
 /* Construct children first */
 static UA_StatusCode
 recursiveCallConstructors(UA_Server *server, UA_Session *session,
@@ -1296,7 +1300,15 @@ recursiveCallConstructors(UA_Server *server, UA_Session *session,
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
 
+    return callConstructors(server, session, head, type);
+}
+
+/* Call the constructors of the node. The children are already constructed. */
+static UA_StatusCode
+callConstructors(UA_Server *server, UA_Session *session,
+                 const UA_NodeHead *head, const UA_Node *type) {
     /* Call the global constructor */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
     void *context = head->context;
     if(server->config.nodeLifecycle.constructor) {
         UA_UNLOCK(&server->serviceMutex);
@@ -1699,8 +1711,10 @@ deconstructNodeSet(UA_Server *server, UA_Session *session,
         if(member->head.nodeClass == UA_NODECLASS_OBJECT ||
            member->head.nodeClass == UA_NODECLASS_VARIABLE) {
             const UA_Node *type = getNodeType(server, &member->head);
-            if(!type)
+            if(!type) {
+                UA_NODESTORE_RELEASE(server, member);
                 continue;
+            }
 
             /* Get the lifecycle */
             const UA_NodeTypeLifecycle *lifecycle;
@@ -1822,6 +1836,14 @@ deleteNodeSet(UA_Server *server, UA_Session *session,
             removeIncomingReferences(server, session, &member->head);
         UA_NODESTORE_REMOVE(server, &member->head.nodeId);
     }
+
+#ifdef UA_ENABLE_METHODCALLS
+    /* Not all references to the deleted nodes are removed */
+    invalidateMethodCallCache(server);
+#endif
+#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
+    invalidateConditionFieldCache(server);
+#endif
 }
 
 static void
@@ -1953,6 +1975,13 @@ struct AddNodeInfo {
 static UA_StatusCode
 addOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
                    const struct AddNodeInfo *info) {
+    if(info->refTypeIndex == UA_REFERENCETYPEINDEX_HASSUBTYPE)
+        invalidateSubtypeIndex(server, (info->isForward) ?
+                               &info->targetNodeId->nodeId : &node->head.nodeId);
+    invalidateBrowsePathCache(server);
+#ifdef UA_ENABLE_METHODCALLS
+    invalidateMethodCallCache(server);
+#endif
     return UA_Node_addReference(node, info->refTypeIndex, info->isForward,
                                 info->targetNodeId, info->targetBrowseNameHash);
 }
@@ -1969,6 +1998,16 @@ deleteOneWayReference(UA_Server *server, UA_Session *session, UA_Node *node,
     }
     UA_Byte refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
     UA_NODESTORE_RELEASE(server, refType);
+    if(refTypeIndex == UA_REFERENCETYPEINDEX_HASSUBTYPE)
+        invalidateSubtypeIndex(server, (item->isForward) ?
+                               &item->targetNodeId.nodeId : &node->head.nodeId);
+    invalidateBrowsePathCache(server);
+#ifdef UA_ENABLE_METHODCALLS
+    invalidateMethodCallCache(server);
+#endif
+#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
+    invalidateConditionFieldCache(server);
+#endif
     return UA_Node_deleteReference(node, refTypeIndex, item->isForward, &item->targetNodeId);
 }
 
@@ -2206,6 +2245,535 @@ UA_Server_deleteReference(UA_Server *server, const UA_NodeId sourceNodeId,
     return retval;
 }
 
+/*****************************/
+/* Bulk Object Instantiation */
+/*****************************/
+
+/* The instantiation plan lists the instance declarations that are copied into
+ * every instance of an ObjectType. It is computed once with the rules of
+ * copyAllChildren (the type before its supertypes, existing children are
+ * merged by their BrowseName). Then it is applied to all instances without
+ * browsing the type hierarchy again. */
+
+#define UA_PLAN_ROOT ((size_t)-1)
+
+typedef struct {
+    size_t parent;              /* Index of the parent step or UA_PLAN_ROOT */
+    UA_NodeId source;           /* The instance declaration */
+    UA_NodeId referenceTypeId;  /* Reference from the parent */
+    UA_Byte refTypeIndex;
+    UA_NodeClass nodeClass;
+    UA_Boolean mandatory;
+    UA_Boolean checkRefs;       /* Add the references with type-checking */
+    UA_UInt32 browseNameHash;
+    UA_NodeId typeDefinition;
+    UA_UInt32 typeDefinitionHash;
+    UA_QualifiedName browseName;
+    UA_Node *node;              /* Prepared copy of the declaration. NULL for
+                                 * methods, they are only referenced. */
+} UA_InstantiationStep;
+
+typedef struct {
+    size_t stepsSize;
+    UA_InstantiationStep *steps;
+} UA_InstantiationPlan;
+
+static void
+InstantiationPlan_clear(UA_Server *server, UA_InstantiationPlan *plan) {
+    for(size_t i = 0; i < plan->stepsSize; i++) {
+        UA_InstantiationStep *step = &plan->steps[i];
+        UA_NodeId_clear(&step->source);
+        UA_NodeId_clear(&step->referenceTypeId);
+        UA_NodeId_clear(&step->typeDefinition);
+        UA_QualifiedName_clear(&step->browseName);
+        if(step->node)
+            UA_NODESTORE_DELETE(server, step->node);
+    }
+    UA_free(plan->steps);
+    plan->steps = NULL;
+    plan->stepsSize = 0;
+}
+
+static size_t
+findPlanStep(const UA_InstantiationPlan *plan, size_t parent,
+             const UA_QualifiedName *browseName) {
+    for(size_t i = 0; i < plan->stepsSize; i++) {
+        const UA_InstantiationStep *step = &plan->steps[i];
+        if(step->parent == parent &&
+           step->browseName.namespaceIndex == browseName->namespaceIndex &&
+           UA_String_equal(&step->browseName.name, &browseName->name))
+            return i;
+    }
+    return plan->stepsSize;
+}
+
+/* Prepare the copy of a variable or object declaration. The checks that do
+ * not depend on the instance are done only once. */
+static UA_StatusCode
+prepareInstantiationStep(UA_Server *server, UA_Session *session,
+                         const UA_NodeId *parentSource, UA_InstantiationStep *step) {
+    UA_StatusCode retval = UA_NODESTORE_GETCOPY(server, &step->source, &step->node);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    retval = checkParentReference(server, session, &step->node->head,
+                                  parentSource, &step->referenceTypeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Remove the context and the NodeId. Keep only the modelling rule
+     * references. The others are added for every instance. */
+    step->node->head.context = NULL;
+    step->node->head.constructed = false;
+    UA_NodeId_clear(&step->node->head.nodeId);
+    const UA_ReferenceTypeSet keepRefs =
+        UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASMODELLINGRULE);
+    UA_Node_deleteReferencesSubset(step->node, &keepRefs);
+
+    /* Add the references directly only for a concrete TypeDefinition with the
+     * matching NodeClass. Otherwise AddNode_addRefs applies the default type
+     * and the rules for abstract types. */
+    step->checkRefs = true;
+    const UA_Node *type = UA_NODESTORE_GET(server, &step->typeDefinition);
+    if(!type)
+        return UA_STATUSCODE_GOOD;
+    if(step->nodeClass == UA_NODECLASS_OBJECT &&
+       type->head.nodeClass == UA_NODECLASS_OBJECTTYPE)
+        step->checkRefs = type->objectTypeNode.isAbstract;
+    else if(step->nodeClass == UA_NODECLASS_VARIABLE &&
+            type->head.nodeClass == UA_NODECLASS_VARIABLETYPE)
+        step->checkRefs = type->variableTypeNode.isAbstract;
+    step->typeDefinitionHash = UA_QualifiedName_hash(&type->head.browseName);
+    UA_NODESTORE_RELEASE(server, type);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Add the children of the source node to the plan */
+static UA_StatusCode
+addInstantiationSteps(UA_Server *server, UA_Session *session,
+                      UA_InstantiationPlan *plan, const UA_NodeId *source,
+                      size_t parent) {
+    /* Browse to get all children of the source */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = *source;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_AGGREGATES);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.nodeClassMask = UA_NODECLASS_OBJECT | UA_NODECLASS_VARIABLE | UA_NODECLASS_METHOD;
+    bd.resultMask = UA_BROWSERESULTMASK_REFERENCETYPEID | UA_BROWSERESULTMASK_NODECLASS |
+        UA_BROWSERESULTMASK_BROWSENAME | UA_BROWSERESULTMASK_TYPEDEFINITION;
+
+    UA_BrowseResult br;
+    UA_BrowseResult_init(&br);
+    UA_UInt32 maxrefs = 0;
+    Operation_Browse(server, session, &maxrefs, &bd, &br);
+    if(br.statusCode != UA_STATUSCODE_GOOD)
+        return br.statusCode;
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < br.referencesSize; ++i) {
+        UA_ReferenceDescription *rd = &br.references[i];
+
+        /* Merge the members into the existing child with that BrowseName */
+        size_t existing = findPlanStep(plan, parent, &rd->browseName);
+        if(existing < plan->stepsSize) {
+            if(rd->nodeClass == UA_NODECLASS_VARIABLE ||
+               rd->nodeClass == UA_NODECLASS_OBJECT)
+                retval = addInstantiationSteps(server, session, plan,
+                                               &rd->nodeId.nodeId, existing);
+            if(retval != UA_STATUSCODE_GOOD)
+                break;
+            continue;
+        }
+
+        /* Optional children are only considered if the callback can decide
+         * about them for every instance */
+        UA_Boolean mandatory = isMandatoryChild(server, session, &rd->nodeId.nodeId);
+        if(!mandatory && !server->config.nodeLifecycle.createOptionalChild)
+            continue;
+
+        /* Get the ReferenceTypeIndex */
+        const UA_Node *refType = UA_NODESTORE_GET(server, &rd->referenceTypeId);
+        if(!refType) {
+            retval = UA_STATUSCODE_BADREFERENCETYPEIDINVALID;
+            break;
+        }
+        UA_Byte refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
+        UA_Boolean isRefType = (refType->head.nodeClass == UA_NODECLASS_REFERENCETYPE);
+        UA_NODESTORE_RELEASE(server, refType);
+        if(!isRefType) {
+            retval = UA_STATUSCODE_BADREFERENCETYPEIDINVALID;
+            break;
+        }
+
+        /* Append the step */
+        UA_InstantiationStep *steps = (UA_InstantiationStep*)
+            UA_realloc(plan->steps, sizeof(UA_InstantiationStep) * (plan->stepsSize + 1));
+        if(!steps) {
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        plan->steps = steps;
+        size_t index = plan->stepsSize;
+        UA_InstantiationStep *step = &steps[index];
+        memset(step, 0, sizeof(UA_InstantiationStep));
+        plan->stepsSize++;
+        step->parent = parent;
+        step->refTypeIndex = refTypeIndex;
+        step->nodeClass = rd->nodeClass;
+        step->mandatory = mandatory;
+        step->browseNameHash = UA_QualifiedName_hash(&rd->browseName);
+        retval |= UA_NodeId_copy(&rd->nodeId.nodeId, &step->source);
+        retval |= UA_NodeId_copy(&rd->referenceTypeId, &step->referenceTypeId);
+        retval |= UA_NodeId_copy(&rd->typeDefinition.nodeId, &step->typeDefinition);
+        retval |= UA_QualifiedName_copy(&rd->browseName, &step->browseName);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+
+        /* Methods are referenced and not copied */
+        if(rd->nodeClass == UA_NODECLASS_METHOD)
+            continue;
+
+        /* Prepare the copy and add the members of the declaration. The steps
+         * array might be reallocated by the recursion. */
+        retval = prepareInstantiationStep(server, session, source, step);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+        retval = addInstantiationSteps(server, session, plan, &rd->nodeId.nodeId, index);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+    }
+
+    UA_BrowseResult_clear(&br);
+    return retval;
+}
+
+static UA_StatusCode
+InstantiationPlan_init(UA_Server *server, UA_Session *session,
+                       const UA_NodeId *typeId, UA_InstantiationPlan *plan) {
+    plan->steps = NULL;
+    plan->stepsSize = 0;
+
+    /* Get the hierarchy of the type and all its supertypes */
+    UA_NodeId *hierarchy = NULL;
+    size_t hierarchySize = 0;
+    UA_StatusCode retval =
+        getParentTypeAndInterfaceHierarchy(server, typeId, &hierarchy, &hierarchySize);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    for(size_t i = 0; i < hierarchySize; ++i) {
+        retval = addInstantiationSteps(server, session, plan, &hierarchy[i], UA_PLAN_ROOT);
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+    }
+
+    UA_Array_delete(hierarchy, hierarchySize, &UA_TYPES[UA_TYPES_NODEID]);
+    if(retval != UA_STATUSCODE_GOOD)
+        InstantiationPlan_clear(server, plan);
+    return retval;
+}
+
+static UA_StatusCode
+addPlanReference(UA_Server *server, UA_Session *session, const UA_NodeId *sourceId,
+                 UA_Byte refTypeIndex, UA_Boolean isForward,
+                 const UA_NodeId *targetId, UA_UInt32 targetNameHash) {
+    UA_ExpandedNodeId target;
+    UA_ExpandedNodeId_init(&target);
+    target.nodeId = *targetId;
+    struct AddNodeInfo info;
+    info.refTypeIndex = refTypeIndex;
+    info.isForward = isForward;
+    info.targetNodeId = &target;
+    info.targetBrowseNameHash = targetNameHash;
+    return UA_Server_editNode(server, session, sourceId,
+                              (UA_EditNodeCallback)addOneWayReference, &info);
+}
+
+/* Copy the declaration of a variable or object into the instance */
+static UA_StatusCode
+instantiateStep(UA_Server *server, UA_Session *session,
+                const UA_InstantiationStep *step, const UA_NodeId *parentId,
+                UA_UInt32 parentNameHash, UA_Boolean keepModellingRules,
+                UA_NodeId *outNewNodeId) {
+    UA_Node *node = UA_NODESTORE_NEW(server, step->nodeClass);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode retval = UA_Node_copy(step->node, node);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_NODESTORE_DELETE(server, node);
+        return retval;
+    }
+
+    if(!keepModellingRules) {
+        UA_ReferenceTypeSet noRefs;
+        UA_ReferenceTypeSet_init(&noRefs);
+        UA_Node_deleteReferencesSubset(node, &noRefs);
+    }
+
+    /* Random numeric id will be assigned in the nodestore */
+    node->head.nodeId.namespaceIndex = parentId->namespaceIndex;
+    if(server->config.nodeLifecycle.generateChildNodeId) {
+        UA_UNLOCK(&server->serviceMutex);
+        retval = server->config.nodeLifecycle.
+            generateChildNodeId(server, &session->sessionId, session->sessionHandle,
+                                &step->source, parentId, &step->referenceTypeId,
+                                &node->head.nodeId);
+        UA_LOCK(&server->serviceMutex);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_NODESTORE_DELETE(server, node);
+            return retval;
+        }
+    }
+
+    /* Add the references to the parent and the TypeDefinition before the node
+     * is inserted */
+    if(!step->checkRefs) {
+        UA_ExpandedNodeId target;
+        UA_ExpandedNodeId_init(&target);
+        target.nodeId = *parentId;
+        retval = UA_Node_addReference(node, step->refTypeIndex, false,
+                                      &target, parentNameHash);
+        target.nodeId = step->typeDefinition;
+        retval |= UA_Node_addReference(node, UA_REFERENCETYPEINDEX_HASTYPEDEFINITION,
+                                       true, &target, step->typeDefinitionHash);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_NODESTORE_DELETE(server, node);
+            return retval;
+        }
+    }
+
+    /* Add the node to the nodestore */
+    retval = UA_NODESTORE_INSERT(server, node, outNewNodeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    if(step->checkRefs) {
+        retval = AddNode_addRefs(server, session, outNewNodeId, parentId,
+                                 &step->referenceTypeId, &step->typeDefinition);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_NODESTORE_REMOVE(server, outNewNodeId);
+            UA_NodeId_clear(outNewNodeId);
+        }
+        return retval;
+    }
+
+    /* Add the opposite direction of the references */
+    retval = addPlanReference(server, session, parentId, step->refTypeIndex,
+                              true, outNewNodeId, step->browseNameHash);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = addPlanReference(server, session, &step->typeDefinition,
+                                  UA_REFERENCETYPEINDEX_HASTYPEDEFINITION, false,
+                                  outNewNodeId, step->browseNameHash);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteNode(server, *outNewNodeId, true);
+        UA_NodeId_clear(outNewNodeId);
+    }
+    return retval;
+}
+
+/* Create the children of the instance. The NodeIds of the instantiated steps
+ * are stored in the ids array. Skipped steps remain with a null NodeId. */
+static UA_StatusCode
+instantiatePlan(UA_Server *server, UA_Session *session,
+                const UA_InstantiationPlan *plan, const UA_NodeId *rootId,
+                UA_NodeId *ids) {
+    const UA_Node *root = UA_NODESTORE_GET(server, rootId);
+    if(!root)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_UInt32 rootNameHash = UA_QualifiedName_hash(&root->head.browseName);
+    UA_NODESTORE_RELEASE(server, root);
+
+    /* The modelling rules are kept for instance declarations (see copyChild).
+     * The children are connected to the root with aggregates references. */
+    const UA_NodeId typesFolder = UA_NODEID_NUMERIC(0, UA_NS0ID_TYPESFOLDER);
+    const UA_ReferenceTypeSet aggregates = UA_REFTYPESET(UA_REFERENCETYPEINDEX_AGGREGATES);
+    UA_Boolean keepModellingRules = server->config.modellingRulesOnInstances ||
+        isNodeInTree(server, rootId, &typesFolder, &aggregates);
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < plan->stepsSize; i++) {
+        const UA_InstantiationStep *step = &plan->steps[i];
+        const UA_NodeId *parentId = rootId;
+        UA_UInt32 parentNameHash = rootNameHash;
+        if(step->parent != UA_PLAN_ROOT) {
+            parentId = &ids[step->parent];
+            parentNameHash = plan->steps[step->parent].browseNameHash;
+            if(UA_NodeId_isNull(parentId))
+                continue; /* The parent was not instantiated */
+        }
+
+        /* Ask whether the optional child shall be instantiated */
+        if(!step->mandatory) {
+            UA_UNLOCK(&server->serviceMutex);
+            UA_Boolean createChild =
+                server->config.nodeLifecycle.createOptionalChild(server,
+                                                                 &session->sessionId,
+                                                                 session->sessionHandle,
+                                                                 &step->source, parentId,
+                                                                 &step->referenceTypeId);
+            UA_LOCK(&server->serviceMutex);
+            if(!createChild)
+                continue;
+        }
+
+        /* Reference the method in both directions */
+        if(step->nodeClass == UA_NODECLASS_METHOD) {
+            retval = addPlanReference(server, session, parentId, step->refTypeIndex,
+                                      true, &step->source, step->browseNameHash);
+            if(retval == UA_STATUSCODE_GOOD)
+                retval = addPlanReference(server, session, &step->source,
+                                          step->refTypeIndex, false, parentId,
+                                          parentNameHash);
+        } else {
+            retval = instantiateStep(server, session, step, parentId, parentNameHash,
+                                     keepModellingRules, &ids[i]);
+        }
+        if(retval != UA_STATUSCODE_GOOD)
+            break;
+    }
+    return retval;
+}
+
+/* Call the constructors. Children are created after their parent. So the
+ * reverse order constructs the children first. */
+static UA_StatusCode
+constructPlanInstance(UA_Server *server, UA_Session *session,
+                      const UA_InstantiationPlan *plan, const UA_NodeId *rootId,
+                      const UA_NodeId *ids, const UA_Node *type) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    for(size_t i = plan->stepsSize; i > 0; i--) {
+        if(UA_NodeId_isNull(&ids[i-1]))
+            continue;
+        const UA_Node *node = UA_NODESTORE_GET(server, &ids[i-1]);
+        if(!node)
+            return UA_STATUSCODE_BADNODEIDUNKNOWN;
+        if(node->head.constructed) {
+            UA_NODESTORE_RELEASE(server, node);
+            continue;
+        }
+        const UA_Node *nodeType = getNodeType(server, &node->head);
+        if(!nodeType) {
+            UA_NODESTORE_RELEASE(server, node);
+            return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+        }
+        retval = callConstructors(server, session, &node->head, nodeType);
+        UA_NODESTORE_RELEASE(server, nodeType);
+        UA_NODESTORE_RELEASE(server, node);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
+
+    const UA_Node *root = UA_NODESTORE_GET(server, rootId);
+    if(!root)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    if(!root->head.constructed)
+        retval = callConstructors(server, session, &root->head, type);
+    UA_NODESTORE_RELEASE(server, root);
+    return retval;
+}
+
+static UA_StatusCode
+addObjectInstance(UA_Server *server, UA_Session *session,
+                  const UA_InstantiationPlan *plan, const UA_Node *type,
+                  const UA_AddObjectNodesItem *instance, UA_NodeId *ids,
+                  UA_NodeId *outNewNodeId) {
+    UA_AddNodesItem item;
+    UA_AddNodesItem_init(&item);
+    item.nodeClass = UA_NODECLASS_OBJECT;
+    item.requestedNewNodeId.nodeId = instance->requestedNewNodeId;
+    item.browseName = instance->browseName;
+    item.typeDefinition.nodeId = type->head.nodeId;
+    UA_ExtensionObject_setValueNoDelete(&item.nodeAttributes,
+                                        (void*)(uintptr_t)&instance->attr,
+                                        &UA_TYPES[UA_TYPES_OBJECTATTRIBUTES]);
+
+    /* Add the object with the references to the parent and the type */
+    UA_NodeId newNodeId;
+    UA_StatusCode retval =
+        Operation_addNode_begin(server, session, instance->nodeContext, &item,
+                                &instance->parentNodeId, &instance->referenceTypeId,
+                                &newNodeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Copy the children and call the constructors */
+    retval = instantiatePlan(server, session, plan, &newNodeId, ids);
+    if(retval == UA_STATUSCODE_GOOD)
+        retval = constructPlanInstance(server, session, plan, &newNodeId, ids, type);
+    for(size_t i = 0; i < plan->stepsSize; i++)
+        UA_NodeId_clear(&ids[i]);
+
+    if(retval != UA_STATUSCODE_GOOD) {
+        logAddNode(&server->config.logger, session, &newNodeId,
+                   "Instantiating the ObjectType failed");
+        deleteNode(server, newNodeId, true);
+        UA_NodeId_clear(&newNodeId);
+        return retval;
+    }
+
+    if(outNewNodeId)
+        *outNewNodeId = newNodeId;
+    else
+        UA_NodeId_clear(&newNodeId);
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Server_addObjectNodes(UA_Server *server, const UA_NodeId typeDefinition,
+                         size_t itemsSize, const UA_AddObjectNodesItem *items,
+                         UA_StatusCode *results, UA_NodeId *outNewNodeIds) {
+    UA_LOCK(&server->serviceMutex);
+    UA_Session *session = &server->adminSession;
+
+    /* Get the ObjectType */
+    const UA_Node *type = UA_NODESTORE_GET(server, &typeDefinition);
+    if(!type) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+    }
+    if(type->head.nodeClass != UA_NODECLASS_OBJECTTYPE) {
+        UA_NODESTORE_RELEASE(server, type);
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_BADTYPEDEFINITIONINVALID;
+    }
+
+    /* Compute the plan once for all instances */
+    UA_InstantiationPlan plan;
+    UA_StatusCode retval = InstantiationPlan_init(server, session, &typeDefinition, &plan);
+    UA_NodeId *ids = NULL;
+    if(retval == UA_STATUSCODE_GOOD) {
+        ids = (UA_NodeId*)UA_Array_new(plan.stepsSize, &UA_TYPES[UA_TYPES_NODEID]);
+        if(!ids) {
+            InstantiationPlan_clear(server, &plan);
+            retval = UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO(&server->config.logger, UA_LOGCATEGORY_SERVER,
+                    "AddObjectNodes: Computing the instantiation plan failed "
+                    "with status code %s", UA_StatusCode_name(retval));
+        UA_NODESTORE_RELEASE(server, type);
+        UA_UNLOCK(&server->serviceMutex);
+        return retval;
+    }
+
+    /* Add the instances */
+    for(size_t i = 0; i < itemsSize; i++) {
+        results[i] = addObjectInstance(server, session, &plan, type, &items[i], ids,
+                                       outNewNodeIds ? &outNewNodeIds[i] : NULL);
+        if(results[i] != UA_STATUSCODE_GOOD && outNewNodeIds)
+            UA_NodeId_init(&outNewNodeIds[i]);
+    }
+
+    UA_Array_delete(ids, plan.stepsSize, &UA_TYPES[UA_TYPES_NODEID]);
+    InstantiationPlan_clear(server, &plan);
+    UA_NODESTORE_RELEASE(server, type);
+    UA_UNLOCK(&server->serviceMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
 /**********************/
 /* Set Value Callback */
 /**********************/
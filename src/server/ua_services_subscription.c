@@ -19,6 +19,7 @@
 #include "ua_server_internal.h"
 #include "ua_services.h"
 #include "ua_subscription.h"
+#include "ua_types_encoding_binary.h"
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
@@ -311,6 +312,25 @@ Service_DeleteSubscriptions(UA_Server *server, UA_Session *session,
                   &response->resultsSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
 }
 
+static UA_StatusCode
+getRetransmissionEntry(UA_Session *session, const UA_RepublishRequest *request,
+                       UA_NotificationMessageEntry **entry) {
+    /* Get the subscription */
+    UA_Subscription *sub = UA_Session_getSubscriptionById(session, request->subscriptionId);
+    if(!sub)
+        return UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID;
+
+    /* Reset the subscription lifetime */
+    sub->currentLifetimeCount = 0;
+
+    /* Find the notification in the retransmission queue  */
+    TAILQ_FOREACH(*entry, &sub->retransmissionQueue, listEntry) {
+        if((*entry)->sequenceNumber == request->retransmitSequenceNumber)
+            return UA_STATUSCODE_GOOD;
+    }
+    return UA_STATUSCODE_BADMESSAGENOTAVAILABLE;
+}
+
 void
 Service_Republish(UA_Server *server, UA_Session *session,
                   const UA_RepublishRequest *request,
@@ -319,29 +339,43 @@ Service_Republish(UA_Server *server, UA_Session *session,
                          "Processing RepublishRequest");
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-    /* Get the subscription */
-    UA_Subscription *sub = UA_Session_getSubscriptionById(session, request->subscriptionId);
-    if(!sub) {
-        response->responseHeader.serviceResult = UA_STATUSCODE_BADSUBSCRIPTIONIDINVALID;
+    UA_NotificationMessageEntry *entry = NULL;
+    response->responseHeader.serviceResult =
+        getRetransmissionEntry(session, request, &entry);
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
         return;
-    }
 
-    /* Reset the subscription lifetime */
-    sub->currentLifetimeCount = 0;
+    /* Decode the retained NotificationMessage */
+    size_t offset = 0;
+    response->responseHeader.serviceResult =
+        UA_decodeBinary(&entry->encoded, &offset, &response->notificationMessage,
+                        &UA_TYPES[UA_TYPES_NOTIFICATIONMESSAGE], NULL);
+}
 
-    /* Find the notification in the retransmission queue  */
-    UA_NotificationMessageEntry *entry;
-    TAILQ_FOREACH(entry, &sub->retransmissionQueue, listEntry) {
-        if(entry->message.sequenceNumber == request->retransmitSequenceNumber)
-            break;
-    }
-    if(!entry) {
-        response->responseHeader.serviceResult = UA_STATUSCODE_BADMESSAGENOTAVAILABLE;
-        return;
-    }
+UA_StatusCode
+Service_RepublishEncoded(UA_Server *server, UA_Session *session,
+                         const UA_RepublishRequest *request, UA_UInt32 requestId) {
+    UA_LOG_DEBUG_SESSION(&server->config.logger, session,
+                         "Processing RepublishRequest");
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-    response->responseHeader.serviceResult =
-        UA_NotificationMessage_copy(&entry->message, &response->notificationMessage);
+    UA_RepublishResponse response;
+    UA_RepublishResponse_init(&response);
+    response.responseHeader.requestHandle = request->requestHeader.requestHandle;
+
+    UA_NotificationMessageEntry *entry = NULL;
+    response.responseHeader.serviceResult =
+        getRetransmissionEntry(session, request, &entry);
+    if(response.responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+        return sendResponse(server, session, session->header.channel, requestId,
+                            (UA_Response*)&response, &UA_TYPES[UA_TYPES_REPUBLISHRESPONSE]);
+
+    /* Send the retained encoding of the NotificationMessage */
+    return sendResponseEncodedMember(server, session, session->header.channel, requestId,
+                                     (UA_Response*)&response,
+                                     &UA_TYPES[UA_TYPES_REPUBLISHRESPONSE],
+                                     UA_REPUBLISHRESPONSE_NOTIFICATIONMESSAGE,
+                                     &entry->encoded);
 }
 
 static UA_StatusCode
@@ -357,7 +391,7 @@ setTransferredSequenceNumbers(const UA_Subscription *sub, UA_TransferResult *res
     UA_NotificationMessageEntry *entry;
     size_t i = 0;
     TAILQ_FOREACH(entry, &sub->retransmissionQueue, listEntry) {
-        result->availableSequenceNumbers[i] = entry->message.sequenceNumber;
+        result->availableSequenceNumbers[i] = entry->sequenceNumber;
         i++;
     }
 
@@ -424,6 +458,11 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
      * that all backpointers are set correctly. */
     memcpy(newSub, sub, sizeof(UA_Subscription));
 
+    /* The cached allocations remain with the original subscription */
+    newSub->cachedRetransmissionEntry = NULL;
+    newSub->cachedNotificationData = NULL;
+    newSub->cachedDataChangeNotification = NULL;
+
     /* Register cyclic publish callback */
     result->statusCode = Subscription_registerPublishCallback(server, newSub);
     if(result->statusCode != UA_STATUSCODE_GOOD) {
@@ -447,6 +486,10 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
     }
     sub->monitoredItemsSize = 0;
 
+    /* The MonitoredItem index was taken over with the memcpy */
+    sub->monitoredItemsIndex = NULL;
+    sub->monitoredItemsIndexSize = 0;
+
     /* Move over the notification queue */
     TAILQ_INIT(&newSub->notificationQueue);
     UA_Notification *nn;
@@ -464,11 +507,15 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
     TAILQ_FOREACH_SAFE(nme, &sub->retransmissionQueue, listEntry, nme_tmp) {
         TAILQ_REMOVE(&sub->retransmissionQueue, nme, listEntry);
         TAILQ_INSERT_TAIL(&newSub->retransmissionQueue, nme, listEntry);
-        if(oldSession)
+        if(oldSession) {
             oldSession->totalRetransmissionQueueSize -= 1;
+            oldSession->totalRetransmissionQueueBytes -= nme->encoded.length;
+        }
         sub->retransmissionQueueSize -= 1;
+        sub->retransmissionQueueBytes -= nme->encoded.length;
     }
     UA_assert(sub->retransmissionQueueSize == 0);
+    UA_assert(sub->retransmissionQueueBytes == 0);
     sub->retransmissionQueueSize = 0;
 
     /* Add to the server */
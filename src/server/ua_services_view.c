@@ -134,9 +134,230 @@ isNodeInTreeNoCircular(UA_Server *server, const UA_NodeId *leafNode,
     return false;
 }
 
+/*****************/
+/* Subtype Index */
+/*****************/
+
+/* The type hierarchies are queried with isNodeInTree for every instantiation,
+ * every write (DataType compatibility) and every event filter. The transitive
+ * closure of the HasSubtype hierarchy is memoized for the type nodes. An entry
+ * holds pointers to the entries of all (direct and indirect) supertypes. That
+ * also covers multiple inheritance. The entries are computed when first
+ * queried. Adding or removing a HasSubtype reference drops the entire index if
+ * the subtype node has an entry. The type hierarchies are rarely changed after
+ * the information model has been loaded. */
+
+#define UA_SUBTYPEINDEX_MINSIZE 64
+
+struct UA_SubtypeEntry {
+    UA_SubtypeEntry *next;
+    UA_NodeId nodeId;
+    UA_UInt32 hash;
+    UA_Boolean computing; /* Detect circular HasSubtype references */
+    size_t supertypesSize;
+    UA_SubtypeEntry **supertypes;
+};
+
+static void
+deleteSubtypeEntry(UA_SubtypeEntry *entry) {
+    UA_NodeId_clear(&entry->nodeId);
+    UA_free(entry->supertypes);
+    UA_free(entry);
+}
+
+void
+clearSubtypeIndex(UA_Server *server) {
+    for(size_t i = 0; i < server->subtypeIndexSize; i++) {
+        UA_SubtypeEntry *entry = server->subtypeIndex[i];
+        while(entry) {
+            UA_SubtypeEntry *next = entry->next;
+            deleteSubtypeEntry(entry);
+            entry = next;
+        }
+    }
+    UA_free(server->subtypeIndex);
+    server->subtypeIndex = NULL;
+    server->subtypeIndexSize = 0;
+    server->subtypeIndexCount = 0;
+}
+
+static UA_SubtypeEntry *
+findSubtypeEntry(UA_Server *server, const UA_NodeId *nodeId, UA_UInt32 hash) {
+    if(server->subtypeIndexSize == 0)
+        return NULL;
+    UA_SubtypeEntry *entry =
+        server->subtypeIndex[hash & (server->subtypeIndexSize - 1)];
+    for(; entry; entry = entry->next) {
+        if(entry->hash == hash && UA_NodeId_equal(&entry->nodeId, nodeId))
+            return entry;
+    }
+    return NULL;
+}
+
+/* Keeps the old buckets if the allocation fails */
+static void
+resizeSubtypeIndex(UA_Server *server, size_t size) {
+    UA_SubtypeEntry **index = (UA_SubtypeEntry**)
+        UA_calloc(size, sizeof(UA_SubtypeEntry*));
+    if(!index)
+        return;
+    for(size_t i = 0; i < server->subtypeIndexSize; i++) {
+        UA_SubtypeEntry *entry = server->subtypeIndex[i];
+        while(entry) {
+            UA_SubtypeEntry *next = entry->next;
+            UA_SubtypeEntry **bucket = &index[entry->hash & (size - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    UA_free(server->subtypeIndex);
+    server->subtypeIndex = index;
+    server->subtypeIndexSize = size;
+}
+
+static void
+removeSubtypeEntry(UA_Server *server, UA_SubtypeEntry *entry) {
+    UA_SubtypeEntry **prev =
+        &server->subtypeIndex[entry->hash & (server->subtypeIndexSize - 1)];
+    while(*prev != entry)
+        prev = &(*prev)->next;
+    *prev = entry->next;
+    server->subtypeIndexCount--;
+    deleteSubtypeEntry(entry);
+}
+
+/* Add the supertype and its closure to the entry. Supertypes reached via
+ * several paths are added only once. */
+static UA_StatusCode
+addSupertypes(UA_SubtypeEntry *entry, UA_SubtypeEntry *super) {
+    UA_SubtypeEntry **supertypes = (UA_SubtypeEntry**)
+        UA_realloc(entry->supertypes, sizeof(UA_SubtypeEntry*) *
+                   (entry->supertypesSize + super->supertypesSize + 1));
+    if(!supertypes)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    entry->supertypes = supertypes;
+    size_t oldSize = entry->supertypesSize;
+    for(size_t i = 0; i <= super->supertypesSize; i++) {
+        UA_SubtypeEntry *s = (i < super->supertypesSize) ? super->supertypes[i] : super;
+        size_t j = 0;
+        for(; j < oldSize; j++) {
+            if(supertypes[j] == s)
+                break;
+        }
+        if(j == oldSize)
+            supertypes[entry->supertypesSize++] = s;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Returns NULL if the node is no type node or if the hierarchy above cannot be
+ * resolved (missing nodes, circular references, too deep). Then the caller
+ * falls back to walking the references. */
+static UA_SubtypeEntry *
+getSubtypeEntry(UA_Server *server, const UA_NodeId *nodeId, UA_UInt16 depth) {
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    UA_SubtypeEntry *entry = findSubtypeEntry(server, nodeId, hash);
+    if(entry)
+        return (entry->computing) ? NULL : entry;
+
+    if(depth >= UA_MAX_TREE_RECURSE)
+        return NULL;
+
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node)
+        return NULL;
+    if(node->head.nodeClass != UA_NODECLASS_OBJECTTYPE &&
+       node->head.nodeClass != UA_NODECLASS_VARIABLETYPE &&
+       node->head.nodeClass != UA_NODECLASS_DATATYPE &&
+       node->head.nodeClass != UA_NODECLASS_REFERENCETYPE) {
+        UA_NODESTORE_RELEASE(server, node);
+        return NULL;
+    }
+
+    /* Insert the entry before recursing to detect cycles */
+    if(server->subtypeIndexCount >= server->subtypeIndexSize)
+        resizeSubtypeIndex(server, (server->subtypeIndexSize > 0) ?
+                           server->subtypeIndexSize * 2 : UA_SUBTYPEINDEX_MINSIZE);
+    entry = (UA_SubtypeEntry*)UA_calloc(1, sizeof(UA_SubtypeEntry));
+    if(!entry || server->subtypeIndexSize == 0 ||
+       UA_NodeId_copy(nodeId, &entry->nodeId) != UA_STATUSCODE_GOOD) {
+        UA_free(entry);
+        UA_NODESTORE_RELEASE(server, node);
+        return NULL;
+    }
+    entry->hash = hash;
+    entry->computing = true;
+    UA_SubtypeEntry **bucket =
+        &server->subtypeIndex[hash & (server->subtypeIndexSize - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    server->subtypeIndexCount++;
+
+    /* Collect the closure of the supertypes */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < node->head.referencesSize && res == UA_STATUSCODE_GOOD; i++) {
+        UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(!rk->isInverse || rk->referenceTypeIndex != UA_REFERENCETYPEINDEX_HASSUBTYPE)
+            continue;
+        for(UA_ReferenceTarget *target = UA_NodeReferenceKind_firstTarget(rk);
+            target; target = UA_NodeReferenceKind_nextTarget(rk, target)) {
+            if(!UA_ExpandedNodeId_isLocal(&target->targetId))
+                continue;
+            UA_SubtypeEntry *super =
+                getSubtypeEntry(server, &target->targetId.nodeId, (UA_UInt16)(depth + 1));
+            if(!super) {
+                res = UA_STATUSCODE_BADINTERNALERROR;
+                break;
+            }
+            res = addSupertypes(entry, super);
+            if(res != UA_STATUSCODE_GOOD)
+                break;
+        }
+    }
+    UA_NODESTORE_RELEASE(server, node);
+
+    if(res != UA_STATUSCODE_GOOD) {
+        removeSubtypeEntry(server, entry);
+        return NULL;
+    }
+    entry->computing = false;
+    return entry;
+}
+
+void
+invalidateSubtypeIndex(UA_Server *server, const UA_NodeId *subtype) {
+    if(server->subtypeIndexCount == 0)
+        return;
+    /* The entries of all subtypes point to the entry. So if there is no entry,
+     * then the node is not part of any memoized closure. */
+    if(findSubtypeEntry(server, subtype, UA_NodeId_hash(subtype)))
+        clearSubtypeIndex(server);
+}
+
 UA_Boolean
 isNodeInTree(UA_Server *server, const UA_NodeId *leafNode,
              const UA_NodeId *nodeToFind, const UA_ReferenceTypeSet *relevantRefs) {
+    /* Use the subtype index for the type hierarchies */
+    UA_ReferenceTypeSet hasSubtype = UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE);
+    if(memcmp(relevantRefs, &hasSubtype, sizeof(UA_ReferenceTypeSet)) == 0) {
+        if(UA_NodeId_equal(nodeToFind, leafNode))
+            return true;
+        UA_SubtypeEntry *leaf = getSubtypeEntry(server, leafNode, 0);
+        if(leaf) {
+            /* All supertypes of the leaf have an entry */
+            UA_SubtypeEntry *find =
+                findSubtypeEntry(server, nodeToFind, UA_NodeId_hash(nodeToFind));
+            if(!find)
+                return false;
+            for(size_t i = 0; i < leaf->supertypesSize; i++) {
+                if(leaf->supertypes[i] == find)
+                    return true;
+            }
+            return false;
+        }
+    }
+
     struct ref_history visitedRefs = {NULL, leafNode, 0};
     return isNodeInTreeNoCircular(server, leafNode, nodeToFind, &visitedRefs, relevantRefs);
 }
@@ -899,26 +1120,6 @@ UA_Server_browseNext(UA_Server *server, UA_Boolean releaseContinuationPoint,
 /* TranslateBrowsePath */
 /***********************/
 
-/* Find all entries for that hash. There are duplicate for the possible hash
- * collisions. The exact browsename is checked afterwards. */
-static UA_StatusCode
-recursiveAddBrowseHashTarget(RefTree *results, struct aa_head *head,
-                             const UA_ReferenceTarget *rt) {
-    UA_assert(rt);
-    UA_StatusCode res = RefTree_add(results, &rt->targetId, NULL);
-    UA_ReferenceTarget *prev = (UA_ReferenceTarget*)aa_prev(head, rt);
-    while(prev && prev->targetNameHash == rt->targetNameHash) {
-        res |= RefTree_add(results, &prev->targetId, NULL);
-        prev = (UA_ReferenceTarget*)aa_prev(head, prev);
-    }
-    UA_ReferenceTarget *next= (UA_ReferenceTarget*)aa_next(head, rt);
-    while(next && next->targetNameHash == rt->targetNameHash) {
-        res |= RefTree_add(results, &next->targetId, NULL);
-        next = (UA_ReferenceTarget*)aa_next(head, next);
-    }
-    return res;
-}
-
 static UA_StatusCode
 walkBrowsePathElement(UA_Server *server, UA_Session *session,
                       const UA_RelativePath *path, const size_t pathIndex,
@@ -940,8 +1141,6 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
             return UA_STATUSCODE_BADNOMATCH;
     }
 
-    struct aa_head _refNameTree = refNameTree;
-
     /* Loop over all Nodes in the current depth level */
     for(size_t i = 0; i < current->size; i++) {
         /* Remote Node. Immediately add to the results with the RemainingPathIndex set. */
@@ -999,13 +1198,13 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
              * the hash matches. The exact BrowseName will be verified in the
              * next iteration of the outer loop. So we only have to retrieve
              * every node just once. */
-            _refNameTree.root = rk->nameTreeRoot;
-            UA_ReferenceTarget *rt = (UA_ReferenceTarget*)
-                aa_find(&_refNameTree, &browseNameHash);
-            if(!rt)
-                continue;
-
-            res = recursiveAddBrowseHashTarget(next, &_refNameTree, rt);
+            for(UA_ReferenceTarget *rt =
+                    UA_NodeReferenceKind_nextTargetByName(rk, browseNameHash, NULL);
+                rt; rt = UA_NodeReferenceKind_nextTargetByName(rk, browseNameHash, rt)) {
+                res = RefTree_add(next, &rt->targetId, NULL);
+                if(res != UA_STATUSCODE_GOOD)
+                    break;
+            }
             if(res != UA_STATUSCODE_GOOD)
                 break;
         }
@@ -1015,34 +1214,16 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
     return res;
 }
 
+/* Walk the path elements starting at pathIndex. The seeds are the targets of
+ * the path elements before (or the starting node). Remote targets are added to
+ * the results with the RemainingPathIndex. If remote targets were found, the
+ * result cannot be the prefix for longer paths. */
 static void
-Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
-                                       const UA_UInt32 *nodeClassMask,
-                                       const UA_BrowsePath *path,
-                                       UA_BrowsePathResult *result) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
-
-    if(path->relativePath.elementsSize <= 0) {
-        result->statusCode = UA_STATUSCODE_BADNOTHINGTODO;
-        return;
-    }
-
-    /* RelativePath elements must not have an empty targetName */
-    for(size_t i = 0; i < path->relativePath.elementsSize; ++i) {
-        if(UA_QualifiedName_isNull(&path->relativePath.elements[i].targetName)) {
-            result->statusCode = UA_STATUSCODE_BADBROWSENAMEINVALID;
-            return;
-        }
-    }
-
-    /* Check if the starting node exists */
-    const UA_Node *startingNode = UA_NODESTORE_GET(server, &path->startingNode);
-    if(!startingNode) {
-        result->statusCode = UA_STATUSCODE_BADNODEIDUNKNOWN;
-        return;
-    }
-    UA_NODESTORE_RELEASE(server, startingNode);
-
+walkBrowsePath(UA_Server *server, UA_Session *session,
+               const UA_ExpandedNodeId *seeds, size_t seedsSize,
+               const UA_RelativePath *path, size_t pathIndex,
+               UA_UInt32 nodeClassMask, UA_BrowsePathResult *result,
+               UA_Boolean *extendable) {
     /* Create two RefTrees that are alternated between path elements */
     RefTree rt1, rt2, *current = &rt1, *next = &rt2, *tmp;
     result->statusCode |= RefTree_init(&rt1);
@@ -1052,17 +1233,16 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
     if(result->statusCode != UA_STATUSCODE_GOOD)
         goto cleanup;
 
-    /* Copy the starting node into next */
-    UA_ExpandedNodeId startingNodeId;
-    UA_ExpandedNodeId_init(&startingNodeId);
-    startingNodeId.nodeId = path->startingNode;
-    result->statusCode = RefTree_add(next, &startingNodeId, NULL);
-    if(result->statusCode != UA_STATUSCODE_GOOD)
-        goto cleanup;
+    /* Copy the seeds into next */
+    for(size_t i = 0; i < seedsSize; i++) {
+        result->statusCode = RefTree_add(next, &seeds[i], NULL);
+        if(result->statusCode != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
 
     /* Walk the path elements. Retrieve the nodes only once from the NodeStore.
      * Hence the BrowseName is checked with one element "delay". */
-    for(size_t i = 0; i < path->relativePath.elementsSize; i++) {
+    for(size_t i = pathIndex; i < path->elementsSize; i++) {
         /* Switch the trees */
         tmp = current;
         current = next;
@@ -1080,13 +1260,16 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
 
         /* Walk element for all NodeIds in the "current" tree.
          * Puts new results in the "next" tree. */
+        size_t targetsBefore = result->targetsSize;
         result->statusCode =
-            walkBrowsePathElement(server, session, &path->relativePath, i,
-                                  *nodeClassMask, browseNameFilter, result, current, next);
+            walkBrowsePathElement(server, session, path, i, nodeClassMask,
+                                  browseNameFilter, result, current, next);
+        if(result->targetsSize != targetsBefore)
+            *extendable = false;
         if(result->statusCode != UA_STATUSCODE_GOOD)
             goto cleanup;
 
-        browseNameFilter = &path->relativePath.elements[i].targetName;
+        browseNameFilter = &path->elements[i].targetName;
     }
 
     /* Allocate space for the results array */
@@ -1100,6 +1283,9 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
     result->targets = tmpResults;
 
     for(size_t k = 0; k < next->size; k++) {
+        if(!UA_ExpandedNodeId_isLocal(&next->targets[k]))
+            *extendable = false;
+
         /* Check the BrowseName. It has been filtered only via its hash so far. */
         const UA_Node *node = UA_NODESTORE_GET(server, &next->targets[k].nodeId);
         if(!node)
@@ -1134,6 +1320,279 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
     }
 }
 
+/********************/
+/* BrowsePath Cache */
+/********************/
+
+#define UA_BROWSEPATHCACHE_MINSIZE 64
+
+struct UA_BrowsePathCacheEntry {
+    UA_BrowsePathCacheEntry *next;
+    UA_UInt32 hash;
+    UA_UInt32 generation;
+    UA_UInt32 nodeClassMask;
+    UA_Boolean extendable; /* The result can be used for longer paths */
+    UA_NodeId startingNode;
+    UA_RelativePath path;
+    UA_BrowsePathResult result;
+};
+
+static void
+deleteBrowsePathCacheEntry(UA_BrowsePathCacheEntry *entry) {
+    UA_NodeId_clear(&entry->startingNode);
+    UA_RelativePath_clear(&entry->path);
+    UA_BrowsePathResult_clear(&entry->result);
+    UA_free(entry);
+}
+
+void
+clearBrowsePathCache(UA_Server *server) {
+    for(size_t i = 0; i < server->browsePathCacheSize; i++) {
+        UA_BrowsePathCacheEntry *entry = server->browsePathCache[i];
+        while(entry) {
+            UA_BrowsePathCacheEntry *next = entry->next;
+            deleteBrowsePathCacheEntry(entry);
+            entry = next;
+        }
+    }
+    UA_free(server->browsePathCache);
+    server->browsePathCache = NULL;
+    server->browsePathCacheSize = 0;
+    server->browsePathCacheCount = 0;
+}
+
+void
+invalidateBrowsePathCache(UA_Server *server) {
+    /* Outdated entries could match again after the overflow */
+    server->browsePathCacheGeneration++;
+    if(server->browsePathCacheGeneration == 0)
+        clearBrowsePathCache(server);
+}
+
+static UA_UInt32
+hashBrowsePath(const UA_NodeId *startingNode, const UA_RelativePath *path,
+               UA_UInt32 nodeClassMask) {
+    UA_UInt32 h = UA_NodeId_hash(startingNode) ^ nodeClassMask;
+    for(size_t i = 0; i < path->elementsSize; i++) {
+        const UA_RelativePathElement *elem = &path->elements[i];
+        UA_UInt32 eh[3];
+        eh[0] = UA_NodeId_hash(&elem->referenceTypeId);
+        eh[1] = UA_QualifiedName_hash(&elem->targetName);
+        eh[2] = (UA_UInt32)elem->isInverse | ((UA_UInt32)elem->includeSubtypes << 1);
+        h = UA_ByteString_hash(h, (const UA_Byte*)eh, sizeof(eh));
+    }
+    return h;
+}
+
+static UA_Boolean
+relativePathEqual(const UA_RelativePath *p1, const UA_RelativePath *p2) {
+    if(p1->elementsSize != p2->elementsSize)
+        return false;
+    for(size_t i = 0; i < p1->elementsSize; i++) {
+        const UA_RelativePathElement *e1 = &p1->elements[i];
+        const UA_RelativePathElement *e2 = &p2->elements[i];
+        if(e1->isInverse != e2->isInverse ||
+           e1->includeSubtypes != e2->includeSubtypes ||
+           !UA_NodeId_equal(&e1->referenceTypeId, &e2->referenceTypeId) ||
+           !UA_QualifiedName_equal(&e1->targetName, &e2->targetName))
+            return false;
+    }
+    return true;
+}
+
+/* Returns only entries of the current generation. Outdated entries are
+ * removed. */
+static UA_BrowsePathCacheEntry *
+findBrowsePathCacheEntry(UA_Server *server, const UA_NodeId *startingNode,
+                         const UA_RelativePath *path, UA_UInt32 nodeClassMask,
+                         UA_UInt32 hash) {
+    if(server->browsePathCacheSize == 0)
+        return NULL;
+    UA_BrowsePathCacheEntry **prev =
+        &server->browsePathCache[hash & (server->browsePathCacheSize - 1)];
+    for(UA_BrowsePathCacheEntry *entry = *prev; entry; entry = *prev) {
+        if(entry->hash == hash && entry->nodeClassMask == nodeClassMask &&
+           UA_NodeId_equal(&entry->startingNode, startingNode) &&
+           relativePathEqual(&entry->path, path)) {
+            if(entry->generation == server->browsePathCacheGeneration)
+                return entry;
+            *prev = entry->next;
+            server->browsePathCacheCount--;
+            deleteBrowsePathCacheEntry(entry);
+            return NULL;
+        }
+        prev = &entry->next;
+    }
+    return NULL;
+}
+
+/* Keeps the old buckets if the allocation fails */
+static void
+resizeBrowsePathCache(UA_Server *server, size_t size) {
+    UA_BrowsePathCacheEntry **cache = (UA_BrowsePathCacheEntry**)
+        UA_calloc(size, sizeof(UA_BrowsePathCacheEntry*));
+    if(!cache)
+        return;
+    for(size_t i = 0; i < server->browsePathCacheSize; i++) {
+        UA_BrowsePathCacheEntry *entry = server->browsePathCache[i];
+        while(entry) {
+            UA_BrowsePathCacheEntry *next = entry->next;
+            UA_BrowsePathCacheEntry **bucket = &cache[entry->hash & (size - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    UA_free(server->browsePathCache);
+    server->browsePathCache = cache;
+    server->browsePathCacheSize = size;
+}
+
+/* Failing to cache the result is not an error */
+static void
+addBrowsePathCacheEntry(UA_Server *server, const UA_NodeId *startingNode,
+                        const UA_RelativePath *path, UA_UInt32 nodeClassMask,
+                        UA_UInt32 hash, const UA_BrowsePathResult *result,
+                        UA_Boolean extendable) {
+    /* Start over when the cache is full. Outdated entries are dropped as well. */
+    if(server->browsePathCacheCount >= server->config.maxBrowsePathCacheSize)
+        clearBrowsePathCache(server);
+
+    if(server->browsePathCacheCount >= server->browsePathCacheSize)
+        resizeBrowsePathCache(server, (server->browsePathCacheSize > 0) ?
+                              server->browsePathCacheSize * 2 :
+                              UA_BROWSEPATHCACHE_MINSIZE);
+    if(server->browsePathCacheSize == 0)
+        return;
+
+    UA_BrowsePathCacheEntry *entry = (UA_BrowsePathCacheEntry*)
+        UA_calloc(1, sizeof(UA_BrowsePathCacheEntry));
+    if(!entry)
+        return;
+    UA_StatusCode res = UA_NodeId_copy(startingNode, &entry->startingNode);
+    res |= UA_RelativePath_copy(path, &entry->path);
+    res |= UA_BrowsePathResult_copy(result, &entry->result);
+    if(res != UA_STATUSCODE_GOOD) {
+        deleteBrowsePathCacheEntry(entry);
+        return;
+    }
+    entry->hash = hash;
+    entry->generation = server->browsePathCacheGeneration;
+    entry->nodeClassMask = nodeClassMask;
+    entry->extendable = extendable;
+    UA_BrowsePathCacheEntry **bucket =
+        &server->browsePathCache[hash & (server->browsePathCacheSize - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    server->browsePathCacheCount++;
+}
+
+/* Resolve the path from the cache. Otherwise resolve the prefix without the
+ * last element first (which is then cached as well) and walk only the last
+ * element. So paths with a common prefix are resolved like in a trie: every
+ * prefix is walked only once. */
+static void
+translateBrowsePath(UA_Server *server, UA_Session *session,
+                    const UA_NodeId *startingNode, const UA_RelativePath *path,
+                    UA_UInt32 nodeClassMask, UA_BrowsePathResult *result,
+                    UA_Boolean *extendable) {
+    *extendable = true;
+    UA_ExpandedNodeId start;
+    UA_ExpandedNodeId_init(&start);
+    start.nodeId = *startingNode;
+
+    /* Every prefix of a path is cached. Don't cache very long paths. */
+    if(server->config.maxBrowsePathCacheSize == 0 ||
+       path->elementsSize > UA_MAX_TREE_RECURSE) {
+        walkBrowsePath(server, session, &start, 1, path, 0,
+                       nodeClassMask, result, extendable);
+        return;
+    }
+
+    UA_UInt32 hash = hashBrowsePath(startingNode, path, nodeClassMask);
+    UA_BrowsePathCacheEntry *entry =
+        findBrowsePathCacheEntry(server, startingNode, path, nodeClassMask, hash);
+    if(entry) {
+        *extendable = entry->extendable;
+        UA_StatusCode res = UA_BrowsePathResult_copy(&entry->result, result);
+        if(res != UA_STATUSCODE_GOOD)
+            result->statusCode = res;
+        return;
+    }
+
+    /* Resolve the prefix */
+    UA_BrowsePathResult prefixResult;
+    UA_BrowsePathResult_init(&prefixResult);
+    UA_Boolean prefixExtendable = false;
+    if(path->elementsSize > 1) {
+        UA_RelativePath prefix = *path;
+        prefix.elementsSize--;
+        translateBrowsePath(server, session, startingNode, &prefix, nodeClassMask,
+                            &prefixResult, &prefixExtendable);
+    }
+
+    /* Continue from the targets of the prefix. Otherwise walk the entire path. */
+    if(prefixExtendable && prefixResult.statusCode == UA_STATUSCODE_GOOD) {
+        UA_ExpandedNodeId *seeds = (UA_ExpandedNodeId*)
+            UA_malloc(sizeof(UA_ExpandedNodeId) * prefixResult.targetsSize);
+        if(!seeds) {
+            UA_BrowsePathResult_clear(&prefixResult);
+            result->statusCode = UA_STATUSCODE_BADOUTOFMEMORY;
+            return;
+        }
+        for(size_t i = 0; i < prefixResult.targetsSize; i++)
+            seeds[i] = prefixResult.targets[i].targetId;
+        walkBrowsePath(server, session, seeds, prefixResult.targetsSize, path,
+                       path->elementsSize - 1, nodeClassMask, result, extendable);
+        UA_free(seeds);
+    } else if(prefixExtendable && prefixResult.statusCode == UA_STATUSCODE_BADNOMATCH) {
+        result->statusCode = UA_STATUSCODE_BADNOMATCH;
+    } else {
+        walkBrowsePath(server, session, &start, 1, path, 0,
+                       nodeClassMask, result, extendable);
+    }
+    UA_BrowsePathResult_clear(&prefixResult);
+
+    /* Cache the result. Don't cache internal errors. */
+    if(result->statusCode == UA_STATUSCODE_GOOD ||
+       result->statusCode == UA_STATUSCODE_BADNOMATCH)
+        addBrowsePathCacheEntry(server, startingNode, path, nodeClassMask,
+                                hash, result, *extendable);
+}
+
+static void
+Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
+                                       const UA_UInt32 *nodeClassMask,
+                                       const UA_BrowsePath *path,
+                                       UA_BrowsePathResult *result) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    if(path->relativePath.elementsSize <= 0) {
+        result->statusCode = UA_STATUSCODE_BADNOTHINGTODO;
+        return;
+    }
+
+    /* RelativePath elements must not have an empty targetName */
+    for(size_t i = 0; i < path->relativePath.elementsSize; ++i) {
+        if(UA_QualifiedName_isNull(&path->relativePath.elements[i].targetName)) {
+            result->statusCode = UA_STATUSCODE_BADBROWSENAMEINVALID;
+            return;
+        }
+    }
+
+    /* Check if the starting node exists */
+    const UA_Node *startingNode = UA_NODESTORE_GET(server, &path->startingNode);
+    if(!startingNode) {
+        result->statusCode = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        return;
+    }
+    UA_NODESTORE_RELEASE(server, startingNode);
+
+    UA_Boolean extendable;
+    translateBrowsePath(server, session, &path->startingNode, &path->relativePath,
+                        *nodeClassMask, result, &extendable);
+}
+
 UA_BrowsePathResult
 translateBrowsePathToNodeIds(UA_Server *server,
                                        const UA_BrowsePath *browsePath) {
@@ -1238,7 +1697,6 @@ void Service_RegisterNodes(UA_Server *server, UA_Session *session,
                          "Processing RegisterNodesRequest");
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-    //TODO: hang the nodeids to the session if really needed
     if(request->nodesToRegisterSize == 0) {
         response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
         return;
@@ -1251,11 +1709,41 @@ void Service_RegisterNodes(UA_Server *server, UA_Session *session,
         return;
     }
 
-    response->responseHeader.serviceResult =
-        UA_Array_copy(request->nodesToRegister, request->nodesToRegisterSize,
-                      (void**)&response->registeredNodeIds, &UA_TYPES[UA_TYPES_NODEID]);
-    if(response->responseHeader.serviceResult == UA_STATUSCODE_GOOD)
-        response->registeredNodeIdsSize = request->nodesToRegisterSize;
+    response->registeredNodeIds = (UA_NodeId*)
+        UA_Array_new(request->nodesToRegisterSize, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_Boolean *added = (UA_Boolean*)
+        UA_calloc(request->nodesToRegisterSize, sizeof(UA_Boolean));
+    if(!response->registeredNodeIds || !added) {
+        UA_free(response->registeredNodeIds);
+        response->registeredNodeIds = NULL;
+        UA_free(added);
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADOUTOFMEMORY;
+        return;
+    }
+    response->registeredNodeIdsSize = request->nodesToRegisterSize;
+
+    /* Return handles that point directly to the (pinned) nodes */
+    for(size_t i = 0; i < request->nodesToRegisterSize; i++) {
+        UA_StatusCode retval =
+            UA_Session_registerNode(server, session, &request->nodesToRegister[i],
+                                    &response->registeredNodeIds[i], &added[i]);
+        if(retval == UA_STATUSCODE_GOOD)
+            continue;
+        /* Roll back the registrations of this request. Handles that were
+         * registered before remain. */
+        for(size_t j = 0; j < i; j++) {
+            if(added[j])
+                UA_Session_unregisterNode(server, session,
+                                          &response->registeredNodeIds[j]);
+        }
+        UA_Array_delete(response->registeredNodeIds, response->registeredNodeIdsSize,
+                        &UA_TYPES[UA_TYPES_NODEID]);
+        response->registeredNodeIds = NULL;
+        response->registeredNodeIdsSize = 0;
+        response->responseHeader.serviceResult = retval;
+        break;
+    }
+    UA_free(added);
 }
 
 void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
@@ -1265,7 +1753,6 @@ void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
                          "Processing UnRegisterNodesRequest");
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-    //TODO: remove the nodeids from the session if really needed
     if(request->nodesToUnregisterSize == 0)
         response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
 
@@ -1275,4 +1762,8 @@ void Service_UnregisterNodes(UA_Server *server, UA_Session *session,
         response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
         return;
     }
+
+    /* NodeIds that are not handles of the session are ignored */
+    for(size_t i = 0; i < request->nodesToUnregisterSize; i++)
+        UA_Session_unregisterNode(server, session, &request->nodesToUnregister[i]);
 }
@@ -49,6 +49,22 @@ void UA_Session_clear(UA_Session *session, UA_Server* server) {
     }
     session->continuationPoints = NULL;
     session->availableContinuationPoints = UA_MAXCONTINUATIONPOINTS;
+
+    /* Release the registered nodes */
+    for(size_t i = 0; i < session->registeredNodesSize; i++) {
+        UA_RegisteredNode *rn = &session->registeredNodes[i];
+        if(!rn->used)
+            continue;
+        if(rn->node)
+            UA_NODESTORE_RELEASE(server, rn->node);
+        UA_NodeId_clear(&rn->nodeId);
+    }
+    UA_assert(server->registeredNodesSize >= session->registeredNodesUsed);
+    server->registeredNodesSize -= session->registeredNodesUsed;
+    UA_free(session->registeredNodes);
+    session->registeredNodes = NULL;
+    session->registeredNodesSize = 0;
+    session->registeredNodesUsed = 0;
 }
 
 void
@@ -73,6 +89,206 @@ UA_Session_detachFromSecureChannel(UA_Session *session) {
     }
 }
 
+UA_StatusCode
+UA_Session_registerNode(UA_Server *server, UA_Session *session,
+                        const UA_NodeId *nodeId, UA_NodeId *handle,
+                        UA_Boolean *added) {
+    *added = false;
+
+    /* Already a handle */
+    if(UA_Session_getRegisteredNode(session, nodeId))
+        return UA_NodeId_copy(nodeId, handle);
+
+    /* Already registered. Reuse the handle. */
+    for(size_t i = 0; i < session->registeredNodesSize; i++) {
+        UA_RegisteredNode *rn = &session->registeredNodes[i];
+        if(rn->used && !rn->removed && UA_NodeId_equal(&rn->nodeId, nodeId)) {
+            *handle = UA_NODEID_NUMERIC(UA_REGISTEREDNODES_NAMESPACE, (UA_UInt32)i + 1);
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
+    /* The table of registered nodes is full */
+    if(server->config.maxRegisteredNodesPerSession != 0 &&
+       session->registeredNodesUsed >= server->config.maxRegisteredNodesPerSession)
+        return UA_STATUSCODE_BADTOOMANYOPERATIONS;
+
+    /* Pin the node */
+    const UA_Node *node = UA_NODESTORE_GET(server, nodeId);
+    if(!node)
+        return UA_NodeId_copy(nodeId, handle);
+#if defined(UA_ENABLE_IMMUTABLE_NODES) || UA_MULTITHREADING >= 100
+    /* Don't keep the node pinned. Immutable nodes are replaced for every edit.
+     * With multithreading, the node could be unregistered by another thread
+     * while it is in use. The handle resolves to the NodeId instead. */
+    UA_NODESTORE_RELEASE(server, node);
+    node = NULL;
+#endif
+
+    /* Find a free slot. Grow the table if it is full. */
+    size_t index = 0;
+    if(session->registeredNodesUsed < session->registeredNodesSize) {
+        while(session->registeredNodes[index].used)
+            index++;
+    } else {
+        size_t newSize = session->registeredNodesSize * 2;
+        if(newSize == 0)
+            newSize = 8;
+        UA_RegisteredNode *newTable = (UA_RegisteredNode*)
+            UA_realloc(session->registeredNodes, newSize * sizeof(UA_RegisteredNode));
+        if(!newTable) {
+            if(node)
+                UA_NODESTORE_RELEASE(server, node);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        memset(&newTable[session->registeredNodesSize], 0,
+               (newSize - session->registeredNodesSize) * sizeof(UA_RegisteredNode));
+        index = session->registeredNodesSize;
+        session->registeredNodes = newTable;
+        session->registeredNodesSize = newSize;
+    }
+
+    UA_RegisteredNode *rn = &session->registeredNodes[index];
+    UA_StatusCode retval = UA_NodeId_copy(nodeId, &rn->nodeId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        if(node)
+            UA_NODESTORE_RELEASE(server, node);
+        return retval;
+    }
+    rn->node = node;
+    rn->used = true;
+    rn->removed = false;
+    session->registeredNodesUsed++;
+    server->registeredNodesSize++;
+    *handle = UA_NODEID_NUMERIC(UA_REGISTEREDNODES_NAMESPACE, (UA_UInt32)index + 1);
+    *added = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_Session_unregisterNode(UA_Server *server, UA_Session *session,
+                          const UA_NodeId *handle) {
+    UA_RegisteredNode *rn = UA_Session_getRegisteredNode(session, handle);
+    if(!rn)
+        return;
+    if(rn->node)
+        UA_NODESTORE_RELEASE(server, rn->node);
+    UA_NodeId_clear(&rn->nodeId);
+    memset(rn, 0, sizeof(UA_RegisteredNode));
+    session->registeredNodesUsed--;
+    server->registeredNodesSize--;
+}
+
+UA_RegisteredNode *
+UA_Session_getRegisteredNode(UA_Session *session, const UA_NodeId *handle) {
+    if(handle->namespaceIndex != UA_REGISTEREDNODES_NAMESPACE ||
+       handle->identifierType != UA_NODEIDTYPE_NUMERIC)
+        return NULL;
+    UA_UInt32 id = handle->identifier.numeric;
+    if(id == 0 || id > session->registeredNodesSize)
+        return NULL;
+    UA_RegisteredNode *rn = &session->registeredNodes[id - 1];
+    if(!rn->used)
+        return NULL;
+    return rn;
+}
+
+static UA_StatusCode
+resolveRegisteredNodes(UA_Session *session, void *p, const UA_DataType *type);
+
+static UA_StatusCode
+resolveRegisteredNodesArray(UA_Session *session, void *p, size_t size,
+                            const UA_DataType *type) {
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    uintptr_t ptr = (uintptr_t)p;
+    for(size_t i = 0; i < size && retval == UA_STATUSCODE_GOOD; i++) {
+        retval = resolveRegisteredNodes(session, (void*)ptr, type);
+        ptr += type->memSize;
+    }
+    return retval;
+}
+
+/* Walk the structure like clearStructure. Variants and DataValues are skipped.
+ * NodeIds contained in values (e.g. of a WriteRequest) are data and no
+ * references to nodes. */
+static UA_StatusCode
+resolveRegisteredNodes(UA_Session *session, void *p, const UA_DataType *type) {
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_NODEID: {
+        UA_RegisteredNode *rn = UA_Session_getRegisteredNode(session, (UA_NodeId*)p);
+        if(!rn)
+            return UA_STATUSCODE_GOOD;
+        UA_NodeId_clear((UA_NodeId*)p);
+        return UA_NodeId_copy(&rn->nodeId, (UA_NodeId*)p);
+    }
+    case UA_DATATYPEKIND_EXPANDEDNODEID: {
+        UA_ExpandedNodeId *en = (UA_ExpandedNodeId*)p;
+        if(en->serverIndex != 0 || en->namespaceUri.length > 0)
+            return UA_STATUSCODE_GOOD;
+        return resolveRegisteredNodes(session, &en->nodeId, &UA_TYPES[UA_TYPES_NODEID]);
+    }
+    case UA_DATATYPEKIND_EXTENSIONOBJECT: {
+        /* For example the HistoryUpdateDetails and the MonitoringFilter */
+        UA_ExtensionObject *eo = (UA_ExtensionObject*)p;
+        if(eo->encoding < UA_EXTENSIONOBJECT_DECODED)
+            return UA_STATUSCODE_GOOD;
+        return resolveRegisteredNodes(session, eo->content.decoded.data,
+                                      eo->content.decoded.type);
+    }
+    case UA_DATATYPEKIND_STRUCTURE:
+    case UA_DATATYPEKIND_OPTSTRUCT:
+        break;
+    default:
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* The AuthenticationToken is not a node */
+    if(type == &UA_TYPES[UA_TYPES_REQUESTHEADER])
+        return UA_STATUSCODE_GOOD;
+
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    uintptr_t ptr = (uintptr_t)p;
+    const UA_DataType *typelists[2] = { UA_TYPES, &type[-type->typeIndex] };
+    for(size_t i = 0; i < type->membersSize && retval == UA_STATUSCODE_GOOD; ++i) {
+        const UA_DataTypeMember *m = &type->members[i];
+        const UA_DataType *mt = &typelists[!m->namespaceZero][m->memberTypeIndex];
+        ptr += m->padding;
+        if(!m->isOptional) {
+            if(!m->isArray) {
+                retval = resolveRegisteredNodes(session, (void*)ptr, mt);
+                ptr += mt->memSize;
+            } else {
+                size_t length = *(size_t*)ptr;
+                ptr += sizeof(size_t);
+                retval = resolveRegisteredNodesArray(session, *(void**)ptr, length, mt);
+                ptr += sizeof(void*);
+            }
+        } else {
+            if(!m->isArray) {
+                if(*(void**)ptr != NULL)
+                    retval = resolveRegisteredNodes(session, *(void**)ptr, mt);
+                ptr += sizeof(void*);
+            } else {
+                size_t length = *(size_t*)ptr;
+                ptr += sizeof(size_t);
+                if(*(void**)ptr != NULL)
+                    retval = resolveRegisteredNodesArray(session, *(void**)ptr,
+                                                         length, mt);
+                ptr += sizeof(void*);
+            }
+        }
+    }
+    return retval;
+}
+
+UA_StatusCode
+UA_Session_resolveRegisteredNodes(UA_Session *session, void *request,
+                                  const UA_DataType *requestType) {
+    if(session->registeredNodesUsed == 0)
+        return UA_STATUSCODE_GOOD;
+    return resolveRegisteredNodes(session, request, requestType);
+}
+
 UA_StatusCode
 UA_Session_generateNonce(UA_Session *session) {
     UA_SecureChannel *channel = session->header.channel;
@@ -110,6 +326,7 @@ UA_Session_attachSubscription(UA_Session *session, UA_Subscription *sub) {
 
     /* Increase the number of outstanding retransmissions */
     session->totalRetransmissionQueueSize += sub->retransmissionQueueSize;
+    session->totalRetransmissionQueueBytes += sub->retransmissionQueueBytes;
 }
 
 void
@@ -125,6 +342,7 @@ UA_Session_detachSubscription(UA_Server *server, UA_Session *session,
 
     /* Reduce the number of outstanding retransmissions */
     session->totalRetransmissionQueueSize -= sub->retransmissionQueueSize;
+    session->totalRetransmissionQueueBytes -= sub->retransmissionQueueBytes;
     
     /* Send remaining publish responses if the last subscription was removed */
     if(!TAILQ_EMPTY(&session->subscriptions))
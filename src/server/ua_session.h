@@ -9,6 +9,7 @@
 #ifndef UA_SESSION_H_
 #define UA_SESSION_H_
 
+#include <open62541/plugin/nodestore.h>
 #include <open62541/util.h>
 
 #include "ua_securechannel.h"
@@ -27,6 +28,20 @@ ContinuationPoint_clear(ContinuationPoint *cp);
 struct UA_Subscription;
 typedef struct UA_Subscription UA_Subscription;
 
+/* RegisterNodes returns handles for the registered nodes. The handles are
+ * numeric NodeIds in this namespace index. They are only valid within the
+ * Session. The identifier is the index in the table of registered nodes + 1. */
+#define UA_REGISTEREDNODES_NAMESPACE 0xFFFF
+
+typedef struct {
+    UA_NodeId nodeId;    /* NodeId from the RegisterNodes request */
+    const UA_Node *node; /* Pinned in the Nodestore. NULL with immutable nodes
+                          * and multithreading (see UA_Session_registerNode). */
+    UA_Boolean used;     /* The slot in the table is in use */
+    UA_Boolean removed;  /* The node was removed from the Nodestore. The node
+                          * stays pinned until it is unregistered. */
+} UA_RegisteredNode;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
 typedef struct UA_PublishResponseEntry {
     SIMPLEQ_ENTRY(UA_PublishResponseEntry) listEntry;
@@ -49,6 +64,9 @@ typedef struct {
     UA_ByteString     serverNonce;
     UA_UInt16         availableContinuationPoints;
     ContinuationPoint *continuationPoints;
+    UA_RegisteredNode *registeredNodes;
+    size_t            registeredNodesSize;
+    size_t            registeredNodesUsed;
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     size_t subscriptionsSize;
     TAILQ_HEAD(, UA_Subscription) subscriptions; /* Late subscriptions that do eventually
@@ -58,6 +76,7 @@ typedef struct {
     SIMPLEQ_HEAD(, UA_PublishResponseEntry) responseQueue;
     UA_UInt32 numPublishReq;
     size_t totalRetransmissionQueueSize; /* Retransmissions of all subscriptions */
+    size_t totalRetransmissionQueueBytes; /* Encoded size of the retransmissions */
 #endif
 } UA_Session;
 
@@ -74,6 +93,35 @@ UA_StatusCode UA_Session_generateNonce(UA_Session *session);
 /* If any activity on a session happens, the timeout is extended */
 void UA_Session_updateLifetime(UA_Session *session);
 
+/**
+ * Registered Nodes
+ * ---------------- */
+
+/* Register the node and return the handle. If the node does not exist, the
+ * NodeId is returned without registration. A node that is already registered
+ * gets the same handle. Then added is false. Returns BadTooManyOperations if
+ * maxRegisteredNodesPerSession is reached. */
+UA_StatusCode
+UA_Session_registerNode(UA_Server *server, UA_Session *session,
+                        const UA_NodeId *nodeId, UA_NodeId *handle,
+                        UA_Boolean *added);
+
+void
+UA_Session_unregisterNode(UA_Server *server, UA_Session *session,
+                          const UA_NodeId *handle);
+
+/* Returns NULL if the NodeId is not a handle of a registered node */
+UA_RegisteredNode *
+UA_Session_getRegisteredNode(UA_Session *session, const UA_NodeId *handle);
+
+/* Replace the handles of registered nodes in a decoded request with the
+ * NodeIds from the RegisterNodes request. This is done for all services before
+ * they are dispatched. So the services, and the callbacks they invoke, only see
+ * the original NodeIds. */
+UA_StatusCode
+UA_Session_resolveRegisteredNodes(UA_Session *session, void *request,
+                                  const UA_DataType *requestType);
+
 /**
  * Subscription handling
  * --------------------- */
@@ -19,6 +19,7 @@
 
 #include "ua_server_internal.h"
 #include "ua_subscription.h"
+#include "ua_types_encoding_binary.h"
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
@@ -70,18 +71,35 @@ UA_Subscription_delete(UA_Server *server, UA_Subscription *sub) {
         UA_MonitoredItem_delete(server, mon);
     }
     UA_assert(sub->monitoredItemsSize == 0);
+    UA_free(sub->monitoredItemsIndex);
+    sub->monitoredItemsIndex = NULL;
+    sub->monitoredItemsIndexSize = 0;
 
     /* Delete Retransmission Queue */
     UA_NotificationMessageEntry *nme, *nme_tmp;
     TAILQ_FOREACH_SAFE(nme, &sub->retransmissionQueue, listEntry, nme_tmp) {
         TAILQ_REMOVE(&sub->retransmissionQueue, nme, listEntry);
-        UA_NotificationMessage_clear(&nme->message);
-        UA_free(nme);
-        if(sub->session)
+        if(sub->session) {
             --sub->session->totalRetransmissionQueueSize;
+            sub->session->totalRetransmissionQueueBytes -= nme->encoded.length;
+        }
         --sub->retransmissionQueueSize;
+        sub->retransmissionQueueBytes -= nme->encoded.length;
+        UA_ByteString_clear(&nme->encoded);
+        UA_free(nme);
     }
     UA_assert(sub->retransmissionQueueSize == 0);
+    UA_assert(sub->retransmissionQueueBytes == 0);
+
+    /* Delete the cached allocations */
+    UA_free(sub->cachedRetransmissionEntry);
+    sub->cachedRetransmissionEntry = NULL;
+    UA_free(sub->cachedNotificationData); /* The ExtensionObjects are cleared */
+    sub->cachedNotificationData = NULL;
+    if(sub->cachedDataChangeNotification) {
+        UA_DataChangeNotification_delete(sub->cachedDataChangeNotification);
+        sub->cachedDataChangeNotification = NULL;
+    }
 
     /* Add a delayed callback to remove the Subscription when the current jobs
      * have completed. Pointers to the subscription may still exist upwards in
@@ -94,26 +112,145 @@ UA_Subscription_delete(UA_Server *server, UA_Subscription *sub) {
     UA_Timer_addTimerEntry(&server->timer, &sub->delayedFreePointers, NULL);
 }
 
+/* Rebuild the MonitoredItem index with the new number of buckets. The old
+ * index is kept if the allocation fails. */
+static void
+resizeMonitoredItemsIndex(UA_Subscription *sub, size_t indexSize) {
+    UA_MonitoredItem **index = (UA_MonitoredItem**)
+        UA_calloc(indexSize, sizeof(UA_MonitoredItem*));
+    if(!index)
+        return;
+    UA_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+        size_t bucket = mon->monitoredItemId & (indexSize - 1);
+        mon->indexNext = index[bucket];
+        index[bucket] = mon;
+    }
+    UA_free(sub->monitoredItemsIndex);
+    sub->monitoredItemsIndex = index;
+    sub->monitoredItemsIndexSize = indexSize;
+}
+
+void
+UA_Subscription_addMonitoredItem(UA_Subscription *sub, UA_MonitoredItem *mon) {
+    mon->monitoredItemId = ++sub->lastMonitoredItemId;
+    sub->monitoredItemsSize++;
+    LIST_INSERT_HEAD(&sub->monitoredItems, mon, listEntry);
+
+    /* Grow the index to keep at most one MonitoredItem per bucket on average */
+    if(sub->monitoredItemsSize > sub->monitoredItemsIndexSize) {
+        size_t indexSize = sub->monitoredItemsIndexSize * 2;
+        if(indexSize < UA_SUBSCRIPTION_MININDEXSIZE)
+            indexSize = UA_SUBSCRIPTION_MININDEXSIZE;
+        resizeMonitoredItemsIndex(sub, indexSize); /* Inserts mon */
+        if(sub->monitoredItemsIndexSize == indexSize)
+            return;
+    }
+
+    if(!sub->monitoredItemsIndex)
+        return;
+    size_t bucket = mon->monitoredItemId & (sub->monitoredItemsIndexSize - 1);
+    mon->indexNext = sub->monitoredItemsIndex[bucket];
+    sub->monitoredItemsIndex[bucket] = mon;
+}
+
+void
+UA_Subscription_removeMonitoredItem(UA_Subscription *sub, UA_MonitoredItem *mon) {
+    sub->monitoredItemsSize--;
+    LIST_REMOVE(mon, listEntry);
+
+    if(!sub->monitoredItemsIndex)
+        return;
+    UA_MonitoredItem **pos = &sub->monitoredItemsIndex
+        [mon->monitoredItemId & (sub->monitoredItemsIndexSize - 1)];
+    while(*pos && *pos != mon)
+        pos = &(*pos)->indexNext;
+    if(*pos)
+        *pos = mon->indexNext;
+    mon->indexNext = NULL;
+
+    /* Shrink the index when it has become sparse */
+    if(sub->monitoredItemsIndexSize > UA_SUBSCRIPTION_MININDEXSIZE &&
+       sub->monitoredItemsSize < sub->monitoredItemsIndexSize / 4)
+        resizeMonitoredItemsIndex(sub, sub->monitoredItemsIndexSize / 2);
+}
+
 UA_MonitoredItem *
 UA_Subscription_getMonitoredItem(UA_Subscription *sub, UA_UInt32 monitoredItemId) {
     UA_MonitoredItem *mon;
-    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-        if(mon->monitoredItemId == monitoredItemId)
-            break;
+    if(!sub->monitoredItemsIndex) {
+        LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+            if(mon->monitoredItemId == monitoredItemId)
+                break;
+        }
+        return mon;
     }
+    mon = sub->monitoredItemsIndex[monitoredItemId & (sub->monitoredItemsIndexSize - 1)];
+    while(mon && mon->monitoredItemId != monitoredItemId)
+        mon = mon->indexNext;
     return mon;
 }
 
+/* Clear the NotificationMessage. Keep the notificationData array and the
+ * array of the DataChangeNotification for reuse in the next publish cycle. */
 static void
-removeOldestRetransmissionMessageFromSub(UA_Subscription *sub) {
-    UA_NotificationMessageEntry *oldestEntry =
-        TAILQ_LAST(&sub->retransmissionQueue, ListOfNotificationMessages);
-    TAILQ_REMOVE(&sub->retransmissionQueue, oldestEntry, listEntry);
-    UA_NotificationMessage_clear(&oldestEntry->message);
-    UA_free(oldestEntry);
+recycleNotificationMessage(UA_Subscription *sub, UA_NotificationMessage *message) {
+    for(size_t i = 0; i < message->notificationDataSize; i++) {
+        UA_ExtensionObject *eo = &message->notificationData[i];
+        if(!sub->cachedDataChangeNotification &&
+           eo->encoding == UA_EXTENSIONOBJECT_DECODED &&
+           eo->content.decoded.type == &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]) {
+            UA_DataChangeNotification *dcn = (UA_DataChangeNotification*)
+                eo->content.decoded.data;
+            for(size_t j = 0; j < dcn->monitoredItemsSize; j++)
+                UA_MonitoredItemNotification_clear(&dcn->monitoredItems[j]);
+            UA_Array_delete(dcn->diagnosticInfos, dcn->diagnosticInfosSize,
+                            &UA_TYPES[UA_TYPES_DIAGNOSTICINFO]);
+            dcn->diagnosticInfos = NULL;
+            dcn->diagnosticInfosSize = 0;
+            sub->cachedDataChangeNotification = dcn;
+            UA_ExtensionObject_init(eo);
+            continue;
+        }
+        UA_ExtensionObject_clear(eo);
+    }
+
+    /* The notificationData array always has two entries (see
+     * prepareNotificationMessage) */
+    if(!sub->cachedNotificationData && message->notificationData)
+        sub->cachedNotificationData = message->notificationData;
+    else
+        UA_free(message->notificationData);
+    UA_NotificationMessage_init(message);
+}
+
+static void
+recycleRetransmissionEntry(UA_Subscription *sub, UA_NotificationMessageEntry *entry) {
+    UA_ByteString_clear(&entry->encoded);
+    if(!sub->cachedRetransmissionEntry)
+        sub->cachedRetransmissionEntry = entry;
+    else
+        UA_free(entry);
+}
+
+/* Remove the entry from the queue and adjust the counters */
+static void
+removeRetransmissionEntry(UA_Subscription *sub, UA_NotificationMessageEntry *entry) {
+    TAILQ_REMOVE(&sub->retransmissionQueue, entry, listEntry);
     --sub->retransmissionQueueSize;
-    if(sub->session)
+    sub->retransmissionQueueBytes -= entry->encoded.length;
+    if(sub->session) {
         --sub->session->totalRetransmissionQueueSize;
+        sub->session->totalRetransmissionQueueBytes -= entry->encoded.length;
+    }
+    recycleRetransmissionEntry(sub, entry);
+}
+
+static void
+removeOldestRetransmissionMessageFromSub(UA_Subscription *sub) {
+    /* New entries are added at the tail */
+    UA_NotificationMessageEntry *oldestEntry = TAILQ_FIRST(&sub->retransmissionQueue);
+    removeRetransmissionEntry(sub, oldestEntry);
 }
 
 static void
@@ -122,11 +259,10 @@ removeOldestRetransmissionMessageFromSession(UA_Session *session) {
     UA_Subscription *oldestSub = NULL;
     UA_Subscription *sub;
     TAILQ_FOREACH(sub, &session->subscriptions, sessionListEntry) {
-        UA_NotificationMessageEntry *first =
-            TAILQ_LAST(&sub->retransmissionQueue, ListOfNotificationMessages);
+        UA_NotificationMessageEntry *first = TAILQ_FIRST(&sub->retransmissionQueue);
         if(!first)
             continue;
-        if(!oldestEntry || oldestEntry->message.publishTime > first->message.publishTime) {
+        if(!oldestEntry || oldestEntry->publishTime > first->publishTime) {
             oldestEntry = first;
             oldestSub = sub;
         }
@@ -137,11 +273,22 @@ removeOldestRetransmissionMessageFromSession(UA_Session *session) {
     removeOldestRetransmissionMessageFromSub(oldestSub);
 }
 
-static void
+/* Returns false if the entry was not added because the message alone exceeds
+ * the byte limit. The entry then remains with the caller. */
+static UA_Boolean
 UA_Subscription_addRetransmissionMessage(UA_Server *server, UA_Subscription *sub,
                                          UA_NotificationMessageEntry *entry) {
-    /* Release the oldest entry if there is not enough space */
+    /* The message alone exceeds the byte limit. Don't retain it. */
     UA_Session *session = sub->session;
+    size_t maxBytes = server->config.maxRetransmissionQueueBytes;
+    if(session && maxBytes > 0 && entry->encoded.length > maxBytes) {
+        UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
+                                    "NotificationMessage exceeds the byte limit "
+                                    "of the retransmission queue");
+        return false;
+    }
+
+    /* Release the oldest entry if there is not enough space */
     if(sub->retransmissionQueueSize >= UA_MAX_RETRANSMISSIONQUEUESIZE) {
         removeOldestRetransmissionMessageFromSub(sub);
     } else if(session && server->config.maxRetransmissionQueueSize > 0 &&
@@ -151,11 +298,25 @@ UA_Subscription_addRetransmissionMessage(UA_Server *server, UA_Subscription *sub
         removeOldestRetransmissionMessageFromSession(sub->session);
     }
 
+    /* Release the oldest entries until the message fits into the byte limit */
+    if(session && maxBytes > 0 &&
+       session->totalRetransmissionQueueBytes + entry->encoded.length > maxBytes) {
+        UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
+                                    "Retransmission queue byte limit reached");
+        while(session->totalRetransmissionQueueSize > 0 &&
+              session->totalRetransmissionQueueBytes + entry->encoded.length > maxBytes)
+            removeOldestRetransmissionMessageFromSession(session);
+    }
+
     /* Add entry */
     TAILQ_INSERT_TAIL(&sub->retransmissionQueue, entry, listEntry);
     ++sub->retransmissionQueueSize;
-    if(session)
+    sub->retransmissionQueueBytes += entry->encoded.length;
+    if(session) {
         ++session->totalRetransmissionQueueSize;
+        session->totalRetransmissionQueueBytes += entry->encoded.length;
+    }
+    return true;
 }
 
 UA_StatusCode
@@ -163,24 +324,33 @@ UA_Subscription_removeRetransmissionMessage(UA_Subscription *sub, UA_UInt32 sequ
     /* Find the retransmission message */
     UA_NotificationMessageEntry *entry;
     TAILQ_FOREACH(entry, &sub->retransmissionQueue, listEntry) {
-        if(entry->message.sequenceNumber == sequenceNumber)
+        if(entry->sequenceNumber == sequenceNumber)
             break;
     }
     if(!entry)
         return UA_STATUSCODE_BADSEQUENCENUMBERUNKNOWN;
 
     /* Remove the retransmission message */
-    TAILQ_REMOVE(&sub->retransmissionQueue, entry, listEntry);
-    --sub->retransmissionQueueSize;
-    UA_NotificationMessage_clear(&entry->message);
-    UA_free(entry);
-
-    if(sub->session)
-        --sub->session->totalRetransmissionQueueSize;
+    removeRetransmissionEntry(sub, entry);
 
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+encodeNotificationMessage(const UA_NotificationMessage *message, UA_ByteString *encoded) {
+    const UA_DataType *type = &UA_TYPES[UA_TYPES_NOTIFICATIONMESSAGE];
+    UA_StatusCode retval =
+        UA_ByteString_allocBuffer(encoded, UA_calcSizeBinary(message, type));
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_Byte *bufPos = encoded->data;
+    const UA_Byte *bufEnd = &encoded->data[encoded->length];
+    retval = UA_encodeBinary(message, type, &bufPos, &bufEnd, NULL, NULL);
+    if(retval != UA_STATUSCODE_GOOD)
+        UA_ByteString_clear(encoded);
+    return retval;
+}
+
 static UA_StatusCode
 prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
                            UA_NotificationMessage *message, size_t notifications) {
@@ -192,10 +362,14 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
      *
      * If a Subscription contains MonitoredItems for events and data, this array
      * should have not more than 2 elements. */
-    message->notificationData = (UA_ExtensionObject*)
-        UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
-    if(!message->notificationData)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    message->notificationData = sub->cachedNotificationData;
+    sub->cachedNotificationData = NULL;
+    if(!message->notificationData) {
+        message->notificationData = (UA_ExtensionObject*)
+            UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+        if(!message->notificationData)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
     message->notificationDataSize = 2;
 
     /* Pre-allocate DataChangeNotifications */
@@ -203,21 +377,35 @@ prepareNotificationMessage(UA_Server *server, UA_Subscription *sub,
     UA_DataChangeNotification *dcn = NULL;
     size_t dcnPos = 0; /* How many DataChangeNotifications were moved into the list? */
     if(sub->dataChangeNotifications > 0) {
-        dcn = UA_DataChangeNotification_new();
+        size_t dcnSize = sub->dataChangeNotifications;
+        if(dcnSize > notifications)
+            dcnSize = notifications;
+
+        /* Reuse the cached DataChangeNotification. The monitoredItemsSize is
+         * the capacity of its (cleared) array. */
+        dcn = sub->cachedDataChangeNotification;
+        sub->cachedDataChangeNotification = NULL;
+        if(dcn && dcn->monitoredItemsSize < dcnSize) {
+            UA_free(dcn->monitoredItems);
+            dcn->monitoredItems = NULL;
+            dcn->monitoredItemsSize = 0;
+        }
         if(!dcn) {
-            UA_NotificationMessage_clear(message);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
+            dcn = UA_DataChangeNotification_new();
+            if(!dcn) {
+                UA_NotificationMessage_clear(message);
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            }
         }
         UA_ExtensionObject_setValue(message->notificationData, dcn,
                                     &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]);
-        size_t dcnSize = sub->dataChangeNotifications;
-        if(dcnSize > notifications)
-            dcnSize = notifications;
-        dcn->monitoredItems = (UA_MonitoredItemNotification*)
-            UA_Array_new(dcnSize, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
         if(!dcn->monitoredItems) {
-            UA_NotificationMessage_clear(message);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
+            dcn->monitoredItems = (UA_MonitoredItemNotification*)
+                UA_Array_new(dcnSize, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
+            if(!dcn->monitoredItems) {
+                UA_NotificationMessage_clear(message);
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            }
         }
         dcn->monitoredItemsSize = dcnSize;
         notificationDataIdx++;
@@ -460,9 +648,12 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     UA_NotificationMessageEntry *retransmission = NULL;
     if(notifications > 0) {
         if(server->config.enableRetransmissionQueue) {
-            /* Allocate the retransmission entry */
-            retransmission = (UA_NotificationMessageEntry*)
-                UA_malloc(sizeof(UA_NotificationMessageEntry));
+            /* Reuse or allocate the retransmission entry */
+            retransmission = sub->cachedRetransmissionEntry;
+            sub->cachedRetransmissionEntry = NULL;
+            if(!retransmission)
+                retransmission = (UA_NotificationMessageEntry*)
+                    UA_malloc(sizeof(UA_NotificationMessageEntry));
             if(!retransmission) {
                 UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
                                             "Could not allocate memory for retransmission. "
@@ -480,8 +671,7 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
                                         "Could not prepare the notification message. "
                                         "The subscription is late.");
             /* If the retransmission queue is enabled a retransmission message is allocated */
-            if(retransmission)
-                UA_free(retransmission);
+            sub->cachedRetransmissionEntry = retransmission;
             sub->state = UA_SUBSCRIPTIONSTATE_LATE;
             UA_Session_queuePublishReq(sub->session, pre, true); /* Re-enqueue */
             return;
@@ -505,15 +695,31 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
      * response with or without an monitored item. */
     message->sequenceNumber = sub->nextSequenceNumber;
 
+    UA_Boolean retained = false;
     if(notifications > 0) {
         /* If the retransmission queue is enabled a retransmission message is
-         * allocated */
+         * allocated. Encode the NotificationMessage once. The encoding is used
+         * for the PublishResponse and retained for Republish. */
+        if(retransmission) {
+            UA_StatusCode retval =
+                encodeNotificationMessage(message, &retransmission->encoded);
+            if(retval != UA_STATUSCODE_GOOD) {
+                UA_LOG_WARNING_SUBSCRIPTION(&server->config.logger, sub,
+                                            "Could not encode the NotificationMessage "
+                                            "for retransmission with StatusCode %s",
+                                            UA_StatusCode_name(retval));
+                recycleRetransmissionEntry(sub, retransmission);
+                retransmission = NULL;
+            }
+        }
+
         if(retransmission) {
             /* Put the notification message into the retransmission queue. This
              * needs to be done here, so that the message itself is included in
              * the available sequence numbers for acknowledgement. */
-            retransmission->message = response->notificationMessage;
-            UA_Subscription_addRetransmissionMessage(server, sub, retransmission);
+            retransmission->sequenceNumber = message->sequenceNumber;
+            retransmission->publishTime = message->publishTime;
+            retained = UA_Subscription_addRetransmissionMessage(server, sub, retransmission);
         }
         /* Only if a notification was created, the sequence number must be
          * increased. For a keepalive the sequence number can be reused. */
@@ -528,7 +734,7 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     size_t i = 0;
     UA_NotificationMessageEntry *nme;
     TAILQ_FOREACH(nme, &sub->retransmissionQueue, listEntry) {
-        response->availableSequenceNumbers[i] = nme->message.sequenceNumber;
+        response->availableSequenceNumbers[i] = nme->sequenceNumber;
         ++i;
     }
     UA_assert(i == sub->retransmissionQueueSize);
@@ -536,17 +742,26 @@ UA_Subscription_publish(UA_Server *server, UA_Subscription *sub) {
     /* Send the response */
     UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub, "Sending out a publish response "
                               "with %" PRIu32 " notifications", notifications);
-    sendResponse(server, sub->session, sub->session->header.channel, pre->requestId,
-                 (UA_Response*)response, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
+    if(retransmission)
+        sendResponseEncodedMember(server, sub->session, sub->session->header.channel,
+                                  pre->requestId, (UA_Response*)response,
+                                  &UA_TYPES[UA_TYPES_PUBLISHRESPONSE],
+                                  UA_PUBLISHRESPONSE_NOTIFICATIONMESSAGE,
+                                  &retransmission->encoded);
+    else
+        sendResponse(server, sub->session, sub->session->header.channel, pre->requestId,
+                     (UA_Response*)response, &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]);
 
     /* Reset subscription state to normal */
     sub->state = UA_SUBSCRIPTIONSTATE_NORMAL;
     sub->currentKeepAliveCount = 0;
 
-    /* Free the response */
-    if(retransmission)
-        /* NotificationMessage was moved into retransmission queue */
-        UA_NotificationMessage_init(&response->notificationMessage);
+    /* Free the response. Keep the allocations for the next NotificationMessage
+     * and the retransmission entry if it was not retained. */
+    if(retransmission && !retained)
+        recycleRetransmissionEntry(sub, retransmission);
+    if(notifications > 0)
+        recycleNotificationMessage(sub, &response->notificationMessage);
     response->availableSequenceNumbers = NULL;
     response->availableSequenceNumbersSize = 0;
     UA_PublishResponse_clear(&pre->response);
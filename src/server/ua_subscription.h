@@ -78,15 +78,34 @@ typedef struct {
     UA_TwoStateVariableChangeCallback activeStateCallback;
 } UA_ConditionCallbacks;
 
+/* Number of cached field NodeIds per ConditionBranch */
+#define UA_CONDITION_FIELDCACHESIZE 18
+
 /* In Alarms and Conditions first implementation, conditionBranchId is always
  * equal to NULL NodeId (UA_NODEID_NULL). That ConditionBranch represents the
  * current state Condition. The current state is determined by the last Event
  * triggered (lastEventId). See Part 9, 5.5.2, BranchId. */
 typedef struct UA_ConditionBranch {
     LIST_ENTRY(UA_ConditionBranch) listEntry;
+    struct UA_Condition *condition; /* The Condition of the branch */
+
+    /* Buckets in the server-wide indexes of the condition list. The branches
+     * are indexed by their NodeId (ConditionId for the main branch) and by
+     * their lastEventId. */
+    struct UA_ConditionBranch *idIndexNext;
+    struct UA_ConditionBranch *eventIdIndexNext;
+    UA_UInt32 idHash;
+    UA_UInt32 eventIdHash;
+
     UA_NodeId conditionBranchId;
     UA_ByteString lastEventId;
     UA_Boolean isCallerAC;
+
+    /* NodeIds of the standard fields of the branch node (the condition node
+     * for the main branch). Resolved on first use, UA_NODEID_NULL until then.
+     * The cached fields are listed in ua_subscription_alarms_conditions.c. */
+    UA_NodeId fieldCache[UA_CONDITION_FIELDCACHESIZE];
+    UA_UInt32 fieldCacheGeneration;
 } UA_ConditionBranch;
 
 /* In Alarms and Conditions first implementation, A Condition
@@ -94,6 +113,7 @@ typedef struct UA_ConditionBranch {
 typedef struct UA_Condition {
     LIST_ENTRY(UA_Condition) listEntry;
     LIST_HEAD(, UA_ConditionBranch) conditionBranchHead;
+    struct UA_ConditionSource *source; /* The ConditionSource of the Condition */
     UA_NodeId conditionId;
     UA_UInt16 lastSeverity;
     UA_DateTime lastSeveritySourceTimeStamp;
@@ -107,9 +127,14 @@ typedef struct UA_Condition {
 typedef struct UA_ConditionSource {
     LIST_ENTRY(UA_ConditionSource) listEntry;
     LIST_HEAD(, UA_Condition) conditionHead;
+    struct UA_ConditionSource *indexNext; /* Bucket in the server-wide index */
+    UA_UInt32 hash;
     UA_NodeId conditionSourceId;
 } UA_ConditionSource;
 
+/* Smallest number of buckets in the hash indexes of the condition list */
+#define UA_CONDITION_MININDEXSIZE 16
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS */
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
@@ -130,7 +155,15 @@ typedef struct UA_Notification {
 #endif
 } UA_Notification;
 
-UA_Notification * UA_Notification_new(void);
+/* Deleted Notifications are kept in a freelist of the server for reuse. This
+ * avoids an allocation for every sampled value. The freelist is bounded to
+ * release memory after a burst of notifications. */
+#define UA_NOTIFICATION_FREELIST_MAXSIZE 4096
+
+UA_Notification * UA_Notification_new(UA_Server *server);
+
+/* Free the Notifications in the freelist of the server */
+void UA_Notification_clearFreeList(UA_Server *server);
 
 /* Notifications are always added to the queue of the MonitoredItem. That queue
  * can overflow. If Notifications are reported, they are also added to the
@@ -151,6 +184,8 @@ typedef TAILQ_HEAD(NotificationQueue, UA_Notification) NotificationQueue;
 struct UA_MonitoredItem {
     UA_TimerEntry delayedFreePointers;
     LIST_ENTRY(UA_MonitoredItem) listEntry;
+    UA_MonitoredItem *indexNext; /* Next in the bucket of the Subscription's
+                                  * MonitoredItem index */
 #ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
     UA_MonitoredItem *next; /* Linked list of MonitoredItems directly attached
                              * to a Node */
@@ -227,9 +262,22 @@ void UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon)
 /* Subscription */
 /****************/
 
+/* The retransmission queue holds the NotificationMessages in their binary
+ * encoding. The encoding is done once before the PublishResponse is sent and
+ * the same bytes are used for the PublishResponse and the Republish. */
+
+/* Index of the NotificationMessage member in the response types */
+#define UA_PUBLISHRESPONSE_NOTIFICATIONMESSAGE 4
+#define UA_REPUBLISHRESPONSE_NOTIFICATIONMESSAGE 1
+
+/* Smallest number of buckets in the MonitoredItem index of a Subscription */
+#define UA_SUBSCRIPTION_MININDEXSIZE 16
+
 typedef struct UA_NotificationMessageEntry {
     TAILQ_ENTRY(UA_NotificationMessageEntry) listEntry;
-    UA_NotificationMessage message;
+    UA_UInt32 sequenceNumber;
+    UA_DateTime publishTime;
+    UA_ByteString encoded; /* Binary encoded NotificationMessage */
 } UA_NotificationMessageEntry;
 
 /* We use only a subset of the states defined in the standard */
@@ -280,6 +328,13 @@ struct UA_Subscription {
     LIST_HEAD(, UA_MonitoredItem) monitoredItems;
     UA_UInt32 monitoredItemsSize;
 
+    /* Hash index of the MonitoredItems by their identifier. The identifiers
+     * are allocated sequentially. So the lower bits are used as the hash and
+     * the buckets are filled evenly. The number of buckets is a power of two.
+     * Without an index (failed allocation), the list is searched. */
+    UA_MonitoredItem **monitoredItemsIndex;
+    size_t monitoredItemsIndexSize;
+
     /* Global list of notifications from the MonitoredItems */
     NotificationQueue notificationQueue;
     UA_UInt32 notificationQueueSize; /* Total queue size */
@@ -295,6 +350,16 @@ struct UA_Subscription {
     /* Retransmission Queue */
     ListOfNotificationMessages retransmissionQueue;
     size_t retransmissionQueueSize;
+    size_t retransmissionQueueBytes; /* Encoded size of all entries */
+
+    /* Allocations of a sent NotificationMessage and of an acknowledged
+     * retransmission entry. They are reused for the next NotificationMessage
+     * instead of allocating new arrays for every publish cycle. The cached
+     * DataChangeNotification has no content. Its monitoredItemsSize is the
+     * capacity of the (cleared) monitoredItems array. */
+    UA_NotificationMessageEntry *cachedRetransmissionEntry;
+    UA_ExtensionObject *cachedNotificationData; /* Array of two */
+    UA_DataChangeNotification *cachedDataChangeNotification;
 };
 
 UA_Subscription * UA_Subscription_new(void);
@@ -303,6 +368,10 @@ UA_StatusCode Subscription_registerPublishCallback(UA_Server *server, UA_Subscri
 void Subscription_unregisterPublishCallback(UA_Server *server, UA_Subscription *sub);
 UA_MonitoredItem * UA_Subscription_getMonitoredItem(UA_Subscription *sub, UA_UInt32 monitoredItemId);
 
+/* Assign the next identifier and add to the list and index of MonitoredItems */
+void UA_Subscription_addMonitoredItem(UA_Subscription *sub, UA_MonitoredItem *mon);
+void UA_Subscription_removeMonitoredItem(UA_Subscription *sub, UA_MonitoredItem *mon);
+
 void UA_Subscription_publish(UA_Server *server, UA_Subscription *sub);
 UA_StatusCode UA_Subscription_removeRetransmissionMessage(UA_Subscription *sub,
                                                           UA_UInt32 sequenceNumber);
@@ -104,6 +104,39 @@ static const UA_QualifiedName fieldConfirmedStateQN = STATIC_QN(CONDITION_FIELD_
 static const UA_QualifiedName fieldActiveStateQN = STATIC_QN(CONDITION_FIELD_ACTIVESTATE);
 static const UA_QualifiedName fieldTimeQN = STATIC_QN(CONDITION_FIELD_TIME);
 static const UA_QualifiedName fieldSourceQN = STATIC_QN(CONDITION_FIELD_SOURCENODE);
+static const UA_QualifiedName fieldEventTypeQN = STATIC_QN(CONDITION_FIELD_EVENTTYPE);
+static const UA_QualifiedName fieldSeverityQN = STATIC_QN(CONDITION_FIELD_SEVERITY);
+static const UA_QualifiedName fieldLastSeverityQN = STATIC_QN(CONDITION_FIELD_LASTSEVERITY);
+static const UA_QualifiedName fieldCommentQN = STATIC_QN(CONDITION_FIELD_COMMENT);
+static const UA_QualifiedName fieldQualityQN = STATIC_QN(CONDITION_FIELD_QUALITY);
+static const UA_QualifiedName sourceTimestampQN =
+    STATIC_QN(CONDITION_FIELD_CONDITIONVARIABLE_SOURCETIMESTAMP);
+
+/* Fields of a condition whose NodeIds are cached in the condition list. The
+ * property name is NULL for the field itself. */
+static const struct {
+    const UA_QualifiedName *field;
+    const UA_QualifiedName *property;
+} cachedConditionFields[UA_CONDITION_FIELDCACHESIZE] = {
+    {&fieldRetainQN, NULL},
+    {&fieldEnabledStateQN, NULL},
+    {&fieldEnabledStateQN, &twoStateVariableIdQN},
+    {&fieldActiveStateQN, NULL},
+    {&fieldActiveStateQN, &twoStateVariableIdQN},
+    {&fieldAckedStateQN, NULL},
+    {&fieldAckedStateQN, &twoStateVariableIdQN},
+    {&fieldConfirmedStateQN, NULL},
+    {&fieldConfirmedStateQN, &twoStateVariableIdQN},
+    {&fieldSeverityQN, NULL},
+    {&fieldLastSeverityQN, NULL},
+    {&fieldLastSeverityQN, &sourceTimestampQN},
+    {&fieldMessageQN, NULL},
+    {&fieldTimeQN, NULL},
+    {&fieldCommentQN, NULL},
+    {&fieldQualityQN, NULL},
+    {&fieldSourceQN, NULL},
+    {&fieldEventTypeQN, NULL}
+};
 
 #define CONDITION_ASSERT_RETURN_RETVAL(retval, logMessage, deleteFunction)                \
     {                                                                                     \
@@ -133,6 +166,287 @@ static UA_NodeId refreshEvents[2] =
     {{0, UA_NODEIDTYPE_NUMERIC, {0}},
      {0, UA_NODEIDTYPE_NUMERIC, {0}}};
 
+/*****************************************************************************/
+/* Condition List Index                                                      */
+/*****************************************************************************/
+
+/* The NodeId of a branch. That is the ConditionId for the main branch. */
+static const UA_NodeId *
+getBranchNodeId(const UA_ConditionBranch *branch) {
+    if(UA_NodeId_isNull(&branch->conditionBranchId))
+        return &branch->condition->conditionId;
+    return &branch->conditionBranchId;
+}
+
+/* Rebuild the ConditionSource index with the new number of buckets. The old
+ * index is kept if the allocation fails. */
+static void
+resizeConditionSourcesIndex(UA_Server *server, size_t indexSize) {
+    UA_ConditionSource **index = (UA_ConditionSource**)
+        UA_calloc(indexSize, sizeof(UA_ConditionSource*));
+    if(!index)
+        return;
+    UA_ConditionSource *source;
+    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
+        size_t bucket = source->hash & (indexSize - 1);
+        source->indexNext = index[bucket];
+        index[bucket] = source;
+    }
+    UA_free(server->conditionSourcesIndex);
+    server->conditionSourcesIndex = index;
+    server->conditionSourcesIndexSize = indexSize;
+}
+
+static void
+addConditionSource(UA_Server *server, UA_ConditionSource *source) {
+    source->hash = UA_NodeId_hash(&source->conditionSourceId);
+    server->conditionSourcesSize++;
+    LIST_INSERT_HEAD(&server->headConditionSource, source, listEntry);
+
+    /* Grow the index to keep at most one entry per bucket on average */
+    if(server->conditionSourcesSize > server->conditionSourcesIndexSize) {
+        size_t indexSize = server->conditionSourcesIndexSize * 2;
+        if(indexSize < UA_CONDITION_MININDEXSIZE)
+            indexSize = UA_CONDITION_MININDEXSIZE;
+        resizeConditionSourcesIndex(server, indexSize); /* Inserts source */
+        if(server->conditionSourcesIndexSize == indexSize)
+            return;
+    }
+
+    if(!server->conditionSourcesIndex)
+        return;
+    size_t bucket = source->hash & (server->conditionSourcesIndexSize - 1);
+    source->indexNext = server->conditionSourcesIndex[bucket];
+    server->conditionSourcesIndex[bucket] = source;
+}
+
+static void
+removeConditionSource(UA_Server *server, UA_ConditionSource *source) {
+    server->conditionSourcesSize--;
+    LIST_REMOVE(source, listEntry);
+
+    if(!server->conditionSourcesIndex)
+        return;
+    UA_ConditionSource **pos = &server->conditionSourcesIndex
+        [source->hash & (server->conditionSourcesIndexSize - 1)];
+    while(*pos && *pos != source)
+        pos = &(*pos)->indexNext;
+    if(*pos)
+        *pos = source->indexNext;
+    source->indexNext = NULL;
+
+    /* Shrink the index when it has become sparse */
+    if(server->conditionSourcesIndexSize > UA_CONDITION_MININDEXSIZE &&
+       server->conditionSourcesSize < server->conditionSourcesIndexSize / 4)
+        resizeConditionSourcesIndex(server, server->conditionSourcesIndexSize / 2);
+}
+
+static UA_ConditionSource *
+findConditionSource(UA_Server *server, const UA_NodeId *conditionSourceId) {
+    UA_ConditionSource *source;
+    if(!server->conditionSourcesIndex) {
+        LIST_FOREACH(source, &server->headConditionSource, listEntry) {
+            if(UA_NodeId_equal(&source->conditionSourceId, conditionSourceId))
+                break;
+        }
+        return source;
+    }
+    UA_UInt32 hash = UA_NodeId_hash(conditionSourceId);
+    source = server->conditionSourcesIndex
+        [hash & (server->conditionSourcesIndexSize - 1)];
+    while(source && (source->hash != hash ||
+                     !UA_NodeId_equal(&source->conditionSourceId, conditionSourceId)))
+        source = source->indexNext;
+    return source;
+}
+
+static void
+insertBranchEventId(UA_ConditionBranch **eventIdIndex, size_t indexSize,
+                    UA_ConditionBranch *branch) {
+    /* Branches without an event are not indexed by the EventId */
+    if(branch->lastEventId.length == 0)
+        return;
+    size_t bucket = branch->eventIdHash & (indexSize - 1);
+    branch->eventIdIndexNext = eventIdIndex[bucket];
+    eventIdIndex[bucket] = branch;
+}
+
+static void
+unlinkBranchEventId(UA_Server *server, UA_ConditionBranch *branch) {
+    if(!server->conditionBranchesIndex || branch->lastEventId.length == 0)
+        return;
+    UA_ConditionBranch **eventIdIndex =
+        &server->conditionBranchesIndex[server->conditionBranchesIndexSize];
+    UA_ConditionBranch **pos =
+        &eventIdIndex[branch->eventIdHash & (server->conditionBranchesIndexSize - 1)];
+    while(*pos && *pos != branch)
+        pos = &(*pos)->eventIdIndexNext;
+    if(*pos)
+        *pos = branch->eventIdIndexNext;
+    branch->eventIdIndexNext = NULL;
+}
+
+/* Rebuild the branch indexes with the new number of buckets. The old indexes
+ * are kept if the allocation fails. */
+static void
+resizeConditionBranchesIndex(UA_Server *server, size_t indexSize) {
+    UA_ConditionBranch **index = (UA_ConditionBranch**)
+        UA_calloc(indexSize * 2, sizeof(UA_ConditionBranch*));
+    if(!index)
+        return;
+    UA_ConditionSource *source;
+    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
+        UA_Condition *cond;
+        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
+            UA_ConditionBranch *branch;
+            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
+                size_t bucket = branch->idHash & (indexSize - 1);
+                branch->idIndexNext = index[bucket];
+                index[bucket] = branch;
+                insertBranchEventId(&index[indexSize], indexSize, branch);
+            }
+        }
+    }
+    UA_free(server->conditionBranchesIndex);
+    server->conditionBranchesIndex = index;
+    server->conditionBranchesIndexSize = indexSize;
+}
+
+static void
+addConditionBranch(UA_Server *server, UA_Condition *cond, UA_ConditionBranch *branch) {
+    branch->condition = cond;
+    branch->idHash = UA_NodeId_hash(getBranchNodeId(branch));
+    branch->eventIdHash = UA_ByteString_hash(0, branch->lastEventId.data,
+                                             branch->lastEventId.length);
+    server->conditionBranchesSize++;
+    LIST_INSERT_HEAD(&cond->conditionBranchHead, branch, listEntry);
+
+    /* Grow the index to keep at most one entry per bucket on average */
+    if(server->conditionBranchesSize > server->conditionBranchesIndexSize) {
+        size_t indexSize = server->conditionBranchesIndexSize * 2;
+        if(indexSize < UA_CONDITION_MININDEXSIZE)
+            indexSize = UA_CONDITION_MININDEXSIZE;
+        resizeConditionBranchesIndex(server, indexSize); /* Inserts branch */
+        if(server->conditionBranchesIndexSize == indexSize)
+            return;
+    }
+
+    if(!server->conditionBranchesIndex)
+        return;
+    size_t indexSize = server->conditionBranchesIndexSize;
+    size_t bucket = branch->idHash & (indexSize - 1);
+    branch->idIndexNext = server->conditionBranchesIndex[bucket];
+    server->conditionBranchesIndex[bucket] = branch;
+    insertBranchEventId(&server->conditionBranchesIndex[indexSize], indexSize, branch);
+}
+
+static void
+removeConditionBranch(UA_Server *server, UA_ConditionBranch *branch) {
+    server->conditionBranchesSize--;
+    LIST_REMOVE(branch, listEntry);
+
+    if(!server->conditionBranchesIndex)
+        return;
+    unlinkBranchEventId(server, branch);
+    UA_ConditionBranch **pos = &server->conditionBranchesIndex
+        [branch->idHash & (server->conditionBranchesIndexSize - 1)];
+    while(*pos && *pos != branch)
+        pos = &(*pos)->idIndexNext;
+    if(*pos)
+        *pos = branch->idIndexNext;
+    branch->idIndexNext = NULL;
+
+    /* Shrink the index when it has become sparse */
+    if(server->conditionBranchesIndexSize > UA_CONDITION_MININDEXSIZE &&
+       server->conditionBranchesSize < server->conditionBranchesIndexSize / 4)
+        resizeConditionBranchesIndex(server, server->conditionBranchesIndexSize / 2);
+}
+
+static UA_StatusCode
+setBranchLastEventId(UA_Server *server, UA_ConditionBranch *branch,
+                     const UA_ByteString *lastEventId) {
+    UA_ByteString eventId;
+    UA_StatusCode retval = UA_ByteString_copy(lastEventId, &eventId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    unlinkBranchEventId(server, branch);
+    UA_ByteString_clear(&branch->lastEventId);
+    branch->lastEventId = eventId;
+    branch->eventIdHash = UA_ByteString_hash(0, eventId.data, eventId.length);
+    if(server->conditionBranchesIndex)
+        insertBranchEventId(&server->conditionBranchesIndex
+                            [server->conditionBranchesIndexSize],
+                            server->conditionBranchesIndexSize, branch);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Find the branch by its NodeId. The ConditionId selects the main branch. */
+static UA_ConditionBranch *
+findConditionBranch(UA_Server *server, const UA_NodeId *branchNodeId) {
+    UA_ConditionBranch *branch;
+    if(!server->conditionBranchesIndex) {
+        UA_ConditionSource *source;
+        LIST_FOREACH(source, &server->headConditionSource, listEntry) {
+            UA_Condition *cond;
+            LIST_FOREACH(cond, &source->conditionHead, listEntry) {
+                LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
+                    if(UA_NodeId_equal(getBranchNodeId(branch), branchNodeId))
+                        return branch;
+                }
+            }
+        }
+        return NULL;
+    }
+    UA_UInt32 hash = UA_NodeId_hash(branchNodeId);
+    branch = server->conditionBranchesIndex
+        [hash & (server->conditionBranchesIndexSize - 1)];
+    while(branch && (branch->idHash != hash ||
+                     !UA_NodeId_equal(getBranchNodeId(branch), branchNodeId)))
+        branch = branch->idIndexNext;
+    return branch;
+}
+
+static UA_ConditionBranch *
+findConditionBranchByEventId(UA_Server *server, const UA_ByteString *eventId) {
+    if(eventId->length == 0)
+        return NULL;
+    UA_ConditionBranch *branch;
+    if(!server->conditionBranchesIndex) {
+        UA_ConditionSource *source;
+        LIST_FOREACH(source, &server->headConditionSource, listEntry) {
+            UA_Condition *cond;
+            LIST_FOREACH(cond, &source->conditionHead, listEntry) {
+                LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
+                    if(UA_ByteString_equal(&branch->lastEventId, eventId))
+                        return branch;
+                }
+            }
+        }
+        return NULL;
+    }
+    UA_UInt32 hash = UA_ByteString_hash(0, eventId->data, eventId->length);
+    size_t indexSize = server->conditionBranchesIndexSize;
+    branch = server->conditionBranchesIndex[indexSize + (hash & (indexSize - 1))];
+    while(branch && (branch->eventIdHash != hash ||
+                     !UA_ByteString_equal(&branch->lastEventId, eventId)))
+        branch = branch->eventIdIndexNext;
+    return branch;
+}
+
+/* Find the condition by its ConditionId. The condition has to belong to the
+ * ConditionSource. */
+static UA_Condition *
+findCondition(UA_Server *server, const UA_NodeId *conditionSource,
+              const UA_NodeId *conditionId) {
+    UA_ConditionBranch *branch = findConditionBranch(server, conditionId);
+    if(!branch || !UA_NodeId_isNull(&branch->conditionBranchId))
+        return NULL;
+    UA_Condition *cond = branch->condition;
+    if(!UA_NodeId_equal(&cond->source->conditionSourceId, conditionSource))
+        return NULL;
+    return cond;
+}
+
 /*****************************************************************************/
 /* Functions                                                                */
 /*****************************************************************************/
@@ -146,43 +460,33 @@ UA_Server_setConditionTwoStateVariableCallback(UA_Server *server, const UA_NodeI
                                                const UA_NodeId conditionSource, UA_Boolean removeBranch,
                                                UA_TwoStateVariableChangeCallback callback,
                                                UA_TwoStateVariableCallbackType callbackType) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *cs;
-    LIST_FOREACH(cs, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&cs->conditionSourceId, &conditionSource))
-            continue;
-
-        /* Get Condition Entry */
-        UA_Condition *c;
-        LIST_FOREACH(c, &cs->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&c->conditionId, &condition))
-                continue;
+    /* Get Condition Entry */
+    UA_Condition *c = findCondition(server, &conditionSource, &condition);
+    if(!c)
+        return UA_STATUSCODE_BADNOTFOUND;
 
-            switch(callbackType) {
-                case UA_ENTERING_ENABLEDSTATE:
-                    c->callbacks.enableStateCallback = callback;
-                    return UA_STATUSCODE_GOOD;
+    switch(callbackType) {
+        case UA_ENTERING_ENABLEDSTATE:
+            c->callbacks.enableStateCallback = callback;
+            return UA_STATUSCODE_GOOD;
 
-                case UA_ENTERING_ACKEDSTATE:
-                    c->callbacks.ackStateCallback = callback;
-                    c->callbacks.ackedRemoveBranch = removeBranch;
-                    return UA_STATUSCODE_GOOD;
+        case UA_ENTERING_ACKEDSTATE:
+            c->callbacks.ackStateCallback = callback;
+            c->callbacks.ackedRemoveBranch = removeBranch;
+            return UA_STATUSCODE_GOOD;
 
-                case UA_ENTERING_CONFIRMEDSTATE:
-                    c->callbacks.confirmStateCallback = callback;
-                    c->callbacks.confirmedRemoveBranch = removeBranch;
-                    return UA_STATUSCODE_GOOD;
+        case UA_ENTERING_CONFIRMEDSTATE:
+            c->callbacks.confirmStateCallback = callback;
+            c->callbacks.confirmedRemoveBranch = removeBranch;
+            return UA_STATUSCODE_GOOD;
 
-                case UA_ENTERING_ACTIVESTATE:
-                    c->callbacks.activeStateCallback = callback;
-                    return UA_STATUSCODE_GOOD;
+        case UA_ENTERING_ACTIVESTATE:
+            c->callbacks.activeStateCallback = callback;
+            return UA_STATUSCODE_GOOD;
 
-                default:
-                    return UA_STATUSCODE_BADNOTFOUND;
-            }
-        }
+        default:
+            return UA_STATUSCODE_BADNOTFOUND;
     }
-    return UA_STATUSCODE_BADNOTFOUND;
 }
 
 static UA_StatusCode
@@ -223,26 +527,13 @@ static UA_StatusCode
 callConditionTwoStateVariableCallback(UA_Server *server, const UA_NodeId *condition,
                                       const UA_NodeId *conditionSource, UA_Boolean *removeBranch,
                                       UA_TwoStateVariableCallbackType callbackType) {
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(UA_NodeId_equal(&cond->conditionId, condition)) {
-                return getConditionTwoStateVariableCallback(server, condition, cond,
-                                                            removeBranch, callbackType);
-            }
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                if(!UA_NodeId_equal(&branch->conditionBranchId, condition))
-                    continue;
-                return getConditionTwoStateVariableCallback(server, &branch->conditionBranchId,
-                                                            cond, removeBranch, callbackType);
-            }
-        }
-    }
-    return UA_STATUSCODE_BADNOTFOUND;
+    /* The condition or one of its branches */
+    UA_ConditionBranch *branch = findConditionBranch(server, condition);
+    if(!branch ||
+       !UA_NodeId_equal(&branch->condition->source->conditionSourceId, conditionSource))
+        return UA_STATUSCODE_BADNOTFOUND;
+    return getConditionTwoStateVariableCallback(server, condition, branch->condition,
+                                                removeBranch, callbackType);
 }
 
 /* Gets the parent NodeId of a Field (e.g. Severity) or Field Property (e.g.
@@ -275,45 +566,147 @@ getFieldParentNodeId(UA_Server *server, const UA_NodeId *field, UA_NodeId *paren
     return retval;
 }
 
-/* Gets the NodeId of a Field (e.g. Severity) */
+/* Drop the cached field NodeIds of the condition (or branch). For example
+ * when the fields of the condition have changed. */
+static void
+clearConditionFieldCache(UA_ConditionBranch *branch) {
+    for(size_t i = 0; i < UA_CONDITION_FIELDCACHESIZE; i++)
+        UA_NodeId_clear(&branch->fieldCache[i]);
+}
+
+void
+invalidateConditionFieldCache(UA_Server *server) {
+    server->conditionFieldCacheGeneration++;
+    if(server->conditionFieldCacheGeneration != 0)
+        return;
+
+    /* Outdated caches could match again after the overflow */
+    UA_ConditionSource *source;
+    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
+        UA_Condition *cond;
+        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
+            UA_ConditionBranch *branch;
+            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
+                clearConditionFieldCache(branch);
+                branch->fieldCacheGeneration = 0;
+            }
+        }
+    }
+}
+
+/* Returns the entry of the field in the cache of the condition (or branch).
+ * NULL if the condition is not (yet) in the condition list or the field is not
+ * cached. */
+static UA_NodeId *
+getConditionFieldCacheEntry(UA_Server *server, const UA_NodeId *conditionNodeId,
+                            const UA_QualifiedName *fieldName,
+                            const UA_QualifiedName *propertyName) {
+    UA_ConditionBranch *branch = findConditionBranch(server, conditionNodeId);
+    if(!branch)
+        return NULL;
+
+    /* Nodes were deleted or references removed since the fields were cached */
+    if(branch->fieldCacheGeneration != server->conditionFieldCacheGeneration) {
+        clearConditionFieldCache(branch);
+        branch->fieldCacheGeneration = server->conditionFieldCacheGeneration;
+    }
+
+    for(size_t i = 0; i < UA_CONDITION_FIELDCACHESIZE; i++) {
+        const UA_QualifiedName *property = cachedConditionFields[i].property;
+        if((property == NULL) != (propertyName == NULL))
+            continue;
+        if(!UA_QualifiedName_equal(cachedConditionFields[i].field, fieldName))
+            continue;
+        if(property && !UA_QualifiedName_equal(property, propertyName))
+            continue;
+        return &branch->fieldCache[i];
+    }
+    return NULL;
+}
+
+/* Resolve the child node by its BrowseName. The result is stored in the cache
+ * entry if one is given. */
 static UA_StatusCode
-getConditionFieldNodeId(UA_Server *server, const UA_NodeId *conditionNodeId,
-                        const UA_QualifiedName* fieldName, UA_NodeId *outFieldNodeId) {
+resolveConditionField(UA_Server *server, const UA_NodeId *parent,
+                      const UA_QualifiedName *name, UA_NodeId *cacheEntry,
+                      UA_NodeId *outNodeId) {
     UA_BrowsePathResult bpr =
-        UA_Server_browseSimplifiedBrowsePath(server, *conditionNodeId, 1, fieldName);
+        UA_Server_browseSimplifiedBrowsePath(server, *parent, 1, name);
     if(bpr.statusCode != UA_STATUSCODE_GOOD)
         return bpr.statusCode;
-    UA_StatusCode retval = UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, outFieldNodeId);
+    UA_StatusCode retval = UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, outNodeId);
+    if(retval == UA_STATUSCODE_GOOD && cacheEntry &&
+       UA_NodeId_copy(outNodeId, cacheEntry) != UA_STATUSCODE_GOOD)
+        UA_NodeId_init(cacheEntry);
     UA_BrowsePathResult_clear(&bpr);
     return retval;
 }
 
+/* Gets the NodeId of a Field (e.g. Severity) */
+static UA_StatusCode
+getConditionFieldNodeId(UA_Server *server, const UA_NodeId *conditionNodeId,
+                        const UA_QualifiedName* fieldName, UA_NodeId *outFieldNodeId) {
+    UA_NodeId *cacheEntry =
+        getConditionFieldCacheEntry(server, conditionNodeId, fieldName, NULL);
+    if(cacheEntry && !UA_NodeId_isNull(cacheEntry))
+        return UA_NodeId_copy(cacheEntry, outFieldNodeId);
+    return resolveConditionField(server, conditionNodeId, fieldName,
+                                 cacheEntry, outFieldNodeId);
+}
+
 /* Gets the NodeId of a Field Property (e.g. EnabledState/Id) */
 static UA_StatusCode
 getConditionFieldPropertyNodeId(UA_Server *server, const UA_NodeId *originCondition,
                                 const UA_QualifiedName* variableFieldName,
                                 const UA_QualifiedName* variablePropertyName,
                                 UA_NodeId *outFieldPropertyNodeId) {
+    UA_NodeId *cacheEntry =
+        getConditionFieldCacheEntry(server, originCondition, variableFieldName,
+                                    variablePropertyName);
+    if(cacheEntry && !UA_NodeId_isNull(cacheEntry))
+        return UA_NodeId_copy(cacheEntry, outFieldPropertyNodeId);
+
     /* 1) Find Variable Field of the Condition */
-    UA_BrowsePathResult bprConditionVariableField =
-        UA_Server_browseSimplifiedBrowsePath(server, *originCondition, 1, variableFieldName);
-    if(bprConditionVariableField.statusCode != UA_STATUSCODE_GOOD)
-        return bprConditionVariableField.statusCode;
+    UA_NodeId variableField;
+    UA_StatusCode retval =
+        getConditionFieldNodeId(server, originCondition, variableFieldName, &variableField);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
 
     /* 2) Find Property of the Variable Field of the Condition */
-    UA_BrowsePathResult bprVariableFieldProperty =
-        UA_Server_browseSimplifiedBrowsePath(server, bprConditionVariableField.targets->targetId.nodeId,
-                                             1, variablePropertyName);
-    if(bprVariableFieldProperty.statusCode != UA_STATUSCODE_GOOD) {
-        UA_BrowsePathResult_clear(&bprConditionVariableField);
-        return bprVariableFieldProperty.statusCode;
-    }
-
-    *outFieldPropertyNodeId = bprVariableFieldProperty.targets[0].targetId.nodeId;
-    UA_NodeId_init(&bprVariableFieldProperty.targets[0].targetId.nodeId);
-    UA_BrowsePathResult_clear(&bprConditionVariableField);
-    UA_BrowsePathResult_clear(&bprVariableFieldProperty);
-    return UA_STATUSCODE_GOOD;
+    retval = resolveConditionField(server, &variableField, variablePropertyName,
+                                   cacheEntry, outFieldPropertyNodeId);
+    UA_NodeId_clear(&variableField);
+    return retval;
+}
+
+/* Writes the value of a Field (fieldName) or Field Property (propertyName not
+ * NULL) */
+static UA_StatusCode
+writeConditionField(UA_Server *server, const UA_NodeId *condition,
+                    const UA_QualifiedName *fieldName,
+                    const UA_QualifiedName *propertyName, const UA_Variant *value) {
+    UA_NodeId fieldNodeId;
+    UA_StatusCode retval;
+    if(propertyName)
+        retval = getConditionFieldPropertyNodeId(server, condition, fieldName,
+                                                 propertyName, &fieldNodeId);
+    else
+        retval = getConditionFieldNodeId(server, condition, fieldName, &fieldNodeId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    retval = UA_Server_writeValue(server, fieldNodeId, *value);
+    UA_NodeId_clear(&fieldNodeId);
+    return retval;
+}
+
+/* Sets the Time field of the condition (e.g. the SourceTimestamp of the state
+ * transition) */
+static UA_StatusCode
+setConditionTime(UA_Server *server, const UA_NodeId *condition, UA_DateTime time) {
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &time, &UA_TYPES[UA_TYPES_DATETIME]);
+    return writeConditionField(server, condition, &fieldTimeQN, NULL, &value);
 }
 
 /* Gets NodeId value of a Field which has NodeId as DataType (e.g. EventType) */
@@ -352,73 +745,42 @@ getConditionBranchNodeId(UA_Server *server, const UA_ByteString *eventId,
     *outConditionBranchNodeId = UA_NODEID_NULL;
     /* The function checks the BranchId based on the event Id, if BranchId ==
        NULL -> outConditionId = ConditionId */
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            /* Get Branch Entry*/
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                if(!UA_ByteString_equal(&branch->lastEventId, eventId))
-                    continue;
-                if(UA_NodeId_isNull(&branch->conditionBranchId))
-                    return UA_NodeId_copy(&cond->conditionId, outConditionBranchNodeId);
-                return UA_NodeId_copy(&branch->conditionBranchId, outConditionBranchNodeId);
-            }
-        }
-    }
-
-    return UA_STATUSCODE_BADEVENTIDUNKNOWN;
+    UA_ConditionBranch *branch = findConditionBranchByEventId(server, eventId);
+    if(!branch)
+        return UA_STATUSCODE_BADEVENTIDUNKNOWN;
+    return UA_NodeId_copy(getBranchNodeId(branch), outConditionBranchNodeId);
 }
 
 static UA_StatusCode
 getConditionLastSeverity(UA_Server *server, const UA_NodeId *conditionSource,
                          const UA_NodeId *conditionId, UA_UInt16 *outLastSeverity,
                          UA_DateTime *outLastSeveritySourceTimeStamp) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, conditionId))
-                continue;
-            *outLastSeverity = cond->lastSeverity;
-            *outLastSeveritySourceTimeStamp = cond->lastSeveritySourceTimeStamp;
-            return UA_STATUSCODE_GOOD;
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, conditionId);
+    if(!cond) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Entry not found in list!");
+        return UA_STATUSCODE_BADNOTFOUND;
     }
-
-    UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Entry not found in list!");
-    return UA_STATUSCODE_BADNOTFOUND;
+    *outLastSeverity = cond->lastSeverity;
+    *outLastSeveritySourceTimeStamp = cond->lastSeveritySourceTimeStamp;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
 updateConditionLastSeverity(UA_Server *server, const UA_NodeId *conditionSource,
                             const UA_NodeId *conditionId, UA_UInt16 lastSeverity,
                             UA_DateTime lastSeveritySourceTimeStamp) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, conditionId))
-                continue;
-            cond->lastSeverity = lastSeverity;
-            cond->lastSeveritySourceTimeStamp =  lastSeveritySourceTimeStamp;
-            return UA_STATUSCODE_GOOD;
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, conditionId);
+    if(!cond) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Entry not found in list!");
+        return UA_STATUSCODE_BADNOTFOUND;
     }
-
-    UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Entry not found in list!");
-    return UA_STATUSCODE_BADNOTFOUND;
+    cond->lastSeverity = lastSeverity;
+    cond->lastSeveritySourceTimeStamp =  lastSeveritySourceTimeStamp;
+    return UA_STATUSCODE_GOOD;
 }
 
 
@@ -426,138 +788,91 @@ static UA_StatusCode
 getConditionActiveState(UA_Server *server, const UA_NodeId *conditionSource,
                          const UA_NodeId *conditionId, UA_ActiveState *outLastActiveState,
                          UA_ActiveState *outCurrentActiveState, UA_Boolean *outIsLimitAlarm) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, conditionId))
-                continue;
-            *outLastActiveState = cond->lastActiveState;
-            *outCurrentActiveState = cond->currentActiveState;
-            *outIsLimitAlarm = cond->isLimitAlarm;
-            return UA_STATUSCODE_GOOD;
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, conditionId);
+    if(!cond) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Entry not found in list!");
+        return UA_STATUSCODE_BADNOTFOUND;
     }
-
-    UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Entry not found in list!");
-    return UA_STATUSCODE_BADNOTFOUND;
+    *outLastActiveState = cond->lastActiveState;
+    *outCurrentActiveState = cond->currentActiveState;
+    *outIsLimitAlarm = cond->isLimitAlarm;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
 updateConditionActiveState(UA_Server *server, const UA_NodeId *conditionSource,
                             const UA_NodeId *conditionId, const UA_ActiveState lastActiveState,
                             const UA_ActiveState currentActiveState, UA_Boolean isLimitAlarm) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, conditionId))
-                continue;
-            cond->lastActiveState = lastActiveState;
-            cond->currentActiveState = currentActiveState;
-            cond->isLimitAlarm = isLimitAlarm;
-            return UA_STATUSCODE_GOOD;
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, conditionId);
+    if(!cond) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Entry not found in list!");
+        return UA_STATUSCODE_BADNOTFOUND;
     }
-
-    UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Entry not found in list!");
-    return UA_STATUSCODE_BADNOTFOUND;
+    cond->lastActiveState = lastActiveState;
+    cond->currentActiveState = currentActiveState;
+    cond->isLimitAlarm = isLimitAlarm;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
 updateConditionLastEventId(UA_Server *server, const UA_NodeId *triggeredEvent,
                            const UA_NodeId *ConditionSource, const UA_ByteString *lastEventId) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, ConditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, triggeredEvent))
-                continue;
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                if(UA_NodeId_isNull(&branch->conditionBranchId)) {
-                    /* update main condition branch */
-                    UA_ByteString_clear(&branch->lastEventId);
-                    return UA_ByteString_copy(lastEventId, &branch->lastEventId);
-                }
-                UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
-                             "Condition Branch not implemented");
-                return UA_STATUSCODE_BADNOTFOUND;
-            }
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, ConditionSource, triggeredEvent);
+    UA_ConditionBranch *branch = (cond) ? LIST_FIRST(&cond->conditionBranchHead) : NULL;
+    if(!branch) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Entry not found in list!");
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+    if(!UA_NodeId_isNull(&branch->conditionBranchId)) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Condition Branch not implemented");
+        return UA_STATUSCODE_BADNOTFOUND;
     }
 
-    UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Entry not found in list!");
-    return UA_STATUSCODE_BADNOTFOUND;
+    /* update main condition branch */
+    return setBranchLastEventId(server, branch, lastEventId);
 }
 
 static void
 setIsCallerAC(UA_Server *server, const UA_NodeId *condition,
               const UA_NodeId *conditionSource, UA_Boolean isCallerAC) {
-    /* Get conditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, condition))
-                continue;
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                if(UA_NodeId_isNull(&branch->conditionBranchId)) {
-                    branch->isCallerAC = isCallerAC;
-                    return;
-                }
-                UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
-                             "Condition Branch not implemented");
-                return;
-            }
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, condition);
+    UA_ConditionBranch *branch = (cond) ? LIST_FIRST(&cond->conditionBranchHead) : NULL;
+    if(!branch) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Entry not found in list!");
+        return;
     }
-
-    UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND, "Entry not found in list!");
+    if(!UA_NodeId_isNull(&branch->conditionBranchId)) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Condition Branch not implemented");
+        return;
+    }
+    branch->isCallerAC = isCallerAC;
 }
 
 UA_Boolean
 isConditionOrBranch(UA_Server *server, const UA_NodeId *condition,
                     const UA_NodeId *conditionSource, UA_Boolean *isCallerAC) {
-    /* Get conditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, condition))
-                continue;
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                if(UA_NodeId_isNull(&branch->conditionBranchId)) {
-                    *isCallerAC = branch->isCallerAC;
-                    return true;
-                }
-                UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
-                             "Condition Branch not implemented");
-                return false;
-            }
-        }
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, condition);
+    UA_ConditionBranch *branch = (cond) ? LIST_FIRST(&cond->conditionBranchHead) : NULL;
+    if(!branch)
+        return false;
+    if(!UA_NodeId_isNull(&branch->conditionBranchId)) {
+        UA_LOG_ERROR(&server->config.logger, UA_LOGCATEGORY_USERLAND,
+                     "Condition Branch not implemented");
+        return false;
     }
-    return false;
+    *isCallerAC = branch->isCallerAC;
+    return true;
 }
 
 static UA_Boolean
@@ -632,67 +947,57 @@ isTwoStateVariableInTrueState(UA_Server *server, const UA_NodeId *condition,
 static UA_StatusCode
 enteringDisabledState(UA_Server *server, const UA_NodeId *conditionId,
                       const UA_NodeId *conditionSource) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, conditionId);
+    if(!cond)
+        return UA_STATUSCODE_BADNOTFOUND;
+    UA_ConditionSource *source = cond->source;
+
+    /* Get Branch Entry*/
+    UA_ConditionBranch *branch;
+    LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
+        UA_NodeId triggeredNode;
+        if(UA_NodeId_isNull(&branch->conditionBranchId))
+            //disable main Condition Branch (BranchId == NULL)
+            triggeredNode = cond->conditionId;
+        else //disable all branches
+            triggeredNode = branch->conditionBranchId;
+
+        UA_LocalizedText message = UA_LOCALIZEDTEXT(LOCALE, DISABLED_MESSAGE);
+        UA_LocalizedText enableText = UA_LOCALIZEDTEXT(LOCALE, DISABLED_TEXT);
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        UA_StatusCode retval = UA_Server_setConditionField(server, triggeredNode,
+                                                           &value, fieldMessageQN);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "Set Condition Message failed",);
 
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, conditionId))
-                continue;
+        UA_Variant_setScalar(&value, &enableText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        retval = UA_Server_setConditionField(server, triggeredNode, &value, fieldEnabledStateQN);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "Set Condition EnabledState text failed",);
 
-            /* Get Branch Entry*/
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                UA_NodeId triggeredNode;
-                if(UA_NodeId_isNull(&branch->conditionBranchId))
-                    //disable main Condition Branch (BranchId == NULL)
-                    triggeredNode = cond->conditionId;
-                else //disable all branches
-                    triggeredNode = branch->conditionBranchId;
+        UA_Boolean retain = false;
+        UA_Variant_setScalar(&value, &retain, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        retval = UA_Server_setConditionField(server, triggeredNode, &value, fieldRetainQN);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "Set Condition Retain failed",);
 
-                UA_LocalizedText message = UA_LOCALIZEDTEXT(LOCALE, DISABLED_MESSAGE);
-                UA_LocalizedText enableText = UA_LOCALIZEDTEXT(LOCALE, DISABLED_TEXT);
-                UA_Variant value;
-                UA_Variant_setScalar(&value, &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-                UA_StatusCode retval = UA_Server_setConditionField(server, triggeredNode,
-                                                                   &value, fieldMessageQN);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "Set Condition Message failed",);
-
-                UA_Variant_setScalar(&value, &enableText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-                retval = UA_Server_setConditionField(server, triggeredNode, &value, fieldEnabledStateQN);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "Set Condition EnabledState text failed",);
-
-                UA_Boolean retain = false;
-                UA_Variant_setScalar(&value, &retain, &UA_TYPES[UA_TYPES_BOOLEAN]);
-                retval = UA_Server_setConditionField(server, triggeredNode, &value, fieldRetainQN);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "Set Condition Retain failed",);
-
-                /* Trigger event */
-                UA_ByteString lastEventId = UA_BYTESTRING_NULL;
-                /* Trigger the event for Condition or its Branch */
-                setIsCallerAC(server, &triggeredNode, conditionSource, true);
-                //Condition Nodes should not be deleted after triggering the event
-                retval = UA_Server_triggerEvent(server, triggeredNode, source->conditionSourceId,
-                                                &lastEventId, false);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "Triggering condition event failed",);
-                setIsCallerAC(server, &triggeredNode, conditionSource, false);
-
-                /* Update list */
-                retval = updateConditionLastEventId(server, &triggeredNode,
-                                                    &source->conditionSourceId, &lastEventId);
-                UA_ByteString_clear(&lastEventId);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "updating condition event failed",);
-            }
+        /* Trigger event */
+        UA_ByteString lastEventId = UA_BYTESTRING_NULL;
+        /* Trigger the event for Condition or its Branch */
+        setIsCallerAC(server, &triggeredNode, conditionSource, true);
+        //Condition Nodes should not be deleted after triggering the event
+        retval = UA_Server_triggerEvent(server, triggeredNode, source->conditionSourceId,
+                                        &lastEventId, false);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "Triggering condition event failed",);
+        setIsCallerAC(server, &triggeredNode, conditionSource, false);
 
-            return UA_STATUSCODE_GOOD;
-        }
+        /* Update list */
+        retval = updateConditionLastEventId(server, &triggeredNode,
+                                            &source->conditionSourceId, &lastEventId);
+        UA_ByteString_clear(&lastEventId);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "updating condition event failed",);
     }
 
-    return UA_STATUSCODE_BADNOTFOUND;
+    return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
@@ -704,54 +1009,45 @@ enteringEnabledState(UA_Server *server,
     UA_NodeId triggeredNode;
     UA_Variant value;
 
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(!UA_NodeId_equal(&cond->conditionId, conditionId))
-                continue;
-            /* Get Branch Entry*/
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                UA_NodeId_init(&triggeredNode);
-                if(UA_NodeId_isNull(&branch->conditionBranchId)) //enable main Condition
-                    triggeredNode = cond->conditionId;
-                else //enable branches
-                    triggeredNode = branch->conditionBranchId;
+    /* Get Condition Entry */
+    UA_Condition *cond = findCondition(server, conditionSource, conditionId);
+    if(!cond)
+        return UA_STATUSCODE_BADNOTFOUND;
 
-                message = UA_LOCALIZEDTEXT(LOCALE, ENABLED_MESSAGE);
-                enableText = UA_LOCALIZEDTEXT(LOCALE, ENABLED_TEXT);
-                UA_Variant_setScalar(&value, &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-                UA_StatusCode retval = UA_Server_setConditionField(server, triggeredNode,
-                                                                   &value, fieldMessageQN);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "set Condition Message failed",);
-
-                UA_Variant_setScalar(&value, &enableText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-                retval = UA_Server_setConditionField(server, triggeredNode, &value, fieldEnabledStateQN);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "set Condition EnabledState text failed",);
-
-                /* User callback TODO how should branches be evaluated? see p.19 (5.5.2) */
-                UA_Boolean removeBranch = false;//not used
-                retval = callConditionTwoStateVariableCallback(server, &triggeredNode,
-                                                               conditionSource, &removeBranch,
-                                                               UA_ENTERING_ENABLEDSTATE);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "calling condition callback failed",);
-
-                /* Trigger event */
-                //Condition Nodes should not be deleted after triggering the event
-                retval = UA_Server_triggerConditionEvent(server, triggeredNode, *conditionSource, NULL);
-                CONDITION_ASSERT_RETURN_RETVAL(retval, "triggering condition event failed",);
-            }
+    /* Get Branch Entry*/
+    UA_ConditionBranch *branch;
+    LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
+        UA_NodeId_init(&triggeredNode);
+        if(UA_NodeId_isNull(&branch->conditionBranchId)) //enable main Condition
+            triggeredNode = cond->conditionId;
+        else //enable branches
+            triggeredNode = branch->conditionBranchId;
+
+        message = UA_LOCALIZEDTEXT(LOCALE, ENABLED_MESSAGE);
+        enableText = UA_LOCALIZEDTEXT(LOCALE, ENABLED_TEXT);
+        UA_Variant_setScalar(&value, &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        UA_StatusCode retval = UA_Server_setConditionField(server, triggeredNode,
+                                                           &value, fieldMessageQN);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "set Condition Message failed",);
+
+        UA_Variant_setScalar(&value, &enableText, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        retval = UA_Server_setConditionField(server, triggeredNode, &value, fieldEnabledStateQN);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "set Condition EnabledState text failed",);
+
+        /* User callback TODO how should branches be evaluated? see p.19 (5.5.2) */
+        UA_Boolean removeBranch = false;//not used
+        retval = callConditionTwoStateVariableCallback(server, &triggeredNode,
+                                                       conditionSource, &removeBranch,
+                                                       UA_ENTERING_ENABLEDSTATE);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "calling condition callback failed",);
 
-            return UA_STATUSCODE_GOOD;
-        }
+        /* Trigger event */
+        //Condition Nodes should not be deleted after triggering the event
+        retval = UA_Server_triggerConditionEvent(server, triggeredNode, *conditionSource, NULL);
+        CONDITION_ASSERT_RETURN_RETVAL(retval, "triggering condition event failed",);
     }
 
-    return UA_STATUSCODE_BADNOTFOUND;
+    return UA_STATUSCODE_GOOD;
 }
 
 static void
@@ -778,9 +1074,7 @@ afterWriteCallbackEnabledStateChange(UA_Server *server,
                                  UA_NodeId_clear(&conditionNode););
 
     /* Set disabling/enabling time */
-    retval = UA_Server_writeObjectProperty_scalar(server, conditionNode, fieldTimeQN,
-                                                  (const UA_DateTime*)&data->sourceTimestamp,
-                                                  &UA_TYPES[UA_TYPES_DATETIME]);
+    retval = setConditionTime(server, &conditionNode, data->sourceTimestamp);
     CONDITION_ASSERT_RETURN_VOID(retval, "Set enabling/disabling Time failed",
                                  UA_NodeId_clear(&conditionNode);
                                  UA_NodeId_clear(&conditionSource););
@@ -822,9 +1116,7 @@ afterWriteCallbackAckedStateChange(UA_Server *server,
      * That check makes it possible to set ackedState/Id to false, without triggering an event */
     if(*((UA_Boolean *)data->value.data) == false) {
         /* Set unacknowledging time */
-        retval = UA_Server_writeObjectProperty_scalar(server, conditionNode, fieldTimeQN,
-                                                      &data->sourceTimestamp,
-                                                      &UA_TYPES[UA_TYPES_DATETIME]);
+        retval = setConditionTime(server, &conditionNode, data->sourceTimestamp);
         CONDITION_ASSERT_RETURN_VOID(retval, "Set deactivating Time failed",
                                      UA_NodeId_clear(&conditionNode););
 
@@ -913,9 +1205,7 @@ afterWriteCallbackConfirmedStateChange(UA_Server *server,
      * That check makes it possible to set ConfirmedState/Id to false, without triggering an event */
     if(*((UA_Boolean *)data->value.data) == false) {
         /* Set unconfirming time */
-        retval = UA_Server_writeObjectProperty_scalar(server, conditionNode, fieldTimeQN,
-                                                      &data->sourceTimestamp,
-                                                      &UA_TYPES[UA_TYPES_DATETIME]);
+        retval = setConditionTime(server, &conditionNode, data->sourceTimestamp);
         CONDITION_ASSERT_RETURN_VOID(retval, "Set deactivating Time failed",
                                      UA_NodeId_clear(&conditionNode););
         
@@ -943,9 +1233,7 @@ afterWriteCallbackConfirmedStateChange(UA_Server *server,
     }
 
     /* Set confirming time */
-    retval = UA_Server_writeObjectProperty_scalar(server, conditionNode, fieldTimeQN,
-                                                  &data->sourceTimestamp,
-                                                  &UA_TYPES[UA_TYPES_DATETIME]);
+    retval = setConditionTime(server, &conditionNode, data->sourceTimestamp);
     CONDITION_ASSERT_RETURN_VOID(retval, "Set Confirming Time failed",
                                  UA_NodeId_clear(&conditionNode););
     
@@ -1050,9 +1338,7 @@ afterWriteCallbackActiveStateChange(UA_Server *server,
         if(isTwoStateVariableInTrueState(server, &conditionNode, &fieldEnabledStateQN) &&
             isRetained(server, &conditionNode)) {
             /* Set activating time */
-            retval = UA_Server_writeObjectProperty_scalar(server, conditionNode, fieldTimeQN,
-                                                          &data->sourceTimestamp,
-                                                          &UA_TYPES[UA_TYPES_DATETIME]);
+            retval = setConditionTime(server, &conditionNode, data->sourceTimestamp);
             CONDITION_ASSERT_RETURN_VOID(retval, "Set activating Time failed",
                                          UA_NodeId_clear(&conditionNode);
                                          UA_NodeId_clear(&conditionSource););
@@ -1105,9 +1391,7 @@ afterWriteCallbackActiveStateChange(UA_Server *server,
                                      UA_NodeId_clear(&conditionSource););
         
         /* Set deactivating time */
-        retval = UA_Server_writeObjectProperty_scalar(server, conditionNode, fieldTimeQN,
-                                                      &data->sourceTimestamp,
-                                                      &UA_TYPES[UA_TYPES_DATETIME]);
+        retval = setConditionTime(server, &conditionNode, data->sourceTimestamp);
         CONDITION_ASSERT_RETURN_VOID(retval, "Set deactivating Time failed",
                                      UA_NodeId_clear(&conditionNode);
                                      UA_NodeId_clear(&conditionSource););
@@ -1320,9 +1604,7 @@ addCommentMethodCallback(UA_Server *server, const UA_NodeId *sessionId,
                                    UA_NodeId_clear(&triggerEvent););
     
     /* Set adding comment time (the same value of SourceTimestamp) */
-    retval = UA_Server_writeObjectProperty_scalar(server, triggerEvent, fieldTimeQN,
-                                                  &fieldSourceTimeStampValue,
-                                                  &UA_TYPES[UA_TYPES_DATETIME]);
+    retval = setConditionTime(server, &triggerEvent, fieldSourceTimeStampValue);
     CONDITION_ASSERT_RETURN_RETVAL(retval, "Set enabling/disabling Time failed",
                                    UA_NodeId_clear(&triggerEvent););
     
@@ -1756,8 +2038,9 @@ setConditionInConditionList(UA_Server *server, const UA_NodeId *conditionNodeId,
     }
 
     memset(conditionBranchListEntry, 0, sizeof(UA_ConditionBranch));
+    conditionListEntry->source = conditionSourceEntry;
     LIST_INSERT_HEAD(&conditionSourceEntry->conditionHead, conditionListEntry, listEntry);
-    LIST_INSERT_HEAD(&conditionListEntry->conditionBranchHead, conditionBranchListEntry, listEntry);
+    addConditionBranch(server, conditionListEntry, conditionBranchListEntry);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -1765,11 +2048,9 @@ static UA_StatusCode
 appendConditionEntry(UA_Server *server, const UA_NodeId *conditionNodeId,
                      const UA_NodeId *conditionSourceNodeId) {
     /* Get ConditionSource Entry to see if the ConditionSource Entry already exists*/
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        if(UA_NodeId_equal(&source->conditionSourceId, conditionSourceNodeId))
-            return setConditionInConditionList(server, conditionNodeId, source);
-    }
+    UA_ConditionSource *source = findConditionSource(server, conditionSourceNodeId);
+    if(source)
+        return setConditionInConditionList(server, conditionNodeId, source);
 
     /* ConditionSource not found in list, so we create a new ConditionSource Entry */
     UA_ConditionSource *conditionSourceListEntry;
@@ -1786,24 +2067,25 @@ appendConditionEntry(UA_Server *server, const UA_NodeId *conditionNodeId,
         return retval;
     }
 
-    LIST_INSERT_HEAD(&server->headConditionSource, conditionSourceListEntry, listEntry);
+    addConditionSource(server, conditionSourceListEntry);
     return setConditionInConditionList(server, conditionNodeId, conditionSourceListEntry);
 }
 
-static void deleteAllBranchesFromCondition(UA_Condition *cond)
+static void deleteAllBranchesFromCondition(UA_Server *server, UA_Condition *cond)
 {
     UA_ConditionBranch *branch, *tmp_branch;
     LIST_FOREACH_SAFE(branch, &cond->conditionBranchHead, listEntry, tmp_branch) {
+        removeConditionBranch(server, branch);
+        clearConditionFieldCache(branch);
         UA_NodeId_clear(&branch->conditionBranchId);
         UA_ByteString_clear(&branch->lastEventId);
-        LIST_REMOVE(branch, listEntry);
         UA_free(branch);
     }
 }
 
-static void deleteCondition(UA_Condition *cond)
+static void deleteCondition(UA_Server *server, UA_Condition *cond)
 {
-    deleteAllBranchesFromCondition(cond);
+    deleteAllBranchesFromCondition(server, cond);
     UA_NodeId_clear(&cond->conditionId);
     LIST_REMOVE(cond, listEntry);
     UA_free(cond);
@@ -1811,14 +2093,23 @@ static void deleteCondition(UA_Condition *cond)
 
 void
 UA_ConditionList_delete(UA_Server *server) {
+    /* Drop the indexes first. The entries are then removed from the lists
+     * without updating the indexes. */
+    UA_free(server->conditionSourcesIndex);
+    server->conditionSourcesIndex = NULL;
+    server->conditionSourcesIndexSize = 0;
+    UA_free(server->conditionBranchesIndex);
+    server->conditionBranchesIndex = NULL;
+    server->conditionBranchesIndexSize = 0;
+
     UA_ConditionSource *source, *tmp_source;
     LIST_FOREACH_SAFE(source, &server->headConditionSource, listEntry, tmp_source) {
         UA_Condition *cond, *tmp_cond;
         LIST_FOREACH_SAFE(cond, &source->conditionHead, listEntry, tmp_cond) {
-            deleteCondition(cond);
+            deleteCondition(server, cond);
         }
         UA_NodeId_clear(&source->conditionSourceId);
-        LIST_REMOVE(source, listEntry);
+        removeConditionSource(server, source);
         UA_free(source);
     }
     /* Free memory allocated for RefreshEvents NodeIds */
@@ -1831,27 +2122,12 @@ UA_ConditionList_delete(UA_Server *server) {
 UA_StatusCode
 UA_getConditionId(UA_Server *server, const UA_NodeId *conditionNodeId,
                   UA_NodeId *outConditionId) {
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source;
-    LIST_FOREACH(source, &server->headConditionSource, listEntry) {
-        /* Get Condition Entry */
-        UA_Condition *cond;
-        LIST_FOREACH(cond, &source->conditionHead, listEntry) {
-            if(UA_NodeId_equal(&cond->conditionId, conditionNodeId)) {
-                *outConditionId = cond->conditionId;
-                return UA_STATUSCODE_GOOD;
-            }
-            /* Get Branch Entry*/
-            UA_ConditionBranch *branch;
-            LIST_FOREACH(branch, &cond->conditionBranchHead, listEntry) {
-                if(UA_NodeId_equal(&branch->conditionBranchId, conditionNodeId)) {
-                    *outConditionId = cond->conditionId;
-                    return UA_STATUSCODE_GOOD;
-                }
-            }
-        }
-    }
-    return UA_STATUSCODE_BADNOTFOUND;
+    /* Get the Condition or Branch Entry */
+    UA_ConditionBranch *branch = findConditionBranch(server, conditionNodeId);
+    if(!branch)
+        return UA_STATUSCODE_BADNOTFOUND;
+    *outConditionId = branch->condition->conditionId;
+    return UA_STATUSCODE_GOOD;
 }
 
 /* Check whether the Condition Source Node has "EventSource" or one of its
@@ -2383,6 +2659,11 @@ UA_Server_addConditionOptionalField(UA_Server *server, const UA_NodeId condition
                                     const UA_NodeId conditionType, const UA_QualifiedName fieldName,
                                     UA_NodeId *outOptionalNode) {
 #ifdef CONDITIONOPTIONALFIELDS_SUPPORT
+    /* The fields of the condition change */
+    UA_ConditionBranch *branch = findConditionBranch(server, &condition);
+    if(branch)
+        clearConditionFieldCache(branch);
+
     /* Get optional Field NodId from ConditionType -> user should give the
      * correct ConditionType or Subtype!!!! */
     UA_BrowsePathResult bpr =
@@ -2459,14 +2740,7 @@ UA_Server_setConditionField(UA_Server *server, const UA_NodeId condition,
                                      "Set Condition Field with Array value not implemented",);
     }
 
-    UA_BrowsePathResult bpr = UA_Server_browseSimplifiedBrowsePath(server, condition, 1, &fieldName);
-    if(bpr.statusCode != UA_STATUSCODE_GOOD)
-        return bpr.statusCode;
-
-    UA_StatusCode retval = UA_Server_writeValue(server, bpr.targets[0].targetId.nodeId, *value);
-    UA_BrowsePathResult_clear(&bpr);
-
-    return retval;
+    return writeConditionField(server, &condition, &fieldName, NULL, value);
 }
 
 /* Set the value of property of condition field. */
@@ -2482,27 +2756,8 @@ UA_Server_setConditionVariableFieldProperty(UA_Server *server, const UA_NodeId c
                                      "Set Property of Condition Field with Array value not implemented",);
     }
 
-    /*1) find Variable Field of the Condition*/
-    UA_BrowsePathResult bprConditionVariableField =
-        UA_Server_browseSimplifiedBrowsePath(server, condition, 1, &variableFieldName);
-    if(bprConditionVariableField.statusCode != UA_STATUSCODE_GOOD)
-        return bprConditionVariableField.statusCode;
-
-    /*2) find Property of the Variable Field of the Condition*/
-    UA_BrowsePathResult bprVariableFieldProperty =
-        UA_Server_browseSimplifiedBrowsePath(server,
-                                             bprConditionVariableField.targets->targetId.nodeId,
-                                             1, &variablePropertyName);
-    if(bprVariableFieldProperty.statusCode != UA_STATUSCODE_GOOD) {
-        UA_BrowsePathResult_clear(&bprConditionVariableField);
-        return bprVariableFieldProperty.statusCode;
-    }
-
-    UA_StatusCode retval =
-        UA_Server_writeValue(server, bprVariableFieldProperty.targets[0].targetId.nodeId, *value);
-    UA_BrowsePathResult_clear(&bprConditionVariableField);
-    UA_BrowsePathResult_clear(&bprVariableFieldProperty);
-    return retval;
+    return writeConditionField(server, &condition, &variableFieldName,
+                               &variablePropertyName, value);
 }
 
 /* triggers an event only for an enabled condition. The condition list is
@@ -2542,33 +2797,17 @@ UA_Server_triggerConditionEvent(UA_Server *server, const UA_NodeId condition,
 UA_StatusCode UA_Server_deleteCondition(UA_Server *server, const UA_NodeId condition,
                                         const UA_NodeId conditionSource) {
     // Delete from internal list
-    UA_Boolean found = UA_FALSE;
-    /* Get ConditionSource Entry */
-    UA_ConditionSource *source, *tmp_source;
-    LIST_FOREACH_SAFE(source, &server->headConditionSource, listEntry, tmp_source) {
-        if(!UA_NodeId_equal(&source->conditionSourceId, &conditionSource))
-            continue;
-        /* Get Condition Entry */
-        UA_Condition *cond, *tmp_cond;
-        LIST_FOREACH_SAFE(cond, &source->conditionHead, listEntry, tmp_cond) {
-            if(!UA_NodeId_equal(&cond->conditionId, &condition))
-                continue;
-            deleteCondition(cond);
-            found = UA_TRUE;
-            break;
-        }
-
-        if(LIST_EMPTY(&source->conditionHead)){
-            UA_NodeId_clear(&source->conditionSourceId);
-            LIST_REMOVE(source, listEntry);
-            UA_free(source);
-        }
-        break;
-    }
-    if(!found)
-    {
+    UA_Condition *cond = findCondition(server, &conditionSource, &condition);
+    if(!cond)
         return UA_STATUSCODE_BADNOTFOUND;
+    UA_ConditionSource *source = cond->source;
+    deleteCondition(server, cond);
+    if(LIST_EMPTY(&source->conditionHead)) {
+        UA_NodeId_clear(&source->conditionSourceId);
+        removeConditionSource(server, source);
+        UA_free(source);
     }
+
     // Delete from address space
     return UA_Server_deleteNode(server, condition, true);
 }
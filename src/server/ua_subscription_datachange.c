@@ -202,7 +202,7 @@ UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_Subscription
                                               UA_MonitoredItem *mon,
                                               const UA_DataValue *value) {
     /* Allocate a new notification */
-    UA_Notification *newNotification = UA_Notification_new();
+    UA_Notification *newNotification = UA_Notification_new(server);
     if(!newNotification)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -211,7 +211,7 @@ UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_Subscription
     newNotification->data.dataChange.clientHandle = mon->parameters.clientHandle;
     UA_StatusCode retval = UA_DataValue_copy(value, &newNotification->data.dataChange.value);
     if(retval != UA_STATUSCODE_GOOD) {
-        UA_free(newNotification);
+        UA_Notification_delete(server, newNotification);
         return retval;
     }
 
@@ -223,6 +223,31 @@ UA_MonitoredItem_createDataChangeNotification(UA_Server *server, UA_Subscription
     return UA_STATUSCODE_GOOD;
 }
 
+/* Copy the value into the lastValue of the MonitoredItem. Scalars of the same
+ * pointer-free type are written into the existing memory. This saves a malloc
+ * and a free for every sample with a changed value. */
+static UA_StatusCode
+storeLastValue(UA_DataValue *lastValue, const UA_DataValue *value) {
+    const UA_Variant *v = &value->value;
+    UA_Variant *lv = &lastValue->value;
+    if(!value->hasValue || !lastValue->hasValue ||
+       v->type != lv->type || !v->type || !v->type->pointerFree ||
+       !UA_Variant_isScalar(v) || !UA_Variant_isScalar(lv) ||
+       v->arrayDimensionsSize > 0 || lv->arrayDimensionsSize > 0 ||
+       lv->storageType != UA_VARIANT_DATA || !lv->data || !v->data) {
+        UA_DataValue_clear(lastValue);
+        return UA_DataValue_copy(value, lastValue);
+    }
+
+    /* Reuse the memory of the scalar */
+    void *data = lv->data;
+    memcpy(data, v->data, v->type->memSize);
+    *lastValue = *value;
+    lastValue->value.data = data;
+    lastValue->value.storageType = UA_VARIANT_DATA;
+    return UA_STATUSCODE_GOOD;
+}
+
 /* Moves the value to the MonitoredItem if successful */
 static UA_StatusCode
 sampleCallbackWithValue(UA_Server *server, UA_Session *session,
@@ -258,41 +283,57 @@ sampleCallbackWithValue(UA_Server *server, UA_Session *session,
     }
 
     /* The MonitoredItem is attached to a subscription (not server-local).
-     * Prepare a notification and enqueue it. */
+     * Prepare a notification and move the sample into it. The lastValue for
+     * filter comparison and TransferSubscription is a copy. */
     if(sub) {
-        retval = UA_MonitoredItem_createDataChangeNotification(server, sub, mon, value);
+        UA_Notification *newNotification = UA_Notification_new(server);
+        if(!newNotification) {
+            UA_ByteString_clear(&binValueEncoding);
+            UA_DataValue_clear(value);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        retval = storeLastValue(&mon->lastValue, value);
         if(retval != UA_STATUSCODE_GOOD) {
+            UA_Notification_delete(server, newNotification);
             UA_ByteString_clear(&binValueEncoding);
             UA_DataValue_clear(value);
             return retval;
         }
-    }
 
-    /* <-- Point of no return --> */
+        /* <-- Point of no return --> */
+
+        UA_ByteString_clear(&mon->lastSampledValue);
+        mon->lastSampledValue = binValueEncoding;
+
+        newNotification->mon = mon;
+        newNotification->data.dataChange.clientHandle = mon->parameters.clientHandle;
+        newNotification->data.dataChange.value = *value;
+        UA_Notification_enqueueAndTrigger(server, newNotification);
+        UA_LOG_DEBUG_SUBSCRIPTION(&server->config.logger, sub,
+                                  "MonitoredItem %" PRIi32 " | "
+                                  "Enqueued a new notification", mon->monitoredItemId);
+        return UA_STATUSCODE_GOOD;
+    }
 
     /* Store the encoding for comparison */
     UA_ByteString_clear(&mon->lastSampledValue);
     mon->lastSampledValue = binValueEncoding;
 
-    /* Move/store the value for filter comparison and TransferSubscription */
+    /* Move/store the value for filter comparison */
     UA_DataValue_clear(&mon->lastValue);
     mon->lastValue = *value;
 
-    /* Call the local callback if the MonitoredItem is not attached to a
-     * subscription. Do this at the very end. Because the callback might delete
-     * the subscription. */
-    if(!sub) {
-        UA_LocalMonitoredItem *localMon = (UA_LocalMonitoredItem*) mon;
-        void *nodeContext = NULL;
-        getNodeContext(server, mon->itemToMonitor.nodeId, &nodeContext);
-        UA_UNLOCK(&server->serviceMutex);
-        localMon->callback.dataChangeCallback(server,
-                                              mon->monitoredItemId, localMon->context,
-                                              &mon->itemToMonitor.nodeId, nodeContext,
-                                              mon->itemToMonitor.attributeId, value);
-        UA_LOCK(&server->serviceMutex);
-    }
-
+    /* Call the local callback of the server-local MonitoredItem. Do this at the
+     * very end. Because the callback might delete the MonitoredItem. */
+    UA_LocalMonitoredItem *localMon = (UA_LocalMonitoredItem*) mon;
+    void *nodeContext = NULL;
+    getNodeContext(server, mon->itemToMonitor.nodeId, &nodeContext);
+    UA_UNLOCK(&server->serviceMutex);
+    localMon->callback.dataChangeCallback(server,
+                                          mon->monitoredItemId, localMon->context,
+                                          &mon->itemToMonitor.nodeId, nodeContext,
+                                          mon->itemToMonitor.attributeId, value);
+    UA_LOCK(&server->serviceMutex);
     return UA_STATUSCODE_GOOD;
 }
 
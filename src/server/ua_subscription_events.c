@@ -434,15 +434,15 @@ eventSetStandardFields(UA_Server *server, const UA_NodeId *event,
 UA_StatusCode
 UA_Event_addEventToMonitoredItem(UA_Server *server, const UA_NodeId *event,
                                  UA_MonitoredItem *mon) {
-    UA_Notification *notification = UA_Notification_new();
-    if(!notification)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-
     if(mon->parameters.filter.content.decoded.type != &UA_TYPES[UA_TYPES_EVENTFILTER])
         return UA_STATUSCODE_BADFILTERNOTALLOWED;
     UA_EventFilter *eventFilter = (UA_EventFilter*)
         mon->parameters.filter.content.decoded.data;
 
+    UA_Notification *notification = UA_Notification_new(server);
+    if(!notification)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
     UA_Subscription *sub = mon->subscription;
     UA_Session *session = sub->session;
     UA_StatusCode retval = UA_Server_filterEvent(server, session, event,
@@ -51,7 +51,7 @@ createEventOverflowNotification(UA_Server *server, UA_Subscription *sub,
      * NodeId of the OverflowEventType. */
 
     /* Allocate the notification */
-    UA_Notification *overflowNotification = UA_Notification_new();
+    UA_Notification *overflowNotification = UA_Notification_new(server);
     if(!overflowNotification)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
@@ -61,7 +61,7 @@ createEventOverflowNotification(UA_Server *server, UA_Subscription *sub,
     overflowNotification->data.event.clientHandle = mon->parameters.clientHandle;
     overflowNotification->data.event.eventFields = UA_Variant_new();
     if(!overflowNotification->data.event.eventFields) {
-        UA_free(overflowNotification);
+        UA_Notification_delete(server, overflowNotification);
         return UA_STATUSCODE_BADOUTOFMEMORY;
     }
     overflowNotification->data.event.eventFieldsSize = 1;
@@ -140,16 +140,37 @@ setOverflowInfoBits(UA_MonitoredItem *mon) {
 }
 
 UA_Notification *
-UA_Notification_new(void) {
-    UA_Notification *n = (UA_Notification*)UA_calloc(1, sizeof(UA_Notification));
+UA_Notification_new(UA_Server *server) {
+    /* Take a notification from the freelist or allocate */
+    UA_Notification *n = server->notificationFreeList;
     if(n) {
-        /* Set the sentinel for a notification that is not enqueued */
-        TAILQ_NEXT(n, globalEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
-        TAILQ_NEXT(n, listEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
+        server->notificationFreeList = TAILQ_NEXT(n, listEntry);
+        server->notificationFreeListSize--;
+        memset(n, 0, sizeof(UA_Notification));
+    } else {
+        n = (UA_Notification*)UA_calloc(1, sizeof(UA_Notification));
+        if(!n)
+            return NULL;
     }
+
+    /* Set the sentinel for a notification that is not enqueued */
+    TAILQ_NEXT(n, globalEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
+    TAILQ_NEXT(n, listEntry) = UA_SUBSCRIPTION_QUEUE_SENTINEL;
     return n;
 }
 
+void
+UA_Notification_clearFreeList(UA_Server *server) {
+    UA_Notification *n = server->notificationFreeList;
+    while(n) {
+        UA_Notification *next = TAILQ_NEXT(n, listEntry);
+        UA_free(n);
+        n = next;
+    }
+    server->notificationFreeList = NULL;
+    server->notificationFreeListSize = 0;
+}
+
 static void UA_Notification_dequeueMon(UA_Server *server, UA_Notification *n);
 static void UA_Notification_enqueueSub(UA_Notification *n);
 static void UA_Notification_dequeueSub(UA_Notification *n);
@@ -171,7 +192,15 @@ UA_Notification_delete(UA_Server *server, UA_Notification *n) {
             break;
         }
     }
-    UA_free(n);
+
+    /* Put into the freelist for reuse */
+    if(server->notificationFreeListSize >= UA_NOTIFICATION_FREELIST_MAXSIZE) {
+        UA_free(n);
+        return;
+    }
+    TAILQ_NEXT(n, listEntry) = server->notificationFreeList;
+    server->notificationFreeList = n;
+    server->notificationFreeListSize++;
 }
 
 /* Add to the MonitoredItem queue, update all counters and then handle overflow */
@@ -398,10 +427,8 @@ UA_Server_registerMonitoredItem(UA_Server *server, UA_MonitoredItem *mon) {
 
     /* Register in Subscription and Server */
     if(sub) {
-        mon->monitoredItemId = ++sub->lastMonitoredItemId;
         mon->subscription = sub;
-        sub->monitoredItemsSize++;
-        LIST_INSERT_HEAD(&sub->monitoredItems, mon, listEntry);
+        UA_Subscription_addMonitoredItem(sub, mon);
     } else {
         mon->monitoredItemId = ++server->lastLocalMonitoredItemId;
         LIST_INSERT_HEAD(&server->localMonitoredItems, mon, listEntry);
@@ -458,8 +485,9 @@ UA_Server_unregisterMonitoredItem(UA_Server *server, UA_MonitoredItem *mon) {
 
     /* Deregister in Subscription and server */
     if(sub)
-        sub->monitoredItemsSize--;
-    LIST_REMOVE(mon, listEntry); /* Also for LocalMonitoredItems */
+        UA_Subscription_removeMonitoredItem(sub, mon);
+    else
+        LIST_REMOVE(mon, listEntry); /* LocalMonitoredItems */
     server->monitoredItemsSize--;
 
     mon->registered = false;
@@ -418,6 +418,35 @@ UA_MessageContext_encode(UA_MessageContext *mc, const void *content,
     return retval;
 }
 
+UA_StatusCode
+UA_MessageContext_encodeRaw(UA_MessageContext *mc, const UA_ByteString *encoded) {
+    const UA_Byte *pos = encoded->data;
+    size_t remaining = encoded->length;
+    while(remaining > 0) {
+        /* The chunk is full. Send out and get a new buffer. */
+        if(mc->buf_pos >= mc->buf_end) {
+            UA_Byte *buf_pos = mc->buf_pos;
+            const UA_Byte *buf_end = mc->buf_end;
+            UA_StatusCode retval = sendSymmetricEncodingCallback(mc, &buf_pos, &buf_end);
+            if(retval != UA_STATUSCODE_GOOD) {
+                if(mc->messageBuffer.length > 0)
+                    UA_MessageContext_abort(mc);
+                return retval;
+            }
+        }
+
+        /* Copy as much as fits into the current chunk */
+        size_t possible = (uintptr_t)mc->buf_end - (uintptr_t)mc->buf_pos;
+        if(possible > remaining)
+            possible = remaining;
+        memcpy(mc->buf_pos, pos, possible);
+        mc->buf_pos += possible;
+        pos += possible;
+        remaining -= possible;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_MessageContext_finish(UA_MessageContext *mc) {
     mc->final = true;
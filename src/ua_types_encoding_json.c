@@ -75,9 +75,52 @@ extern const decodeJsonSignature decodeJsonJumpTable[UA_DATATYPEKINDS];
 UA_String UA_DateTime_toJSON(UA_DateTime t);
 ENCODE_JSON(ByteString);
 
+/* Reallocate the output buffer of a growable context so that at least len
+ * more bytes fit. The capacity is doubled to keep the number of reallocations
+ * logarithmic in the size of the encoding. A borrowed initial buffer (e.g. on
+ * the stack) is copied into a new heap buffer instead. */
+static status UA_FUNC_ATTR_WARN_UNUSED_RESULT
+growJsonBuffer(CtxJson *ctx, size_t len) {
+    if(!ctx->growBuffer || ctx->calcOnly)
+        return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    UA_ByteString *buf = ctx->growBuffer;
+    size_t used = (size_t)(ctx->pos - buf->data);
+    size_t newSize = buf->length * 2;
+    if(newSize < UA_JSON_GROWBUFFER_MINSIZE)
+        newSize = UA_JSON_GROWBUFFER_MINSIZE;
+    if(newSize < used + len)
+        newSize = used + len;
+    UA_Byte *newData;
+    if(ctx->growBufferBorrowed) {
+        newData = (UA_Byte*)UA_malloc(newSize);
+        if(!newData)
+            return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+        if(used > 0)
+            memcpy(newData, buf->data, used);
+        ctx->growBufferBorrowed = false;
+    } else {
+        newData = (UA_Byte*)UA_realloc(buf->data, newSize);
+        if(!newData)
+            return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+    }
+    buf->data = newData;
+    buf->length = newSize;
+    ctx->pos = &newData[used];
+    ctx->end = &newData[newSize];
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Ensure that len bytes can be written at ctx->pos */
+static UA_INLINE status UA_FUNC_ATTR_WARN_UNUSED_RESULT
+reserveJson(CtxJson *ctx, size_t len) {
+    if(len <= (size_t)((uintptr_t)ctx->end - (uintptr_t)ctx->pos))
+        return UA_STATUSCODE_GOOD;
+    return growJsonBuffer(ctx, len);
+}
+
 static status UA_FUNC_ATTR_WARN_UNUSED_RESULT
 writeChar(CtxJson *ctx, char c) {
-    if(ctx->pos >= ctx->end)
+    if(ctx->pos >= ctx->end && growJsonBuffer(ctx, 1) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     if(!ctx->calcOnly)
         *ctx->pos = (UA_Byte)c;
@@ -148,7 +191,7 @@ status writeJsonObjElm(CtxJson *ctx, const char *key,
 }
 
 status writeJsonNull(CtxJson *ctx) {
-    if(ctx->pos + 4 > ctx->end)
+    if(reserveJson(ctx, 4) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     if(ctx->calcOnly) {
         ctx->pos += 4;
@@ -213,7 +256,7 @@ static const char* UA_JSONKEY_INNERDIAGNOSTICINFO = "InnerDiagnosticInfo";
 status UA_FUNC_ATTR_WARN_UNUSED_RESULT
 writeJsonKey(CtxJson *ctx, const char* key) {
     size_t size = strlen(key);
-    if(ctx->pos + size + 4 > ctx->end) /* +4 because of " " : and , */
+    if(reserveJson(ctx, size + 4) != UA_STATUSCODE_GOOD) /* +4 because of " " : and , */
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     status ret = writeJsonCommaIfNeeded(ctx);
     ctx->commaNeeded[ctx->depth] = true;
@@ -246,7 +289,7 @@ ENCODE_JSON(Boolean) {
         return UA_STATUSCODE_GOOD;
     }
 
-    if(ctx->pos + sizeOfJSONBool > ctx->end)
+    if(reserveJson(ctx, sizeOfJSONBool) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(*src) {
@@ -274,7 +317,7 @@ ENCODE_JSON(Byte) {
     UA_UInt16 digits = itoaUnsigned(*src, buf, 10);
 
     /* Ensure destination can hold the data- */
-    if(ctx->pos + digits > ctx->end)
+    if(reserveJson(ctx, digits) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     /* Copy digits to the output string/buffer. */
@@ -288,7 +331,7 @@ ENCODE_JSON(Byte) {
 ENCODE_JSON(SByte) {
     char buf[5];
     UA_UInt16 digits = itoaSigned(*src, buf);
-    if(ctx->pos + digits > ctx->end)
+    if(reserveJson(ctx, digits) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     if(!ctx->calcOnly)
         memcpy(ctx->pos, buf, digits);
@@ -301,7 +344,7 @@ ENCODE_JSON(UInt16) {
     char buf[6];
     UA_UInt16 digits = itoaUnsigned(*src, buf, 10);
 
-    if(ctx->pos + digits > ctx->end)
+    if(reserveJson(ctx, digits) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -315,7 +358,7 @@ ENCODE_JSON(Int16) {
     char buf[7];
     UA_UInt16 digits = itoaSigned(*src, buf);
 
-    if(ctx->pos + digits > ctx->end)
+    if(reserveJson(ctx, digits) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -329,7 +372,7 @@ ENCODE_JSON(UInt32) {
     char buf[11];
     UA_UInt16 digits = itoaUnsigned(*src, buf, 10);
 
-    if(ctx->pos + digits > ctx->end)
+    if(reserveJson(ctx, digits) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -343,7 +386,7 @@ ENCODE_JSON(Int32) {
     char buf[12];
     UA_UInt16 digits = itoaSigned(*src, buf);
 
-    if(ctx->pos + digits > ctx->end)
+    if(reserveJson(ctx, digits) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -360,7 +403,7 @@ ENCODE_JSON(UInt64) {
     buf[digits + 1] = '\"';
     UA_UInt16 length = (UA_UInt16)(digits + 2);
 
-    if(ctx->pos + length > ctx->end)
+    if(reserveJson(ctx, length) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -378,7 +421,7 @@ ENCODE_JSON(Int64) {
     buf[digits + 1] = '\"';
     UA_UInt16 length = (UA_UInt16)(digits + 2);
 
-    if(ctx->pos + length > ctx->end)
+    if(reserveJson(ctx, length) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -458,7 +501,7 @@ ENCODE_JSON(Float) {
     
     checkAndEncodeSpecialFloatingPoint(buffer, &len);
     
-    if(ctx->pos + len > ctx->end)
+    if(reserveJson(ctx, len) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -483,7 +526,7 @@ ENCODE_JSON(Double) {
     size_t len = strlen(buffer);
     checkAndEncodeSpecialFloatingPoint(buffer, &len);    
 
-    if(ctx->pos + len > ctx->end)
+    if(reserveJson(ctx, len) != UA_STATUSCODE_GOOD)
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
 
     if(!ctx->calcOnly)
@@ -568,7 +611,7 @@ ENCODE_JSON(String) {
         }
 
         if(pos != str) {
-            if(ctx->pos + (pos - str) > ctx->end)
+            if(reserveJson(ctx, (size_t)(pos - str)) != UA_STATUSCODE_GOOD)
                 return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
             if(!ctx->calcOnly)
                 memcpy(ctx->pos, str, (size_t)(pos - str));
@@ -632,7 +675,7 @@ ENCODE_JSON(String) {
             break;
         }
 
-        if(ctx->pos + length > ctx->end)
+        if(reserveJson(ctx, length) != UA_STATUSCODE_GOOD)
             return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
         if(!ctx->calcOnly)
             memcpy(ctx->pos, text, length);
@@ -662,7 +705,7 @@ ENCODE_JSON(ByteString) {
     if(!ba64)
         return UA_STATUSCODE_BADENCODINGERROR;
 
-    if(ctx->pos + flen > ctx->end) {
+    if(reserveJson(ctx, flen) != UA_STATUSCODE_GOOD) {
         UA_free(ba64);
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     }
@@ -719,7 +762,7 @@ static void UA_Guid_to_hex(const UA_Guid *guid, u8* out) {
 
 /* Guid */
 ENCODE_JSON(Guid) {
-    if(ctx->pos + 38 > ctx->end) /* 36 + 2 (") */
+    if(reserveJson(ctx, 38) != UA_STATUSCODE_GOOD) /* 36 + 2 (") */
         return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
     status ret = writeJsonQuote(ctx);
     u8 *buf = ctx->pos;
@@ -1485,6 +1528,41 @@ UA_encodeJson(const void *src, const UA_DataType *type,
     return ret;
 }
 
+status UA_FUNC_ATTR_WARN_UNUSED_RESULT
+UA_encodeJsonBuffer(const void *src, const UA_DataType *type,
+                    UA_ByteString *buf, size_t *encodedLength,
+                    UA_String *namespaces, size_t namespaceSize,
+                    UA_String *serverUris, size_t serverUriSize,
+                    UA_Boolean useReversible) {
+    if(!src || !type || !buf || !encodedLength)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* An empty ByteString may point to the sentinel */
+    if(buf->length == 0)
+        buf->data = NULL;
+
+    /* Set up the context */
+    CtxJson ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.pos = buf->data;
+    ctx.end = (buf->data) ? &buf->data[buf->length] : NULL;
+    ctx.growBuffer = buf;
+    ctx.namespaces = namespaces;
+    ctx.namespacesSize = namespaceSize;
+    ctx.serverUris = serverUris;
+    ctx.serverUrisSize = serverUriSize;
+    ctx.useReversible = useReversible;
+
+    /* Encode. The buffer only runs full if the reallocation failed. */
+    status ret = encodeJsonJumpTable[type->typeKind](src, type, &ctx);
+    if(ret == UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    *encodedLength = (size_t)(ctx.pos - buf->data);
+    return UA_STATUSCODE_GOOD;
+}
+
 /************/
 /* CalcSize */
 /************/
@@ -2233,116 +2311,68 @@ DECODE_JSON(QualifiedName) {
     return decodeFields(ctx, parseCtx, entries, 2, type);
 }
 
-/* Function for searching ahead of the current token. Used for retrieving the
- * OPC UA type of a token */
-static status
-searchObjectForKeyRec(const char *searchKey, CtxJson *ctx, 
-                      ParseCtx *parseCtx, size_t *resultIndex, UA_UInt16 depth) {
-    UA_StatusCode ret = UA_STATUSCODE_BADNOTFOUND;
-    
-    CHECK_TOKEN_BOUNDS;
-    
-    if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-        size_t objectCount = (size_t)parseCtx->tokenArray[parseCtx->index].size;
-        parseCtx->index++; /*Object to first Key*/
-        
-        for(size_t i = 0; i < objectCount; i++) {
-            CHECK_TOKEN_BOUNDS;
-            if(depth == 0) { /* we search only on first layer */
-                if(jsoneq((char*)ctx->pos, &parseCtx->tokenArray[parseCtx->index], searchKey) == 0) {
-                    /*found*/
-                    parseCtx->index++; /*We give back a pointer to the value of the searched key!*/
-                    if (parseCtx->index >= parseCtx->tokenCount)
-                        /* We got invalid json. See https://bugs.chromium.org/p/oss-fuzz/issues/detail?id=14620 */
-                        return UA_STATUSCODE_BADOUTOFRANGE;
-                    *resultIndex = parseCtx->index;
-                    return UA_STATUSCODE_GOOD;
-                }
-            }
-               
-            parseCtx->index++; /* value */
-            CHECK_TOKEN_BOUNDS;
-            
-            if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else {
-                /* Only Primitive or string */
-                parseCtx->index++;
-            }
-        }
-    } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-        size_t arraySize = (size_t)parseCtx->tokenArray[parseCtx->index].size;
-        parseCtx->index++; /*Object to first element*/
-        
-        for(size_t i = 0; i < arraySize; i++) {
-            CHECK_TOKEN_BOUNDS;
-            if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else if(parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-               ret = searchObjectForKeyRec(searchKey, ctx, parseCtx, resultIndex,
-                                           (UA_UInt16)(depth + 1));
-            } else {
-                /* Only Primitive or string */
-                parseCtx->index++;
-            }
-        }
-    }
-    return ret;
+/* Returns the index of the first token after the value at the given index,
+ * skipping all tokens nested in the value. The tokens are ordered by their
+ * start offset. So the next sibling is the first token that starts after the
+ * end of the value. It is found with a binary search instead of walking over
+ * the nested tokens. */
+static size_t
+skipJsonValue(const ParseCtx *parseCtx, size_t index) {
+    const jsmntok_t *tokens = parseCtx->tokenArray;
+    size_t lo = index + 1;
+    if(tokens[index].type != JSMN_OBJECT && tokens[index].type != JSMN_ARRAY)
+        return lo;
+    size_t hi = (size_t)parseCtx->tokenCount;
+    int end = tokens[index].end;
+    while(lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if(tokens[mid].start < end)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
 }
 
+/* Function for searching ahead of the current token. Used for retrieving the
+ * OPC UA type of a token. Only the keys of the current object are compared.
+ * Nested values are skipped without looking at their tokens. */
 UA_FUNC_ATTR_WARN_UNUSED_RESULT status
 lookAheadForKey(const char* search, CtxJson *ctx,
                 ParseCtx *parseCtx, size_t *resultIndex) {
-    UA_UInt16 oldIndex = parseCtx->index; /* Save index for later restore */
-    
-    UA_UInt16 depth = 0;
-    UA_StatusCode ret  = searchObjectForKeyRec(search, ctx, parseCtx, resultIndex, depth);
-
-    parseCtx->index = oldIndex; /* Restore index */
-    return ret;
-}
-
-/* Function used to jump over an object which cannot be parsed */
-static UA_StatusCode
-jumpOverRec(CtxJson *ctx, ParseCtx *parseCtx) {
-    if(ctx->depth >= UA_JSON_ENCODING_MAX_RECURSION - 1)
-        return UA_STATUSCODE_BADENCODINGERROR;
-
     CHECK_TOKEN_BOUNDS;
-    size_t count = (size_t)(parseCtx->tokenArray[parseCtx->index].size);
-    if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT)
-        count = count * 2; /* The size is for both keys and values */
-        
-    ctx->depth++;
-    UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t i = 0; i < count; i++) {
-        parseCtx->index++;
-        CHECK_TOKEN_BOUNDS;
-        if(parseCtx->tokenArray[parseCtx->index].type == JSMN_OBJECT ||
-           parseCtx->tokenArray[parseCtx->index].type == JSMN_ARRAY) {
-            res |= jumpOverRec(ctx, parseCtx);
+    if(parseCtx->tokenArray[parseCtx->index].type != JSMN_OBJECT)
+        return UA_STATUSCODE_BADNOTFOUND;
+
+    size_t tokenCount = (size_t)parseCtx->tokenCount;
+    size_t keyCount = (size_t)parseCtx->tokenArray[parseCtx->index].size;
+    size_t index = (size_t)parseCtx->index + 1; /* Object to first Key */
+    for(size_t i = 0; i < keyCount; i++) {
+        if(index >= tokenCount)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        if(jsoneq((char*)ctx->pos, &parseCtx->tokenArray[index], search) == 0) {
+            /* We give back a pointer to the value of the searched key */
+            if(index + 1 >= tokenCount)
+                /* We got invalid json. See https://bugs.chromium.org/p/oss-fuzz/issues/detail?id=14620 */
+                return UA_STATUSCODE_BADOUTOFRANGE;
+            *resultIndex = index + 1;
+            return UA_STATUSCODE_GOOD;
         }
+        if(index + 1 >= tokenCount)
+            return UA_STATUSCODE_BADDECODINGERROR;
+        index = skipJsonValue(parseCtx, index + 1); /* Next key */
     }
-    ctx->depth--;
-
-    return res;
+    return UA_STATUSCODE_BADNOTFOUND;
 }
 
-/* returns the index */
+/* Returns the index of the last token within the object which cannot be
+ * parsed */
 static UA_StatusCode
 jumpOverObject(CtxJson *ctx, ParseCtx *parseCtx, size_t *resultIndex) {
-    UA_UInt16 oldIndex = parseCtx->index; /* Save index for later restore */
-    ctx->depth++;
-    UA_StatusCode res = jumpOverRec(ctx, parseCtx);
-    ctx->depth--;
-    *resultIndex = parseCtx->index;
-    parseCtx->index = oldIndex; /* Restore index */
-    return res;
+    (void)ctx;
+    CHECK_TOKEN_BOUNDS;
+    *resultIndex = skipJsonValue(parseCtx, parseCtx->index) - 1;
+    return UA_STATUSCODE_GOOD;
 }
 
 static status
@@ -3056,9 +3086,9 @@ decodeFields(CtxJson *ctx, ParseCtx *parseCtx, DecodeEntry *entries,
                 if(ret != UA_STATUSCODE_GOOD)
                     return ret;
             } else {
-                /*overstep single value, this will not work if object or array
-                 Only used not to double parse pre looked up type, but it has to be overstepped*/
-                parseCtx->index++;
+                /* Overstep the value. Only used not to double parse the pre
+                 * looked up type, but it has to be overstepped. */
+                parseCtx->index = (UA_UInt16)skipJsonValue(parseCtx, parseCtx->index);
             }
             break;
         }
@@ -3216,12 +3246,19 @@ tokenize(ParseCtx *parseCtx, CtxJson *ctx, const UA_ByteString *src) {
     parseCtx->tokenCount = 0;
     parseCtx->index = 0;
 
+    /* The token index is 16bit. Use the default size if no capacity is set. */
+    size_t tokenArraySize = parseCtx->tokenArraySize;
+    if(tokenArraySize == 0)
+        tokenArraySize = UA_JSON_MAXTOKENCOUNT;
+    if(tokenArraySize > UA_UINT16_MAX)
+        tokenArraySize = UA_UINT16_MAX;
+
     /*Set up tokenizer jsmn*/
     jsmn_parser p;
     jsmn_init(&p);
     parseCtx->tokenCount = (UA_Int32)
         jsmn_parse(&p, (char*)src->data, src->length,
-                   parseCtx->tokenArray, UA_JSON_MAXTOKENCOUNT);
+                   parseCtx->tokenArray, (unsigned int)tokenArraySize);
     
     if(parseCtx->tokenCount < 0) {
         if(parseCtx->tokenCount == JSMN_ERROR_NOMEM)
@@ -3239,6 +3276,61 @@ decodeJsonInternal(void *dst, const UA_DataType *type,
     return decodeJsonJumpTable[type->typeKind](dst, type, ctx, parseCtx, moveToken);
 }
 
+/* Decode the value from the tokens. The value is cleaned up on failure. */
+static status
+decodeJsonTokens(void *dst, const UA_DataType *type,
+                 CtxJson *ctx, ParseCtx *parseCtx) {
+    memset(dst, 0, type->memSize); /* Initialize the value */
+
+    /* Assume the top-level element is an object. Or there is only a primitive
+     * to parse. Do it directly. */
+    status ret = UA_STATUSCODE_BADDECODINGERROR;
+    if(parseCtx->tokenCount >= 1 &&
+       parseCtx->tokenArray[0].type == JSMN_OBJECT) {
+        ret = decodeJsonJumpTable[type->typeKind](dst, type, ctx, parseCtx, true);
+    } else if(parseCtx->tokenCount == 1 &&
+              (parseCtx->tokenArray[0].type == JSMN_PRIMITIVE ||
+               parseCtx->tokenArray[0].type == JSMN_STRING)) {
+        ret = decodeJsonJumpTable[type->typeKind](dst, type, ctx, parseCtx, true);
+    }
+
+    /* sanity check if all Tokens were processed */
+    if(!(parseCtx->index == parseCtx->tokenCount ||
+         parseCtx->index == parseCtx->tokenCount-1)) {
+        ret = UA_STATUSCODE_BADDECODINGERROR;
+    }
+
+    if(ret != UA_STATUSCODE_GOOD)
+        UA_clear(dst, type); /* Clean up */
+    return ret;
+}
+
+status UA_FUNC_ATTR_WARN_UNUSED_RESULT
+UA_decodeJsonWithTokens(const UA_ByteString *src, void *dst,
+                        const UA_DataType *type,
+                        jsmntok_t *tokens, size_t tokensSize) {
+#ifndef UA_ENABLE_TYPEDESCRIPTION
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+
+    if(dst == NULL || src == NULL || type == NULL ||
+       tokens == NULL || tokensSize == 0)
+        return UA_STATUSCODE_BADARGUMENTSMISSING;
+
+    /* Set up the context */
+    CtxJson ctx;
+    memset(&ctx, 0, sizeof(CtxJson));
+    ParseCtx parseCtx;
+    memset(&parseCtx, 0, sizeof(ParseCtx));
+    parseCtx.tokenArray = tokens;
+    parseCtx.tokenArraySize = tokensSize;
+
+    status ret = tokenize(&parseCtx, &ctx, src);
+    if(ret != UA_STATUSCODE_GOOD)
+        return ret;
+    return decodeJsonTokens(dst, type, &ctx, &parseCtx);
+}
+
 status UA_FUNC_ATTR_WARN_UNUSED_RESULT
 UA_decodeJson(const UA_ByteString *src, void *dst, const UA_DataType *type) {
     
@@ -3250,46 +3342,31 @@ UA_decodeJson(const UA_ByteString *src, void *dst, const UA_DataType *type) {
         return UA_STATUSCODE_BADARGUMENTSMISSING;
     }
     
-    /* Set up the context */
+    /* Set up the context. Most messages fit into the token array on the
+     * stack. Only larger messages are tokenized again into a token array of
+     * the maximum size on the heap. */
+    jsmntok_t stackTokens[UA_JSON_STACKTOKENCOUNT];
     CtxJson ctx;
+    memset(&ctx, 0, sizeof(CtxJson));
     ParseCtx parseCtx;
-    parseCtx.tokenArray = (jsmntok_t*)UA_malloc(sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
-    if(!parseCtx.tokenArray)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    
+    memset(&parseCtx, 0, sizeof(ParseCtx));
+    parseCtx.tokenArray = stackTokens;
+    parseCtx.tokenArraySize = UA_JSON_STACKTOKENCOUNT;
+
     status ret = tokenize(&parseCtx, &ctx, src);
-    if(ret != UA_STATUSCODE_GOOD)
-        goto cleanup;
-
-    /* Assume the top-level element is an object */
-    if(parseCtx.tokenCount < 1 || parseCtx.tokenArray[0].type != JSMN_OBJECT) {
-        if(parseCtx.tokenCount == 1) {
-            if(parseCtx.tokenArray[0].type == JSMN_PRIMITIVE ||
-               parseCtx.tokenArray[0].type == JSMN_STRING) {
-               /* Only a primitive to parse. Do it directly. */
-               memset(dst, 0, type->memSize); /* Initialize the value */
-               ret = decodeJsonJumpTable[type->typeKind](dst, type, &ctx, &parseCtx, true);
-               goto cleanup;
-            }
-        }
-        ret = UA_STATUSCODE_BADDECODINGERROR;
-        goto cleanup;
+    if(ret == UA_STATUSCODE_BADOUTOFMEMORY) {
+        parseCtx.tokenArray = (jsmntok_t*)
+            UA_malloc(sizeof(jsmntok_t) * UA_JSON_MAXTOKENCOUNT);
+        if(!parseCtx.tokenArray)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        parseCtx.tokenArraySize = UA_JSON_MAXTOKENCOUNT;
+        ret = tokenize(&parseCtx, &ctx, src);
     }
 
-    /* Decode */
-    memset(dst, 0, type->memSize); /* Initialize the value */
-    ret = decodeJsonJumpTable[type->typeKind](dst, type, &ctx, &parseCtx, true);
+    if(ret == UA_STATUSCODE_GOOD)
+        ret = decodeJsonTokens(dst, type, &ctx, &parseCtx);
 
-    cleanup:
-    UA_free(parseCtx.tokenArray);
-    
-    /* sanity check if all Tokens were processed */
-    if(!(parseCtx.index == parseCtx.tokenCount ||
-         parseCtx.index == parseCtx.tokenCount-1)) {
-        ret = UA_STATUSCODE_BADDECODINGERROR;
-    }
-    
-    if(ret != UA_STATUSCODE_GOOD)
-        UA_clear(dst, type); /* Clean up */
+    if(parseCtx.tokenArray != stackTokens)
+        UA_free(parseCtx.tokenArray);
     return ret;
 }
@@ -20,7 +20,14 @@
 _UA_BEGIN_DECLS
 
 #define UA_JSON_MAXTOKENCOUNT 1000
-    
+
+/* Size of the token array on the stack used by UA_decodeJson. Messages with
+ * more tokens are tokenized again with UA_JSON_MAXTOKENCOUNT on the heap. */
+#define UA_JSON_STACKTOKENCOUNT 128
+
+/* Initial size of the buffer for UA_encodeJsonBuffer */
+#define UA_JSON_GROWBUFFER_MINSIZE 256
+
 size_t
 UA_calcSizeJson(const void *src, const UA_DataType *type,
                 UA_String *namespaces, size_t namespaceSize,
@@ -34,10 +41,32 @@ UA_encodeJson(const void *src, const UA_DataType *type,
               UA_String *serverUris, size_t serverUriSize,
               UA_Boolean useReversible) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Encode in a single pass into a buffer that is reallocated when it runs full.
+ * No prior UA_calcSizeJson is required. The buffer can be empty or be reused
+ * from a previous call. Its length is the capacity and can be larger than the
+ * encoding. The buffer remains with the caller also if the encoding fails.
+ *
+ * @param buf The (growable) output buffer
+ * @param encodedLength Returns the length of the encoding in the buffer */
+UA_StatusCode
+UA_encodeJsonBuffer(const void *src, const UA_DataType *type,
+                    UA_ByteString *buf, size_t *encodedLength,
+                    UA_String *namespaces, size_t namespaceSize,
+                    UA_String *serverUris, size_t serverUriSize,
+                    UA_Boolean useReversible) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 UA_StatusCode
 UA_decodeJson(const UA_ByteString *src, void *dst,
               const UA_DataType *type) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Decode with a token array provided by the caller. Decoders that run often
+ * reuse the same token array and avoid an allocation per message. Returns
+ * BadOutOfMemory if the message has more tokens than tokensSize. */
+UA_StatusCode
+UA_decodeJsonWithTokens(const UA_ByteString *src, void *dst,
+                        const UA_DataType *type, jsmntok_t *tokens,
+                        size_t tokensSize) UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 /* Interal Definitions
  *
  * For future by the PubSub encoding */
@@ -52,6 +81,11 @@ typedef struct {
     UA_Boolean useReversible;
     UA_Boolean calcOnly; /* Only compute the length of the decoding */
 
+    /* If set, the buffer is reallocated when the end is reached. pos and end
+     * point into the buffer. */
+    UA_ByteString *growBuffer;
+    UA_Boolean growBufferBorrowed; /* Not owned. Copied instead of realloc */
+
     size_t namespacesSize;
     UA_String *namespaces;
     
@@ -117,6 +151,8 @@ encodeJsonInternal(const void *src, const UA_DataType *type, CtxJson *ctx);
 
 typedef struct {
     jsmntok_t *tokenArray;
+    size_t tokenArraySize; /* Capacity of the tokenArray. Zero for the
+                            * default UA_JSON_MAXTOKENCOUNT. */
     UA_Int32 tokenCount;
     UA_UInt16 index;
 
@@ -0,0 +1,176 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_async.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "thread_wrapper.h"
+
+#define LOGFILE "check_log_async.log"
+#define THREADS 4
+#define MESSAGES_PER_THREAD 1000
+
+static void setup(void) {
+    unlink(LOGFILE);
+}
+
+static void teardown(void) {
+    unlink(LOGFILE);
+}
+
+/* Count the lines in the log file that contain the pattern */
+static size_t
+countLines(const char *pattern) {
+    FILE *f = fopen(LOGFILE, "r");
+    ck_assert_ptr_ne(f, NULL);
+    char line[1024];
+    size_t count = 0;
+    while(fgets(line, sizeof(line), f)) {
+        if(strstr(line, pattern))
+            count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static UA_Logger
+fileLogger(UA_LogLevel minLevel, size_t queueSize, UA_UInt32 drainInterval) {
+    UA_LogAsyncConfig config;
+    UA_LogAsyncConfig_init(&config, minLevel);
+    config.target = UA_LOGASYNCTARGET_FILE;
+    config.path = LOGFILE;
+    config.queueSize = queueSize;
+    config.drainInterval = drainInterval;
+    UA_Logger logger;
+    UA_StatusCode res = UA_Log_Async_init(&logger, &config);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    return logger;
+}
+
+START_TEST(LogAsync_invalidConfig) {
+    UA_LogAsyncConfig config;
+    UA_LogAsyncConfig_init(&config, UA_LOGLEVEL_INFO);
+    config.target = UA_LOGASYNCTARGET_FILE; /* No path */
+    UA_Logger logger;
+    ck_assert_uint_eq(UA_Log_Async_init(&logger, &config),
+                      UA_STATUSCODE_BADINVALIDARGUMENT);
+
+    UA_LogAsyncConfig_init(&config, UA_LOGLEVEL_INFO);
+    config.queueSize = 0;
+    ck_assert_uint_eq(UA_Log_Async_init(&logger, &config),
+                      UA_STATUSCODE_BADINVALIDARGUMENT);
+} END_TEST
+
+START_TEST(LogAsync_writeOnClear) {
+    UA_Logger logger = fileLogger(UA_LOGLEVEL_TRACE, 64, 10000);
+    UA_LOG_INFO(&logger, UA_LOGCATEGORY_SERVER, "message %d", 42);
+    UA_LOG_ERROR(&logger, UA_LOGCATEGORY_CLIENT, "another message");
+    logger.clear(logger.context);
+
+    ck_assert_uint_eq(countLines("server\tmessage 42"), 1);
+    ck_assert_uint_eq(countLines("client\tanother message"), 1);
+} END_TEST
+
+START_TEST(LogAsync_categoryLevels) {
+    UA_LogAsyncConfig config;
+    UA_LogAsyncConfig_init(&config, UA_LOGLEVEL_INFO);
+    config.target = UA_LOGASYNCTARGET_FILE;
+    config.path = LOGFILE;
+    config.minLevel[UA_LOGCATEGORY_NETWORK] = UA_LOGLEVEL_ERROR;
+    config.minLevel[UA_LOGCATEGORY_SERVER] = UA_LOGLEVEL_WARNING;
+    UA_Logger logger;
+    UA_StatusCode res = UA_Log_Async_init(&logger, &config);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_LOG_WARNING(&logger, UA_LOGCATEGORY_NETWORK, "filtered");
+    UA_LOG_ERROR(&logger, UA_LOGCATEGORY_NETWORK, "passed");
+    UA_LOG_INFO(&logger, UA_LOGCATEGORY_SERVER, "filtered");
+    UA_LOG_WARNING(&logger, UA_LOGCATEGORY_SERVER, "passed");
+    UA_LOG_INFO(&logger, UA_LOGCATEGORY_USERLAND, "passed");
+    logger.clear(logger.context);
+
+    ck_assert_uint_eq(countLines("filtered"), 0);
+    ck_assert_uint_eq(countLines("passed"), 3);
+} END_TEST
+
+START_TEST(LogAsync_truncate) {
+    char longMessage[2 * UA_LOG_ASYNC_MESSAGESIZE];
+    memset(longMessage, 'x', sizeof(longMessage) - 1);
+    longMessage[sizeof(longMessage) - 1] = 0;
+
+    UA_Logger logger = fileLogger(UA_LOGLEVEL_TRACE, 64, 10);
+    UA_LOG_INFO(&logger, UA_LOGCATEGORY_SERVER, "%s", longMessage);
+    logger.clear(logger.context);
+
+    /* The message is cut off after UA_LOG_ASYNC_MESSAGESIZE - 1 characters */
+    longMessage[UA_LOG_ASYNC_MESSAGESIZE - 1] = '\n';
+    longMessage[UA_LOG_ASYNC_MESSAGESIZE] = 0;
+    ck_assert_uint_eq(countLines(longMessage), 1);
+} END_TEST
+
+START_TEST(LogAsync_dropWhenFull) {
+    /* The background thread does not wake up before the clear */
+    UA_Logger logger = fileLogger(UA_LOGLEVEL_TRACE, 4, 100000);
+    usleep(10000); /* Let the thread run into the wait */
+    for(size_t i = 0; i < 100; i++)
+        UA_LOG_INFO(&logger, UA_LOGCATEGORY_USERLAND, "queued message");
+    size_t dropped = UA_Log_Async_getDropped(&logger);
+    ck_assert_uint_eq(dropped, 96);
+    logger.clear(logger.context);
+
+    ck_assert_uint_eq(countLines("queued message"), 4);
+    ck_assert_uint_eq(countLines("96 log messages dropped"), 1);
+} END_TEST
+
+static UA_Logger sharedLogger;
+
+THREAD_CALLBACK(logThread) {
+    for(size_t i = 0; i < MESSAGES_PER_THREAD; i++)
+        UA_LOG_INFO(&sharedLogger, UA_LOGCATEGORY_USERLAND, "threaded message %lu",
+                    (unsigned long)i);
+    return 0;
+}
+
+START_TEST(LogAsync_multipleProducers) {
+    sharedLogger = fileLogger(UA_LOGLEVEL_TRACE, THREADS * MESSAGES_PER_THREAD, 1);
+    THREAD_HANDLE threads[THREADS];
+    for(size_t i = 0; i < THREADS; i++)
+        THREAD_CREATE(threads[i], logThread);
+    for(size_t i = 0; i < THREADS; i++)
+        THREAD_JOIN(threads[i]);
+    ck_assert_uint_eq(UA_Log_Async_getDropped(&sharedLogger), 0);
+    sharedLogger.clear(sharedLogger.context);
+
+    ck_assert_uint_eq(countLines("threaded message"), THREADS * MESSAGES_PER_THREAD);
+    ck_assert_uint_eq(countLines("threaded message 999\n"), THREADS);
+} END_TEST
+
+static Suite *testSuite_LogAsync(void) {
+    Suite *s = suite_create("Asynchronous Logger");
+    TCase *tc = tcase_create("Log to file");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, LogAsync_invalidConfig);
+    tcase_add_test(tc, LogAsync_writeOnClear);
+    tcase_add_test(tc, LogAsync_categoryLevels);
+    tcase_add_test(tc, LogAsync_truncate);
+    tcase_add_test(tc, LogAsync_dropWhenFull);
+    tcase_add_test(tc, LogAsync_multipleProducers);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_LogAsync();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_async.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "check.h"
+#include "thread_wrapper.h"
+
+#define MESSAGES_PER_THREAD 200000
+#define MAXTHREADS 4
+
+static UA_Logger logger;
+
+typedef struct {
+    UA_Int64 worstLatency; /* in ns */
+} ThreadResult;
+
+static UA_Int64
+nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UA_Int64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+THREAD_CALLBACK_PARAM(logThread, param) {
+    ThreadResult *result = *(ThreadResult**)param;
+    result->worstLatency = 0;
+    for(size_t i = 0; i < MESSAGES_PER_THREAD; i++) {
+        UA_Int64 begin = nowNs();
+        UA_LOG_INFO(&logger, UA_LOGCATEGORY_SERVER,
+                    "Message %lu with a double %f and a string %s",
+                    (unsigned long)i, 3.14, "argument");
+        UA_Int64 latency = nowNs() - begin;
+        if(latency > result->worstLatency)
+            result->worstLatency = latency;
+    }
+    return 0;
+}
+
+/* Log from several threads into /dev/null. Reports the throughput of the
+ * callers and the worst-case latency of a single log call. */
+static void
+measure(size_t threadCount) {
+    UA_LogAsyncConfig config;
+    UA_LogAsyncConfig_init(&config, UA_LOGLEVEL_INFO);
+    config.target = UA_LOGASYNCTARGET_FILE;
+    config.path = "/dev/null";
+    config.queueSize = 65536;
+    config.drainInterval = 1;
+    UA_StatusCode res = UA_Log_Async_init(&logger, &config);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    THREAD_HANDLE threads[MAXTHREADS];
+    ThreadResult results[MAXTHREADS];
+    ThreadResult *resultPointers[MAXTHREADS];
+    UA_Int64 begin = nowNs();
+    for(size_t i = 0; i < threadCount; i++) {
+        resultPointers[i] = &results[i];
+        THREAD_CREATE_PARAM(threads[i], logThread, resultPointers[i]);
+    }
+    UA_Int64 worstLatency = 0;
+    for(size_t i = 0; i < threadCount; i++) {
+        THREAD_JOIN(threads[i]);
+        if(results[i].worstLatency > worstLatency)
+            worstLatency = results[i].worstLatency;
+    }
+    UA_Int64 finish = nowNs();
+    size_t dropped = UA_Log_Async_getDropped(&logger);
+    logger.clear(logger.context);
+
+    double timeSpent = (double)(finish - begin) / 1e9;
+    size_t calls = threadCount * MESSAGES_PER_THREAD;
+    printf("%lu threads: %lu log calls in %f s (%.0f calls/s), "
+           "worst-case latency %.1f us, %lu dropped\n",
+           (unsigned long)threadCount, (unsigned long)calls, timeSpent,
+           timeSpent > 0 ? (double)calls / timeSpent : 0.0,
+           (double)worstLatency / 1000.0, (unsigned long)dropped);
+}
+
+START_TEST(LogAsync_speed) {
+    measure(1);
+    measure(MAXTHREADS);
+} END_TEST
+
+int main(void) {
+    TCase *tc_speed = tcase_create("Speed of the asynchronous logger");
+    tcase_add_test(tc_speed, LogAsync_speed);
+    tcase_set_timeout(tc_speed, 0);
+    Suite *s = suite_create("Asynchronous Logger Speed Test");
+    suite_add_tcase(s, tc_speed);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
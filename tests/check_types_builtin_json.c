@@ -5611,6 +5611,97 @@ START_TEST(UA_Variant_Malformed2_decode) {
 }
 END_TEST
 
+START_TEST(UA_Variant_Array_String_json_encodeBuffer) {
+    UA_String strings[20];
+    for(size_t i = 0; i < 20; i++)
+        strings[i] = UA_STRING("ab\"cdefghijklmnopqrstuvwxyz");
+    UA_Variant src;
+    UA_Variant_setArray(&src, strings, 20, &UA_TYPES[UA_TYPES_STRING]);
+    const UA_DataType *type = &UA_TYPES[UA_TYPES_VARIANT];
+
+    /* Two-pass encoding for the reference */
+    size_t size = UA_calcSizeJson(&src, type, NULL, 0, NULL, 0, UA_TRUE);
+    UA_ByteString ref;
+    UA_ByteString_allocBuffer(&ref, size);
+    UA_Byte *bufPos = ref.data;
+    const UA_Byte *bufEnd = &ref.data[size];
+    status s = UA_encodeJson(&src, type, &bufPos, &bufEnd, NULL, 0, NULL, 0, UA_TRUE);
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+
+    /* Single pass from an empty buffer. The buffer grows several times. */
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    size_t encodedLength = 0;
+    s = UA_encodeJsonBuffer(&src, type, &buf, &encodedLength, NULL, 0, NULL, 0, UA_TRUE);
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(encodedLength, size);
+    ck_assert_uint_ge(buf.length, size);
+    ck_assert(memcmp(buf.data, ref.data, size) == 0);
+
+    /* Reuse the buffer for a small value */
+    UA_Int32 smallValue = 42;
+    s = UA_encodeJsonBuffer(&smallValue, &UA_TYPES[UA_TYPES_INT32], &buf, &encodedLength,
+                            NULL, 0, NULL, 0, UA_TRUE);
+    ck_assert_int_eq(s, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(encodedLength, 2);
+    ck_assert(memcmp(buf.data, "42", 2) == 0);
+
+    UA_ByteString_clear(&buf);
+    UA_ByteString_clear(&ref);
+}
+END_TEST
+
+START_TEST(UA_Variant_Array_UInt32_json_decode_manyTokens) {
+    /* More tokens than fit into the token array on the stack */
+    char str[2048];
+    size_t pos = (size_t)sprintf(str, "{\"Type\":7,\"Body\":[");
+    for(size_t i = 0; i < 300; i++)
+        pos += (size_t)sprintf(&str[pos], i == 0 ? "%u" : ",%u", (unsigned)i);
+    sprintf(&str[pos], "]}");
+    UA_ByteString buf = UA_STRING(str);
+
+    UA_Variant out;
+    UA_Variant_init(&out);
+    UA_StatusCode retval = UA_decodeJson(&buf, &out, &UA_TYPES[UA_TYPES_VARIANT]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(out.arrayLength, 300);
+    ck_assert_uint_eq(((UA_UInt32*)out.data)[299], 299);
+    UA_Variant_clear(&out);
+
+    /* The caller-provided token array is too small */
+    jsmntok_t tokens[UA_JSON_STACKTOKENCOUNT];
+    retval = UA_decodeJsonWithTokens(&buf, &out, &UA_TYPES[UA_TYPES_VARIANT],
+                                     tokens, UA_JSON_STACKTOKENCOUNT);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADOUTOFMEMORY);
+
+    /* Reuse the token array for a smaller message */
+    UA_ByteString small = UA_STRING("{\"Type\":7,\"Body\":[1,2,3]}");
+    retval = UA_decodeJsonWithTokens(&small, &out, &UA_TYPES[UA_TYPES_VARIANT],
+                                     tokens, UA_JSON_STACKTOKENCOUNT);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(out.arrayLength, 3);
+    UA_Variant_clear(&out);
+}
+END_TEST
+
+START_TEST(UA_Variant_NestedKey_json_decode) {
+    /* The "Type" key of the nested Variant must not be found for the outer
+     * Variant. The nested value is placed before the outer "Type". */
+    UA_ByteString buf = UA_STRING("{\"Body\":{\"Value\":{\"Type\":6,\"Body\":[1,2]},"
+                                  "\"Status\":2151677952},\"Type\":23}");
+    UA_Variant out;
+    UA_Variant_init(&out);
+    UA_StatusCode retval = UA_decodeJson(&buf, &out, &UA_TYPES[UA_TYPES_VARIANT]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(out.type == &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_DataValue *dv = (UA_DataValue*)out.data;
+    ck_assert(dv->hasValue);
+    ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_uint_eq(dv->value.arrayLength, 2);
+    ck_assert_uint_eq(dv->status, UA_STATUSCODE_BADNOTIMPLEMENTED);
+    UA_Variant_clear(&out);
+}
+END_TEST
+
 START_TEST(UA_JsonHelper) {
     // given
     
@@ -5817,6 +5908,7 @@ static Suite *testSuite_builtin_json(void) {
     tcase_add_test(tc_json_encode, UA_ViewDescription_json_encode);
     tcase_add_test(tc_json_encode, UA_WriteRequest_json_encode);
     tcase_add_test(tc_json_encode, UA_VariableAttributes_json_encode);
+    tcase_add_test(tc_json_encode, UA_Variant_Array_String_json_encodeBuffer);
 
     suite_add_tcase(s, tc_json_encode);
     
@@ -5989,6 +6081,9 @@ static Suite *testSuite_builtin_json(void) {
     tcase_add_test(tc_json_decode, UA_Variant_Malformed_decode);
     tcase_add_test(tc_json_decode, UA_Variant_Malformed2_decode);
 
+    tcase_add_test(tc_json_decode, UA_Variant_Array_UInt32_json_decode_manyTokens);
+    tcase_add_test(tc_json_decode, UA_Variant_NestedKey_json_decode);
+
     suite_add_tcase(s, tc_json_decode);
     
     TCase *tc_json_helper = tcase_create("json_helper");
@@ -0,0 +1,168 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure the JSON en- and decoding over messages taken from
+ * check_types_builtin_json. The encoding with a prior UA_calcSizeJson is
+ * compared with the single-pass encoding into a reused buffer. */
+
+#include <open62541/types.h>
+#include <open62541/types_generated.h>
+
+#include "ua_types_encoding_json.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#define ITERATIONS 20000
+
+typedef struct {
+    const char *name;
+    UA_UInt16 typeIndex;
+    const char *json;
+} JsonSample;
+
+static const JsonSample corpus[] = {
+    {"WriteRequest", UA_TYPES_WRITEREQUEST,
+     "{\"RequestHeader\":{\"AuthenticationToken\":{\"IdType\":1,\"Id\":\"authToken\"},"
+     "\"Timestamp\":\"1970-01-15T06:56:07Z\",\"RequestHandle\":123123,"
+     "\"ReturnDiagnostics\":1,\"AuditEntryId\":\"Auditentryid\",\"TimeoutHint\":120,"
+     "\"AdditionalHeader\":{\"TypeId\":{\"Id\":1},\"Body\":false}},"
+     "\"NodesToWrite\":[{\"NodeId\":{\"IdType\":1,\"Id\":\"a1111\"},\"AttributeId\":12,"
+     "\"IndexRange\":\"BLOAB\",\"Value\":{\"Value\":{\"Type\":1,\"Body\":true},"
+     "\"Status\":2153250816,\"SourceTimestamp\":\"1970-01-15T06:56:07Z\","
+     "\"ServerTimestamp\":\"1970-01-15T06:56:07Z\"}},{\"NodeId\":{\"IdType\":1,"
+     "\"Id\":\"a2222\"},\"AttributeId\":12,\"IndexRange\":\"BLOAB\",\"Value\":{"
+     "\"Value\":{\"Type\":1,\"Body\":true},\"Status\":2153250816,"
+     "\"SourceTimestamp\":\"1970-01-15T06:56:07Z\","
+     "\"ServerTimestamp\":\"1970-01-15T06:56:07Z\"}}]}"},
+    {"DataValue", UA_TYPES_DATAVALUE,
+     "{\"Value\":{\"Type\":1,\"Body\":true},\"Status\":2153250816,"
+     "\"SourceTimestamp\":\"1970-01-15T06:56:07.890Z\",\"SourcePicoseconds\":5678,"
+     "\"ServerTimestamp\":\"1970-01-28T03:34:38.901Z\",\"ServerPicoseconds\":6789}"},
+    {"ExtensionObject array", UA_TYPES_VARIANT,
+     "{\"Type\":22,\"Body\":[{\"TypeId\":{\"Id\":511},\"Body\":{\"ViewId\":{\"Id\":1},"
+     "\"Timestamp\":\"1970-01-15T06:56:07Z\",\"ViewVersion\":1}},{\"TypeId\":{\"Id\":511},"
+     "\"Body\":{\"ViewId\":{\"Id\":2},\"Timestamp\":\"1970-01-15T06:56:07Z\","
+     "\"ViewVersion\":2}}]}"},
+    {"DiagnosticInfo", UA_TYPES_DIAGNOSTICINFO,
+     "{\"SymbolicId\":13,\"LocalizedText\":14,\"Locale\":12,\"AdditionalInfo\":"
+     "\"additionalInfo\",\"InnerStatusCode\":2155216896,\"InnerDiagnosticInfo\":{"
+     "\"AdditionalInfo\":\"INNER ADDITION INFO\",\"InnerDiagnosticInfo\":{"
+     "\"AdditionalInfo\":\"INNER ADDITION INFO2\"}}}"},
+    {"String array", UA_TYPES_VARIANT,
+     "{\"Type\":12,\"Body\":[\"eins\",\"zwei\",\"drei\",\"vier\",\"fünf\",\"sechs\","
+     "\"sieben\",\"acht\"]}"}
+};
+
+#define CORPUSSIZE (sizeof(corpus) / sizeof(JsonSample))
+
+static void *values[CORPUSSIZE];
+
+static void setup(void) {
+    for(size_t i = 0; i < CORPUSSIZE; i++) {
+        const UA_DataType *type = &UA_TYPES[corpus[i].typeIndex];
+        values[i] = UA_new(type);
+        UA_ByteString buf = UA_STRING((char*)(uintptr_t)corpus[i].json);
+        UA_StatusCode retval = UA_decodeJson(&buf, values[i], type);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void teardown(void) {
+    for(size_t i = 0; i < CORPUSSIZE; i++)
+        UA_delete(values[i], &UA_TYPES[corpus[i].typeIndex]);
+}
+
+START_TEST(decodeSpeed) {
+    for(size_t i = 0; i < CORPUSSIZE; i++) {
+        const UA_DataType *type = &UA_TYPES[corpus[i].typeIndex];
+        UA_ByteString buf = UA_STRING((char*)(uintptr_t)corpus[i].json);
+        void *out = UA_new(type);
+
+        clock_t begin = clock();
+        for(size_t j = 0; j < ITERATIONS; j++) {
+            UA_StatusCode retval = UA_decodeJson(&buf, out, type);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            UA_clear(out, type);
+        }
+        clock_t finish = clock();
+
+        double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+        printf("decode          %-22s %u times: %f s (%f us per message)\n", corpus[i].name,
+               (unsigned)ITERATIONS, time_spent, time_spent * 1000000.0 / ITERATIONS);
+        UA_delete(out, type);
+    }
+} END_TEST
+
+START_TEST(encodeSpeedTwoPass) {
+    for(size_t i = 0; i < CORPUSSIZE; i++) {
+        const UA_DataType *type = &UA_TYPES[corpus[i].typeIndex];
+
+        clock_t begin = clock();
+        for(size_t j = 0; j < ITERATIONS; j++) {
+            size_t size = UA_calcSizeJson(values[i], type, NULL, 0, NULL, 0, true);
+            ck_assert_uint_gt(size, 0);
+            UA_ByteString buf;
+            UA_StatusCode retval = UA_ByteString_allocBuffer(&buf, size);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            UA_Byte *bufPos = buf.data;
+            const UA_Byte *bufEnd = &buf.data[buf.length];
+            retval = UA_encodeJson(values[i], type, &bufPos, &bufEnd,
+                                   NULL, 0, NULL, 0, true);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            UA_ByteString_clear(&buf);
+        }
+        clock_t finish = clock();
+
+        double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+        printf("two-pass encode %-22s %u times: %f s (%f us per message)\n",
+               corpus[i].name, (unsigned)ITERATIONS, time_spent,
+               time_spent * 1000000.0 / ITERATIONS);
+    }
+} END_TEST
+
+START_TEST(encodeSpeedSinglePass) {
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    for(size_t i = 0; i < CORPUSSIZE; i++) {
+        const UA_DataType *type = &UA_TYPES[corpus[i].typeIndex];
+
+        clock_t begin = clock();
+        for(size_t j = 0; j < ITERATIONS; j++) {
+            size_t encodedLength = 0;
+            UA_StatusCode retval =
+                UA_encodeJsonBuffer(values[i], type, &buf, &encodedLength,
+                                    NULL, 0, NULL, 0, true);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+            ck_assert_uint_gt(encodedLength, 0);
+        }
+        clock_t finish = clock();
+
+        double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+        printf("one-pass encode %-22s %u times: %f s (%f us per message)\n",
+               corpus[i].name, (unsigned)ITERATIONS, time_spent,
+               time_spent * 1000000.0 / ITERATIONS);
+    }
+    UA_ByteString_clear(&buf);
+} END_TEST
+
+static Suite * testSuite_jsonSpeed(void) {
+    Suite *s = suite_create("JSON Encoding Speed");
+    TCase *tc_speed = tcase_create("JSON Encoding Speed");
+    tcase_add_checked_fixture(tc_speed, setup, teardown);
+    tcase_add_test(tc_speed, decodeSpeed);
+    tcase_add_test(tc_speed, encodeSpeedTwoPass);
+    tcase_add_test(tc_speed, encodeSpeedSinglePass);
+    suite_add_tcase(s, tc_speed);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_jsonSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -347,7 +347,127 @@ START_TEST(Node_Register) {
 }
 END_TEST
 
+/* Registering a node again returns the same handle. The number of registered
+ * nodes per Session is limited. */
+START_TEST(Node_RegisterLimit) {
+    UA_NodeId nodes[3];
+    nodes[0] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+    nodes[1] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+    nodes[2] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
 
+    UA_RegisterNodesRequest req;
+    UA_RegisterNodesRequest_init(&req);
+    req.nodesToRegister = nodes;
+    req.nodesToRegisterSize = 2;
+    UA_RegisterNodesResponse res = UA_Client_Service_registerNodes(client, req);
+    ck_assert_uint_eq(res.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(res.registeredNodeIdsSize, 2);
+    ck_assert(UA_NodeId_equal(&res.registeredNodeIds[0], &res.registeredNodeIds[1]));
+
+    /* The registered node counts against the limit. The request is rejected
+     * without changing the existing registration. */
+    UA_Server_getConfig(server)->maxRegisteredNodesPerSession = 1;
+    req.nodesToRegisterSize = 3;
+    UA_RegisterNodesResponse res2 = UA_Client_Service_registerNodes(client, req);
+    ck_assert_uint_eq(res2.responseHeader.serviceResult,
+                      UA_STATUSCODE_BADTOOMANYOPERATIONS);
+    ck_assert_uint_eq(res2.registeredNodeIdsSize, 0);
+    UA_RegisterNodesResponse_clear(&res2);
+
+    UA_Variant val;
+    UA_StatusCode retval =
+        UA_Client_readValueAttribute(client, res.registeredNodeIds[0], &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&val);
+
+    UA_Server_getConfig(server)->maxRegisteredNodesPerSession = 1000;
+    UA_RegisterNodesResponse_clear(&res);
+}
+END_TEST
+
+
+#ifdef UA_ENABLE_NODEMANAGEMENT
+/* The handles of registered nodes are used for Read, Write and Browse. They
+ * become invalid when the node is deleted. */
+START_TEST(Node_RegisterReadWrite) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 5;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "a.registered.variable.with.a.long.nodeid");
+    UA_StatusCode retval =
+        UA_Client_addVariableNode(client, nodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "registered"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_RegisterNodesRequest req;
+    UA_RegisterNodesRequest_init(&req);
+    req.nodesToRegister = &nodeId;
+    req.nodesToRegisterSize = 1;
+    UA_RegisterNodesResponse res = UA_Client_Service_registerNodes(client, req);
+    ck_assert_uint_eq(res.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(res.registeredNodeIdsSize, 1);
+    UA_NodeId handle = res.registeredNodeIds[0];
+    ck_assert_uint_eq(handle.identifierType, UA_NODEIDTYPE_NUMERIC);
+    ck_assert(!UA_NodeId_equal(&handle, &nodeId));
+
+    /* Write and read via the handle */
+    UA_Variant val;
+    value = 6;
+    UA_Variant_setScalar(&val, &value, &UA_TYPES[UA_TYPES_INT32]);
+    retval = UA_Client_writeValueAttribute(client, handle, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Client_readValueAttribute(client, handle, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)val.data, 6);
+    UA_Variant_clear(&val);
+    retval = UA_Client_readValueAttribute(client, nodeId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)val.data, 6);
+    UA_Variant_clear(&val);
+
+    /* Browse via the handle */
+    UA_BrowseRequest bReq;
+    UA_BrowseRequest_init(&bReq);
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = handle;
+    bd.browseDirection = UA_BROWSEDIRECTION_INVERSE;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    bReq.nodesToBrowse = &bd;
+    bReq.nodesToBrowseSize = 1;
+    UA_BrowseResponse bRes = UA_Client_Service_browse(client, bReq);
+    ck_assert_uint_eq(bRes.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bRes.resultsSize, 1);
+    ck_assert_uint_eq(bRes.results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bRes.results[0].referencesSize, 1);
+    UA_BrowseResponse_clear(&bRes);
+
+    /* The handle is invalid after the node was deleted */
+    retval = UA_Client_deleteNode(client, nodeId, true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Client_readValueAttribute(client, handle, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    UA_UnregisterNodesRequest reqUn;
+    UA_UnregisterNodesRequest_init(&reqUn);
+    reqUn.nodesToUnregister = &handle;
+    reqUn.nodesToUnregisterSize = 1;
+    UA_UnregisterNodesResponse resUn = UA_Client_Service_unregisterNodes(client, reqUn);
+    ck_assert_uint_eq(resUn.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UnregisterNodesResponse_clear(&resUn);
+    UA_RegisterNodesResponse_clear(&res);
+
+    /* The handle is unknown after unregistering */
+    retval = UA_Client_readValueAttribute(client, handle, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNODEIDUNKNOWN);
+}
+END_TEST
+#endif
 
 // NodeIds for ReadWrite testing
 UA_NodeId nodeReadWriteUnitTest;
@@ -1045,6 +1165,10 @@ static Suite *testSuite_Client(void) {
 #endif
     tcase_add_test(tc_nodes, Node_Browse);
     tcase_add_test(tc_nodes, Node_Register);
+    tcase_add_test(tc_nodes, Node_RegisterLimit);
+#ifdef UA_ENABLE_NODEMANAGEMENT
+    tcase_add_test(tc_nodes, Node_RegisterReadWrite);
+#endif
     suite_add_tcase(s, tc_nodes);
 
 #ifdef UA_ENABLE_NODEMANAGEMENT
@@ -0,0 +1,153 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Drive many clients from one thread with UA_Client_run_iterateMany. Every
+ * client is connected to its own in-process server. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel_async.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include "client/ua_client_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define SERVERS 8
+#define BASEPORT 4850
+
+UA_Server *servers[SERVERS];
+UA_Client *clients[SERVERS];
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running) {
+        for(size_t i = 0; i < SERVERS; i++)
+            UA_Server_run_iterate(servers[i], false);
+    }
+    return 0;
+}
+
+static void setup(void) {
+    running = true;
+    for(size_t i = 0; i < SERVERS; i++) {
+        servers[i] = UA_Server_new();
+        UA_ServerConfig_setMinimal(UA_Server_getConfig(servers[i]),
+                                   (UA_UInt16)(BASEPORT + i), NULL);
+        UA_Server_run_startup(servers[i]);
+    }
+    THREAD_CREATE(server_thread, serverloop);
+
+    for(size_t i = 0; i < SERVERS; i++) {
+        clients[i] = UA_Client_new();
+        UA_ClientConfig *cc = UA_Client_getConfig(clients[i]);
+        UA_ClientConfig_setDefault(cc);
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+        cc->outStandingPublishRequests = 0;
+#endif
+    }
+}
+
+static void teardown(void) {
+    for(size_t i = 0; i < SERVERS; i++) {
+        UA_Client_disconnect(clients[i]);
+        UA_Client_delete(clients[i]);
+    }
+    running = false;
+    THREAD_JOIN(server_thread);
+    for(size_t i = 0; i < SERVERS; i++) {
+        UA_Server_run_shutdown(servers[i]);
+        UA_Server_delete(servers[i]);
+    }
+}
+
+static UA_Boolean
+allActivated(void) {
+    for(size_t i = 0; i < SERVERS; i++) {
+        UA_SessionState ss;
+        UA_Client_getState(clients[i], NULL, &ss, NULL);
+        if(ss != UA_SESSIONSTATE_ACTIVATED)
+            return false;
+    }
+    return true;
+}
+
+static void
+connectAll(void) {
+    for(size_t i = 0; i < SERVERS; i++) {
+        char url[64];
+        UA_snprintf(url, 64, "opc.tcp://localhost:%u", (unsigned)(BASEPORT + i));
+        UA_StatusCode retval = UA_Client_connectAsync(clients[i], url);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    for(size_t i = 0; i < 1000 && !allActivated(); i++) {
+        UA_StatusCode retval = UA_Client_run_iterateMany(clients, SERVERS, 10);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert(allActivated());
+}
+
+static void
+readCallback(UA_Client *client, void *userdata, UA_UInt32 requestId,
+             UA_StatusCode opStatus, UA_DataValue *value) {
+    size_t *counter = (size_t*)userdata;
+    if(opStatus == UA_STATUSCODE_GOOD && value->hasValue)
+        (*counter)++;
+}
+
+START_TEST(Client_iterateMany_connect) {
+    connectAll();
+
+    /* Nothing to receive. The call returns after the timeout. */
+    UA_StatusCode retval = UA_Client_run_iterateMany(clients, SERVERS, 10);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* NULL entries are skipped */
+    UA_Client *sparse[3] = {NULL, clients[0], NULL};
+    retval = UA_Client_run_iterateMany(sparse, 3, 10);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+} END_TEST
+
+START_TEST(Client_iterateMany_read) {
+    connectAll();
+
+    /* Only one client has an outstanding request */
+    size_t counter = 0;
+    UA_StatusCode retval =
+        UA_Client_readValueAttribute_async(clients[SERVERS-1],
+                UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME),
+                readCallback, &counter, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 100 && counter == 0; i++)
+        UA_Client_run_iterateMany(clients, SERVERS, 10);
+    ck_assert_uint_eq(counter, 1);
+} END_TEST
+
+static Suite* testSuite_Client(void) {
+    Suite *s = suite_create("Client Multiplex");
+    TCase *tc_client = tcase_create("Client Multiplex");
+    tcase_add_checked_fixture(tc_client, setup, teardown);
+    tcase_add_test(tc_client, Client_iterateMany_connect);
+    tcase_add_test(tc_client, Client_iterateMany_read);
+    suite_add_tcase(s,tc_client);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_Client();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
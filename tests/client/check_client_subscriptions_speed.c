@@ -0,0 +1,172 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_subscriptions.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include "client/ua_client_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "thread_wrapper.h"
+
+#define MONITOREDITEMS 50000
+#define BATCHSIZE 1000
+#define ROUNDS 10
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static size_t notifications;
+
+static void
+dataChangeHandler(UA_Client *client, UA_UInt32 subId, void *subContext,
+                  UA_UInt32 monId, void *monContext, UA_DataValue *value) {
+    notifications++;
+}
+
+/* Dispatch synthetic PublishResponses with one DataChangeNotification for
+ * every MonitoredItem of the Subscription */
+START_TEST(Client_dispatchNotifications) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    request.requestedPublishingInterval = 60000.0;
+    UA_CreateSubscriptionResponse response =
+        UA_Client_Subscriptions_create(client, request, NULL, NULL, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UInt32 subId = response.subscriptionId;
+
+    /* Create the MonitoredItems in batches */
+    UA_MonitoredItemCreateRequest items[BATCHSIZE];
+    UA_Client_DataChangeNotificationCallback callbacks[BATCHSIZE];
+    UA_Client_DeleteMonitoredItemCallback deleteCallbacks[BATCHSIZE];
+    void *contexts[BATCHSIZE];
+    for(size_t i = 0; i < BATCHSIZE; i++) {
+        items[i] = UA_MonitoredItemCreateRequest_default(
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE));
+        items[i].requestedParameters.samplingInterval = 60000.0;
+        callbacks[i] = dataChangeHandler;
+        deleteCallbacks[i] = NULL;
+        contexts[i] = NULL;
+    }
+    for(size_t i = 0; i < MONITOREDITEMS / BATCHSIZE; i++) {
+        UA_CreateMonitoredItemsRequest createRequest;
+        UA_CreateMonitoredItemsRequest_init(&createRequest);
+        createRequest.subscriptionId = subId;
+        createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+        createRequest.itemsToCreate = items;
+        createRequest.itemsToCreateSize = BATCHSIZE;
+        UA_CreateMonitoredItemsResponse createResponse =
+            UA_Client_MonitoredItems_createDataChanges(client, createRequest, contexts,
+                                                       callbacks, deleteCallbacks);
+        ck_assert_uint_eq(createResponse.responseHeader.serviceResult,
+                          UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(createResponse.resultsSize, BATCHSIZE);
+        UA_CreateMonitoredItemsResponse_clear(&createResponse);
+    }
+
+    UA_Client_Subscription *sub = LIST_FIRST(&client->subscriptions);
+    ck_assert_ptr_ne(sub, NULL);
+    ck_assert_uint_eq(sub->monitoredItemsSize, MONITOREDITEMS);
+
+    /* Prepare a notification for every MonitoredItem, in reverse order of
+     * their creation */
+    UA_DataChangeNotification *dcn = UA_DataChangeNotification_new();
+    dcn->monitoredItems = (UA_MonitoredItemNotification*)
+        UA_Array_new(MONITOREDITEMS, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
+    ck_assert_ptr_ne(dcn->monitoredItems, NULL);
+    dcn->monitoredItemsSize = MONITOREDITEMS;
+    size_t n = 0;
+    UA_Client_MonitoredItem *mon;
+    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
+        dcn->monitoredItems[n].clientHandle = mon->clientHandle;
+        UA_Int32 value = (UA_Int32)n;
+        UA_Variant_setScalarCopy(&dcn->monitoredItems[n].value.value, &value,
+                                 &UA_TYPES[UA_TYPES_INT32]);
+        dcn->monitoredItems[n].value.hasValue = true;
+        n++;
+    }
+
+    UA_PublishRequest publishRequest;
+    UA_PublishRequest_init(&publishRequest);
+    UA_PublishResponse publishResponse;
+    UA_PublishResponse_init(&publishResponse);
+    publishResponse.subscriptionId = subId;
+    publishResponse.notificationMessage.notificationData = UA_ExtensionObject_new();
+    publishResponse.notificationMessage.notificationDataSize = 1;
+    UA_ExtensionObject_setValue(publishResponse.notificationMessage.notificationData,
+                                dcn, &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]);
+
+    notifications = 0;
+    clock_t begin = clock();
+    for(size_t i = 0; i < ROUNDS; i++) {
+        publishResponse.notificationMessage.sequenceNumber = sub->sequenceNumber + 1;
+        client->currentlyOutStandingPublishRequests++;
+        UA_Client_Subscriptions_processPublishResponse(client, &publishRequest,
+                                                       &publishResponse);
+    }
+    clock_t finish = clock();
+    ck_assert_uint_eq(notifications, (size_t)MONITOREDITEMS * ROUNDS);
+
+    double timeSpent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("dispatched %d notifications in %f s (%.0f notifications/s)\n",
+           MONITOREDITEMS * ROUNDS, timeSpent,
+           timeSpent > 0 ? (double)(MONITOREDITEMS * ROUNDS) / timeSpent : 0.0);
+
+    UA_PublishResponse_clear(&publishResponse);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+static Suite* testSuite_Client(void) {
+    TCase *tc_client = tcase_create("Client Subscription Dispatch");
+    tcase_add_checked_fixture(tc_client, setup, teardown);
+    tcase_set_timeout(tc_client, 0);
+    tcase_add_test(tc_client, Client_dispatchNotifications);
+    Suite *s = suite_create("Client Subscriptions Speed Test");
+    suite_add_tcase(s, tc_client);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_Client();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,6 +2,8 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/nodestore_default.h>
 #include <open62541/server.h>
 #include <open62541/server_config_default.h>
 #include <open62541/types.h>
@@ -12,6 +14,8 @@
 #include "tests/namespace_tests_plc_generated.h"
 #include "unistd.h"
 
+#include <time.h>
+
 UA_Server *server = NULL;
 
 static void setup(void) {
@@ -37,12 +41,66 @@ START_TEST(Server_addPlcNodeset) {
 }
 END_TEST
 
+/* Compare the startup time with ns0, DI and PLCopen created by the generated
+ * code and loaded from a nodestore snapshot */
+START_TEST(Server_nodestoreSnapshot) {
+    UA_ByteString snapshot;
+    UA_StatusCode retval = UA_Server_encodeNodestoreSnapshot(server, &snapshot);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    clock_t begin = clock();
+    UA_Server *generated = UA_Server_new();
+    ck_assert(generated != NULL);
+    retval = namespace_tests_di_generated(generated);
+    retval |= namespace_tests_plc_generated(generated);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    double generatedTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    begin = clock();
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_;
+    retval = UA_Nodestore_HashMap(&config.nodestore);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server *loaded = UA_Server_newWithNodestoreSnapshot(&config, &snapshot);
+    ck_assert(loaded != NULL);
+    double loadedTime = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    printf("Startup with DI and PLCopen (%lu bytes snapshot): generated %f s, "
+           "from snapshot %f s\n", (unsigned long)snapshot.length,
+           generatedTime, loadedTime);
+
+    /* The namespaces and nodes of DI and PLCopen are available */
+    size_t nsIndex = 0;
+    retval = UA_Server_getNamespaceByName(loaded,
+                                          UA_STRING("http://PLCopen.org/OpcUa/IEC61131-3/"),
+                                          &nsIndex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_getNamespaceByName(loaded,
+                                          UA_STRING("http://opcfoundation.org/UA/DI/"),
+                                          &nsIndex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_QualifiedName browseName;
+    retval = UA_Server_readBrowseName(loaded, UA_NODEID_NUMERIC((UA_UInt16)nsIndex, 5001),
+                                      &browseName);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_String deviceSet = UA_STRING("DeviceSet");
+    ck_assert(UA_String_equal(&browseName.name, &deviceSet));
+    UA_QualifiedName_clear(&browseName);
+
+    UA_Server_delete(generated);
+    UA_Server_delete(loaded);
+    UA_ByteString_clear(&snapshot);
+}
+END_TEST
+
 static Suite* testSuite_Client(void) {
     Suite *s = suite_create("Server Nodeset Compiler");
     TCase *tc_server = tcase_create("Server DI and PLCopen nodeset");
     tcase_add_unchecked_fixture(tc_server, setup, teardown);
     tcase_add_test(tc_server, Server_addDiNodeset);
     tcase_add_test(tc_server, Server_addPlcNodeset);
+    tcase_add_test(tc_server, Server_nodestoreSnapshot);
     suite_add_tcase(s, tc_server);
     return s;
 }
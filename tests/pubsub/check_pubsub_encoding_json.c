@@ -100,6 +100,28 @@ START_TEST(UA_PubSub_EncodeAllOptionalFields) {
     char* result = "{\"MessageId\":\"ABCDEFGH\",\"MessageType\":\"ua-data\",\"PublisherId\":65535,\"DataSetClassId\":\"00000001-0002-0003-0000-000000000000\",\"Messages\":[{\"DataSetWriterId\":12345,\"SequenceNumber\":4711,\"MetaDataVersion\":{\"MajorVersion\":42,\"MinorVersion\":7},\"Timestamp\":\"1601-01-13T20:38:31.1111111Z\",\"Status\":2764857,\"Payload\":{\"Field1\":{\"Type\":7,\"Body\":27}}}]}";
     ck_assert_str_eq(result, (char*)buffer.data);
 
+    /* Single-pass encoding into a borrowed buffer that is large enough */
+    UA_Byte stackBuf[512];
+    UA_ByteString buf2 = {sizeof(stackBuf), stackBuf};
+    size_t encodedLength = 0;
+    rv = UA_NetworkMessage_encodeJsonBuffer(&m, &buf2, true, &encodedLength,
+                                            NULL, 0, NULL, 0, true);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(buf2.data, stackBuf);
+    ck_assert_uint_eq(encodedLength, size);
+    ck_assert(memcmp(buf2.data, result, size) == 0);
+
+    /* The borrowed buffer runs full and is moved to the heap */
+    buf2.data = stackBuf;
+    buf2.length = 64;
+    rv = UA_NetworkMessage_encodeJsonBuffer(&m, &buf2, true, &encodedLength,
+                                            NULL, 0, NULL, 0, true);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_ne(buf2.data, stackBuf);
+    ck_assert_uint_eq(encodedLength, size);
+    ck_assert(memcmp(buf2.data, result, size) == 0);
+    UA_ByteString_clear(&buf2);
+
     UA_ByteString_clear(&buffer);
     UA_NetworkMessage_clear(&m);
 }
@@ -116,10 +116,86 @@ START_TEST(SinglePublishDataSetField) {
     UA_WriterGroup_publishCallback(server, wg);
 } END_TEST
 
+/* AES-128-CTR keystream for the key 00..0f and the counter block
+ * 01020304|1011121314151617|00000000 and its HMAC-SHA256 with the key 20..2f */
+static const UA_Byte kat_ciphertext[32] = {
+    0xc7, 0x7f, 0xd5, 0xb2, 0x29, 0x48, 0x84, 0x0b, 0x1e, 0x41, 0x49, 0x56,
+    0x56, 0xb3, 0x6a, 0x2f, 0xf0, 0x9b, 0xc9, 0x6a, 0xe9, 0x3a, 0xfc, 0x7e,
+    0x02, 0x09, 0xdb, 0xa8, 0xbd, 0xbb, 0xb1, 0xdd};
+static const UA_Byte kat_signature[32] = {
+    0xb3, 0x77, 0x6b, 0xa8, 0xb0, 0x11, 0xe0, 0x5b, 0xff, 0x19, 0x9c, 0x8d,
+    0xd6, 0x51, 0x81, 0x9f, 0x81, 0xe0, 0xaa, 0x7a, 0x93, 0xc3, 0x1a, 0x78,
+    0x57, 0x9a, 0x70, 0xd7, 0x0f, 0xe7, 0x85, 0x39};
+
+START_TEST(EncryptAndSignKnownAnswer) {
+    UA_PubSubSecurityPolicy *policy =
+        &UA_Server_getConfig(server)->pubSubConfig.securityPolicies[0];
+    UA_SecurityPolicySymmetricModule *sm = &policy->symmetricModule;
+
+    /* The keys are cached in the channel context. Start with the zero keys and
+     * check that setSecurityKeys replaces them. */
+    void *cc = NULL;
+    UA_StatusCode res = policy->newContext(policy->policyContext, NULL, NULL, NULL, &cc);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Byte skData[UA_AES128CTR_SIGNING_KEY_LENGTH];
+    UA_Byte ekData[UA_AES128CTR_KEY_LENGTH];
+    UA_Byte knData[UA_AES128CTR_KEYNONCE_LENGTH] = {1, 2, 3, 4};
+    UA_Byte mnData[8];
+    for(UA_Byte i = 0; i < 16; i++) {
+        ekData[i] = i;
+        skData[i] = (UA_Byte)(0x20 + i);
+    }
+    for(UA_Byte i = 0; i < 8; i++)
+        mnData[i] = (UA_Byte)(0x10 + i);
+    UA_ByteString sk = {UA_AES128CTR_SIGNING_KEY_LENGTH, skData};
+    UA_ByteString ek = {UA_AES128CTR_KEY_LENGTH, ekData};
+    UA_ByteString kn = {UA_AES128CTR_KEYNONCE_LENGTH, knData};
+    UA_ByteString mn = {8, mnData};
+    res = policy->setSecurityKeys(cc, &sk, &ek, &kn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = policy->setMessageNonce(cc, &mn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Encrypt twice to check that the counter restarts for every message */
+    for(size_t round = 0; round < 2; round++) {
+        UA_Byte data[32] = {0};
+        UA_ByteString buf = {32, data};
+        res = sm->cryptoModule.encryptionAlgorithm.encrypt(cc, &buf);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(memcmp(data, kat_ciphertext, 32) == 0);
+
+        UA_Byte sigData[32];
+        UA_ByteString sig = {32, sigData};
+        res = sm->cryptoModule.signatureAlgorithm.sign(cc, &buf, &sig);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(memcmp(sigData, kat_signature, 32) == 0);
+        res = sm->cryptoModule.signatureAlgorithm.verify(cc, &buf, &sig);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        res = sm->cryptoModule.encryptionAlgorithm.decrypt(cc, &buf);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_Byte zero[32] = {0};
+        ck_assert(memcmp(data, zero, 32) == 0);
+    }
+
+    /* A new signing key changes the signature */
+    skData[0] ^= 0xff;
+    res = policy->setSecurityKeys(cc, &sk, &ek, &kn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString msg = {32, (UA_Byte*)(uintptr_t)kat_ciphertext};
+    UA_ByteString sig = {32, (UA_Byte*)(uintptr_t)kat_signature};
+    res = sm->cryptoModule.signatureAlgorithm.verify(cc, &msg, &sig);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+
+    policy->deleteContext(cc);
+} END_TEST
+
 int main(void) {
     TCase *tc_pubsub_publish = tcase_create("PubSub publish DataSetFields");
     tcase_add_checked_fixture(tc_pubsub_publish, setup, teardown);
     tcase_add_test(tc_pubsub_publish, SinglePublishDataSetField);
+    tcase_add_test(tc_pubsub_publish, EncryptAndSignKnownAnswer);
 
     Suite *s = suite_create("PubSub WriterGroups/Writer/Fields handling and publishing");
     suite_add_tcase(s, tc_pubsub_publish);
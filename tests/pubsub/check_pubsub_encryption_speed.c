@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/securitypolicy_default.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MESSAGES 100000
+
+typedef UA_StatusCode
+(*PolicyConstructor)(UA_PubSubSecurityPolicy *policy, const UA_Logger *logger);
+
+/* Encrypt and sign MESSAGES payloads of the given size with a fresh message
+ * nonce each, the same steps as for a published NetworkMessage */
+static void
+measure(PolicyConstructor constructor, size_t payloadSize) {
+    UA_PubSubSecurityPolicy policy;
+    UA_StatusCode res = constructor(&policy, UA_Log_Stdout);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_SecurityPolicySymmetricModule *sm = &policy.symmetricModule;
+
+    UA_Byte keys[32 + 32 + 4] = {0};
+    size_t skLen = sm->cryptoModule.signatureAlgorithm.getLocalKeyLength(NULL);
+    size_t ekLen = sm->cryptoModule.encryptionAlgorithm.getLocalKeyLength(NULL);
+    UA_ByteString sk = {skLen, keys};
+    UA_ByteString ek = {ekLen, keys + skLen};
+    UA_ByteString kn = {4, keys + skLen + ekLen};
+    void *cc = NULL;
+    res = policy.newContext(policy.policyContext, &sk, &ek, &kn, &cc);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    size_t sigSize = sm->cryptoModule.signatureAlgorithm.getLocalSignatureSize(cc);
+    UA_ByteString msg;
+    res = UA_ByteString_allocBuffer(&msg, payloadSize + sigSize);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    memset(msg.data, 0x2a, msg.length);
+    UA_ByteString payload = {payloadSize, msg.data};
+    UA_ByteString signature = {sigSize, msg.data + payloadSize};
+
+    UA_Byte nonceData[8] = {0};
+    UA_ByteString nonce = {8, nonceData};
+
+    clock_t begin = clock();
+    for(UA_UInt32 i = 0; i < MESSAGES; i++) {
+        memcpy(nonceData + 4, &i, sizeof(UA_UInt32));
+        res |= policy.setMessageNonce(cc, &nonce);
+        res |= sm->cryptoModule.encryptionAlgorithm.encrypt(cc, &payload);
+        res |= sm->cryptoModule.signatureAlgorithm.sign(cc, &payload, &signature);
+    }
+    clock_t finish = clock();
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    double timeSpent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%.*s, %lu byte payload: %d messages in %f s (%.0f messages/s)\n",
+           (int)policy.policyUri.length, (char*)policy.policyUri.data,
+           (unsigned long)payloadSize, MESSAGES, timeSpent,
+           timeSpent > 0 ? (double)MESSAGES / timeSpent : 0.0);
+
+    UA_ByteString_clear(&msg);
+    policy.deleteContext(cc);
+    policy.clear(&policy);
+}
+
+START_TEST(EncryptAndSignSpeed) {
+    measure(UA_PubSubSecurityPolicy_Aes128Ctr, 64);
+    measure(UA_PubSubSecurityPolicy_Aes128Ctr, 1400);
+    measure(UA_PubSubSecurityPolicy_Aes256Ctr, 64);
+    measure(UA_PubSubSecurityPolicy_Aes256Ctr, 1400);
+} END_TEST
+
+int main(void) {
+    TCase *tc_speed = tcase_create("Speed of the PubSub security policies");
+    tcase_add_test(tc_speed, EncryptAndSignSpeed);
+    Suite *s = suite_create("PubSub Encryption Speed Test");
+    suite_add_tcase(s, tc_speed);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
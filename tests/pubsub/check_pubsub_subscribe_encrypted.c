@@ -46,6 +46,7 @@ UA_NodeId connection_test;
 UA_NodeId readerGroupTest;
 
 UA_NodeId publishedDataSetTest;
+UA_UInt32 subscribedData = 0;
 
 /* setup() is to create an environment for test cases */
 static void setup(void) {
@@ -404,6 +405,216 @@ START_TEST(SinglePublishSubscribeInt32) {
         UA_Variant_delete(publishedNodeData);
     } END_TEST
 
+static UA_StatusCode
+externalDataWriteCallback(UA_Server *serverLocal, const UA_NodeId *sessionId,
+                          void *sessionContext, const UA_NodeId *nodeId,
+                          void *nodeContext, const UA_NumericRange *range,
+                          const UA_DataValue *data) {
+    if(UA_Variant_hasScalarType(&data->value, &UA_TYPES[UA_TYPES_UINT32]))
+        subscribedData = *(UA_UInt32*)data->value.data;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+externalDataReadNotificationCallback(UA_Server *serverLocal, const UA_NodeId *sessionId,
+                                     void *sessionContext, const UA_NodeId *nodeid,
+                                     void *nodeContext, const UA_NumericRange *range) {
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(SinglePublishSubscribeRTFixedSize) {
+        UA_ByteString sk = {UA_AES128CTR_SIGNING_KEY_LENGTH, signingKey};
+        UA_ByteString ek = {UA_AES128CTR_KEY_LENGTH, encryptingKey};
+        UA_ByteString kn = {UA_AES128CTR_KEYNONCE_LENGTH, keyNonce};
+
+        /* Published DataSet with a static value source */
+        UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+        UA_PublishedDataSetConfig pdsConfig;
+        memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+        pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+        pdsConfig.name = UA_STRING("PublishedDataSet Test");
+        retVal = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetTest).addResult;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_UInt32 *publisherData = UA_UInt32_new();
+        *publisherData = PUBLISHER_DATA;
+        UA_DataValue *publisherValue = UA_DataValue_new();
+        UA_Variant_setScalar(&publisherValue->value, publisherData, &UA_TYPES[UA_TYPES_UINT32]);
+        UA_NodeId dataSetFieldIdent;
+        UA_DataSetFieldConfig dataSetFieldConfig;
+        memset(&dataSetFieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        dataSetFieldConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+        dataSetFieldConfig.field.variable.rtValueSource.staticValueSource = &publisherValue;
+        dataSetFieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        retVal = UA_Server_addDataSetField(server, publishedDataSetTest, &dataSetFieldConfig,
+                                           &dataSetFieldIdent).result;
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Writer group with fixed offsets */
+        UA_NodeId writerGroup;
+        UA_WriterGroupConfig writerGroupConfig;
+        memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+        writerGroupConfig.name               = UA_STRING("WriterGroup Test");
+        writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+        writerGroupConfig.enabled            = UA_FALSE;
+        writerGroupConfig.writerGroupId      = WRITER_GROUP_ID;
+        writerGroupConfig.rtLevel            = UA_PUBSUB_RT_FIXED_SIZE;
+        writerGroupConfig.encodingMimeType   = UA_PUBSUB_ENCODING_UADP;
+        writerGroupConfig.messageSettings.encoding             = UA_EXTENSIONOBJECT_DECODED;
+        writerGroupConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+        UA_UadpWriterGroupMessageDataType *writerGroupMessage  = UA_UadpWriterGroupMessageDataType_new();
+        writerGroupMessage->networkMessageContentMask          = (UA_UadpNetworkMessageContentMask)(UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+                                                                  (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+                                                                  (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+                                                                  (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+        writerGroupConfig.messageSettings.content.decoded.data = writerGroupMessage;
+        writerGroupConfig.securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+        writerGroupConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+        retVal = UA_Server_addWriterGroup(server, connection_test, &writerGroupConfig, &writerGroup);
+        UA_UadpWriterGroupMessageDataType_delete(writerGroupMessage);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        UA_NodeId dataSetWriter;
+        UA_DataSetWriterConfig dataSetWriterConfig;
+        memset(&dataSetWriterConfig, 0, sizeof(dataSetWriterConfig));
+        dataSetWriterConfig.name            = UA_STRING("DataSetWriter Test");
+        dataSetWriterConfig.dataSetWriterId = DATASET_WRITER_ID;
+        retVal = UA_Server_addDataSetWriter(server, writerGroup, publishedDataSetTest,
+                                            &dataSetWriterConfig, &dataSetWriter);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        retVal = UA_Server_setWriterGroupEncryptionKeys(server, writerGroup, 1, sk, ek, kn);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Reader Group with fixed offsets */
+        UA_ReaderGroupConfig readerGroupConfig;
+        memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+        readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+        readerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+        readerGroupConfig.timeout = 1000000;
+        readerGroupConfig.securityMode = UA_MESSAGESECURITYMODE_SIGNANDENCRYPT;
+        readerGroupConfig.securityPolicy = &config->pubSubConfig.securityPolicies[0];
+        retVal = UA_Server_addReaderGroup(server, connection_test, &readerGroupConfig, &readerGroupTest);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        retVal = UA_Server_setReaderGroupEncryptionKeys(server, readerGroupTest, 1, sk, ek, kn);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+
+        /* Subscribed variable with an external value backend */
+        UA_NodeId newnodeId;
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed UInt32");
+        vAttr.dataType    = UA_TYPES[UA_TYPES_UINT32].typeId;
+        retVal = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, SUBSCRIBEVARIABLE_NODEID),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                           UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           vAttr, NULL, &newnodeId);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_DataValue *subscribedValue = UA_DataValue_new();
+        subscribedValue->hasValue = true;
+        UA_Variant_setScalar(&subscribedValue->value, &subscribedData, &UA_TYPES[UA_TYPES_UINT32]);
+        subscribedValue->value.storageType = UA_VARIANT_DATA_NODELETE;
+        UA_ValueBackend valueBackend;
+        valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+        valueBackend.backend.external.value = &subscribedValue;
+        valueBackend.backend.external.callback.userWrite = externalDataWriteCallback;
+        valueBackend.backend.external.callback.notificationRead = externalDataReadNotificationCallback;
+        UA_Server_setVariableNode_valueBackend(server, newnodeId, valueBackend);
+
+        /* Data Set Reader */
+        UA_NodeId readerIdentifier;
+        UA_DataSetReaderConfig readerConfig;
+        memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+        readerConfig.name             = UA_STRING("DataSetReader Test");
+        UA_UInt16 publisherIdentifier = PUBLISHER_ID;
+        readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+        readerConfig.publisherId.data = &publisherIdentifier;
+        readerConfig.writerGroupId    = WRITER_GROUP_ID;
+        readerConfig.dataSetWriterId  = DATASET_WRITER_ID;
+        readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+        readerConfig.messageSettings.content.decoded.type = &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+        UA_UadpDataSetReaderMessageDataType *dataSetReaderMessage = UA_UadpDataSetReaderMessageDataType_new();
+        dataSetReaderMessage->networkMessageContentMask = (UA_UadpNetworkMessageContentMask)(UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+                                                           (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+                                                           (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+                                                           (UA_UadpNetworkMessageContentMask)UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+        readerConfig.messageSettings.content.decoded.data = dataSetReaderMessage;
+        UA_DataSetMetaDataType *pMetaData = &readerConfig.dataSetMetaData;
+        UA_DataSetMetaDataType_init(pMetaData);
+        pMetaData->name       = UA_STRING("DataSet Test");
+        pMetaData->fieldsSize = 1;
+        pMetaData->fields     = (UA_FieldMetaData*)UA_Array_new(pMetaData->fieldsSize,
+                                                                &UA_TYPES[UA_TYPES_FIELDMETADATA]);
+        UA_FieldMetaData_init(&pMetaData->fields[0]);
+        UA_NodeId_copy(&UA_TYPES[UA_TYPES_UINT32].typeId, &pMetaData->fields[0].dataType);
+        pMetaData->fields[0].builtInType = UA_NS0ID_UINT32;
+        pMetaData->fields[0].valueRank   = -1; /* scalar */
+        UA_FieldTargetVariable targetVar;
+        memset(&targetVar, 0, sizeof(UA_FieldTargetVariable));
+        UA_FieldTargetDataType_init(&targetVar.targetVariable);
+        targetVar.targetVariable.attributeId  = UA_ATTRIBUTEID_VALUE;
+        targetVar.targetVariable.targetNodeId = newnodeId;
+        readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = 1;
+        readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = &targetVar;
+        retVal = UA_Server_addDataSetReader(server, readerGroupTest, &readerConfig,
+                                            &readerIdentifier);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_UadpDataSetReaderMessageDataType_delete(dataSetReaderMessage);
+        UA_free(pMetaData->fields);
+
+        /* Setting the WriterGroup operational sends the first message */
+        ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupTest),
+                         UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(UA_Server_freezeWriterGroupConfiguration(server, writerGroup),
+                         UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(UA_Server_setWriterGroupOperational(server, writerGroup),
+                         UA_STATUSCODE_GOOD);
+
+        UA_PubSubConnection *connection =
+            UA_PubSubConnection_findConnectionbyId(server, connection_test);
+        UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupTest);
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroup);
+        ck_assert(connection && rg && wg);
+        retVal = receiveBufferedNetworkMessage(server, rg, connection);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(subscribedData, PUBLISHER_DATA);
+
+        /* The buffered message is not modified by the encryption. A fresh
+         * MessageNonce is used for every message. */
+        UA_UInt32 nonceSequenceNumber = wg->nonceSequenceNumber;
+        *publisherData = PUBLISHER_DATA + 1;
+        UA_WriterGroup_publishCallback(server, wg);
+        ck_assert_uint_eq(wg->nonceSequenceNumber, nonceSequenceNumber + 1);
+        retVal = receiveBufferedNetworkMessage(server, rg, connection);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(subscribedData, PUBLISHER_DATA + 1);
+
+        /* Tampered messages are rejected */
+        *publisherData = PUBLISHER_DATA + 2;
+        UA_WriterGroup_publishCallback(server, wg);
+        UA_ByteString buffer;
+        retVal = UA_ByteString_allocBuffer(&buffer, 512);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        retVal = connection->channel->receive(connection->channel, &buffer, NULL, 1000000);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_GOOD);
+        UA_DataSetReader *dsr = LIST_FIRST(&rg->readers);
+        buffer.data[dsr->bufferedMessage.payloadOffset] ^= 0x01;
+        size_t messageEnd = 0;
+        retVal = verifyAndDecryptBufferedNetworkMessage(&config->logger, &buffer, 0,
+                                                        &dsr->bufferedMessage, rg,
+                                                        &messageEnd);
+        ck_assert_int_eq(retVal, UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+        UA_ByteString_clear(&buffer);
+        ck_assert_uint_eq(subscribedData, PUBLISHER_DATA + 1);
+
+        ck_assert_int_eq(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupTest),
+                         UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(UA_Server_unfreezeWriterGroupConfiguration(server, writerGroup),
+                         UA_STATUSCODE_GOOD);
+        UA_DataValue_delete(publisherValue);
+        UA_DataValue_delete(subscribedValue);
+    } END_TEST
+
 int main(void) {
 
     /*Test case to run both publisher and subscriber */
@@ -411,6 +622,7 @@ int main(void) {
     tcase_add_checked_fixture(tc_pubsub_publish_subscribe, setup, teardown);
     // tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeDateTime);
     tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeInt32);
+    tcase_add_test(tc_pubsub_publish_subscribe, SinglePublishSubscribeRTFixedSize);
 
     Suite *suite = suite_create("PubSub readerGroups/reader/Fields handling and publishing");
     suite_add_tcase(suite, tc_pubsub_publish_subscribe);
@@ -4,12 +4,16 @@
 
 #include <open62541/client.h>
 #include <open62541/client_config_default.h>
+#include <open62541/plugin/accesscontrol_default.h>
 #include <open62541/server.h>
 #include <open62541/server_config_default.h>
 #include <open62541/types.h>
 
 #include <check.h>
+#include <stdio.h>
+#include <unistd.h>
 
+#include "testing_clock.h"
 #include "thread_wrapper.h"
 
 UA_Server *server;
@@ -31,6 +35,63 @@ static void setup(void) {
     THREAD_CREATE(server_thread, serverloop);
 }
 
+#define LOGINFILE "check_accesscontrol_logins.txt"
+
+/* Load additional logins from a file before the server is started */
+static void setupLoginFile(void) {
+    running = true;
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+
+    FILE *f = fopen(LOGINFILE, "w");
+    ck_assert_ptr_ne(f, NULL);
+    fprintf(f, "# username:password\n\nuser3:secret3\n");
+    UA_String password = UA_STRING("secret4");
+    UA_String hashed = UA_STRING_NULL;
+    if(UA_AccessControl_default_hashPassword(&password, 0, &hashed) == UA_STATUSCODE_GOOD) {
+        fprintf(f, "user4:%.*s\n", (int)hashed.length, (char*)hashed.data);
+        UA_String_clear(&hashed);
+    } else {
+        fprintf(f, "user4:secret4\n");
+    }
+    fclose(f);
+    UA_StatusCode res = UA_AccessControl_default_loadLogins(config, LOGINFILE);
+    unlink(LOGINFILE);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+/* Start without logins. The endpoints are created before the login is added. */
+static void setupNoLogins(void) {
+    running = true;
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+
+    const UA_ByteString uri = UA_STRING_STATIC("http://opcfoundation.org/UA/SecurityPolicy#None");
+    UA_StatusCode res = UA_AccessControl_default(config, true, &uri, 0, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Array_delete(config->endpoints, config->endpointsSize,
+                    &UA_TYPES[UA_TYPES_ENDPOINTDESCRIPTION]);
+    config->endpoints = NULL;
+    config->endpointsSize = 0;
+    res = UA_ServerConfig_addEndpoint(config, uri, UA_MESSAGESECURITYMODE_NONE);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(config->endpoints[0].userIdentityTokensSize, 1);
+
+    UA_String username = UA_STRING("user5");
+    UA_String password = UA_STRING("secret5");
+    res = UA_AccessControl_default_addLogin(config, &username, &password);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(config->endpoints[0].userIdentityTokensSize, 2);
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
 static void teardown(void) {
     running = false;
     THREAD_JOIN(server_thread);
@@ -85,6 +146,146 @@ START_TEST(Client_pass_fail) {
     UA_Client_delete(client);
 } END_TEST
 
+START_TEST(Client_user_from_file) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval =
+        UA_Client_connectUsername(client, "opc.tcp://localhost:4840", "user3", "secret3");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Client_disconnect(client);
+
+    retval = UA_Client_connectUsername(client, "opc.tcp://localhost:4840", "user4", "secret4");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Client_disconnect(client);
+
+    retval = UA_Client_connectUsername(client, "opc.tcp://localhost:4840", "user4", "secret3");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADUSERACCESSDENIED);
+    UA_Client_disconnect(client);
+
+    /* The logins from the configuration are still there */
+    retval = UA_Client_connectUsername(client, "opc.tcp://localhost:4840", "user1", "password");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+START_TEST(Client_user_added_later) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig_setDefault(UA_Client_getConfig(client));
+    UA_StatusCode retval =
+        UA_Client_connectUsername(client, "opc.tcp://localhost:4840", "user5", "secret5");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Client_disconnect(client);
+
+    retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+static UA_StatusCode
+activate(UA_AccessControl *ac, const UA_NodeId *sessionId,
+         const char *username, const char *password, void **sessionContext) {
+    UA_UserNameIdentityToken token;
+    UA_UserNameIdentityToken_init(&token);
+    token.policyId = UA_STRING("open62541-username-policy");
+    token.userName = UA_STRING((char*)(uintptr_t)username);
+    token.password = UA_STRING((char*)(uintptr_t)password);
+    UA_ExtensionObject eo;
+    UA_ExtensionObject_setValueNoDelete(&eo, &token,
+                                        &UA_TYPES[UA_TYPES_USERNAMEIDENTITYTOKEN]);
+    return ac->activateSession(NULL, ac, NULL, NULL, sessionId, &eo, sessionContext);
+}
+
+START_TEST(AccessControl_lockout) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    UA_UsernamePasswordLogin logins[2] = {
+        {UA_STRING_STATIC("user"), UA_STRING_STATIC("password")},
+        {UA_STRING_STATIC("other"), UA_STRING_STATIC("password")}};
+    const UA_ByteString uri = UA_STRING_STATIC("http://opcfoundation.org/UA/SecurityPolicy#None");
+    UA_StatusCode res = UA_AccessControl_default(&config, false, &uri, 2, logins);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_AccessControl *ac = &config.accessControl;
+
+    UA_NodeId session1 = UA_NODEID_NUMERIC(1, 1);
+    UA_NodeId session2 = UA_NODEID_NUMERIC(1, 2);
+    void *sessionContext = NULL;
+
+    /* Fail until the username is locked out */
+    for(size_t i = 0; i < 3; i++) {
+        res = activate(ac, &session1, "user", "wrong", &sessionContext);
+        ck_assert_uint_eq(res, UA_STATUSCODE_BADUSERACCESSDENIED);
+    }
+    res = activate(ac, &session1, "user", "password", &sessionContext);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADUSERACCESSDENIED);
+
+    /* A new Session does not reset the lockout */
+    ac->closeSession(NULL, ac, &session1, NULL);
+    res = activate(ac, &session2, "user", "password", &sessionContext);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADUSERACCESSDENIED);
+
+    /* Other usernames are not affected */
+    res = activate(ac, &session2, "other", "password", &sessionContext);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ac->closeSession(NULL, ac, &session2, sessionContext);
+
+    /* Unknown usernames are locked out as well */
+    for(size_t i = 0; i < 3; i++) {
+        res = activate(ac, &session1, "unknown", "wrong", &sessionContext);
+        ck_assert_uint_eq(res, UA_STATUSCODE_BADUSERACCESSDENIED);
+    }
+
+    /* The first lockout lasts one second */
+    UA_fakeSleep(1100);
+    res = activate(ac, &session1, "user", "password", &sessionContext);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ac->closeSession(NULL, ac, &session1, sessionContext);
+
+    ac->clear(ac);
+} END_TEST
+
+START_TEST(AccessControl_addLogin) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    const UA_ByteString uri = UA_STRING_STATIC("http://opcfoundation.org/UA/SecurityPolicy#None");
+    UA_StatusCode res = UA_AccessControl_default(&config, true, &uri, 0, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_AccessControl *ac = &config.accessControl;
+    ck_assert_uint_eq(ac->userTokenPoliciesSize, 1);
+
+    /* Fewer iterations for the passwords hashed by the plugin */
+    res = UA_AccessControl_default_setHashIterations(&config, 0);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADINVALIDARGUMENT);
+    res = UA_AccessControl_default_setHashIterations(&config, 1000);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Adding a login advertises the username policy */
+    char name[16];
+    for(size_t i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "user%u", (unsigned)i);
+        UA_String username = UA_STRING(name);
+        UA_String password = UA_STRING("password");
+        res = UA_AccessControl_default_addLogin(&config, &username, &password);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(ac->userTokenPoliciesSize, 2);
+    ck_assert_int_eq(ac->userTokenPolicies[1].tokenType, UA_USERTOKENTYPE_USERNAME);
+
+    /* Usernames are unique */
+    UA_String username = UA_STRING("user42");
+    UA_String password = UA_STRING("other");
+    res = UA_AccessControl_default_addLogin(&config, &username, &password);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADALREADYEXISTS);
+
+    UA_NodeId sessionId = UA_NODEID_NUMERIC(1, 1);
+    void *sessionContext = NULL;
+    res = activate(ac, &sessionId, "user42", "password", &sessionContext);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ac->closeSession(NULL, ac, &sessionId, sessionContext);
+
+    ac->clear(ac);
+} END_TEST
 
 static Suite* testSuite_Client(void) {
     Suite *s = suite_create("Client");
@@ -95,6 +296,21 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client_user, Client_user_fail);
     tcase_add_test(tc_client_user, Client_pass_fail);
     suite_add_tcase(s,tc_client_user);
+
+    TCase *tc_login_file = tcase_create("Client Login File");
+    tcase_add_checked_fixture(tc_login_file, setupLoginFile, teardown);
+    tcase_add_test(tc_login_file, Client_user_from_file);
+    suite_add_tcase(s,tc_login_file);
+
+    TCase *tc_no_logins = tcase_create("Client Login Added Later");
+    tcase_add_checked_fixture(tc_no_logins, setupNoLogins, teardown);
+    tcase_add_test(tc_no_logins, Client_user_added_later);
+    suite_add_tcase(s,tc_no_logins);
+
+    TCase *tc_plugin = tcase_create("Default AccessControl Plugin");
+    tcase_add_test(tc_plugin, AccessControl_lockout);
+    tcase_add_test(tc_plugin, AccessControl_addLogin);
+    suite_add_tcase(s,tc_plugin);
     return s;
 }
 
@@ -6,6 +6,8 @@
 #include <open62541/util.h>
 #include <open62541/plugin/nodestore_default.h>
 
+#include "ua_server_internal.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -248,6 +250,149 @@ START_TEST(profileGetDelete) {
 }
 END_TEST
 
+static UA_Node *
+createNodeWithReferences(UA_UInt32 targets) {
+    UA_Node *n = createNode(0, 2253);
+    for(UA_UInt32 i = 0; i < targets; i++) {
+        UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(1, i + 1);
+        UA_StatusCode res = UA_Node_addReference(n, UA_REFERENCETYPEINDEX_ORGANIZES,
+                                                 true, &target, i % 10);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    return n;
+}
+
+/* All targets are found and iterated in ascending order */
+static void
+checkReferences(const UA_Node *n, UA_UInt32 targets) {
+    ck_assert_uint_eq(n->head.referencesSize, 1);
+    const UA_NodeReferenceKind *rk = &n->head.references[0];
+    ck_assert_uint_eq(rk->targetsSize, targets);
+
+    size_t count = 0;
+    const UA_ReferenceTarget *prev = NULL;
+    for(UA_ReferenceTarget *t = UA_NodeReferenceKind_firstTarget(rk);
+        t; t = UA_NodeReferenceKind_nextTarget(rk, t)) {
+        if(prev)
+            ck_assert(prev->targetIdHash <= t->targetIdHash);
+        prev = t;
+        count++;
+    }
+    ck_assert_uint_eq(count, targets);
+
+    for(UA_UInt32 i = 0; i < targets; i++) {
+        UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(1, i + 1);
+        const UA_ReferenceTarget *t = UA_NodeReferenceKind_findTarget(rk, &target);
+        ck_assert(t != NULL);
+        ck_assert(UA_ExpandedNodeId_equal(&t->targetId, &target));
+    }
+    UA_ExpandedNodeId missing = UA_EXPANDEDNODEID_NUMERIC(1, targets + 1);
+    ck_assert(UA_NodeReferenceKind_findTarget(rk, &missing) == NULL);
+
+    /* Lookup by BrowseName hash */
+    count = 0;
+    for(UA_ReferenceTarget *t = UA_NodeReferenceKind_nextTargetByName(rk, 3, NULL);
+        t; t = UA_NodeReferenceKind_nextTargetByName(rk, 3, t)) {
+        ck_assert_uint_eq(t->targetNameHash, 3);
+        count++;
+    }
+    ck_assert_uint_eq(count, (targets + 6) / 10);
+    ck_assert(UA_NodeReferenceKind_nextTargetByName(rk, 10, NULL) == NULL);
+}
+
+START_TEST(referencesArray) {
+    UA_Node *n = createNodeWithReferences(UA_REFERENCETARGETS_ARRAY_MAX);
+    ck_assert(!n->head.references[0].hasRefTree);
+    checkReferences(n, UA_REFERENCETARGETS_ARRAY_MAX);
+
+    /* No duplicate references */
+    UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(1, 1);
+    UA_StatusCode res = UA_Node_addReference(n, UA_REFERENCETYPEINDEX_ORGANIZES,
+                                             true, &target, 0);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED);
+
+    /* Remove all references */
+    for(UA_UInt32 i = 0; i < UA_REFERENCETARGETS_ARRAY_MAX; i++) {
+        target = UA_EXPANDEDNODEID_NUMERIC(1, i + 1);
+        res = UA_Node_deleteReference(n, UA_REFERENCETYPEINDEX_ORGANIZES, true, &target);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(n->head.referencesSize, 0);
+    ns.deleteNode(ns.context, n);
+} END_TEST
+
+START_TEST(referencesTree) {
+    const UA_UInt32 targets = UA_REFERENCETARGETS_ARRAY_MAX * 4;
+    UA_Node *n = createNodeWithReferences(targets);
+    ck_assert(n->head.references[0].hasRefTree);
+    checkReferences(n, targets);
+
+    /* Remove the upper half */
+    for(UA_UInt32 i = targets / 2; i < targets; i++) {
+        UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(1, i + 1);
+        UA_StatusCode res =
+            UA_Node_deleteReference(n, UA_REFERENCETYPEINDEX_ORGANIZES, true, &target);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    checkReferences(n, targets / 2);
+    ns.deleteNode(ns.context, n);
+} END_TEST
+
+START_TEST(referencesCopy) {
+    const UA_UInt32 targets = UA_REFERENCETARGETS_ARRAY_MAX * 4;
+    UA_Node *n = createNodeWithReferences(targets);
+
+    /* The copy keeps the trees */
+    UA_Node *copy = UA_Node_copy_alloc(n);
+    ck_assert(copy != NULL);
+    ck_assert(copy->head.references[0].hasRefTree);
+    checkReferences(copy, targets);
+    UA_Node_clear(copy);
+    UA_free(copy);
+
+    /* The copy of a small tree is an array */
+    for(UA_UInt32 i = UA_REFERENCETARGETS_ARRAY_MAX; i < targets; i++) {
+        UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(1, i + 1);
+        UA_Node_deleteReference(n, UA_REFERENCETYPEINDEX_ORGANIZES, true, &target);
+    }
+    copy = UA_Node_copy_alloc(n);
+    ck_assert(copy != NULL);
+    ck_assert(!copy->head.references[0].hasRefTree);
+    checkReferences(copy, UA_REFERENCETARGETS_ARRAY_MAX);
+    UA_Node_clear(copy);
+    UA_free(copy);
+    ns.deleteNode(ns.context, n);
+} END_TEST
+
+START_TEST(referencesFlatCopy) {
+    const UA_UInt32 targets = UA_REFERENCETARGETS_ARRAY_MAX * 4;
+    UA_Node *n = createNodeWithReferences(targets);
+
+    /* The flat copy uses an array also for many targets */
+    size_t size = UA_Node_copyFlat(n, NULL);
+    ck_assert(size > 0);
+    UA_Node *flat = (UA_Node*)UA_malloc(size);
+    ck_assert(flat != NULL);
+    ck_assert_uint_eq(UA_Node_copyFlat(n, flat), size);
+    ck_assert(!flat->head.references[0].hasRefTree);
+    checkReferences(flat, targets);
+
+    /* Adding to the copy of a large array switches to the trees */
+    UA_Node *copy = UA_Node_copy_alloc(flat);
+    ck_assert(copy != NULL);
+    UA_ExpandedNodeId target = UA_EXPANDEDNODEID_NUMERIC(1, targets + 1);
+    UA_StatusCode res = UA_Node_addReference(copy, UA_REFERENCETYPEINDEX_ORGANIZES,
+                                             true, &target, targets % 10);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(copy->head.references[0].hasRefTree);
+    checkReferences(copy, targets + 1);
+    UA_Node_clear(copy);
+    UA_free(copy);
+
+    UA_free(flat);
+    ns.deleteNode(ns.context, n);
+} END_TEST
+
 static Suite * namespace_suite (void) {
     Suite *s = suite_create ("UA_NodeStore");
 
@@ -303,6 +448,14 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_profile_hm, profileGetDelete);
     suite_add_tcase (s, tc_profile_hm);
 
+    TCase* tc_references = tcase_create ("References");
+    tcase_add_checked_fixture(tc_references, setupHashMap, teardown);
+    tcase_add_test (tc_references, referencesArray);
+    tcase_add_test (tc_references, referencesTree);
+    tcase_add_test (tc_references, referencesCopy);
+    tcase_add_test (tc_references, referencesFlatCopy);
+    suite_add_tcase (s, tc_references);
+
     return s;
 }
 
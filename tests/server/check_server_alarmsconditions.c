@@ -9,6 +9,7 @@
 #include <open62541/server_config_default.h>
 
 #include <check.h>
+#include <time.h>
 
 UA_Server *server_ac;
 
@@ -50,6 +51,218 @@ START_TEST(createDelete) {
         ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
     }
 } END_TEST
+
+static UA_UInt16
+readSeverity(const UA_NodeId condition) {
+    UA_Variant value;
+    UA_StatusCode retval =
+        UA_Server_readObjectProperty(server_ac, condition, UA_QUALIFIEDNAME(0, "Severity"), &value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT16]));
+    UA_UInt16 severity = *(UA_UInt16*)value.data;
+    UA_Variant_clear(&value);
+    return severity;
+}
+
+START_TEST(setConditionField) {
+    UA_NodeId condition;
+    UA_StatusCode retval =
+        UA_Server_createCondition(server_ac, UA_NODEID_NULL,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OFFNORMALALARMTYPE),
+                                  UA_QUALIFIEDNAME(0, "Condition setConditionField"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                  UA_NODEID_NULL, &condition);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The second write uses the cached NodeId of the field */
+    UA_Variant value;
+    for(UA_UInt16 severity = 100; severity <= 200; severity += 100) {
+        UA_Variant_setScalar(&value, &severity, &UA_TYPES[UA_TYPES_UINT16]);
+        retval = UA_Server_setConditionField(server_ac, condition, &value,
+                                             UA_QUALIFIEDNAME(0, "Severity"));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(readSeverity(condition), severity);
+    }
+
+    /* Adding an optional field resets the cached fields */
+    UA_Boolean suppressed = true;
+    UA_Variant_setScalar(&value, &suppressed, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    retval = UA_Server_setConditionVariableFieldProperty(server_ac, condition, &value,
+                                                         UA_QUALIFIEDNAME(0, "SuppressedState"),
+                                                         UA_QUALIFIEDNAME(0, "Id"));
+    ck_assert_uint_ne(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_addConditionOptionalField(server_ac, condition,
+                                                 UA_NODEID_NUMERIC(0, UA_NS0ID_ALARMCONDITIONTYPE),
+                                                 UA_QUALIFIEDNAME(0, "SuppressedState"), NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_setConditionVariableFieldProperty(server_ac, condition, &value,
+                                                         UA_QUALIFIEDNAME(0, "SuppressedState"),
+                                                         UA_QUALIFIEDNAME(0, "Id"));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_UInt16 severity = 300;
+    UA_Variant_setScalar(&value, &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    retval = UA_Server_setConditionField(server_ac, condition, &value,
+                                         UA_QUALIFIEDNAME(0, "Severity"));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(readSeverity(condition), 300);
+
+    retval = UA_Server_deleteCondition(server_ac, condition, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_NodeId_clear(&condition);
+} END_TEST
+
+static void
+addSeverityVariable(const UA_NodeId requestedId, const UA_NodeId parent,
+                    const UA_NodeId referenceType, const char *name,
+                    UA_NodeId *outNodeId) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_UInt16 severity = 0;
+    UA_Variant_setScalar(&attr.value, &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    attr.dataType = UA_TYPES[UA_TYPES_UINT16].typeId;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server_ac, requestedId, parent, referenceType,
+                                  UA_QUALIFIEDNAME(0, (char*)(uintptr_t)name),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE),
+                                  attr, NULL, outNodeId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+/* The cached NodeId of a deleted field must not be used, also not when the
+ * NodeId is given to a different node */
+START_TEST(setConditionFieldDeleted) {
+    UA_NodeId condition;
+    UA_StatusCode retval =
+        UA_Server_createCondition(server_ac, UA_NODEID_NULL,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OFFNORMALALARMTYPE),
+                                  UA_QUALIFIEDNAME(0, "Condition setConditionFieldDeleted"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                  UA_NODEID_NULL, &condition);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_UInt16 severity = 100;
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    retval = UA_Server_setConditionField(server_ac, condition, &value,
+                                         UA_QUALIFIEDNAME(0, "Severity"));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Replace the Severity field and reuse its NodeId elsewhere */
+    UA_QualifiedName severityName = UA_QUALIFIEDNAME(0, "Severity");
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server_ac, condition, 1, &severityName);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    UA_NodeId oldSeverity;
+    UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, &oldSeverity);
+    UA_BrowsePathResult_clear(&bpr);
+    retval = UA_Server_deleteNode(server_ac, oldSeverity, true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    addSeverityVariable(oldSeverity, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES), "Other", NULL);
+    UA_NodeId newSeverity;
+    addSeverityVariable(UA_NODEID_NULL, condition,
+                        UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY), "Severity",
+                        &newSeverity);
+
+    severity = 200;
+    retval = UA_Server_setConditionField(server_ac, condition, &value,
+                                         UA_QUALIFIEDNAME(0, "Severity"));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(readSeverity(condition), 200);
+
+    UA_Variant other;
+    retval = UA_Server_readValue(server_ac, oldSeverity, &other);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(*(UA_UInt16*)other.data, 0);
+    UA_Variant_clear(&other);
+
+    UA_Server_deleteNode(server_ac, oldSeverity, true);
+    UA_NodeId_clear(&oldSeverity);
+    UA_NodeId_clear(&newSeverity);
+    retval = UA_Server_deleteCondition(server_ac, condition, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER));
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_NodeId_clear(&condition);
+} END_TEST
+
+/* Every condition instantiates the complete OffNormalAlarmType. So the number
+ * of conditions is kept lower than for a deployment with many alarms. */
+#define CONDITIONS 1000
+
+START_TEST(triggerAcknowledgeMany) {
+    UA_NodeId *conditions = (UA_NodeId*)UA_calloc(CONDITIONS, sizeof(UA_NodeId));
+    UA_ByteString *eventIds = (UA_ByteString*)UA_calloc(CONDITIONS, sizeof(UA_ByteString));
+    ck_assert(conditions != NULL && eventIds != NULL);
+    UA_NodeId source = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+
+    for(size_t i = 0; i < CONDITIONS; i++) {
+        UA_StatusCode retval =
+            UA_Server_createCondition(server_ac, UA_NODEID_NULL,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OFFNORMALALARMTYPE),
+                                      UA_QUALIFIEDNAME(0, "Condition triggerAcknowledgeMany"),
+                                      source, UA_NODEID_NULL, &conditions[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_Boolean enabled = true;
+        UA_Variant value;
+        UA_Variant_setScalar(&value, &enabled, &UA_TYPES[UA_TYPES_BOOLEAN]);
+        retval = UA_Server_setConditionVariableFieldProperty(server_ac, conditions[i], &value,
+                                                             UA_QUALIFIEDNAME(0, "EnabledState"),
+                                                             UA_QUALIFIEDNAME(0, "Id"));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        retval = UA_Server_setConditionField(server_ac, conditions[i], &value,
+                                             UA_QUALIFIEDNAME(0, "Retain"));
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < CONDITIONS; i++) {
+        UA_StatusCode retval =
+            UA_Server_triggerConditionEvent(server_ac, conditions[i], source, &eventIds[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    clock_t triggered = clock();
+
+    UA_LocalizedText comment = UA_LOCALIZEDTEXT("en", "acknowledged");
+    UA_Variant inputs[2];
+    UA_CallMethodRequest request;
+    UA_CallMethodRequest_init(&request);
+    request.methodId = UA_NODEID_NUMERIC(0, UA_NS0ID_ACKNOWLEDGEABLECONDITIONTYPE_ACKNOWLEDGE);
+    request.inputArgumentsSize = 2;
+    request.inputArguments = inputs;
+    for(size_t i = 0; i < CONDITIONS; i++) {
+        request.objectId = conditions[i];
+        UA_Variant_setScalar(&inputs[0], &eventIds[i], &UA_TYPES[UA_TYPES_BYTESTRING]);
+        UA_Variant_setScalar(&inputs[1], &comment, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+        UA_CallMethodResult result = UA_Server_call(server_ac, &request);
+        ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+        UA_CallMethodResult_clear(&result);
+    }
+    clock_t acknowledged = clock();
+
+    printf("%u conditions: trigger %f s, acknowledge %f s\n", CONDITIONS,
+           (double)(triggered - begin) / CLOCKS_PER_SEC,
+           (double)(acknowledged - triggered) / CLOCKS_PER_SEC);
+
+    /* The first EventId of a condition is superseded by the acknowledgement */
+    request.objectId = conditions[0];
+    UA_Variant_setScalar(&inputs[0], &eventIds[0], &UA_TYPES[UA_TYPES_BYTESTRING]);
+    UA_CallMethodResult result = UA_Server_call(server_ac, &request);
+    ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_BADEVENTIDUNKNOWN);
+    UA_CallMethodResult_clear(&result);
+
+    for(size_t i = 0; i < CONDITIONS; i++) {
+        UA_StatusCode retval = UA_Server_deleteCondition(server_ac, conditions[i], source);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        retval = UA_Server_deleteCondition(server_ac, conditions[i], source);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_BADNOTFOUND);
+        UA_NodeId_clear(&conditions[i]);
+        UA_ByteString_clear(&eventIds[i]);
+    }
+    UA_free(conditions);
+    UA_free(eventIds);
+} END_TEST
 #endif
 
 int main(void) {
@@ -58,6 +271,9 @@ int main(void) {
     TCase *tc_call = tcase_create("Alarms and Conditions");
 #ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     tcase_add_test(tc_call, createDelete);
+    tcase_add_test(tc_call, setConditionField);
+    tcase_add_test(tc_call, setConditionFieldDeleted);
+    tcase_add_test(tc_call, triggerAcknowledgeMany);
 #endif
     tcase_add_checked_fixture(tc_call, setup, teardown);
 
@@ -37,6 +37,43 @@ clientReceiveCallback(UA_Client *client, void *userdata,
     clientCounter++;
 }
 
+static UA_Int32 dataSourceValue;
+
+static UA_StatusCode
+readDataSource(UA_Server *serverArg, const UA_NodeId *sessionId,
+               void *sessionContext, const UA_NodeId *nodeId, void *nodeContext,
+               UA_Boolean includeSourceTimeStamp, const UA_NumericRange *range,
+               UA_DataValue *value) {
+    UA_Variant_setScalarCopy(&value->value, &dataSourceValue, &UA_TYPES[UA_TYPES_INT32]);
+    value->hasValue = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+writeDataSource(UA_Server *serverArg, const UA_NodeId *sessionId,
+                void *sessionContext, const UA_NodeId *nodeId, void *nodeContext,
+                const UA_NumericRange *range, const UA_DataValue *value) {
+    dataSourceValue = *(UA_Int32*)value->value.data;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_ReadResponse readResponse;
+static UA_WriteResponse writeResponse;
+
+static void
+clientReadCallback(UA_Client *client, void *userdata,
+                   UA_UInt32 requestId, UA_ReadResponse *rr) {
+    UA_ReadResponse_copy(rr, &readResponse);
+    clientCounter++;
+}
+
+static void
+clientWriteCallback(UA_Client *client, void *userdata,
+                    UA_UInt32 requestId, UA_WriteResponse *wr) {
+    UA_WriteResponse_copy(wr, &writeResponse);
+    clientCounter++;
+}
+
 THREAD_CALLBACK(serverloop) {
     while(running)
         UA_Server_run_iterate(server, true);
@@ -76,6 +113,28 @@ static void setup(void) {
     res = UA_Server_setMethodNodeAsync(server, UA_NODEID_STRING(1, "asyncMethod"), true);
     ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
 
+    /* Asynchronous DataSource */
+    dataSourceValue = 42;
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    attr.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    attr.valueRank = UA_VALUERANK_SCALAR;
+    UA_DataSource dataSource;
+    dataSource.read = readDataSource;
+    dataSource.write = writeDataSource;
+    res = UA_Server_addDataSourceVariableNode(server, UA_NODEID_STRING(1, "asyncVariable"),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                            UA_QUALIFIEDNAME(1, "asyncVariable"),
+                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                            attr, dataSource, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_setVariableNodeAsync(server, UA_NODEID_STRING(1, "asyncVariable"), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ReadResponse_init(&readResponse);
+    UA_WriteResponse_init(&writeResponse);
+
     UA_Server_run_startup(server);
     THREAD_CREATE(server_thread, serverloop);
 }
@@ -85,6 +144,8 @@ static void teardown(void) {
     THREAD_JOIN(server_thread);
     UA_Server_run_shutdown(server);
     UA_Server_delete(server);
+    UA_ReadResponse_clear(&readResponse);
+    UA_WriteResponse_clear(&writeResponse);
 }
 
 START_TEST(Async_call) {
@@ -242,6 +303,178 @@ START_TEST(Async_timeout_worker) {
     UA_Client_delete(client);
 } END_TEST
 
+/* Read the async DataSource together with a synchronous attribute. The
+ * response is sent when the worker has returned the value. */
+START_TEST(Async_read) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefault(clientConfig);
+
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    UA_ReadValueId rvi[2];
+    UA_ReadValueId_init(&rvi[0]);
+    rvi[0].nodeId = UA_NODEID_STRING(1, "asyncVariable");
+    rvi[0].attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadValueId_init(&rvi[1]);
+    rvi[1].nodeId = UA_NODEID_STRING(1, "asyncVariable");
+    rvi[1].attributeId = UA_ATTRIBUTEID_BROWSENAME;
+    UA_ReadRequest rr;
+    UA_ReadRequest_init(&rr);
+    rr.nodesToRead = rvi;
+    rr.nodesToReadSize = 2;
+    rr.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    retval = UA_Client_sendAsyncReadRequest(client, &rr, clientReadCallback, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* No response before the worker has returned */
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 0);
+
+    /* Process the async read for the server */
+    UA_AsyncOperationType aot;
+    const UA_AsyncOperationRequest *request;
+    void *context;
+    UA_Boolean haveAsync =
+        UA_Server_getAsyncOperationNonBlocking(server, &aot, &request, &context, NULL);
+    ck_assert_uint_eq(haveAsync, true);
+    ck_assert_uint_eq(aot, UA_ASYNCOPERATIONTYPE_READ);
+    ck_assert_uint_eq(request->readValueId.attributeId, UA_ATTRIBUTEID_VALUE);
+    UA_AsyncOperationResponse response;
+    response.readResult = UA_Server_read(server, &request->readValueId,
+                                         UA_TIMESTAMPSTORETURN_BOTH);
+    UA_Server_setAsyncOperationResult(server, &response, context);
+    UA_DataValue_clear(&response.readResult);
+
+    /* Iterate and pick up the async response to be sent out */
+    UA_fakeSleep(1000);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 1);
+
+    ck_assert_uint_eq(readResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(readResponse.resultsSize, 2);
+    ck_assert(readResponse.results[0].hasValue);
+    ck_assert_int_eq(*(UA_Int32*)readResponse.results[0].value.data, 42);
+    ck_assert(readResponse.results[0].hasServerTimestamp);
+    ck_assert(!readResponse.results[0].hasSourceTimestamp);
+    ck_assert(readResponse.results[1].hasValue);
+    ck_assert(readResponse.results[1].value.type == &UA_TYPES[UA_TYPES_QUALIFIEDNAME]);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+START_TEST(Async_write) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefault(clientConfig);
+
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    UA_Int32 value = 23;
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = UA_NODEID_STRING(1, "asyncVariable");
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value.hasValue = true;
+    UA_Variant_setScalar(&wv.value.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    UA_WriteRequest wr;
+    UA_WriteRequest_init(&wr);
+    wr.nodesToWrite = &wv;
+    wr.nodesToWriteSize = 1;
+    retval = UA_Client_sendAsyncWriteRequest(client, &wr, clientWriteCallback, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 0);
+    ck_assert_int_eq(dataSourceValue, 42);
+
+    /* Process the async write for the server */
+    UA_AsyncOperationType aot;
+    const UA_AsyncOperationRequest *request;
+    void *context;
+    UA_Boolean haveAsync =
+        UA_Server_getAsyncOperationNonBlocking(server, &aot, &request, &context, NULL);
+    ck_assert_uint_eq(haveAsync, true);
+    ck_assert_uint_eq(aot, UA_ASYNCOPERATIONTYPE_WRITE);
+    UA_AsyncOperationResponse response;
+    response.writeResult = UA_Server_write(server, &request->writeValue);
+    UA_Server_setAsyncOperationResult(server, &response, context);
+    ck_assert_int_eq(dataSourceValue, 23);
+
+    UA_fakeSleep(1000);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 1);
+    ck_assert_uint_eq(writeResponse.resultsSize, 1);
+    ck_assert_uint_eq(writeResponse.results[0], UA_STATUSCODE_GOOD);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+/* The async read times out if the worker does not return */
+START_TEST(Async_read_timeout) {
+    UA_Client *client = UA_Client_new();
+    UA_ClientConfig *clientConfig = UA_Client_getConfig(client);
+    UA_ClientConfig_setDefault(clientConfig);
+
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = UA_NODEID_STRING(1, "asyncVariable");
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadRequest rr;
+    UA_ReadRequest_init(&rr);
+    rr.nodesToRead = &rvi;
+    rr.nodesToReadSize = 1;
+    retval = UA_Client_sendAsyncReadRequest(client, &rr, clientReadCallback, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 0);
+
+    UA_fakeSleep(2500);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 1);
+    ck_assert_uint_eq(readResponse.resultsSize, 1);
+    ck_assert(readResponse.results[0].hasStatus);
+    ck_assert_uint_eq(readResponse.results[0].status, UA_STATUSCODE_BADTIMEOUT);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
 static Suite* method_async_suite(void) {
     /* set up unit test for internal data structures */
     Suite *s = suite_create("Async Method");
@@ -252,6 +485,13 @@ static Suite* method_async_suite(void) {
     tcase_add_test(tc_manager, Async_timeout);
     tcase_add_test(tc_manager, Async_timeout_worker);
     suite_add_tcase(s, tc_manager);
+
+    TCase* tc_readwrite = tcase_create("AsyncReadWrite");
+    tcase_add_checked_fixture(tc_readwrite, setup, teardown);
+    tcase_add_test(tc_readwrite, Async_read);
+    tcase_add_test(tc_readwrite, Async_write);
+    tcase_add_test(tc_readwrite, Async_read_timeout);
+    suite_add_tcase(s, tc_readwrite);
     
     return s;
 }
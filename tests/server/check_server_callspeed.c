@@ -0,0 +1,142 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This example is just to see how fast we can process method calls. The server
+   does not open a TCP port. */
+
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define COMPONENTS 100 /* Variables next to the method in the object */
+#define CALLS 100000 /* Number of calls to perform */
+
+static UA_Server *server;
+static UA_NodeId objectId;
+static UA_NodeId methodId;
+
+static UA_StatusCode
+addCallback(UA_Server *serverArg,
+            const UA_NodeId *sessionId, void *sessionHandle,
+            const UA_NodeId *methodNodeId, void *methodContext,
+            const UA_NodeId *objectNodeId, void *objectContext,
+            size_t inputSize, const UA_Variant *input,
+            size_t outputSize, UA_Variant *output) {
+    UA_Double sum = *(UA_Int32*)input[0].data + *(UA_Double*)input[1].data;
+    return UA_Variant_setScalarCopy(output, &sum, &UA_TYPES[UA_TYPES_DOUBLE]);
+}
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Device"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                oAttr, NULL, &objectId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The method is found among the other components of the object */
+    UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&vAttr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    for(size_t i = 0; i < COMPONENTS; i++) {
+        char varName[20];
+        UA_snprintf(varName, 20, "Variable %u", (UA_UInt32)i);
+        retval = UA_Server_addVariableNode(server, UA_NODEID_NULL, objectId,
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                           UA_QUALIFIEDNAME(1, varName),
+                                           UA_NODEID_NULL, vAttr, NULL, NULL);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_Argument inputArguments[2];
+    UA_Argument_init(&inputArguments[0]);
+    inputArguments[0].name = UA_STRING("Summand 1");
+    inputArguments[0].dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    inputArguments[0].valueRank = UA_VALUERANK_SCALAR;
+    UA_Argument_init(&inputArguments[1]);
+    inputArguments[1].name = UA_STRING("Summand 2");
+    inputArguments[1].dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    inputArguments[1].valueRank = UA_VALUERANK_SCALAR;
+
+    UA_Argument outputArgument;
+    UA_Argument_init(&outputArgument);
+    outputArgument.name = UA_STRING("Sum");
+    outputArgument.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    outputArgument.valueRank = UA_VALUERANK_SCALAR;
+
+    UA_MethodAttributes mAttr = UA_MethodAttributes_default;
+    mAttr.executable = true;
+    mAttr.userExecutable = true;
+    retval = UA_Server_addMethodNode(server, UA_NODEID_NULL, objectId,
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                     UA_QUALIFIEDNAME(1, "Add"), mAttr, &addCallback,
+                                     2, inputArguments, 1, &outputArgument,
+                                     NULL, &methodId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_NodeId_clear(&objectId);
+    UA_NodeId_clear(&methodId);
+    UA_Server_delete(server);
+}
+
+static void
+measure(const char *name) {
+    UA_Int32 summand1 = 1;
+    UA_Double summand2 = 0.5;
+    UA_Variant input[2];
+    UA_Variant_setScalar(&input[0], &summand1, &UA_TYPES[UA_TYPES_INT32]);
+    UA_Variant_setScalar(&input[1], &summand2, &UA_TYPES[UA_TYPES_DOUBLE]);
+
+    UA_CallMethodRequest request;
+    UA_CallMethodRequest_init(&request);
+    request.objectId = objectId;
+    request.methodId = methodId;
+    request.inputArgumentsSize = 2;
+    request.inputArguments = input;
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < CALLS; i++) {
+        UA_CallMethodResult result = UA_Server_call(server, &request);
+        ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+        UA_CallMethodResult_clear(&result);
+    }
+    clock_t finish = clock();
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%s: %u calls in %f s (%.0f calls/s)\n", name, CALLS, time_spent,
+           time_spent > 0 ? CALLS / time_spent : 0.0);
+}
+
+START_TEST(callSpeed) {
+    UA_Server_getConfig(server)->maxMethodCallCacheSize = 0;
+    measure("without cache");
+    UA_Server_getConfig(server)->maxMethodCallCacheSize = 1024;
+    measure("with cache");
+} END_TEST
+
+int main(void) {
+    TCase *tc_call = tcase_create("call");
+    tcase_add_checked_fixture(tc_call, setup, teardown);
+    tcase_add_test(tc_call, callSpeed);
+    tcase_set_timeout(tc_call, 0);
+    Suite *s = suite_create("Speed test for method calls");
+    suite_add_tcase(s, tc_call);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
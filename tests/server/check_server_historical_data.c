@@ -9,6 +9,10 @@
 #include <open62541/client_config_default.h>
 #include <open62541/client_highlevel.h>
 #include <open62541/plugin/historydata/history_data_backend.h>
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+#ifdef UA_ENABLE_HISTORIZING_FILE
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+#endif
 #include <open62541/plugin/historydata/history_data_backend_memory.h>
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
@@ -30,11 +34,24 @@
 #endif
 #include <stddef.h>
 
+#ifdef UA_ENABLE_HISTORIZING_FILE
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#endif
+
 static UA_Server *server;
 #ifdef UA_ENABLE_HISTORIZING
 static UA_HistoryDataGathering *gathering;
 #endif
 static UA_Boolean running;
+#ifdef UA_ENABLE_HISTORIZING_FILE
+/* Created by the file backend tests. Removed in the teardown, also when a
+ * test fails. */
+static char historyDirectory[32];
+#endif
 static THREAD_HANDLE server_thread;
 static MUTEX_HANDLE serverMutex;
 
@@ -133,6 +150,24 @@ static void setup(void) {
     client->connection.recv = UA_Client_recvTesting;
 }
 
+#ifdef UA_ENABLE_HISTORIZING_FILE
+static int
+removeEntry(const char *path, const struct stat *sb, int typeflag, struct FTW *ftwbuf) {
+    return remove(path);
+}
+
+static void
+removeDirectory(const char *path) {
+    nftw(path, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+static void
+createHistoryDirectory(void) {
+    strcpy(historyDirectory, "/tmp/ua_history_XXXXXX");
+    ck_assert_ptr_ne(mkdtemp(historyDirectory), NULL);
+}
+#endif
+
 static void teardown(void) {
     /* cleanup */
     UA_Client_disconnect(client);
@@ -146,6 +181,12 @@ static void teardown(void) {
     UA_Server_delete(server);
 #ifdef UA_ENABLE_HISTORIZING
     UA_free(gathering);
+#endif
+#ifdef UA_ENABLE_HISTORIZING_FILE
+    if (historyDirectory[0] != '\0') {
+        removeDirectory(historyDirectory);
+        historyDirectory[0] = '\0';
+    }
 #endif
     if (!MUTEX_DESTROY(serverMutex)) {
         fprintf(stderr, "Server mutex was not destroyed correctly.\n");
@@ -240,10 +281,10 @@ resultIsEqual(const UA_DataValue * result, const testTuple * tuple, size_t index
 }
 
 static UA_Boolean
-fillHistoricalDataBackend(UA_HistoryDataBackend backend)
+fillHistoricalDataBackend(UA_HistoryDataBackend backend, const UA_DateTime *data)
 {
     int i = 0;
-    UA_DateTime currentDateTime = testData[i];
+    UA_DateTime currentDateTime = data[i];
     fprintf(stderr, "Adding to historical data backend: ");
     while (currentDateTime) {
         fprintf(stderr, "%lld, ", currentDateTime / UA_DATETIME_SEC);
@@ -263,7 +304,7 @@ fillHistoricalDataBackend(UA_HistoryDataBackend backend)
             return false;
         }
         UA_DataValue_clear(&value);
-        currentDateTime = testData[++i];
+        currentDateTime = data[++i];
     }
     fprintf(stderr, "\n");
     return true;
@@ -621,7 +662,7 @@ START_TEST(Server_HistorizingUpdateDelete)
     ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
 
     // fill backend
-    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
 
     // delete some values
     ck_assert_str_eq(UA_StatusCode_name(deleteHistory(DELETE_START_TIME, DELETE_STOP_TIME)),
@@ -963,7 +1004,7 @@ START_TEST(Server_HistorizingBackendMemory)
     fprintf(stderr, "%d tests expected failed.\n", retval);
 
     // fill backend
-    ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
 
     // read all in one
     retval = testHistoricalDataBackend(100);
@@ -983,7 +1024,826 @@ START_TEST(Server_HistorizingBackendMemory)
 }
 END_TEST
 
+static UA_HistoryReadResponse
+clientHistoryReadRaw(const UA_NodeId *nodeId) {
+    UA_ReadRawModifiedDetails details;
+    UA_ReadRawModifiedDetails_init(&details);
+    details.startTime = TIMESTAMP_FIRST;
+    details.endTime = TIMESTAMP_LAST;
+
+    UA_HistoryReadValueId valueId;
+    UA_HistoryReadValueId_init(&valueId);
+    valueId.nodeId = *nodeId;
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.historyReadDetails.encoding = UA_EXTENSIONOBJECT_DECODED;
+    request.historyReadDetails.content.decoded.type =
+        &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS];
+    request.historyReadDetails.content.decoded.data = &details;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = &valueId;
+    return UA_Client_Service_historyRead(client, request);
+}
+
+/* The handles from RegisterNodes are resolved for all services */
+START_TEST(Server_HistorizingRegisteredNode)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
+
+    UA_RegisterNodesRequest regReq;
+    UA_RegisterNodesRequest_init(&regReq);
+    regReq.nodesToRegister = &outNodeId;
+    regReq.nodesToRegisterSize = 1;
+    UA_RegisterNodesResponse regRes = UA_Client_Service_registerNodes(client, regReq);
+    ck_assert_uint_eq(regRes.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(regRes.registeredNodeIdsSize, 1);
+    UA_NodeId handle = regRes.registeredNodeIds[0];
+    ck_assert(!UA_NodeId_equal(&handle, &outNodeId));
+
+    /* HistoryRead with the handle returns the history of the node */
+    UA_HistoryReadResponse expected = clientHistoryReadRaw(&outNodeId);
+    ck_assert_uint_eq(expected.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(expected.resultsSize, 1);
+    ck_assert_uint_eq(expected.results[0].statusCode, UA_STATUSCODE_GOOD);
+    UA_HistoryData *expectedData = (UA_HistoryData*)
+        expected.results[0].historyData.content.decoded.data;
+    ck_assert_uint_gt(expectedData->dataValuesSize, 0);
+
+    UA_HistoryReadResponse response = clientHistoryReadRaw(&handle);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    UA_HistoryData *data = (UA_HistoryData*)
+        response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, expectedData->dataValuesSize);
+    for(size_t i = 0; i < data->dataValuesSize; i++)
+        ck_assert_int_eq(data->dataValues[i].sourceTimestamp,
+                         expectedData->dataValues[i].sourceTimestamp);
+    UA_HistoryReadResponse_clear(&response);
+    UA_HistoryReadResponse_clear(&expected);
+
+#ifdef UA_ENABLE_NODEMANAGEMENT
+    /* DeleteNodes with the handle removes the node */
+    ret = UA_Client_deleteNode(client, handle, true);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    UA_NodeClass nodeClass;
+    serverMutexLock();
+    ret = UA_Server_readNodeClass(server, outNodeId, &nodeClass);
+    serverMutexUnlock();
+    ck_assert_uint_eq(ret, UA_STATUSCODE_BADNODEIDUNKNOWN);
+#endif
+
+    UA_RegisterNodesResponse_clear(&regRes);
+    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendColumnar)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1, 0);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // empty backend should not crash
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests expected failed.\n", retval);
+
+    // fill backend
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testData), true);
+
+    // read all in one
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous one at one request
+    retval = testHistoricalDataBackend(1);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous two at one request
+    retval = testHistoricalDataBackend(2);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+    UA_HistoryDataBackend_Columnar_clear(&setting.historizingBackend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingColumnarUpdateUpdate)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1, 0);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // fill backend with insert (out of order)
+    ck_assert_str_eq(UA_StatusCode_name(updateHistory(UA_PERFORMUPDATETYPE_INSERT, testData, NULL, NULL))
+                                        , UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    testResult(testDataSorted, NULL);
+
+    // delete some values
+    ck_assert_str_eq(UA_StatusCode_name(deleteHistory(DELETE_START_TIME, DELETE_STOP_TIME)),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    testResult(testDataAfterDelete, NULL);
+
+    // update all and insert some
+    UA_StatusCode *result;
+    size_t resultSize = 0;
+    ck_assert_str_eq(UA_StatusCode_name(updateHistory(UA_PERFORMUPDATETYPE_UPDATE, testDataSorted, &result, &resultSize))
+                                        , UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    for (size_t i = 0; i < resultSize; ++i) {
+        ck_assert_str_eq(UA_StatusCode_name(result[i]), UA_StatusCode_name(testDataUpdateResult[i]));
+    }
+    UA_Array_delete(result, resultSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
+
+    UA_HistoryData data;
+    UA_HistoryData_init(&data);
+
+    testResult(testDataSorted, &data);
+
+    for (size_t i = 0; i < data.dataValuesSize; ++i) {
+        ck_assert_uint_eq(data.dataValues[i].hasValue, true);
+        ck_assert(data.dataValues[i].value.type == &UA_TYPES[UA_TYPES_INT64]);
+        ck_assert_uint_eq(*((UA_Int64*)data.dataValues[i].value.data), UA_PERFORMUPDATETYPE_UPDATE);
+    }
+
+    UA_HistoryData_clear(&data);
+    UA_HistoryDataBackend_Columnar_clear(&setting.historizingBackend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingColumnarRingBuffer)
+{
+    // keep only the latest 5 values
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = UA_HistoryDataBackend_Columnar(1, 5);
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode retval = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(retval), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // fill the data. The last values are strings and switch the value column
+    // from unboxed integers to variants.
+    UA_DateTime start = UA_DateTime_now();
+    for (UA_UInt32 i = 0; i < 10; ++i) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        value.hasValue = true;
+        if (i < 8) {
+            UA_Variant_setScalarCopy(&value.value, &i, &UA_TYPES[UA_TYPES_UINT32]);
+        } else {
+            UA_String str = UA_STRING("string");
+            UA_Variant_setScalarCopy(&value.value, &str, &UA_TYPES[UA_TYPES_STRING]);
+        }
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = start + (i * UA_DATETIME_SEC);
+        value.hasServerTimestamp = true;
+        value.serverTimestamp = value.sourceTimestamp;
+        retval = setting.historizingBackend.serverSetHistoryData(server,
+                                                                 setting.historizingBackend.context,
+                                                                 NULL,
+                                                                 NULL,
+                                                                 &outNodeId,
+                                                                 UA_FALSE,
+                                                                 &value);
+        ck_assert_str_eq(UA_StatusCode_name(retval), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+        UA_DataValue_clear(&value);
+    }
+
+    // a value older than the retained window is dropped
+    UA_DataValue old;
+    UA_DataValue_init(&old);
+    old.hasSourceTimestamp = true;
+    old.sourceTimestamp = start - UA_DATETIME_SEC;
+    retval = setting.historizingBackend.serverSetHistoryData(server,
+                                                             setting.historizingBackend.context,
+                                                             NULL, NULL, &outNodeId,
+                                                             UA_FALSE, &old);
+    ck_assert_str_eq(UA_StatusCode_name(retval), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // request
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestHistory(start - UA_DATETIME_SEC, start + (10 * UA_DATETIME_SEC), &response, 0, false, NULL);
+
+    // test the response
+    ck_assert_str_eq(UA_StatusCode_name(response.responseHeader.serviceResult), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    UA_HistoryData * data = (UA_HistoryData *)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 5);
+    for (size_t j = 0; j < data->dataValuesSize; ++j) {
+        ck_assert_uint_eq(data->dataValues[j].sourceTimestamp, start + ((j + 5) * UA_DATETIME_SEC));
+        ck_assert_uint_eq(data->dataValues[j].hasValue, true);
+        if (j + 5 < 8) {
+            ck_assert(data->dataValues[j].value.type == &UA_TYPES[UA_TYPES_UINT32]);
+            ck_assert_uint_eq(*(UA_UInt32 *)data->dataValues[j].value.data, j + 5);
+        } else {
+            ck_assert(data->dataValues[j].value.type == &UA_TYPES[UA_TYPES_STRING]);
+        }
+    }
+    UA_HistoryReadResponse_clear(&response);
+
+    // an index range on the scalar values fails and returns no values
+    UA_HistoryDataBackend *backend = &setting.historizingBackend;
+    size_t first = backend->firstIndex(server, backend->context, NULL, NULL, &outNodeId);
+    size_t last = backend->lastIndex(server, backend->context, NULL, NULL, &outNodeId);
+    UA_NumericRangeDimension dim = {1, 1};
+    UA_NumericRange range = {1, &dim};
+    UA_DataValue values[5];
+    for (size_t j = 0; j < 5; ++j)
+        UA_DataValue_init(&values[j]);
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    UA_ByteString outCp = UA_BYTESTRING_NULL;
+    size_t provided = 0;
+    retval = backend->copyDataValues(server, backend->context, NULL, NULL, &outNodeId,
+                                     first, last, false, 5, range, false,
+                                     &cp, &outCp, &provided, values);
+    ck_assert_str_eq(UA_StatusCode_name(retval),
+                     UA_StatusCode_name(UA_STATUSCODE_BADINDEXRANGENODATA));
+    for (size_t j = 0; j < 5; ++j)
+        ck_assert_uint_eq(values[j].hasValue, false);
+    UA_ByteString_clear(&outCp);
+    UA_HistoryDataBackend_Columnar_clear(&setting.historizingBackend);
+}
+END_TEST
+
+#ifdef UA_ENABLE_HISTORIZING_FILE
+
+static void
+swapBackend(UA_HistoryDataBackend backend) {
+    const UA_HistorizingNodeIdSettings* setting =
+        gathering->getHistorizingSetting(server, gathering->context, &outNodeId);
+    UA_HistorizingNodeIdSettings newSetting = *setting;
+    newSetting.historizingBackend = backend;
+    gathering->updateNodeIdSetting(server, gathering->context, &outNodeId, newSetting);
+}
+
+START_TEST(Server_HistorizingBackendFile)
+{
+    createHistoryDirectory();
+    const char *directory = historyDirectory;
+
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(directory, 0, 0, false);
+    ck_assert_ptr_ne(backend.context, NULL);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // empty backend should not crash
+    UA_UInt32 retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests expected failed.\n", retval);
+
+    // fill backend. The file backend only appends.
+    ck_assert_uint_eq(fillHistoricalDataBackend(backend, testDataSorted), true);
+
+    // values older than the latest value are rejected
+    UA_DataValue old;
+    UA_DataValue_init(&old);
+    old.hasSourceTimestamp = true;
+    old.sourceTimestamp = testDataSorted[0];
+    ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                       &outNodeId, UA_FALSE, &old);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_BADINVALIDTIMESTAMP));
+
+    // read all in one
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous one at one request
+    retval = testHistoricalDataBackend(1);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // read continuous two at one request
+    retval = testHistoricalDataBackend(2);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // the history survives a restart of the backend
+    serverMutexLock();
+    UA_HistoryDataBackend_File_clear(&backend);
+    backend = UA_HistoryDataBackend_File(directory, 0, 0, false);
+    ck_assert_ptr_ne(backend.context, NULL);
+    swapBackend(backend);
+    serverMutexUnlock();
+
+    retval = testHistoricalDataBackend(100);
+    fprintf(stderr, "%d tests failed.\n", retval);
+    ck_assert_uint_eq(retval, 0);
+
+    // HistoryUpdate is not supported
+    ck_assert_str_eq(UA_StatusCode_name(updateHistory(UA_PERFORMUPDATETYPE_INSERT, testData, NULL, NULL)),
+                     UA_StatusCode_name(UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED));
+
+    UA_HistoryDataBackend_File_clear(&backend);
+}
+END_TEST
+
+static void
+testFileRetention(UA_DateTime start) {
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestHistory(start, start + (100 * UA_DATETIME_SEC), &response, 0, false, NULL);
+
+    ck_assert_str_eq(UA_StatusCode_name(response.responseHeader.serviceResult), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    UA_HistoryData * data = (UA_HistoryData *)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 12);
+    for (size_t j = 0; j < data->dataValuesSize; ++j) {
+        ck_assert_uint_eq(data->dataValues[j].sourceTimestamp, start + ((j + 88) * UA_DATETIME_SEC));
+        ck_assert(data->dataValues[j].value.type == &UA_TYPES[UA_TYPES_INT64]);
+        ck_assert_uint_eq(*(UA_Int64 *)data->dataValues[j].value.data, j + 88);
+    }
+    UA_HistoryReadResponse_clear(&response);
+}
+
+START_TEST(Server_HistorizingFileRetention)
+{
+    createHistoryDirectory();
+    const char *directory = historyDirectory;
+
+    // every segment holds four values. At most three segments are kept.
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(directory, 320, 3, true);
+    ck_assert_ptr_ne(backend.context, NULL);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode retval = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(retval), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    UA_DateTime start = UA_DateTime_now();
+    for (UA_Int64 i = 0; i < 100; ++i) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        value.hasValue = true;
+        UA_Variant_setScalarCopy(&value.value, &i, &UA_TYPES[UA_TYPES_INT64]);
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = start + (i * UA_DATETIME_SEC);
+        value.hasServerTimestamp = true;
+        value.serverTimestamp = value.sourceTimestamp;
+        value.hasStatus = true;
+        value.status = UA_STATUSCODE_GOOD;
+        retval = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                              &outNodeId, UA_FALSE, &value);
+        ck_assert_str_eq(UA_StatusCode_name(retval), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+        UA_DataValue_clear(&value);
+    }
+    testFileRetention(start);
+
+    // the retained window is the same after a restart
+    serverMutexLock();
+    UA_HistoryDataBackend_File_clear(&backend);
+    backend = UA_HistoryDataBackend_File(directory, 320, 3, true);
+    ck_assert_ptr_ne(backend.context, NULL);
+    swapBackend(backend);
+    serverMutexUnlock();
+    testFileRetention(start);
+
+    // a damaged record fails the CRC check and is cut off after a restart.
+    // The node has the number 0. The newest of the 25 segments is 24.seg.
+    serverMutexLock();
+    UA_HistoryDataBackend_File_clear(&backend);
+    char path[128];
+    snprintf(path, sizeof(path), "%s/0/24.seg", directory);
+    int fd = open(path, O_RDWR);
+    ck_assert_int_ge(fd, 0);
+    UA_UInt64 end = 0;
+    ck_assert_int_eq(pread(fd, &end, sizeof(end), 16), (ssize_t)sizeof(end));
+    UA_Byte byte = 0;
+    ck_assert_int_eq(pread(fd, &byte, 1, (off_t)end - 8), 1);
+    byte ^= 0xFF;
+    ck_assert_int_eq(pwrite(fd, &byte, 1, (off_t)end - 8), 1);
+    close(fd);
+    backend = UA_HistoryDataBackend_File(directory, 320, 3, true);
+    ck_assert_ptr_ne(backend.context, NULL);
+    swapBackend(backend);
+    size_t last = backend.lastIndex(server, backend.context, NULL, NULL, &outNodeId);
+    const UA_DataValue *lastValue =
+        backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, last);
+    ck_assert_int_eq(lastValue->sourceTimestamp, start + (98 * UA_DATETIME_SEC));
+    serverMutexUnlock();
+
+    UA_HistoryDataBackend_File_clear(&backend);
+}
+END_TEST
+
+#endif /* UA_ENABLE_HISTORIZING_FILE */
+
+#define AGGREGATE_SAMPLES 10
+
+static UA_DateTime
+fillAggregateBackend(UA_HistoryDataBackend *backend, size_t maxResponseSize)
+{
+    *backend = UA_HistoryDataBackend_Memory(1, 100);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = *backend;
+    setting.maxHistoryDataResponseSize = maxResponseSize;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // value i * 10 at second i
+    UA_DateTime start = UA_DateTime_now();
+    for (UA_Int32 i = 0; i < AGGREGATE_SAMPLES; ++i) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        value.hasValue = true;
+        UA_Int32 v = i * 10;
+        UA_Variant_setScalarCopy(&value.value, &v, &UA_TYPES[UA_TYPES_INT32]);
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = start + (i * UA_DATETIME_SEC);
+        value.hasServerTimestamp = true;
+        value.serverTimestamp = value.sourceTimestamp;
+        ret = backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                            &outNodeId, UA_FALSE, &value);
+        ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+        UA_DataValue_clear(&value);
+    }
+    return start;
+}
+
+static void
+requestProcessed(UA_UInt32 aggregate, UA_DateTime start, UA_DateTime end,
+                 UA_Double processingInterval, UA_ByteString *continuationPoint,
+                 UA_HistoryReadResponse *response)
+{
+    UA_ReadProcessedDetails *details = UA_ReadProcessedDetails_new();
+    details->startTime = start;
+    details->endTime = end;
+    details->processingInterval = processingInterval;
+    details->aggregateConfiguration.useServerCapabilitiesDefaults = true;
+    details->aggregateTypeSize = 1;
+    details->aggregateType = UA_NodeId_new();
+    *details->aggregateType = UA_NODEID_NUMERIC(0, aggregate);
+
+    UA_HistoryReadValueId *valueId = UA_HistoryReadValueId_new();
+    UA_NodeId_copy(&outNodeId, &valueId->nodeId);
+    if (continuationPoint)
+        UA_ByteString_copy(continuationPoint, &valueId->continuationPoint);
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.historyReadDetails.encoding = UA_EXTENSIONOBJECT_DECODED;
+    request.historyReadDetails.content.decoded.type = &UA_TYPES[UA_TYPES_READPROCESSEDDETAILS];
+    request.historyReadDetails.content.decoded.data = details;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = valueId;
+
+    UA_LOCK(&server->serviceMutex);
+    Service_HistoryRead(server, &server->adminSession, &request, response);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_HistoryReadRequest_clear(&request);
+
+    ck_assert_str_eq(UA_StatusCode_name(response->responseHeader.serviceResult),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert_uint_eq(response->resultsSize, 1);
+}
+
+/* Two intervals of five seconds. Returns the values as double. */
+static void
+testAggregate(UA_UInt32 aggregate, UA_DateTime start, const UA_DataType *type,
+              UA_Double expected0, UA_Double expected1)
+{
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestProcessed(aggregate, start, start + (AGGREGATE_SAMPLES * UA_DATETIME_SEC),
+                     5000.0, NULL, &response);
+    ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    UA_HistoryData *data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 2);
+    UA_Double expected[2] = {expected0, expected1};
+    for (size_t i = 0; i < 2; ++i) {
+        UA_DataValue *dv = &data->dataValues[i];
+        ck_assert_uint_eq(dv->hasValue, true);
+        ck_assert(dv->value.type == type);
+        UA_Double d;
+        if (type == &UA_TYPES[UA_TYPES_INT32])
+            d = *(UA_Int32*)dv->value.data;
+        else if (type == &UA_TYPES[UA_TYPES_UINT32])
+            d = *(UA_UInt32*)dv->value.data;
+        else
+            d = *(UA_Double*)dv->value.data;
+        ck_assert(d > expected[i] - 0.001 && d < expected[i] + 0.001);
+        ck_assert_uint_eq(dv->hasSourceTimestamp, true);
+    }
+    ck_assert_uint_eq(response.results[0].continuationPoint.length, 0);
+    UA_HistoryReadResponse_clear(&response);
+}
+
+START_TEST(Server_HistorizingReadProcessed)
+{
+    UA_HistoryDataBackend backend;
+    UA_DateTime start = fillAggregateBackend(&backend, 100);
+
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, start, &UA_TYPES[UA_TYPES_DOUBLE], 20.0, 70.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_MINIMUM, start, &UA_TYPES[UA_TYPES_INT32], 0.0, 50.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, start, &UA_TYPES[UA_TYPES_INT32], 40.0, 90.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_RANGE, start, &UA_TYPES[UA_TYPES_DOUBLE], 40.0, 40.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_COUNT, start, &UA_TYPES[UA_TYPES_UINT32], 5.0, 5.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_START, start, &UA_TYPES[UA_TYPES_INT32], 0.0, 50.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_END, start, &UA_TYPES[UA_TYPES_INT32], 40.0, 90.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_DELTA, start, &UA_TYPES[UA_TYPES_DOUBLE], 40.0, 40.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE, start, &UA_TYPES[UA_TYPES_INT32], 0.0, 50.0);
+    // the second interval ends after the last sample. The value is
+    // extrapolated stepped for the last second.
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE, start, &UA_TYPES[UA_TYPES_DOUBLE], 25.0, 74.0);
+    testAggregate(UA_NS0ID_AGGREGATEFUNCTION_TOTAL, start, &UA_TYPES[UA_TYPES_DOUBLE], 125.0, 370.0);
+
+    // the timestamp of the minimum is the timestamp of the raw value
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestProcessed(UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, start,
+                     start + (AGGREGATE_SAMPLES * UA_DATETIME_SEC), 5000.0, NULL, &response);
+    UA_HistoryData *data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_int_eq(data->dataValues[0].sourceTimestamp, start + (4 * UA_DATETIME_SEC));
+    ck_assert_int_eq(data->dataValues[1].sourceTimestamp, start + (9 * UA_DATETIME_SEC));
+    UA_HistoryReadResponse_clear(&response);
+
+    // reverse order. The intervals start at the later time.
+    UA_HistoryReadResponse_init(&response);
+    requestProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, start + (AGGREGATE_SAMPLES * UA_DATETIME_SEC),
+                     start, 5000.0, NULL, &response);
+    data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 2);
+    ck_assert(*(UA_Double*)data->dataValues[0].value.data == 70.0);
+    ck_assert_int_eq(data->dataValues[0].sourceTimestamp, start + (10 * UA_DATETIME_SEC));
+    ck_assert(*(UA_Double*)data->dataValues[1].value.data == 20.0);
+    ck_assert_int_eq(data->dataValues[1].sourceTimestamp, start + (5 * UA_DATETIME_SEC));
+    UA_HistoryReadResponse_clear(&response);
+
+    // unknown aggregate
+    UA_HistoryReadResponse_init(&response);
+    requestProcessed(UA_NS0ID_AGGREGATEFUNCTION_STANDARDDEVIATIONSAMPLE, start,
+                     start + UA_DATETIME_SEC, 0.0, NULL, &response);
+    ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode),
+                     UA_StatusCode_name(UA_STATUSCODE_BADAGGREGATENOTSUPPORTED));
+    UA_HistoryReadResponse_clear(&response);
+
+    // a bad value makes the average of the interval uncertain
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    value.hasStatus = true;
+    value.status = UA_STATUSCODE_BADSENSORFAILURE;
+    value.hasSourceTimestamp = true;
+    value.sourceTimestamp = start + (UA_DATETIME_SEC / 2);
+    ck_assert_str_eq(UA_StatusCode_name(backend.serverSetHistoryData(server, backend.context,
+                                                                     NULL, NULL, &outNodeId,
+                                                                     UA_FALSE, &value)),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    UA_HistoryReadResponse_init(&response);
+    requestProcessed(UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, start,
+                     start + (AGGREGATE_SAMPLES * UA_DATETIME_SEC), 5000.0, NULL, &response);
+    data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 2);
+    ck_assert(*(UA_Double*)data->dataValues[0].value.data == 20.0);
+    ck_assert_uint_eq(data->dataValues[0].status & 0xC0000000, UA_STATUSCODE_UNCERTAIN);
+    ck_assert_uint_eq(data->dataValues[1].status & 0xC0000000, UA_STATUSCODE_GOOD);
+    UA_HistoryReadResponse_clear(&response);
+
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingReadProcessedContinuation)
+{
+    // one interval per response
+    UA_HistoryDataBackend backend;
+    UA_DateTime start = fillAggregateBackend(&backend, 1);
+
+    UA_ByteString continuationPoint = UA_BYTESTRING_NULL;
+    for (UA_Int32 i = 0; i < AGGREGATE_SAMPLES / 2; ++i) {
+        UA_HistoryReadResponse response;
+        UA_HistoryReadResponse_init(&response);
+        requestProcessed(UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, start,
+                         start + (AGGREGATE_SAMPLES * UA_DATETIME_SEC), 2000.0,
+                         &continuationPoint, &response);
+        UA_ByteString_clear(&continuationPoint);
+        ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode),
+                         UA_StatusCode_name(UA_STATUSCODE_GOOD));
+        UA_HistoryData *data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+        ck_assert_uint_eq(data->dataValuesSize, 1);
+        ck_assert_int_eq(*(UA_Int32*)data->dataValues[0].value.data, (i * 20) + 10);
+        if (i + 1 < AGGREGATE_SAMPLES / 2)
+            ck_assert_uint_gt(response.results[0].continuationPoint.length, 0);
+        else
+            ck_assert_uint_eq(response.results[0].continuationPoint.length, 0);
+        UA_ByteString_copy(&response.results[0].continuationPoint, &continuationPoint);
+        UA_HistoryReadResponse_clear(&response);
+    }
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+/* The number of intervals chosen by the client is capped per response */
+START_TEST(Server_HistorizingReadProcessedManyIntervals)
+{
+    UA_HistoryDataBackend backend;
+    UA_DateTime start = fillAggregateBackend(&backend, 0);
+
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestProcessed(UA_NS0ID_AGGREGATEFUNCTION_COUNT, start,
+                     start + (10 * 365 * 24 * 3600 * UA_DATETIME_SEC), 1.0,
+                     NULL, &response);
+    ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    UA_HistoryData *data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 10000);
+    ck_assert_uint_gt(response.results[0].continuationPoint.length, 0);
+    UA_HistoryReadResponse_clear(&response);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+static void
+requestAtTime(const UA_DateTime *reqTimes, size_t reqTimesSize,
+              UA_TimestampsToReturn timestampsToReturn, UA_HistoryReadResponse *response)
+{
+    UA_ReadAtTimeDetails *details = UA_ReadAtTimeDetails_new();
+    UA_StatusCode ret = UA_Array_copy(reqTimes, reqTimesSize, (void**)&details->reqTimes,
+                                      &UA_TYPES[UA_TYPES_DATETIME]);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    details->reqTimesSize = reqTimesSize;
+    details->useSimpleBounds = true;
+
+    UA_HistoryReadValueId *valueId = UA_HistoryReadValueId_new();
+    UA_NodeId_copy(&outNodeId, &valueId->nodeId);
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.historyReadDetails.encoding = UA_EXTENSIONOBJECT_DECODED;
+    request.historyReadDetails.content.decoded.type = &UA_TYPES[UA_TYPES_READATTIMEDETAILS];
+    request.historyReadDetails.content.decoded.data = details;
+    request.timestampsToReturn = timestampsToReturn;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = valueId;
+
+    UA_LOCK(&server->serviceMutex);
+    Service_HistoryRead(server, &server->adminSession, &request, response);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_HistoryReadRequest_clear(&request);
+
+    ck_assert_str_eq(UA_StatusCode_name(response->responseHeader.serviceResult),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert_uint_eq(response->resultsSize, 1);
+    ck_assert_str_eq(UA_StatusCode_name(response->results[0].statusCode),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+}
+
+/* More raw samples in one interval than are copied from the backend at once */
+START_TEST(Server_HistorizingReadProcessedChunks)
+{
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1000);
+    UA_HistorizingNodeIdSettings setting;
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    serverMutexLock();
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    serverMutexUnlock();
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    // value i every 100ms. Every tenth value is bad.
+    UA_DateTime start = UA_DateTime_now();
+    for (UA_Int32 i = 0; i < 1000; ++i) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        value.hasValue = true;
+        UA_Variant_setScalarCopy(&value.value, &i, &UA_TYPES[UA_TYPES_INT32]);
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = start + (i * 100 * UA_DATETIME_MSEC);
+        if (i % 10 == 5) {
+            value.hasStatus = true;
+            value.status = UA_STATUSCODE_BADSENSORFAILURE;
+        }
+        ret = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                           &outNodeId, UA_FALSE, &value);
+        ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+        UA_DataValue_clear(&value);
+    }
+
+    // one interval over all values
+    UA_UInt32 aggregates[4] = {UA_NS0ID_AGGREGATEFUNCTION_COUNT, UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM,
+                               UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE};
+    UA_Double expected[4] = {900.0, 999.0, 499.4444, 499.9995};
+    for (size_t i = 0; i < 4; ++i) {
+        UA_HistoryReadResponse response;
+        UA_HistoryReadResponse_init(&response);
+        requestProcessed(aggregates[i], start, start + (100 * UA_DATETIME_SEC), 0.0, NULL, &response);
+        ck_assert_str_eq(UA_StatusCode_name(response.results[0].statusCode),
+                         UA_StatusCode_name(UA_STATUSCODE_GOOD));
+        UA_HistoryData *data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+        ck_assert_uint_eq(data->dataValuesSize, 1);
+        UA_Double d;
+        if (data->dataValues[0].value.type == &UA_TYPES[UA_TYPES_UINT32])
+            d = *(UA_UInt32*)data->dataValues[0].value.data;
+        else if (data->dataValues[0].value.type == &UA_TYPES[UA_TYPES_INT32])
+            d = *(UA_Int32*)data->dataValues[0].value.data;
+        else
+            d = *(UA_Double*)data->dataValues[0].value.data;
+        ck_assert(d > expected[i] - 0.001 && d < expected[i] + 0.001);
+        UA_HistoryReadResponse_clear(&response);
+    }
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingReadAtTime)
+{
+    UA_HistoryDataBackend backend;
+    UA_DateTime start = fillAggregateBackend(&backend, 100);
+
+    UA_DateTime reqTimes[4] = {
+        start + (2 * UA_DATETIME_SEC),              // raw value
+        start + (2 * UA_DATETIME_SEC) + (UA_DATETIME_SEC / 2), // interpolated
+        start + (20 * UA_DATETIME_SEC),             // after the last value
+        start - UA_DATETIME_SEC                     // before the first value
+    };
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    requestAtTime(reqTimes, 4, UA_TIMESTAMPSTORETURN_SOURCE, &response);
+    UA_HistoryData *data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 4);
+    for (size_t i = 0; i < 4; ++i)
+        ck_assert_int_eq(data->dataValues[i].sourceTimestamp, reqTimes[i]);
+
+    ck_assert_int_eq(*(UA_Int32*)data->dataValues[0].value.data, 20);
+    ck_assert_uint_eq(data->dataValues[0].status, UA_STATUSCODE_GOOD);
+
+    ck_assert(data->dataValues[1].value.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)data->dataValues[1].value.data, 25);
+    ck_assert_uint_eq(data->dataValues[1].status & 0xC0000000, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(data->dataValues[1].status & UA_STATUSCODE_INFOTYPE_DATAVALUE,
+                      UA_STATUSCODE_INFOTYPE_DATAVALUE);
+
+    ck_assert_int_eq(*(UA_Int32*)data->dataValues[2].value.data, 90);
+    ck_assert_uint_eq(data->dataValues[2].status & 0xC0000000, UA_STATUSCODE_UNCERTAIN);
+
+    ck_assert_uint_eq(data->dataValues[3].hasValue, false);
+    ck_assert_str_eq(UA_StatusCode_name(data->dataValues[3].status),
+                     UA_StatusCode_name(UA_STATUSCODE_BADNODATA));
+    UA_HistoryReadResponse_clear(&response);
+
+    // only the server timestamp is returned
+    UA_HistoryReadResponse_init(&response);
+    requestAtTime(reqTimes, 4, UA_TIMESTAMPSTORETURN_SERVER, &response);
+    data = (UA_HistoryData*)response.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(data->dataValuesSize, 4);
+    for (size_t i = 0; i < 4; ++i) {
+        ck_assert_uint_eq(data->dataValues[i].hasSourceTimestamp, false);
+        ck_assert_uint_eq(data->dataValues[i].hasServerTimestamp, true);
+        ck_assert_int_eq(data->dataValues[i].serverTimestamp, reqTimes[i]);
+    }
+    UA_HistoryReadResponse_clear(&response);
+
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
 START_TEST(Server_HistorizingRandomIndexBackend)
+
 {
     UA_HistoryDataBackend backend = UA_HistoryDataBackend_randomindextest(testData);
     UA_HistorizingNodeIdSettings setting;
@@ -1025,11 +1885,24 @@ static Suite* testSuite_Client(void)
     tcase_add_test(tc_server, Server_HistorizingStrategyUser);
     tcase_add_test(tc_server, Server_HistorizingStrategyValueSet);
     tcase_add_test(tc_server, Server_HistorizingBackendMemory);
+    tcase_add_test(tc_server, Server_HistorizingRegisteredNode);
     tcase_add_test(tc_server, Server_HistorizingRandomIndexBackend);
     tcase_add_test(tc_server, Server_HistorizingUpdateDelete);
     tcase_add_test(tc_server, Server_HistorizingUpdateInsert);
     tcase_add_test(tc_server, Server_HistorizingUpdateReplace);
     tcase_add_test(tc_server, Server_HistorizingUpdateUpdate);
+    tcase_add_test(tc_server, Server_HistorizingBackendColumnar);
+    tcase_add_test(tc_server, Server_HistorizingColumnarUpdateUpdate);
+    tcase_add_test(tc_server, Server_HistorizingColumnarRingBuffer);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessed);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedContinuation);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedChunks);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedManyIntervals);
+    tcase_add_test(tc_server, Server_HistorizingReadAtTime);
+#ifdef UA_ENABLE_HISTORIZING_FILE
+    tcase_add_test(tc_server, Server_HistorizingBackendFile);
+    tcase_add_test(tc_server, Server_HistorizingFileRetention);
+#endif
 #endif /* UA_ENABLE_HISTORIZING */
     suite_add_tcase(s, tc_server);
 
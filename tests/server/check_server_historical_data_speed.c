@@ -0,0 +1,195 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure the insert rate and the ReadRaw latency of the columnar history
+ * backend with many historized nodes. The server does not open a TCP port. */
+
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+#include <open62541/plugin/historydata/history_data_gathering_default.h>
+#include <open62541/plugin/historydata/history_database_default.h>
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#define HISTNODES 10000 /* Number of historized nodes */
+#define READS 10000     /* Number of ReadRaw requests */
+#define READRANGE 10    /* Seconds covered by one ReadRaw request */
+
+static UA_Server *server;
+static UA_HistoryDataGathering gathering;
+static UA_HistoryDataBackend backend;
+static UA_NodeId histNodeIds[HISTNODES];
+static UA_DateTime start;
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setMinimal(config, 4840, NULL);
+    gathering = UA_HistoryDataGathering_Default(HISTNODES);
+    config->historyDatabase = UA_HistoryDatabase_default(gathering);
+    start = UA_DateTime_now();
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Double myDouble = 42.0;
+    UA_Variant_setScalar(&attr.value, &myDouble, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_HISTORYREAD;
+    attr.historizing = true;
+    UA_NodeId parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    UA_NodeId parentReferenceNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    for(size_t i = 0; i < HISTNODES; i++) {
+        char varName[20];
+        UA_snprintf(varName, 20, "Variable %u", (UA_UInt32)i);
+        UA_NodeId myNodeId = UA_NODEID_STRING(1, varName);
+        UA_QualifiedName myName = UA_QUALIFIEDNAME(1, varName);
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, myNodeId, parentNodeId,
+                                      parentReferenceNodeId, myName,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      attr, NULL, &histNodeIds[i]);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void teardown(void) {
+    for(size_t i = 0; i < HISTNODES; i++)
+        UA_NodeId_clear(&histNodeIds[i]);
+    UA_Server_delete(server);
+    if(backend.deleteMembers)
+        backend.deleteMembers(&backend);
+    memset(&backend, 0, sizeof(UA_HistoryDataBackend));
+}
+
+static void
+registerNodes(void) {
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    for(size_t i = 0; i < HISTNODES; i++) {
+        UA_StatusCode retval =
+            gathering.registerNodeId(server, gathering.context, &histNodeIds[i], setting);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void
+insertSpeed(size_t samplesPerNode) {
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    UA_Double d = 0.0;
+    UA_Variant_setScalar(&value.value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    value.hasValue = true;
+    value.hasStatus = true;
+    value.hasSourceTimestamp = true;
+    value.hasServerTimestamp = true;
+
+    clock_t begin = clock();
+    for(size_t s = 0; s < samplesPerNode; s++) {
+        value.sourceTimestamp = start + ((UA_DateTime)s * UA_DATETIME_SEC);
+        value.serverTimestamp = value.sourceTimestamp;
+        for(size_t i = 0; i < HISTNODES; i++) {
+            d = (UA_Double)(s + i);
+            UA_StatusCode retval =
+                backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                             &histNodeIds[i], true, &value);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+    }
+    clock_t finish = clock();
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    size_t inserts = samplesPerNode * HISTNODES;
+    printf("%u inserts over %u nodes took %f s (%f inserts/s)\n",
+           (unsigned)inserts, (unsigned)HISTNODES, time_spent,
+           time_spent > 0 ? (double)inserts / time_spent : 0.0);
+}
+
+static void
+readRawSpeed(size_t samplesPerNode) {
+    UA_ReadRawModifiedDetails details;
+    UA_ReadRawModifiedDetails_init(&details);
+    details.numValuesPerNode = 0;
+    details.returnBounds = false;
+
+    UA_HistoryReadValueId valueId;
+    UA_HistoryReadValueId_init(&valueId);
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    request.historyReadDetails.encoding = UA_EXTENSIONOBJECT_DECODED;
+    request.historyReadDetails.content.decoded.type = &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS];
+    request.historyReadDetails.content.decoded.data = &details;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = &valueId;
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < READS; i++) {
+        valueId.nodeId = histNodeIds[(i * 7919) % HISTNODES];
+        UA_DateTime offset = (UA_DateTime)(i % (samplesPerNode - READRANGE));
+        details.startTime = start + (offset * UA_DATETIME_SEC);
+        details.endTime = details.startTime + (READRANGE * UA_DATETIME_SEC);
+
+        UA_HistoryReadResponse response;
+        UA_HistoryReadResponse_init(&response);
+        UA_LOCK(&server->serviceMutex);
+        Service_HistoryRead(server, &server->adminSession, &request, &response);
+        UA_UNLOCK(&server->serviceMutex);
+
+        ck_assert_uint_eq(response.resultsSize, 1);
+        ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+        UA_HistoryData *data = (UA_HistoryData*)
+            response.results[0].historyData.content.decoded.data;
+        ck_assert_uint_eq(data->dataValuesSize, READRANGE);
+        UA_HistoryReadResponse_clear(&response);
+    }
+    clock_t finish = clock();
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%u ReadRaw requests over %u nodes took %f s (%f us per request)\n",
+           (unsigned)READS, (unsigned)HISTNODES, time_spent,
+           time_spent * 1000000.0 / READS);
+}
+
+START_TEST(historySpeedColumnar) {
+    backend = UA_HistoryDataBackend_Columnar(HISTNODES, 0);
+    registerNodes();
+    insertSpeed(100);
+    readRawSpeed(100);
+} END_TEST
+
+START_TEST(historySpeedColumnarRingBuffer) {
+    /* Every node keeps only the latest 50 samples */
+    backend = UA_HistoryDataBackend_Columnar(HISTNODES, 50);
+    registerNodes();
+    insertSpeed(100);
+    start += 50 * UA_DATETIME_SEC;
+    readRawSpeed(50);
+} END_TEST
+
+static Suite * testSuite_historySpeed(void) {
+    Suite *s = suite_create("Historical Data Speed");
+    TCase *tc_speed = tcase_create("Historical Data Speed");
+    tcase_add_checked_fixture(tc_speed, setup, teardown);
+    tcase_set_timeout(tc_speed, 600);
+    tcase_add_test(tc_speed, historySpeedColumnar);
+    tcase_add_test(tc_speed, historySpeedColumnarRingBuffer);
+    suite_add_tcase(s, tc_speed);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_historySpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,214 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/nodestore_default.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+
+static UA_Server *server;
+static size_t nodesBefore;
+
+static void
+countVisitor(void *context, const UA_Node *node) {
+    (*(size_t*)context)++;
+}
+
+static size_t
+countNodes(void) {
+    size_t count = 0;
+    UA_Nodestore *ns = &UA_Server_getConfig(server)->nodestore;
+    ns->iterate(ns->context, countVisitor, &count);
+    return count;
+}
+
+static void setup(void) {
+    server = UA_Server_new();
+    ck_assert(server != NULL);
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+    nodesBefore = countNodes();
+    UA_StatusCode res =
+        UA_Nodestore_HashMap_seal(&UA_Server_getConfig(server)->nodestore);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+START_TEST(Sealed_iterate) {
+    ck_assert_uint_eq(countNodes(), nodesBefore);
+
+    /* Sealing twice is not possible */
+    UA_StatusCode res =
+        UA_Nodestore_HashMap_seal(&UA_Server_getConfig(server)->nodestore);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADINVALIDSTATE);
+} END_TEST
+
+START_TEST(Sealed_read) {
+    UA_QualifiedName bn;
+    UA_StatusCode res =
+        UA_Server_readBrowseName(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER), &bn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_QualifiedName expected = UA_QUALIFIEDNAME(0, "Objects");
+    ck_assert(UA_QualifiedName_equal(&bn, &expected));
+    UA_QualifiedName_clear(&bn);
+
+    /* DataSource values */
+    UA_Variant value;
+    res = UA_Server_readValue(server,
+                              UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME),
+                              &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_DATETIME]));
+    UA_Variant_clear(&value);
+
+    /* Browse with reference subtypes */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert(br.referencesSize > 0);
+    UA_BrowseResult_clear(&br);
+} END_TEST
+
+START_TEST(Sealed_write) {
+    /* Writing to a sealed node stores the modified copy in the hash-map */
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERARRAY);
+    UA_String uri = UA_STRING("urn:sealed");
+    UA_Variant value;
+    UA_Variant_setArray(&value, &uri, 1, &UA_TYPES[UA_TYPES_STRING]);
+    UA_StatusCode res = UA_Server_writeValue(server, nodeId, value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Variant out;
+    res = UA_Server_readValue(server, nodeId, &out);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(out.arrayLength, 1);
+    ck_assert(UA_String_equal((UA_String*)out.data, &uri));
+    UA_Variant_clear(&out);
+
+    /* Shadowed nodes are visited only once */
+    ck_assert_uint_eq(countNodes(), nodesBefore);
+} END_TEST
+
+START_TEST(Sealed_addDelete) {
+    /* Nodes with the NodeId of a sealed node cannot be added */
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Server"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADNODEIDEXISTS);
+
+    /* Adding a node edits the references of the sealed parent */
+    UA_NodeId newId;
+    res = UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Object"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oattr, NULL, &newId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(countNodes(), nodesBefore + 1);
+
+    UA_QualifiedName objectName = UA_QUALIFIEDNAME(1, "Object");
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server,
+                                             UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                             1, &objectName);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+    ck_assert(UA_NodeId_equal(&bpr.targets[0].targetId.nodeId, &newId));
+    UA_BrowsePathResult_clear(&bpr);
+
+    /* Delete the new node and a sealed node */
+    res = UA_Server_deleteNode(server, newId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_NodeId_clear(&newId);
+    res = UA_Server_deleteNode(server, UA_NODEID_NUMERIC(0, UA_NS0ID_VIEWSFOLDER), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(countNodes(), nodesBefore - 1);
+
+    UA_QualifiedName bn;
+    res = UA_Server_readBrowseName(server, UA_NODEID_NUMERIC(0, UA_NS0ID_VIEWSFOLDER), &bn);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    /* The NodeId can be used again */
+    res = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(0, UA_NS0ID_VIEWSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Views"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(countNodes(), nodesBefore);
+} END_TEST
+
+START_TEST(Sealed_addReferenceType) {
+    UA_ReferenceTypeAttributes attr = UA_ReferenceTypeAttributes_default;
+    attr.inverseName = UA_LOCALIZEDTEXT("", "IsSealedBy");
+    UA_NodeId refTypeId = UA_NODEID_NUMERIC(1, 9000);
+    UA_StatusCode res =
+        UA_Server_addReferenceTypeNode(server, refTypeId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                       UA_QUALIFIEDNAME(1, "Seals"), attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_addReference(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                 refTypeId,
+                                 UA_EXPANDEDNODEID_NUMERIC(0, UA_NS0ID_SERVER), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The new ReferenceType is a subtype of the sealed hierarchical types */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.resultMask = UA_BROWSERESULTMASK_REFERENCETYPEID;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    UA_Boolean found = false;
+    for(size_t i = 0; i < br.referencesSize; i++) {
+        if(UA_NodeId_equal(&br.references[i].referenceTypeId, &refTypeId))
+            found = true;
+    }
+    ck_assert(found);
+    UA_BrowseResult_clear(&br);
+} END_TEST
+
+static Suite *testSuite_sealed(void) {
+    Suite *s = suite_create("Sealed Nodestore");
+    TCase *tc_sealed = tcase_create("Sealed");
+    tcase_add_checked_fixture(tc_sealed, setup, teardown);
+    tcase_add_test(tc_sealed, Sealed_iterate);
+    tcase_add_test(tc_sealed, Sealed_read);
+    tcase_add_test(tc_sealed, Sealed_write);
+    tcase_add_test(tc_sealed, Sealed_addDelete);
+    tcase_add_test(tc_sealed, Sealed_addReferenceType);
+    suite_add_tcase(s, tc_sealed);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_sealed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,233 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/plugin/nodestore_default.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <time.h>
+
+#define SNAPSHOT_NS "http://open62541.org/snapshot/"
+
+static UA_Server *server;
+static UA_UInt16 nsIndex;
+static UA_ByteString snapshot;
+
+static void setup(void) {
+    server = UA_Server_new();
+    ck_assert(server != NULL);
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+    nsIndex = UA_Server_addNamespace(server, SNAPSHOT_NS);
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "the answer");
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_STRING(nsIndex, "the.answer"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(nsIndex, "the answer"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_encodeNodestoreSnapshot(server, &snapshot);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(snapshot.length > 0);
+}
+
+static void teardown(void) {
+    UA_ByteString_clear(&snapshot);
+    UA_Server_delete(server);
+}
+
+static UA_Server *
+newServerFromSnapshot(const UA_ByteString *snap) {
+    UA_ServerConfig config;
+    memset(&config, 0, sizeof(UA_ServerConfig));
+    config.logger = UA_Log_Stdout_;
+    if(UA_Nodestore_HashMap(&config.nodestore) != UA_STATUSCODE_GOOD)
+        return NULL;
+    UA_Server *s = UA_Server_newWithNodestoreSnapshot(&config, snap);
+    if(s)
+        UA_ServerConfig_setDefault(UA_Server_getConfig(s));
+    return s;
+}
+
+static size_t
+countReferences(UA_Server *s, UA_UInt32 nodeId, UA_UInt32 refTypeId) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(0, nodeId);
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, refTypeId);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_BOTH;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_BrowseResult br = UA_Server_browse(s, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    size_t count = br.referencesSize;
+    UA_BrowseResult_clear(&br);
+    return count;
+}
+
+START_TEST(Snapshot_load) {
+    UA_Server *loaded = newServerFromSnapshot(&snapshot);
+    ck_assert(loaded != NULL);
+
+    /* The namespace array is restored */
+    size_t foundIndex = 0;
+    UA_StatusCode res =
+        UA_Server_getNamespaceByName(loaded, UA_STRING(SNAPSHOT_NS), &foundIndex);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(foundIndex, nsIndex);
+
+    /* Values stored in the node are restored */
+    UA_Variant value;
+    res = UA_Server_readValue(loaded, UA_NODEID_STRING(nsIndex, "the.answer"), &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_INT32]));
+    ck_assert_int_eq(*(UA_Int32*)value.data, 42);
+    UA_Variant_clear(&value);
+
+    /* The DataSources of ns0 are attached again */
+    res = UA_Server_readValue(loaded,
+                              UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME),
+                              &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_DATETIME]));
+    UA_Variant_clear(&value);
+
+    /* Browsing with reference subtypes returns the same references */
+    ck_assert_uint_eq(countReferences(loaded, UA_NS0ID_OBJECTSFOLDER,
+                                      UA_NS0ID_HIERARCHICALREFERENCES),
+                      countReferences(server, UA_NS0ID_OBJECTSFOLDER,
+                                      UA_NS0ID_HIERARCHICALREFERENCES));
+    ck_assert_uint_eq(countReferences(loaded, UA_NS0ID_SERVER,
+                                      UA_NS0ID_REFERENCES),
+                      countReferences(server, UA_NS0ID_SERVER,
+                                      UA_NS0ID_REFERENCES));
+
+    /* Nodes can be added to the loaded server */
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    res = UA_Server_addObjectNode(loaded, UA_NODEID_STRING(nsIndex, "object"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(nsIndex, "object"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Server_delete(loaded);
+} END_TEST
+
+START_TEST(Snapshot_reencode) {
+    UA_Server *loaded = newServerFromSnapshot(&snapshot);
+    ck_assert(loaded != NULL);
+    UA_ByteString snapshot2;
+    UA_StatusCode res = UA_Server_encodeNodestoreSnapshot(loaded, &snapshot2);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(snapshot2.length, snapshot.length);
+    UA_ByteString_clear(&snapshot2);
+    UA_Server_delete(loaded);
+} END_TEST
+
+START_TEST(Snapshot_invalid) {
+    /* Wrong magic number */
+    UA_ByteString invalid = UA_BYTESTRING("not a snapshot");
+    UA_Server *loaded = newServerFromSnapshot(&invalid);
+    ck_assert(loaded == NULL);
+
+    /* Truncated */
+    UA_ByteString truncated = snapshot;
+    truncated.length = snapshot.length / 2;
+    loaded = newServerFromSnapshot(&truncated);
+    ck_assert(loaded == NULL);
+} END_TEST
+
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+START_TEST(Snapshot_optionalNodeRemoved) {
+    /* Optional nodes of ns0 that are missing in the snapshot are skipped */
+    UA_StatusCode res = UA_Server_deleteNode(server,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERCAPABILITIES_MAXQUERYCONTINUATIONPOINTS),
+        true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString snapshot2;
+    res = UA_Server_encodeNodestoreSnapshot(server, &snapshot2);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server *loaded = newServerFromSnapshot(&snapshot2);
+    ck_assert(loaded != NULL);
+    UA_Server_delete(loaded);
+    UA_ByteString_clear(&snapshot2);
+
+    /* Other errors during the initialization are not tolerated */
+    res = UA_Server_deleteNode(server,
+        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    res = UA_Server_addObjectNode(server,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(0, "CurrentTime"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_encodeNodestoreSnapshot(server, &snapshot2);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    loaded = newServerFromSnapshot(&snapshot2);
+    ck_assert(loaded == NULL);
+    UA_ByteString_clear(&snapshot2);
+} END_TEST
+#endif
+
+START_TEST(Snapshot_startupTime) {
+    const int runs = 10;
+    clock_t begin = clock();
+    for(int i = 0; i < runs; i++) {
+        UA_Server *s = UA_Server_new();
+        ck_assert(s != NULL);
+        UA_Server_delete(s);
+    }
+    double generated = (double)(clock() - begin) / CLOCKS_PER_SEC / runs;
+
+    begin = clock();
+    for(int i = 0; i < runs; i++) {
+        UA_Server *s = newServerFromSnapshot(&snapshot);
+        ck_assert(s != NULL);
+        UA_Server_delete(s);
+    }
+    double loaded = (double)(clock() - begin) / CLOCKS_PER_SEC / runs;
+
+    printf("Server startup (%lu bytes snapshot): generated ns0 %f s, "
+           "from snapshot %f s\n", (unsigned long)snapshot.length,
+           generated, loaded);
+} END_TEST
+
+static Suite *testSuite_snapshot(void) {
+    Suite *s = suite_create("Nodestore Snapshot");
+    TCase *tc_snapshot = tcase_create("Snapshot");
+    tcase_add_checked_fixture(tc_snapshot, setup, teardown);
+    tcase_add_test(tc_snapshot, Snapshot_load);
+    tcase_add_test(tc_snapshot, Snapshot_reencode);
+    tcase_add_test(tc_snapshot, Snapshot_invalid);
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+    tcase_add_test(tc_snapshot, Snapshot_optionalNodeRemoved);
+#endif
+    tcase_add_test(tc_snapshot, Snapshot_startupTime);
+    suite_add_tcase(s, tc_snapshot);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_snapshot();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -72,12 +72,171 @@ START_TEST(addVariable) {
 }
 END_TEST
 
+#define CHILDREN 10000
+#define BROWSES 100
+
+START_TEST(browseLargeFolder) {
+    /* Add many children to a folder */
+    UA_NodeId folderId;
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Folder"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oattr, NULL, &folderId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    for(int i = 0; i < CHILDREN; i++) {
+        char name[20];
+        UA_snprintf(name, 20, "Variable %i", i);
+        retval = UA_Server_addVariableNode(server, UA_NODEID_NULL, folderId,
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                           UA_QUALIFIEDNAME(1, name),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = folderId;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.resultMask = UA_BROWSERESULTMASK_BROWSENAME;
+
+    clock_t begin = clock();
+    for(int i = 0; i < BROWSES; i++) {
+        UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+        ck_assert_int_eq(br.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(br.referencesSize, CHILDREN);
+        UA_BrowseResult_clear(&br);
+    }
+    double time_spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    printf("%i browse of %i children:\t Duration was %f s\n",
+           BROWSES, CHILDREN, time_spent);
+
+    /* Lookup of single children by their BrowseName */
+    begin = clock();
+    for(int i = 0; i < CHILDREN; i++) {
+        char name[20];
+        UA_snprintf(name, 20, "Variable %i", i);
+        UA_QualifiedName qn = UA_QUALIFIEDNAME(1, name);
+        UA_BrowsePathResult bpr =
+            UA_Server_browseSimplifiedBrowsePath(server, folderId, 1, &qn);
+        ck_assert_int_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(bpr.targetsSize, 1);
+        UA_BrowsePathResult_clear(&bpr);
+    }
+    time_spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    printf("%i browse paths:\t Duration was %f s\n", CHILDREN, time_spent);
+}
+END_TEST
+
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+
+#define INSTANCES 1000
+#define TYPECHILDREN 10
+
+static UA_NodeId
+addDeviceType(void) {
+    UA_NodeId deviceTypeId;
+    UA_ObjectTypeAttributes otAttr = UA_ObjectTypeAttributes_default;
+    UA_StatusCode retval =
+        UA_Server_addObjectTypeNode(server, UA_NODEID_NULL,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(1, "DeviceType"), otAttr,
+                                    NULL, &deviceTypeId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Mandatory variables */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 42;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    for(int i = 0; i < TYPECHILDREN; i++) {
+        char name[20];
+        UA_snprintf(name, 20, "Variable %i", i);
+        UA_NodeId childId;
+        retval = UA_Server_addVariableNode(server, UA_NODEID_NULL, deviceTypeId,
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                           UA_QUALIFIEDNAME(1, name),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &childId);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        retval = UA_Server_addReference(server, childId,
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_HASMODELLINGRULE),
+                                        UA_EXPANDEDNODEID_NUMERIC(0, UA_NS0ID_MODELLINGRULE_MANDATORY),
+                                        true);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    return deviceTypeId;
+}
+
+START_TEST(addObjects) {
+    UA_NodeId deviceTypeId = addDeviceType();
+    UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+    UA_QualifiedName name = UA_QUALIFIEDNAME(1, "Device");
+    UA_NodeId parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    UA_NodeId parentReferenceNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+
+    clock_t begin = clock();
+    for(int i = 0; i < INSTANCES; i++) {
+        UA_StatusCode retval =
+            UA_Server_addObjectNode(server, UA_NODEID_NULL, parentNodeId,
+                                    parentReferenceNodeId, name, deviceTypeId,
+                                    attr, NULL, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    double time_spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    printf("%i instances:\t Duration was %f s (%.0f instances/s)\n",
+           INSTANCES, time_spent, INSTANCES / time_spent);
+}
+END_TEST
+
+START_TEST(addObjectsBulk) {
+    UA_NodeId deviceTypeId = addDeviceType();
+    UA_AddObjectNodesItem *items = (UA_AddObjectNodesItem*)
+        UA_calloc(INSTANCES, sizeof(UA_AddObjectNodesItem));
+    UA_StatusCode *results = (UA_StatusCode*)
+        UA_calloc(INSTANCES, sizeof(UA_StatusCode));
+    for(int i = 0; i < INSTANCES; i++) {
+        items[i].parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        items[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+        items[i].browseName = UA_QUALIFIEDNAME(1, "Device");
+        items[i].attr = UA_ObjectAttributes_default;
+    }
+
+    clock_t begin = clock();
+    UA_StatusCode retval =
+        UA_Server_addObjectNodes(server, deviceTypeId, INSTANCES, items, results, NULL);
+    double time_spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    for(int i = 0; i < INSTANCES; i++)
+        ck_assert_int_eq(results[i], UA_STATUSCODE_GOOD);
+    printf("%i instances in bulk:\t Duration was %f s (%.0f instances/s)\n",
+           INSTANCES, time_spent, INSTANCES / time_spent);
+
+    UA_free(items);
+    UA_free(results);
+}
+END_TEST
+
+#endif
+
 static Suite * service_speed_suite (void) {
     Suite *s = suite_create ("Service Speed");
 
     TCase* tc_addnodes = tcase_create ("AddNodes");
     tcase_add_checked_fixture(tc_addnodes, setup, teardown);
     tcase_add_test(tc_addnodes, addVariable);
+    tcase_add_test(tc_addnodes, browseLargeFolder);
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+    tcase_add_test(tc_addnodes, addObjects);
+    tcase_add_test(tc_addnodes, addObjectsBulk);
+#endif
     suite_add_tcase(s, tc_addnodes);
 
     return s;
@@ -0,0 +1,313 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measure the throughput of DataChange notifications from the sampling of
+ * MonitoredItems to the sent PublishResponse. The server does not open a TCP
+ * port. The PublishResponses are sent over a dummy connection.
+ *
+ * Also measure the creation, modification and deletion of many MonitoredItems
+ * in a single Subscription. This depends on the lookup by identifier. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "server/ua_subscription.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "testing_networklayers.h"
+#include "testing_policy.h"
+
+#define ITEMS 1000  /* MonitoredItems in the subscription */
+#define ROUNDS 1000 /* Sampling and publish cycles */
+#define MANYITEMS 100000 /* MonitoredItems for the create/modify/delete test */
+
+static UA_SecureChannel testChannel;
+static UA_SecurityPolicy dummyPolicy;
+static UA_Connection testingConnection;
+static funcs_called funcsCalled;
+static key_sizes keySizes;
+static UA_Server *server;
+static UA_Session *session;
+static UA_Subscription *sub;
+static UA_NodeId variableNodeId;
+
+static void setup(void) {
+    server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    TestingPolicy(&dummyPolicy, UA_BYTESTRING_NULL, &funcsCalled, &keySizes);
+    UA_SecureChannel_init(&testChannel, &UA_ConnectionConfig_default);
+    UA_SecureChannel_setSecurityPolicy(&testChannel, &dummyPolicy, &UA_BYTESTRING_NULL);
+    testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+
+    testingConnection = createDummyConnection(65535, NULL);
+    UA_Connection_attachSecureChannel(&testingConnection, &testChannel);
+    testChannel.connection = &testingConnection;
+
+    /* Add the monitored variable */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 myInteger = 0;
+    UA_Variant_setScalar(&attr.value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+    variableNodeId = UA_NODEID_STRING(1, "the.answer");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, variableNodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "the answer"),
+                                  UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Create the session on the test channel */
+    UA_CreateSessionRequest sessionRequest;
+    UA_CreateSessionRequest_init(&sessionRequest);
+    sessionRequest.requestedSessionTimeout = UA_UINT32_MAX;
+    UA_LOCK(&server->serviceMutex);
+    retval = UA_Server_createSession(server, &testChannel, &sessionRequest, &session);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Create the subscription */
+    UA_CreateSubscriptionRequest subRequest;
+    UA_CreateSubscriptionRequest_init(&subRequest);
+    subRequest.publishingEnabled = true;
+    UA_CreateSubscriptionResponse subResponse;
+    UA_CreateSubscriptionResponse_init(&subResponse);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateSubscription(server, session, &subRequest, &subResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(subResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    sub = UA_Session_getSubscriptionById(session, subResponse.subscriptionId);
+    ck_assert_ptr_ne(sub, NULL);
+
+    /* Create the MonitoredItems. The sampling interval is long. The samples
+     * are taken manually. */
+    UA_MonitoredItemCreateRequest items[ITEMS];
+    for(size_t i = 0; i < ITEMS; i++) {
+        UA_MonitoredItemCreateRequest_init(&items[i]);
+        items[i].itemToMonitor.nodeId = variableNodeId;
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_REPORTING;
+        items[i].requestedParameters.clientHandle = (UA_UInt32)i;
+        items[i].requestedParameters.samplingInterval = 1000000.0;
+        items[i].requestedParameters.queueSize = 1;
+        items[i].requestedParameters.discardOldest = true;
+    }
+    UA_CreateMonitoredItemsRequest monRequest;
+    UA_CreateMonitoredItemsRequest_init(&monRequest);
+    monRequest.subscriptionId = subResponse.subscriptionId;
+    monRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    monRequest.itemsToCreate = items;
+    monRequest.itemsToCreateSize = ITEMS;
+    UA_CreateMonitoredItemsResponse monResponse;
+    UA_CreateMonitoredItemsResponse_init(&monResponse);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateMonitoredItems(server, session, &monRequest, &monResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(monResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(monResponse.resultsSize, ITEMS);
+    UA_CreateMonitoredItemsResponse_clear(&monResponse);
+    UA_CreateSubscriptionResponse_clear(&subResponse);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+    UA_SecureChannel_close(&testChannel);
+    dummyPolicy.clear(&dummyPolicy);
+    testingConnection.close(&testingConnection);
+}
+
+/* Queue a PublishRequest and publish all ready notifications. Acknowledge the
+ * sent NotificationMessage right away. */
+static void
+publish(void) {
+    UA_PublishResponseEntry *pre = (UA_PublishResponseEntry*)
+        UA_malloc(sizeof(UA_PublishResponseEntry));
+    ck_assert_ptr_ne(pre, NULL);
+    pre->requestId = 1;
+    UA_PublishResponse_init(&pre->response);
+
+    UA_LOCK(&server->serviceMutex);
+    UA_Session_queuePublishReq(session, pre, false);
+    UA_UInt32 sequenceNumber = sub->nextSequenceNumber;
+    sub->readyNotifications = sub->notificationQueueSize;
+    UA_Subscription_publish(server, sub);
+    UA_Subscription_removeRetransmissionMessage(sub, sequenceNumber);
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+START_TEST(subscriptionThroughput) {
+    /* Send out the initial samples */
+    publish();
+    ck_assert_uint_eq(sub->notificationQueueSize, 0);
+
+    UA_Variant value;
+    UA_Int32 myInteger = 0;
+    UA_Variant_setScalar(&value, &myInteger, &UA_TYPES[UA_TYPES_INT32]);
+
+    clock_t begin = clock();
+    for(size_t r = 0; r < ROUNDS; r++) {
+        myInteger = (UA_Int32)r + 1;
+        UA_StatusCode retval = UA_Server_writeValue(server, variableNodeId, value);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_MonitoredItem *mon;
+        LIST_FOREACH(mon, &sub->monitoredItems, listEntry)
+            UA_MonitoredItem_sampleCallback(server, mon);
+        ck_assert_uint_eq(sub->notificationQueueSize, ITEMS);
+
+        publish();
+        ck_assert_uint_eq(sub->notificationQueueSize, 0);
+    }
+    clock_t finish = clock();
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    size_t notifications = (size_t)ITEMS * ROUNDS;
+    printf("%u notifications in %u publish cycles took %f s (%f notifications/s)\n",
+           (unsigned)notifications, (unsigned)ROUNDS, time_spent,
+           time_spent > 0 ? (double)notifications / time_spent : 0.0);
+} END_TEST
+
+static void
+printTime(const char *operation, clock_t begin, clock_t finish) {
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("%s %u MonitoredItems took %f s (%f us per item)\n", operation,
+           (unsigned)MANYITEMS, time_spent, time_spent * 1000000.0 / MANYITEMS);
+}
+
+START_TEST(monitoredItemsCreateModifyDelete) {
+    UA_UInt32 *ids = (UA_UInt32*)UA_malloc(MANYITEMS * sizeof(UA_UInt32));
+    ck_assert_ptr_ne(ids, NULL);
+
+    /* Create */
+    UA_MonitoredItemCreateRequest *items = (UA_MonitoredItemCreateRequest*)
+        UA_malloc(MANYITEMS * sizeof(UA_MonitoredItemCreateRequest));
+    ck_assert_ptr_ne(items, NULL);
+    for(size_t i = 0; i < MANYITEMS; i++) {
+        UA_MonitoredItemCreateRequest_init(&items[i]);
+        items[i].itemToMonitor.nodeId = variableNodeId;
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_DISABLED;
+        items[i].requestedParameters.clientHandle = (UA_UInt32)i;
+        items[i].requestedParameters.samplingInterval = 1000000.0;
+        items[i].requestedParameters.queueSize = 1;
+        items[i].requestedParameters.discardOldest = true;
+    }
+    UA_CreateMonitoredItemsRequest createRequest;
+    UA_CreateMonitoredItemsRequest_init(&createRequest);
+    createRequest.subscriptionId = sub->subscriptionId;
+    createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    createRequest.itemsToCreate = items;
+    createRequest.itemsToCreateSize = MANYITEMS;
+    UA_CreateMonitoredItemsResponse createResponse;
+    UA_CreateMonitoredItemsResponse_init(&createResponse);
+
+    clock_t begin = clock();
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateMonitoredItems(server, session, &createRequest, &createResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    printTime("create", begin, clock());
+
+    ck_assert_uint_eq(createResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(createResponse.resultsSize, MANYITEMS);
+    for(size_t i = 0; i < MANYITEMS; i++) {
+        ck_assert_uint_eq(createResponse.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ids[i] = createResponse.results[i].monitoredItemId;
+    }
+    UA_CreateMonitoredItemsResponse_clear(&createResponse);
+    UA_free(items);
+    ck_assert_uint_eq(sub->monitoredItemsSize, ITEMS + MANYITEMS);
+
+    /* Modify in reverse order of creation */
+    UA_MonitoredItemModifyRequest *mods = (UA_MonitoredItemModifyRequest*)
+        UA_malloc(MANYITEMS * sizeof(UA_MonitoredItemModifyRequest));
+    ck_assert_ptr_ne(mods, NULL);
+    for(size_t i = 0; i < MANYITEMS; i++) {
+        UA_MonitoredItemModifyRequest_init(&mods[i]);
+        mods[i].monitoredItemId = ids[MANYITEMS - 1 - i];
+        mods[i].requestedParameters.clientHandle = (UA_UInt32)i;
+        mods[i].requestedParameters.samplingInterval = 500000.0;
+        mods[i].requestedParameters.queueSize = 2;
+        mods[i].requestedParameters.discardOldest = true;
+    }
+    UA_ModifyMonitoredItemsRequest modifyRequest;
+    UA_ModifyMonitoredItemsRequest_init(&modifyRequest);
+    modifyRequest.subscriptionId = sub->subscriptionId;
+    modifyRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    modifyRequest.itemsToModify = mods;
+    modifyRequest.itemsToModifySize = MANYITEMS;
+    UA_ModifyMonitoredItemsResponse modifyResponse;
+    UA_ModifyMonitoredItemsResponse_init(&modifyResponse);
+
+    begin = clock();
+    UA_LOCK(&server->serviceMutex);
+    Service_ModifyMonitoredItems(server, session, &modifyRequest, &modifyResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    printTime("modify", begin, clock());
+
+    ck_assert_uint_eq(modifyResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(modifyResponse.resultsSize, MANYITEMS);
+    for(size_t i = 0; i < MANYITEMS; i++)
+        ck_assert_uint_eq(modifyResponse.results[i].statusCode, UA_STATUSCODE_GOOD);
+    UA_ModifyMonitoredItemsResponse_clear(&modifyResponse);
+    UA_free(mods);
+
+    UA_MonitoredItem *mon = UA_Subscription_getMonitoredItem(sub, ids[0]);
+    ck_assert_ptr_ne(mon, NULL);
+    ck_assert_uint_eq(mon->parameters.clientHandle, MANYITEMS - 1);
+    ck_assert_uint_eq(mon->parameters.queueSize, 2);
+
+    /* Delete */
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = sub->subscriptionId;
+    deleteRequest.monitoredItemIds = ids;
+    deleteRequest.monitoredItemIdsSize = MANYITEMS;
+    UA_DeleteMonitoredItemsResponse deleteResponse;
+    UA_DeleteMonitoredItemsResponse_init(&deleteResponse);
+
+    begin = clock();
+    UA_LOCK(&server->serviceMutex);
+    Service_DeleteMonitoredItems(server, session, &deleteRequest, &deleteResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    printTime("delete", begin, clock());
+
+    ck_assert_uint_eq(deleteResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(deleteResponse.resultsSize, MANYITEMS);
+    for(size_t i = 0; i < MANYITEMS; i++)
+        ck_assert_uint_eq(deleteResponse.results[i], UA_STATUSCODE_GOOD);
+    UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
+    ck_assert_uint_eq(sub->monitoredItemsSize, ITEMS);
+    ck_assert_ptr_eq(UA_Subscription_getMonitoredItem(sub, ids[0]), NULL);
+    ck_assert_ptr_ne(UA_Subscription_getMonitoredItem(sub, 1), NULL);
+    UA_free(ids);
+} END_TEST
+
+static Suite * testSuite_subscriptionSpeed(void) {
+    Suite *s = suite_create("Subscription Speed");
+    TCase *tc_speed = tcase_create("DataChange Throughput");
+    tcase_add_checked_fixture(tc_speed, setup, teardown);
+    tcase_set_timeout(tc_speed, 600);
+    tcase_add_test(tc_speed, subscriptionThroughput);
+    suite_add_tcase(s, tc_speed);
+
+    TCase *tc_items = tcase_create("MonitoredItem Create/Modify/Delete");
+    tcase_add_checked_fixture(tc_items, setup, teardown);
+    tcase_set_timeout(tc_items, 600);
+    tcase_add_test(tc_items, monitoredItemsCreateModifyDelete);
+    suite_add_tcase(s, tc_items);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_subscriptionSpeed();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -242,6 +242,123 @@ START_TEST(ReadSingleAttributeValueRangeWithoutTimestamp) {
     UA_DataValue_clear(&resp);
 } END_TEST
 
+START_TEST(ReadValueNoCopy) {
+    UA_ReadValueId rvi[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    rvi[0].nodeId = UA_NODEID_STRING(1, "the.answer");
+    rvi[1].nodeId = UA_NODEID_STRING(1, "myarray");
+    rvi[1].indexRange = UA_STRING("1:2,0:1");
+    rvi[2].nodeId = UA_NODEID_STRING(1, "unknown");
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 3;
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+
+    const UA_Node **pinnedNodes;
+    size_t pinnedNodesSize;
+    UA_LOCK(&server->serviceMutex);
+    Service_ReadNoCopy(server, &server->adminSession, &request, &response,
+                       &pinnedNodes, &pinnedNodesSize);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 3);
+
+    /* The value points into the pinned node */
+    ck_assert_uint_eq(pinnedNodesSize, 1);
+    ck_assert(response.results[0].hasValue);
+    ck_assert_int_eq(response.results[0].value.storageType, UA_VARIANT_DATA_NODELETE);
+    ck_assert_ptr_eq(response.results[0].value.data,
+                     pinnedNodes[0]->variableNode.value.data.value.value.data);
+
+    /* The range is copied */
+    ck_assert_uint_eq(response.results[1].value.arrayLength, 4);
+    ck_assert_int_eq(response.results[1].value.storageType, UA_VARIANT_DATA);
+    ck_assert_uint_eq(response.results[2].status, UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    UA_LOCK(&server->serviceMutex);
+    releasePinnedNodes(server, pinnedNodes, pinnedNodesSize);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
+static void
+onReadWriteTheAnswer(UA_Server *server_, const UA_NodeId *sessionId,
+                     void *sessionContext, const UA_NodeId *nodeId,
+                     void *nodeContext, const UA_NumericRange *range,
+                     const UA_DataValue *value) {
+    UA_Int32 newValue = 43;
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &newValue, &UA_TYPES[UA_TYPES_INT32]);
+    UA_Server_writeValue(server_, UA_NODEID_STRING(1, "the.answer"), v);
+}
+
+/* An onRead callback of a later operation writes to a node whose value was
+ * borrowed before */
+START_TEST(ReadValueNoCopyWriteInCallback) {
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 zero = 0;
+    UA_Variant_setScalar(&vattr.value, &zero, &UA_TYPES[UA_TYPES_INT32]);
+    UA_NodeId callbackNodeId = UA_NODEID_STRING(1, "callback");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, callbackNodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "callback"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  vattr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_ValueCallback callback;
+    callback.onRead = onReadWriteTheAnswer;
+    callback.onWrite = NULL;
+    retval = UA_Server_setVariableNode_valueCallback(server, callbackNodeId, callback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ReadValueId rvi[2];
+    UA_ReadValueId_init(&rvi[0]);
+    rvi[0].nodeId = UA_NODEID_STRING(1, "the.answer");
+    rvi[0].attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadValueId_init(&rvi[1]);
+    rvi[1].nodeId = callbackNodeId;
+    rvi[1].attributeId = UA_ATTRIBUTEID_VALUE;
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 2;
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+
+    const UA_Node **pinnedNodes;
+    size_t pinnedNodesSize;
+    UA_LOCK(&server->serviceMutex);
+    Service_ReadNoCopy(server, &server->adminSession, &request, &response,
+                       &pinnedNodes, &pinnedNodesSize);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.resultsSize, 2);
+    ck_assert_uint_eq(pinnedNodesSize, 1);
+    ck_assert(response.results[0].hasValue);
+#ifdef UA_ENABLE_IMMUTABLE_NODES
+    /* The pinned node is the version before the write */
+    ck_assert_int_eq(*(UA_Int32*)response.results[0].value.data, 42);
+#else
+    /* The node was edited in-situ. The result points to the current value. */
+    ck_assert_int_eq(*(UA_Int32*)response.results[0].value.data, 43);
+#endif
+
+    UA_LOCK(&server->serviceMutex);
+    releasePinnedNodes(server, pinnedNodes, pinnedNodesSize);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
 START_TEST(ReadSingleAttributeNodeIdWithoutTimestamp) {
     UA_ReadValueId rvi;
     UA_ReadValueId_init(&rvi);
@@ -981,6 +1098,8 @@ static Suite * testSuite_services_attributes(void) {
     tcase_add_test(tc_readSingleAttributes, ReadSingleAttributeValueWithoutTimestamp);
     tcase_add_test(tc_readSingleAttributes, ReadSingleServerAttribute);
     tcase_add_test(tc_readSingleAttributes, ReadSingleAttributeValueRangeWithoutTimestamp);
+    tcase_add_test(tc_readSingleAttributes, ReadValueNoCopy);
+    tcase_add_test(tc_readSingleAttributes, ReadValueNoCopyWriteInCallback);
     tcase_add_test(tc_readSingleAttributes, ReadSingleAttributeNodeIdWithoutTimestamp);
     tcase_add_test(tc_readSingleAttributes, ReadSingleAttributeNodeClassWithoutTimestamp);
     tcase_add_test(tc_readSingleAttributes, ReadSingleAttributeBrowseNameWithoutTimestamp);
@@ -205,6 +205,137 @@ START_TEST(callMethodWithWronglyTypedArguments) {
 #endif
 } END_TEST
 
+/* The method argument definitions and the object membership are cached. The
+ * cache must follow changes of the address space. */
+
+static UA_StatusCode
+echoCallback(UA_Server *serverArg,
+             const UA_NodeId *sessionId, void *sessionHandle,
+             const UA_NodeId *methodId, void *methodContext,
+             const UA_NodeId *objectId, void *objectContext,
+             size_t inputSize, const UA_Variant *input,
+             size_t outputSize, UA_Variant *output) {
+    if(inputSize != 1 || outputSize != 1)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_Variant_copy(input, output);
+}
+
+static void setupEcho(void) {
+    setup();
+
+    UA_Argument inputArgument;
+    UA_Argument_init(&inputArgument);
+    inputArgument.name = UA_STRING("Input");
+    inputArgument.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    inputArgument.valueRank = UA_VALUERANK_SCALAR;
+
+    UA_Argument outputArgument;
+    UA_Argument_init(&outputArgument);
+    outputArgument.name = UA_STRING("Output");
+    outputArgument.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    outputArgument.valueRank = UA_VALUERANK_SCALAR;
+
+    UA_MethodAttributes attr = UA_MethodAttributes_default;
+    attr.executable = true;
+    attr.userExecutable = true;
+    UA_StatusCode res =
+        UA_Server_addMethodNodeEx(server, UA_NODEID_STRING(1, "echo"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, "Echo"), attr, &echoCallback,
+                                  1, &inputArgument, UA_NODEID_STRING(1, "echo-input"), NULL,
+                                  1, &outputArgument, UA_NODEID_NULL, NULL, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    res = UA_Server_addObjectNode(server, UA_NODEID_STRING(1, "otherobject"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Other Object"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oAttr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void setupEchoNoCache(void) {
+    setupEcho();
+    UA_Server_getConfig(server)->maxMethodCallCacheSize = 0;
+}
+
+static UA_StatusCode
+callEcho(const UA_NodeId objectId, size_t inputSize, UA_Int32 value) {
+    UA_Variant input;
+    UA_Variant_setScalar(&input, &value, &UA_TYPES[UA_TYPES_INT32]);
+
+    UA_CallMethodRequest request;
+    UA_CallMethodRequest_init(&request);
+    request.methodId = UA_NODEID_STRING(1, "echo");
+    request.objectId = objectId;
+    request.inputArgumentsSize = inputSize;
+    request.inputArguments = &input;
+
+    UA_CallMethodResult result = UA_Server_call(server, &request);
+    UA_StatusCode res = result.statusCode;
+    if(res == UA_STATUSCODE_GOOD) {
+        ck_assert_uint_eq(result.outputArgumentsSize, 1);
+        ck_assert(UA_Variant_hasScalarType(&result.outputArguments[0],
+                                           &UA_TYPES[UA_TYPES_INT32]));
+        ck_assert_int_eq(*(UA_Int32*)result.outputArguments[0].data, value);
+    }
+    UA_CallMethodResult_clear(&result);
+    return res;
+}
+
+START_TEST(callMethodRepeatedly) {
+    const UA_NodeId objects = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    for(UA_Int32 i = 0; i < 10; i++) {
+        ck_assert_uint_eq(callEcho(objects, 1, i), UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(callEcho(objects, 0, i), UA_STATUSCODE_BADARGUMENTSMISSING);
+    }
+} END_TEST
+
+START_TEST(callMethodAfterArgumentsChanged) {
+    const UA_NodeId objects = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    ck_assert_uint_eq(callEcho(objects, 1, 42), UA_STATUSCODE_GOOD);
+
+    /* Expect a Double argument instead */
+    const UA_NodeId inputArgumentsId = UA_NODEID_STRING(1, "echo-input");
+    UA_Argument inputArgument;
+    UA_Argument_init(&inputArgument);
+    inputArgument.name = UA_STRING("Input");
+    inputArgument.dataType = UA_TYPES[UA_TYPES_DOUBLE].typeId;
+    inputArgument.valueRank = UA_VALUERANK_SCALAR;
+    UA_Variant value;
+    UA_Variant_setArray(&value, &inputArgument, 1, &UA_TYPES[UA_TYPES_ARGUMENT]);
+    UA_StatusCode res = UA_Server_writeValue(server, inputArgumentsId, value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(callEcho(objects, 1, 42), UA_STATUSCODE_BADINVALIDARGUMENT);
+
+    /* Without the InputArguments property, no arguments are accepted */
+    res = UA_Server_deleteNode(server, inputArgumentsId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(callEcho(objects, 1, 42), UA_STATUSCODE_BADTOOMANYARGUMENTS);
+    ck_assert_uint_eq(callEcho(objects, 0, 42), UA_STATUSCODE_BADINTERNALERROR);
+} END_TEST
+
+START_TEST(callMethodAfterReferencesChanged) {
+    const UA_NodeId other = UA_NODEID_STRING(1, "otherobject");
+    ck_assert_uint_eq(callEcho(other, 1, 42), UA_STATUSCODE_BADMETHODINVALID);
+
+    UA_ExpandedNodeId target = UA_EXPANDEDNODEID_STRING(1, "echo");
+    UA_StatusCode res =
+        UA_Server_addReference(server, other, UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                               target, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(callEcho(other, 1, 42), UA_STATUSCODE_GOOD);
+
+    res = UA_Server_deleteReference(server, other,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                    true, target, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(callEcho(other, 1, 42), UA_STATUSCODE_BADMETHODINVALID);
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("services_call");
 
@@ -221,6 +352,20 @@ int main(void) {
     tcase_add_test(tc_call, callMethodWithWronglyTypedArguments);
     suite_add_tcase(s, tc_call);
 
+    TCase *tc_cache = tcase_create("call - cached descriptors");
+    tcase_add_checked_fixture(tc_cache, setupEcho, teardown);
+    tcase_add_test(tc_cache, callMethodRepeatedly);
+    tcase_add_test(tc_cache, callMethodAfterArgumentsChanged);
+    tcase_add_test(tc_cache, callMethodAfterReferencesChanged);
+    suite_add_tcase(s, tc_cache);
+
+    TCase *tc_nocache = tcase_create("call - without cache");
+    tcase_add_checked_fixture(tc_nocache, setupEchoNoCache, teardown);
+    tcase_add_test(tc_nocache, callMethodRepeatedly);
+    tcase_add_test(tc_nocache, callMethodAfterArgumentsChanged);
+    tcase_add_test(tc_nocache, callMethodAfterReferencesChanged);
+    suite_add_tcase(s, tc_nocache);
+
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
     srunner_run_all(sr, CK_NORMAL);
@@ -568,6 +568,181 @@ START_TEST(InstantiateObjectType) {
     ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
 } END_TEST
 
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+
+static UA_NodeId
+addTypeChild(const UA_NodeId parentId, UA_NodeClass nodeClass, char *name,
+             UA_Boolean mandatory) {
+    UA_NodeId childId;
+    UA_StatusCode retval;
+    if(nodeClass == UA_NODECLASS_VARIABLE) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
+        retval = UA_Server_addVariableNode(server, UA_NODEID_NULL, parentId,
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                           UA_QUALIFIEDNAME(1, name),
+                                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                           attr, NULL, &childId);
+    } else {
+        UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+        attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
+        retval = UA_Server_addObjectNode(server, UA_NODEID_NULL, parentId,
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                         UA_QUALIFIEDNAME(1, name),
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                         attr, NULL, &childId);
+    }
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_NodeId modellingRule = UA_NODEID_NUMERIC(0, mandatory ?
+                                                UA_NS0ID_MODELLINGRULE_MANDATORY :
+                                                UA_NS0ID_MODELLINGRULE_OPTIONAL);
+    retval = UA_Server_addReference(server, childId,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASMODELLINGRULE),
+                                    UA_EXPANDEDNODEID_NUMERIC(0, modellingRule.identifier.numeric),
+                                    true);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    return childId;
+}
+
+static size_t
+countChildren(const UA_NodeId nodeId, UA_UInt32 refTypeId) {
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = nodeId;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, refTypeId);
+    bd.includeSubtypes = true;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_int_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    size_t count = br.referencesSize;
+    if(refTypeId == UA_NS0ID_AGGREGATES) {
+        for(size_t i = 0; i < br.referencesSize; i++)
+            count += countChildren(br.references[i].nodeId.nodeId, refTypeId);
+    }
+    UA_BrowseResult_clear(&br);
+    return count;
+}
+
+static UA_NodeId
+findChild(const UA_NodeId nodeId, size_t pathSize, char **path) {
+    UA_QualifiedName names[4];
+    for(size_t i = 0; i < pathSize; i++)
+        names[i] = UA_QUALIFIEDNAME(1, path[i]);
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server, nodeId, pathSize, names);
+    UA_NodeId childId = UA_NODEID_NULL;
+    if(bpr.statusCode == UA_STATUSCODE_GOOD && bpr.targetsSize == 1)
+        UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, &childId);
+    UA_BrowsePathResult_clear(&bpr);
+    return childId;
+}
+
+static void
+checkPumpInstance(const UA_NodeId pumpId) {
+    /* Children from the type and the supertype. The members of the
+     * ManufacturerName from the supertype are merged. */
+    char *statusPath[1] = {"Status"};
+    char *unit[2] = {"ManufacturerName", "Unit"};
+    char *rpm[2] = {"Motor", "RPM"};
+    char *model[1] = {"ModelName"};
+    UA_NodeId statusId = findChild(pumpId, 1, statusPath);
+    ck_assert(!UA_NodeId_isNull(&statusId));
+    UA_NodeId unitId = findChild(pumpId, 2, unit);
+    ck_assert(!UA_NodeId_isNull(&unitId));
+    UA_NodeId rpmId = findChild(pumpId, 2, rpm);
+    ck_assert(!UA_NodeId_isNull(&rpmId));
+    UA_NodeId modelId = findChild(pumpId, 1, model);
+    ck_assert(UA_NodeId_isNull(&modelId));
+    ck_assert_uint_eq(countChildren(pumpId, UA_NS0ID_AGGREGATES), 5);
+
+    /* The default config keeps the modelling rules on instances */
+    ck_assert_uint_eq(countChildren(statusId, UA_NS0ID_HASMODELLINGRULE), 1);
+    ck_assert_uint_eq(countChildren(rpmId, UA_NS0ID_HASTYPEDEFINITION), 1);
+    UA_NodeId_clear(&statusId);
+    UA_NodeId_clear(&unitId);
+    UA_NodeId_clear(&rpmId);
+}
+
+START_TEST(InstantiateObjectTypeBulk) {
+    /* DeviceType with a mandatory ManufacturerName (with a mandatory Unit) and
+     * an optional ModelName */
+    UA_NodeId deviceTypeId;
+    UA_ObjectTypeAttributes dtAttr = UA_ObjectTypeAttributes_default;
+    dtAttr.displayName = UA_LOCALIZEDTEXT("en-US", "DeviceType");
+    UA_StatusCode retval =
+        UA_Server_addObjectTypeNode(server, UA_NODEID_NULL,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(1, "DeviceType"), dtAttr,
+                                    NULL, &deviceTypeId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_NodeId manufacturerId =
+        addTypeChild(deviceTypeId, UA_NODECLASS_VARIABLE, "ManufacturerName", true);
+    addTypeChild(manufacturerId, UA_NODECLASS_VARIABLE, "Unit", true);
+    addTypeChild(deviceTypeId, UA_NODECLASS_VARIABLE, "ModelName", false);
+
+    /* PumpType overrides the ManufacturerName and adds a Status and a Motor
+     * object with a RPM variable */
+    UA_NodeId pumpTypeId;
+    UA_ObjectTypeAttributes ptAttr = UA_ObjectTypeAttributes_default;
+    ptAttr.displayName = UA_LOCALIZEDTEXT("en-US", "PumpType");
+    retval = UA_Server_addObjectTypeNode(server, UA_NODEID_NULL, deviceTypeId,
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                         UA_QUALIFIEDNAME(1, "PumpType"), ptAttr,
+                                         NULL, &pumpTypeId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    addTypeChild(pumpTypeId, UA_NODECLASS_VARIABLE, "ManufacturerName", true);
+    addTypeChild(pumpTypeId, UA_NODECLASS_VARIABLE, "Status", true);
+    UA_NodeId motorId = addTypeChild(pumpTypeId, UA_NODECLASS_OBJECT, "Motor", true);
+    addTypeChild(motorId, UA_NODECLASS_VARIABLE, "RPM", true);
+
+    /* Instantiate one by one */
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_NodeId pumpId;
+    handleCalled = 0;
+    retval = UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                     UA_QUALIFIEDNAME(1, "Pump"), pumpTypeId,
+                                     oAttr, NULL, &pumpId);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    checkPumpInstance(pumpId);
+    UA_Int32 constructed = handleCalled;
+    ck_assert_int_eq(constructed, 6);
+    UA_NodeId_clear(&pumpId);
+
+    /* Instantiate in bulk. The second item has an invalid parent. */
+    UA_AddObjectNodesItem items[3];
+    memset(items, 0, sizeof(items));
+    for(size_t i = 0; i < 3; i++) {
+        items[i].parentNodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+        items[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+        items[i].browseName = UA_QUALIFIEDNAME(1, "Pump");
+        items[i].attr = oAttr;
+    }
+    items[1].parentNodeId = UA_NODEID_NUMERIC(1, 424242);
+    UA_StatusCode results[3];
+    UA_NodeId pumpIds[3];
+    handleCalled = 0;
+    retval = UA_Server_addObjectNodes(server, pumpTypeId, 3, items, results, pumpIds);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(results[0], UA_STATUSCODE_GOOD);
+    ck_assert_int_ne(results[1], UA_STATUSCODE_GOOD);
+    ck_assert(UA_NodeId_isNull(&pumpIds[1]));
+    ck_assert_int_eq(results[2], UA_STATUSCODE_GOOD);
+    checkPumpInstance(pumpIds[0]);
+    checkPumpInstance(pumpIds[2]);
+    ck_assert_int_eq(handleCalled, 2 * constructed);
+    UA_NodeId_clear(&pumpIds[0]);
+    UA_NodeId_clear(&pumpIds[2]);
+
+    /* Only ObjectTypes can be instantiated */
+    retval = UA_Server_addObjectNodes(server, manufacturerId, 1, items, results, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADTYPEDEFINITIONINVALID);
+} END_TEST
+
+#endif
+
 static UA_NodeId
 findReference(const UA_NodeId sourceId, const UA_NodeId refTypeId) {
 	UA_BrowseDescription * bDesc = UA_BrowseDescription_new();
@@ -674,6 +849,9 @@ int main(void) {
     tcase_add_test(tc_addnodes, AddNodeTwiceGivesError);
     tcase_add_test(tc_addnodes, AddObjectWithConstructor);
     tcase_add_test(tc_addnodes, InstantiateObjectType);
+#ifdef UA_GENERATED_NAMESPACE_ZERO
+    tcase_add_test(tc_addnodes, InstantiateObjectTypeBulk);
+#endif
     suite_add_tcase(s, tc_addnodes);
 
     TCase *tc_deletenodes = tcase_create("deletenodes");
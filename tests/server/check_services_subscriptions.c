@@ -12,6 +12,8 @@
 #include <check.h>
 
 #include "testing_clock.h"
+#include "testing_networklayers.h"
+#include "testing_policy.h"
 
 static UA_Server *server = NULL;
 static UA_Session *session = NULL;
@@ -850,6 +852,205 @@ START_TEST(Server_invalidSamplingInterval) {
 }
 END_TEST
 
+/* Sessions bound to a SecureChannel with a dummy connection. The sent
+ * PublishResponses are copied to sentBuffer. */
+static UA_SecureChannel testChannel;
+static UA_SecurityPolicy dummyPolicy;
+static UA_Connection testingConnection;
+static UA_ByteString sentBuffer;
+static funcs_called funcsCalled;
+static key_sizes keySizes;
+static UA_NodeId variableNodeId;
+static UA_Int32 variableValue;
+
+static void setupChannel(void) {
+    setup();
+
+    TestingPolicy(&dummyPolicy, UA_BYTESTRING_NULL, &funcsCalled, &keySizes);
+    UA_SecureChannel_init(&testChannel, &UA_ConnectionConfig_default);
+    UA_SecureChannel_setSecurityPolicy(&testChannel, &dummyPolicy, &UA_BYTESTRING_NULL);
+    testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    UA_ByteString_init(&sentBuffer);
+    testingConnection = createDummyConnection(65535, &sentBuffer);
+    UA_Connection_attachSecureChannel(&testingConnection, &testChannel);
+    testChannel.connection = &testingConnection;
+
+    /* Replace the session with one that is bound to the channel */
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    request.requestedSessionTimeout = UA_UINT32_MAX;
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode retval = UA_Server_createSession(server, &testChannel, &request, &session);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Add a variable to monitor */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    variableValue = 0;
+    UA_Variant_setScalar(&attr.value, &variableValue, &UA_TYPES[UA_TYPES_INT32]);
+    variableNodeId = UA_NODEID_STRING(1, "retransmission.variable");
+    retval = UA_Server_addVariableNode(server, variableNodeId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "retransmission variable"),
+                                       UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void teardownChannel(void) {
+    teardown();
+    UA_SecureChannel_close(&testChannel);
+    dummyPolicy.clear(&dummyPolicy);
+    testingConnection.close(&testingConnection);
+}
+
+static UA_Subscription *
+createVariableSubscription(void) {
+    createSubscription();
+    UA_Subscription *sub = UA_Session_getSubscriptionById(session, subscriptionId);
+    ck_assert_ptr_ne(sub, NULL);
+
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = variableNodeId;
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item.requestedParameters.samplingInterval = 1000000.0;
+    item.requestedParameters.queueSize = 1;
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.itemsToCreateSize = 1;
+    request.itemsToCreate = &item;
+    UA_CreateMonitoredItemsResponse response;
+    UA_CreateMonitoredItemsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateMonitoredItems(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    UA_CreateMonitoredItemsResponse_clear(&response);
+    return sub;
+}
+
+/* Change the value, sample and send a PublishResponse without acknowledging */
+static void
+changeAndPublish(UA_Subscription *sub) {
+    variableValue++;
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &variableValue, &UA_TYPES[UA_TYPES_INT32]);
+    UA_StatusCode retval = UA_Server_writeValue(server, variableNodeId, value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_MonitoredItem_sampleCallback(server, LIST_FIRST(&sub->monitoredItems));
+
+    UA_PublishResponseEntry *pre = (UA_PublishResponseEntry*)
+        UA_malloc(sizeof(UA_PublishResponseEntry));
+    ck_assert_ptr_ne(pre, NULL);
+    pre->requestId = 1;
+    UA_PublishResponse_init(&pre->response);
+    UA_LOCK(&server->serviceMutex);
+    UA_Session_queuePublishReq(session, pre, false);
+    sub->readyNotifications = sub->notificationQueueSize;
+    UA_Subscription_publish(server, sub);
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+static UA_Boolean
+sentBufferContains(const UA_ByteString *encoded) {
+    if(encoded->length == 0 || sentBuffer.length < encoded->length)
+        return false;
+    for(size_t i = 0; i <= sentBuffer.length - encoded->length; i++) {
+        if(memcmp(&sentBuffer.data[i], encoded->data, encoded->length) == 0)
+            return true;
+    }
+    return false;
+}
+
+START_TEST(Server_retransmissionEncoded) {
+    UA_Subscription *sub = createVariableSubscription();
+    changeAndPublish(sub);
+
+    /* The encoded NotificationMessage is retained and was sent out */
+    ck_assert_uint_eq(sub->retransmissionQueueSize, 1);
+    UA_NotificationMessageEntry *entry = TAILQ_FIRST(&sub->retransmissionQueue);
+    ck_assert_uint_gt(entry->encoded.length, 0);
+    ck_assert_uint_eq(sub->retransmissionQueueBytes, entry->encoded.length);
+    ck_assert_uint_eq(session->totalRetransmissionQueueBytes, entry->encoded.length);
+    ck_assert(sentBufferContains(&entry->encoded));
+
+    /* Republish decodes the retained message */
+    UA_RepublishRequest request;
+    UA_RepublishRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.retransmitSequenceNumber = entry->sequenceNumber;
+    UA_RepublishResponse response;
+    UA_RepublishResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Republish(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.notificationMessage.sequenceNumber, entry->sequenceNumber);
+    ck_assert_int_eq(response.notificationMessage.publishTime, entry->publishTime);
+    ck_assert_uint_eq(response.notificationMessage.notificationDataSize, 1);
+    UA_DataChangeNotification *dcn = (UA_DataChangeNotification*)
+        response.notificationMessage.notificationData[0].content.decoded.data;
+    ck_assert_uint_eq(dcn->monitoredItemsSize, 1);
+    ck_assert_int_eq(*(UA_Int32*)dcn->monitoredItems[0].value.value.data, variableValue);
+    UA_RepublishResponse_clear(&response);
+
+    /* The binary Republish sends the retained bytes */
+    UA_ByteString_clear(&sentBuffer);
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode retval = Service_RepublishEncoded(server, session, &request, 2);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(sentBufferContains(&entry->encoded));
+
+    /* Acknowledge */
+    retval = UA_Subscription_removeRetransmissionMessage(sub, request.retransmitSequenceNumber);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(sub->retransmissionQueueSize, 0);
+    ck_assert_uint_eq(sub->retransmissionQueueBytes, 0);
+    ck_assert_uint_eq(session->totalRetransmissionQueueBytes, 0);
+}
+END_TEST
+
+START_TEST(Server_retransmissionByteLimit) {
+    UA_Subscription *sub = createVariableSubscription();
+    changeAndPublish(sub);
+    ck_assert_uint_eq(sub->retransmissionQueueSize, 1);
+    size_t messageSize = TAILQ_FIRST(&sub->retransmissionQueue)->encoded.length;
+
+    /* Room for two messages */
+    server->config.maxRetransmissionQueueBytes = (messageSize * 5) / 2;
+    for(size_t i = 0; i < 5; i++) {
+        changeAndPublish(sub);
+        ck_assert_uint_le(session->totalRetransmissionQueueBytes,
+                          server->config.maxRetransmissionQueueBytes);
+    }
+    ck_assert_uint_eq(sub->retransmissionQueueSize, 2);
+    ck_assert_uint_eq(sub->retransmissionQueueBytes, 2 * messageSize);
+
+    /* The two newest messages are retained in the order they were sent */
+    UA_NotificationMessageEntry *first = TAILQ_FIRST(&sub->retransmissionQueue);
+    UA_NotificationMessageEntry *last =
+        TAILQ_LAST(&sub->retransmissionQueue, ListOfNotificationMessages);
+    ck_assert_uint_eq(first->sequenceNumber, sub->nextSequenceNumber - 2);
+    ck_assert_uint_eq(last->sequenceNumber, sub->nextSequenceNumber - 1);
+    ck_assert_ptr_eq(TAILQ_NEXT(first, listEntry), last);
+
+    /* A message larger than the limit is sent but not retained */
+    server->config.maxRetransmissionQueueBytes = messageSize - 1;
+    UA_ByteString_clear(&sentBuffer);
+    changeAndPublish(sub);
+    ck_assert_uint_gt(sentBuffer.length, 0);
+    ck_assert_uint_eq(sub->retransmissionQueueSize, 2);
+    ck_assert_ptr_eq(first, TAILQ_FIRST(&sub->retransmissionQueue));
+    ck_assert_ptr_eq(last, TAILQ_LAST(&sub->retransmissionQueue, ListOfNotificationMessages));
+}
+END_TEST
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
 
 static Suite* testSuite_Client(void) {
@@ -875,6 +1076,14 @@ static Suite* testSuite_Client(void) {
 #endif /* UA_ENABLE_SUBSCRIPTIONS */
     suite_add_tcase(s, tc_server);
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    TCase *tc_retransmission = tcase_create("Server Subscription Retransmission");
+    tcase_add_checked_fixture(tc_retransmission, setupChannel, teardownChannel);
+    tcase_add_test(tc_retransmission, Server_retransmissionEncoded);
+    tcase_add_test(tc_retransmission, Server_retransmissionByteLimit);
+    suite_add_tcase(s, tc_retransmission);
+#endif /* UA_ENABLE_SUBSCRIPTIONS */
+
     return s;
 }
 
@@ -12,6 +12,7 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "thread_wrapper.h"
 
@@ -396,6 +397,182 @@ START_TEST(Service_TranslateBrowsePathsWithHashCollision) {
 }
 END_TEST
 
+static UA_StatusCode
+translatePath(UA_Server *server, const UA_NodeId start, size_t pathSize,
+              const char **names, UA_NodeId *outTarget) {
+    UA_RelativePathElement rpe[4];
+    UA_BrowsePath bp;
+    UA_BrowsePath_init(&bp);
+    bp.startingNode = start;
+    bp.relativePath.elements = rpe;
+    bp.relativePath.elementsSize = pathSize;
+    for(size_t i = 0; i < pathSize; i++) {
+        UA_RelativePathElement_init(&rpe[i]);
+        rpe[i].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+        rpe[i].includeSubtypes = true;
+        rpe[i].targetName = UA_QUALIFIEDNAME(1, (char*)(uintptr_t)names[i]);
+    }
+    UA_BrowsePathResult bpr = UA_Server_translateBrowsePathToNodeIds(server, &bp);
+    UA_StatusCode res = bpr.statusCode;
+    if(res == UA_STATUSCODE_GOOD) {
+        ck_assert_uint_eq(bpr.targetsSize, 1);
+        if(outTarget)
+            UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, outTarget);
+    }
+    UA_BrowsePathResult_clear(&bpr);
+    return res;
+}
+
+START_TEST(Service_TranslateBrowsePathsCache) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, UA_NODEID_STRING(1, "A"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "A"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_addObjectNode(server, UA_NODEID_STRING(1, "B"),
+                                  UA_NODEID_STRING(1, "A"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, "B"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    const UA_NodeId objects = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    const char *pathAB[2] = {"A", "B"};
+    const char *pathAC[2] = {"A", "C"};
+    const UA_NodeId nodeB = UA_NODEID_STRING(1, "B");
+    UA_NodeId target;
+
+    /* Translate twice. The second time from the cache. */
+    for(size_t i = 0; i < 2; i++) {
+        res = translatePath(server, objects, 2, pathAB, &target);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(UA_NodeId_equal(&target, &nodeB));
+        UA_NodeId_clear(&target);
+        ck_assert_uint_eq(translatePath(server, objects, 2, pathAC, NULL),
+                          UA_STATUSCODE_BADNOMATCH);
+    }
+
+    /* The prefix was cached as well */
+    ck_assert_uint_eq(translatePath(server, objects, 1, pathAB, NULL),
+                      UA_STATUSCODE_GOOD);
+
+    /* Add a node that matches the cached path without result */
+    res = UA_Server_addObjectNode(server, UA_NODEID_STRING(1, "C"),
+                                  UA_NODEID_STRING(1, "A"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, "C"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                  oattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(translatePath(server, objects, 2, pathAC, NULL),
+                      UA_STATUSCODE_GOOD);
+
+    /* Remove the reference to a cached target */
+    res = UA_Server_deleteReference(server, UA_NODEID_STRING(1, "A"),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT), true,
+                                    UA_EXPANDEDNODEID_STRING(1, "B"), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(translatePath(server, objects, 2, pathAB, NULL),
+                      UA_STATUSCODE_BADNOMATCH);
+
+    /* Delete a node on the cached path */
+    res = UA_Server_deleteNode(server, UA_NODEID_STRING(1, "A"), true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(translatePath(server, objects, 2, pathAC, NULL),
+                      UA_STATUSCODE_BADNOMATCH);
+    ck_assert_uint_eq(translatePath(server, objects, 1, pathAC, NULL),
+                      UA_STATUSCODE_BADNOMATCH);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
+#define TRANSLATE_OBJECTS 100
+#define TRANSLATE_VARIABLES 100
+
+START_TEST(Service_TranslateBrowsePathsSpeed) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    UA_ServerConfig_setDefault(config);
+
+    /* Objects/Object-i/Variable-j */
+    char name[32];
+    UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    for(UA_UInt32 i = 0; i < TRANSLATE_OBJECTS; i++) {
+        UA_NodeId objectId;
+        snprintf(name, sizeof(name), "Object-%u", (unsigned)i);
+        UA_StatusCode res =
+            UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                    UA_QUALIFIEDNAME(1, name),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                    oattr, NULL, &objectId);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        for(UA_UInt32 j = 0; j < TRANSLATE_VARIABLES; j++) {
+            snprintf(name, sizeof(name), "Variable-%u", (unsigned)j);
+            res = UA_Server_addVariableNode(server, UA_NODEID_NULL, objectId,
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                            UA_QUALIFIEDNAME(1, name),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            vattr, NULL, NULL);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+    }
+
+    size_t pathsSize = TRANSLATE_OBJECTS * TRANSLATE_VARIABLES;
+    UA_BrowsePath *paths = (UA_BrowsePath*)
+        UA_Array_new(pathsSize, &UA_TYPES[UA_TYPES_BROWSEPATH]);
+    ck_assert(paths != NULL);
+    for(UA_UInt32 i = 0; i < TRANSLATE_OBJECTS; i++) {
+        for(UA_UInt32 j = 0; j < TRANSLATE_VARIABLES; j++) {
+            UA_BrowsePath *bp = &paths[i * TRANSLATE_VARIABLES + j];
+            bp->startingNode = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+            bp->relativePath.elements = (UA_RelativePathElement*)
+                UA_Array_new(2, &UA_TYPES[UA_TYPES_RELATIVEPATHELEMENT]);
+            ck_assert(bp->relativePath.elements != NULL);
+            bp->relativePath.elementsSize = 2;
+            UA_RelativePathElement *rpe = bp->relativePath.elements;
+            rpe[0].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+            snprintf(name, sizeof(name), "Object-%u", (unsigned)i);
+            rpe[0].targetName = UA_QUALIFIEDNAME_ALLOC(1, name);
+            rpe[1].referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+            snprintf(name, sizeof(name), "Variable-%u", (unsigned)j);
+            rpe[1].targetName = UA_QUALIFIEDNAME_ALLOC(1, name);
+        }
+    }
+
+    /* No cache, empty cache, filled cache */
+    const char *runs[3] = {"no cache", "empty cache", "filled cache"};
+    for(size_t r = 0; r < 3; r++) {
+        config->maxBrowsePathCacheSize = (r == 0) ? 0 : 16384;
+        clock_t begin = clock();
+        for(size_t i = 0; i < pathsSize; i++) {
+            UA_BrowsePathResult bpr =
+                UA_Server_translateBrowsePathToNodeIds(server, &paths[i]);
+            ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq(bpr.targetsSize, 1);
+            UA_BrowsePathResult_clear(&bpr);
+        }
+        double duration = (double)(clock() - begin) / CLOCKS_PER_SEC;
+        printf("Translate %lu BrowsePaths (%s): %f s\n",
+               (unsigned long)pathsSize, runs[r], duration);
+    }
+
+    UA_Array_delete(paths, pathsSize, &UA_TYPES[UA_TYPES_BROWSEPATH]);
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(BrowseSimplifiedBrowsePath) {
     UA_QualifiedName objectsName = UA_QUALIFIEDNAME(0, "Objects");
     UA_BrowsePathResult bpr =
@@ -409,6 +586,162 @@ START_TEST(BrowseSimplifiedBrowsePath) {
 }
 END_TEST
 
+/* HasSubtype together with a ReferenceType that is not used between type nodes
+ * gives the same result without the subtype index */
+static UA_Boolean
+isSubtypeWalk(UA_Server *server, UA_UInt32 leaf, UA_UInt32 find) {
+    UA_NodeId leafId = UA_NODEID_NUMERIC(0, leaf);
+    UA_NodeId findId = UA_NODEID_NUMERIC(0, find);
+    UA_ReferenceTypeSet refs =
+        UA_ReferenceTypeSet_union(UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE),
+                                  UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASEVENTSOURCE));
+    return isNodeInTree(server, &leafId, &findId, &refs);
+}
+
+static UA_Boolean
+isSubtype(UA_Server *server, const UA_NodeId leaf, const UA_NodeId find) {
+    return isNodeInTree_singleRef(server, &leaf, &find,
+                                  UA_REFERENCETYPEINDEX_HASSUBTYPE);
+}
+
+START_TEST(IsNodeInTree_Subtypes) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    const UA_UInt32 types[] = {
+        UA_NS0ID_INT32, UA_NS0ID_INTEGER, UA_NS0ID_NUMBER, UA_NS0ID_FLOAT,
+        UA_NS0ID_BASEDATATYPE, UA_NS0ID_STRING, UA_NS0ID_FOLDERTYPE,
+        UA_NS0ID_BASEOBJECTTYPE, UA_NS0ID_BASEDATAVARIABLETYPE,
+        UA_NS0ID_BASEVARIABLETYPE, UA_NS0ID_ORGANIZES,
+        UA_NS0ID_HIERARCHICALREFERENCES, UA_NS0ID_REFERENCES,
+        UA_NS0ID_OBJECTSFOLDER};
+    const size_t typesSize = sizeof(types) / sizeof(UA_UInt32);
+    for(size_t i = 0; i < typesSize; i++) {
+        for(size_t j = 0; j < typesSize; j++) {
+            ck_assert_uint_eq(isSubtype(server, UA_NODEID_NUMERIC(0, types[i]),
+                                        UA_NODEID_NUMERIC(0, types[j])),
+                              isSubtypeWalk(server, types[i], types[j]));
+        }
+    }
+
+    ck_assert(isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_INT32),
+                        UA_NODEID_NUMERIC(0, UA_NS0ID_NUMBER)));
+    ck_assert(!isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_NUMBER),
+                         UA_NODEID_NUMERIC(0, UA_NS0ID_INT32)));
+    ck_assert(!isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_INT32),
+                         UA_NODEID_NUMERIC(0, UA_NS0ID_FLOAT)));
+    ck_assert(isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                        UA_NODEID_NUMERIC(0, UA_NS0ID_REFERENCES)));
+
+    /* Instances are not indexed */
+    ck_assert(isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER)));
+    ck_assert(!isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                         UA_NODEID_NUMERIC(0, UA_NS0ID_ROOTFOLDER)));
+
+    UA_Server_delete(server);
+}
+END_TEST
+
+static UA_NodeId
+addObjectType(UA_Server *server, UA_UInt32 id, const UA_NodeId parent) {
+    UA_ObjectTypeAttributes attr = UA_ObjectTypeAttributes_default;
+    UA_NodeId typeId = UA_NODEID_NUMERIC(1, id);
+    UA_StatusCode res =
+        UA_Server_addObjectTypeNode(server, typeId, parent,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(1, "Type"), attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    return typeId;
+}
+
+START_TEST(IsNodeInTree_ModifySubtypes) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    UA_NodeId baseObjectType = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    UA_NodeId typeA = addObjectType(server, 1000, baseObjectType);
+    UA_NodeId typeB = addObjectType(server, 1001, typeA);
+    UA_NodeId typeC = addObjectType(server, 1002, baseObjectType);
+    ck_assert(isSubtype(server, typeB, baseObjectType));
+    ck_assert(isSubtype(server, typeB, typeA));
+    ck_assert(!isSubtype(server, typeB, typeC));
+
+    /* Multiple inheritance */
+    UA_ExpandedNodeId targetB = UA_EXPANDEDNODEID_NUMERIC(1, 1001);
+    UA_StatusCode res =
+        UA_Server_addReference(server, typeC, UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                               targetB, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(isSubtype(server, typeB, typeA));
+    ck_assert(isSubtype(server, typeB, typeC));
+
+    /* Remove a supertype */
+    res = UA_Server_deleteReference(server, typeA,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                    true, targetB, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(!isSubtype(server, typeB, typeA));
+    ck_assert(isSubtype(server, typeB, typeC));
+    ck_assert(isSubtype(server, typeB, baseObjectType));
+
+    /* Delete the subtype and add it again with a different parent */
+    res = UA_Server_deleteNode(server, typeB, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(!isSubtype(server, typeB, typeC));
+    typeB = addObjectType(server, 1001, typeA);
+    ck_assert(isSubtype(server, typeB, typeA));
+    ck_assert(!isSubtype(server, typeB, typeC));
+    ck_assert(isSubtype(server, typeB, baseObjectType));
+
+    UA_Server_delete(server);
+}
+END_TEST
+
+START_TEST(IsNodeInTree_Speed) {
+    UA_Server *server = UA_Server_new();
+    UA_ServerConfig_setDefault(UA_Server_getConfig(server));
+
+    /* A deep hierarchy of ObjectTypes */
+    UA_NodeId parent = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    for(UA_UInt32 i = 0; i < 40; i++)
+        parent = addObjectType(server, 2000 + i, parent);
+
+    const int runs = 100000;
+    UA_Boolean found = true;
+    clock_t begin = clock();
+    for(int i = 0; i < runs; i++)
+        found &= isSubtypeWalk(server, UA_NS0ID_INT32, UA_NS0ID_BASEDATATYPE);
+    double walkShallow = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    begin = clock();
+    for(int i = 0; i < runs; i++)
+        found &= isSubtype(server, UA_NODEID_NUMERIC(0, UA_NS0ID_INT32),
+                           UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATATYPE));
+    double indexShallow = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    UA_NodeId root = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+    UA_ReferenceTypeSet refs =
+        UA_ReferenceTypeSet_union(UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE),
+                                  UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASEVENTSOURCE));
+    begin = clock();
+    for(int i = 0; i < runs; i++)
+        found &= isNodeInTree(server, &parent, &root, &refs);
+    double walkDeep = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    begin = clock();
+    for(int i = 0; i < runs; i++)
+        found &= isSubtype(server, parent, root);
+    double indexDeep = (double)(clock() - begin) / CLOCKS_PER_SEC;
+    ck_assert(found);
+
+    printf("%i subtype checks (depth 4): walk %f s, index %f s\n",
+           runs, walkShallow, indexShallow);
+    printf("%i subtype checks (depth 41): walk %f s, index %f s\n",
+           runs, walkDeep, indexDeep);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     Suite *s = suite_create("Service_TranslateBrowsePathsToNodeIds");
     TCase *tc_browse = tcase_create("Browse Service");
@@ -418,6 +751,8 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_browse, Service_Browse_ReferenceTypes);
     tcase_add_test(tc_browse, Service_Browse_WithMaxResults);
     tcase_add_test(tc_browse, Service_Browse_Recursive);
+    tcase_add_test(tc_browse, Service_TranslateBrowsePathsCache);
+    tcase_add_test(tc_browse, Service_TranslateBrowsePathsSpeed);
     suite_add_tcase(s, tc_browse);
 
     TCase *tc_translate = tcase_create("TranslateBrowsePathsToNodeIds");
@@ -427,6 +762,12 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_translate, BrowseSimplifiedBrowsePath);
 
     suite_add_tcase(s, tc_translate);
+
+    TCase *tc_tree = tcase_create("IsNodeInTree");
+    tcase_add_test(tc_tree, IsNodeInTree_Subtypes);
+    tcase_add_test(tc_tree, IsNodeInTree_ModifySubtypes);
+    tcase_add_test(tc_tree, IsNodeInTree_Speed);
+    suite_add_tcase(s, tc_tree);
     return s;
 }
 